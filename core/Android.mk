@@ -17,23 +17,34 @@ COMMON_FILES :=	\
 	src/BitMatrix.cpp \
 	src/BitSource.cpp \
 	src/CharacterSetECI.cpp \
+	src/CpuFeatures.cpp \
+	src/Deadline.cpp \
 	src/DecodeHints.cpp \
+	src/DecodeStats.cpp \
 	src/DecodeStatus.cpp \
+	src/EdgeOrientation.cpp \
 	src/GenericGF.cpp \
 	src/GenericGFPoly.cpp \
 	src/GenericLuminanceSource.cpp \
 	src/GlobalHistogramBinarizer.cpp \
 	src/GridSampler.cpp \
+	src/GS1.cpp \
 	src/HybridBinarizer.cpp \
+	src/IntegralImageBinarizer.cpp \
 	src/LuminanceSource.cpp \
+	src/MemoryResource.cpp \
 	src/MultiFormatReader.cpp \
+	src/Parallel.cpp \
 	src/PerspectiveTransform.cpp \
 	src/ReedSolomonDecoder.cpp \
 	src/Result.cpp \
 	src/ResultMetadata.cpp \
 	src/ResultPoint.cpp \
+	src/RunLengthIndex.cpp \
 	src/TextDecoder.cpp \
 	src/TextUtfEncoding.cpp \
+	src/Trace.cpp \
+	src/ViewLuminanceSource.cpp \
 	src/WhiteRectDetector.cpp \
 	src/ZXBigInteger.cpp
 
@@ -46,6 +57,7 @@ DATAMATRIX_FILES :=	\
 	src/datamatrix/DMBitMatrixParser.cpp \
 	src/datamatrix/DMDataBlock.cpp \
 	src/datamatrix/DMDecoder.cpp \
+	src/datamatrix/DMDefaultPlacement.cpp \
 	src/datamatrix/DMDetector.cpp \
 	src/datamatrix/DMReader.cpp \
 	src/datamatrix/DMVersion.cpp
@@ -53,6 +65,7 @@ DATAMATRIX_FILES :=	\
 MAXICODE_FILES := \
 	src/maxicode/MCBitMatrixParser.cpp \
 	src/maxicode/MCDecoder.cpp \
+	src/maxicode/MCDetector.cpp \
 	src/maxicode/MCReader.cpp
 	
 ONED_FILES := \
@@ -78,7 +91,6 @@ ONED_FILES := \
 
 ONED_RSS_FILES := \
 	src/oned/rss/ODRSSExpandedBinaryDecoder.cpp \
-	src/oned/rss/ODRSSFieldParser.cpp \
 	src/oned/rss/ODRSSGenericAppIdDecoder.cpp \
 	src/oned/rss/ODRSSReaderHelper.cpp
 
@@ -90,6 +102,7 @@ PDF417_FILES := \
 	src/pdf417/PDFDetectionResult.cpp \
 	src/pdf417/PDFDetectionResultColumn.cpp \
 	src/pdf417/PDFDetector.cpp \
+	src/pdf417/PDFMacroAssembler.cpp \
 	src/pdf417/PDFModulusGF.cpp \
 	src/pdf417/PDFModulusPoly.cpp \
 	src/pdf417/PDFReader.cpp \
@@ -109,6 +122,7 @@ QRCODE_FILES := \
 	src/qrcode/QRFinderPatternFinder.cpp \
 	src/qrcode/QRFormatInformation.cpp \
 	src/qrcode/QRReader.cpp \
+	src/qrcode/QRStructuredAppend.cpp \
 	src/qrcode/QRVersion.cpp
 
 TEXT_CODEC_FILES := \
@@ -0,0 +1,169 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "AsyncBarcodeReader.h"
+#include "ZXContainerAlgorithms.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+namespace ZXing {
+
+AsyncBarcodeReader::AsyncBarcodeReader(const DecodeHints& hints, int workers, int queueSize)
+	: _scanner(hints), _queueSize(std::max(1, queueSize))
+{
+	for (int i = 0; i < std::max(1, workers); ++i)
+		_workers.emplace_back(&AsyncBarcodeReader::work, this);
+}
+
+AsyncBarcodeReader::~AsyncBarcodeReader()
+{
+	std::deque<Frame> dropped;
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stop = true;
+		_stats.dropped += _queue.size();
+		_pending -= static_cast<int>(_queue.size());
+		dropped.swap(_queue);
+	}
+	_frameReady.notify_all();
+	for (auto& frame : dropped)
+		frame.callback({}, true);
+	for (auto& worker : _workers)
+		worker.join();
+}
+
+void AsyncBarcodeReader::submit(const ImageView& iv, Callback callback)
+{
+	Frame frame;
+	frame.width = iv.width();
+	frame.height = iv.height();
+	frame.format = iv.format();
+	frame.pixStride = iv.pixStride();
+	// only the bytes of the pixels themselves, not the padding at the end of each row
+	if (iv.format() == ImageFormat::Mono12Packed)
+		frame.rowStride = (iv.width() * 3 + 1) / 2;
+	else
+		frame.rowStride = iv.width() > 0 ? (iv.width() - 1) * iv.pixStride() + PixStride(iv.format()) : 0;
+	frame.callback = std::move(callback);
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		if (!_buffers.empty()) {
+			frame.pixels = std::move(_buffers.back());
+			_buffers.pop_back();
+		}
+	}
+	frame.pixels.resize(frame.rowStride * frame.height);
+	for (int y = 0; y < frame.height; ++y)
+		std::memcpy(frame.pixels.data() + y * frame.rowStride, iv.data(0, y), frame.rowStride);
+	frame.submitted = Clock::now();
+
+	Frame dropped;
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		++_stats.submitted;
+		++_pending;
+		// latest frame wins
+		if (Size(_queue) >= _queueSize) {
+			dropped = std::move(_queue.front());
+			_queue.pop_front();
+			++_stats.dropped;
+			_buffers.push_back(std::move(dropped.pixels));
+		}
+		_queue.push_back(std::move(frame));
+		_stats.maxQueueLength = std::max(_stats.maxQueueLength, Size(_queue));
+	}
+	_frameReady.notify_one();
+
+	if (dropped.callback) {
+		dropped.callback({}, true);
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			--_pending;
+		}
+		_idle.notify_all();
+	}
+}
+
+std::future<Results> AsyncBarcodeReader::submit(const ImageView& frame)
+{
+	auto promise = std::make_shared<std::promise<Results>>();
+	submit(frame, [promise](Results&& results, bool) { promise->set_value(std::move(results)); });
+	return promise->get_future();
+}
+
+void AsyncBarcodeReader::work()
+{
+	for (;;) {
+		Frame frame;
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_frameReady.wait(lock, [this] { return _stop || !_queue.empty(); });
+			if (_queue.empty())
+				return;
+			frame = std::move(_queue.front());
+			_queue.pop_front();
+		}
+
+		auto results = _scanner.readMultiple(
+			{frame.pixels.data(), frame.width, frame.height, frame.format, frame.rowStride, frame.pixStride});
+		auto latency = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - frame.submitted);
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			++_stats.decoded;
+			_stats.totalLatency += latency;
+			_stats.maxLatency = std::max(_stats.maxLatency, latency);
+			_buffers.push_back(std::move(frame.pixels));
+		}
+
+		frame.callback(std::move(results), false);
+
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			--_pending;
+		}
+		_idle.notify_all();
+	}
+}
+
+void AsyncBarcodeReader::wait()
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	_idle.wait(lock, [this] { return _pending == 0; });
+}
+
+int AsyncBarcodeReader::queueLength() const
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	return Size(_queue);
+}
+
+AsyncBarcodeReader::Stats AsyncBarcodeReader::stats() const
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _stats;
+}
+
+void AsyncBarcodeReader::resetStats()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	_stats = {};
+}
+
+} // ZXing
@@ -0,0 +1,125 @@
+#pragma once
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "DecodeHints.h"
+#include "ReadBarcode.h"
+#include "Result.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ZXing {
+
+/**
+ * Decodes frames on a pool of worker threads without blocking the thread that submits them.
+ *
+ * submit() copies the frame into an internal buffer and returns right away. The frames wait in a bounded queue. When
+ * it is full, the oldest waiting frame is dropped in favor of the new one (latest frame wins), so the latency stays
+ * bounded if the decoding can't keep up. Each worker runs the complete pipeline of one frame (luminance conversion,
+ * binarization, detection and decoding) with a BarcodeScanner shared by all workers, so with N workers up to N frames
+ * are in different stages at the same time.
+ */
+class AsyncBarcodeReader
+{
+public:
+	/**
+	 * Receives the results of a frame on the worker thread that decoded it. A frame dropped from the queue gets empty
+	 * results and dropped set, on the thread that submitted the frame that replaced it (or that destroys the reader).
+	 */
+	using Callback = std::function<void(Results&& results, bool dropped)>;
+
+	struct Stats
+	{
+		int64_t submitted = 0;
+		int64_t decoded = 0;
+		int64_t dropped = 0;
+		int maxQueueLength = 0;                     ///< most frames waiting at once
+		std::chrono::microseconds totalLatency{0}; ///< sum of the times from submit() to the callback of decoded frames
+		std::chrono::microseconds maxLatency{0};
+
+		std::chrono::microseconds meanLatency() const { return decoded ? totalLatency / decoded : totalLatency; }
+	};
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	struct Frame
+	{
+		std::vector<uint8_t> pixels;
+		int width, height, rowStride, pixStride;
+		ImageFormat format;
+		Callback callback;
+		Clock::time_point submitted;
+	};
+
+	BarcodeScanner _scanner;
+	const int _queueSize;
+	mutable std::mutex _mutex;
+	std::condition_variable _frameReady, _idle;
+	std::deque<Frame> _queue;
+	std::vector<std::vector<uint8_t>> _buffers;
+	std::vector<std::thread> _workers;
+	int _pending = 0; // frames waiting or being decoded
+	bool _stop = false;
+	Stats _stats;
+
+	void work();
+
+public:
+	/**
+	 * @param hints  DecodeHints for all frames
+	 * @param workers  number of worker threads
+	 * @param queueSize  number of frames that may wait for a worker
+	 */
+	explicit AsyncBarcodeReader(const DecodeHints& hints = {}, int workers = 1, int queueSize = 2);
+
+	/// Drops the waiting frames and waits for the ones being decoded
+	~AsyncBarcodeReader();
+
+	AsyncBarcodeReader(const AsyncBarcodeReader&) = delete;
+	AsyncBarcodeReader& operator=(const AsyncBarcodeReader&) = delete;
+
+	/**
+	 * Queue a frame for decoding, all barcodes in it are read (at most hints().maxNumberOfSymbols())
+	 *
+	 * @param frame  view of the image data including layout and format, copied before returning
+	 * @param callback  called exactly once with the results of the frame or when it is dropped
+	 */
+	void submit(const ImageView& frame, Callback callback);
+
+	/// Queue a frame for decoding, the future holds empty results if the frame is dropped
+	std::future<Results> submit(const ImageView& frame);
+
+	/// Wait until every submitted frame is decoded or dropped and its callback returned
+	void wait();
+
+	/// Number of frames waiting for a worker
+	int queueLength() const;
+
+	Stats stats() const;
+	void resetStats();
+};
+
+} // ZXing
@@ -0,0 +1,310 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "BarcodeTracker.h"
+#include "ZXContainerAlgorithms.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace ZXing {
+
+// the window around a tracked symbol extends by half its size (at least this many pixels) into every direction
+static constexpr int MIN_SEARCH_MARGIN = 16;
+
+// the frame gating compares frames on a grid of GATE_BLOCK x GATE_BLOCK pixels, sampling every GATE_ROW_STEP-th row
+static constexpr int GATE_BLOCK = 16;
+static constexpr int GATE_ROW_STEP = 4;
+// a block changed if its mean luminance or edge strength differs by more than this from the previous frame
+static constexpr int GATE_MIN_CHANGE = 8;
+// the mean absolute gradient of a block that may contain (part of) a barcode
+static constexpr int GATE_MIN_EDGES = 10;
+
+BarcodeTracker::BarcodeTracker(const DecodeHints& hints, int rescanInterval)
+	: _hints(hints), _scanner(hints), _rescanInterval(std::max(1, rescanInterval))
+{}
+
+const BarcodeScanner& BarcodeTracker::formatScanner(BarcodeFormat format, bool decodeText)
+{
+	auto key = std::make_pair(format, decodeText);
+	auto i = _formatScanners.find(key);
+	if (i == _formatScanners.end()) {
+		// the window is cropped here, the regions of interest of the full frame don't apply to it
+		auto hints = DecodeHints(_hints).setFormats(format).setRegionsOfInterest({}).setMaxNumberOfSymbols(1);
+		hints.setSkipTextDecoding(_hints.skipTextDecoding() || !decodeText);
+		i = _formatScanners.emplace(key, BarcodeScanner(hints)).first;
+	}
+	return i->second;
+}
+
+Result BarcodeTracker::readTrack(const ImageView& iv, const Track& track)
+{
+	auto& pos = track.position;
+	auto xs = std::minmax({pos[0].x, pos[1].x, pos[2].x, pos[3].x});
+	auto ys = std::minmax({pos[0].y, pos[1].y, pos[2].y, pos[3].y});
+	int margin = std::max(MIN_SEARCH_MARGIN, std::max(xs.second - xs.first, ys.second - ys.first) / 2);
+
+	int left = std::max(0, xs.first - margin);
+	int top = std::max(0, ys.first - margin);
+	int right = std::min(iv.width(), xs.second + margin + 1);
+	int bottom = std::min(iv.height(), ys.second + margin + 1);
+	if (right <= left || bottom <= top)
+		return Result(DecodeStatus::NotFound);
+
+	auto window = iv.cropped(left, top, right - left, bottom - top);
+	auto read = [&](bool decodeText) {
+		auto result = formatScanner(track.format, decodeText).read(window);
+		if (result.isValid()) {
+			auto p = result.position();
+			for (auto& c : p)
+				c = c + PointI(left, top);
+			result.setPosition(p);
+		}
+		return result;
+	};
+
+	// while the symbol keeps repeating, its raw bytes are enough to recognize it
+	bool detectRepeats = _repeatTimeout.count() > 0;
+	auto result = read(!detectRepeats);
+	if (result.isValid() && detectRepeats && !repeat(result) && result.text().empty() && !_hints.skipTextDecoding())
+		result = read(true);
+	return result;
+}
+
+static bool SameSymbol(const Result& a, const Result& b)
+{
+	if (a.format() != b.format())
+		return false;
+	// not all readers fill the raw bytes (e.g. the 1D ones), the text of those is cheap
+	if (!a.rawBytes().empty() || !b.rawBytes().empty() ? a.rawBytes() != b.rawBytes() : a.text() != b.text())
+		return false;
+
+	// about the same position: the centers are less than the size of the symbol apart
+	auto& pos = b.position();
+	double size = std::max({distance(pos[0], pos[1]), distance(pos[1], pos[2]), double(MIN_SEARCH_MARGIN)});
+	return distance(Center(a.position()), Center(pos)) < size;
+}
+
+bool BarcodeTracker::repeat(Result& result)
+{
+	auto seen = FindIf(_seen, [&result](const Seen& s) { return SameSymbol(result, s.result); });
+	if (seen == _seen.end())
+		return false;
+
+	seen->result.setPosition(result.position());
+	seen->time = _now;
+	result = seen->result;
+	result.setIsRepeat(true);
+	return true;
+}
+
+void BarcodeTracker::remember(Results& results)
+{
+	if (_repeatTimeout.count() <= 0)
+		return;
+	for (auto& result : results)
+		if (result.isValid() && !result.isRepeat() && !repeat(result))
+			_seen.push_back({result, _now});
+}
+
+void BarcodeTracker::startFrame()
+{
+	_now = Clock::now();
+	_seen.erase(std::remove_if(_seen.begin(), _seen.end(),
+							   [this](const Seen& s) { return _now - s.time > _repeatTimeout; }),
+				_seen.end());
+}
+
+void BarcodeTracker::setTracks(const Results& results)
+{
+	_tracks.clear();
+	for (auto& result : results)
+		if (result.isValid())
+			_tracks.push_back({result.position(), result.format()});
+}
+
+bool BarcodeTracker::frameChanged(const ImageView& iv, ImageRegion& changes)
+{
+	const int width = iv.width() / GATE_BLOCK;
+	const int height = iv.height() / GATE_BLOCK;
+	const int channel = GreenIndex(iv.format());
+	const int pixStride = iv.pixStride();
+	const bool sameSize = width == _thumbnailWidth && height == _thumbnailHeight;
+
+	std::vector<uint8_t> thumbnail(2 * width * height);
+	bool changed = !sameSize || width == 0 || height == 0;
+	int left = width, top = height, right = -1, bottom = -1;
+	for (int by = 0; by < height; ++by)
+		for (int bx = 0; bx < width; ++bx) {
+			// horizontal and vertical differences to the neighboring pixels, all stay inside the image
+			int sum = 0, edges = 0, count = 0;
+			for (int y = by * GATE_BLOCK; y < (by + 1) * GATE_BLOCK; y += GATE_ROW_STEP) {
+				const uint8_t* p = iv.data(bx * GATE_BLOCK, y) + channel;
+				for (int x = 0; x < GATE_BLOCK - 1; ++x, p += pixStride, ++count) {
+					sum += p[0];
+					edges += std::abs(p[pixStride] - p[0]) + std::abs(p[iv.rowStride()] - p[0]);
+				}
+			}
+			int i = 2 * (by * width + bx);
+			thumbnail[i] = static_cast<uint8_t>(sum / count);
+			thumbnail[i + 1] = static_cast<uint8_t>(std::min(255, edges / count));
+			if (sameSize && std::abs(thumbnail[i] - _thumbnail[i]) <= GATE_MIN_CHANGE &&
+				std::abs(thumbnail[i + 1] - _thumbnail[i + 1]) <= GATE_MIN_CHANGE)
+				continue;
+			changed = true;
+			if (thumbnail[i + 1] >= GATE_MIN_EDGES) {
+				left = std::min(left, bx);
+				top = std::min(top, by);
+				right = std::max(right, bx);
+				bottom = std::max(bottom, by);
+			}
+		}
+
+	_thumbnail = std::move(thumbnail);
+	_thumbnailWidth = width;
+	_thumbnailHeight = height;
+
+	if (width == 0 || height == 0) // frame smaller than a block
+		changes = {0, 0, iv.width(), iv.height()};
+	else if (right < 0)
+		changes = {0, 0, 0, 0};
+	else {
+		// one block of margin for the parts of a symbol with few edges (e.g. its quiet zone)
+		left = std::max(0, left - 1) * GATE_BLOCK;
+		top = std::max(0, top - 1) * GATE_BLOCK;
+		right = std::min(iv.width(), (right + 2) * GATE_BLOCK);
+		bottom = std::min(iv.height(), (bottom + 2) * GATE_BLOCK);
+		changes = {left, top, right - left, bottom - top};
+	}
+	return changed;
+}
+
+bool BarcodeTracker::skipFrame(const ImageView& iv, Results& results)
+{
+	_skipped = false;
+	_scanRegion = {0, 0, iv.width(), iv.height()};
+	if (!_gateFrames)
+		return false;
+
+	ImageRegion changes;
+	if (!frameChanged(iv, changes)) {
+		// the symbols are still there
+		results = _lastResults;
+		for (auto& result : results)
+			if (!repeat(result))
+				result.setIsRepeat(false);
+		_skipped = true;
+	} else if (_tracks.empty()) {
+		if (changes.width == 0)
+			_skipped = true;
+		else if (_hints.regionsOfInterest().empty())
+			_scanRegion = changes;
+	}
+	if (_skipped)
+		_tracked = false;
+	return _skipped;
+}
+
+Results BarcodeTracker::scan(const ImageView& iv, bool multiple)
+{
+	auto& region = _scanRegion;
+	auto view = iv.cropped(region.left, region.top, region.width, region.height);
+	auto results = multiple ? _scanner.readMultiple(view) : Results{_scanner.read(view)};
+	for (auto& result : results) {
+		auto p = result.position();
+		for (auto& c : p)
+			c = c + PointI(region.left, region.top);
+		result.setPosition(p);
+	}
+	return results;
+}
+
+void BarcodeTracker::finishFrame(Results& results)
+{
+	remember(results);
+	setTracks(results);
+	_lastResults.clear();
+	for (auto& result : results)
+		if (result.isValid())
+			_lastResults.push_back(result);
+}
+
+Result BarcodeTracker::read(const ImageView& iv)
+{
+	startFrame();
+	Results results;
+	if (!skipFrame(iv, results)) {
+		for (auto& track : _tracks) {
+			auto result = readTrack(iv, track);
+			if (result.isValid()) {
+				results.push_back(std::move(result));
+				break;
+			}
+		}
+
+		_tracked = !results.empty();
+		if (!_tracked)
+			results = scan(iv, false);
+		finishFrame(results);
+	}
+	return results.empty() ? Result(DecodeStatus::NotFound) : results.front();
+}
+
+Results BarcodeTracker::readMultiple(const ImageView& iv)
+{
+	startFrame();
+	Results results;
+	if (skipFrame(iv, results))
+		return results;
+
+	if (!_tracks.empty() && ++_framesSinceScan < _rescanInterval) {
+		for (auto& track : _tracks) {
+			auto result = readTrack(iv, track);
+			// a window may contain a neighboring symbol instead of the tracked one
+			auto same = [&result](const Result& r) {
+				return r.format() == result.format() && r.text() == result.text();
+			};
+			if (!result.isValid() || FindIf(results, same) != results.end())
+				break;
+			results.push_back(std::move(result));
+		}
+		if (results.size() == _tracks.size()) {
+			finishFrame(results);
+			_tracked = true;
+			return results;
+		}
+	}
+
+	results = scan(iv, true);
+	finishFrame(results);
+	_framesSinceScan = 0;
+	_tracked = false;
+	return results;
+}
+
+void BarcodeTracker::reset()
+{
+	_tracks.clear();
+	_seen.clear();
+	_lastResults.clear();
+	_thumbnail.clear();
+	_thumbnailWidth = _thumbnailHeight = 0;
+	_framesSinceScan = 0;
+	_tracked = false;
+}
+
+} // ZXing
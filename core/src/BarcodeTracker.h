@@ -0,0 +1,145 @@
+#pragma once
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "BarcodeFormat.h"
+#include "DecodeHints.h"
+#include "ReadBarcode.h"
+#include "Result.h"
+
+#include <chrono>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace ZXing {
+
+/**
+ * A barcode reader for consecutive frames of a video stream.
+ *
+ * Between two frames a symbol usually moves only a few pixels. The tracker remembers the format and Position of every
+ * symbol it found and first looks for it again in a window around its last Position with a reader restricted to that
+ * format. Only if a tracked symbol is lost (or every rescanInterval frames in readMultiple(), to pick up new symbols)
+ * the whole frame is scanned with all requested formats.
+ *
+ * A symbol decoded again at about the same position within the repeat timeout is recognized from its format and raw
+ * bytes alone and returned as a copy of the earlier Result with isRepeat() set. For QR Codes the tracked reads then
+ * skip the text decoding (see DecodeHints::skipTextDecoding).
+ *
+ * With frame gating enabled, each frame is first compared to the previous one on a coarse grid, see setFrameGating().
+ *
+ * Unlike BarcodeScanner, a tracker holds per-stream state and must not be used concurrently from multiple threads.
+ */
+class BarcodeTracker
+{
+	using Clock = std::chrono::steady_clock;
+
+	struct Track
+	{
+		Position position;
+		BarcodeFormat format;
+	};
+
+	// a symbol returned within the last repeat timeout
+	struct Seen
+	{
+		Result result;
+		Clock::time_point time;
+	};
+
+	DecodeHints _hints;
+	BarcodeScanner _scanner;
+	std::map<std::pair<BarcodeFormat, bool>, BarcodeScanner> _formatScanners;
+	std::vector<Track> _tracks;
+	std::vector<Seen> _seen;
+	Results _lastResults;
+	// mean luminance and edge strength of each GATE_BLOCK x GATE_BLOCK block of the previous frame
+	std::vector<uint8_t> _thumbnail;
+	int _thumbnailWidth = 0, _thumbnailHeight = 0;
+	ImageRegion _scanRegion = {};
+	std::chrono::milliseconds _repeatTimeout{1000};
+	Clock::time_point _now;
+	int _rescanInterval;
+	int _framesSinceScan = 0;
+	bool _tracked = false;
+	bool _gateFrames = false;
+	bool _skipped = false;
+
+	const BarcodeScanner& formatScanner(BarcodeFormat format, bool decodeText);
+	Result readTrack(const ImageView& buffer, const Track& track);
+	bool repeat(Result& result);
+	void remember(Results& results);
+	void setTracks(const Results& results);
+	void startFrame();
+	bool frameChanged(const ImageView& buffer, ImageRegion& changes);
+	bool skipFrame(const ImageView& buffer, Results& results);
+	Results scan(const ImageView& buffer, bool multiple);
+	void finishFrame(Results& results);
+
+public:
+	/**
+	 * @param hints  DecodeHints used for the full frame scans, the tracked reads use them restricted to one format
+	 * @param rescanInterval  readMultiple() scans the full frame at least every rescanInterval frames
+	 */
+	explicit BarcodeTracker(const DecodeHints& hints = {}, int rescanInterval = 30);
+
+	const DecodeHints& hints() const { return _hints; }
+
+	/**
+	 * Read the tracked barcode from the next frame, falling back to a full scan if it is lost
+	 *
+	 * @param buffer  view of the frame including layout and format
+	 * @return #Result structure
+	 */
+	Result read(const ImageView& buffer);
+
+	/**
+	 * Read all barcodes from the next frame, at most hints().maxNumberOfSymbols()
+	 *
+	 * @param buffer  view of the frame including layout and format
+	 * @return list of valid #Result structures, possibly empty
+	 */
+	Results readMultiple(const ImageView& buffer);
+
+	/// Whether the last frame was read from the tracked positions alone, without a full scan
+	bool lastFrameTracked() const { return _tracked; }
+
+	/**
+	 * Time after which a symbol seen again is reported as new (default 1s), each sighting restarts it. 0 disables the
+	 * repeat detection.
+	 */
+	void setRepeatTimeout(std::chrono::milliseconds timeout) { _repeatTimeout = timeout; }
+	std::chrono::milliseconds repeatTimeout() const { return _repeatTimeout; }
+
+	/**
+	 * Compare each frame to the previous one on a coarse grid before decoding anything (default off). Meant for fixed
+	 * cameras where most frames show an unchanged scene. A frame without changes returns the results of the previous
+	 * one. A frame whose changes contain no strong edges, i.e. nothing that could be a new barcode, returns no results
+	 * unless a symbol is tracked. While nothing is tracked, the full scan is restricted to the changed part of the
+	 * frame.
+	 */
+	void setFrameGating(bool gate) { _gateFrames = gate; }
+	bool frameGating() const { return _gateFrames; }
+
+	/// Whether the last frame was answered by the frame gating alone, without decoding
+	bool lastFrameSkipped() const { return _skipped; }
+
+	/// Forget all tracked and seen symbols, e.g. after a cut in the video, the next frame is scanned completely
+	void reset();
+};
+
+} // ZXing
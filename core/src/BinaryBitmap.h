@@ -17,9 +17,13 @@
 */
 
 #include "BitArray.h"
+#include "EdgeOrientation.h"
 #include "Pattern.h"
+#include "RunLengthIndex.h"
 
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <stdexcept>
 
 namespace ZXing {
@@ -35,6 +39,40 @@ class BitMatrix;
 */
 class BinaryBitmap
 {
+	// Keeps the result of the first call alive for getBitMatrix() and getRunLengths(). Like std::call_once, but it can
+	// be reset (not while other threads use it).
+	template <typename T>
+	class Cached
+	{
+		std::atomic<bool> _done{false};
+		std::mutex _mutex;
+		std::shared_ptr<const T> _value;
+
+	public:
+		template <typename F>
+		const T* get(F compute)
+		{
+			if (!_done.load(std::memory_order_acquire)) {
+				std::lock_guard<std::mutex> lock(_mutex);
+				if (!_done.load(std::memory_order_relaxed)) {
+					_value = compute();
+					_done.store(true, std::memory_order_release);
+				}
+			}
+			return _value.get();
+		}
+
+		void reset()
+		{
+			_value.reset();
+			_done = false;
+		}
+	};
+
+	mutable Cached<BitMatrix> _bitMatrix;
+	mutable Cached<RunLengthIndex> _runLengths;
+	mutable Cached<EdgeOrientation> _edgeOrientation;
+
 public:
 	virtual ~BinaryBitmap() = default;
 
@@ -70,8 +108,10 @@ public:
 	{
 		res.clear();
 		BitArray row;
-		getBlackRow(y, row);
+		if (!getBlackRow(y, row))
+			return false;
 
+		// run lengths of alternating white and black pixels, the first and the last one are white (possibly 0)
 		auto li = row.begin();
 		auto i = li;
 		if( *i )
@@ -81,10 +121,23 @@ public:
 			li = i;
 		}
 		res.push_back(i - li);
+		if (res.size() % 2 == 0)
+			res.push_back(0);
 
 		return true;
 	}
 
+	/**
+	* Like getPatternRow but additionally returns the widths of the same elements with sub-pixel precision, where the
+	* edges are interpolated between the two pixels around each crossing of the threshold. 'widths' stays empty if
+	* the implementation does not support it, as this default one.
+	*/
+	virtual bool getSubPixelPatternRow(int y, PatternRow& res, SubPixelPatternRow& widths) const
+	{
+		widths.clear();
+		return getPatternRow(y, res);
+	}
+
 	/**
 	* Converts a 2D array of luminance data to 1 bit. This method is intended for decoding 2D
 	* barcodes and may or may not apply sharpening. Therefore, a row from this matrix may not be
@@ -95,6 +148,49 @@ public:
 	*/
 	virtual std::shared_ptr<const BitMatrix> getBlackMatrix() const = 0;
 
+	/**
+	* Run lengths of all rows and columns of getBlackMatrix(), see RunLengthIndex. Implementations cache it next to
+	* the matrix so that every reader looking at the same image shares one scan of it. This default
+	* implementation computes a new one on every call.
+	*
+	* @return null if image can't be binarized to make a matrix
+	*/
+	virtual std::shared_ptr<const RunLengthIndex> getRunLengthIndex() const
+	{
+		auto matrix = getBlackMatrix();
+		return matrix ? std::make_shared<const RunLengthIndex>(*matrix) : nullptr;
+	}
+
+	/**
+	* Non-owning access to getBlackMatrix(), valid as long as this bitmap. Only the first call goes through the
+	* shared_ptr, so the readers sharing one image (possibly on several threads) do not touch its reference count.
+	*
+	* @return null if image can't be binarized to make a matrix
+	*/
+	const BitMatrix* getBitMatrix() const
+	{
+		return _bitMatrix.get([this]() { return getBlackMatrix(); });
+	}
+
+	/**
+	* Non-owning access to getRunLengthIndex(), like getBitMatrix().
+	*
+	* @return null if image can't be binarized to make a matrix
+	*/
+	const RunLengthIndex* getRunLengths() const
+	{
+		return _runLengths.get([this]() { return getRunLengthIndex(); });
+	}
+
+	/**
+	* The directions of the edges in the image, see EdgeOrientation. Computed from a few black rows on the first call
+	* and shared like getBitMatrix(), so the readers can agree on whether to scan the rows or the columns first.
+	*/
+	const EdgeOrientation& getEdgeOrientation() const
+	{
+		return *_edgeOrientation.get([this]() { return std::make_shared<const EdgeOrientation>(*this); });
+	}
+
 	/**
 	* @return Whether this bitmap can be cropped.
 	*/
@@ -122,7 +218,8 @@ public:
 
 	/**
 	* Returns a new object with rotated image data by 90 degrees clockwise.
-	* Only callable if {@link #isRotateSupported()} is true.
+	* Only callable if {@link #isRotateSupported()} is true. The binarizers return views that rotate their already
+	* binarized matrix instead of binarizing a rotated copy of the image (the same holds for cropped()).
 	*
 	* @param degreeCW degree in clockwise direction, possible values are 90, 180 and 270
 	* @return A rotated version of this object.
@@ -131,6 +228,15 @@ public:
 	{
 		throw std::runtime_error("This binarizer does not support rotation.");
 	}
+
+protected:
+	/// For implementations whose black matrix changes: getBitMatrix() and the values derived from it are recomputed
+	void resetBitMatrix()
+	{
+		_bitMatrix.reset();
+		_runLengths.reset();
+		_edgeOrientation.reset();
+	}
 };
 
 } // ZXing
@@ -16,19 +16,38 @@
 */
 
 #include "BitArray.h"
+#include "BitHacks.h"
 #include "ByteArray.h"
 
+#include <algorithm>
 #include <cstddef>
+#include <cstring>
 #include <stdexcept>
 
-#ifndef ZX_FAST_BIT_STORAGE
-#include "BitHacks.h"
-#include <algorithm>
-#endif
-
 namespace ZXing {
 
-#ifndef ZX_FAST_BIT_STORAGE
+#ifdef ZX_FAST_BIT_STORAGE
+
+void
+BitArray::reverse()
+{
+	// swap 8 bytes from both ends at a time, reversing their order on the way
+	uint8_t* first = _bits.data();
+	uint8_t* last = first + _bits.size();
+	for (; last - first >= 16; first += 8) {
+		last -= 8;
+		uint64_t a, b;
+		std::memcpy(&a, first, 8);
+		std::memcpy(&b, last, 8);
+		a = BitHacks::ByteSwap(a);
+		b = BitHacks::ByteSwap(b);
+		std::memcpy(first, &b, 8);
+		std::memcpy(last, &a, 8);
+	}
+	std::reverse(first, last);
+}
+
+#else
 
 bool
 BitArray::isRange(int start, int end, bool value) const
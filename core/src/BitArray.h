@@ -24,6 +24,7 @@
 #endif
 
 #include <cstdint>
+#include <cstring>
 #include <iterator>
 #include <vector>
 #include <algorithm>
@@ -179,9 +180,28 @@ public:
 	Iterator begin() const noexcept { return _bits.cbegin(); }
 	Iterator end() const noexcept { return _bits.cend(); }
 
-	template <typename ITER>
-	static ITER getNextSetTo(ITER begin, ITER end, bool v) noexcept {
-		while( begin != end && *begin != static_cast<int>(v) )
+	// The bytes are 0 or 1, so xor-ing 8 of them with the pattern of the ones that are skipped leaves a non-zero word
+	// as soon as one of them matches. The byte loop then only has to look at the last 8 bytes.
+	static Iterator getNextSetTo(Iterator begin, Iterator end, bool v) noexcept {
+		const uint64_t skipped = v ? 0 : 0x0101010101010101;
+		for (uint64_t w; end - begin >= 8; begin += 8) {
+			std::memcpy(&w, &*begin, 8);
+			if (w != skipped)
+				break;
+		}
+		while (begin != end && *begin != static_cast<int>(v))
+			++begin;
+		return begin;
+	}
+
+	static ReverseIterator getNextSetTo(ReverseIterator begin, ReverseIterator end, bool v) noexcept {
+		const uint64_t skipped = v ? 0 : 0x0101010101010101;
+		for (uint64_t w; end - begin >= 8; begin += 8) {
+			std::memcpy(&w, &*(begin.base() - 8), 8);
+			if (w != skipped)
+				break;
+		}
+		while (begin != end && *begin != static_cast<int>(v))
 			++begin;
 		return begin;
 	}
@@ -238,6 +258,19 @@ public:
 #endif
 	}
 
+	/**
+	* Clears bit i.
+	*
+	* @param i bit to clear
+	*/
+	void unset(int i) {
+#ifdef ZX_FAST_BIT_STORAGE
+		_bits.at(i) = 0;
+#else
+		_bits.at(i >> 5) &= ~(1 << (i & 0x1F));
+#endif
+	}
+
 	/**
 	* Clears all bits (sets to false).
 	*/
@@ -307,9 +340,7 @@ public:
 	/**
 	* Reverses all bits in the array.
 	*/
-	void reverse() {
-		std::reverse(_bits.begin(), _bits.end());
-	}
+	void reverse();
 #else
 	void appendBits(int value, int numBits);
 
@@ -91,6 +91,33 @@ inline uint32_t Reverse(uint32_t v)
 #endif
 }
 
+inline uint64_t ByteSwap(uint64_t v)
+{
+#ifdef ZX_HAS_GCC_BUILTINS
+	return __builtin_bswap64(v);
+#else
+	v = ((v >> 8) & 0x00FF00FF00FF00FFull) | ((v & 0x00FF00FF00FF00FFull) << 8);
+	v = ((v >> 16) & 0x0000FFFF0000FFFFull) | ((v & 0x0000FFFF0000FFFFull) << 16);
+	return (v >> 32) | (v << 32);
+#endif
+}
+
+/// <summary>
+/// Transpose a 32x32 bit matrix in place, bit c of a[r] (least significant first) becomes bit r of a[c].
+/// See "Hacker's Delight", section 7-3: the off-diagonal blocks of size 16, 8, 4, 2 and 1 are swapped in turn.
+/// </summary>
+inline void Transpose32(uint32_t* a)
+{
+	uint32_t m = 0x0000FFFF;
+	for (int j = 16; j != 0; j >>= 1, m ^= m << j) {
+		for (int k = 0; k < 32; k = ((k | j) + 1) & ~j) {
+			uint32_t t = ((a[k] >> j) ^ a[k | j]) & m;
+			a[k] ^= t << j;
+			a[k | j] ^= t;
+		}
+	}
+}
+
 inline int CountBitsSet(uint32_t v)
 {
 #ifdef ZX_HAS_GCC_BUILTINS
@@ -110,8 +137,8 @@ inline int HighestBitSet(uint32_t v)
 
 // shift a whole array of bits by offset bits to the right (thinking of the array as a contiguous stream of bits
 // starting with the LSB of the first int and ending with the MSB of the last int, this is actually a left shift)
-template <typename T>
-void ShiftRight(std::vector<T>& bits, std::size_t offset)
+template <typename T, typename A>
+void ShiftRight(std::vector<T, A>& bits, std::size_t offset)
 {
 	assert(offset < sizeof(T) * 8);
 
@@ -126,8 +153,8 @@ void ShiftRight(std::vector<T>& bits, std::size_t offset)
 }
 
 // reverse a whole array of bits. padding is the number of 'dummy' bits at the end of the array
-template <typename T>
-void Reverse(std::vector<T>& bits, std::size_t padding)
+template <typename T, typename A>
+void Reverse(std::vector<T, A>& bits, std::size_t padding)
 {
 	static_assert(sizeof(T) == sizeof(uint32_t), "Reverse only implemented for 32 bit types");
 
@@ -18,12 +18,17 @@
 #include "BitMatrix.h"
 #include "BitArray.h"
 #include "ByteMatrix.h"
+#include "CpuFeatures.h"
 
 #ifndef ZX_FAST_BIT_STORAGE
 #include "BitHacks.h"
 #endif
 
 #include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
 #include <stdexcept>
 #include <utility>
 
@@ -40,6 +45,53 @@ BitMatrix::getRow(int y, BitArray& row) const
 	std::copy_n(_bits.begin() + y * _rowSize, _rowSize, row._bits.begin());
 }
 
+void
+BitMatrix::setRow(int y, const BitArray& row)
+{
+	if (y < 0 || y >= _height || row.size() != _width) {
+		throw std::out_of_range("BitMatrix::setRow(): Invalid row");
+	}
+	std::copy_n(row._bits.begin(), _rowSize, _bits.begin() + y * _rowSize);
+}
+
+bool
+BitMatrix::isRowRange(int y, int begin, int end, bool value) const
+{
+	if (y < 0 || y >= _height || begin < 0 || end > _width || end < begin) {
+		throw std::out_of_range("BitMatrix::isRowRange(): Invalid range");
+	}
+	const data_t* row = _bits.data() + y * _rowSize;
+#ifdef ZX_FAST_BIT_STORAGE
+	int x = begin;
+	if (!value) {
+		// 8 pixels at a time, white ones are 0 bytes
+		for (; x + 8 <= end; x += 8) {
+			uint64_t word;
+			std::memcpy(&word, row + x, sizeof(word));
+			if (word)
+				return false;
+		}
+	}
+	for (; x < end; ++x)
+		if ((row[x] != 0) != value)
+			return false;
+	return true;
+#else
+	if (end == begin)
+		return true;
+	// see BitArray::isRange
+	int last = end - 1;
+	for (int i = begin / 32; i <= last / 32; i++) {
+		int firstBit = i > begin / 32 ? 0 : begin & 0x1F;
+		int lastBit = i < last / 32 ? 31 : last & 0x1F;
+		uint32_t mask = static_cast<uint32_t>((2ULL << lastBit) - (1ULL << firstBit));
+		if ((row[i] & mask) != (value ? mask : 0U))
+			return false;
+	}
+	return true;
+#endif
+}
+
 ByteMatrix BitMatrix::toByteMatrix(int black, int white) const
 {
 	ByteMatrix res(width(), height());
@@ -75,17 +127,87 @@ BitMatrix::setRegion(int left, int top, int width, int height)
 	}
 }
 
+#if defined(ZX_FAST_BIT_STORAGE) && defined(ZX_HAS_X86_DISPATCH)
+
+// Transposes a 16x16 byte tile. Each round interleaves row k with row k + 8, which rotates the 8 bit (row, column)
+// index of every byte left by one, so after 4 rounds row and column are swapped.
+ZX_TARGET("sse2")
+static void Transpose16x16SSE2(const uint8_t* src, int srcStride, uint8_t* dst, int dstStride)
+{
+	__m128i r[16], t[16];
+	for (int i = 0; i < 16; ++i)
+		r[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * srcStride));
+	for (int round = 0; round < 4; ++round) {
+		for (int k = 0; k < 8; ++k) {
+			t[2 * k] = _mm_unpacklo_epi8(r[k], r[k + 8]);
+			t[2 * k + 1] = _mm_unpackhi_epi8(r[k], r[k + 8]);
+		}
+		std::copy_n(t, 16, r);
+	}
+	for (int i = 0; i < 16; ++i)
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * dstStride), r[i]);
+}
+
+// Swaps the first and the last count 16 byte blocks of [first, last) and reverses the bytes within them.
+ZX_TARGET("ssse3")
+static void ReverseSSSE3(uint8_t* first, uint8_t* last, size_t count)
+{
+	const __m128i reverse = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+	for (; count > 0; --count, first += 16) {
+		last -= 16;
+		__m128i a = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(first)), reverse);
+		__m128i b = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(last)), reverse);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(first), b);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(last), a);
+	}
+}
+
+#endif
+
 void
 BitMatrix::rotate90()
 {
 	BitMatrix result(height(), width());
-	for (int x = 0; x < width(); ++x) {
-		for (int y = 0; y < height(); ++y) {
-			if (get(x, y)) {
-				result.set(y, width() - x - 1);
+#ifdef ZX_FAST_BIT_STORAGE
+	// Transpose square tiles, so the (strided) reads and writes of a tile stay within a few cache lines. Column x of
+	// the source becomes row width - 1 - x of the result, i.e. the rows of a transposed tile are stored bottom up.
+	constexpr int TILE = 16;
+#ifdef ZX_HAS_X86_DISPATCH
+	bool sse2 = CpuFeatures::HasSSE2();
+#endif
+	for (int y0 = 0; y0 < _height; y0 += TILE) {
+		int y1 = std::min(y0 + TILE, _height);
+		for (int x0 = 0; x0 < _width; x0 += TILE) {
+			int x1 = std::min(x0 + TILE, _width);
+#ifdef ZX_HAS_X86_DISPATCH
+			if (sse2 && y1 - y0 == TILE && x1 - x0 == TILE) {
+				Transpose16x16SSE2(_bits.data() + y0 * _rowSize + x0, _rowSize,
+								   result._bits.data() + (_width - 1 - x0) * result._rowSize + y0, -result._rowSize);
+				continue;
+			}
+#endif
+			for (int x = x0; x < x1; ++x) {
+				auto* dst = result._bits.data() + (_width - x - 1) * result._rowSize;
+				const auto* src = _bits.data() + x;
+				for (int y = y0; y < y1; ++y)
+					dst[y] = src[y * _rowSize];
 			}
 		}
 	}
+#else
+	// Transpose 32x32 bit blocks: 32 rows of one word column of the source become 32 rows of one word column of the
+	// result. The padding bits at the end of a row are not copied, they may be set after a flipAll().
+	std::array<uint32_t, 32> block;
+	for (int y0 = 0; y0 < _height; y0 += 32) {
+		for (int x32 = 0; x32 < _rowSize; ++x32) {
+			for (int i = 0; i < 32; ++i)
+				block[i] = y0 + i < _height ? _bits[(y0 + i) * _rowSize + x32] : 0;
+			BitHacks::Transpose32(block.data());
+			for (int j = 0; j < 32 && x32 * 32 + j < _width; ++j)
+				result._bits[(_width - 1 - x32 * 32 - j) * result._rowSize + y0 / 32] = block[j];
+		}
+	}
+#endif
 	*this = std::move(result);
 }
 
@@ -93,7 +215,17 @@ void
 BitMatrix::rotate180()
 {
 #ifdef ZX_FAST_BIT_STORAGE
-	std::reverse(_bits.begin(), _bits.end());
+	auto first = _bits.begin(), last = _bits.end();
+#ifdef ZX_HAS_X86_DISPATCH
+	if (CpuFeatures::HasSSSE3()) {
+		// the outer parts in 16 byte blocks, the middle (less than 32 bytes) below
+		size_t simdBytes = _bits.size() / 32 * 16;
+		ReverseSSSE3(_bits.data(), _bits.data() + _bits.size(), simdBytes / 16);
+		first += simdBytes;
+		last -= simdBytes;
+	}
+#endif
+	std::reverse(first, last);
 #else
 	BitHacks::Reverse(_bits, _rowSize * 32 - _width);
 #endif
@@ -102,14 +234,51 @@ BitMatrix::rotate180()
 void
 BitMatrix::mirror()
 {
-	for (int x = 0; x < _width; x++) {
-		for (int y = x + 1; y < _height; y++) {
-			if (get(x, y) != get(y, x)) {
-				flip(y, x);
-				flip(x, y);
+	// swaps (x, y) with (y, x), i.e. transposes the (square) matrix in place
+	int size = std::min(_width, _height);
+#ifdef ZX_FAST_BIT_STORAGE
+	// tile by tile, so both the tile and its mirror image stay in the cache
+	constexpr int TILE = 32;
+	for (int y0 = 0; y0 < size; y0 += TILE)
+		for (int x0 = y0; x0 < size; x0 += TILE)
+			for (int y = y0; y < std::min(y0 + TILE, size); ++y)
+				for (int x = std::max(x0, y + 1); x < std::min(x0 + TILE, size); ++x)
+					std::swap(_bits[y * _rowSize + x], _bits[x * _rowSize + y]);
+#else
+	if (_width != _height) {
+		for (int x = 0; x < size; x++)
+			for (int y = x + 1; y < size; y++)
+				if (get(x, y) != get(y, x)) {
+					flip(y, x);
+					flip(x, y);
+				}
+		return;
+	}
+	// Transpose 32x32 bit blocks, the ones on the diagonal in place, the others swapped with their mirror image
+	std::array<uint32_t, 32> a, b;
+	int numBlocks = (size + 31) / 32;
+	auto load = [&](std::array<uint32_t, 32>& block, int by, int bx) {
+		for (int i = 0; i < 32; ++i)
+			block[i] = by * 32 + i < _height ? _bits[(by * 32 + i) * _rowSize + bx] : 0;
+		BitHacks::Transpose32(block.data());
+	};
+	auto store = [&](const std::array<uint32_t, 32>& block, int by, int bx) {
+		for (int i = 0; i < 32 && by * 32 + i < _height; ++i)
+			_bits[(by * 32 + i) * _rowSize + bx] = block[i];
+	};
+	for (int by = 0; by < numBlocks; ++by)
+		for (int bx = by; bx < numBlocks; ++bx) {
+			load(a, by, bx);
+			if (bx == by) {
+				store(a, by, bx);
+			}
+			else {
+				load(b, bx, by);
+				store(a, bx, by);
+				store(b, by, bx);
 			}
 		}
-	}
+#endif
 }
 
 bool
@@ -121,45 +290,32 @@ BitMatrix::findBoundingBox(int &left, int& top, int& width, int& height, int min
 
 #ifdef ZX_FAST_BIT_STORAGE
 	for (int y = top; y <= bottom; y++ ) {
+		const data_t* row = _bits.data() + y * _width;
 		for (int x = 0; x < left; ++x)
-			if (get(x, y)) {
+			if (row[x]) {
 				left = x;
 				break;
 			}
 		for (int x = _width-1; x > right; x--)
-			if (get(x, y)) {
+			if (row[x]) {
 				right = x;
 				break;
 			}
 	}
 #else
-	for (int y = top; y <= bottom; y++)
-	{
-		for (int x32 = 0; x32 < _rowSize; x32++)
-		{
-			uint32_t theBits = _bits[y * _rowSize + x32];
-			if (theBits != 0)
-			{
-				if (x32 * 32 < left) {
-					int bit = 0;
-					while ((theBits << (31 - bit)) == 0) {
-						bit++;
-					}
-					if ((x32 * 32 + bit) < left) {
-						left = x32 * 32 + bit;
-					}
-				}
-				if (x32 * 32 + 31 > right) {
-					int bit = 31;
-					while ((theBits >> bit) == 0) {
-						bit--;
-					}
-					if ((x32 * 32 + bit) > right) {
-						right = x32 * 32 + bit;
-					}
-				}
+	// only the first and the last set bit of each row matter
+	for (int y = top; y <= bottom; y++) {
+		const data_t* row = _bits.data() + y * _rowSize;
+		for (int x32 = 0; x32 * 32 < left; ++x32)
+			if (row[x32]) {
+				left = std::min(left, x32 * 32 + BitHacks::NumberOfTrailingZeros(row[x32]));
+				break;
+			}
+		for (int x32 = _rowSize - 1; x32 * 32 + 31 > right; --x32)
+			if (row[x32]) {
+				right = std::max(right, x32 * 32 + 31 - BitHacks::NumberOfLeadingZeros(row[x32]));
+				break;
 			}
-		}
 	}
 #endif
 
@@ -229,19 +385,140 @@ BitMatrix Inflate(BitMatrix&& input, int width, int height, int quietZone)
 	return result;
 }
 
+static void FillRun(uint8_t* line, int begin, int end, RasterFormat format)
+{
+	if (format == RasterFormat::Lum) {
+		std::memset(line + begin, 0, end - begin);
+		return;
+	}
+	// set the bits [begin, end) of a most significant bit first scanline
+	auto mask = [](int from, int to) { return static_cast<uint8_t>((0xFF >> from) & ~(0xFF >> to)); };
+	int first = begin / 8, last = (end - 1) / 8;
+	if (first == last) {
+		line[first] |= mask(begin % 8, end - first * 8);
+		return;
+	}
+	line[first] |= mask(begin % 8, 8);
+	std::memset(line + first + 1, 0xFF, last - first - 1);
+	line[last] |= mask(0, end - last * 8);
+}
+
+void InflateInto(const BitMatrix& input, uint8_t* buffer, int width, int height, RasterFormat format, int rowStride)
+{
+	const int lineBytes = format == RasterFormat::Mono ? (width + 7) / 8 : width;
+	const uint8_t white = format == RasterFormat::Mono ? 0 : 0xFF;
+	if (rowStride == 0)
+		rowStride = lineBytes;
+
+	if (input.empty() || width < input.width() || height < input.height() || rowStride < lineBytes)
+		throw std::invalid_argument("Barcode does not fit into the raster");
+
+	const bool linear = input.height() == 1;
+	const int scale = linear ? width / input.width() : std::min(width / input.width(), height / input.height());
+	const int moduleHeight = linear ? height : scale;
+	const int leftPadding = (width - input.width() * scale) / 2;
+	const int topPadding = (height - input.height() * moduleHeight) / 2;
+
+	auto line = [&](int y) { return buffer + static_cast<std::ptrdiff_t>(y) * rowStride; };
+
+	for (int y = 0; y < topPadding; ++y)
+		std::memset(line(y), white, lineBytes);
+
+	for (int inputY = 0, outputY = topPadding; inputY < input.height(); ++inputY, outputY += moduleHeight) {
+		uint8_t* first = line(outputY);
+		std::memset(first, white, lineBytes);
+		for (int x = 0; x < input.width();) {
+			if (!input.get(x, inputY)) {
+				++x;
+				continue;
+			}
+			int runStart = x;
+			while (x < input.width() && input.get(x, inputY))
+				++x;
+			FillRun(first, leftPadding + runStart * scale, leftPadding + x * scale, format);
+		}
+		for (int y = outputY + 1; y < outputY + moduleHeight; ++y)
+			std::memcpy(line(y), first, lineBytes);
+	}
+
+	for (int y = topPadding + input.height() * moduleHeight; y < height; ++y)
+		std::memset(line(y), white, lineBytes);
+}
+
 BitMatrix Deflate(const BitMatrix& input, int width, int height, int top, int left, int subSampling)
 {
 	BitMatrix result(width, height);
-	for (int y = 0; y < result.height(); y++) {
-		int yOffset = top + y * subSampling;
-		for (int x = 0; x < result.width(); x++) {
-			if (input.get(left + x * subSampling, yOffset))
-				result.set(x, y);
+	if (width <= 0 || height <= 0)
+		return result;
+
+	// If the sampled area is inside the input, the bounds only need to be checked once and the pixels can be read
+	// straight from the rows. Otherwise keep the (bounds checked) per pixel access.
+	if (top < 0 || left < 0 || subSampling < 1 || top + (height - 1) * subSampling >= input.height() ||
+		left + (width - 1) * subSampling >= input.width()) {
+		for (int y = 0; y < result.height(); y++) {
+			int yOffset = top + y * subSampling;
+			for (int x = 0; x < result.width(); x++) {
+				if (input.get(left + x * subSampling, yOffset))
+					result.set(x, y);
+			}
 		}
+		return result;
+	}
+
+	for (int y = 0; y < height; y++) {
+		const auto* src = input._bits.data() + (top + y * subSampling) * input._rowSize;
+		auto* dst = result._bits.data() + y * result._rowSize;
+#ifdef ZX_FAST_BIT_STORAGE
+		src += left;
+		for (int x = 0; x < width; x++)
+			dst[x] = src[x * subSampling];
+#else
+		for (int x = 0, ix = left; x < width; x++, ix += subSampling)
+			dst[x / 32] |= ((src[ix / 32] >> (ix & 0x1f)) & 1) << (x & 0x1f);
+#endif
 	}
 	return result;
+}
 
+void GetPatternRow(const BitMatrix& matrix, int r, Vector<uint16_t>& res, bool transpose)
+{
+	res.clear();
+	auto line = transpose ? matrix.columnView(r) : matrix.rowView(r);
+	int length = line.size();
+	bool val = false; // the first run is white
+	int last = 0;
+	for (int i = 0; i < length; ++i) {
+		if (line[i] != val) {
+			res.push_back(i - last);
+			last = i;
+			val = !val;
+		}
+	}
+	res.push_back(length - last);
+	if (val)
+		res.push_back(0); // the last run is white
 }
 
-} // ZXing
+int GetPatternLine(const BitMatrix& matrix, PointI p0, PointI p1, Vector<uint16_t>& res)
+{
+	res.clear();
+	auto d = p1 - p0;
+	int length = std::max(std::abs(d.x), std::abs(d.y)) + 1;
+	auto step = PointF(d) / std::max(1, length - 1);
+	bool val = false; // the first run is white
+	int last = 0;
+	for (int i = 0; i < length; ++i) {
+		auto p = round(PointF(p0) + i * step);
+		if (matrix.get(p.x, p.y) != val) {
+			res.push_back(i - last);
+			last = i;
+			val = !val;
+		}
+	}
+	res.push_back(length - last);
+	if (val)
+		res.push_back(0); // the last run is white
+	return length;
+}
 
+} // ZXing
@@ -17,11 +17,15 @@
 */
 
 #include <algorithm>
+#include <cassert>
 #include <cstdint>
 #include <utility>
 #include <vector>
 
+#include "DecodeStats.h"
 #include "Matrix.h"
+#include "MemoryResource.h"
+#include "Point.h"
 #include "ZXConfig.h"
 
 namespace ZXing {
@@ -54,12 +58,18 @@ class BitMatrix
 #else
 	using data_t = uint32_t;
 #endif
-	std::vector<data_t> _bits;
+	Vector<data_t> _bits;
+	DecodeStats::Allocation _allocation; // see DecodeStats::peakBytes()
 	// There is nothing wrong to support this but disable to make it explicit since we may copy something very big here.
 	// Use copy() below.
 	BitMatrix(const BitMatrix&) = default;
 	BitMatrix& operator=(const BitMatrix&) = delete;
 
+	// reads the rows directly, see below
+	friend BitMatrix Deflate(const BitMatrix& matrix, int width, int height, int top, int left, int subSampling);
+	// copies the rows computed on the GPU directly, see OpenCLBinarizer.cpp
+	friend class OpenCLLuminanceSource;
+
 	const data_t& get(int i) const {
 #if 1
 		return _bits.at(i);
@@ -73,20 +83,29 @@ class BitMatrix
 public:
 	BitMatrix() = default;
 #ifdef ZX_FAST_BIT_STORAGE
-	BitMatrix(int width, int height) : _width(width), _height(height), _rowSize(width), _bits(width * height, 0) {}
+	BitMatrix(int width, int height)
+		: _width(width), _height(height), _rowSize(width), _bits(width * height, 0), _allocation(_bits.size())
+	{}
 #else
-	BitMatrix(int width, int height) : _width(width), _height(height), _rowSize((width + 31) / 32), _bits(((width + 31) / 32) * _height, 0) {}
+	BitMatrix(int width, int height)
+		: _width(width), _height(height), _rowSize((width + 31) / 32), _bits(((width + 31) / 32) * _height, 0),
+		  _allocation(_bits.size() * sizeof(data_t))
+	{}
 #endif
 
 	explicit BitMatrix(int dimension) : BitMatrix(dimension, dimension) {} // Construct a square matrix.
 
-	BitMatrix(BitMatrix&& other) noexcept : _width(other._width), _height(other._height), _rowSize(other._rowSize), _bits(std::move(other._bits)) {}
+	BitMatrix(BitMatrix&& other) noexcept
+		: _width(other._width), _height(other._height), _rowSize(other._rowSize), _bits(std::move(other._bits)),
+		  _allocation(std::move(other._allocation))
+	{}
 
 	BitMatrix& operator=(BitMatrix&& other) noexcept {
 		_width = other._width;
 		_height = other._height;
 		_rowSize = other._rowSize;
 		_bits = std::move(other._bits);
+		_allocation = std::move(other._allocation);
 		return *this;
 	}
 
@@ -109,6 +128,59 @@ public:
 	Row row(int y) { return {_bits.data() + y * _width, _bits.data() + (y + 1) * _width}; }
 #endif
 
+	/**
+	* Read-only view of the bits of one row or column. Unlike get(x, y), the element access is only bounds checked by an
+	* assert in debug builds. It is meant for the inner loops of the detectors, which establish the valid range once
+	* outside of the loop, so that the loop body is free of the range check and its throw path.
+	*/
+	class ConstLineView
+	{
+		const data_t* _data;
+		int _size;
+		int _stride; // 0 for a row in the packed storage
+		int _shift;
+
+	public:
+		ConstLineView(const data_t* data, int size, int stride, int shift)
+			: _data(data), _size(size), _stride(stride), _shift(shift)
+		{}
+
+		int size() const { return _size; }
+
+		bool operator[](int i) const {
+			assert(0 <= i && i < _size);
+#ifdef ZX_FAST_BIT_STORAGE
+			return _data[i * _stride] != 0;
+#else
+			return _stride ? ((_data[i * _stride] >> _shift) & 1) != 0 : ((_data[i / 32] >> (i & 0x1f)) & 1) != 0;
+#endif
+		}
+	};
+
+	ConstLineView rowView(int y) const {
+		assert(0 <= y && y < _height);
+#ifdef ZX_FAST_BIT_STORAGE
+		return {_bits.data() + y * _rowSize, _width, 1, 0};
+#else
+		return {_bits.data() + y * _rowSize, _width, 0, 0};
+#endif
+	}
+
+	ConstLineView columnView(int x) const {
+		assert(0 <= x && x < _width);
+#ifdef ZX_FAST_BIT_STORAGE
+		return {_bits.data() + x, _height, _rowSize, 0};
+#else
+		return {_bits.data() + x / 32, _height, _rowSize, x & 0x1f};
+#endif
+	}
+
+	/**
+	* True if the pixels [begin, end) of row y all have the given value. The row is checked a word at a time, which
+	* makes this much cheaper than calling get() for each pixel.
+	*/
+	bool isRowRange(int y, int begin, int end, bool value) const;
+
 	/**
 	* <p>Gets the requested bit, where true means black.</p>
 	*
@@ -171,7 +243,11 @@ public:
 
 	void flipAll() {
 		for (auto& i : _bits) {
+#ifdef ZX_FAST_BIT_STORAGE
+			i ^= 1; // one byte of 0 or 1 per bit
+#else
 			i = ~i;
+#endif
 		}
 	}
 
@@ -192,6 +268,13 @@ public:
 	*/
 	void setRegion(int left, int top, int width, int height);
 
+	/**
+	* Copies the bits of row from into row to, e.g. to repeat a row drawn once over the full height.
+	*/
+	void copyRow(int from, int to) {
+		std::copy_n(_bits.begin() + from * _rowSize, _rowSize, _bits.begin() + to * _rowSize);
+	}
+
 	/**
 	* A fast method to retrieve one row of data from the matrix as a BitArray.
 	*
@@ -202,6 +285,14 @@ public:
 	*/
 	void getRow(int y, BitArray& row) const;
 
+	/**
+	* Copies a row of bits into the matrix, the reverse of getRow().
+	*
+	* @param y The row to set
+	* @param row The bits, its size has to be the width of the matrix
+	*/
+	void setRow(int y, const BitArray& row);
+
 	/**
 	* Modifies this {@code BitMatrix} to represent the same but rotated 90 degrees clockwise
 	*/
@@ -271,6 +362,30 @@ public:
  */
 BitMatrix Inflate(BitMatrix&& input, int width, int height, int quietZone);
 
+/// Pixel formats of the raster InflateInto draws into
+enum class RasterFormat
+{
+	Lum,  ///< 8 bits per pixel, 0 = black, 255 = white
+	Mono, ///< 1 bit per pixel, most significant bit first, 1 = black (like PBM)
+};
+
+/**
+ * @brief InflateInto draws a BitMatrix into a caller provided raster without allocating the full size image
+ *
+ * The matrix is scaled up by the largest integer factor that fits and centered on a white background. A matrix with
+ * a single row (a linear barcode) is stretched over the full height. Each scanline of a module row is run-filled
+ * once and then copied to the other scanlines of that row.
+ * @param input matrix to draw, usually including its quiet zone
+ * @param buffer raster of at least height * rowStride bytes
+ * @param width width of the raster in pixels
+ * @param height height of the raster in pixels
+ * @param format pixel format of the raster
+ * @param rowStride bytes per scanline, 0 means tightly packed
+ * @throw std::invalid_argument if input does not fit into width x height
+ */
+void InflateInto(const BitMatrix& input, uint8_t* buffer, int width, int height, RasterFormat format,
+				 int rowStride = 0);
+
 /**
  * @brief Deflate (crop + subsample) a bit matrix
  * @param matrix
@@ -283,6 +398,26 @@ BitMatrix Inflate(BitMatrix&& input, int width, int height, int quietZone);
  */
 BitMatrix Deflate(const BitMatrix& matrix, int width, int height, int top, int left, int subSampling);
 
+/**
+ * @brief GetPatternRow computes the run lengths of the alternating white and black pixels of a row or column
+ * @param matrix input
+ * @param r index of the row (or column)
+ * @param res run lengths, the first and the last one are white (possibly 0), see also BinaryBitmap::getPatternRow
+ * @param transpose use column r instead of row r
+ */
+void GetPatternRow(const BitMatrix& matrix, int r, Vector<uint16_t>& res, bool transpose = false);
+
+/**
+ * @brief GetPatternLine computes the run lengths like GetPatternRow, but along the straight line from p0 to p1, which
+ * is sampled at the pixel nearest to each step of one pixel along its major axis (like Bresenham's algorithm)
+ * @param matrix input
+ * @param p0 first pixel of the line, must be inside the matrix
+ * @param p1 last pixel of the line, must be inside the matrix
+ * @param res run lengths in samples, the first and the last one are white (possibly 0)
+ * @return the number of samples, i.e. the sum of res
+ */
+int GetPatternLine(const BitMatrix& matrix, PointI p0, PointI p1, Vector<uint16_t>& res);
+
 template<typename T>
 BitMatrix ToBitMatrix(const Matrix<T>& in, T trueValue = {true})
 {
@@ -17,7 +17,14 @@
 #include "BitMatrixIO.h"
 #include "BitArray.h"
 
+#include "ZXContainerAlgorithms.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
 #include <fstream>
+#include <sstream>
+#include <vector>
 
 namespace ZXing {
 
@@ -64,10 +71,407 @@ BitMatrix ParseBitMatrix(const std::string& str, char one, bool expectSpace)
 
 void SaveAsPBM(const BitMatrix& matrix, const std::string filename, int quiteZone)
 {
-	auto out = Inflate(matrix.copy(), 0, 0, quiteZone);
-	std::ofstream file(filename);
-	file << "P1\n" << out.width() << ' ' << out.height() << '\n';
-	file << ToString(out, '1', '0', true);
+	std::ofstream file(filename, std::ios::binary);
+	file << ToPBM(matrix, 1, quiteZone);
+}
+
+void ForEachRectangle(const BitMatrix& matrix, const std::function<void(int, int, int, int)>& emit)
+{
+	struct Rect
+	{
+		int left, right, top;
+	};
+	// rectangles that reached the previous row, ordered by left, get extended as long as the same run continues
+	std::vector<Rect> open, next;
+	for (int y = 0; y <= matrix.height(); ++y) {
+		next.clear();
+		auto prev = open.begin();
+		for (int x = 0; y < matrix.height() && x < matrix.width();) {
+			if (!matrix.get(x, y)) {
+				++x;
+				continue;
+			}
+			int left = x;
+			while (x < matrix.width() && matrix.get(x, y))
+				++x;
+			for (; prev != open.end() && prev->left < left; ++prev)
+				emit(prev->left, prev->top, prev->right - prev->left, y - prev->top);
+			if (prev != open.end() && prev->left == left && prev->right == x)
+				next.push_back(*prev++);
+			else
+				next.push_back({left, x, y});
+		}
+		for (; prev != open.end(); ++prev)
+			emit(prev->left, prev->top, prev->right - prev->left, y - prev->top);
+		std::swap(open, next);
+	}
+}
+
+std::string ToSVG(const BitMatrix& matrix)
+{
+	std::ostringstream out;
+	out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+		<< "<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.1\" viewBox=\"0 0 " << matrix.width() << " "
+		<< matrix.height() << "\" stroke=\"none\">\n"
+		<< "<path d=\"";
+	ForEachRectangle(matrix, [&out](int left, int top, int width, int height) {
+		out << "M" << left << "," << top << "h" << width << "v" << height << "h-" << width << "z";
+	});
+	out << "\"/>\n</svg>\n";
+	return out.str();
+}
+
+/**
+ * Calls emit(changes) for every pixel row of matrix scaled by scale and surrounded by quietZone white bits. changes
+ * holds the x positions where the color switches, starting with a switch from white to black. Each list is built once
+ * per matrix row and repeated scale times.
+ */
+template <typename F>
+static void ForEachScaledRow(const BitMatrix& matrix, int scale, int quietZone, F emit)
+{
+	std::vector<int> changes;
+	for (int y = -quietZone; y < matrix.height() + quietZone; ++y) {
+		changes.clear();
+		if (y >= 0 && y < matrix.height()) {
+			bool black = false;
+			for (int x = 0; x < matrix.width(); ++x)
+				if (matrix.get(x, y) != black) {
+					black = !black;
+					changes.push_back((x + quietZone) * scale);
+				}
+			if (black && quietZone > 0)
+				changes.push_back((matrix.width() + quietZone) * scale);
+		}
+		for (int i = 0; i < scale; ++i)
+			emit(changes);
+	}
+}
+
+static void PackRow(const std::vector<int>& changes, int width, bool blackIsOne, std::vector<uint8_t>& row)
+{
+	row.assign((width + 7) / 8, blackIsOne ? 0 : 0xff);
+	for (size_t i = 0; i < changes.size(); i += 2) {
+		int end = i + 1 < changes.size() ? changes[i + 1] : width;
+		for (int x = changes[i]; x < end; ++x)
+			row[x / 8] ^= 0x80 >> (x % 8);
+	}
+}
+
+std::string ToPBM(const BitMatrix& matrix, int scale, int quietZone)
+{
+	scale = std::max(scale, 1);
+	int width = (matrix.width() + 2 * quietZone) * scale;
+	int height = (matrix.height() + 2 * quietZone) * scale;
+	std::string res = "P4\n" + std::to_string(width) + " " + std::to_string(height) + "\n";
+	res.reserve(res.size() + (width + 7) / 8 * height);
+	std::vector<uint8_t> row;
+	ForEachScaledRow(matrix, scale, quietZone, [&](const std::vector<int>& changes) {
+		PackRow(changes, width, true, row);
+		res.append(row.begin(), row.end());
+	});
+	return res;
+}
+
+static void AppendBE32(std::string& out, uint32_t v)
+{
+	for (int shift = 24; shift >= 0; shift -= 8)
+		out += static_cast<char>(v >> shift);
+}
+
+static uint32_t CRC32(const std::string& data, size_t start)
+{
+	static const auto table = [] {
+		std::vector<uint32_t> t(256);
+		for (uint32_t n = 0; n < 256; ++n) {
+			uint32_t c = n;
+			for (int k = 0; k < 8; ++k)
+				c = c & 1 ? 0xedb88320 ^ (c >> 1) : c >> 1;
+			t[n] = c;
+		}
+		return t;
+	}();
+	uint32_t crc = 0xffffffff;
+	for (size_t i = start; i < data.size(); ++i)
+		crc = table[(crc ^ static_cast<uint8_t>(data[i])) & 0xff] ^ (crc >> 8);
+	return crc ^ 0xffffffff;
+}
+
+static void AppendPNGChunk(std::string& out, const char* type, const std::string& data)
+{
+	AppendBE32(out, static_cast<uint32_t>(data.size()));
+	size_t start = out.size();
+	out += type;
+	out += data;
+	AppendBE32(out, CRC32(out, start));
+}
+
+/// Deflate bit stream, filled from the least significant bit of each byte
+struct LSBBitWriter
+{
+	std::string bytes;
+	uint32_t buffer = 0;
+	int count = 0;
+
+	void put(uint32_t bits, int length)
+	{
+		buffer |= bits << count;
+		for (count += length; count >= 8; count -= 8, buffer >>= 8)
+			bytes += static_cast<char>(buffer & 0xff);
+	}
+
+	// Huffman codes are packed starting with their most significant bit
+	void putCode(uint32_t code, int length)
+	{
+		uint32_t reversed = 0;
+		for (int i = 0; i < length; ++i, code >>= 1)
+			reversed = (reversed << 1) | (code & 1);
+		put(reversed, length);
+	}
+
+	void flush() { put(0, (8 - count) % 8); }
+};
+
+static void PutFixedHuffman(LSBBitWriter& out, int symbol)
+{
+	if (symbol < 144)
+		out.putCode(0x30 + symbol, 8);
+	else if (symbol < 256)
+		out.putCode(0x190 + symbol - 144, 9);
+	else if (symbol < 280)
+		out.putCode(symbol - 256, 7);
+	else
+		out.putCode(0xc0 + symbol - 280, 8);
+}
+
+static void PutMatch(LSBBitWriter& out, int length)
+{
+	static const int BASE[] = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+							   31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+	static const int EXTRA[] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+	int code = Size(BASE) - 1;
+	while (BASE[code] > length)
+		--code;
+	PutFixedHuffman(out, 257 + code);
+	out.put(length - BASE[code], EXTRA[code]);
+	out.put(0, 5); // distance code 0: the previous byte
+}
+
+/**
+ * zlib stream of a single fixed Huffman block that only uses matches at distance 1, i.e. run-length encoding. With the
+ * rows of a scaled symbol consisting of long runs of 0x00 and 0xff and the 'Up' filter turning repeated rows into
+ * zeros, this gets close to real deflate at a fraction of the cost.
+ */
+static std::string ZlibRunLengthEncode(const std::vector<uint8_t>& data)
+{
+	LSBBitWriter out;
+	out.bytes = "\x78\x01";
+	out.put(1, 1); // last block
+	out.put(1, 2); // fixed Huffman codes
+	for (size_t i = 0; i < data.size();) {
+		PutFixedHuffman(out, data[i]);
+		size_t j = i + 1;
+		while (true) {
+			size_t run = 0;
+			while (j + run < data.size() && run < 258 && data[j + run] == data[i])
+				++run;
+			if (run < 3)
+				break;
+			PutMatch(out, static_cast<int>(run));
+			j += run;
+		}
+		i = j;
+	}
+	PutFixedHuffman(out, 256); // end of block
+	out.flush();
+
+	uint32_t s1 = 1, s2 = 0;
+	for (auto b : data) {
+		s1 = (s1 + b) % 65521;
+		s2 = (s2 + s1) % 65521;
+	}
+	AppendBE32(out.bytes, (s2 << 16) | s1);
+	return std::move(out.bytes);
+}
+
+std::string ToPNG(const BitMatrix& matrix, int scale, int quietZone)
+{
+	scale = std::max(scale, 1);
+	int width = (matrix.width() + 2 * quietZone) * scale;
+	int height = (matrix.height() + 2 * quietZone) * scale;
+	std::vector<uint8_t> filtered, row, prev;
+	filtered.reserve(((width + 7) / 8 + 1) * height);
+	ForEachScaledRow(matrix, scale, quietZone, [&](const std::vector<int>& changes) {
+		PackRow(changes, width, false, row);
+		bool repeated = row == prev;
+		filtered.push_back(repeated ? 2 : 0); // filter type 'Up' or 'None'
+		if (repeated)
+			filtered.insert(filtered.end(), row.size(), 0);
+		else
+			filtered.insert(filtered.end(), row.begin(), row.end());
+		std::swap(row, prev);
+	});
+
+	std::string header;
+	AppendBE32(header, width);
+	AppendBE32(header, height);
+	header += std::string("\x01\x00\x00\x00\x00", 5); // bit depth 1, grayscale, deflate, no interlace
+
+	std::string res = "\x89PNG\r\n\x1a\n";
+	AppendPNGChunk(res, "IHDR", header);
+	AppendPNGChunk(res, "IDAT", ZlibRunLengthEncode(filtered));
+	AppendPNGChunk(res, "IEND", {});
+	return res;
+}
+
+/// CCITT bit stream, filled from the most significant bit of each byte
+struct MSBBitWriter
+{
+	std::string bytes;
+	uint32_t buffer = 0;
+	int count = 0;
+
+	void put(uint32_t bits, int length)
+	{
+		buffer = (buffer << length) | bits;
+		for (count += length; count >= 8; count -= 8)
+			bytes += static_cast<char>(buffer >> (count - 8));
+	}
+
+	void flush() { put(0, (8 - count) % 8); }
+};
+
+struct G4Code
+{
+	uint16_t code;
+	uint8_t length;
+};
+
+// ITU-T T.4 run length codes: terminating codes for 0 to 63, then make-up codes for 64 to 2560 in steps of 64
+// clang-format off
+static const G4Code WHITE_CODES[] = {
+	{0x35, 8}, {0x7, 6}, {0x7, 4}, {0x8, 4}, {0xb, 4}, {0xc, 4}, {0xe, 4}, {0xf, 4},
+	{0x13, 5}, {0x14, 5}, {0x7, 5}, {0x8, 5}, {0x8, 6}, {0x3, 6}, {0x34, 6}, {0x35, 6},
+	{0x2a, 6}, {0x2b, 6}, {0x27, 7}, {0xc, 7}, {0x8, 7}, {0x17, 7}, {0x3, 7}, {0x4, 7},
+	{0x28, 7}, {0x2b, 7}, {0x13, 7}, {0x24, 7}, {0x18, 7}, {0x2, 8}, {0x3, 8}, {0x1a, 8},
+	{0x1b, 8}, {0x12, 8}, {0x13, 8}, {0x14, 8}, {0x15, 8}, {0x16, 8}, {0x17, 8}, {0x28, 8},
+	{0x29, 8}, {0x2a, 8}, {0x2b, 8}, {0x2c, 8}, {0x2d, 8}, {0x4, 8}, {0x5, 8}, {0xa, 8},
+	{0xb, 8}, {0x52, 8}, {0x53, 8}, {0x54, 8}, {0x55, 8}, {0x24, 8}, {0x25, 8}, {0x58, 8},
+	{0x59, 8}, {0x5a, 8}, {0x5b, 8}, {0x4a, 8}, {0x4b, 8}, {0x32, 8}, {0x33, 8}, {0x34, 8},
+	{0x1b, 5}, {0x12, 5}, {0x17, 6}, {0x37, 7}, {0x36, 8}, {0x37, 8}, {0x64, 8}, {0x65, 8},
+	{0x68, 8}, {0x67, 8}, {0xcc, 9}, {0xcd, 9}, {0xd2, 9}, {0xd3, 9}, {0xd4, 9}, {0xd5, 9},
+	{0xd6, 9}, {0xd7, 9}, {0xd8, 9}, {0xd9, 9}, {0xda, 9}, {0xdb, 9}, {0x98, 9}, {0x99, 9},
+	{0x9a, 9}, {0x18, 6}, {0x9b, 9}, {0x8, 11}, {0xc, 11}, {0xd, 11}, {0x12, 12}, {0x13, 12},
+	{0x14, 12}, {0x15, 12}, {0x16, 12}, {0x17, 12}, {0x1c, 12}, {0x1d, 12}, {0x1e, 12}, {0x1f, 12},
+};
+static const G4Code BLACK_CODES[] = {
+	{0x37, 10}, {0x2, 3}, {0x3, 2}, {0x2, 2}, {0x3, 3}, {0x3, 4}, {0x2, 4}, {0x3, 5},
+	{0x5, 6}, {0x4, 6}, {0x4, 7}, {0x5, 7}, {0x7, 7}, {0x4, 8}, {0x7, 8}, {0x18, 9},
+	{0x17, 10}, {0x18, 10}, {0x8, 10}, {0x67, 11}, {0x68, 11}, {0x6c, 11}, {0x37, 11}, {0x28, 11},
+	{0x17, 11}, {0x18, 11}, {0xca, 12}, {0xcb, 12}, {0xcc, 12}, {0xcd, 12}, {0x68, 12}, {0x69, 12},
+	{0x6a, 12}, {0x6b, 12}, {0xd2, 12}, {0xd3, 12}, {0xd4, 12}, {0xd5, 12}, {0xd6, 12}, {0xd7, 12},
+	{0x6c, 12}, {0x6d, 12}, {0xda, 12}, {0xdb, 12}, {0x54, 12}, {0x55, 12}, {0x56, 12}, {0x57, 12},
+	{0x64, 12}, {0x65, 12}, {0x52, 12}, {0x53, 12}, {0x24, 12}, {0x37, 12}, {0x38, 12}, {0x27, 12},
+	{0x28, 12}, {0x58, 12}, {0x59, 12}, {0x2b, 12}, {0x2c, 12}, {0x5a, 12}, {0x66, 12}, {0x67, 12},
+	{0xf, 10}, {0xc8, 12}, {0xc9, 12}, {0x5b, 12}, {0x33, 12}, {0x34, 12}, {0x35, 12}, {0x6c, 13},
+	{0x6d, 13}, {0x4a, 13}, {0x4b, 13}, {0x4c, 13}, {0x4d, 13}, {0x72, 13}, {0x73, 13}, {0x74, 13},
+	{0x75, 13}, {0x76, 13}, {0x77, 13}, {0x52, 13}, {0x53, 13}, {0x54, 13}, {0x55, 13}, {0x5a, 13},
+	{0x5b, 13}, {0x64, 13}, {0x65, 13}, {0x8, 11}, {0xc, 11}, {0xd, 11}, {0x12, 12}, {0x13, 12},
+	{0x14, 12}, {0x15, 12}, {0x16, 12}, {0x17, 12}, {0x1c, 12}, {0x1d, 12}, {0x1e, 12}, {0x1f, 12},
+};
+// clang-format on
+
+static void PutRunLength(MSBBitWriter& out, int length, const G4Code* codes)
+{
+	for (; length >= 2624; length -= 2560)
+		out.put(codes[63 + 40].code, codes[63 + 40].length);
+	if (length >= 64) {
+		auto& makeUp = codes[63 + length / 64];
+		out.put(makeUp.code, makeUp.length);
+		length %= 64;
+	}
+	out.put(codes[length].code, codes[length].length);
+}
+
+/// Two-dimensional coding of one row relative to the previous one (ITU-T T.6, section 2.2)
+static void EncodeG4Row(MSBBitWriter& out, const std::vector<int>& ref, const std::vector<int>& cur, int width)
+{
+	auto at = [width](const std::vector<int>& changes, size_t i) { return i < changes.size() ? changes[i] : width; };
+	int a0 = -1;
+	while (a0 < width) {
+		// the number of changes up to a0 gives its color, the changes to black have even indices
+		size_t i = std::upper_bound(cur.begin(), cur.end(), a0) - cur.begin();
+		size_t j = std::upper_bound(ref.begin(), ref.end(), a0) - ref.begin();
+		if (j % 2 != i % 2)
+			++j;
+		int a1 = at(cur, i), b1 = at(ref, j), b2 = at(ref, j + 1);
+		if (b2 < a1) {
+			out.put(0x1, 4); // pass
+			a0 = b2;
+		}
+		else if (std::abs(a1 - b1) <= 3) {
+			static const G4Code VERTICAL[] = {{0x2, 7}, {0x2, 6}, {0x2, 3}, {0x1, 1}, {0x3, 3}, {0x3, 6}, {0x3, 7}};
+			out.put(VERTICAL[a1 - b1 + 3].code, VERTICAL[a1 - b1 + 3].length);
+			a0 = a1;
+		}
+		else {
+			int a2 = at(cur, i + 1);
+			bool black = i % 2;
+			out.put(0x1, 3); // horizontal
+			PutRunLength(out, a1 - std::max(a0, 0), black ? BLACK_CODES : WHITE_CODES);
+			PutRunLength(out, a2 - a1, black ? WHITE_CODES : BLACK_CODES);
+			a0 = a2;
+		}
+	}
+}
+
+static void AppendLE(std::string& out, uint32_t v, int bytes)
+{
+	for (int i = 0; i < bytes; ++i, v >>= 8)
+		out += static_cast<char>(v & 0xff);
+}
+
+std::string ToTIFF(const BitMatrix& matrix, int scale, int quietZone)
+{
+	scale = std::max(scale, 1);
+	int width = (matrix.width() + 2 * quietZone) * scale;
+	int height = (matrix.height() + 2 * quietZone) * scale;
+	MSBBitWriter strip;
+	std::vector<int> ref; // the imaginary row above the image is white
+	ForEachScaledRow(matrix, scale, quietZone, [&](const std::vector<int>& changes) {
+		EncodeG4Row(strip, ref, changes, width);
+		ref = changes;
+	});
+	strip.put(0x001001, 24); // EOFB
+	strip.flush();
+
+	std::string res = "II*";
+	res += '\0';
+	uint32_t ifdOffset = static_cast<uint32_t>(8 + strip.bytes.size() + strip.bytes.size() % 2);
+	AppendLE(res, ifdOffset, 4);
+	res += strip.bytes;
+	res.resize(ifdOffset);
+
+	enum { SHORT = 3, LONG = 4 };
+	const uint32_t entries[][3] = {
+		{256, LONG, static_cast<uint32_t>(width)},	// ImageWidth
+		{257, LONG, static_cast<uint32_t>(height)}, // ImageLength
+		{258, SHORT, 1},							// BitsPerSample
+		{259, SHORT, 4},							// Compression: CCITT Group 4
+		{262, SHORT, 0},							// PhotometricInterpretation: WhiteIsZero
+		{273, LONG, 8},								// StripOffsets
+		{277, SHORT, 1},							// SamplesPerPixel
+		{278, LONG, static_cast<uint32_t>(height)}, // RowsPerStrip
+		{279, LONG, static_cast<uint32_t>(strip.bytes.size())}, // StripByteCounts
+	};
+	AppendLE(res, Size(entries), 2);
+	for (auto& e : entries) {
+		AppendLE(res, e[0], 2);
+		AppendLE(res, e[1], 2);
+		AppendLE(res, 1, 4);
+		AppendLE(res, e[2], 4);
+	}
+	AppendLE(res, 0, 4); // no next IFD
+	return res;
 }
 
 } // ZXing
@@ -16,6 +16,7 @@
 * limitations under the License.
 */
 
+#include <functional>
 #include <string>
 
 #include "BitMatrix.h"
@@ -24,6 +25,32 @@ namespace ZXing {
     
 	std::string ToString(const BitMatrix& matrix, char one = 'X', char zero = ' ', bool addSpace = true, bool printAsCString = false);
 	BitMatrix ParseBitMatrix(const std::string& str, char one = 'X', bool expectSpace = true);
+	/// Writes matrix as binary PBM (see ToPBM) with quiteZone white bits on all sides
 	void SaveAsPBM(const BitMatrix& matrix, const std::string filename, int quiteZone = 1);
 
+	/*
+	 * 1-bit raster output. Each bit of matrix becomes a block of scale x scale pixels and quietZone white bits (before
+	 * scaling) are added on all sides. The rows are packed straight from the run boundaries of the matrix rows without
+	 * a scaled or 8-bit intermediate image, so use them on the unscaled symbol.
+	 */
+
+	/// Binary (P4) portable bitmap
+	std::string ToPBM(const BitMatrix& matrix, int scale = 1, int quietZone = 0);
+
+	/// 1-bit grayscale PNG, compressed by run-length encoding in a fixed Huffman deflate block
+	std::string ToPNG(const BitMatrix& matrix, int scale = 1, int quietZone = 0);
+
+	/// Single strip bilevel TIFF with CCITT Group 4 (T.6) compression, the usual format of label and fax printers
+	std::string ToTIFF(const BitMatrix& matrix, int scale = 1, int quietZone = 0);
+
+	/**
+	 * Calls emit(left, top, width, height) for non-overlapping rectangles that exactly cover the set bits of matrix.
+	 * Horizontal runs are merged with identical runs in the rows below, so the number of rectangles depends on the
+	 * structure of the symbol, not on its size in pixels. Use it on the unscaled symbol for vector output.
+	 */
+	void ForEachRectangle(const BitMatrix& matrix, const std::function<void(int, int, int, int)>& emit);
+
+	/// SVG document with a viewBox of one unit per bit of matrix and a single path built by ForEachRectangle
+	std::string ToSVG(const BitMatrix& matrix);
+
 } // ZXing
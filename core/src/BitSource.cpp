@@ -19,6 +19,7 @@
 #include "ByteArray.h"
 #include "ZXContainerAlgorithms.h"
 
+#include <algorithm>
 #include <stdexcept>
 
 namespace ZXing {
@@ -26,51 +27,47 @@ namespace ZXing {
 int
 BitSource::available() const
 {
-	return 8 * (Size(_bytes) - _byteOffset) - _bitOffset;
+	return 8 * Size(_bytes) - _position;
+}
+
+uint64_t
+BitSource::window() const
+{
+	// assembled byte by byte to be independent of the endianness, compilers turn this into a single (swapped) load
+	const uint8_t* bytes = _bytes.data() + _position / 8;
+	int count = std::min(8, Size(_bytes) - _position / 8);
+	uint64_t res = 0;
+	for (int i = 0; i < count; ++i)
+		res |= uint64_t(bytes[i]) << (56 - 8 * i);
+	return res;
 }
 
 int
-BitSource::readBits(int numBits)
+BitSource::peekBits(int numBits) const
 {
 	if (numBits < 1 || numBits > 32 || numBits > available()) {
 		throw std::out_of_range("BitSource::readBits: out of range");
 	}
 
-	int result = 0;
-
-	// First, read remainder from current byte
-	if (_bitOffset > 0) {
-		int bitsLeft = 8 - _bitOffset;
-		int toRead = numBits < bitsLeft ? numBits : bitsLeft;
-		int bitsToNotRead = bitsLeft - toRead;
-		int mask = (0xFF >> (8 - toRead)) << bitsToNotRead;
-		result = (_bytes[_byteOffset] & mask) >> bitsToNotRead;
-		numBits -= toRead;
-		_bitOffset += toRead;
-		if (_bitOffset == 8) {
-			_bitOffset = 0;
-			_byteOffset++;
-		}
-	}
+	// the bits of the current byte that were already read are shifted out, at most 7 + 32 bits are needed
+	return static_cast<int>(static_cast<uint32_t>((window() << (_position % 8)) >> (64 - numBits)));
+}
 
-	// Next read whole bytes
-	if (numBits > 0) {
-		while (numBits >= 8) {
-			result = (result << 8) | _bytes[_byteOffset];
-			_byteOffset++;
-			numBits -= 8;
-		}
+int
+BitSource::readBits(int numBits)
+{
+	int result = peekBits(numBits);
+	_position += numBits;
+	return result;
+}
 
-		// Finally read a partial byte
-		if (numBits > 0) {
-			int bitsToNotRead = 8 - numBits;
-			int mask = (0xFF >> bitsToNotRead) << bitsToNotRead;
-			result = (result << numBits) | ((_bytes[_byteOffset] & mask) >> bitsToNotRead);
-			_bitOffset += numBits;
-		}
+void
+BitSource::skipBits(int numBits)
+{
+	if (numBits < 0 || numBits > available()) {
+		throw std::out_of_range("BitSource::skipBits: out of range");
 	}
-
-	return result;
+	_position += numBits;
 }
 
 } // ZXing
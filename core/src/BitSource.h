@@ -16,6 +16,8 @@
 * limitations under the License.
 */
 
+#include <cstdint>
+
 namespace ZXing {
 
 class ByteArray;
@@ -32,8 +34,10 @@ class ByteArray;
 class BitSource
 {
 	const ByteArray& _bytes;
-	int _byteOffset = 0;
-	int _bitOffset = 0;
+	int _position = 0; // index of the next bit to read
+
+	// the 64 bits starting at the first bit of the byte containing the next bit to read, padded with 0s
+	uint64_t window() const;
 
 public:
 	/**
@@ -50,14 +54,14 @@ public:
 	* @return index of next bit in current byte which would be read by the next call to {@link #readBits(int)}.
 	*/
 	int bitOffset() const {
-		return _bitOffset;
+		return _position % 8;
 	}
 
 	/**
 	* @return index of next byte in input byte array which would be read by the next call to {@link #readBits(int)}.
 	*/
 	int byteOffset() const {
-		return _byteOffset;
+		return _position / 8;
 	}
 
 	/**
@@ -68,6 +72,17 @@ public:
 	*/
 	int readBits(int numBits);
 
+	/**
+	* Like readBits but without consuming the bits, i.e. the next read starts at the same position.
+	*/
+	int peekBits(int numBits) const;
+
+	/**
+	* Consumes numBits bits without reading them.
+	* @throws std::out_of_range if numBits is negative or more than is available
+	*/
+	void skipBits(int numBits);
+
 	/**
 	* @return number of bits that can be read successfully
 	*/
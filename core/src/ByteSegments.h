@@ -0,0 +1,109 @@
+#pragma once
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "ByteArray.h"
+#include "ZXContainerAlgorithms.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <list>
+#include <utility>
+#include <vector>
+
+namespace ZXing {
+
+/**
+* The byte segments of a symbol (see ResultMetadata::BYTE_SEGMENTS), stored back to back in one buffer together with
+* the end of each segment. A multi-segment binary payload can be handed on as a whole with bytes(), or segment by
+* segment as a view into the buffer.
+*/
+class ByteSegments
+{
+	ByteArray _bytes;
+	std::vector<int> _ends;
+
+public:
+	/// A view of one segment, valid as long as the ByteSegments it came from is not changed
+	struct Span
+	{
+		const uint8_t* _begin;
+		const uint8_t* _end;
+
+		const uint8_t* begin() const { return _begin; }
+		const uint8_t* end() const { return _end; }
+		const uint8_t* data() const { return _begin; }
+		int size() const { return static_cast<int>(_end - _begin); }
+		uint8_t operator[](int i) const { return _begin[i]; }
+		ByteArray toByteArray() const
+		{
+			ByteArray res;
+			res.assign(_begin, _end);
+			return res;
+		}
+	};
+
+	ByteSegments() = default;
+	explicit ByteSegments(const std::list<ByteArray>& segments)
+	{
+		for (const auto& segment : segments)
+			append(segment.data(), Size(segment));
+	}
+
+	/// Adds a segment of 'size' bytes and returns where they go, valid until the next append
+	uint8_t* append(int size)
+	{
+		_bytes.resize(_bytes.size() + size);
+		_ends.push_back(Size(_bytes));
+		return _bytes.data() + _bytes.size() - size;
+	}
+
+	void append(const uint8_t* data, int size) { std::copy_n(data, size, append(size)); }
+
+	bool empty() const { return _ends.empty(); }
+	int size() const { return Size(_ends); }
+
+	Span operator[](int i) const
+	{
+		return {_bytes.data() + (i ? _ends[i - 1] : 0), _bytes.data() + _ends[i]};
+	}
+
+	Span front() const { return (*this)[0]; }
+	Span back() const { return (*this)[size() - 1]; }
+
+	/// All segments back to back
+	const ByteArray& bytes() const & { return _bytes; }
+	ByteArray&& bytes() && { return std::move(_bytes); }
+
+	/// The end offset of each segment in bytes()
+	const std::vector<int>& ends() const { return _ends; }
+
+	std::list<ByteArray> toList() const
+	{
+		std::list<ByteArray> res;
+		for (int i = 0; i < size(); ++i)
+			res.push_back((*this)[i].toByteArray());
+		return res;
+	}
+
+	friend bool operator==(const ByteSegments& a, const ByteSegments& b)
+	{
+		return a._ends == b._ends && a._bytes == b._bytes;
+	}
+};
+
+} // ZXing
@@ -17,148 +17,165 @@
 
 #include "CharacterSetECI.h"
 #include "CharacterSet.h"
+#include "ZXContainerAlgorithms.h"
 
-#include <map>
+#include <algorithm>
 #include <cstring>
-#include <utility>
+#include <iterator>
 
 namespace ZXing {
 
 namespace {
 
-static const std::map<int, CharacterSet> ECI_VALUE_TO_CHARSET = {
-	{0,  CharacterSet::Cp437},
-	{1,  CharacterSet::ISO8859_1},
-	{2,  CharacterSet::Cp437},
-	{3,  CharacterSet::ISO8859_1},
-	{4,  CharacterSet::ISO8859_2},
-	{5,  CharacterSet::ISO8859_3},
-	{6,  CharacterSet::ISO8859_4},
-	{7,  CharacterSet::ISO8859_5},
-	{8,  CharacterSet::ISO8859_6},
-	{9,  CharacterSet::ISO8859_7},
-	{10, CharacterSet::ISO8859_8},
-	{11, CharacterSet::ISO8859_9},
-	{12, CharacterSet::ISO8859_10},
-	{13, CharacterSet::ISO8859_11},
-	{15, CharacterSet::ISO8859_13},
-	{16, CharacterSet::ISO8859_14},
-	{17, CharacterSet::ISO8859_15},
-	{18, CharacterSet::ISO8859_16},
-	{20, CharacterSet::Shift_JIS},
-	{21, CharacterSet::Cp1250},
-	{22, CharacterSet::Cp1251},
-	{23, CharacterSet::Cp1252},
-	{24, CharacterSet::Cp1256},
-	{25, CharacterSet::UnicodeBig},
-	{26, CharacterSet::UTF8},
-	{27, CharacterSet::ASCII},
-	{28, CharacterSet::Big5},
-	{29, CharacterSet::GB18030},
-	{30, CharacterSet::EUC_KR},
-	{170, CharacterSet::ASCII},
+// indexed by the ECI value, 14 and 19 are not assigned, 170 (ISO/IEC 646 invariant) is handled in CharsetFromValue
+constexpr CharacterSet ECI_VALUE_TO_CHARSET[] = {
+	CharacterSet::Cp437,      // 0
+	CharacterSet::ISO8859_1,  // 1
+	CharacterSet::Cp437,      // 2
+	CharacterSet::ISO8859_1,  // 3
+	CharacterSet::ISO8859_2,  // 4
+	CharacterSet::ISO8859_3,  // 5
+	CharacterSet::ISO8859_4,  // 6
+	CharacterSet::ISO8859_5,  // 7
+	CharacterSet::ISO8859_6,  // 8
+	CharacterSet::ISO8859_7,  // 9
+	CharacterSet::ISO8859_8,  // 10
+	CharacterSet::ISO8859_9,  // 11
+	CharacterSet::ISO8859_10, // 12
+	CharacterSet::ISO8859_11, // 13
+	CharacterSet::Unknown,    // 14
+	CharacterSet::ISO8859_13, // 15
+	CharacterSet::ISO8859_14, // 16
+	CharacterSet::ISO8859_15, // 17
+	CharacterSet::ISO8859_16, // 18
+	CharacterSet::Unknown,    // 19
+	CharacterSet::Shift_JIS,  // 20
+	CharacterSet::Cp1250,     // 21
+	CharacterSet::Cp1251,     // 22
+	CharacterSet::Cp1252,     // 23
+	CharacterSet::Cp1256,     // 24
+	CharacterSet::UnicodeBig, // 25
+	CharacterSet::UTF8,       // 26
+	CharacterSet::ASCII,      // 27
+	CharacterSet::Big5,       // 28
+	CharacterSet::GB18030,    // 29
+	CharacterSet::EUC_KR,     // 30
 };
 
-struct StringCmp {
-	bool operator()(char const *a, char const *b) const {
-		return std::strcmp(a, b) < 0;
-	}
+struct NameCharset
+{
+	const char* name;
+	CharacterSet charset;
 };
 
-static const std::map<const char*, CharacterSet, StringCmp> ECI_NAME_TO_CHARSET = {
+// sorted by name (in strcmp order) for the binary search in CharsetFromName
+constexpr NameCharset ECI_NAME_TO_CHARSET[] = {
+	{"ASCII",		CharacterSet::ASCII},
+	{"Big5",			CharacterSet::Big5},
+	{"Cp1250",		CharacterSet::Cp1250},
+	{"Cp1251",		CharacterSet::Cp1251},
+	{"Cp1252",		CharacterSet::Cp1252},
+	{"Cp1256",		CharacterSet::Cp1256},
 	{"Cp437",		CharacterSet::Cp437},
-	{"ISO8859_1",	CharacterSet::ISO8859_1},
+	{"EUC-CN",		CharacterSet::GB18030},
+	{"EUC-KR",		CharacterSet::EUC_KR},
+	{"EUC_CN",		CharacterSet::GB18030},
+	{"EUC_KR",		CharacterSet::EUC_KR},
+	{"GB18030",		CharacterSet::GB18030},
+	{"GB2312",		CharacterSet::GB2312},
+	{"GBK",			CharacterSet::GB18030},
 	{"ISO-8859-1",	CharacterSet::ISO8859_1},
-	{"ISO8859_2",	CharacterSet::ISO8859_2},
+	{"ISO-8859-10",	CharacterSet::ISO8859_10},
+	{"ISO-8859-11",	CharacterSet::ISO8859_11},
+	{"ISO-8859-13",	CharacterSet::ISO8859_13},
+	{"ISO-8859-14",	CharacterSet::ISO8859_14},
+	{"ISO-8859-15",	CharacterSet::ISO8859_15},
+	{"ISO-8859-16",	CharacterSet::ISO8859_16},
 	{"ISO-8859-2",	CharacterSet::ISO8859_2},
-	{"ISO8859_3",	CharacterSet::ISO8859_3},
 	{"ISO-8859-3",	CharacterSet::ISO8859_3},
-	{"ISO8859_4",	CharacterSet::ISO8859_4},
 	{"ISO-8859-4",	CharacterSet::ISO8859_4},
-	{"ISO8859_5",	CharacterSet::ISO8859_5},
 	{"ISO-8859-5",	CharacterSet::ISO8859_5},
-	{"ISO8859_6",	CharacterSet::ISO8859_6},
 	{"ISO-8859-6",	CharacterSet::ISO8859_6},
-	{"ISO8859_7",	CharacterSet::ISO8859_7},
 	{"ISO-8859-7",	CharacterSet::ISO8859_7},
-	{"ISO8859_8",	CharacterSet::ISO8859_8},
 	{"ISO-8859-8",	CharacterSet::ISO8859_8},
-	{"ISO8859_9",	CharacterSet::ISO8859_9},
 	{"ISO-8859-9",	CharacterSet::ISO8859_9},
+	{"ISO8859_1",	CharacterSet::ISO8859_1},
 	{"ISO8859_10",	CharacterSet::ISO8859_10},
-	{"ISO-8859-10",	CharacterSet::ISO8859_10},
 	{"ISO8859_11",	CharacterSet::ISO8859_11},
-	{"ISO-8859-11",	CharacterSet::ISO8859_11},
 	{"ISO8859_13",	CharacterSet::ISO8859_13},
-	{"ISO-8859-13",	CharacterSet::ISO8859_13},
 	{"ISO8859_14",	CharacterSet::ISO8859_14},
-	{"ISO-8859-14",	CharacterSet::ISO8859_14},
 	{"ISO8859_15",	CharacterSet::ISO8859_15},
-	{"ISO-8859-15",	CharacterSet::ISO8859_15},
 	{"ISO8859_16",	CharacterSet::ISO8859_16},
-	{"ISO-8859-16",	CharacterSet::ISO8859_16},
-	{"SJIS",		CharacterSet::Shift_JIS},
+	{"ISO8859_2",	CharacterSet::ISO8859_2},
+	{"ISO8859_3",	CharacterSet::ISO8859_3},
+	{"ISO8859_4",	CharacterSet::ISO8859_4},
+	{"ISO8859_5",	CharacterSet::ISO8859_5},
+	{"ISO8859_6",	CharacterSet::ISO8859_6},
+	{"ISO8859_7",	CharacterSet::ISO8859_7},
+	{"ISO8859_8",	CharacterSet::ISO8859_8},
+	{"ISO8859_9",	CharacterSet::ISO8859_9},
+	{"SJIS",			CharacterSet::Shift_JIS},
 	{"Shift_JIS",	CharacterSet::Shift_JIS},
-	{"Cp1250",		CharacterSet::Cp1250},
-	{"windows-1250",CharacterSet::Cp1250},
-	{"Cp1251",		CharacterSet::Cp1251},
-	{"windows-1251",CharacterSet::Cp1251},
-	{"Cp1252",		CharacterSet::Cp1252},
-	{"windows-1252",CharacterSet::Cp1252},
-	{"Cp1256",		CharacterSet::Cp1256},
-	{"windows-1256",CharacterSet::Cp1256},
-	{"UnicodeBigUnmarked", CharacterSet::UnicodeBig},
-	{"UTF-16BE",	CharacterSet::UnicodeBig},
-	{"UnicodeBig",	CharacterSet::UnicodeBig},
-	{"UTF8",		CharacterSet::UTF8},
+	{"US-ASCII",		CharacterSet::ASCII},
+	{"UTF-16BE",		CharacterSet::UnicodeBig},
 	{"UTF-8",		CharacterSet::UTF8},
-	{"ASCII",		CharacterSet::ASCII},
-	{"US-ASCII",	CharacterSet::ASCII},
-	{"Big5",		CharacterSet::Big5},
-	{"GB2312",		CharacterSet::GB2312},
-	{"GB18030",		CharacterSet::GB18030},
-	{"EUC_CN",		CharacterSet::GB18030},
-	{"EUC-CN",		CharacterSet::GB18030 },
-	{"GBK",			CharacterSet::GB18030},
-	{"EUC_KR",		CharacterSet::EUC_KR},
-	{"EUC-KR",		CharacterSet::EUC_KR },
+	{"UTF8",			CharacterSet::UTF8},
+	{"UnicodeBig",	CharacterSet::UnicodeBig},
+	{"UnicodeBigUnmarked", CharacterSet::UnicodeBig},
+	{"windows-1250",	CharacterSet::Cp1250},
+	{"windows-1251",	CharacterSet::Cp1251},
+	{"windows-1252",	CharacterSet::Cp1252},
+	{"windows-1256",	CharacterSet::Cp1256},
 };
 
+constexpr int StrCmp(const char* a, const char* b)
+{
+	while (*a && *a == *b)
+		++a, ++b;
+	return static_cast<unsigned char>(*a) - static_cast<unsigned char>(*b);
+}
+
+constexpr bool IsSorted(const NameCharset* begin, const NameCharset* end)
+{
+	for (auto i = begin + 1; i < end; ++i)
+		if (StrCmp(i[-1].name, i->name) >= 0)
+			return false;
+	return true;
+}
+
+static_assert(IsSorted(std::begin(ECI_NAME_TO_CHARSET), std::end(ECI_NAME_TO_CHARSET)),
+			  "ECI_NAME_TO_CHARSET has to be sorted by name");
+
 } // anonymous
 
 CharacterSet
 CharacterSetECI::CharsetFromValue(int value)
 {
-	auto it = ECI_VALUE_TO_CHARSET.find(value);
-	if (it != ECI_VALUE_TO_CHARSET.end())
-	{
-		return it->second;
-	}
+	if (value >= 0 && value < Size(ECI_VALUE_TO_CHARSET))
+		return ECI_VALUE_TO_CHARSET[value];
+	if (value == 170)
+		return CharacterSet::ASCII;
 	return CharacterSet::Unknown;
 }
 
 int
 CharacterSetECI::ValueForCharset(CharacterSet charset)
 {
-	for (auto& entry : ECI_VALUE_TO_CHARSET)
-	{
-		if (entry.second == charset)
-		{
-			return entry.first;
-		}
-	}
+	// the lowest value of a charset with several ones
+	auto it = std::find(std::begin(ECI_VALUE_TO_CHARSET), std::end(ECI_VALUE_TO_CHARSET), charset);
+	if (charset != CharacterSet::Unknown && it != std::end(ECI_VALUE_TO_CHARSET))
+		return static_cast<int>(it - std::begin(ECI_VALUE_TO_CHARSET));
 	return 0;
 }
 
 CharacterSet
 CharacterSetECI::CharsetFromName(const char* name)
 {
-	auto it = ECI_NAME_TO_CHARSET.find(name);
-	if (it != ECI_NAME_TO_CHARSET.end())
-	{
-		return it->second;
-	}
+	auto less = [](const NameCharset& entry, const char* name) { return std::strcmp(entry.name, name) < 0; };
+	auto it = std::lower_bound(std::begin(ECI_NAME_TO_CHARSET), std::end(ECI_NAME_TO_CHARSET), name, less);
+	if (it != std::end(ECI_NAME_TO_CHARSET) && std::strcmp(it->name, name) == 0)
+		return it->charset;
 	return CharacterSet::Unknown;
-};
+}
 
 } // ZXing
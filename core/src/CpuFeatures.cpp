@@ -0,0 +1,107 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "CpuFeatures.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+namespace ZXing {
+namespace CpuFeatures {
+
+static unsigned Bit(Isa isa)
+{
+	return 1u << static_cast<int>(isa);
+}
+
+static unsigned Supported()
+{
+	unsigned res = Bit(Isa::Scalar);
+#ifdef ZX_HAS_X86_DISPATCH
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("sse2"))
+		res |= Bit(Isa::SSE2);
+	if (__builtin_cpu_supports("ssse3"))
+		res |= Bit(Isa::SSSE3);
+	if (__builtin_cpu_supports("sse4.1"))
+		res |= Bit(Isa::SSE41);
+	if (__builtin_cpu_supports("avx2"))
+		res |= Bit(Isa::AVX2);
+#endif
+#ifdef ZX_HAS_NEON
+	res |= Bit(Isa::NEON);
+#endif
+#ifdef ZX_HAS_WASM_SIMD
+	res |= Bit(Isa::WasmSimd);
+#endif
+	return res;
+}
+
+// isa and everything it includes
+static unsigned UpTo(Isa isa)
+{
+	if (isa <= Isa::AVX2)
+		return (Bit(isa) << 1) - 1;
+	return Bit(Isa::Scalar) | Bit(isa);
+}
+
+static const Isa ALL[] = {Isa::Scalar, Isa::SSE2, Isa::SSSE3, Isa::SSE41, Isa::AVX2, Isa::NEON, Isa::WasmSimd};
+
+const char* ToString(Isa isa)
+{
+	static const char* const NAMES[] = {"scalar", "sse2", "ssse3", "sse4.1", "avx2", "neon", "wasm"};
+	return NAMES[static_cast<int>(isa)];
+}
+
+static unsigned Initial()
+{
+	unsigned res = Supported();
+	if (const char* forced = std::getenv("ZXING_FORCE_ISA"))
+		for (auto isa : ALL)
+			if (std::strcmp(forced, ToString(isa)) == 0)
+				res &= UpTo(isa);
+	return res;
+}
+
+static std::atomic<unsigned>& Enabled()
+{
+	static std::atomic<unsigned> enabled(Initial());
+	return enabled;
+}
+
+bool Has(Isa isa) noexcept
+{
+	return Enabled().load(std::memory_order_relaxed) & Bit(isa);
+}
+
+Isa Best() noexcept
+{
+	Isa res = Isa::Scalar;
+	for (auto isa : ALL)
+		if (Has(isa))
+			res = isa;
+	return res;
+}
+
+void SetMaxIsa(Isa isa) noexcept
+{
+	Enabled().store(Supported() & UpTo(isa), std::memory_order_relaxed);
+}
+
+} // CpuFeatures
+} // ZXing
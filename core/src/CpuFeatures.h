@@ -0,0 +1,83 @@
+#pragma once
+/*
+* Copyright 2020 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+/**
+* Helpers for SIMD code paths. On x86 the instruction set extensions are chosen at runtime (functions using them
+* are compiled with ZX_TARGET("...") and only called if the corresponding Has...() returns true), so the library
+* itself does not need to be built with any -m flags. NEON is always available on 64-bit ARM and is compiled in
+* whenever the compiler targets it, as is WebAssembly SIMD128 when building with -msimd128 (see wrappers/wasm).
+*
+* Every kernel has a scalar fallback. The cpu is queried once, the extensions can be limited with the environment
+* variable ZXING_FORCE_ISA (scalar, sse2, ssse3, sse4.1, avx2, neon or wasm) or SetMaxIsa(), e.g. to test the
+* fallbacks on a machine that has everything.
+*/
+
+#if (defined(__clang__) || defined(__GNUC__)) && (defined(__x86_64__) || defined(__i386__)) && !defined(ZX_DISABLE_SIMD)
+#define ZX_HAS_X86_DISPATCH
+#define ZX_TARGET(x) __attribute__((target(x)))
+#include <immintrin.h>
+#endif
+
+#if (defined(__ARM_NEON) || defined(__ARM_NEON__)) && !defined(ZX_DISABLE_SIMD)
+#define ZX_HAS_NEON
+#include <arm_neon.h>
+#endif
+
+#if defined(__wasm_simd128__) && !defined(ZX_DISABLE_SIMD)
+#define ZX_HAS_WASM_SIMD
+#include <wasm_simd128.h>
+#endif
+
+namespace ZXing {
+namespace CpuFeatures {
+
+/// Instruction set extensions, the x86 ones in ascending order, each including the ones before
+enum class Isa
+{
+	Scalar,
+	SSE2,
+	SSSE3,
+	SSE41,
+	AVX2,
+	NEON,
+	WasmSimd,
+};
+
+/// True if the kernels for isa are supported by the cpu and enabled
+bool Has(Isa isa) noexcept;
+
+/// The best enabled extension
+Isa Best() noexcept;
+
+/**
+* Limits the kernels to isa and the ones below it (Isa::Scalar disables all SIMD code), as long as the cpu supports
+* them. Not meant to be called while other threads are decoding, the change may not be visible to them right away.
+*/
+void SetMaxIsa(Isa isa) noexcept;
+
+/// The name as accepted by ZXING_FORCE_ISA
+const char* ToString(Isa isa);
+
+inline bool HasSSE2() { return Has(Isa::SSE2); }
+inline bool HasSSSE3() { return Has(Isa::SSSE3); }
+inline bool HasSSE41() { return Has(Isa::SSE41); }
+inline bool HasAVX2() { return Has(Isa::AVX2); }
+inline bool HasNEON() { return Has(Isa::NEON); }
+inline bool HasWasmSimd() { return Has(Isa::WasmSimd); }
+
+} // CpuFeatures
+} // ZXing
@@ -0,0 +1,38 @@
+/*
+* Copyright 2020 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "Deadline.h"
+
+namespace ZXing {
+
+static thread_local const Deadline* t_current = nullptr;
+
+Deadline::Scope::Scope(const Deadline& deadline) : _previous(t_current)
+{
+	t_current = &deadline;
+}
+
+Deadline::Scope::~Scope()
+{
+	t_current = _previous;
+}
+
+const Deadline* Deadline::Current() noexcept
+{
+	return t_current;
+}
+
+} // ZXing
@@ -0,0 +1,103 @@
+#pragma once
+/*
+* Copyright 2020 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <memory>
+
+namespace ZXing {
+
+/**
+* A Deadline describes the point in time after which a decoding attempt should be given up. A deadline created
+* via Cancellable() can additionally be cancelled explicitly, copies share its cancellation state. Plain deadlines
+* carry no such state, so creating and copying them does not allocate.
+*
+* The Reader interface does not carry any per-call state, so the deadline is installed for the current
+* thread via a Deadline::Scope object (see MultiFormatReader). Long running loops in the readers and
+* detectors poll Deadline::Expired() cooperatively and bail out early.
+*/
+class Deadline
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	/// Construct a deadline that never expires
+	Deadline() = default;
+
+	explicit Deadline(Clock::time_point end) : _end(end) {}
+
+	explicit Deadline(Clock::duration budget) : _end(Clock::now() + budget) {}
+
+	/// Construct a deadline that expires at end or when cancel() is called on it or any of its copies
+	static Deadline Cancellable(Clock::time_point end = Clock::time_point::max())
+	{
+		Deadline res(end);
+		res._cancelled = std::make_shared<std::atomic<bool>>(false);
+		return res;
+	}
+
+	Clock::time_point timePoint() const noexcept { return _end; }
+
+	bool isLimited() const noexcept { return _end != Clock::time_point::max(); }
+
+	bool hasExpired() const noexcept
+	{
+		return (_cancelled && _cancelled->load(std::memory_order_relaxed)) || (isLimited() && Clock::now() >= _end);
+	}
+
+	bool isCancellable() const noexcept { return _cancelled != nullptr; }
+
+	/// Requires a deadline created via Cancellable()
+	void cancel() noexcept
+	{
+		assert(_cancelled);
+		_cancelled->store(true, std::memory_order_relaxed);
+	}
+
+	/**
+	* Installs a deadline for the current thread for the lifetime of the Scope object.
+	* Scopes can be nested, the previous deadline is restored on destruction.
+	*/
+	class Scope
+	{
+		const Deadline* _previous;
+
+	public:
+		explicit Scope(const Deadline& deadline);
+		~Scope();
+
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+	};
+
+	/// Returns the deadline installed for the current thread or nullptr
+	static const Deadline* Current() noexcept;
+
+	/// Returns true if a deadline is installed for the current thread and it has expired
+	static bool Expired() noexcept
+	{
+		auto current = Current();
+		return current && current->hasExpired();
+	}
+
+private:
+	Clock::time_point _end = Clock::time_point::max();
+	std::shared_ptr<std::atomic<bool>> _cancelled;
+};
+
+} // ZXing
@@ -18,11 +18,20 @@
 
 #include "BarcodeFormat.h"
 
+#include <chrono>
+#include <cstdint>
+#include <functional>
 #include <vector>
 #include <string>
 
 namespace ZXing {
 
+class DecodeStats;
+class MemoryResource;
+struct SlowDecode;
+
+using SlowDecodeCallback = std::function<void(const SlowDecode&)>;
+
 /**
  * @brief The Binarizer enum
  *
@@ -36,6 +45,26 @@ enum class Binarizer : unsigned char // needs to unsigned for the bitfield below
 	GlobalHistogram, ///< T = valley between the 2 largest peaks in the histogram (per line in 1D case)
 	FixedThreshold,  ///< T = 127
 	BoolCast,        ///< T = 0, fastest possible
+	LocalMean,       ///< T = mean of the window around each pixel minus 15% for 2D and GlobalHistogram for 1D (IntegralImageBinarizer)
+};
+
+/**
+ * @brief The ColorStrategy enum
+ *
+ * Specify how color images are reduced to the single gray channel the binarizers work on.
+ */
+enum class ColorStrategy : unsigned char
+{
+	Luminance,   ///< 0.299 R + 0.587 G + 0.114 B (the green channel for FixedThreshold and BoolCast)
+	BestChannel, ///< the luminance or the R, G or B channel, whichever separates dark and light pixels best
+};
+
+/**
+ * Axis aligned rectangular image region in full-frame pixel coordinates
+ */
+struct ImageRegion
+{
+	int left, top, width, height;
 };
 
 class DecodeHints
@@ -47,18 +76,51 @@ class DecodeHints
 	bool _assumeCode39CheckDigit : 1;
 	bool _assumeGS1 : 1;
 	bool _returnCodabarStartEnd : 1;
-	Binarizer _binarizer : 2;
+	bool _tryParallel : 1;
+	bool _tryDownscale : 1;
+	bool _skipTextDecoding : 1;
+	bool _adaptiveReaderOrder : 1;
+	bool _adaptiveRowOrder : 1;
+	bool _tryCascade : 1;
+	bool _tryInvert : 1;
+	bool _tryOmnidirectional : 1;
+	Binarizer _binarizer : 3;
 
+	int _maxNumberOfSymbols = 0xFF;
+	int _downscaleThreshold = 500;
+	int _downscaleFactor = 2;
+	int _binarizerThreads = 1;
+	int _rowScanThreads = 1;
+	int _minLineCount = 1;
+	int _scanStride = 1;
+	int _binarizerWindowSize = 0;
+	int _binarizerBlockSize = 8;
+	int _expectedDimension = 0;
+	int _expectedRotation = -1;
+	float _minModuleSize = 0;
+	float _maxModuleSize = 0;
+	std::chrono::milliseconds _timeout = {};
+	DecodeStats* _stats = nullptr;
+	MemoryResource* _memoryResource = nullptr;
+	int64_t _maxMemory = 0;
+	int _maxSymbolSize = 0;
+	int _resultCacheSize = 0;
+	ColorStrategy _colorStrategy = ColorStrategy::Luminance;
+	std::chrono::milliseconds _slowDecodeThreshold = {};
+	SlowDecodeCallback _slowDecodeCallback;
 	BarcodeFormats _formats = BarcodeFormat::INVALID;
 	std::string _characterSet;
 	std::vector<int> _allowedLengths;
 	std::vector<int> _allowedEanExtensions;
+	std::vector<ImageRegion> _regionsOfInterest;
 
 public:
 	// bitfields don't get default initialized to 0.
 	DecodeHints()
 		: _tryHarder(0), _tryRotate(0), _isPure(0), _tryCode39ExtendedMode(0), _assumeCode39CheckDigit(0),
-		  _assumeGS1(0), _returnCodabarStartEnd(0), _binarizer(Binarizer::LocalAverage)
+		  _assumeGS1(0), _returnCodabarStartEnd(0), _tryParallel(0), _tryDownscale(0),
+		  _skipTextDecoding(0), _adaptiveReaderOrder(0), _adaptiveRowOrder(0), _tryCascade(0), _tryInvert(0),
+		  _tryOmnidirectional(0), _binarizer(Binarizer::LocalAverage)
 	{}
 
 #define ZX_PROPERTY(TYPE, GETTER, SETTER) \
@@ -74,15 +136,155 @@ public:
 	/// Also try detecting code in 90, 180 and 270 degree rotated images.
 	ZX_PROPERTY(bool, tryRotate, setTryRotate)
 
+	/// Also look for inverted symbols (light modules on a dark background, e.g. laser etched parts or dark mode
+	/// screens) if nothing was found. The inverted image is derived from the binary image of the first pass, so it
+	/// is not binarized again. See also Result::isInverted().
+	ZX_PROPERTY(bool, tryInvert, setTryInvert)
+
+	/// Also look for 1D symbols at the angles in between the rows and the columns (in steps of 22.5 degrees) if not
+	/// enough were found. The binary image is sampled along lines at these angles, it is not rotated. The ORIENTATION
+	/// metadata of such a result is the angle, rounded down to full degrees.
+	ZX_PROPERTY(bool, tryOmnidirectional, setTryOmnidirectional)
+
+	/// Run the readers for the individual formats concurrently (on the same binary image), the result is still
+	/// chosen based on the usual format priority. Only useful if more than one format is searched for.
+	ZX_PROPERTY(bool, tryParallel, setTryParallel)
+
+	/// Try the readers in the order of their recent success instead of the fixed format priority, so e.g. a stream of
+	/// QR Codes doesn't pay for the 1D scan of every frame. Only meant for a reader used for many images. If an image
+	/// contains symbols of several formats, a different one than with the fixed order may be returned.
+	ZX_PROPERTY(bool, adaptiveReaderOrder, setAdaptiveReaderOrder)
+
+	/// Let the 1D readers scan the horizontal bands of the image that contain the most bars first instead of going
+	/// middle-out. Without tryHarder, the rows are then no longer restricted to the middle half of the image, so symbols
+	/// close to the top or bottom edge are found as well. With tryHarder, every row of the usual scan is still scanned
+	/// eventually, but a symbol is typically found after fewer rows.
+	ZX_PROPERTY(bool, adaptiveRowOrder, setAdaptiveRowOrder)
+
+	/// If nothing is found with the given binarizer, retry with the LocalAverage and GlobalHistogram binarizers, then
+	/// with tryRotate and finally with tryHarder (see CascadeAttempts()). The luminance image is converted only once
+	/// and each binary image is shared by all attempts with that binarizer. A BarcodeScanner tries the attempts that
+	/// succeeded most often first, the timeout applies to the whole cascade. Result::cascadeAttempt() tells which
+	/// attempt found the symbol. Only affects read(), not readMultiple().
+	ZX_PROPERTY(bool, tryCascade, setTryCascade)
+
+	/// Number of horizontal bands the LocalAverage binarizer splits large images into to process them in parallel
+	/// (using ParallelFor, see Parallel.h for plugging in a custom thread pool).
+	ZX_PROPERTY(int, binarizerThreads, setBinarizerThreads)
+
+	/// Number of threads the 1D readers split the scanned rows across with tryHarder (using ParallelFor). The row
+	/// closest to the image center still wins, but the RSS readers may combine the rows of stacked symbols differently.
+	/// The QR Code finder pattern search scans bands of rows concurrently, with the same result as a single thread.
+	/// Since it then scans every row instead of skipping some, this only pays off with more than 2 threads.
+	/// The Data Matrix multi-symbol detection (see MultiFormatReader::readMultiple) traces its seed lines concurrently.
+	ZX_PROPERTY(int, rowScanThreads, setRowScanThreads)
+
+	/// Number of scan lines of a 1D symbol that have to agree on the content before it is accepted. Results found in
+	/// fewer lines (e.g. misreads of a noisy image) are dropped, see also Result::lineCount().
+	ZX_PROPERTY(int, minLineCount, setMinLineCount)
+
+	/// Scan density of the pattern searches of all detectors, for a predictable CPU time per frame on slow devices:
+	/// the 1D readers scan every scanStride-th of their rows, the QR Code finder pattern search, the Aztec and MaxiCode
+	/// bull's eye searches and the PDF417 guard pattern search skip that many times more rows, the Data Matrix detector
+	/// only tries edges at least scanStride pixels apart as the start of a symbol and spaces its seed lines that much
+	/// wider. Symbols with modules smaller than about scanStride pixels may then be missed. 1 (the default) scans as
+	/// usual.
+	ZX_PROPERTY(int, scanStride, setScanStride)
+
+	/// Time budget per call of MultiFormatReader::read or BarcodeScanner::read/readMultiple (0 means unlimited). The
+	/// BarcodeScanner shares it between all tiles, pyramid levels and cascade attempts of a call. Once it is exhausted,
+	/// the readers give up cooperatively and the call returns DecodeStatus::Timeout unless a symbol has been found.
+	ZX_PROPERTY(std::chrono::milliseconds, timeout, setTimeout)
+
+	/// Collect the time spent per stage and reader plus some counters and the memory use of every decode call (see
+	/// DecodeStats). The object is not owned, nullptr (the default) disables the collection.
+	ZX_PROPERTY(DecodeStats*, stats, setStats)
+
+	/// Calls of BarcodeScanner::read(Multiple) (and so ReadBarcode(s)) that take at least slowDecodeThreshold are passed
+	/// to slowDecodeCallback together with the hints and the DecodeStats of just that call, see SlowDecode. Meant to
+	/// collect the latency outliers for reproduction, e.g. with WriteSlowDecode. The callback runs on the thread that
+	/// called read, the times reported to stats are not affected.
+	ZX_PROPERTY(std::chrono::milliseconds, slowDecodeThreshold, setSlowDecodeThreshold)
+
+	/// See slowDecodeThreshold, an empty function (the default) disables the capture.
+	ZX_PROPERTY(SlowDecodeCallback, slowDecodeCallback, setSlowDecodeCallback)
+
+	/// Where the temporary buffers of every decode call are allocated (see MemoryResource), e.g. a
+	/// MonotonicBufferResource per request that is released in one go afterwards. The object is not owned, nullptr
+	/// (the default) means operator new/delete, or a RecyclingMemoryResource of the BarcodeScanner.
+	ZX_PROPERTY(MemoryResource*, memoryResource, setMemoryResource)
+
+	/// Upper limit in bytes for the memory ReadBarcode(s) may use for the binarized image and its copies (0 means
+	/// unlimited). Larger images are box-filtered down (see downscaleFactor, at least 2) until the estimated working
+	/// set fits, the returned positions are still in full-frame coordinates. See DecodeStats::peakBytes() for the
+	/// actual peak.
+	ZX_PROPERTY(int64_t, maxMemory, setMaxMemory)
+
+	/// Scan box-filtered, downscaled versions of large input images first (coarsest level first). ReadBarcode falls
+	/// back to the next finer level only if nothing was found, ReadBarcodes scans all levels and merges the symbols
+	/// found on several of them. Only affects a luminance based binarizer.
+	ZX_PROPERTY(bool, tryDownscale, setTryDownscale)
+
+	/// Image size ( min(width, height) ) above which another, downscaled pyramid level is created (see tryDownscale).
+	ZX_PROPERTY(int, downscaleThreshold, setDownscaleThreshold)
+
+	/// Scale factor between two consecutive pyramid levels, usually 2 or 4 (see tryDownscale).
+	ZX_PROPERTY(int, downscaleFactor, setDownscaleFactor)
+
+	/// Largest expected size of a symbol in pixels, including its quiet zone (0 means unknown). Images larger than 4
+	/// times that are read in tiles of 4 x maxSymbolSize pixels overlapping by maxSymbolSize, so each symbol is
+	/// completely inside at least one tile. The tiles are read in parallel (see ParallelFor) and the memory needed at
+	/// once is bounded by the size of the tiles instead of the whole image. Results found in more than one tile are
+	/// only reported once.
+	ZX_PROPERTY(int, maxSymbolSize, setMaxSymbolSize)
+
+	/// Number of images whose results a BarcodeScanner keeps (0, the default, disables the cache). A byte-identical
+	/// image, e.g. a reprinted label uploaded again, is then answered from the cache instead of being decoded. The key
+	/// is a 64-bit xxHash of the pixels plus the size and format of the image (the hints are fixed per scanner), the
+	/// least recently used entry is dropped when the cache is full. Results of calls that ran into the timeout are
+	/// not cached. See DecodeStats::cacheHits() and cacheMisses().
+	ZX_PROPERTY(int, resultCacheSize, setResultCacheSize)
+
 	/// Binarizer to use internally when using the ReadBarcode function
 	ZX_PROPERTY(Binarizer, binarizer, setBinarizer)
 
+	/// How color images are converted to gray before binarization. BestChannel compares the luminance and the single
+	/// color channels on a subsampled histogram of the image and uses the one with the largest contrast between the
+	/// dark and the light pixels, e.g. the green or blue channel for red on white.
+	ZX_PROPERTY(ColorStrategy, colorStrategy, setColorStrategy)
+
+	/// Window size in pixels used by the LocalMean binarizer, 0 means the default (40).
+	ZX_PROPERTY(int, binarizerWindowSize, setBinarizerWindowSize)
+
+	/// Block size in pixels used by the LocalAverage binarizer: 8 (default), 16 or 32. 0 chooses it from minModuleSize
+	/// if that is set, or else from a quick estimate of the module size in the image. Larger blocks suit large modules.
+	ZX_PROPERTY(int, binarizerBlockSize, setBinarizerBlockSize)
+
 	/// Set to true if the input contains nothing but a perfectly aligned barcode (generated image)
 	ZX_PROPERTY(bool, isPure, setIsPure)
 
+	/// Number of modules per side of the expected symbols, e.g. 29 for a QR Code version 3 (0 means unknown). The
+	/// QR Code detector then skips estimating the module size and the dimension from the finder patterns.
+	ZX_PROPERTY(int, expectedDimension, setExpectedDimension)
+
+	/// Smallest expected module size in pixels (0 means no limit). The QR Code detector ignores finder patterns and
+	/// symbols with smaller modules.
+	ZX_PROPERTY(float, minModuleSize, setMinModuleSize)
+
+	/// Largest expected module size in pixels (0 means no limit), see minModuleSize.
+	ZX_PROPERTY(float, maxModuleSize, setMaxModuleSize)
+
+	/// Expected clockwise rotation of the symbols in degrees (-1 means unknown). The QR Code detector ignores symbols
+	/// that are rotated by more than 45 degrees from it.
+	ZX_PROPERTY(int, expectedRotation, setExpectedRotation)
+
 	/// Specifies what character encoding to use when decoding, where applicable.
 	ZX_PROPERTY(std::string, characterSet, setCharacterSet)
 
+	/// Only return the raw bytes (Result::rawBytes and the BYTE_SEGMENTS metadata) of a QR Code and leave its text
+	/// empty. This skips the guessing of the character set and the conversion of byte, Kanji and Hanzi segments.
+	ZX_PROPERTY(bool, skipTextDecoding, setSkipTextDecoding)
+
 	/// Allowed lengths of encoded data -- reject anything else..
 	ZX_PROPERTY(std::vector<int>, allowedLengths, setAllowedLengths)
 
@@ -114,6 +316,13 @@ public:
 	*/
 	ZX_PROPERTY(std::vector<int>, allowedEanExtensions, setAllowedEanExtensions)
 
+	/// Maximum number of symbols to detect when using ReadBarcodes / MultiFormatReader::readMultiple
+	ZX_PROPERTY(int, maxNumberOfSymbols, setMaxNumberOfSymbols)
+
+	/// Restrict binarization and detection to the given image regions (empty means the whole image). The regions are
+	/// processed in the given order, the returned positions are in full-frame coordinates.
+	ZX_PROPERTY(std::vector<ImageRegion>, regionsOfInterest, setRegionsOfInterest)
+
 #undef ZX_PROPERTY
 
 	bool hasFormat(BarcodeFormat f) const noexcept { return _formats.testFlag(f); }
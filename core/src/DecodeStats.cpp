@@ -0,0 +1,127 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "DecodeStats.h"
+
+namespace ZXing {
+
+static thread_local DecodeStats* t_current = nullptr;
+static thread_local DecodeStats::StageTimer* t_currentTimer = nullptr;
+static thread_local bool t_inReader = false;
+
+DecodeStats::DecodeStats() : _memory(std::make_shared<Memory>())
+{
+	reset();
+}
+
+void DecodeStats::reset()
+{
+	for (auto& c : _stageTimes)
+		c = 0;
+	for (auto& c : _readerTimes)
+		c = 0;
+	_rowsScanned = 0;
+	_finderCandidates = 0;
+	_errorsCorrected = 0;
+	_cacheHits = 0;
+	_cacheMisses = 0;
+	_memory->count = 0;
+	_memory->peak = _memory->current.load();
+}
+
+void DecodeStats::add(const DecodeStats& other)
+{
+	for (size_t i = 0; i < _stageTimes.size(); ++i)
+		_stageTimes[i] += other._stageTimes[i].load(std::memory_order_relaxed);
+	for (size_t i = 0; i < _readerTimes.size(); ++i)
+		_readerTimes[i] += other._readerTimes[i].load(std::memory_order_relaxed);
+	_rowsScanned += other.rowsScanned();
+	_finderCandidates += other.finderCandidates();
+	_errorsCorrected += other.errorsCorrected();
+	_cacheHits += other.cacheHits();
+	_cacheMisses += other.cacheMisses();
+	_memory->count += other.allocations();
+	int64_t otherPeak = other.peakBytes();
+	int64_t peak = _memory->peak.load(std::memory_order_relaxed);
+	while (otherPeak > peak && !_memory->peak.compare_exchange_weak(peak, otherPeak, std::memory_order_relaxed))
+		;
+}
+
+DecodeStats* DecodeStats::Current() noexcept
+{
+	return t_current;
+}
+
+DecodeStats::Scope::Scope(DecodeStats* stats) : _previous(t_current)
+{
+	t_current = stats;
+}
+
+DecodeStats::Scope::~Scope()
+{
+	t_current = _previous;
+}
+
+void DecodeStats::StageTimer::start()
+{
+	_parent = t_currentTimer;
+	t_currentTimer = this;
+	_start = Clock::now();
+}
+
+void DecodeStats::StageTimer::stop()
+{
+	auto elapsed = Clock::now() - _start;
+	_stats->_stageTimes[static_cast<int>(_stage)] += (elapsed - _nested).count();
+	if (_parent)
+		_parent->_nested += elapsed;
+	t_currentTimer = _parent;
+}
+
+void DecodeStats::ReaderTimer::start()
+{
+	if (t_inReader) {
+		_stats = nullptr;
+		return;
+	}
+	t_inReader = true;
+	_start = Clock::now();
+}
+
+void DecodeStats::ReaderTimer::stop()
+{
+	_stats->_readerTimes[static_cast<int>(_reader)] += (Clock::now() - _start).count();
+	t_inReader = false;
+}
+
+void DecodeStats::Allocation::add(DecodeStats& stats)
+{
+	_memory = stats._memory;
+	++_memory->count;
+	int64_t current = _memory->current += _bytes;
+	int64_t peak = _memory->peak.load(std::memory_order_relaxed);
+	while (current > peak && !_memory->peak.compare_exchange_weak(peak, current, std::memory_order_relaxed))
+		;
+}
+
+void DecodeStats::Allocation::release()
+{
+	_memory->current -= _bytes;
+	_memory.reset();
+}
+
+} // ZXing
@@ -0,0 +1,250 @@
+#pragma once
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+namespace ZXing {
+
+/**
+* Where the time of decode calls went. Collection is enabled by passing a DecodeStats object to
+* DecodeHints::setStats, the caller keeps it alive while the reader is used. The values accumulate over all calls
+* until reset(); a single object may be shared by readers running concurrently.
+*
+* Like the Deadline, the stats are installed for the current thread via a Scope (see MultiFormatReader). Without
+* one, the timers and counters in the library reduce to a check of a thread local pointer.
+*
+* Stage times are exclusive: the time spent sampling the grid during detection counts as Sample only. Work that is
+* split across threads (see DecodeHints::rowScanThreads) is summed over the threads.
+*/
+class DecodeStats
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	enum class Stage
+	{
+		Binarize,        ///< computing the BitMatrix from the luminance image
+		Detect,          ///< locating symbols, incl. the 1D row scans
+		Sample,          ///< sampling the module grid (GridSampler)
+		ErrorCorrection, ///< Reed-Solomon (or PDF417 modulus) error correction
+		DecodeText,      ///< turning the corrected codewords into text
+		_count
+	};
+
+	enum class ReaderType
+	{
+		OneD,
+		QRCode,
+		DataMatrix,
+		Aztec,
+		PDF417,
+		MaxiCode,
+		_count
+	};
+
+	DecodeStats();
+	DecodeStats(const DecodeStats&) = delete;
+	DecodeStats& operator=(const DecodeStats&) = delete;
+
+	/// Exclusive time spent in a stage
+	std::chrono::nanoseconds time(Stage stage) const { return load(_stageTimes[static_cast<int>(stage)]); }
+
+	/// Total time spent in a reader (all stages of its decode calls)
+	std::chrono::nanoseconds time(ReaderType reader) const { return load(_readerTimes[static_cast<int>(reader)]); }
+
+	/// Rows of the image the 1D readers looked at
+	int64_t rowsScanned() const { return _rowsScanned.load(std::memory_order_relaxed); }
+
+	/// Finder pattern candidates the QR Code finder confirmed (cross checked)
+	int64_t finderCandidates() const { return _finderCandidates.load(std::memory_order_relaxed); }
+
+	/// Codewords fixed by error correction
+	int64_t errorsCorrected() const { return _errorsCorrected.load(std::memory_order_relaxed); }
+
+	/// Calls of a BarcodeScanner answered from / not found in its result cache, see DecodeHints::resultCacheSize
+	int64_t cacheHits() const { return _cacheHits.load(std::memory_order_relaxed); }
+	int64_t cacheMisses() const { return _cacheMisses.load(std::memory_order_relaxed); }
+
+	/// Number of image sized buffers allocated (binarized images, luminance copies, rotated and sampled copies)
+	int64_t allocations() const { return _memory->count.load(std::memory_order_relaxed); }
+
+	/**
+	* Highest number of bytes held in those buffers at the same time. If the stats are shared by concurrent calls,
+	* this is the peak of all of them together. reset() restarts it from the bytes currently held.
+	*/
+	int64_t peakBytes() const { return _memory->peak.load(std::memory_order_relaxed); }
+
+	void reset();
+
+	/**
+	* Adds the values of other, e.g. the stats of a single call, to these. The peak memory becomes the larger of the
+	* two peaks.
+	*/
+	void add(const DecodeStats& other);
+
+	// Recording, used by the library
+
+	static DecodeStats* Current() noexcept;
+
+	static void AddRowsScanned(int64_t n) { if (auto s = Current()) s->_rowsScanned += n; }
+	static void AddFinderCandidates(int64_t n) { if (auto s = Current()) s->_finderCandidates += n; }
+	static void AddErrorsCorrected(int64_t n) { if (auto s = Current()) s->_errorsCorrected += n; }
+	static void AddCacheLookup(bool hit) { if (auto s = Current()) ++(hit ? s->_cacheHits : s->_cacheMisses); }
+
+	/**
+	* Installs the stats for the current thread for the lifetime of the Scope object, nullptr disables them.
+	* Scopes can be nested, the previous stats are restored on destruction.
+	*/
+	class Scope
+	{
+		DecodeStats* _previous;
+
+	public:
+		explicit Scope(DecodeStats* stats);
+		~Scope();
+
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+	};
+
+	/**
+	* Adds the time until its destruction to a stage, minus the time of StageTimers nested inside it on the
+	* same thread.
+	*/
+	class StageTimer
+	{
+		DecodeStats* _stats;
+		Stage _stage;
+		StageTimer* _parent = nullptr;
+		Clock::time_point _start;
+		Clock::duration _nested = {};
+
+		void start();
+		void stop();
+
+	public:
+		explicit StageTimer(Stage stage) : _stats(Current()), _stage(stage)
+		{
+			if (_stats)
+				start();
+		}
+		~StageTimer()
+		{
+			if (_stats)
+				stop();
+		}
+
+		StageTimer(const StageTimer&) = delete;
+		StageTimer& operator=(const StageTimer&) = delete;
+	};
+
+	/**
+	* Adds the time until its destruction to a reader. Only the outermost ReaderTimer on a thread counts, so a
+	* reader forwarding to another of its decode overloads is not counted twice.
+	*/
+	class ReaderTimer
+	{
+		DecodeStats* _stats;
+		ReaderType _reader;
+		Clock::time_point _start;
+
+		void start();
+		void stop();
+
+	public:
+		explicit ReaderTimer(ReaderType reader) : _stats(Current()), _reader(reader)
+		{
+			if (_stats)
+				start();
+		}
+		~ReaderTimer()
+		{
+			if (_stats)
+				stop();
+		}
+
+		ReaderTimer(const ReaderTimer&) = delete;
+		ReaderTimer& operator=(const ReaderTimer&) = delete;
+	};
+
+private:
+	using Counter = std::atomic<int64_t>;
+
+	struct Memory
+	{
+		Counter current{0}, peak{0}, count{0};
+	};
+
+public:
+	/**
+	* Accounts a buffer of the given size to the stats installed at construction, for the lifetime of the Allocation.
+	* The large buffers of the library (BitMatrix, the pixels of GenericLuminanceSource) carry one. The Allocation
+	* keeps the accounting alive, so the buffer may outlive the DecodeStats object.
+	*/
+	class Allocation
+	{
+		std::shared_ptr<Memory> _memory;
+		int64_t _bytes = 0;
+
+		void add(DecodeStats& stats);
+		void release();
+
+	public:
+		Allocation() = default;
+		explicit Allocation(int64_t bytes) : _bytes(bytes)
+		{
+			if (auto stats = Current())
+				add(*stats);
+		}
+		Allocation(const Allocation& other) : Allocation(other._bytes) {}
+		Allocation(Allocation&& other) noexcept : _memory(std::move(other._memory)), _bytes(other._bytes) {}
+		~Allocation()
+		{
+			if (_memory)
+				release();
+		}
+
+		Allocation& operator=(Allocation&& other) noexcept
+		{
+			if (_memory)
+				release();
+			_memory = std::move(other._memory);
+			_bytes = other._bytes;
+			return *this;
+		}
+		Allocation& operator=(const Allocation&) = delete;
+	};
+
+private:
+
+	static std::chrono::nanoseconds load(const Counter& c)
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::duration(c.load(std::memory_order_relaxed)));
+	}
+
+	std::array<Counter, static_cast<int>(Stage::_count)> _stageTimes;
+	std::array<Counter, static_cast<int>(ReaderType::_count)> _readerTimes;
+	Counter _rowsScanned, _finderCandidates, _errorsCorrected, _cacheHits, _cacheMisses;
+	std::shared_ptr<Memory> _memory;
+};
+
+} // ZXing
@@ -25,6 +25,7 @@ enum class DecodeStatus
 	NotFound,
 	FormatError,
 	ChecksumError,
+	Timeout,
 #ifdef ZX_USE_NEW_ROW_READERS
 	_internal // this is for internal/temporary use until all 1D readers support the new Pattern API
 #endif
@@ -42,7 +43,7 @@ inline bool StatusIsError(DecodeStatus status)
 
 inline const char* ToString(DecodeStatus status)
 {
-	constexpr const char* names[] = {"NoError", "NotFound", "FormatError", "ChecksumError"};
+	constexpr const char* names[] = {"NoError", "NotFound", "FormatError", "ChecksumError", "Timeout"};
 	return names[static_cast<int>(status)];
 }
 
@@ -17,11 +17,11 @@
 */
 
 #include "ByteArray.h"
+#include "ByteSegments.h"
 #include "DecodeStatus.h"
 #include "ZXContainerAlgorithms.h"
 
 #include <memory>
-#include <list>
 #include <string>
 #include <utility>
 
@@ -42,7 +42,7 @@ class DecoderResult
 	ByteArray _rawBytes;
 	int _numBits = 0;
 	std::wstring _text;
-	std::list<ByteArray> _byteSegments;
+	ByteSegments _byteSegments;
 	std::wstring _ecLevel;
 	int _errorsCorrected = -1;
 	int _erasures = -1;
@@ -88,7 +88,7 @@ public:
 	DecoderResult&& SETTER(TYPE&& v) && { _##GETTER = std::move(v); return std::move(*this); }
 
 	ZX_PROPERTY(int, numBits, setNumBits)
-	ZX_PROPERTY(std::list<ByteArray>, byteSegments, setByteSegments)
+	ZX_PROPERTY(ByteSegments, byteSegments, setByteSegments)
 	ZX_PROPERTY(std::wstring, ecLevel, setEcLevel)
 	ZX_PROPERTY(int, errorsCorrected, setErrorsCorrected)
 	ZX_PROPERTY(int, erasures, setErasures)
@@ -0,0 +1,85 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "EdgeOrientation.h"
+
+#include "BinaryBitmap.h"
+#include "BitArray.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace ZXing {
+
+// out-of-line definitions, std::min takes its arguments by reference (C++14 has no inline variables)
+constexpr int EdgeOrientation::NUM_BINS;
+constexpr int EdgeOrientation::NUM_BANDS;
+
+EdgeOrientation::EdgeOrientation(const BinaryBitmap& image)
+{
+	constexpr double PI = 3.14159265358979323846;
+
+	int width = image.width();
+	int height = image.height();
+	if (width < 3 || height < 3)
+		return;
+
+	int numBands = std::min(NUM_BANDS, height / 3);
+	std::array<BitArray, 3> rows;
+	for (int band = 0; band < numBands; ++band) {
+		// the middle row of the band, the bands are spread evenly over the height
+		int y = 1 + (height - 2) * (2 * band + 1) / (2 * numBands);
+		bool ok = true;
+		for (int i = 0; i < 3 && ok; ++i)
+			ok = image.getBlackRow(y - 1 + i, rows[i]);
+		if (!ok)
+			continue;
+
+		auto at = [&](int i, int x) { return static_cast<int>(rows[i].get(x)); };
+		for (int x = 1; x < width - 1; ++x) {
+			int gx = at(0, x + 1) + 2 * at(1, x + 1) + at(2, x + 1) - at(0, x - 1) - 2 * at(1, x - 1) - at(2, x - 1);
+			int gy = at(2, x - 1) + 2 * at(2, x) + at(2, x + 1) - at(0, x - 1) - 2 * at(0, x) - at(0, x + 1);
+			if (gx == 0 && gy == 0)
+				continue;
+			// the direction of the gradient modulo 180 degrees, image y pointing down as in DoDecodeOmnidirectional
+			double angle = std::atan2(gy, gx);
+			if (angle < 0)
+				angle += PI;
+			int bin = static_cast<int>(std::lround(angle * NUM_BINS / PI)) % NUM_BINS;
+			int weight = std::abs(gx) + std::abs(gy);
+			_bins[bin] += weight;
+			_total += weight;
+		}
+	}
+}
+
+bool EdgeOrientation::prefersColumns() const
+{
+	// the rows stay first unless the columns clearly dominate, a mostly diagonal image is scanned as before
+	return _bins[NUM_BINS / 2] > 2 * _bins[0];
+}
+
+std::array<int, EdgeOrientation::NUM_BINS> EdgeOrientation::binsByCount() const
+{
+	std::array<int, NUM_BINS> res;
+	std::iota(res.begin(), res.end(), 0);
+	std::stable_sort(res.begin(), res.end(), [this](int a, int b) { return _bins[a] > _bins[b]; });
+	return res;
+}
+
+} // ZXing
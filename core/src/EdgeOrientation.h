@@ -0,0 +1,57 @@
+#pragma once
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include <array>
+
+namespace ZXing {
+
+class BinaryBitmap;
+
+/**
+* A histogram of the directions of the edges in an image, used to decide in which direction to look for barcodes
+* first. Bin i counts the edges (weighted by their contrast) whose gradient points in the direction of
+* i * 180 / NUM_BINS degrees, plus or minus half a bin and modulo 180, i.e. the edges a scan line in that direction
+* crosses at a right angle. The bars of a 1D symbol read along the rows fall into bin 0, the ones of a symbol read
+* along the columns into bin NUM_BINS / 2.
+*
+* It applies a Sobel operator to the black rows of a few thin bands spread over the image, so it costs about as much
+* as binarizing 3 * NUM_BANDS rows. BinaryBitmap::getEdgeOrientation() shares one per image between all readers.
+*/
+class EdgeOrientation
+{
+public:
+	static constexpr int NUM_BINS = 8;
+	static constexpr int NUM_BANDS = 24;
+
+	explicit EdgeOrientation(const BinaryBitmap& image);
+
+	int count(int bin) const { return _bins[bin]; }
+	int total() const { return _total; }
+
+	/// True if clearly more edges face the columns than the rows, so that a rotated scan should come first
+	bool prefersColumns() const;
+
+	/// The bins by decreasing count, ties keep their order
+	std::array<int, NUM_BINS> binsByCount() const;
+
+private:
+	std::array<int, NUM_BINS> _bins = {};
+	int _total = 0;
+};
+
+} // ZXing
@@ -0,0 +1,65 @@
+#pragma once
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "DecodeHints.h"
+#include "Point.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ZXing {
+
+/**
+* What is known about the symbols in advance, see DecodeHints::expectedDimension, minModuleSize, maxModuleSize and
+* expectedRotation. Detectors use it to drop candidates that don't match and to skip estimating what is known. A
+* default constructed one knows nothing and accepts everything.
+*/
+struct ExpectedGeometry
+{
+	int dimension = 0;        // modules per side, 0 if unknown
+	float minModuleSize = 0;  // in pixels, 0 if unbounded
+	float maxModuleSize = 0;  // in pixels, 0 if unbounded
+	int rotation = -1;        // clockwise in degrees, -1 if unknown
+
+	ExpectedGeometry() = default;
+
+	explicit ExpectedGeometry(const DecodeHints& hints) :
+		dimension(hints.expectedDimension()),
+		minModuleSize(hints.minModuleSize()),
+		maxModuleSize(hints.maxModuleSize()),
+		rotation(hints.expectedRotation())
+	{}
+
+	bool acceptsModuleSize(float moduleSize) const
+	{
+		return (minModuleSize <= 0 || moduleSize >= minModuleSize) && (maxModuleSize <= 0 || moduleSize <= maxModuleSize);
+	}
+
+	/// True if the top edge of a symbol, running from its top-left towards its top-right corner, is within 45 degrees
+	/// of the expected rotation.
+	bool acceptsTopEdge(PointF topEdge) const
+	{
+		if (rotation < 0)
+			return true;
+		constexpr double PI = 3.14159265358979323846;
+		double angle = std::atan2(topEdge.y, topEdge.x) * 180 / PI; // clockwise, since y points down
+		double diff = std::fmod(std::abs(angle - rotation), 360.0);
+		return std::min(diff, 360 - diff) <= 45;
+	}
+};
+
+} // ZXing
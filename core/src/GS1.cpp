@@ -0,0 +1,325 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "GS1.h"
+#include "DecodeStatus.h"
+#include "ZXContainerAlgorithms.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace ZXing {
+namespace GS1 {
+
+struct AiInfo
+{
+	const char* aiPrefix; // the AI, or its first three digits if the fourth one is a parameter (e.g. a decimal point)
+	int fieldSize;        // if negative, the length is variable and abs(length) give the max size
+};
+
+static constexpr AiInfo aiInfos[] = {
+// TWO_DIGIT_DATA_LENGTH
+	{ "00", 18 },
+	{ "01", 14 },
+	{ "02", 14 },
+
+	{ "10", -20 },
+	{ "11", 6 },
+	{ "12", 6 },
+	{ "13", 6 },
+	{ "15", 6 },
+	{ "17", 6 },
+
+	{ "20", 2 },
+	{ "21", -20 },
+	{ "22", -29 },
+
+	{ "30", -8 },
+	{ "37", -8 },
+
+	//internal company codes
+	{ "90", -30 },
+	{ "91", -30 },
+	{ "92", -30 },
+	{ "93", -30 },
+	{ "94", -30 },
+	{ "95", -30 },
+	{ "96", -30 },
+	{ "97", -30 },
+	{ "98", -30 },
+	{ "99", -30 },
+
+//THREE_DIGIT_DATA_LENGTH
+	{ "240", -30 },
+	{ "241", -30 },
+	{ "242", -6 },
+	{ "250", -30 },
+	{ "251", -30 },
+	{ "253", -17 },
+	{ "254", -20 },
+
+	{ "400", -30 },
+	{ "401", -30 },
+	{ "402", 17 },
+	{ "403", -30 },
+	{ "410", 13 },
+	{ "411", 13 },
+	{ "412", 13 },
+	{ "413", 13 },
+	{ "414", 13 },
+	{ "420", -20 },
+	{ "421", -15 },
+	{ "422", 3 },
+	{ "423", -15 },
+	{ "424", 3 },
+	{ "425", 3 },
+	{ "426", 3 },
+
+//THREE_DIGIT_PLUS_DIGIT_DATA_LENGTH
+	{ "310", 6 },
+	{ "311", 6 },
+	{ "312", 6 },
+	{ "313", 6 },
+	{ "314", 6 },
+	{ "315", 6 },
+	{ "316", 6 },
+	{ "320", 6 },
+	{ "321", 6 },
+	{ "322", 6 },
+	{ "323", 6 },
+	{ "324", 6 },
+	{ "325", 6 },
+	{ "326", 6 },
+	{ "327", 6 },
+	{ "328", 6 },
+	{ "329", 6 },
+	{ "330", 6 },
+	{ "331", 6 },
+	{ "332", 6 },
+	{ "333", 6 },
+	{ "334", 6 },
+	{ "335", 6 },
+	{ "336", 6 },
+	{ "340", 6 },
+	{ "341", 6 },
+	{ "342", 6 },
+	{ "343", 6 },
+	{ "344", 6 },
+	{ "345", 6 },
+	{ "346", 6 },
+	{ "347", 6 },
+	{ "348", 6 },
+	{ "349", 6 },
+	{ "350", 6 },
+	{ "351", 6 },
+	{ "352", 6 },
+	{ "353", 6 },
+	{ "354", 6 },
+	{ "355", 6 },
+	{ "356", 6 },
+	{ "357", 6 },
+	{ "360", 6 },
+	{ "361", 6 },
+	{ "362", 6 },
+	{ "363", 6 },
+	{ "364", 6 },
+	{ "365", 6 },
+	{ "366", 6 },
+	{ "367", 6 },
+	{ "368", 6 },
+	{ "369", 6 },
+	{ "390", -15 },
+	{ "391", -18 },
+	{ "392", -15 },
+	{ "393", -18 },
+	{ "7030", -30 },
+	{ "7031", -30 },
+	{ "7032", -30 },
+	{ "7033", -30 },
+	{ "7034", -30 },
+	{ "7035", -30 },
+	{ "7036", -30 },
+	{ "7037", -30 },
+	{ "7038", -30 },
+	{ "7039", -30 },
+
+//FOUR_DIGIT_DATA_LENGTH
+	{ "7001", 13 },
+	{ "7002", -30 },
+	{ "7003", 10 },
+
+	{ "8001", 14 },
+	{ "8002", -20 },
+	{ "8003", -30 },
+	{ "8004", -30 },
+	{ "8005", 6 },
+	{ "8006", 18 },
+	{ "8007", -30 },
+	{ "8008", -12 },
+	{ "8018", 18 },
+	{ "8020", -25 },
+	{ "8100", 6 },
+	{ "8101", 10 },
+	{ "8102", 2 },
+	{ "8110", -70 },
+	{ "8200", -70 },
+};
+
+/**
+* The AIs are looked up with a perfect hash: the first two digits of an AI determine its length and how many of its
+* digits identify the entry in aiInfos (the key). The numerical value of the key modulo HASH_SIZE is unique for all
+* entries, which is checked at compile time, so a lookup is one table access plus one comparison.
+*/
+static constexpr int HASH_SIZE = 429;
+
+struct AiTables
+{
+	struct Prefix
+	{
+		uint8_t aiSize;
+		uint8_t keySize;
+	} prefixes[100];
+
+	struct Entry
+	{
+		int16_t key;
+		int8_t fieldSize;
+	} entries[HASH_SIZE];
+
+	bool perfect;
+};
+
+static constexpr int StrLen(const char* s)
+{
+	int len = 0;
+	while (s[len])
+		++len;
+	return len;
+}
+
+static constexpr AiTables BuildAiTables()
+{
+	AiTables res = {};
+	for (auto& e : res.entries)
+		e = {-1, 0};
+	res.perfect = true;
+
+	for (const auto& info : aiInfos) {
+		const char* s = info.aiPrefix;
+		int keySize = StrLen(s);
+		// the 3-digit prefixes starting with '3' are the measures, with the decimal point position as fourth digit
+		int aiSize = s[0] == '3' && keySize == 3 ? 4 : keySize;
+		int key = 0;
+		for (int i = 0; i < keySize; ++i)
+			key = key * 10 + (s[i] - '0');
+
+		auto& prefix = res.prefixes[(s[0] - '0') * 10 + (s[1] - '0')];
+		auto& entry = res.entries[key % HASH_SIZE];
+		if ((prefix.aiSize && (prefix.aiSize != aiSize || prefix.keySize != keySize)) || entry.key != -1)
+			res.perfect = false;
+		prefix = {static_cast<uint8_t>(aiSize), static_cast<uint8_t>(keySize)};
+		entry = {static_cast<int16_t>(key), static_cast<int8_t>(info.fieldSize)};
+	}
+	return res;
+}
+
+static constexpr AiTables aiTables = BuildAiTables();
+static_assert(aiTables.perfect, "AI prefixes must be consistent and HASH_SIZE must give a collision free hash");
+
+static bool IsDigit(char c)
+{
+	return c >= '0' && c <= '9';
+}
+
+DecodeStatus
+Parse(const std::string& data, std::vector<Element>& elements)
+{
+	constexpr char GS = 0x1D;
+	const int size = Size(data);
+	int pos = 0;
+	while (pos < size) {
+		if (size - pos < 2 || !IsDigit(data[pos]) || !IsDigit(data[pos + 1]))
+			return DecodeStatus::NotFound;
+
+		const auto& prefix = aiTables.prefixes[(data[pos] - '0') * 10 + (data[pos + 1] - '0')];
+		if (prefix.aiSize == 0 || size - pos < prefix.aiSize)
+			return DecodeStatus::NotFound;
+
+		int key = 0;
+		for (int i = 0; i < prefix.aiSize; ++i) {
+			if (!IsDigit(data[pos + i]))
+				return DecodeStatus::NotFound;
+			if (i < prefix.keySize)
+				key = key * 10 + (data[pos + i] - '0');
+		}
+
+		const auto& entry = aiTables.entries[key % HASH_SIZE];
+		if (entry.key != key)
+			return DecodeStatus::NotFound;
+
+		int dataBegin = pos + prefix.aiSize;
+		int dataSize;
+		if (entry.fieldSize >= 0) {
+			dataSize = entry.fieldSize;
+			if (size - dataBegin < dataSize)
+				return DecodeStatus::NotFound;
+		}
+		else {
+			// require at least one character in the variable field size case
+			int dataEnd = dataBegin;
+			int maxEnd = std::min(size, dataBegin - entry.fieldSize);
+			while (dataEnd < maxEnd && data[dataEnd] != GS)
+				++dataEnd;
+			dataSize = dataEnd - dataBegin;
+			if (dataSize == 0)
+				return DecodeStatus::NotFound;
+		}
+
+		elements.push_back({pos, prefix.aiSize, dataSize});
+		pos = dataBegin + dataSize;
+		if (pos < size && data[pos] == GS)
+			++pos;
+	}
+	return DecodeStatus::NoError;
+}
+
+std::string
+ToHRI(const std::string& data, const std::vector<Element>& elements)
+{
+	std::string res;
+	res.reserve(data.size() + 2 * elements.size());
+	for (const auto& e : elements) {
+		res += '(';
+		res.append(data, e.begin, e.aiSize);
+		res += ')';
+		res.append(data, e.dataBegin(), e.dataSize);
+	}
+	return res;
+}
+
+DecodeStatus
+HRIFromGS1(const std::string& data, std::string& result)
+{
+	std::vector<Element> elements;
+	auto status = Parse(data, elements);
+	if (StatusIsOK(status))
+		result = ToHRI(data, elements);
+	return status;
+}
+
+} // GS1
+} // ZXing
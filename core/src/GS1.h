@@ -0,0 +1,62 @@
+#pragma once
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include <string>
+#include <vector>
+
+namespace ZXing {
+
+enum class DecodeStatus;
+
+namespace GS1 {
+
+/**
+* One element string of GS1 data: an Application Identifier (AI) followed by its data field. Both are given as offsets
+* into the parsed string, so parsing does not copy any characters.
+*/
+struct Element
+{
+	int begin;    ///< offset of the AI
+	int aiSize;   ///< number of digits of the AI
+	int dataSize; ///< number of characters of the data field
+
+	int dataBegin() const { return begin + aiSize; }
+	int end() const { return begin + aiSize + dataSize; }
+
+	std::string ai(const std::string& data) const { return data.substr(begin, aiSize); }
+	std::string value(const std::string& data) const { return data.substr(dataBegin(), dataSize); }
+};
+
+/**
+* Splits GS1 data into its element strings in a single pass. A variable length field ends at a GS (0x1D) character,
+* at its maximum length or at the end of the data. A GS following any field is skipped.
+*
+* @return DecodeStatus::NotFound if the data contains an unknown AI or a field that is too short
+*/
+DecodeStatus Parse(const std::string& data, std::vector<Element>& elements);
+
+/**
+* Renders parsed GS1 data as Human Readable Interpretation, i.e. with every AI in parentheses: "(01)...(10)...".
+*/
+std::string ToHRI(const std::string& data, const std::vector<Element>& elements);
+
+/// Parse() followed by ToHRI()
+DecodeStatus HRIFromGS1(const std::string& data, std::string& result);
+
+} // GS1
+} // ZXing
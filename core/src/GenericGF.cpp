@@ -17,97 +17,112 @@
 
 #include "GenericGF.h"
 
+#include <cstdint>
+
 namespace ZXing {
 
+/**
+* The exp and log tables of GF(SIZE) with the given primitive polynomial, computed at compile time so they live in
+* read-only memory. The exp table has twice the length (the powers simply repeat with period SIZE - 1), so that
+* GenericGF::multiply can add two logs without reducing the sum modulo SIZE - 1.
+*
+* @param PRIMITIVE irreducible polynomial whose coefficients are represented by
+*  the bits of an int, where the least-significant bit represents the constant
+*  coefficient
+*/
+template <int PRIMITIVE, int SIZE>
+struct GFTables
+{
+	uint16_t exp[2 * SIZE];
+	uint16_t log[SIZE];
+
+	constexpr GFTables() : exp{}, log{}
+	{
+		int x = 1;
+		for (int i = 0; i < 2 * SIZE; ++i) {
+			exp[i] = static_cast<uint16_t>(x);
+			x *= 2; // we're assuming the generator alpha is 2
+			if (x >= SIZE) {
+				x ^= PRIMITIVE;
+				x &= SIZE - 1;
+			}
+		}
+		for (int i = 0; i < SIZE - 1; ++i)
+			log[exp[i]] = static_cast<uint16_t>(i);
+		// log[0] == 0 but this should never be used
+	}
+};
+
+static constexpr GFTables<0x1069, 4096> AZTEC_DATA_12_TABLES{}; // x^12 + x^6 + x^5 + x^3 + 1
+static constexpr GFTables<0x409, 1024> AZTEC_DATA_10_TABLES{}; // x^10 + x^3 + 1
+static constexpr GFTables<0x43, 64> AZTEC_DATA_6_TABLES{}; // x^6 + x + 1, also used by MaxiCode
+static constexpr GFTables<0x13, 16> AZTEC_PARAM_TABLES{}; // x^4 + x + 1
+static constexpr GFTables<0x011D, 256> QR_CODE_FIELD_256_TABLES{}; // x^8 + x^4 + x^3 + x^2 + 1
+static constexpr GFTables<0x012D, 256> DATA_MATRIX_FIELD_256_TABLES{}; // x^8 + x^5 + x^3 + x^2 + 1, also used by Aztec
+
+template <int PRIMITIVE, int SIZE>
+GenericGF::GenericGF(const GFTables<PRIMITIVE, SIZE>& tables, int b) :
+	_size(SIZE),
+	_generatorBase(b),
+	_expTable(tables.exp),
+	_logTable(tables.log)
+{
+}
+
 const GenericGF &
 GenericGF::AztecData12()
 {
-	static GenericGF inst(0x1069, 4096, 1); // x^12 + x^6 + x^5 + x^3 + 1
+	static const GenericGF inst(AZTEC_DATA_12_TABLES, 1);
 	return inst;
 }
 
 const GenericGF &
 GenericGF::AztecData10()
 {
-	static GenericGF inst(0x409, 1024, 1); // x^10 + x^3 + 1
+	static const GenericGF inst(AZTEC_DATA_10_TABLES, 1);
 	return inst;
 }
 
 const GenericGF &
 GenericGF::AztecData6()
 {
-	static GenericGF inst(0x43, 64, 1); // x^6 + x + 1
+	static const GenericGF inst(AZTEC_DATA_6_TABLES, 1);
 	return inst;
 }
 
 const GenericGF &
 GenericGF::AztecParam()
 {
-	static GenericGF inst(0x13, 16, 1); // x^4 + x + 1
+	static const GenericGF inst(AZTEC_PARAM_TABLES, 1);
 	return inst;
 }
 
 const GenericGF &
 GenericGF::QRCodeField256()
 {
-	static GenericGF inst(0x011D, 256, 0); // x^8 + x^4 + x^3 + x^2 + 1
+	static const GenericGF inst(QR_CODE_FIELD_256_TABLES, 0);
 	return inst;
 }
 
 const GenericGF &
 GenericGF::DataMatrixField256()
 {
-	static GenericGF inst(0x012D, 256, 1); // x^8 + x^5 + x^3 + x^2 + 1
+	static const GenericGF inst(DATA_MATRIX_FIELD_256_TABLES, 1);
 	return inst;
 }
 
 const GenericGF &
 GenericGF::AztecData8()
 {
-	static const GenericGF inst(0x012D, 256, 1); // = DATA_MATRIX_FIELD_256;
+	static const GenericGF inst(DATA_MATRIX_FIELD_256_TABLES, 1); // = DATA_MATRIX_FIELD_256;
 	return inst;
 }
 
 const GenericGF &
 GenericGF::MaxiCodeField64()
 {
-	static const GenericGF inst(0x43, 64, 1); // = AZTEC_DATA_6;
+	static const GenericGF inst(AZTEC_DATA_6_TABLES, 1); // = AZTEC_DATA_6;
 	return inst;
 }
 
-
-/**
-* Create a representation of GF(size) using the given primitive polynomial.
-*
-* @param primitive irreducible polynomial whose coefficients are represented by
-*  the bits of an int, where the least-significant bit represents the constant
-*  coefficient
-* @param size the size of the field
-* @param b the factor b in the generator polynomial can be 0- or 1-based
-*  (g(x) = (x+a^b)(x+a^(b+1))...(x+a^(b+2t-1))).
-*  In most cases it should be 1, but for QR code it is 0.
-*/
-GenericGF::GenericGF(int primitive, int size, int b) :
-	_size(size),
-	_generatorBase(b)
-{
-	_expTable.resize(size, 0);
-	_logTable.resize(size, 0);
-	int x = 1;
-	for (int i = 0; i < size; ++i)
-	{
-		_expTable[i] = x;
-		x *= 2; // we're assuming the generator alpha is 2
-		if (x >= size) {
-			x ^= primitive;
-			x &= size - 1;
-		}
-	}
-	for (int i = 0; i < size - 1; ++i)
-	{
-		_logTable[_expTable[i]] = i;
-	}
-	// logTable[0] == 0 but this should never be used
-}
-
 } // ZXing
@@ -20,11 +20,14 @@
 
 #include <algorithm>
 #include <cassert>
-#include <vector>
+#include <cstdint>
 #include <stdexcept>
 
 namespace ZXing {
 
+template <int PRIMITIVE, int SIZE>
+struct GFTables;
+
 /**
 * <p>This class contains utility methods for performing mathematical operations over
 * the Galois Fields. Operations use a given primitive polynomial in calculations.</p>
@@ -84,10 +87,11 @@ public:
 	}
 
 	/**
-	* @return 2 to the power of a in GF(size)
+	* @return 2 to the power of a in GF(size), a < 2 * size
 	*/
 	int exp(int a) const {
-		return _expTable.at(a);
+		assert(a >= 0 && a < 2 * _size);
+		return _expTable[a];
 	}
 
 	/**
@@ -97,7 +101,8 @@ public:
 		if (a == 0) {
 			throw std::invalid_argument("a == 0");
 		}
-		return _logTable.at(a);
+		assert(a > 0 && a < _size);
+		return _logTable[a];
 	}
 
 	/**
@@ -114,12 +119,8 @@ public:
 		if (a == 0 || b == 0) {
 			return 0;
 		}
-		auto fast_mod = [](const int input, const int ceil) {
-			// avoid using the '%' modulo operator => ReedSolomon computation is more than twice as fast
-			// see also https://stackoverflow.com/a/33333636/2088798
-			return input < ceil ? input : input - ceil;
-		};
-		return _expTable[fast_mod(_logTable[a] + _logTable[b], _size - 1)];
+		// the exp table has double length, so the sum of the logs needs no reduction modulo size - 1
+		return _expTable[_logTable[a] + _logTable[b]];
 	}
 
 	
@@ -134,21 +135,18 @@ public:
 private:
 	const int _size;
 	int _generatorBase;
-	std::vector<int> _expTable;
-	std::vector<int> _logTable;
+	const uint16_t* _expTable;
+	const uint16_t* _logTable;
 
 	/**
-	* Create a representation of GF(size) using the given primitive polynomial.
+	* Create a representation of GF(size) from the tables generated at compile time for its primitive polynomial.
 	*
-	* @param primitive irreducible polynomial whose coefficients are represented by
-	*  the bits of an int, where the least-significant bit represents the constant
-	*  coefficient
-	* @param size the size of the field
 	* @param b the factor b in the generator polynomial can be 0- or 1-based
 	*  (g(x) = (x+a^b)(x+a^(b+1))...(x+a^(b+2t-1))).
 	*  In most cases it should be 1, but for QR code it is 0.
 	*/
-	GenericGF(int primitive, int size, int b);
+	template <int PRIMITIVE, int SIZE>
+	GenericGF(const GFTables<PRIMITIVE, SIZE>& tables, int b);
 };
 
 } // ZXing
@@ -17,7 +17,6 @@
 
 #include "GenericGFPoly.h"
 #include "GenericGF.h"
-#include "ZXConfig.h"
 
 #include <algorithm>
 #include <cassert>
@@ -63,7 +62,7 @@ GenericGFPoly& GenericGFPoly::addOrSubtract(GenericGFPoly& other)
 	auto& smallerCoefs = other._coefficients;
 	auto& largerCoefs = _coefficients;
 	if (smallerCoefs.size() > largerCoefs.size())
-		std::swap(smallerCoefs, largerCoefs);
+		swap(smallerCoefs, largerCoefs);
 
 	size_t lengthDiff = largerCoefs.size() - smallerCoefs.size();
 
@@ -86,8 +85,6 @@ GenericGFPoly::multiply(const GenericGFPoly& other)
 	auto& a = _coefficients;
 	auto& b = other._coefficients;
 
-	// To disable the use of the malloc cache, simply uncomment:
-	// Coefficients _cache;
 	_cache.resize(a.size() + b.size() - 1);
 	std::fill(_cache.begin(), _cache.end(), 0);
 	for (size_t i = 0; i < a.size(); ++i) {
@@ -96,7 +93,7 @@ GenericGFPoly::multiply(const GenericGFPoly& other)
 		}
 	}
 
-	_coefficients.swap(_cache);
+	swap(_coefficients, _cache);
 
 	normalize();
 	return *this;
@@ -153,7 +150,7 @@ GenericGFPoly::divide(const GenericGFPoly& other, GenericGFPoly& quotient)
 	int denominatorLeadingTerm = other.coefficient(other.degree());
 	int inverseDenominatorLeadingTerm = _field->inverse(denominatorLeadingTerm);
 
-	ZX_THREAD_LOCAL GenericGFPoly temp;
+	GenericGFPoly temp;
 
 	while (remainder.degree() >= other.degree() && !remainder.isZero()) {
 		int degreeDifference = remainder.degree() - other.degree();
@@ -19,7 +19,9 @@
 #include "ZXContainerAlgorithms.h"
 
 #include <algorithm>
+#include <array>
 #include <cstddef>
+#include <iterator>
 #include <cassert>
 #include <vector>
 
@@ -38,24 +40,91 @@ class GenericGF;
 */
 class GenericGFPoly
 {
-	struct Coefficients : public std::vector<int>
+	/**
+	* Coefficient storage with room for the polynomials of typical QR Code, DataMatrix and MaxiCode blocks inside the
+	* object itself, so that arithmetic on them does not allocate. Only larger ones (Aztec) move to the heap and stay
+	* there, just like a std::vector would keep its capacity.
+	*/
+	class Coefficients
 	{
+		static constexpr size_t INLINE_CAPACITY = 80;
+
+		std::array<int, INLINE_CAPACITY> _inline;
+		std::vector<int> _heap;
+		size_t _size = 0;
+		bool _onHeap = false;
+
+	public:
+		int* data() { return _onHeap ? _heap.data() : _inline.data(); }
+		const int* data() const { return _onHeap ? _heap.data() : _inline.data(); }
+		size_t size() const { return _size; }
+		bool empty() const { return _size == 0; }
+
+		int* begin() { return data(); }
+		int* end() { return data() + _size; }
+		const int* begin() const { return data(); }
+		const int* end() const { return data() + _size; }
+		const int* cbegin() const { return data(); }
+		const int* cend() const { return data() + _size; }
+
+		int& operator[](size_t i) { return data()[i]; }
+		int operator[](size_t i) const { return data()[i]; }
+		int& front() { return data()[0]; }
+
 		void reserve(size_t s)
 		{
-			if (capacity() < s)
-				std::vector<int>::reserve(std::max(size_t(32), s));
+			if (_onHeap)
+				_heap.reserve(s);
+			else if (s > INLINE_CAPACITY) {
+				_heap.reserve(s);
+				_heap.assign(_inline.begin(), _inline.begin() + _size);
+				_onHeap = true;
+			}
 		}
 
-		void resize(size_t s)
+		void resize(size_t s, int i = 0)
 		{
 			reserve(s);
-			std::vector<int>::resize(s);
+			if (_onHeap)
+				_heap.resize(s, i);
+			else if (s > _size)
+				std::fill(_inline.begin() + _size, _inline.begin() + s, i);
+			_size = s;
 		}
 
-		void resize(size_t s, int i)
+		template <typename Iterator>
+		void assign(Iterator first, Iterator last)
 		{
-			reserve(s);
-			std::vector<int>::resize(s, i);
+			resize(0);
+			resize(std::distance(first, last));
+			std::copy(first, last, begin());
+		}
+
+		Coefficients& operator=(const Coefficients& other)
+		{
+			if (this != &other)
+				assign(other.begin(), other.end());
+			return *this;
+		}
+
+		Coefficients() = default;
+		Coefficients(const Coefficients& other) { *this = other; }
+		Coefficients(Coefficients&&) = default;
+		Coefficients& operator=(Coefficients&&) = default;
+
+		friend void swap(Coefficients& a, Coefficients& b)
+		{
+			if (!a._onHeap && !b._onHeap) {
+				// only swap the part that is in use
+				size_t n = std::max(a._size, b._size);
+				std::swap_ranges(a._inline.begin(), a._inline.begin() + n, b._inline.begin());
+			}
+			else {
+				std::swap(a._inline, b._inline);
+			}
+			std::swap(a._heap, b._heap);
+			std::swap(a._size, b._size);
+			std::swap(a._onHeap, b._onHeap);
 		}
 	};
 
@@ -73,13 +142,12 @@ public:
 	* or if leading coefficient is 0 and this is not a
 	* constant polynomial (that is, it is not the monomial "0").
 	*/
-	GenericGFPoly(const GenericGF& field, std::vector<int>&& coefficients) : _field(&field)
+	GenericGFPoly(const GenericGF& field, const std::vector<int>& coefficients) : _field(&field)
 	{
 		assert(!coefficients.empty());
-		_coefficients.swap(coefficients); // _coefficients = coefficients
+		_coefficients.assign(coefficients.begin(), coefficients.end());
 		normalize();
 	}
-	GenericGFPoly(const GenericGF& field, const std::vector<int>& coefficients) : GenericGFPoly(field, std::vector<int>(coefficients)) {}
 
 	GenericGFPoly& operator=(GenericGFPoly&& other) = default;
 	GenericGFPoly(GenericGFPoly&& other) = default;
@@ -96,7 +164,7 @@ public:
 		*this = other;
 	}
 
-	const std::vector<int>& coefficients() const {
+	const Coefficients& coefficients() const {
 		return _coefficients;
 	}
 
@@ -135,7 +203,7 @@ public:
 	friend void swap(GenericGFPoly& a, GenericGFPoly& b)
 	{
 		std::swap(a._field, b._field);
-		std::swap(a._coefficients, b._coefficients);
+		swap(a._coefficients, b._coefficients);
 	}
 
 private:
@@ -144,7 +212,7 @@ private:
 	void normalize();
 
 	const GenericGF* _field = nullptr;
-	Coefficients _coefficients, _cache; // _cache is used for malloc caching
+	Coefficients _coefficients, _cache; // _cache is the scratch space of multiply
 };
 
 } // ZXing
@@ -17,9 +17,12 @@
 
 #include "GenericLuminanceSource.h"
 #include "ByteArray.h"
+#include "CpuFeatures.h"
+#include "DecodeStats.h"
 
 #include <algorithm>
 #include <cstdint>
+#include <cstring>
 #include <memory>
 #include <stdexcept>
 #include <utility>
@@ -40,9 +43,195 @@ inline static uint8_t RGBToGray(unsigned r, unsigned g, unsigned b)
 	return static_cast<uint8_t>((306 * r + 601 * g + 117 * b + 0x200) >> 10);
 }
 
-static std::shared_ptr<ByteArray> MakeCopy(const void* src, int rowBytes, int left, int top, int width, int height)
+#ifdef ZX_HAS_X86_DISPATCH
+
+// pshufb masks that expand 2 pixels (lo: pixel 0,1 / hi: pixel 2,3) of 4 pixels in a 16 byte register into
+// 16-bit r, g, b, 0 lanes as expected by RGBToGray4 below.
+static void MakeShuffleMasks(int pixelBytes, int redIndex, int greenIndex, int blueIndex, uint8_t lo[16], uint8_t hi[16])
+{
+	const int index[3] = {redIndex, greenIndex, blueIndex};
+	std::fill_n(lo, 16, 0x80);
+	std::fill_n(hi, 16, 0x80);
+	for (int p = 0; p < 2; ++p)
+		for (int c = 0; c < 3; ++c) {
+			lo[8 * p + 2 * c] = static_cast<uint8_t>(p * pixelBytes + index[c]);
+			hi[8 * p + 2 * c] = static_cast<uint8_t>((p + 2) * pixelBytes + index[c]);
+		}
+}
+
+// converts the 4 pixels in v to 4 32-bit gray values, computes exactly the same as RGBToGray
+ZX_TARGET("sse4.1") static inline __m128i RGBToGray4(__m128i v, __m128i lo, __m128i hi)
+{
+	const __m128i weights = _mm_setr_epi16(306, 601, 117, 0, 306, 601, 117, 0);
+	__m128i sum = _mm_hadd_epi32(_mm_madd_epi16(_mm_shuffle_epi8(v, lo), weights),
+								 _mm_madd_epi16(_mm_shuffle_epi8(v, hi), weights));
+	return _mm_srli_epi32(_mm_add_epi32(sum, _mm_set1_epi32(0x200)), 10);
+}
+
+ZX_TARGET("sse4.1")
+static int RGBToGrayRowSSE41(const uint8_t* src, int width, int pixelBytes, int redIndex, int greenIndex,
+							 int blueIndex, uint8_t* dest)
+{
+	alignas(16) uint8_t masks[2][16];
+	MakeShuffleMasks(pixelBytes, redIndex, greenIndex, blueIndex, masks[0], masks[1]);
+	const __m128i lo = _mm_load_si128(reinterpret_cast<const __m128i*>(masks[0]));
+	const __m128i hi = _mm_load_si128(reinterpret_cast<const __m128i*>(masks[1]));
+
+	// 16 byte loads of 4 pixels each, make sure the last one does not read past the end of the row
+	int x = 0;
+	for (; (x + 4) * pixelBytes + 16 <= width * pixelBytes; x += 8) {
+		const uint8_t* p = src + x * pixelBytes;
+		__m128i g0 = RGBToGray4(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), lo, hi);
+		__m128i g1 = RGBToGray4(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 4 * pixelBytes)), lo, hi);
+		__m128i g = _mm_packus_epi32(g0, g1);
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(dest + x), _mm_packus_epi16(g, g));
+	}
+	return x;
+}
+
+ZX_TARGET("avx2")
+static inline __m256i RGBToGray8(const uint8_t* p, int pixelBytes, __m256i lo, __m256i hi)
+{
+	const __m256i weights = _mm256_setr_epi16(306, 601, 117, 0, 306, 601, 117, 0, 306, 601, 117, 0, 306, 601, 117, 0);
+	// pixel 0..3 in the low lane, pixel 4..7 in the high lane
+	__m256i v = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))),
+										_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 4 * pixelBytes)), 1);
+	__m256i sum = _mm256_hadd_epi32(_mm256_madd_epi16(_mm256_shuffle_epi8(v, lo), weights),
+									_mm256_madd_epi16(_mm256_shuffle_epi8(v, hi), weights));
+	return _mm256_srli_epi32(_mm256_add_epi32(sum, _mm256_set1_epi32(0x200)), 10);
+}
+
+ZX_TARGET("avx2")
+static int RGBToGrayRowAVX2(const uint8_t* src, int width, int pixelBytes, int redIndex, int greenIndex,
+							int blueIndex, uint8_t* dest)
+{
+	alignas(16) uint8_t masks[2][16];
+	MakeShuffleMasks(pixelBytes, redIndex, greenIndex, blueIndex, masks[0], masks[1]);
+	const __m256i lo = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(masks[0])));
+	const __m256i hi = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(masks[1])));
+
+	int x = 0;
+	for (; (x + 12) * pixelBytes + 16 <= width * pixelBytes; x += 16) {
+		const uint8_t* p = src + x * pixelBytes;
+		// packus works per 128-bit lane: 64-bit blocks are now pixel 0..3, 8..11, 4..7, 12..15
+		__m256i g = _mm256_packus_epi32(RGBToGray8(p, pixelBytes, lo, hi), RGBToGray8(p + 8 * pixelBytes, pixelBytes, lo, hi));
+		g = _mm256_permute4x64_epi64(g, _MM_SHUFFLE(3, 1, 2, 0));
+		__m128i res = _mm_packus_epi16(_mm256_castsi256_si128(g), _mm256_extracti128_si256(g, 1));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + x), res);
+	}
+	return x;
+}
+
+#endif // ZX_HAS_X86_DISPATCH
+
+#ifdef ZX_HAS_NEON
+
+static inline uint16x8_t RGBToGray8(uint8x8_t r, uint8x8_t g, uint8x8_t b)
 {
-	auto result = std::make_shared<ByteArray>();
+	uint16x8_t r16 = vmovl_u8(r), g16 = vmovl_u8(g), b16 = vmovl_u8(b);
+	uint32x4_t lo = vmull_n_u16(vget_low_u16(r16), 306);
+	lo = vmlal_n_u16(lo, vget_low_u16(g16), 601);
+	lo = vmlal_n_u16(lo, vget_low_u16(b16), 117);
+	uint32x4_t hi = vmull_n_u16(vget_high_u16(r16), 306);
+	hi = vmlal_n_u16(hi, vget_high_u16(g16), 601);
+	hi = vmlal_n_u16(hi, vget_high_u16(b16), 117);
+	// rounding shift: (x + 0x200) >> 10
+	return vcombine_u16(vrshrn_n_u32(lo, 10), vrshrn_n_u32(hi, 10));
+}
+
+static int RGBToGrayRowNEON(const uint8_t* src, int width, int pixelBytes, int redIndex, int greenIndex,
+							int blueIndex, uint8_t* dest)
+{
+	int x = 0;
+	for (; x + 16 <= width; x += 16, src += 16 * pixelBytes) {
+		uint8x16_t c[4];
+		if (pixelBytes == 3) {
+			uint8x16x3_t v = vld3q_u8(src);
+			c[0] = v.val[0], c[1] = v.val[1], c[2] = v.val[2];
+		} else {
+			uint8x16x4_t v = vld4q_u8(src);
+			c[0] = v.val[0], c[1] = v.val[1], c[2] = v.val[2], c[3] = v.val[3];
+		}
+		uint16x8_t lo = RGBToGray8(vget_low_u8(c[redIndex]), vget_low_u8(c[greenIndex]), vget_low_u8(c[blueIndex]));
+		uint16x8_t hi = RGBToGray8(vget_high_u8(c[redIndex]), vget_high_u8(c[greenIndex]), vget_high_u8(c[blueIndex]));
+		vst1q_u8(dest + x, vcombine_u8(vmovn_u16(lo), vmovn_u16(hi)));
+	}
+	return x;
+}
+
+#endif // ZX_HAS_NEON
+
+#ifdef ZX_HAS_WASM_SIMD
+
+// converts the 4 pixels at p to 4 32-bit gray values: the rg / b swizzles place r, g and b, 0 of each pixel in a pair
+// of 16-bit lanes, so each dot product yields 306 * r + 601 * g and 117 * b respectively. Same result as RGBToGray.
+static inline v128_t RGBToGray4(const uint8_t* p, v128_t rg, v128_t b)
+{
+	const v128_t v = wasm_v128_load(p);
+	const v128_t sum = wasm_i32x4_add(wasm_i32x4_dot_i16x8(wasm_i8x16_swizzle(v, rg), wasm_i16x8_make(306, 601, 306, 601, 306, 601, 306, 601)),
+									  wasm_i32x4_dot_i16x8(wasm_i8x16_swizzle(v, b), wasm_i16x8_make(117, 0, 117, 0, 117, 0, 117, 0)));
+	return wasm_u32x4_shr(wasm_i32x4_add(sum, wasm_i32x4_splat(0x200)), 10);
+}
+
+static int RGBToGrayRowWASM(const uint8_t* src, int width, int pixelBytes, int redIndex, int greenIndex, int blueIndex,
+							uint8_t* dest)
+{
+	// swizzle indices out of range (0x80) select 0
+	alignas(16) uint8_t masks[2][16];
+	std::fill_n(masks[0], 16, 0x80);
+	std::fill_n(masks[1], 16, 0x80);
+	for (int p = 0; p < 4; ++p) {
+		masks[0][4 * p] = static_cast<uint8_t>(p * pixelBytes + redIndex);
+		masks[0][4 * p + 2] = static_cast<uint8_t>(p * pixelBytes + greenIndex);
+		masks[1][4 * p] = static_cast<uint8_t>(p * pixelBytes + blueIndex);
+	}
+	const v128_t rg = wasm_v128_load(masks[0]);
+	const v128_t b = wasm_v128_load(masks[1]);
+
+	// 16 byte loads of 4 pixels each, make sure the last one does not read past the end of the row
+	int x = 0;
+	for (; (x + 4) * pixelBytes + 16 <= width * pixelBytes; x += 8) {
+		const uint8_t* p = src + x * pixelBytes;
+		v128_t g = wasm_u16x8_narrow_i32x4(RGBToGray4(p, rg, b), RGBToGray4(p + 4 * pixelBytes, rg, b));
+		uint64_t gray8 = wasm_i64x2_extract_lane(wasm_u8x16_narrow_i16x8(g, g), 0);
+		std::memcpy(dest + x, &gray8, 8);
+	}
+	return x;
+}
+
+#endif // ZX_HAS_WASM_SIMD
+
+/**
+* Converts one row of 3 or 4 byte per pixel color data into gray values using the fastest kernel available on the
+* running cpu. All kernels produce exactly the same output as RGBToGray.
+*/
+static void RGBToGrayRow(const uint8_t* src, int width, int pixelBytes, int redIndex, int greenIndex, int blueIndex,
+						 uint8_t* dest)
+{
+	int x = 0;
+	if ((pixelBytes == 3 || pixelBytes == 4) && std::max({redIndex, greenIndex, blueIndex}) < pixelBytes) {
+#if defined(ZX_HAS_X86_DISPATCH)
+		if (CpuFeatures::HasAVX2())
+			x = RGBToGrayRowAVX2(src, width, pixelBytes, redIndex, greenIndex, blueIndex, dest);
+		else if (CpuFeatures::HasSSE41())
+			x = RGBToGrayRowSSE41(src, width, pixelBytes, redIndex, greenIndex, blueIndex, dest);
+#elif defined(ZX_HAS_NEON)
+		if (CpuFeatures::HasNEON())
+			x = RGBToGrayRowNEON(src, width, pixelBytes, redIndex, greenIndex, blueIndex, dest);
+#elif defined(ZX_HAS_WASM_SIMD)
+		if (CpuFeatures::HasWasmSimd())
+			x = RGBToGrayRowWASM(src, width, pixelBytes, redIndex, greenIndex, blueIndex, dest);
+#endif
+	}
+	for (src += x * pixelBytes; x < width; ++x, src += pixelBytes)
+		dest[x] = RGBToGray(src[redIndex], src[greenIndex], src[blueIndex]);
+}
+
+static std::shared_ptr<ByteArray> MakeCopy(const void* src, int rowBytes, int left, int top, int width, int height,
+											std::shared_ptr<ByteArray> result = nullptr)
+{
+	if (!result)
+		result = std::make_shared<ByteArray>();
 	result->resize(width * height);
 	const uint8_t* srcRow = static_cast<const uint8_t*>(src) + top * rowBytes + left;
 	uint8_t* destRow = result->data();
@@ -52,15 +241,23 @@ static std::shared_ptr<ByteArray> MakeCopy(const void* src, int rowBytes, int le
 	return result;
 }
 
-static std::shared_ptr<ByteArray> MakeCopy(const ByteArray& pixels, int rowBytes, int left, int top, int width, int height)
+// Attaches the DecodeStats accounting to a newly filled pixel buffer, it lasts as long as the buffer is referenced
+static std::shared_ptr<const ByteArray> Accounted(std::shared_ptr<const ByteArray> pixels)
 {
-	if (top == 0 && left == 0 && width * height == (int)pixels.size()) {
-		return std::make_shared<ByteArray>(pixels);
-	}
-	return MakeCopy(pixels.data(), rowBytes, left, top, width, height);
+	if (!DecodeStats::Current())
+		return pixels;
+
+	struct AccountedPixels
+	{
+		std::shared_ptr<const ByteArray> pixels;
+		DecodeStats::Allocation allocation;
+	};
+	auto holder = std::make_shared<AccountedPixels>(AccountedPixels{pixels, DecodeStats::Allocation(pixels->size())});
+	return std::shared_ptr<const ByteArray>(holder, holder->pixels.get());
 }
 
-GenericLuminanceSource::GenericLuminanceSource(int left, int top, int width, int height, const void* bytes, int rowBytes, int pixelBytes, int redIndex, int greenIndex, int blueIndex) :
+GenericLuminanceSource::GenericLuminanceSource(int left, int top, int width, int height, const void* bytes, int rowBytes, int pixelBytes, int redIndex, int greenIndex, int blueIndex,
+											   std::shared_ptr<ByteArray> buffer) :
 	_left(0),	// since we copy the pixels
 	_top(0),
 	_width(width),
@@ -72,18 +269,16 @@ GenericLuminanceSource::GenericLuminanceSource(int left, int top, int width, int
 	}
 
 	if (pixelBytes == 1)
-		_pixels = MakeCopy(bytes, rowBytes, left, top, width, height);
+		_pixels = Accounted(MakeCopy(bytes, rowBytes, left, top, width, height, std::move(buffer)));
 	else {
-		auto pixels = std::make_shared<ByteArray>(width * height);
+		auto pixels = buffer ? std::move(buffer) : std::make_shared<ByteArray>();
+		pixels->resize(width * height);
 		const uint8_t *rgbSource = static_cast<const uint8_t*>(bytes) + top * rowBytes;
 		uint8_t *destRow = pixels->data();
 		for (int y = 0; y < height; ++y, rgbSource += rowBytes, destRow += width) {
-			const uint8_t *src = rgbSource + left * pixelBytes;
-			for (int x = 0; x < width; ++x, src += pixelBytes) {
-				destRow[x] = RGBToGray(src[redIndex], src[greenIndex], src[blueIndex]);
-			}
+			RGBToGrayRow(rgbSource + left * pixelBytes, width, pixelBytes, redIndex, greenIndex, blueIndex, destRow);
 		}
-		_pixels = std::move(pixels);
+		_pixels = Accounted(std::move(pixels));
 	}
 }
 
@@ -173,39 +368,47 @@ GenericLuminanceSource::canRotate() const
 
 std::shared_ptr<LuminanceSource>
 GenericLuminanceSource::rotated(int degreeCW) const
+{
+	if ((degreeCW + 360) % 360 == 0)
+		return std::make_shared<GenericLuminanceSource>(_left, _top, _width, _height, _pixels, _rowBytes);
+	return Rotated(_width, _height, _pixels->data() + _top * _rowBytes + _left, _rowBytes, degreeCW);
+}
+
+std::shared_ptr<LuminanceSource>
+GenericLuminanceSource::Rotated(int width, int height, const uint8_t* bytes, int rowBytes, int degreeCW)
 {
 	degreeCW = (degreeCW + 360) % 360;
 	if (degreeCW == 90)
 	{
-		auto pixels = std::make_shared<ByteArray>(_width * _height);
-		const uint8_t* srcRow = _pixels->data() + _top * _rowBytes + _left;
+		auto pixels = std::make_shared<ByteArray>(width * height);
+		const uint8_t* srcRow = bytes;
 		uint8_t* dest = pixels->data();
-		for (int y = 0; y < _height; ++y, srcRow += _rowBytes) {
-			for (int x = 0; x < _width; ++x) {
-				dest[x * _height + (_height - y - 1)] = srcRow[x];
+		for (int y = 0; y < height; ++y, srcRow += rowBytes) {
+			for (int x = 0; x < width; ++x) {
+				dest[x * height + (height - y - 1)] = srcRow[x];
 			}
 		}
-		return std::make_shared<GenericLuminanceSource>(0, 0, _height, _width, pixels, _height);
+		return std::make_shared<GenericLuminanceSource>(0, 0, height, width, Accounted(pixels), height);
 	}
 	else if (degreeCW == 180) {
 		// same as a vertical flip followed a horizonal flip
-		auto pixels = MakeCopy(*_pixels, _rowBytes, _left, _top, _width, _height);
+		auto pixels = MakeCopy(bytes, rowBytes, 0, 0, width, height);
 		std::reverse(pixels->begin(), pixels->end());
-		return std::make_shared<GenericLuminanceSource>(0, 0, _width, _height, pixels, _width);
+		return std::make_shared<GenericLuminanceSource>(0, 0, width, height, Accounted(pixels), width);
 	}
 	else if (degreeCW == 270) {
-		auto pixels = std::make_shared<ByteArray>(_width * _height);
-		const uint8_t* srcRow = _pixels->data() + _top * _rowBytes + _left;
+		auto pixels = std::make_shared<ByteArray>(width * height);
+		const uint8_t* srcRow = bytes;
 		uint8_t* dest = pixels->data();
-		for (int y = 0; y < _height; ++y, srcRow += _rowBytes) {
-			for (int x = 0; x < _width; ++x) {
-				dest[(_width - x - 1) * _height + y] = srcRow[x];
+		for (int y = 0; y < height; ++y, srcRow += rowBytes) {
+			for (int x = 0; x < width; ++x) {
+				dest[(width - x - 1) * height + y] = srcRow[x];
 			}
 		}
-		return std::make_shared<GenericLuminanceSource>(0, 0, _height, _width, pixels, _height);
+		return std::make_shared<GenericLuminanceSource>(0, 0, height, width, Accounted(pixels), height);
 	}
 	else if (degreeCW == 0) {
-		return std::make_shared<GenericLuminanceSource>(0, 0, _width, _height, _pixels, _width);
+		return std::make_shared<GenericLuminanceSource>(width, height, bytes, rowBytes);
 	}
 	throw std::invalid_argument("Unsupported rotation");
 }
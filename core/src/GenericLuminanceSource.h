@@ -37,8 +37,10 @@ public:
 
 	/**
 	* Init with a RGB source, left, top, width, height specify the subregion area in orignal image; 'bytes' points to the begining of image buffer (i.e. pixel (0,0)).
+	* The optional 'buffer' is used as storage for the luminance values, which allows to reuse it across images.
 	*/
-	GenericLuminanceSource(int left, int top, int width, int height, const void* bytes, int rowBytes, int pixelBytes, int redIndex, int greenIndex, int blueIndex);
+	GenericLuminanceSource(int left, int top, int width, int height, const void* bytes, int rowBytes, int pixelBytes, int redIndex, int greenIndex, int blueIndex,
+						   std::shared_ptr<ByteArray> buffer = nullptr);
 
 	/**
 	* Init with a grayscale source.
@@ -57,6 +59,12 @@ public:
 	*/
 	GenericLuminanceSource(int left, int top, int width, int height, std::shared_ptr<const ByteArray> pixels, int rowBytes);
 
+	/**
+	* A copy of the grayscale image at 'bytes', rotated clockwise by 'degreeCW' (a multiple of 90).
+	*/
+	static std::shared_ptr<LuminanceSource> Rotated(int width, int height, const uint8_t* bytes, int rowBytes,
+												   int degreeCW);
+
 	virtual int width() const override;
 	virtual int height() const override;
 	virtual const uint8_t* getRow(int y, ByteArray& buffer, bool forceCopy = false) const override;
@@ -16,17 +16,24 @@
 */
 
 #include "GlobalHistogramBinarizer.h"
+#include "DecodeStats.h"
 #include "LuminanceSource.h"
 #include "BitArray.h"
 #include "BitMatrix.h"
 #include "ByteArray.h"
+#include "BitHacks.h"
+#include "CpuFeatures.h"
+#include "Trace.h"
+#include "ZXContainerAlgorithms.h"
 
 #include <algorithm>
 #include <array>
 #include <cassert>
+#include <cstdint>
 #include <functional>
 #include <mutex>
 #include <utility>
+#include <vector>
 
 namespace ZXing {
 
@@ -37,8 +44,9 @@ static const int LUMINANCE_BUCKETS = 1 << LUMINANCE_BITS;
 
 struct GlobalHistogramBinarizer::DataCache
 {
-	std::once_flag once;
+	std::once_flag once, runsOnce;
 	std::shared_ptr<const BitMatrix> matrix;
+	std::shared_ptr<const RunLengthIndex> runs;
 };
 
 GlobalHistogramBinarizer::GlobalHistogramBinarizer(std::shared_ptr<const LuminanceSource> source) :
@@ -47,6 +55,18 @@ GlobalHistogramBinarizer::GlobalHistogramBinarizer(std::shared_ptr<const Luminan
 {
 }
 
+GlobalHistogramBinarizer::GlobalHistogramBinarizer(const GlobalHistogramBinarizer& other) :
+	_source(other._source),
+	_cache(other._cache)
+{
+}
+
+GlobalHistogramBinarizer::GlobalHistogramBinarizer(const LuminanceSource& source) :
+	// aliasing an empty shared_ptr, see the header
+	GlobalHistogramBinarizer(std::shared_ptr<const LuminanceSource>(std::shared_ptr<const LuminanceSource>(), &source))
+{
+}
+
 GlobalHistogramBinarizer::~GlobalHistogramBinarizer() = default;
 
 int
@@ -110,11 +130,123 @@ static int EstimateBlackPoint(const std::array<int, LUMINANCE_BUCKETS>& buckets)
 	return bestValley << LUMINANCE_SHIFT;
 }
 
+static void AddToHistogram(const uint8_t* luminances, int begin, int end, std::array<int, LUMINANCE_BUCKETS>& buckets)
+{
+	// 4 interleaved sub-histograms, so consecutive increments of the same bucket do not wait for each other
+	std::array<std::array<int, LUMINANCE_BUCKETS>, 4> sub = {};
+	int x = begin;
+	for (; x + 4 <= end; x += 4) {
+		sub[0][luminances[x + 0] >> LUMINANCE_SHIFT]++;
+		sub[1][luminances[x + 1] >> LUMINANCE_SHIFT]++;
+		sub[2][luminances[x + 2] >> LUMINANCE_SHIFT]++;
+		sub[3][luminances[x + 3] >> LUMINANCE_SHIFT]++;
+	}
+	for (; x < end; x++)
+		sub[0][luminances[x] >> LUMINANCE_SHIFT]++;
+
+	for (int i = 0; i < LUMINANCE_BUCKETS; i++)
+		buckets[i] += sub[0][i] + sub[1][i] + sub[2][i] + sub[3][i];
+}
+
+static inline void SetBits(std::vector<uint32_t>& bits, int x, uint32_t mask, int count)
+{
+	uint64_t m = static_cast<uint64_t>(mask & ((1ull << count) - 1)) << (x % 32);
+	bits[x / 32] |= static_cast<uint32_t>(m);
+	if (m >> 32)
+		bits[x / 32 + 1] |= static_cast<uint32_t>(m >> 32);
+}
+
+#ifdef ZX_HAS_X86_DISPATCH
+
+// 16 pixels of the sharpened row per iteration, see SharpenedBlackBits
+ZX_TARGET("sse2")
+static int SharpenedBlackBitsSSE2(const uint8_t* luminances, int width, int blackPoint, std::vector<uint32_t>& bits)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i threshold = _mm_set1_epi16(static_cast<short>(2 * blackPoint));
+	int x = 1;
+	for (; x + 16 <= width - 1; x += 16) {
+		const uint8_t* p = luminances + x;
+		__m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p - 1));
+		__m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+		__m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 1));
+		// the intrinsics can not be passed as function pointers, they do not exist as functions in debug builds
+		auto black = [&](__m128i l16, __m128i c16, __m128i r16) {
+			__m128i v = _mm_sub_epi16(_mm_slli_epi16(c16, 2), _mm_add_epi16(l16, r16));
+			return _mm_cmplt_epi16(v, threshold);
+		};
+		__m128i blackLo = black(_mm_unpacklo_epi8(l, zero), _mm_unpacklo_epi8(c, zero), _mm_unpacklo_epi8(r, zero));
+		__m128i blackHi = black(_mm_unpackhi_epi8(l, zero), _mm_unpackhi_epi8(c, zero), _mm_unpackhi_epi8(r, zero));
+		uint32_t mask = _mm_movemask_epi8(_mm_packs_epi16(blackLo, blackHi));
+		SetBits(bits, x, mask, 16);
+	}
+	return x;
+}
+
+#ifdef ZX_FAST_BIT_STORAGE
+// luminances < blackPoint as 0/1 bytes, 16 pixels per iteration
+ZX_TARGET("sse2")
+static int ThresholdRowSSE2(const uint8_t* luminances, int width, int blackPoint, uint8_t* dst)
+{
+	const __m128i limit = _mm_set1_epi8(static_cast<char>(blackPoint - 1));
+	const __m128i one = _mm_set1_epi8(1);
+	int x = 0;
+	for (; x + 16 <= width; x += 16) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(luminances + x));
+		// v < blackPoint  <=>  min(v, blackPoint - 1) == v
+		__m128i black = _mm_and_si128(_mm_cmpeq_epi8(_mm_min_epu8(v, limit), v), one);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), black);
+	}
+	return x;
+}
+#endif // ZX_FAST_BIT_STORAGE
+
+#endif // ZX_HAS_X86_DISPATCH
+
+/**
+* Computes the black pixels of a row with a simple -1 4 -1 sharpening filter (with a weight of 2) applied to all but
+* the first and the last pixel. The result is a bit mask with one bit per pixel.
+* Note: (v / 2 < blackPoint) <=> (v < 2 * blackPoint) for blackPoint > 0, also for negative v.
+*/
+static std::vector<uint32_t> SharpenedBlackBits(const uint8_t* luminances, int width, int blackPoint)
+{
+	std::vector<uint32_t> bits((width + 31) / 32, 0);
+	if (luminances[0] < blackPoint)
+		bits[0] |= 1;
+
+	int x = 1;
+#ifdef ZX_HAS_X86_DISPATCH
+	if (CpuFeatures::HasSSE2())
+		x = SharpenedBlackBitsSSE2(luminances, width, blackPoint, bits);
+#endif
+	for (auto* p = luminances + x; p < luminances + width - 1; ++p, ++x) {
+		if ((-*(p - 1) + (int(*p) * 4) - *(p + 1)) / 2 < blackPoint)
+			bits[x / 32] |= 1u << (x % 32);
+	}
+
+	if (luminances[width - 1] < blackPoint)
+		bits[(width - 1) / 32] |= 1u << ((width - 1) % 32);
+
+	return bits;
+}
+
+// Returns the position of the first bit after x that is not equal to val (or width).
+static int NextChange(const std::vector<uint32_t>& bits, int x, bool val, int width)
+{
+	const uint32_t flip = val ? 0xFFFFFFFF : 0;
+	int i = x / 32;
+	uint32_t w = (bits[i] ^ flip) & (0xFFFFFFFF << (x % 32));
+	while (w == 0) {
+		if (++i == Size(bits))
+			return width;
+		w = bits[i] ^ flip;
+	}
+	return std::min(width, i * 32 + BitHacks::NumberOfTrailingZeros(w));
+}
+
 // Applies simple sharpening to the row data to improve performance of the 1D Readers.
-bool
-GlobalHistogramBinarizer::getBlackRow(int y, BitArray& row) const
+static bool GetBlackRow(const uint8_t* luminances, int width, BitArray& row)
 {
-	int width = _source->width();
 	if (width < 3)
 		return false; // special casing the code below for a width < 3 makes no sense
 
@@ -123,83 +255,113 @@ GlobalHistogramBinarizer::getBlackRow(int y, BitArray& row) const
 	else
 		row.clearBits();
 
-	ByteArray buffer;
-	const uint8_t* luminances = _source->getRow(y, buffer);
 	std::array<int, LUMINANCE_BUCKETS> buckets = {};
-	for (int x = 0; x < width; x++) {
-		buckets[luminances[x] >> LUMINANCE_SHIFT]++;
-	}
+	AddToHistogram(luminances, 0, width, buckets);
 	int blackPoint = EstimateBlackPoint(buckets);
 	if (blackPoint <= 0)
 		return false;
 
-	if (luminances[0] < blackPoint)
-		row.set(0);
+	auto bits = SharpenedBlackBits(luminances, width, blackPoint);
+	for (int i = 0; i < Size(bits); ++i)
+		for (uint32_t w = bits[i]; w; w &= w - 1)
+			row.set(i * 32 + BitHacks::NumberOfTrailingZeros(w));
 
-	int x = 1;
-	for (auto* p = luminances + 1; p < luminances + width - 1; ++p, ++x) {
-		// A simple -1 4 -1 box filter with a weight of 2.
-		if ((-*(p - 1) + (int(*p) * 4) - *(p + 1)) / 2 < blackPoint) {
-			row.set(x);
-		}
-	}
+	return true;
+}
 
-	if (luminances[width - 1] < blackPoint)
-		row.set(width - 1);
+// The value SharpenedBlackBits compares with the black point for pixel x.
+static float Sharpened(const uint8_t* luminances, int width, int x)
+{
+	if (x == 0 || x == width - 1)
+		return luminances[x];
+	return (-luminances[x - 1] + 4 * luminances[x] - luminances[x + 1]) / 2.f;
+}
 
-	return true;
+/**
+* Computes the widths of the runs in res with sub-pixel precision: each edge between two runs is moved from the border
+* of the two pixels to where the linear interpolation of their sharpened values between the pixel centers crosses the
+* black point.
+*/
+static void SubPixelWidths(const uint8_t* luminances, int width, int blackPoint, const PatternRow& res,
+						   SubPixelPatternRow& widths)
+{
+	widths.resize(res.size());
+	float lastEdge = 0;
+	int x = 0;
+	for (size_t i = 0; i < res.size(); ++i) {
+		x += res[i];
+		float edge = static_cast<float>(x);
+		if (0 < x && x < width) {
+			// the pixels x - 1 and x are on different sides of the black point, so the divisor is not 0
+			float s0 = Sharpened(luminances, width, x - 1);
+			float s1 = Sharpened(luminances, width, x);
+			edge += (s0 - blackPoint) / (s0 - s1) - 0.5f;
+		}
+		widths[i] = edge - lastEdge;
+		lastEdge = edge;
+	}
 }
 
-bool GlobalHistogramBinarizer::getPatternRow(int y, PatternRow& res) const
+static bool GetPatternRow(const uint8_t* luminances, int width, PatternRow& res, SubPixelPatternRow* widths = nullptr)
 {
-	int width = _source->width();
 	if (width < 3)
 		return false; // special casing the code below for a width < 3 makes no sense
 
 	res.clear();
 
-	ByteArray buffer;
-	const uint8_t* luminances = _source->getRow(y, buffer);
 	std::array<int, LUMINANCE_BUCKETS> buckets = {};
-	for (int x = 0; x < width; x++) {
-		buckets[luminances[x] >> LUMINANCE_SHIFT]++;
-	}
+	AddToHistogram(luminances, 0, width, buckets);
 	int blackPoint = EstimateBlackPoint(buckets);
 	if (blackPoint <= 0)
 		return false;
 
-	auto* lastPos = luminances;
-	bool lastVal = luminances[0] < blackPoint;
-	if (lastVal)
-		res.push_back(0); // first value is number of white pixels, here 0
-
-	auto process = [&](bool val, const uint8_t* p) {
-		if (val != lastVal) {
-			res.push_back(p - lastPos);
-			lastVal = val;
-			lastPos = p;
-		}
-	};
-
-	for (auto* p = luminances + 1; p < luminances + width - 1; ++p)
-		process((-*(p - 1) + (int(*p) * 4) - *(p + 1)) / 2 < blackPoint, p);
+	auto bits = SharpenedBlackBits(luminances, width, blackPoint);
 
-	auto* backPos = luminances + width - 1;
-	bool backVal = *backPos < blackPoint;
-	process(backVal, backPos);
+	// run lengths of alternating white and black pixels, the first and the last one are white (possibly 0)
+	bool val = bits[0] & 1;
+	if (val)
+		res.push_back(0); // first value is number of white pixels, here 0
 
-	res.push_back(backPos - lastPos + 1);
+	for (int x = 0, next; x < width; x = next, val = !val) {
+		next = NextChange(bits, x, val, width);
+		res.push_back(next - x);
+	}
 
-	if (backVal)
+	if (!val)
 		res.push_back(0); // last value is number of white pixels, here 0
 
 	assert(res.size() % 2 == 1);
 
+	if (widths)
+		SubPixelWidths(luminances, width, blackPoint, res, *widths);
+
 	return true;
 }
 
+bool
+GlobalHistogramBinarizer::getBlackRow(int y, BitArray& row) const
+{
+	ByteArray buffer;
+	return GetBlackRow(_source->getRow(y, buffer), _source->width(), row);
+}
+
+bool GlobalHistogramBinarizer::getPatternRow(int y, PatternRow& res) const
+{
+	ByteArray buffer;
+	return GetPatternRow(_source->getRow(y, buffer), _source->width(), res);
+}
+
+bool GlobalHistogramBinarizer::getSubPixelPatternRow(int y, PatternRow& res, SubPixelPatternRow& widths) const
+{
+	ByteArray buffer;
+	widths.clear();
+	return GetPatternRow(_source->getRow(y, buffer), _source->width(), res, &widths);
+}
+
 static void InitBlackMatrix(const LuminanceSource& source, std::shared_ptr<const BitMatrix>& outMatrix)
 {
+	ZX_TRACE_SCOPE("GlobalHistogramBinarizer::InitBlackMatrix");
+	DecodeStats::StageTimer timer(DecodeStats::Stage::Binarize);
 	int width = source.width();
 	int height = source.height();
 	auto matrix = std::make_shared<BitMatrix>(width, height);
@@ -212,10 +374,7 @@ static void InitBlackMatrix(const LuminanceSource& source, std::shared_ptr<const
 		for (int y = 1; y < 5; y++) {
 			int row = height * y / 5;
 			const uint8_t* luminances = source.getRow(row, buffer);
-			int right = (width * 4) / 5;
-			for (int x = width / 5; x < right; x++) {
-				localBuckets[luminances[x] >> LUMINANCE_SHIFT]++;
-			}
+			AddToHistogram(luminances, width / 5, (width * 4) / 5, localBuckets);
 		}
 	}
 
@@ -231,7 +390,12 @@ static void InitBlackMatrix(const LuminanceSource& source, std::shared_ptr<const
 	const uint8_t* luminances = source.getMatrix(buffer, stride);
 	for (int y = 0; y < height; y++) {
 		int offset = y * stride;
-		for (int x = 0; x < width; x++) {
+		int x = 0;
+#if defined(ZX_HAS_X86_DISPATCH) && defined(ZX_FAST_BIT_STORAGE)
+		if (CpuFeatures::HasSSE2())
+			x = ThresholdRowSSE2(luminances + offset, width, blackPoint, matrix->row(y).begin());
+#endif
+		for (; x < width; x++) {
 			if (luminances[offset + x] < blackPoint) {
 				matrix->set(x, y);
 			}
@@ -248,16 +412,21 @@ GlobalHistogramBinarizer::getBlackMatrix() const
 	return _cache->matrix;
 }
 
-bool
-GlobalHistogramBinarizer::canCrop() const
+// Uses the (virtual) getBlackMatrix(), so a HybridBinarizer caches the runs of its own matrix here.
+std::shared_ptr<const RunLengthIndex>
+GlobalHistogramBinarizer::getRunLengthIndex() const
 {
-	return _source->canCrop();
+	std::call_once(_cache->runsOnce, [this]() {
+		if (auto matrix = getBlackMatrix())
+			_cache->runs = std::make_shared<const RunLengthIndex>(*matrix);
+	});
+	return _cache->runs;
 }
 
-std::shared_ptr<BinaryBitmap>
-GlobalHistogramBinarizer::cropped(int left, int top, int width, int height) const
+bool
+GlobalHistogramBinarizer::canCrop() const
 {
-	return newInstance(_source->cropped(left, top, width, height));
+	return _source->canCrop();
 }
 
 bool
@@ -266,10 +435,223 @@ GlobalHistogramBinarizer::canRotate() const
 	return _source->canRotate();
 }
 
+namespace {
+
+/**
+* A GlobalHistogramBinarizer (or derived class) rotated by 90, 180 or 270 degrees. Its rows are read directly from
+* the luminance source with a stride. This way the 1D readers can scan a rotated image without the rotated copy of the
+* luminance data. The black matrix for the 2D readers is the rotated black matrix of the unrotated image, which
+* shares the cache of the binarizer this view was created from, so the image is not binarized a second time.
+*/
+class RotatedBinarizer : public BinaryBitmap
+{
+	std::shared_ptr<const GlobalHistogramBinarizer> _unrotated;
+	std::shared_ptr<const LuminanceSource> _source;
+	int _degreeCW;
+
+	struct DataCache
+	{
+		std::once_flag luminancesOnce, matrixOnce, runsOnce;
+		ByteArray buffer;
+		const uint8_t* luminances = nullptr;
+		int stride = 0;
+		std::shared_ptr<const BitMatrix> matrix;
+		std::shared_ptr<const RunLengthIndex> runs;
+	};
+	std::unique_ptr<DataCache> _cache;
+
+	// Copies the luminance values of row y (i.e. a column or, for 180 degrees, a row of the source) into buffer
+	const uint8_t* getRow(int y, ByteArray& buffer) const
+	{
+		std::call_once(_cache->luminancesOnce, [this]() {
+			_cache->luminances = _source->getMatrix(_cache->buffer, _cache->stride);
+		});
+		int width = this->width();
+		int stride = _cache->stride;
+		buffer.resize(width);
+		if (_degreeCW == 270) {
+			// row y is the column width - 1 - y of the source from top to bottom
+			const uint8_t* src = _cache->luminances + _source->width() - 1 - y;
+			for (int i = 0; i < width; ++i, src += stride)
+				buffer[i] = *src;
+		} else if (_degreeCW == 90) {
+			// row y is the column y of the source from bottom to top
+			const uint8_t* src = _cache->luminances + (width - 1) * stride + y;
+			for (int i = 0; i < width; ++i, src -= stride)
+				buffer[i] = *src;
+		} else {
+			// row y is the row height - 1 - y of the source from right to left
+			const uint8_t* src = _cache->luminances + (_source->height() - 1 - y) * stride + width - 1;
+			for (int i = 0; i < width; ++i, --src)
+				buffer[i] = *src;
+		}
+		return buffer.data();
+	}
+
+public:
+	RotatedBinarizer(std::shared_ptr<const GlobalHistogramBinarizer> unrotated, std::shared_ptr<const LuminanceSource> source,
+					 int degreeCW)
+		: _unrotated(std::move(unrotated)), _source(std::move(source)), _degreeCW(degreeCW), _cache(new DataCache)
+	{}
+
+	int width() const override { return _degreeCW == 180 ? _source->width() : _source->height(); }
+	int height() const override { return _degreeCW == 180 ? _source->height() : _source->width(); }
+
+	bool getBlackRow(int y, BitArray& row) const override
+	{
+		ByteArray buffer;
+		return GetBlackRow(getRow(y, buffer), width(), row);
+	}
+
+	bool getPatternRow(int y, PatternRow& res) const override
+	{
+		ByteArray buffer;
+		return GetPatternRow(getRow(y, buffer), width(), res);
+	}
+
+	bool getSubPixelPatternRow(int y, PatternRow& res, SubPixelPatternRow& widths) const override
+	{
+		ByteArray buffer;
+		widths.clear();
+		return GetPatternRow(getRow(y, buffer), width(), res, &widths);
+	}
+
+	std::shared_ptr<const BitMatrix> getBlackMatrix() const override
+	{
+		std::call_once(_cache->matrixOnce, [this]() {
+			auto unrotated = _unrotated->getBlackMatrix();
+			if (!unrotated)
+				return;
+			auto matrix = std::make_shared<BitMatrix>(unrotated->copy());
+			// BitMatrix::rotate90() turns column x into row width - 1 - x, which is the 270 degree case of getRow()
+			if (_degreeCW != 180)
+				matrix->rotate90();
+			if (_degreeCW != 270)
+				matrix->rotate180();
+			_cache->matrix = std::move(matrix);
+		});
+		return _cache->matrix;
+	}
+
+	std::shared_ptr<const RunLengthIndex> getRunLengthIndex() const override
+	{
+		std::call_once(_cache->runsOnce, [this]() {
+			if (auto matrix = getBlackMatrix())
+				_cache->runs = std::make_shared<const RunLengthIndex>(*matrix);
+		});
+		return _cache->runs;
+	}
+
+	bool canRotate() const override { return _unrotated->canRotate(); }
+
+	std::shared_ptr<BinaryBitmap> rotated(int degreeCW) const override
+	{
+		return _unrotated->rotated(_degreeCW + degreeCW);
+	}
+};
+
+/**
+* A crop of a GlobalHistogramBinarizer (or derived class). Like RotatedBinarizer, its black matrix is cut out of the
+* black matrix of the whole image, which shares the cache of the binarizer this view was created from. The rows for
+* the 1D readers depend on the histogram of the cropped row, they come from a binarizer of the cropped source.
+*/
+class CroppedBinarizer : public BinaryBitmap
+{
+	std::shared_ptr<const GlobalHistogramBinarizer> _uncropped;
+	std::shared_ptr<const LuminanceSource> _source;
+	int _left, _top, _width, _height;
+
+	struct DataCache
+	{
+		std::once_flag imageOnce, matrixOnce, runsOnce;
+		std::shared_ptr<const BinaryBitmap> image;
+		std::shared_ptr<const BitMatrix> matrix;
+		std::shared_ptr<const RunLengthIndex> runs;
+	};
+	std::unique_ptr<DataCache> _cache;
+
+	const BinaryBitmap& croppedImage() const
+	{
+		std::call_once(_cache->imageOnce, [this]() {
+			_cache->image = _uncropped->newInstance(_source->cropped(_left, _top, _width, _height));
+		});
+		return *_cache->image;
+	}
+
+public:
+	CroppedBinarizer(std::shared_ptr<const GlobalHistogramBinarizer> uncropped,
+					 std::shared_ptr<const LuminanceSource> source, int left, int top, int width, int height)
+		: _uncropped(std::move(uncropped)), _source(std::move(source)), _left(left), _top(top), _width(width),
+		  _height(height), _cache(new DataCache)
+	{}
+
+	int width() const override { return _width; }
+	int height() const override { return _height; }
+
+	bool getBlackRow(int y, BitArray& row) const override { return croppedImage().getBlackRow(y, row); }
+	bool getPatternRow(int y, PatternRow& res) const override { return croppedImage().getPatternRow(y, res); }
+
+	bool getSubPixelPatternRow(int y, PatternRow& res, SubPixelPatternRow& widths) const override
+	{
+		return croppedImage().getSubPixelPatternRow(y, res, widths);
+	}
+
+	std::shared_ptr<const BitMatrix> getBlackMatrix() const override
+	{
+		std::call_once(_cache->matrixOnce, [this]() {
+			if (auto uncropped = _uncropped->getBlackMatrix())
+				_cache->matrix = std::make_shared<const BitMatrix>(Deflate(*uncropped, _width, _height, _top, _left, 1));
+		});
+		return _cache->matrix;
+	}
+
+	std::shared_ptr<const RunLengthIndex> getRunLengthIndex() const override
+	{
+		std::call_once(_cache->runsOnce, [this]() {
+			if (auto matrix = getBlackMatrix())
+				_cache->runs = std::make_shared<const RunLengthIndex>(*matrix);
+		});
+		return _cache->runs;
+	}
+
+	bool canCrop() const override { return true; }
+
+	std::shared_ptr<BinaryBitmap> cropped(int left, int top, int width, int height) const override
+	{
+		if (left < 0 || top < 0 || width < 0 || height < 0 || left + width > _width || top + height > _height)
+			throw std::out_of_range("Crop rectangle does not fit within image data.");
+		return _uncropped->cropped(_left + left, _top + top, width, height);
+	}
+
+	bool canRotate() const override { return croppedImage().canRotate(); }
+
+	std::shared_ptr<BinaryBitmap> rotated(int degreeCW) const override { return croppedImage().rotated(degreeCW); }
+};
+
+} // namespace
+
+std::shared_ptr<BinaryBitmap>
+GlobalHistogramBinarizer::cropped(int left, int top, int width, int height) const
+{
+	if (left < 0 || top < 0 || width < 0 || height < 0 || left + width > _source->width() ||
+		top + height > _source->height())
+		throw std::out_of_range("Crop rectangle does not fit within image data.");
+	return std::make_shared<CroppedBinarizer>(sharedCopy(), _source, left, top, width, height);
+}
+
 std::shared_ptr<BinaryBitmap>
 GlobalHistogramBinarizer::rotated(int degreeCW) const
 {
-	return newInstance(_source->rotated(degreeCW));
+	degreeCW = (degreeCW + 360) % 360;
+	if (degreeCW == 0)
+		return sharedCopy();
+	return std::make_shared<RotatedBinarizer>(sharedCopy(), _source, degreeCW);
+}
+
+std::shared_ptr<GlobalHistogramBinarizer>
+GlobalHistogramBinarizer::sharedCopy() const
+{
+	return std::shared_ptr<GlobalHistogramBinarizer>(new GlobalHistogramBinarizer(*this));
 }
 
 std::shared_ptr<BinaryBitmap>
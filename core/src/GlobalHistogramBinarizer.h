@@ -42,13 +42,21 @@ protected:
 
 public:
 	explicit GlobalHistogramBinarizer(std::shared_ptr<const LuminanceSource> source);
+
+	/**
+	* Non-owning: 'source' has to outlive this binarizer and the bitmaps derived from it (see cropped and rotated).
+	* Use this for a source on the stack, it needs no control block and no reference counting.
+	*/
+	explicit GlobalHistogramBinarizer(const LuminanceSource& source);
 	~GlobalHistogramBinarizer() override;
 
 	int width() const override;
 	int height() const override;
 	bool getBlackRow(int y, BitArray& row) const override;
 	bool getPatternRow(int y, PatternRow &res) const override;
+	bool getSubPixelPatternRow(int y, PatternRow& res, SubPixelPatternRow& widths) const override;
 	std::shared_ptr<const BitMatrix> getBlackMatrix() const override;
+	std::shared_ptr<const RunLengthIndex> getRunLengthIndex() const override;
 	bool canCrop() const override;
 	std::shared_ptr<BinaryBitmap> cropped(int left, int top, int width, int height) const override;
 	bool canRotate() const override;
@@ -56,9 +64,19 @@ public:
 
 	virtual std::shared_ptr<BinaryBitmap> newInstance(const std::shared_ptr<const LuminanceSource>& source) const;
 
+protected:
+	/// Shares the source and the cached black matrix with 'other', see sharedCopy()
+	GlobalHistogramBinarizer(const GlobalHistogramBinarizer& other);
+
+	/**
+	* A copy of this binarizer that shares its cache. The cropped and rotated views derive their black matrix from
+	* the one of this copy, so a matrix that was already computed for this binarizer is reused.
+	*/
+	virtual std::shared_ptr<GlobalHistogramBinarizer> sharedCopy() const;
+
 private:
 	struct DataCache;
-	std::unique_ptr<DataCache> _cache;
+	std::shared_ptr<DataCache> _cache;
 };
 
 } // ZXing
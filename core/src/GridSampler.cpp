@@ -17,11 +17,18 @@
 */
 
 #include "GridSampler.h"
+#include "DecodeStats.h"
+#include "ZXContainerAlgorithms.h"
+
+#include <array>
+#include <cstdlib>
 
 namespace ZXing {
 
-DetectorResult SampleGrid(const BitMatrix& image, int width, int height, const PerspectiveTransform& transform)
+DetectorResult SampleGrid(const BitMatrix& image, int width, int height, const PerspectiveTransform& transform,
+						  BitMatrix* lowConfidence, SampleMode mode)
 {
+	DecodeStats::StageTimer timer(DecodeStats::Stage::Sample);
 	auto project = [&](PointI p) { return PointI(transform(p + PointF(0.5, 0.5))); };
 	auto isInside = [&](PointI p) {
 		p = project(p);
@@ -32,13 +39,50 @@ DetectorResult SampleGrid(const BitMatrix& image, int width, int height, const P
 		!isInside({width - 1, height - 1}) || !isInside({0, height - 1}))
 		return {};
 
+	// counts the black pixels a quarter module around the center, the ones outside the image are ignored
+	auto countNeighbors = [&](int x, int y, int& black) {
+		int count = 0;
+		PointF c(x + 0.5, y + 0.5);
+		std::array<PointF, 4> samples = {c + PointF(-0.25, 0), c + PointF(0.25, 0), c + PointF(0, -0.25),
+										 c + PointF(0, 0.25)};
+		transform(samples.data(), samples.data(), Size(samples));
+		for (auto pf : samples) {
+			auto p = PointI(pf);
+			if (0 <= p.x && p.x < image.width() && 0 <= p.y && p.y < image.height()) {
+				black += image.rowView(p.y)[p.x];
+				++count;
+			}
+		}
+		return count;
+	};
+	bool needNeighbors = lowConfidence || mode == SampleMode::Majority;
+
 	BitMatrix res(width, height);
+	if (lowConfidence)
+		*lowConfidence = BitMatrix(width, height);
 	for (int y = 0; y < height; ++y)
-		for (int x = 0; x < width; ++x) {
-			auto p = project({x, y});
-			if (image.get(p.x, p.y))
+		transform.mapRow(PointF(0.5, y + 0.5), width, [&](int x, PointF pf) {
+			// the four corners are inside the image, so are all module centers in between
+			auto p = PointI(pf);
+			bool bit = image.rowView(p.y)[p.x];
+			bool uncertain = false;
+			if (needNeighbors) {
+				int black = bit;
+				int count = countNeighbors(x, y, black) + 1;
+				if (mode == SampleMode::Majority) {
+					bit = 2 * black > count;
+					// a narrow majority (e.g. 3 of 5) is not trustworthy
+					uncertain = std::abs(2 * black - count) <= 1;
+				}
+				else {
+					uncertain = black != 0 && black != count;
+				}
+			}
+			if (bit)
 				res.set(x, y);
-		}
+			if (lowConfidence && uncertain)
+				lowConfidence->set(x, y);
+		});
 	auto projectCorner = [&](PointI p) { return PointI(transform(PointF(p)) + PointF(0.5, 0.5)); };
 	return {
 		std::move(res),
@@ -21,6 +21,12 @@
 
 namespace ZXing {
 
+enum class SampleMode
+{
+	Center,   ///< one pixel at the center of each module
+	Majority, ///< majority vote of the center and the four pixels a quarter module away, more robust on blurry images
+};
+
 /**
 * Samples an image for a rectangular matrix of bits of the given dimension. The sampling
 * transformation is determined by the coordinates of 4 points, in the original and transformed
@@ -30,9 +36,15 @@ namespace ZXing {
 * @param width width of {@link BitMatrix} to sample from image
 * @param height height of {@link BitMatrix} to sample from image
 * @param transform transforming a destination position into a source position
+* @param lowConfidence if not null, it is set to a width x height matrix that marks the modules where the pixels a
+*   quarter module away from the center disagree with the center pixel, i.e. where the module lies on an edge in the
+*   binarized image. Decoders can map them to codewords and pass those as erasures to the Reed-Solomon decoder.
+*   With SampleMode::Majority only the modules decided by a narrow majority are marked.
+* @param mode how the value of a module is determined from the pixels around its center
 * @return {@link DetectorResult} representing a grid of points sampled from the image within a region
 *   defined by the "src" parameters. Result is empty if transformation is invalid (out of bound access).
 */
-DetectorResult SampleGrid(const BitMatrix& image, int width, int height, const PerspectiveTransform& transform);
+DetectorResult SampleGrid(const BitMatrix& image, int width, int height, const PerspectiveTransform& transform,
+						  BitMatrix* lowConfidence = nullptr, SampleMode mode = SampleMode::Center);
 
 } // ZXing
@@ -16,26 +16,36 @@
 */
 
 #include "HybridBinarizer.h"
+#include "DecodeStats.h"
 #include "LuminanceSource.h"
 #include "ByteArray.h"
+#include "BitArray.h"
 #include "BitMatrix.h"
 #include "Matrix.h"
 #include "ZXNumeric.h"
 #include "ZXContainerAlgorithms.h"
+#include "CpuFeatures.h"
+#include "Parallel.h"
+#include "Trace.h"
 
+#include <algorithm>
+#include <array>
 #include <cassert>
 #include <cstdint>
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <numeric>
 #include <vector>
 #include <utility>
 
 namespace ZXing {
 
 // This class uses 5x5 blocks to compute local luminance, where each block is 8x8 pixels.
-// So this is the smallest dimension in each axis we can accept.
+// So this is the smallest dimension in each axis we can accept. Larger blocks are made of
+// several of these, see CalculateBlackPoints.
 static const int BLOCK_SIZE = 8;
+static const int MAX_BLOCK_SIZE = 32;
 static const int MINIMUM_DIMENSION = BLOCK_SIZE * 5;
 static const int MIN_DYNAMIC_RANGE = 24;
 
@@ -45,80 +55,245 @@ struct HybridBinarizer::DataCache
 	std::shared_ptr<const BitMatrix> matrix;
 };
 
-HybridBinarizer::HybridBinarizer(const std::shared_ptr<const LuminanceSource>& source) :
+HybridBinarizer::HybridBinarizer(const std::shared_ptr<const LuminanceSource>& source, int numBands, int blockSize,
+								 bool lowMemory) :
 	GlobalHistogramBinarizer(source),
-	_cache(new DataCache)
+	_cache(new DataCache),
+	_numBands(numBands),
+	_blockSize(blockSize),
+	_lowMemory(lowMemory)
+{
+}
+
+HybridBinarizer::HybridBinarizer(const LuminanceSource& source, int numBands, int blockSize, bool lowMemory) :
+	GlobalHistogramBinarizer(source),
+	_cache(new DataCache),
+	_numBands(numBands),
+	_blockSize(blockSize),
+	_lowMemory(lowMemory)
 {
 }
 
 HybridBinarizer::~HybridBinarizer() = default;
 
+/**
+* Computes sum, min and max of the luminances of the 8x8 blocks [begin, end) in the block row starting at line
+* 'yoffset'. All blocks except the last one in a row are adjacent, so the vectorized versions below only need to
+* handle those and leave the rest to this scalar version.
+*/
+static void CalculateBlockStats(const uint8_t* luminances, int yoffset, int width, int stride, int begin, int end,
+								int* sums, int* mins, int* maxs)
+{
+	for (int x = begin; x < end; x++) {
+		int xoffset = std::min(x * BLOCK_SIZE, width - BLOCK_SIZE);
+		int sum = 0;
+		int min = 0xFF;
+		int max = 0;
+		for (int yy = 0, offset = yoffset * stride + xoffset; yy < BLOCK_SIZE; yy++, offset += stride) {
+			for (int xx = 0; xx < BLOCK_SIZE; xx++) {
+				int pixel = luminances[offset + xx];
+				sum += pixel;
+				min = std::min(min, pixel);
+				max = std::max(max, pixel);
+			}
+		}
+		sums[x] = sum;
+		mins[x] = min;
+		maxs[x] = max;
+	}
+}
+
+#ifdef ZX_HAS_X86_DISPATCH
+
+// 2 blocks per iteration: vertical min/max over the 8 lines, then horizontal reduction within each 64-bit half
+ZX_TARGET("sse2")
+static int CalculateBlockStatsSSE2(const uint8_t* luminances, int yoffset, int width, int stride, int* sums, int* mins,
+								   int* maxs)
+{
+	const __m128i zero = _mm_setzero_si128();
+	int x = 0;
+	for (; (x + 2) * BLOCK_SIZE <= width; x += 2) {
+		const uint8_t* p = luminances + yoffset * stride + x * BLOCK_SIZE;
+		__m128i vmin = _mm_set1_epi8(-1), vmax = zero, vsum = zero;
+		for (int yy = 0; yy < BLOCK_SIZE; yy++, p += stride) {
+			__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+			vmin = _mm_min_epu8(vmin, v);
+			vmax = _mm_max_epu8(vmax, v);
+			vsum = _mm_add_epi64(vsum, _mm_sad_epu8(v, zero));
+		}
+		for (int shift : {32, 16, 8}) {
+			vmin = _mm_min_epu8(vmin, _mm_srli_epi64(vmin, shift));
+			vmax = _mm_max_epu8(vmax, _mm_srli_epi64(vmax, shift));
+		}
+		sums[x] = _mm_extract_epi16(vsum, 0), sums[x + 1] = _mm_extract_epi16(vsum, 4);
+		mins[x] = _mm_extract_epi16(vmin, 0) & 0xFF, mins[x + 1] = _mm_extract_epi16(vmin, 4) & 0xFF;
+		maxs[x] = _mm_extract_epi16(vmax, 0) & 0xFF, maxs[x + 1] = _mm_extract_epi16(vmax, 4) & 0xFF;
+	}
+	return x;
+}
+
+// same as above with 4 blocks per iteration
+ZX_TARGET("avx2")
+static int CalculateBlockStatsAVX2(const uint8_t* luminances, int yoffset, int width, int stride, int* sums, int* mins,
+								   int* maxs)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	int x = 0;
+	for (; (x + 4) * BLOCK_SIZE <= width; x += 4) {
+		const uint8_t* p = luminances + yoffset * stride + x * BLOCK_SIZE;
+		__m256i vmin = _mm256_set1_epi8(-1), vmax = zero, vsum = zero;
+		for (int yy = 0; yy < BLOCK_SIZE; yy++, p += stride) {
+			__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+			vmin = _mm256_min_epu8(vmin, v);
+			vmax = _mm256_max_epu8(vmax, v);
+			vsum = _mm256_add_epi64(vsum, _mm256_sad_epu8(v, zero));
+		}
+		for (int shift : {32, 16, 8}) {
+			vmin = _mm256_min_epu8(vmin, _mm256_srli_epi64(vmin, shift));
+			vmax = _mm256_max_epu8(vmax, _mm256_srli_epi64(vmax, shift));
+		}
+		alignas(32) uint64_t s[4], lo[4], hi[4];
+		_mm256_store_si256(reinterpret_cast<__m256i*>(s), vsum);
+		_mm256_store_si256(reinterpret_cast<__m256i*>(lo), vmin);
+		_mm256_store_si256(reinterpret_cast<__m256i*>(hi), vmax);
+		for (int i = 0; i < 4; ++i) {
+			sums[x + i] = static_cast<int>(s[i]);
+			mins[x + i] = lo[i] & 0xFF;
+			maxs[x + i] = hi[i] & 0xFF;
+		}
+	}
+	return x;
+}
+
+#endif // ZX_HAS_X86_DISPATCH
+
+#ifdef ZX_HAS_WASM_SIMD
+
+// 2 blocks per iteration like the SSE2 version, the horizontal reduction is done on the stored lanes
+static int CalculateBlockStatsWASM(const uint8_t* luminances, int yoffset, int width, int stride, int* sums, int* mins,
+								   int* maxs)
+{
+	int x = 0;
+	for (; (x + 2) * BLOCK_SIZE <= width; x += 2) {
+		const uint8_t* p = luminances + yoffset * stride + x * BLOCK_SIZE;
+		v128_t vmin = wasm_i8x16_splat(-1), vmax = wasm_i8x16_splat(0), vsum = wasm_i16x8_splat(0);
+		for (int yy = 0; yy < BLOCK_SIZE; yy++, p += stride) {
+			v128_t v = wasm_v128_load(p);
+			vmin = wasm_u8x16_min(vmin, v);
+			vmax = wasm_u8x16_max(vmax, v);
+			vsum = wasm_i16x8_add(vsum, wasm_u16x8_extadd_pairwise_u8x16(v));
+		}
+		alignas(16) uint8_t lo[16], hi[16];
+		alignas(16) uint16_t s[8];
+		wasm_v128_store(lo, vmin);
+		wasm_v128_store(hi, vmax);
+		wasm_v128_store(s, vsum);
+		for (int i = 0; i < 2; ++i) {
+			sums[x + i] = s[4 * i] + s[4 * i + 1] + s[4 * i + 2] + s[4 * i + 3];
+			mins[x + i] = *std::min_element(lo + 8 * i, lo + 8 * i + 8);
+			maxs[x + i] = *std::max_element(hi + 8 * i, hi + 8 * i + 8);
+		}
+	}
+	return x;
+}
+
+#endif // ZX_HAS_WASM_SIMD
+
+/**
+* Runs f(begin, end) for numBands consecutive ranges of block rows in parallel. A band has at least 8 block rows, which
+* also keeps the last block row (that overlaps the one before it) in the same band as its predecessor.
+*/
+static void ForEachBand(int numBands, int subHeight, const std::function<void(int, int)>& f)
+{
+	numBands = Clamp(numBands, 1, std::max(1, subHeight / 8));
+	ParallelFor(numBands, [&](int i) { f(subHeight * i / numBands, subHeight * (i + 1) / numBands); });
+}
+
+/**
+* The black point of a block from the average, min and max of its pixels and the weighted average of the black points
+* of the blocks above and to the left of it (-1 for the blocks in the first row/column).
+*/
+static int BlockBlackPoint(int average, int min, int max, int averageNeighborBlackPoint)
+{
+	if (max - min <= MIN_DYNAMIC_RANGE) {
+		// If variation within the block is low, assume this is a block with only light or only
+		// dark pixels. In that case we do not want to use the average, as it would divide this
+		// low contrast area into black and white pixels, essentially creating data out of noise.
+		//
+		// The default assumption is that the block is light/background. Since no estimate for
+		// the level of dark pixels exists locally, use half the min for the block.
+		average = min / 2;
+
+		// Correct the "white background" assumption for blocks that have neighbors by comparing
+		// the pixels in this block to the previously calculated black points. This is based on
+		// the fact that dark barcode symbology is always surrounded by some amount of light
+		// background for which reasonable black point estimates were made. The bp estimated at
+		// the boundaries is used for the interior.
+
+		// The (min < bp) is arbitrary but works better than other heuristics that were tried.
+		if (averageNeighborBlackPoint >= 0 && min < averageNeighborBlackPoint)
+			average = averageNeighborBlackPoint;
+	}
+	return average;
+}
+
 /**
 * Calculates a single black point for each block of pixels and saves it away.
 * See the following thread for a discussion of this algorithm:
 *  http://groups.google.com/group/zxing/browse_thread/thread/d06efa2c35a7ddc0
 */
-static Matrix<int> CalculateBlackPoints(const uint8_t* luminances, int subWidth, int subHeight, int width, int height, int stride)
+static Matrix<int> CalculateBlackPoints(const uint8_t* luminances, int subWidth, int subHeight, int width, int height, int stride,
+										int scale, int numBands)
 {
-	Matrix<int>	blackPoints(subWidth, subHeight);
+	Matrix<int> sums(subWidth, subHeight), mins(subWidth, subHeight), maxs(subWidth, subHeight);
 
-	for (int y = 0; y < subHeight; y++) {
-		int yoffset = std::min(y * BLOCK_SIZE, height - BLOCK_SIZE);
-		for (int x = 0; x < subWidth; x++) {
-			int xoffset = std::min(x * BLOCK_SIZE, width - BLOCK_SIZE);
-			int sum = 0;
-			int min = 0xFF;
-			int max = 0;
-			for (int yy = 0, offset = yoffset * stride + xoffset; yy < BLOCK_SIZE; yy++, offset += stride) {
-				for (int xx = 0; xx < BLOCK_SIZE; xx++) {
-					int pixel = luminances[offset + xx];
-					sum += pixel;
-					// still looking for good contrast
-					if (pixel < min) {
-						min = pixel;
-					}
-					if (pixel > max) {
-						max = pixel;
-					}
-				}
-				// short-circuit min/max tests once dynamic range is met
-				if (max - min > MIN_DYNAMIC_RANGE) {
-					// finish the rest of the rows quickly
-					for (yy++, offset += stride; yy < BLOCK_SIZE; yy++, offset += stride) {
-						for (int xx = 0; xx < BLOCK_SIZE; xx++) {
-							sum += luminances[offset + xx];
-						}
-					}
-				}
-			}
+	// the block statistics are independent of each other and can be computed in parallel
+	ForEachBand(numBands, subHeight, [&](int begin, int end) {
+		for (int y = begin; y < end; y++) {
+			int yoffset = std::min(y * BLOCK_SIZE, height - BLOCK_SIZE);
+			int *sum = &sums(0, y), *min = &mins(0, y), *max = &maxs(0, y);
+			int done = 0;
+#ifdef ZX_HAS_X86_DISPATCH
+			if (CpuFeatures::HasAVX2())
+				done = CalculateBlockStatsAVX2(luminances, yoffset, width, stride, sum, min, max);
+			else if (CpuFeatures::HasSSE2())
+				done = CalculateBlockStatsSSE2(luminances, yoffset, width, stride, sum, min, max);
+#elif defined(ZX_HAS_WASM_SIMD)
+			if (CpuFeatures::HasWasmSimd())
+				done = CalculateBlockStatsWASM(luminances, yoffset, width, stride, sum, min, max);
+#endif
+			CalculateBlockStats(luminances, yoffset, width, stride, done, subWidth, sum, min, max);
+		}
+	});
 
-			// The default estimate is the average of the values in the block.
-			int average = sum / (BLOCK_SIZE * BLOCK_SIZE);
-			if (max - min <= MIN_DYNAMIC_RANGE) {
-				// If variation within the block is low, assume this is a block with only light or only
-				// dark pixels. In that case we do not want to use the average, as it would divide this
-				// low contrast area into black and white pixels, essentially creating data out of noise.
-				//
-				// The default assumption is that the block is light/background. Since no estimate for
-				// the level of dark pixels exists locally, use half the min for the block.
-				average = min / 2;
-
-				if (y > 0 && x > 0) {
-					// Correct the "white background" assumption for blocks that have neighbors by comparing
-					// the pixels in this block to the previously calculated black points. This is based on
-					// the fact that dark barcode symbology is always surrounded by some amount of light
-					// background for which reasonable black point estimates were made. The bp estimated at
-					// the boundaries is used for the interior.
-
-					// The (min < bp) is arbitrary but works better than other heuristics that were tried.
-					int averageNeighborBlackPoint =
-						(blackPoints(x, y - 1) + (2 * blackPoints(x - 1, y)) + blackPoints(x - 1, y - 1)) / 4;
-					if (min < averageNeighborBlackPoint) {
-						average = averageNeighborBlackPoint;
-					}
-				}
+	// a larger block combines scale x scale of the 8x8 ones, the ones in the last row/column possibly fewer
+	const int blocksWidth = (subWidth + scale - 1) / scale;
+	const int blocksHeight = (subHeight + scale - 1) / scale;
+	if (scale > 1) {
+		Matrix<int> blockSums(blocksWidth, blocksHeight, 0), blockMins(blocksWidth, blocksHeight, 0xFF),
+			blockMaxs(blocksWidth, blocksHeight, 0);
+		for (int y = 0; y < subHeight; y++) {
+			for (int x = 0; x < subWidth; x++) {
+				blockSums(x / scale, y / scale) += sums(x, y);
+				blockMins(x / scale, y / scale) = std::min(blockMins(x / scale, y / scale), mins(x, y));
+				blockMaxs(x / scale, y / scale) = std::max(blockMaxs(x / scale, y / scale), maxs(x, y));
 			}
-			blackPoints(x, y) = average;
+		}
+		sums = std::move(blockSums);
+		mins = std::move(blockMins);
+		maxs = std::move(blockMaxs);
+	}
+
+	// the black points depend on the ones above and to the left, this (cheap) part is done serially
+	Matrix<int> blackPoints(blocksWidth, blocksHeight);
+	for (int y = 0; y < blocksHeight; y++) {
+		for (int x = 0; x < blocksWidth; x++) {
+			int pixels = (std::min(subWidth, (x + 1) * scale) - x * scale) *
+						 (std::min(subHeight, (y + 1) * scale) - y * scale) * BLOCK_SIZE * BLOCK_SIZE;
+			int neighbors = y > 0 && x > 0
+								? (blackPoints(x, y - 1) + (2 * blackPoints(x - 1, y)) + blackPoints(x - 1, y - 1)) / 4
+								: -1;
+			blackPoints(x, y) = BlockBlackPoint(sums(x, y) / pixels, mins(x, y), maxs(x, y), neighbors);
 		}
 	}
 	return blackPoints;
@@ -140,40 +315,143 @@ static void ThresholdBlock(const uint8_t* luminances, int xoffset, int yoffset,
 	}
 }
 
+#if defined(ZX_HAS_X86_DISPATCH) && defined(ZX_FAST_BIT_STORAGE)
+
+/**
+* Applies the thresholds to the adjacent blocks of one block row, 16 pixels (2 blocks) per compare. Like set() in
+* ThresholdBlock, the result is or'ed into the matrix, which matters where the last block row/column overlaps.
+*/
+ZX_TARGET("sse2")
+static int ThresholdBlockRowSSE2(const uint8_t* luminances, int yoffset, int width, int stride, const int* thresholds,
+								 BitMatrix& matrix)
+{
+	const __m128i one = _mm_set1_epi8(1);
+	int x = 0;
+	for (; (x + 2) * BLOCK_SIZE <= width; x += 2) {
+		const __m128i t = _mm_unpacklo_epi64(_mm_set1_epi8(static_cast<char>(thresholds[x])),
+											 _mm_set1_epi8(static_cast<char>(thresholds[x + 1])));
+		const uint8_t* src = luminances + yoffset * stride + x * BLOCK_SIZE;
+		for (int y = 0; y < BLOCK_SIZE; y++, src += stride) {
+			auto dst = reinterpret_cast<__m128i*>(matrix.row(yoffset + y).begin() + x * BLOCK_SIZE);
+			__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+			// v <= t  <=>  min(v, t) == v
+			__m128i black = _mm_and_si128(_mm_cmpeq_epi8(_mm_min_epu8(v, t), v), one);
+			_mm_storeu_si128(dst, _mm_or_si128(_mm_loadu_si128(dst), black));
+		}
+	}
+	return x;
+}
+
+#endif
+
 /**
 * For each block in the image, calculate the average black point using a 5x5 grid
 * of the blocks around it. Also handles the corner cases (fractional blocks are computed based
 * on the last pixels in the row/column which are also used in the previous block).
+* The thresholds of larger blocks (see CalculateBlackPoints) are applied to each of their 8x8 blocks.
 */
 static void CalculateThresholdForBlock(const uint8_t* luminances, int subWidth, int subHeight, int width, int height,
-                                       int stride, const Matrix<int>& blackPoints, BitMatrix& matrix)
-{
-	for (int y = 0; y < subHeight; y++) {
-		int yoffset = std::min(y * BLOCK_SIZE, height - BLOCK_SIZE);
-		for (int x = 0; x < subWidth; x++) {
-			int xoffset = std::min(x * BLOCK_SIZE, width - BLOCK_SIZE);
-			int left = Clamp(x, 2, subWidth - 3);
-			int top = Clamp(y, 2, subHeight - 3);
-			int sum = 0;
-			for (int dy = -2; dy <= 2; ++dy) {
-				for (int dx = -2; dx <= 2; ++dx) {
-					sum += blackPoints(left + dx, top + dy);
+                                       int stride, const Matrix<int>& blackPoints, int scale, BitMatrix& matrix,
+                                       int numBands)
+{
+	// every band writes to its own lines of the matrix only, see ForEachBand
+	ForEachBand(numBands, subHeight, [&](int begin, int end) {
+		std::vector<int> thresholds(subWidth);
+		for (int y = begin; y < end; y++) {
+			int yoffset = std::min(y * BLOCK_SIZE, height - BLOCK_SIZE);
+			if (y == begin || y % scale == 0) {
+				for (int x = 0; x < blackPoints.width(); x++) {
+					int left = Clamp(x, 2, blackPoints.width() - 3);
+					int top = Clamp(y / scale, 2, blackPoints.height() - 3);
+					int sum = 0;
+					for (int dy = -2; dy <= 2; ++dy) {
+						for (int dx = -2; dx <= 2; ++dx) {
+							sum += blackPoints(left + dx, top + dy);
+						}
+					}
+					std::fill(thresholds.begin() + x * scale, thresholds.begin() + std::min(subWidth, (x + 1) * scale),
+							  sum / 25);
 				}
 			}
-			int average = sum / 25;
-			ThresholdBlock(luminances, xoffset, yoffset, average, stride, matrix);
+
+			int done = 0;
+#if defined(ZX_HAS_X86_DISPATCH) && defined(ZX_FAST_BIT_STORAGE)
+			if (CpuFeatures::HasSSE2())
+				done = ThresholdBlockRowSSE2(luminances, yoffset, width, stride, thresholds.data(), matrix);
+#endif
+			for (int x = done; x < subWidth; x++) {
+				int xoffset = std::min(x * BLOCK_SIZE, width - BLOCK_SIZE);
+				ThresholdBlock(luminances, xoffset, yoffset, thresholds[x], stride, matrix);
+			}
+		}
+	});
+}
+
+
+/**
+* Appends the lengths of the dark and light runs of a row with enough contrast to 'runs', see EstimateModuleSize.
+*/
+static void CollectRuns(const uint8_t* row, int width, std::vector<int>& runs)
+{
+	auto minmax = std::minmax_element(row, row + width);
+	if (*minmax.second - *minmax.first <= 2 * MIN_DYNAMIC_RANGE)
+		return;
+	int threshold = (*minmax.first + *minmax.second) / 2;
+	bool dark = row[0] <= threshold;
+	int start = -1; // the run touching the left border is not complete
+	for (int x = 1; x < width; ++x) {
+		if ((row[x] <= threshold) != dark) {
+			if (start >= 0)
+				runs.push_back(x - start);
+			start = x;
+			dark = !dark;
 		}
 	}
 }
 
+/**
+* Quick estimate of the module size from the run lengths of every 16th row (see CollectRuns), 0 if there are too
+* few of them. The shortest runs are the single modules, so the lower quartile of the run lengths is a robust measure.
+*/
+static float ModuleSizeFromRuns(std::vector<int>& runs)
+{
+	if (Size(runs) < 32)
+		return 0;
+	auto quartile = runs.begin() + runs.size() / 4;
+	std::nth_element(runs.begin(), quartile, runs.end());
+	return static_cast<float>(*quartile);
+}
+
+static float EstimateModuleSize(const uint8_t* luminances, int width, int height, int stride)
+{
+	std::vector<int> runs;
+	for (int y = 8; y < height; y += 16)
+		CollectRuns(luminances + y * stride, width, runs);
+	return ModuleSizeFromRuns(runs);
+}
+
+/**
+* The number of 8x8 blocks in each direction of the blocks the black points are computed for (see
+* CalculateBlackPoints). The 5x5 neighborhood needs at least 5 blocks in each direction.
+*/
+static int BlockScale(int blockSize, int subWidth, int subHeight)
+{
+	int scale = Clamp(blockSize, BLOCK_SIZE, MAX_BLOCK_SIZE) / BLOCK_SIZE;
+	while (scale > 1 && std::min(subWidth, subHeight) < 4 * scale + 1)
+		scale /= 2;
+	return scale;
+}
 
 /**
 * Calculates the final BitMatrix once for all requests. This could be called once from the
 * constructor instead, but there are some advantages to doing it lazily, such as making
 * profiling easier, and not doing heavy lifting when callers don't expect it.
 */
-static void InitBlackMatrix(const LuminanceSource& source, std::shared_ptr<const BitMatrix>& outMatrix)
+static void InitBlackMatrix(const LuminanceSource& source, int numBands, int blockSize,
+							std::shared_ptr<const BitMatrix>& outMatrix)
 {
+	ZX_TRACE_SCOPE("HybridBinarizer::InitBlackMatrix");
+	DecodeStats::StageTimer timer(DecodeStats::Stage::Binarize);
 	int width = source.width();
 	int height = source.height();
 	ByteArray buffer;
@@ -181,20 +459,140 @@ static void InitBlackMatrix(const LuminanceSource& source, std::shared_ptr<const
 	const uint8_t* luminances = source.getMatrix(buffer, stride);
 	int subWidth = (width + BLOCK_SIZE - 1) / BLOCK_SIZE; // ceil(width/BS)
 	int subHeight = (height + BLOCK_SIZE - 1) / BLOCK_SIZE; // ceil(height/BS)
-	auto blackPoints = CalculateBlackPoints(luminances, subWidth, subHeight, width, height, stride);
+
+	if (blockSize == 0)
+		blockSize = HybridBinarizer::BlockSizeForModuleSize(EstimateModuleSize(luminances, width, height, stride));
+	int scale = BlockScale(blockSize, subWidth, subHeight);
+
+	auto blackPoints = CalculateBlackPoints(luminances, subWidth, subHeight, width, height, stride, scale, numBands);
 
 	auto matrix = std::make_shared<BitMatrix>(width, height);
-	CalculateThresholdForBlock(luminances, subWidth, subHeight, width, height, stride, blackPoints, *matrix);
+	CalculateThresholdForBlock(luminances, subWidth, subHeight, width, height, stride, blackPoints, scale, *matrix,
+							   numBands);
 	outMatrix = std::move(matrix);
 }
 
+bool
+HybridBinarizer::BinarizeRows(const LuminanceSource& source, int blockSize,
+							  const std::function<void(int, const BitArray&)>& sink)
+{
+	int width = source.width();
+	int height = source.height();
+	if (width < MINIMUM_DIMENSION || height < MINIMUM_DIMENSION)
+		return false;
+
+	ByteArray buffer;
+	int subWidth = (width + BLOCK_SIZE - 1) / BLOCK_SIZE;
+	int subHeight = (height + BLOCK_SIZE - 1) / BLOCK_SIZE;
+	if (blockSize == 0) {
+		std::vector<int> runs;
+		for (int y = 8; y < height; y += 16)
+			CollectRuns(source.getRow(y, buffer), width, runs);
+		blockSize = BlockSizeForModuleSize(ModuleSizeFromRuns(runs));
+	}
+	int scale = BlockScale(blockSize, subWidth, subHeight);
+	const int blocksWidth = (subWidth + scale - 1) / scale;
+	const int blocksHeight = (subHeight + scale - 1) / scale;
+
+	// the black points of the last 5 block rows, all the 5x5 neighborhood of a threshold needs
+	std::array<std::vector<uint8_t>, 5> blackPoints;
+	for (auto& row : blackPoints)
+		row.resize(blocksWidth);
+	std::vector<int> sums(blocksWidth), mins(blocksWidth), maxs(blocksWidth), thresholds(blocksWidth);
+	// the output lines of the current 8x8 block row, the last one overlaps the one before it
+	std::array<BitArray, BLOCK_SIZE> lines;
+	for (auto& line : lines)
+		line = BitArray(width);
+	int nextLine = 0;
+
+	auto thresholdBlockRow = [&](int by) {
+		int top = Clamp(by, 2, blocksHeight - 3);
+		for (int x = 0; x < blocksWidth; x++) {
+			int left = Clamp(x, 2, blocksWidth - 3);
+			int sum = 0;
+			for (int dy = -2; dy <= 2; ++dy)
+				for (int dx = -2; dx <= 2; ++dx)
+					sum += blackPoints[(top + dy) % 5][left + dx];
+			thresholds[x] = sum / 25;
+		}
+		for (int y = by * scale; y < std::min(subHeight, (by + 1) * scale); y++) {
+			int yoffset = std::min(y * BLOCK_SIZE, height - BLOCK_SIZE);
+			for (; nextLine < yoffset; ++nextLine) {
+				sink(nextLine, lines[nextLine % BLOCK_SIZE]);
+				lines[nextLine % BLOCK_SIZE].clearBits();
+			}
+			for (int yy = yoffset; yy < yoffset + BLOCK_SIZE; yy++) {
+				const uint8_t* row = source.getRow(yy, buffer);
+				BitArray& line = lines[yy % BLOCK_SIZE];
+				for (int x = 0; x < subWidth; x++) {
+					int xoffset = std::min(x * BLOCK_SIZE, width - BLOCK_SIZE);
+					int threshold = thresholds[x / scale];
+					// Comparison needs to be <= so that black == 0 pixels are black even if the threshold is 0.
+					for (int xx = xoffset; xx < xoffset + BLOCK_SIZE; xx++)
+						if (row[xx] <= threshold)
+							line.set(xx);
+				}
+			}
+		}
+	};
+
+	int nextBlockRow = 0; // the next block row to threshold
+	for (int by = 0; by < blocksHeight; by++) {
+		std::fill(sums.begin(), sums.end(), 0);
+		std::fill(mins.begin(), mins.end(), 0xFF);
+		std::fill(maxs.begin(), maxs.end(), 0);
+		for (int y = by * scale; y < std::min(subHeight, (by + 1) * scale); y++) {
+			int yoffset = std::min(y * BLOCK_SIZE, height - BLOCK_SIZE);
+			for (int yy = yoffset; yy < yoffset + BLOCK_SIZE; yy++) {
+				const uint8_t* row = source.getRow(yy, buffer);
+				for (int x = 0; x < subWidth; x++) {
+					int xoffset = std::min(x * BLOCK_SIZE, width - BLOCK_SIZE);
+					auto minmax = std::minmax_element(row + xoffset, row + xoffset + BLOCK_SIZE);
+					sums[x / scale] = std::accumulate(row + xoffset, row + xoffset + BLOCK_SIZE, sums[x / scale]);
+					mins[x / scale] = std::min<int>(mins[x / scale], *minmax.first);
+					maxs[x / scale] = std::max<int>(maxs[x / scale], *minmax.second);
+				}
+			}
+		}
+
+		auto& current = blackPoints[by % 5];
+		const auto& above = blackPoints[(by + 4) % 5];
+		for (int x = 0; x < blocksWidth; x++) {
+			int pixels = (std::min(subWidth, (x + 1) * scale) - x * scale) *
+						 (std::min(subHeight, (by + 1) * scale) - by * scale) * BLOCK_SIZE * BLOCK_SIZE;
+			int neighbors = by > 0 && x > 0 ? (above[x] + (2 * current[x - 1]) + above[x - 1]) / 4 : -1;
+			current[x] = static_cast<uint8_t>(BlockBlackPoint(sums[x] / pixels, mins[x], maxs[x], neighbors));
+		}
+
+		// a block row can be thresholded as soon as the last black point row of its neighborhood is known
+		for (; nextBlockRow < blocksHeight && Clamp(nextBlockRow, 2, blocksHeight - 3) + 2 <= by; nextBlockRow++)
+			thresholdBlockRow(nextBlockRow);
+	}
+	for (; nextLine < height; ++nextLine)
+		sink(nextLine, lines[nextLine % BLOCK_SIZE]);
+
+	return true;
+}
+
 std::shared_ptr<const BitMatrix>
 HybridBinarizer::getBlackMatrix() const
 {
 	int width = _source->width();
 	int height = _source->height();
 	if (width >= MINIMUM_DIMENSION && height >= MINIMUM_DIMENSION) {
-		std::call_once(_cache->once, &InitBlackMatrix, std::cref(*_source), std::ref(_cache->matrix));
+		if (_lowMemory) {
+			std::call_once(_cache->once, [this]() {
+				ZX_TRACE_SCOPE("HybridBinarizer::BinarizeRows");
+				DecodeStats::StageTimer timer(DecodeStats::Stage::Binarize);
+				auto matrix = std::make_shared<BitMatrix>(_source->width(), _source->height());
+				BinarizeRows(*_source, _blockSize, [&](int y, const BitArray& row) { matrix->setRow(y, row); });
+				_cache->matrix = std::move(matrix);
+			});
+		}
+		else {
+			std::call_once(_cache->once, &InitBlackMatrix, std::cref(*_source), _numBands, _blockSize,
+						   std::ref(_cache->matrix));
+		}
 		return _cache->matrix;
 	}
 	else {
@@ -206,7 +604,22 @@ HybridBinarizer::getBlackMatrix() const
 std::shared_ptr<BinaryBitmap>
 HybridBinarizer::newInstance(const std::shared_ptr<const LuminanceSource>& source) const
 {
-	return std::make_shared<HybridBinarizer>(source);
+	return std::make_shared<HybridBinarizer>(source, _numBands, _blockSize, _lowMemory);
+}
+
+std::shared_ptr<GlobalHistogramBinarizer>
+HybridBinarizer::sharedCopy() const
+{
+	return std::shared_ptr<GlobalHistogramBinarizer>(new HybridBinarizer(*this));
+}
+
+int
+HybridBinarizer::BlockSizeForModuleSize(float moduleSize)
+{
+	int blockSize = BLOCK_SIZE;
+	while (blockSize < MAX_BLOCK_SIZE && 2 * blockSize <= moduleSize)
+		blockSize *= 2;
+	return blockSize;
 }
 
 } // ZXing
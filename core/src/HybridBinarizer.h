@@ -18,6 +18,7 @@
 
 #include "GlobalHistogramBinarizer.h"
 
+#include <functional>
 #include <memory>
 
 namespace ZXing {
@@ -42,15 +43,50 @@ namespace ZXing {
 class HybridBinarizer : public GlobalHistogramBinarizer
 {
 public:
-	explicit HybridBinarizer(const std::shared_ptr<const LuminanceSource>& source);
+	/**
+	* @param numBands  number of horizontal bands the image is split into, which are binarized in parallel using
+	*                  ParallelFor (see Parallel.h)
+	* @param blockSize side length in pixels of the blocks a threshold is computed for: 8, 16 or 32, or 0 to choose
+	*                  it from a quick estimate of the module size (see BlockSizeForModuleSize). Larger blocks
+	*                  avoid artifacts inside large modules and need less work per pixel.
+	* @param lowMemory build the black matrix with BinarizeRows (numBands is ignored then), for devices where the
+	*                  luminance copy and the temporary block statistics of a large image do not fit
+	*/
+	explicit HybridBinarizer(const std::shared_ptr<const LuminanceSource>& source, int numBands = 1,
+							 int blockSize = 8, bool lowMemory = false);
+
+	/// Non-owning, see GlobalHistogramBinarizer
+	explicit HybridBinarizer(const LuminanceSource& source, int numBands = 1, int blockSize = 8,
+							 bool lowMemory = false);
 	~HybridBinarizer() override;
 
 	std::shared_ptr<const BitMatrix> getBlackMatrix() const override;
 	std::shared_ptr<BinaryBitmap> newInstance(const std::shared_ptr<const LuminanceSource>& source) const override;
 
+	/// The largest supported block size that is not larger than the module size (at least 8)
+	static int BlockSizeForModuleSize(float moduleSize);
+
+	/**
+	* Streaming variant of getBlackMatrix() with the same result, for memory constrained devices. The luminance is
+	* read a few lines at a time with LuminanceSource::getRow(), only the 5 rows of black points (as bytes) the 5x5
+	* neighborhood needs are kept and every finished row is passed to 'sink' in top to bottom order. The working
+	* memory is proportional to the width of the image, not to its size.
+	*
+	* @return false if the image is too small for the local thresholding, see getBlackMatrix()
+	*/
+	static bool BinarizeRows(const LuminanceSource& source, int blockSize,
+							 const std::function<void(int y, const BitArray& row)>& sink);
+
+protected:
+	HybridBinarizer(const HybridBinarizer& other) = default;
+	std::shared_ptr<GlobalHistogramBinarizer> sharedCopy() const override;
+
 private:
 	struct DataCache;
-	std::unique_ptr<DataCache> _cache;
+	std::shared_ptr<DataCache> _cache;
+	int _numBands = 1;
+	int _blockSize = 8;
+	bool _lowMemory = false;
 };
 
 } // ZXing
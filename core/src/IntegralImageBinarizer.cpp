@@ -0,0 +1,139 @@
+/*
+* Copyright 2020 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "IntegralImageBinarizer.h"
+#include "LuminanceSource.h"
+#include "ByteArray.h"
+#include "BitMatrix.h"
+#include "DecodeStats.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace ZXing {
+
+static const int DEFAULT_WINDOW_SIZE = 40;
+
+struct IntegralImageBinarizer::DataCache
+{
+	std::once_flag tableOnce;
+	// (width + 1) x (height + 1) table, entry (x, y) is the sum of all luminances above and left of pixel (x, y).
+	// The sums may wrap around for huge images, the (unsigned) differences of the window sums are still correct.
+	std::vector<uint32_t> table;
+
+	std::once_flag matrixOnce;
+	std::shared_ptr<const BitMatrix> matrix;
+};
+
+IntegralImageBinarizer::IntegralImageBinarizer(const std::shared_ptr<const LuminanceSource>& source, int windowSize,
+											   int offset)
+	: GlobalHistogramBinarizer(source), _cache(new DataCache), _windowSize(windowSize > 0 ? windowSize : DEFAULT_WINDOW_SIZE),
+	  _offset(offset)
+{}
+
+IntegralImageBinarizer::IntegralImageBinarizer(const LuminanceSource& source, int windowSize, int offset)
+	: GlobalHistogramBinarizer(source), _cache(new DataCache), _windowSize(windowSize > 0 ? windowSize : DEFAULT_WINDOW_SIZE),
+	  _offset(offset)
+{}
+
+IntegralImageBinarizer::~IntegralImageBinarizer() = default;
+
+static void InitTable(const LuminanceSource& source, std::vector<uint32_t>& table)
+{
+	const int width = source.width();
+	const int height = source.height();
+	ByteArray buffer;
+	int stride;
+	const uint8_t* luminances = source.getMatrix(buffer, stride);
+
+	table.assign((width + 1) * (height + 1), 0);
+	for (int y = 0; y < height; ++y) {
+		const uint8_t* src = luminances + y * stride;
+		const uint32_t* above = table.data() + y * (width + 1);
+		uint32_t* dst = table.data() + (y + 1) * (width + 1);
+		uint32_t rowSum = 0;
+		for (int x = 0; x < width; ++x) {
+			rowSum += src[x];
+			dst[x + 1] = above[x + 1] + rowSum;
+		}
+	}
+}
+
+std::shared_ptr<const BitMatrix>
+IntegralImageBinarizer::getBlackMatrix(int windowSize) const
+{
+	ZX_TRACE_SCOPE("IntegralImageBinarizer::getBlackMatrix");
+	DecodeStats::StageTimer timer(DecodeStats::Stage::Binarize);
+	const int width = _source->width();
+	const int height = _source->height();
+	std::call_once(_cache->tableOnce, &InitTable, std::cref(*_source), std::ref(_cache->table));
+
+	ByteArray buffer;
+	int stride;
+	const uint8_t* luminances = _source->getMatrix(buffer, stride);
+	const uint32_t* table = _cache->table.data();
+	const int tableStride = width + 1;
+	const int r = std::max(1, windowSize / 2);
+	const int64_t scale = 100 - _offset;
+
+	auto matrix = std::make_shared<BitMatrix>(width, height);
+	for (int y = 0; y < height; ++y) {
+		const int y0 = std::max(0, y - r), y1 = std::min(height, y + r + 1);
+		const uint32_t* top = table + y0 * tableStride;
+		const uint32_t* bottom = table + y1 * tableStride;
+		const uint8_t* src = luminances + y * stride;
+#ifdef ZX_FAST_BIT_STORAGE
+		auto dst = matrix->row(y).begin();
+#endif
+		for (int x = 0; x < width; ++x) {
+			const int x0 = std::max(0, x - r), x1 = std::min(width, x + r + 1);
+			const uint32_t sum = bottom[x1] - bottom[x0] - top[x1] + top[x0];
+			const int64_t count = (x1 - x0) * (y1 - y0);
+			// lum <= mean * (100 - offset) / 100
+#ifdef ZX_FAST_BIT_STORAGE
+			dst[x] = src[x] * count * 100 <= sum * scale;
+#else
+			if (src[x] * count * 100 <= sum * scale)
+				matrix->set(x, y);
+#endif
+		}
+	}
+	return matrix;
+}
+
+std::shared_ptr<const BitMatrix>
+IntegralImageBinarizer::getBlackMatrix() const
+{
+	std::call_once(_cache->matrixOnce, [this]() { _cache->matrix = getBlackMatrix(_windowSize); });
+	return _cache->matrix;
+}
+
+std::shared_ptr<BinaryBitmap>
+IntegralImageBinarizer::newInstance(const std::shared_ptr<const LuminanceSource>& source) const
+{
+	return std::make_shared<IntegralImageBinarizer>(source, _windowSize, _offset);
+}
+
+std::shared_ptr<GlobalHistogramBinarizer>
+IntegralImageBinarizer::sharedCopy() const
+{
+	return std::shared_ptr<GlobalHistogramBinarizer>(new IntegralImageBinarizer(*this));
+}
+
+} // ZXing
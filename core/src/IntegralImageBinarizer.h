@@ -0,0 +1,67 @@
+#pragma once
+/*
+* Copyright 2020 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "GlobalHistogramBinarizer.h"
+
+#include <memory>
+
+namespace ZXing {
+
+/**
+* Local mean thresholding (Bradley & Roth) based on a summed-area table of the luminance values: a pixel is
+* black if it is at least 'offset' percent darker than the mean of the window x window pixels around it.
+*
+* The table gives the mean of any window in constant time, so the cost does not depend on the window size. It is
+* computed once per instance and shared by all getBlackMatrix(windowSize) calls, which makes retries with
+* different window sizes cheap.
+*
+* Like HybridBinarizer, the 1D readers use the GlobalHistogramBinarizer rows.
+*/
+class IntegralImageBinarizer : public GlobalHistogramBinarizer
+{
+public:
+	/**
+	* @param windowSize  edge length of the local window in pixels, 0 picks a default (40, similar to HybridBinarizer)
+	* @param offset  percentage a pixel has to be darker than its local mean to be considered black
+	*/
+	explicit IntegralImageBinarizer(const std::shared_ptr<const LuminanceSource>& source, int windowSize = 0,
+									int offset = 15);
+
+	/// Non-owning, see GlobalHistogramBinarizer
+	explicit IntegralImageBinarizer(const LuminanceSource& source, int windowSize = 0, int offset = 15);
+	~IntegralImageBinarizer() override;
+
+	std::shared_ptr<const BitMatrix> getBlackMatrix() const override;
+	std::shared_ptr<BinaryBitmap> newInstance(const std::shared_ptr<const LuminanceSource>& source) const override;
+
+	/**
+	* Binarize with a different window size, reusing the summed-area table. The result is not cached.
+	*/
+	std::shared_ptr<const BitMatrix> getBlackMatrix(int windowSize) const;
+
+protected:
+	IntegralImageBinarizer(const IntegralImageBinarizer& other) = default;
+	std::shared_ptr<GlobalHistogramBinarizer> sharedCopy() const override;
+
+private:
+	struct DataCache;
+	std::shared_ptr<DataCache> _cache;
+	int _windowSize;
+	int _offset;
+};
+
+} // ZXing
@@ -0,0 +1,92 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "LineScanReader.h"
+#include "ByteArray.h"
+#include "DecodeStats.h"
+#include "GenericLuminanceSource.h"
+#include "GlobalHistogramBinarizer.h"
+#include "ViewLuminanceSource.h"
+#include "ZXContainerAlgorithms.h"
+#include "oned/ODReader.h"
+
+#include <algorithm>
+
+namespace ZXing {
+
+LineScanReader::LineScanReader(const DecodeHints& hints, int windowRows)
+	: _hints(hints), _windowRows(std::max(1, windowRows)), _decoder(new OneD::StreamDecoder(hints)),
+	  _buffer(std::make_shared<ByteArray>())
+{}
+
+LineScanReader::~LineScanReader() = default;
+
+LineScanReader::LineScanReader(LineScanReader&&) noexcept = default;
+LineScanReader& LineScanReader::operator=(LineScanReader&&) noexcept = default;
+
+Results LineScanReader::push(const ImageView& iv)
+{
+	DecodeStats::Scope statsScope(_hints.stats());
+
+	// the rows are binarized with a threshold per row, like the 1D readers do in a complete image
+	std::shared_ptr<const LuminanceSource> source;
+	if (PixStride(iv.format()) == 1 && iv.pixStride() == 1)
+		source = std::make_shared<ViewLuminanceSource>(iv.width(), iv.height(), iv.data(0, 0), iv.rowStride());
+	else
+		source = std::make_shared<GenericLuminanceSource>(0, 0, iv.width(), iv.height(), iv.data(0, 0),
+														  iv.rowStride(), iv.pixStride(), RedIndex(iv.format()),
+														  GreenIndex(iv.format()), BlueIndex(iv.format()), _buffer);
+	GlobalHistogramBinarizer image(source);
+
+	Results completed;
+	for (int y = 0; y < iv.height(); ++y, ++_rowNumber) {
+		// keep the partial symbols of the stacked readers for a limited number of rows only
+		if (_rowNumber - _lastStateReset >= _windowRows) {
+			_decoder->resetState();
+			_lastStateReset = _rowNumber;
+		}
+
+		for (auto& result : _decoder->decode(image, y, _rowNumber)) {
+			auto i = FindIf(_candidates, [&result](const Candidate& c) {
+				return c.result.format() == result.format() && c.result.text() == result.text();
+			});
+			if (i == _candidates.end())
+				i = _candidates.insert(i, {std::move(result), _rowNumber});
+			i->lastRow = _rowNumber;
+			i->result.incrementLineCount();
+			if (i->result.lineCount() == std::max(1, _hints.minLineCount()))
+				completed.push_back(i->result);
+		}
+
+		// symbols absent for windowRows rows are reported again when they reappear
+		_candidates.erase(std::remove_if(_candidates.begin(), _candidates.end(),
+										 [this](const Candidate& c) { return _rowNumber - c.lastRow >= _windowRows; }),
+						  _candidates.end());
+	}
+	DecodeStats::AddRowsScanned(iv.height());
+	return completed;
+}
+
+void LineScanReader::reset()
+{
+	_decoder->resetState();
+	_candidates.clear();
+	_rowNumber = 0;
+	_lastStateReset = 0;
+}
+
+} // ZXing
@@ -0,0 +1,90 @@
+#pragma once
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "DecodeHints.h"
+#include "ReadBarcode.h"
+#include "Result.h"
+
+#include <memory>
+
+namespace ZXing {
+
+class ByteArray;
+
+namespace OneD {
+class StreamDecoder;
+}
+
+/**
+ * Reads 1D (incl. stacked RSS) barcodes from a continuous stream of image rows, e.g. from a line scan camera.
+ *
+ * The rows are pushed as they arrive, one or a few at a time, and each of them is binarized and decoded right away.
+ * A symbol is reported by the push() of the row that completes it, i.e. once it was found in hints().minLineCount()
+ * rows. The same symbol is reported again only after it was absent for windowRows rows. The partial
+ * symbols of the stacked readers are kept for windowRows rows as well, so the memory use does not grow with the length
+ * of the stream. The position of a result is given in stream coordinates, its y being the number of the row
+ * (counted from the first row since the construction or reset()) it was first seen in.
+ *
+ * Only symbols whose bars cross the rows can be read, the hints tryRotate, tryHarder and the 2D formats have no
+ * effect. A LineScanReader holds per-stream state and must not be used concurrently from multiple threads.
+ */
+class LineScanReader
+{
+	struct Candidate
+	{
+		Result result;
+		int lastRow;
+	};
+
+	DecodeHints _hints;
+	int _windowRows;
+	std::unique_ptr<OneD::StreamDecoder> _decoder;
+	std::shared_ptr<ByteArray> _buffer;
+	std::vector<Candidate> _candidates;
+	int _rowNumber = 0;
+	int _lastStateReset = 0;
+
+public:
+	/**
+	 * @param hints  DecodeHints for the 1D readers
+	 * @param windowRows  number of rows after which an absent symbol is forgotten, see above
+	 */
+	explicit LineScanReader(const DecodeHints& hints = {}, int windowRows = 256);
+	~LineScanReader();
+
+	LineScanReader(LineScanReader&&) noexcept;
+	LineScanReader& operator=(LineScanReader&&) noexcept;
+
+	const DecodeHints& hints() const { return _hints; }
+
+	/**
+	 * Decode the next rows of the stream
+	 *
+	 * @param rows  view of one or more rows including layout and format, all pushes should have the same width
+	 * @return the symbols completed by these rows, possibly empty
+	 */
+	Results push(const ImageView& rows);
+
+	/// Number of rows pushed since the construction or the last reset()
+	int rowCount() const { return _rowNumber; }
+
+	/// Start a new stream, all candidates and partial symbols are dropped
+	void reset();
+};
+
+} // ZXing
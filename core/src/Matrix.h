@@ -15,6 +15,7 @@
 * See the License for the specific language governing permissions and
 * limitations under the License.
 */
+#include "MemoryResource.h"
 #include "ZXContainerAlgorithms.h"
 
 #include <algorithm>
@@ -32,7 +33,7 @@ public:
 private:
 	int _width = 0;
 	int _height = 0;
-	std::vector<value_t> _data;
+	Vector<value_t> _data;
 
 	// Nothing wrong to support it, just to make it explicit, instead of by mistake.
 	// Use copy() below.
@@ -0,0 +1,153 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "MemoryResource.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <new>
+
+namespace ZXing {
+
+namespace {
+
+class NewDeleteResource : public MemoryResource
+{
+protected:
+	void* doAllocate(std::size_t bytes, std::size_t) override { return ::operator new(bytes); }
+	void doDeallocate(void* p, std::size_t, std::size_t) noexcept override { ::operator delete(p); }
+};
+
+} // namespace
+
+static thread_local MemoryResource* t_current = nullptr;
+
+MemoryResource* MemoryResource::Default() noexcept
+{
+	// never destroyed: BitMatrix, Matrix and Vector objects with static storage duration may be destroyed after a
+	// function local static and still need their resource to free their storage
+	static auto resource = new NewDeleteResource;
+	return resource;
+}
+
+MemoryResource* MemoryResource::Current() noexcept
+{
+	return t_current ? t_current : Default();
+}
+
+MemoryResource::Scope::Scope(MemoryResource* resource) : _previous(t_current)
+{
+	t_current = resource;
+}
+
+MemoryResource::Scope::~Scope()
+{
+	t_current = _previous;
+}
+
+void* MonotonicBufferResource::doAllocate(std::size_t bytes, std::size_t alignment)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	auto align = [&] {
+		auto offset = (alignment - reinterpret_cast<std::uintptr_t>(_pos) % alignment) % alignment;
+		if (_pos == nullptr || offset + bytes > _available)
+			return false;
+		_pos += offset;
+		_available -= offset;
+		return true;
+	};
+
+	if (!align()) {
+		// chunks grow geometrically, a single large buffer (e.g. a BitMatrix) gets one of its own size at least
+		std::size_t size = std::max(_nextSize, bytes + alignment) + sizeof(Chunk);
+		auto chunk = static_cast<Chunk*>(::operator new(size));
+		*chunk = {_chunks, size};
+		_chunks = chunk;
+		_pos = reinterpret_cast<char*>(chunk + 1);
+		_available = size - sizeof(Chunk);
+		_allocated += size;
+		_nextSize = _nextSize + _nextSize / 2;
+		align();
+	}
+
+	void* res = _pos;
+	_pos += bytes;
+	_available -= bytes;
+	return res;
+}
+
+void* RecyclingMemoryResource::doAllocate(std::size_t bytes, std::size_t alignment)
+{
+	if (bytes >= _minBlockSize) {
+		std::lock_guard<std::mutex> lock(_mutex);
+		// most recently returned first, that is the one most likely still in the cache
+		for (auto i = _cached.rbegin(); i != _cached.rend(); ++i)
+			if (i->bytes == bytes && i->alignment == alignment) {
+				void* p = i->p;
+				_cachedBytes -= bytes;
+				_cached.erase(std::next(i).base());
+				return p;
+			}
+	}
+	return _upstream->allocate(bytes, alignment);
+}
+
+void RecyclingMemoryResource::doDeallocate(void* p, std::size_t bytes, std::size_t alignment) noexcept
+{
+	if (bytes < _minBlockSize || bytes > _maxCachedBytes)
+		return _upstream->deallocate(p, bytes, alignment);
+
+	std::lock_guard<std::mutex> lock(_mutex);
+	try {
+		_cached.push_back({p, bytes, alignment});
+	} catch (...) {
+		return _upstream->deallocate(p, bytes, alignment);
+	}
+	_cachedBytes += bytes;
+	while (_cachedBytes > _maxCachedBytes) {
+		auto& oldest = _cached.front();
+		_upstream->deallocate(oldest.p, oldest.bytes, oldest.alignment);
+		_cachedBytes -= oldest.bytes;
+		_cached.erase(_cached.begin());
+	}
+}
+
+void RecyclingMemoryResource::release() noexcept
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	for (auto& block : _cached)
+		_upstream->deallocate(block.p, block.bytes, block.alignment);
+	_cached.clear();
+	_cachedBytes = 0;
+}
+
+void MonotonicBufferResource::release() noexcept
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	while (_chunks) {
+		auto next = _chunks->next;
+		::operator delete(_chunks);
+		_chunks = next;
+	}
+	_pos = nullptr;
+	_available = 0;
+	_allocated = 0;
+}
+
+} // ZXing
@@ -0,0 +1,192 @@
+#pragma once
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include <cstddef>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+namespace ZXing {
+
+/**
+* Source of the memory of the temporary buffers of a decode call (the binarized image, the integral and block
+* matrices of the binarizers and the pattern rows of the detectors), modelled after std::pmr::memory_resource which is
+* not available in C++14.
+*
+* Like the Deadline, a resource is installed for the current thread via a Scope (see DecodeHints::setMemoryResource).
+* The buffers remember the resource they were allocated from. Everything the library returns (Result, the writer's
+* BitMatrix outside of a Scope) does not use it, so a resource may be released as soon as the call returned.
+*/
+class MemoryResource
+{
+public:
+	virtual ~MemoryResource() = default;
+
+	void* allocate(std::size_t bytes, std::size_t alignment = alignof(std::max_align_t))
+	{
+		return doAllocate(bytes, alignment);
+	}
+	void deallocate(void* p, std::size_t bytes, std::size_t alignment = alignof(std::max_align_t)) noexcept
+	{
+		doDeallocate(p, bytes, alignment);
+	}
+
+	/// Returns the resource installed for the current thread or the one using operator new/delete
+	static MemoryResource* Current() noexcept;
+
+	/// The resource using the global operator new/delete, it is never destroyed so objects with static storage
+	/// duration can free their storage at exit
+	static MemoryResource* Default() noexcept;
+
+	/**
+	* Installs a resource for the current thread for the lifetime of the Scope object, nullptr installs Default().
+	* Scopes can be nested, the previous resource is restored on destruction.
+	*/
+	class Scope
+	{
+		MemoryResource* _previous;
+
+	public:
+		explicit Scope(MemoryResource* resource);
+		~Scope();
+
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+	};
+
+protected:
+	virtual void* doAllocate(std::size_t bytes, std::size_t alignment) = 0;
+	virtual void doDeallocate(void* p, std::size_t bytes, std::size_t alignment) noexcept = 0;
+};
+
+/**
+* Hands out memory from chunks of growing size and frees nothing before release() or its destruction, making the
+* teardown of all buffers of a request a single operation. It is safe to be used by the threads of one decode call
+* (see DecodeHints::rowScanThreads), a separate resource per concurrent call avoids contention.
+*/
+class MonotonicBufferResource : public MemoryResource
+{
+	struct Chunk
+	{
+		Chunk* next;
+		std::size_t size;
+	};
+
+	std::mutex _mutex;
+	Chunk* _chunks = nullptr;
+	char* _pos = nullptr;
+	std::size_t _available = 0;
+	std::size_t _nextSize;
+	std::size_t _allocated = 0;
+
+public:
+	explicit MonotonicBufferResource(std::size_t initialSize = 64 * 1024) : _nextSize(initialSize) {}
+	~MonotonicBufferResource() override { release(); }
+
+	MonotonicBufferResource(const MonotonicBufferResource&) = delete;
+	MonotonicBufferResource& operator=(const MonotonicBufferResource&) = delete;
+
+	/// Frees all memory at once, no buffer allocated from the resource may be used afterwards
+	void release() noexcept;
+
+	/// Total size of the chunks currently held
+	std::size_t allocatedBytes() const noexcept { return _allocated; }
+
+protected:
+	void* doAllocate(std::size_t bytes, std::size_t alignment) override;
+	void doDeallocate(void*, std::size_t, std::size_t) noexcept override {}
+};
+
+/**
+* Keeps blocks of at least minBlockSize bytes when they are deallocated and hands them out again for a request of the
+* same size, smaller ones are passed on to the upstream resource. Consecutive calls with images of the same size (e.g.
+* video frames) then do not allocate their image sized buffers anymore. When more than maxCachedBytes are kept, the
+* least recently returned blocks are freed. Thread safe.
+*/
+class RecyclingMemoryResource : public MemoryResource
+{
+	struct Block
+	{
+		void* p;
+		std::size_t bytes, alignment;
+	};
+
+	MemoryResource* _upstream;
+	std::size_t _minBlockSize, _maxCachedBytes;
+	std::mutex _mutex;
+	std::vector<Block> _cached; // least recently returned first
+	std::size_t _cachedBytes = 0;
+
+public:
+	explicit RecyclingMemoryResource(std::size_t minBlockSize = 1024, std::size_t maxCachedBytes = 64 * 1024 * 1024,
+									 MemoryResource* upstream = Default())
+		: _upstream(upstream), _minBlockSize(minBlockSize), _maxCachedBytes(maxCachedBytes)
+	{}
+	~RecyclingMemoryResource() override { release(); }
+
+	RecyclingMemoryResource(const RecyclingMemoryResource&) = delete;
+	RecyclingMemoryResource& operator=(const RecyclingMemoryResource&) = delete;
+
+	/// Frees the cached blocks, blocks in use are not affected
+	void release() noexcept;
+
+	/// Total size of the blocks kept for reuse
+	std::size_t cachedBytes() const noexcept { return _cachedBytes; }
+
+protected:
+	void* doAllocate(std::size_t bytes, std::size_t alignment) override;
+	void doDeallocate(void* p, std::size_t bytes, std::size_t alignment) noexcept override;
+};
+
+/**
+* Standard allocator using the MemoryResource installed for the current thread at construction. Containers carry it
+* along when moved and pick the current resource again when copied.
+*/
+template <typename T>
+class Allocator
+{
+	template <typename U> friend class Allocator;
+	MemoryResource* _resource;
+
+public:
+	using value_type = T;
+	using propagate_on_container_move_assignment = std::true_type;
+	using propagate_on_container_swap = std::true_type;
+
+	Allocator() noexcept : _resource(MemoryResource::Current()) {}
+	template <typename U>
+	Allocator(const Allocator<U>& other) noexcept : _resource(other._resource) {}
+
+	T* allocate(std::size_t n) { return static_cast<T*>(_resource->allocate(n * sizeof(T), alignof(T))); }
+	void deallocate(T* p, std::size_t n) noexcept { _resource->deallocate(p, n * sizeof(T), alignof(T)); }
+
+	Allocator select_on_container_copy_construction() const noexcept { return {}; }
+
+	MemoryResource* resource() const noexcept { return _resource; }
+
+	template <typename U>
+	bool operator==(const Allocator<U>& other) const noexcept { return _resource == other._resource; }
+	template <typename U>
+	bool operator!=(const Allocator<U>& other) const noexcept { return _resource != other._resource; }
+};
+
+/// A std::vector for temporary buffers, see MemoryResource
+template <typename T>
+using Vector = std::vector<T, Allocator<T>>;
+
+} // ZXing
@@ -19,22 +19,321 @@
 #include "DecodeHints.h"
 #include "BarcodeFormat.h"
 #include "Result.h"
+#include "BinaryBitmap.h"
+#include "BitArray.h"
+#include "BitMatrix.h"
+#include "Deadline.h"
+#include "DecodeStats.h"
+#include "MemoryResource.h"
+#include "Parallel.h"
+#include "Quadrilateral.h"
+#include "ZXContainerAlgorithms.h"
 
+#ifndef ZX_NO_FORMAT_ONED
 #include "oned/ODReader.h"
+#endif
+#ifndef ZX_NO_FORMAT_QRCODE
 #include "qrcode/QRReader.h"
+#endif
+#ifndef ZX_NO_FORMAT_DATAMATRIX
 #include "datamatrix/DMReader.h"
+#endif
+#ifndef ZX_NO_FORMAT_AZTEC
 #include "aztec/AZReader.h"
+#endif
+#ifndef ZX_NO_FORMAT_MAXICODE
 #include "maxicode/MCReader.h"
+#endif
+#ifndef ZX_NO_FORMAT_PDF417
 #include "pdf417/PDFReader.h"
+#endif
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <memory>
+#include <mutex>
+#include <numeric>
+#include <utility>
+#include <vector>
 
 namespace ZXing {
 
+namespace {
+
+/**
+* A BinaryBitmap that forwards to another one but hides (sets to white) the pixels in a list of
+* quadrilateral regions. It is used to find additional symbols in an image without having to
+* recompute the binarization.
+*/
+class MaskedBitmap : public BinaryBitmap
+{
+	std::shared_ptr<const BinaryBitmap> _image;
+	std::vector<QuadrilateralF> _masks;
+	mutable std::shared_ptr<const BitMatrix> _matrix;
+	mutable std::shared_ptr<const RunLengthIndex> _runs;
+
+	// Computes the range [x0, x1) of row y covered by the (convex) quadrilateral q.
+	static bool Span(const QuadrilateralF& q, int y, int width, int& x0, int& x1)
+	{
+		double yc = y + 0.5;
+		double lo = std::numeric_limits<double>::max();
+		double hi = std::numeric_limits<double>::lowest();
+		for (int i = 0; i < 4; ++i) {
+			auto a = q[i], b = q[(i + 1) % 4];
+			if (std::min(a.y, b.y) <= yc && yc <= std::max(a.y, b.y) && a.y != b.y) {
+				double x = a.x + (yc - a.y) * (b.x - a.x) / (b.y - a.y);
+				lo = std::min(lo, x);
+				hi = std::max(hi, x);
+			}
+		}
+		x0 = std::max(0, static_cast<int>(std::floor(lo)));
+		x1 = std::min(width, static_cast<int>(std::ceil(hi)) + 1);
+		return lo <= hi && x0 < x1;
+	}
+
+public:
+	explicit MaskedBitmap(std::shared_ptr<const BinaryBitmap> image, std::vector<QuadrilateralF> masks = {})
+		: _image(std::move(image)), _masks(std::move(masks))
+	{}
+
+	// The mean length of the runs of one color on the line from a to b, 1.5 to 2 modules if it crosses a symbol.
+	static double MeanRunLength(const BitMatrix& matrix, PointF a, PointF b)
+	{
+		int steps = static_cast<int>(distance(a, b));
+		if (steps == 0)
+			return 1;
+		int runs = 1;
+		bool last = false;
+		for (int i = 0; i <= steps; ++i) {
+			auto p = round(a + (double(i) / steps) * (b - a));
+			bool bit = matrix.get(std::max(0, std::min(p.x, matrix.width() - 1)),
+								  std::max(0, std::min(p.y, matrix.height() - 1)));
+			runs += i > 0 && bit != last;
+			last = bit;
+		}
+		return static_cast<double>(steps) / runs;
+	}
+
+	// The median distance from the black pixels on the line from a to b to the next white one in direction d, i.e.
+	// how far the bars of a 1D symbol extend beyond the scan line a-b.
+	static double BarExtent(const BitMatrix& matrix, PointF a, PointF b, PointF d)
+	{
+		auto isIn = [&](PointI p) { return p.x >= 0 && p.x < matrix.width() && p.y >= 0 && p.y < matrix.height(); };
+		std::vector<int> extents;
+		int steps = static_cast<int>(distance(a, b));
+		for (int i = 0; i <= steps; ++i) {
+			auto p = a + (steps ? double(i) / steps : 0.) * (b - a);
+			int extent = 0;
+			for (auto q = round(p); isIn(q) && matrix.get(q.x, q.y); q = round(p + extent * d))
+				++extent;
+			if (extent)
+				extents.push_back(extent);
+		}
+		if (extents.empty())
+			return 0;
+		std::nth_element(extents.begin(), extents.begin() + Size(extents) / 2, extents.end());
+		return extents[Size(extents) / 2];
+	}
+
+	void mask(const Position& pos)
+	{
+		// The reported position is not necessarily the outer boundary of the symbol: the QR code reports the
+		// centers of the finder patterns and a 1D symbol the scan lines it was decoded from, possibly a single one.
+		// So extend it to the ends of the bars and pad it by a few modules on all sides, along the axes of the symbol.
+		auto matrix = _image->getBitMatrix();
+		PointF tl(pos[0]), tr(pos[1]), br(pos[2]), bl(pos[3]);
+		PointF u = (tr + br) != (tl + bl) ? normalized(tr + br - tl - bl) : PointF(1, 0);
+		PointF v = {-u.y, u.x};
+		if ((bl + br - tl - tr) * v < 0)
+			v = -1 * v;
+		double padding = matrix ? 2 * MeanRunLength(*matrix, (tl + bl) / 2, (tr + br) / 2) : 1;
+		double top = padding + (matrix ? BarExtent(*matrix, tl, tr, -1 * v) : 0);
+		double bottom = padding + (matrix ? BarExtent(*matrix, bl, br, v) : 0);
+		QuadrilateralF q = {tl - padding * u - top * v, tr + padding * u - top * v, br + padding * u + bottom * v,
+							bl - padding * u + bottom * v};
+		_masks.push_back(q);
+		_matrix.reset();
+		_runs.reset();
+		resetBitMatrix();
+	}
+
+	int width() const override { return _image->width(); }
+	int height() const override { return _image->height(); }
+
+	bool getBlackRow(int y, BitArray& row) const override
+	{
+		if (!_image->getBlackRow(y, row))
+			return false;
+		int x0, x1;
+		for (const auto& m : _masks)
+			if (Span(m, y, row.size(), x0, x1))
+				for (int x = x0; x < x1; ++x)
+					row.unset(x);
+		return true;
+	}
+
+	bool getPatternRow(int y, PatternRow& res) const override
+	{
+		return _masks.empty() ? _image->getPatternRow(y, res) : BinaryBitmap::getPatternRow(y, res);
+	}
+
+	bool getSubPixelPatternRow(int y, PatternRow& res, SubPixelPatternRow& widths) const override
+	{
+		return _masks.empty() ? _image->getSubPixelPatternRow(y, res, widths)
+							  : BinaryBitmap::getSubPixelPatternRow(y, res, widths);
+	}
+
+	std::shared_ptr<const BitMatrix> getBlackMatrix() const override
+	{
+		if (_masks.empty())
+			return _image->getBlackMatrix();
+		if (!_matrix) {
+			auto src = _image->getBitMatrix();
+			if (!src)
+				return nullptr;
+			auto matrix = std::make_shared<BitMatrix>(src->copy());
+			int x0, x1;
+			for (const auto& m : _masks)
+				for (int y = 0; y < matrix->height(); ++y)
+					if (Span(m, y, matrix->width(), x0, x1))
+						for (int x = x0; x < x1; ++x)
+							matrix->unset(x, y);
+			_matrix = std::move(matrix);
+		}
+		return _matrix;
+	}
+
+	std::shared_ptr<const RunLengthIndex> getRunLengthIndex() const override
+	{
+		if (_masks.empty())
+			return _image->getRunLengthIndex();
+		if (!_runs) {
+			auto matrix = getBitMatrix();
+			if (!matrix)
+				return nullptr;
+			_runs = std::make_shared<const RunLengthIndex>(*matrix);
+		}
+		return _runs;
+	}
+
+	bool canRotate() const override { return _image->canRotate(); }
+
+	std::shared_ptr<BinaryBitmap> rotated(int degreeCW) const override
+	{
+		degreeCW = (degreeCW + 360) % 360;
+		const double w = width() - 1, h = height() - 1;
+		auto masks = _masks;
+		for (auto& m : masks)
+			for (auto& p : m)
+				switch (degreeCW) {
+				case 90: p = {h - p.y, p.x}; break;
+				case 180: p = {w - p.x, h - p.y}; break;
+				case 270: p = {p.y, w - p.x}; break;
+				}
+		return std::make_shared<MaskedBitmap>(_image->rotated(degreeCW), std::move(masks));
+	}
+};
+
+/**
+* A BinaryBitmap with black and white swapped, to find light symbols on a dark background. It is derived from the
+* binarization of another one without binarizing again: the matrix by flipping all its bits, the run lengths by
+* shifting their start color.
+*/
+class InvertedBitmap : public BinaryBitmap
+{
+	std::shared_ptr<const BinaryBitmap> _image;
+	mutable std::once_flag _matrixOnce, _runsOnce;
+	mutable std::shared_ptr<const BitMatrix> _matrix;
+	mutable std::shared_ptr<const RunLengthIndex> _runs;
+
+public:
+	explicit InvertedBitmap(std::shared_ptr<const BinaryBitmap> image) : _image(std::move(image)) {}
+
+	int width() const override { return _image->width(); }
+	int height() const override { return _image->height(); }
+
+	bool getBlackRow(int y, BitArray& row) const override
+	{
+		if (!_image->getBlackRow(y, row))
+			return false;
+		for (int x = 0; x < row.size(); ++x)
+			row.get(x) ? row.unset(x) : row.set(x);
+		return true;
+	}
+
+	bool getPatternRow(int y, PatternRow& res) const override
+	{
+		if (!_image->getPatternRow(y, res))
+			return false;
+		InvertPatternRow(res);
+		return true;
+	}
+
+	bool getSubPixelPatternRow(int y, PatternRow& res, SubPixelPatternRow& widths) const override
+	{
+		if (!_image->getSubPixelPatternRow(y, res, widths))
+			return false;
+		InvertPatternRow(res);
+		if (!widths.empty())
+			InvertPatternRow(widths);
+		return true;
+	}
+
+	std::shared_ptr<const BitMatrix> getBlackMatrix() const override
+	{
+		std::call_once(_matrixOnce, [this]() {
+			if (auto src = _image->getBitMatrix()) {
+				auto matrix = std::make_shared<BitMatrix>(src->copy());
+				matrix->flipAll();
+				_matrix = std::move(matrix);
+			}
+		});
+		return _matrix;
+	}
+
+	std::shared_ptr<const RunLengthIndex> getRunLengthIndex() const override
+	{
+		std::call_once(_runsOnce, [this]() {
+			if (auto runs = _image->getRunLengths())
+				_runs = std::make_shared<const RunLengthIndex>(runs->inverted());
+		});
+		return _runs;
+	}
+
+	bool canCrop() const override { return _image->canCrop(); }
+
+	std::shared_ptr<BinaryBitmap> cropped(int left, int top, int width, int height) const override
+	{
+		return std::make_shared<InvertedBitmap>(_image->cropped(left, top, width, height));
+	}
+
+	bool canRotate() const override { return _image->canRotate(); }
+
+	std::shared_ptr<BinaryBitmap> rotated(int degreeCW) const override
+	{
+		return std::make_shared<InvertedBitmap>(_image->rotated(degreeCW));
+	}
+};
+
+std::shared_ptr<const BinaryBitmap> Unowned(const BinaryBitmap& image)
+{
+	// aliasing an empty shared_ptr: no control block to allocate and no reference count to update
+	return std::shared_ptr<const BinaryBitmap>(std::shared_ptr<const BinaryBitmap>(), &image);
+}
+
+} // namespace
+
 MultiFormatReader::MultiFormatReader(const DecodeHints& hints)
+	: _tryParallel(hints.tryParallel()), _adaptiveOrder(hints.adaptiveReaderOrder()), _tryInvert(hints.tryInvert()),
+	  _timeout(hints.timeout()),
+	  _stats(hints.stats()), _memoryResource(hints.memoryResource())
 {
+#ifndef ZX_NO_FORMAT_ONED
 	bool tryHarder = hints.tryHarder();
+#endif
 	if (!hints.hasNoFormat()) {
+#ifndef ZX_NO_FORMAT_ONED
 		bool addOneDReader =
 			hints.hasFormat(BarcodeFormat::UPC_A) ||
 			hints.hasFormat(BarcodeFormat::UPC_E) ||
@@ -52,58 +351,260 @@ MultiFormatReader::MultiFormatReader(const DecodeHints& hints)
 		if (addOneDReader && !tryHarder) {
 			_readers.emplace_back(new OneD::Reader(hints));
 		}
+#endif
+#ifndef ZX_NO_FORMAT_QRCODE
 		if (hints.hasFormat(BarcodeFormat::QR_CODE)) {
 			_readers.emplace_back(new QRCode::Reader(hints));
 		}
+#endif
+#ifndef ZX_NO_FORMAT_DATAMATRIX
 		if (hints.hasFormat(BarcodeFormat::DATA_MATRIX)) {
 			_readers.emplace_back(new DataMatrix::Reader(hints));
 		}
+#endif
+#ifndef ZX_NO_FORMAT_AZTEC
 		if (hints.hasFormat(BarcodeFormat::AZTEC)) {
-			_readers.emplace_back(new Aztec::Reader());
+			_readers.emplace_back(new Aztec::Reader(hints));
 		}
+#endif
+#ifndef ZX_NO_FORMAT_PDF417
 		if (hints.hasFormat(BarcodeFormat::PDF_417)) {
-			_readers.emplace_back(new Pdf417::Reader());
+			_readers.emplace_back(new Pdf417::Reader(hints));
 		}
+#endif
+#ifndef ZX_NO_FORMAT_MAXICODE
 		if (hints.hasFormat(BarcodeFormat::MAXICODE)) {
 			_readers.emplace_back(new MaxiCode::Reader(hints));
 		}
+#endif
+#ifndef ZX_NO_FORMAT_ONED
 		// At end in "try harder" mode
 		if (addOneDReader && tryHarder) {
 			_readers.emplace_back(new OneD::Reader(hints));
 		}
+#endif
 	}
 
+	// all readers compiled in (see BUILD_FORMATS)
 	if (_readers.empty()) {
+#ifndef ZX_NO_FORMAT_ONED
 		if (!tryHarder) {
 			_readers.emplace_back(new OneD::Reader(hints));
 		}
+#endif
+#ifndef ZX_NO_FORMAT_QRCODE
 		_readers.emplace_back(new QRCode::Reader(hints));
+#endif
+#ifndef ZX_NO_FORMAT_DATAMATRIX
 		_readers.emplace_back(new DataMatrix::Reader(hints));
-		_readers.emplace_back(new Aztec::Reader());
-		_readers.emplace_back(new Pdf417::Reader());
+#endif
+#ifndef ZX_NO_FORMAT_AZTEC
+		_readers.emplace_back(new Aztec::Reader(hints));
+#endif
+#ifndef ZX_NO_FORMAT_PDF417
+		_readers.emplace_back(new Pdf417::Reader(hints));
+#endif
+#ifndef ZX_NO_FORMAT_MAXICODE
 		_readers.emplace_back(new MaxiCode::Reader(hints));
+#endif
+#ifndef ZX_NO_FORMAT_ONED
 		if (tryHarder) {
 			_readers.emplace_back(new OneD::Reader(hints));
 		}
+#endif
+	}
+
+	if (_adaptiveOrder) {
+		_scores.reset(new std::atomic<int>[_readers.size()]);
+		for (size_t i = 0; i < _readers.size(); ++i)
+			_scores[i] = 0;
 	}
 }
 
 MultiFormatReader::~MultiFormatReader() = default;
 
+static Result ReadParallel(const std::vector<std::unique_ptr<Reader>>& readers, const BinaryBitmap& image,
+						   const Deadline& deadline)
+{
+	// Make sure the lazily computed binary image is available before the readers start racing for it.
+	image.getBitMatrix();
+
+	// Every reader gets its own cancellation state, so a valid result can stop all readers of lower priority.
+	std::vector<Deadline> deadlines;
+	deadlines.reserve(readers.size());
+	for (size_t i = 0; i < readers.size(); ++i)
+		deadlines.push_back(Deadline::Cancellable(deadline.timePoint()));
+
+	std::vector<Result> results(readers.size(), Result(DecodeStatus::NotFound));
+	auto stats = DecodeStats::Current();
+	auto memoryResource = MemoryResource::Current();
+	ParallelFor(Size(readers), [&](int i) {
+		Deadline::Scope scope(deadlines[i]);
+		DecodeStats::Scope statsScope(stats);
+		MemoryResource::Scope memoryScope(memoryResource);
+		results[i] = readers[i]->decode(image);
+		if (results[i].isValid())
+			for (size_t j = i + 1; j < deadlines.size(); ++j)
+				deadlines[j].cancel();
+	});
+
+	// Evaluate in priority order, so the result does not depend on which reader happens to finish first.
+	for (auto& r : results)
+		if (r.isValid())
+			return std::move(r);
+	return Result(DecodeStatus::NotFound);
+}
+
+// Without a timeout of its own, a read is limited by the deadline of the caller (e.g. the retry cascade of the
+// BarcodeScanner), if any.
+static Deadline ReadDeadline(std::chrono::milliseconds timeout)
+{
+	if (timeout.count() > 0)
+		return Deadline(timeout);
+	return Deadline::Current() ? *Deadline::Current() : Deadline();
+}
+
+static Result CheckTimeout(Result&& result, const Deadline& deadline)
+{
+	if (result.status() == DecodeStatus::NotFound && deadline.hasExpired())
+		return Result(DecodeStatus::Timeout);
+	return std::move(result);
+}
+
 Result
 MultiFormatReader::read(const BinaryBitmap& image) const
+{
+	Deadline deadline = ReadDeadline(_timeout);
+	Deadline::Scope scope(deadline);
+	DecodeStats::Scope statsScope(_stats ? _stats : DecodeStats::Current());
+	MemoryResource::Scope memoryScope(_memoryResource ? _memoryResource : MemoryResource::Current());
+
+	Result result = readImage(image, deadline);
+	if (_tryInvert && !result.isValid() && !deadline.hasExpired()) {
+		Result inverted = readImage(InvertedBitmap(Unowned(image)), deadline);
+		// keep e.g. a ChecksumError of the first pass unless the second one found something
+		if (inverted.isValid() || inverted.status() == DecodeStatus::Timeout) {
+			inverted.setIsInverted(inverted.isValid());
+			return inverted;
+		}
+	}
+	return result;
+}
+
+Result
+MultiFormatReader::readImage(const BinaryBitmap& image, const Deadline& deadline) const
 {
 	// If we have only one reader in our list, just return whatever that decoded.
 	// This preserves information (e.g. ChecksumError) instead of just returning 'NotFound'.
 	if (_readers.size() == 1)
-		return _readers.front()->decode(image);
+		return CheckTimeout(_readers.front()->decode(image), deadline);
+
+	if (_tryParallel)
+		return CheckTimeout(ReadParallel(_readers, image, deadline), deadline);
+
+	if (_adaptiveOrder)
+		return CheckTimeout(readAdaptive(image, deadline), deadline);
 
 	for (const auto& reader : _readers) {
+		if (deadline.hasExpired())
+			return Result(DecodeStatus::Timeout);
 		Result r = reader->decode(image);
   		if (r.isValid())
 			return r;
 	}
-	return Result(DecodeStatus::NotFound);
+	return CheckTimeout(Result(DecodeStatus::NotFound), deadline);
+}
+
+Result
+MultiFormatReader::readAdaptive(const BinaryBitmap& image, const Deadline& deadline) const
+{
+	// Each score is a moving average of how often its reader found the symbol, in units of 1/4096 (decay 1/16 per
+	// image). The scores are shared by all threads using this reader and updated without synchronization of the
+	// whole set, a lost update only costs a suboptimal order.
+	constexpr int HIT = 1 << 12;
+	constexpr int DECAY_SHIFT = 4;
+
+	std::vector<int> order(_readers.size());
+	std::iota(order.begin(), order.end(), 0);
+	// stable, so the fixed format priority decides between readers that did equally well
+	std::stable_sort(order.begin(), order.end(), [this](int a, int b) {
+		return _scores[a].load(std::memory_order_relaxed) > _scores[b].load(std::memory_order_relaxed);
+	});
+
+	Result result(DecodeStatus::NotFound);
+	int hit = -1;
+	for (int i : order) {
+		if (deadline.hasExpired())
+			return Result(DecodeStatus::Timeout);
+		result = _readers[i]->decode(image);
+		if (result.isValid()) {
+			hit = i;
+			break;
+		}
+	}
+
+	// Images without any symbol say nothing about the formats to expect, so they leave the scores alone.
+	if (hit >= 0)
+		for (int i = 0; i < Size(_readers); ++i) {
+			int score = _scores[i].load(std::memory_order_relaxed);
+			_scores[i].store(score - (score >> DECAY_SHIFT) + (i == hit ? HIT >> DECAY_SHIFT : 0),
+							 std::memory_order_relaxed);
+		}
+
+	return result;
+}
+
+// Two results are considered to describe the same symbol if they share format and content and overlap in the image.
+static bool IsDuplicate(const Results& results, const Result& r)
+{
+	return std::any_of(results.begin(), results.end(), [&r](const Result& o) {
+		return o.format() == r.format() && o.text() == r.text() &&
+			   (IsInside(o.position(), Center(r.position())) || IsInside(r.position(), Center(o.position())));
+	});
+}
+
+// Adds the symbols found in the masked image to the results, masking each one out before the next attempt.
+static void ReadMultiple(const std::vector<std::unique_ptr<Reader>>& readers, MaskedBitmap& masked, int maxSymbols,
+						 const Deadline& deadline, Results& results)
+{
+	for (const auto& reader : readers) {
+		// Repeat with the same reader as long as it finds new symbols, since most readers return only one per call.
+		bool foundNew = true;
+		while (foundNew && Size(results) < maxSymbols && !deadline.hasExpired()) {
+			foundNew = false;
+			for (auto& r : reader->decode(masked, maxSymbols - Size(results))) {
+				if (IsDuplicate(results, r))
+					continue;
+				masked.mask(r.position());
+				results.push_back(std::move(r));
+				foundNew = true;
+			}
+		}
+	}
+}
+
+Results
+MultiFormatReader::readMultiple(const BinaryBitmap& image, int maxSymbols) const
+{
+	Deadline deadline = ReadDeadline(_timeout);
+	Deadline::Scope scope(deadline);
+	DecodeStats::Scope statsScope(_stats ? _stats : DecodeStats::Current());
+	MemoryResource::Scope memoryScope(_memoryResource ? _memoryResource : MemoryResource::Current());
+
+	Results results;
+	MaskedBitmap masked(Unowned(image));
+	ReadMultiple(_readers, masked, maxSymbols, deadline, results);
+
+	if (_tryInvert && Size(results) < maxSymbols && !deadline.hasExpired()) {
+		MaskedBitmap inverted(std::make_shared<InvertedBitmap>(Unowned(image)));
+		for (const auto& r : results)
+			inverted.mask(r.position());
+		int found = Size(results);
+		ReadMultiple(_readers, inverted, maxSymbols, deadline, results);
+		for (int i = found; i < Size(results); ++i)
+			results[i].setIsInverted(true);
+	}
+	return results;
 }
 
 } // ZXing
@@ -16,6 +16,8 @@
 * limitations under the License.
 */
 
+#include <atomic>
+#include <chrono>
 #include <vector>
 #include <memory>
 
@@ -25,6 +27,9 @@ class Result;
 class Reader;
 class BinaryBitmap;
 class DecodeHints;
+class Deadline;
+class DecodeStats;
+class MemoryResource;
 
 /**
 * MultiFormatReader is a convenience class and the main entry point into the library for most uses.
@@ -42,8 +47,26 @@ public:
 
 	Result read(const BinaryBitmap& image) const;
 
+	/**
+	* Decode all symbols in the image, at most maxSymbols. Every reader is run over the same image. Regions of
+	* already decoded symbols are masked out before the next attempt, so the binarization is done only once.
+	*/
+	std::vector<Result> readMultiple(const BinaryBitmap& image, int maxSymbols = 0xFF) const;
+
 private:
+	Result readImage(const BinaryBitmap& image, const Deadline& deadline) const;
+	Result readAdaptive(const BinaryBitmap& image, const Deadline& deadline) const;
+
 	std::vector<std::unique_ptr<Reader>> _readers;
+	// recent success of each reader for the adaptiveReaderOrder, an exponential moving average
+	std::unique_ptr<std::atomic<int>[]> _scores;
+	bool _tryParallel = false;
+	bool _adaptiveOrder = false;
+	bool _tryInvert = false;
+	std::chrono::milliseconds _timeout = {};
+	// nullptr: the stats installed by the caller (e.g. BarcodeScanner) if any
+	DecodeStats* _stats = nullptr;
+	MemoryResource* _memoryResource = nullptr;
 };
 
 } // ZXing
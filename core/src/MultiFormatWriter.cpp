@@ -16,22 +16,46 @@
 
 #include "MultiFormatWriter.h"
 #include "BitMatrix.h"
+#include "Parallel.h"
+#ifndef ZX_NO_FORMAT_AZTEC
 #include "aztec/AZWriter.h"
+#endif
+#ifndef ZX_NO_FORMAT_DATAMATRIX
 #include "datamatrix/DMWriter.h"
+#endif
+#ifndef ZX_NO_FORMAT_PDF417
 #include "pdf417/PDFWriter.h"
+#endif
+#ifndef ZX_NO_FORMAT_QRCODE
 #include "qrcode/QRWriter.h"
 #include "qrcode/QRErrorCorrectionLevel.h"
+#endif
+#ifndef ZX_NO_FORMAT_CODABAR
 #include "oned/ODCodabarWriter.h"
+#endif
+#ifndef ZX_NO_FORMAT_CODE39
 #include "oned/ODCode39Writer.h"
+#endif
+#ifndef ZX_NO_FORMAT_CODE93
 #include "oned/ODCode93Writer.h"
+#endif
+#ifndef ZX_NO_FORMAT_CODE128
 #include "oned/ODCode128Writer.h"
+#endif
+#ifndef ZX_NO_FORMAT_ITF
+#include "oned/ODITFWriter.h"
+#endif
+#ifndef ZX_NO_FORMAT_UPCEAN
 #include "oned/ODEAN8Writer.h"
 #include "oned/ODEAN13Writer.h"
-#include "oned/ODITFWriter.h"
 #include "oned/ODUPCAWriter.h"
 #include "oned/ODUPCEWriter.h"
+#endif
 
+#include <algorithm>
+#include <atomic>
 #include <stdexcept>
+#include <thread>
 
 namespace ZXing {
 
@@ -44,12 +68,6 @@ MultiFormatWriter::encode(const std::wstring& contents, int width, int height) c
 		return writer.encode(contents, width, height);
 	};
 
-	auto AztecEccLevel = [&](Aztec::Writer& writer, int eccLevel) { writer.setEccPercent(eccLevel * 100 / 8); };
-	auto Pdf417EccLevel = [&](Pdf417::Writer& writer, int eccLevel) { writer.setErrorCorrectionLevel(eccLevel); };
-	auto QRCodeEccLevel = [&](QRCode::Writer& writer, int eccLevel) {
-		writer.setErrorCorrectionLevel(static_cast<QRCode::ErrorCorrectionLevel>(--eccLevel / 2));
-	};
-
 	auto exec1 = [&](auto&& writer, auto setEccLevel) {
 		if (_encoding != CharacterSet::Unknown)
 			writer.setEncoding(_encoding);
@@ -58,22 +76,83 @@ MultiFormatWriter::encode(const std::wstring& contents, int width, int height) c
 		return exec0(std::move(writer));
 	};
 
+	// formats left out at build time (see BUILD_FORMATS) end up in the default branch
 	switch (_format) {
-	case BarcodeFormat::AZTEC: return exec1(Aztec::Writer(), AztecEccLevel);
+#ifndef ZX_NO_FORMAT_AZTEC
+	case BarcodeFormat::AZTEC:
+		return exec1(Aztec::Writer(),
+					 [](Aztec::Writer& writer, int eccLevel) { writer.setEccPercent(eccLevel * 100 / 8); });
+#endif
+#ifndef ZX_NO_FORMAT_DATAMATRIX
 	case BarcodeFormat::DATA_MATRIX: return exec0(DataMatrix::Writer());
-	case BarcodeFormat::PDF_417: return exec1(Pdf417::Writer(), Pdf417EccLevel);
-	case BarcodeFormat::QR_CODE: return exec1(QRCode::Writer(), QRCodeEccLevel);
+#endif
+#ifndef ZX_NO_FORMAT_PDF417
+	case BarcodeFormat::PDF_417:
+		return exec1(Pdf417::Writer(),
+					 [](Pdf417::Writer& writer, int eccLevel) { writer.setErrorCorrectionLevel(eccLevel); });
+#endif
+#ifndef ZX_NO_FORMAT_QRCODE
+	case BarcodeFormat::QR_CODE:
+		return exec1(QRCode::Writer(), [](QRCode::Writer& writer, int eccLevel) {
+			writer.setErrorCorrectionLevel(static_cast<QRCode::ErrorCorrectionLevel>(--eccLevel / 2));
+		});
+#endif
+#ifndef ZX_NO_FORMAT_CODABAR
 	case BarcodeFormat::CODABAR: return exec0(OneD::CodabarWriter());
+#endif
+#ifndef ZX_NO_FORMAT_CODE39
 	case BarcodeFormat::CODE_39: return exec0(OneD::Code39Writer());
+#endif
+#ifndef ZX_NO_FORMAT_CODE93
 	case BarcodeFormat::CODE_93: return exec0(OneD::Code93Writer());
+#endif
+#ifndef ZX_NO_FORMAT_CODE128
 	case BarcodeFormat::CODE_128: return exec0(OneD::Code128Writer());
+#endif
+#ifndef ZX_NO_FORMAT_UPCEAN
 	case BarcodeFormat::EAN_8: return exec0(OneD::EAN8Writer());
 	case BarcodeFormat::EAN_13: return exec0(OneD::EAN13Writer());
+#endif
+#ifndef ZX_NO_FORMAT_ITF
 	case BarcodeFormat::ITF: return exec0(OneD::ITFWriter());
+#endif
+#ifndef ZX_NO_FORMAT_UPCEAN
 	case BarcodeFormat::UPC_A: return exec0(OneD::UPCAWriter());
 	case BarcodeFormat::UPC_E: return exec0(OneD::UPCEWriter());
+#endif
 	default: throw std::invalid_argument(std::string("Unsupported format: ") + ToString(_format));
 	}
 }
 
+void
+MultiFormatWriter::render(const std::wstring& contents, uint8_t* buffer, int width, int height, RasterFormat format,
+						  int rowStride) const
+{
+	InflateInto(encode(contents), buffer, width, height, format, rowStride);
+}
+
+void
+MultiFormatWriter::encodeBatch(const std::vector<std::wstring>& contents, int width, int height,
+							   const std::function<void(int, BitMatrix&&)>& onResult, int numThreads) const
+{
+	if (numThreads <= 0)
+		numThreads = std::max(1u, std::thread::hardware_concurrency());
+	numThreads = std::min(numThreads, static_cast<int>(contents.size()));
+
+	// the tasks take the next content from a shared counter, so that a slow one does not hold up a whole shard
+	std::atomic<int> next(0);
+	ParallelFor(numThreads, [&](int) {
+		for (int i = next++; i < static_cast<int>(contents.size()); i = next++) {
+			BitMatrix matrix;
+			try {
+				matrix = encode(contents[i], width, height);
+			}
+			catch (const std::exception&) {
+				// reported as an empty matrix
+			}
+			onResult(i, std::move(matrix));
+		}
+	});
+}
+
 } // ZXing
@@ -17,11 +17,15 @@
 #include "BarcodeFormat.h"
 #include "CharacterSet.h"
 
+#include <cstdint>
+#include <functional>
 #include <string>
+#include <vector>
 
 namespace ZXing {
 
 class BitMatrix;
+enum class RasterFormat;
 
 /**
 * This class is here just for convenience as it offers single-point service
@@ -58,7 +62,31 @@ public:
 		return *this;
 	}
 
-	BitMatrix encode(const std::wstring& contents, int width, int height) const;
+	/**
+	* Encodes contents and scales the symbol up to at least width x height pixels (see Inflate). With the default
+	* size of 0 x 0 the result is the unscaled symbol including its quiet zone, one bit per module (PDF417 rows are 4
+	* bits high), e.g. as input for ForEachRectangle or ToSVG.
+	*/
+	BitMatrix encode(const std::wstring& contents, int width = 0, int height = 0) const;
+
+	/**
+	* Draws the barcode straight into a caller provided raster (see InflateInto), without creating a full size
+	* BitMatrix first. The symbol including its quiet zone is scaled up by the largest integer factor that fits, so
+	* unlike with encode() the quiet zone grows with the module size.
+	* @throw std::invalid_argument if the symbol does not fit into width x height
+	*/
+	void render(const std::wstring& contents, uint8_t* buffer, int width, int height, RasterFormat format,
+				int rowStride = 0) const;
+
+	/**
+	* Encodes all contents like encode() with work shared by numThreads tasks on the executor of ParallelFor (see
+	* SetParallelExecutor), 0 meaning one per hardware thread. Each result is passed to onResult(index, matrix) as
+	* soon as it is done, on the thread that encoded it and in no particular order. Contents that can not be encoded
+	* yield an empty BitMatrix instead of aborting the batch. The encoder tables (e.g. the Reed-Solomon generators) are
+	* process wide and shared by all tasks.
+	*/
+	void encodeBatch(const std::vector<std::wstring>& contents, int width, int height,
+					 const std::function<void(int, BitMatrix&&)>& onResult, int numThreads = 0) const;
 
 private:
 	BarcodeFormat _format;
@@ -0,0 +1,465 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "OpenCLBinarizer.h"
+#include "BitMatrix.h"
+#include "ByteArray.h"
+#include "DecodeStats.h"
+#include "HybridBinarizer.h"
+#include "LuminanceSource.h"
+#include "Trace.h"
+
+#ifndef CL_TARGET_OPENCL_VERSION
+#define CL_TARGET_OPENCL_VERSION 120
+#endif
+#ifdef __APPLE__
+#include <OpenCL/cl.h>
+#else
+#include <CL/cl.h>
+#endif
+
+#include <algorithm>
+#include <cstdlib>
+#include <initializer_list>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ZXing {
+
+// see HybridBinarizer.cpp
+static const int BLOCK_SIZE = 8;
+static const int MINIMUM_DIMENSION = BLOCK_SIZE * 5;
+
+/**
+* The kernels of the HybridBinarizer steps, each one computes exactly what the CPU version does. Only the last one
+* depends on the BitMatrix storage: PACKED_BITS is defined for the packed (one bit per pixel) storage.
+*/
+static const char* KERNEL_SOURCE = R"(
+#define BLOCK_SIZE 8
+#define MIN_DYNAMIC_RANGE 24
+
+// the same integer weights as GenericLuminanceSource, which makes the gray formats (r = g = b = 0) an exact copy
+__kernel void luminance(__global const uchar* src, ulong offset, int rowStride, int pixStride, int r, int g, int b,
+						__global uchar* dst)
+{
+	int x = get_global_id(0), y = get_global_id(1), width = get_global_size(0);
+	__global const uchar* p = src + offset + (long)y * rowStride + x * pixStride;
+	dst[y * width + x] = (uchar)((306 * p[r] + 601 * p[g] + 117 * p[b] + 0x200) >> 10);
+}
+
+// sum (16 bit), min and max (8 bit each) of block (x, y), the last block row/column overlaps the one before it
+__kernel void blockStats(__global const uchar* lum, int width, int height, __global uint* stats)
+{
+	int x = get_global_id(0), y = get_global_id(1);
+	int xoffset = min(x * BLOCK_SIZE, width - BLOCK_SIZE), yoffset = min(y * BLOCK_SIZE, height - BLOCK_SIZE);
+	uint sum = 0, lo = 0xFF, hi = 0;
+	for (int yy = 0; yy < BLOCK_SIZE; ++yy) {
+		__global const uchar* p = lum + (yoffset + yy) * width + xoffset;
+		for (int xx = 0; xx < BLOCK_SIZE; ++xx) {
+			uint v = p[xx];
+			sum += v;
+			lo = min(lo, v);
+			hi = max(hi, v);
+		}
+	}
+	stats[y * get_global_size(0) + x] = sum | (lo << 16) | (hi << 24);
+}
+
+// The black point of a low contrast block depends on the ones above and to the left of it. A single work group walks
+// the anti-diagonals of the block grid, the blocks of one anti-diagonal only depend on the two before it.
+__kernel void blackPoints(__global const uint* stats, int subWidth, int subHeight, __global int* blackPoints)
+{
+	int step = get_local_size(0);
+	for (int d = 0; d < subWidth + subHeight - 1; ++d) {
+		for (int y = max(0, d - subWidth + 1) + (int)get_local_id(0); y <= min(d, subHeight - 1); y += step) {
+			int x = d - y;
+			uint s = stats[y * subWidth + x];
+			int lo = (s >> 16) & 0xFF, hi = s >> 24;
+			int average = (s & 0xFFFF) / (BLOCK_SIZE * BLOCK_SIZE);
+			if (hi - lo <= MIN_DYNAMIC_RANGE) {
+				average = lo / 2;
+				if (y > 0 && x > 0) {
+					int neighbors = (blackPoints[(y - 1) * subWidth + x] + 2 * blackPoints[y * subWidth + x - 1] +
+									 blackPoints[(y - 1) * subWidth + x - 1]) / 4;
+					if (lo < neighbors)
+						average = neighbors;
+				}
+			}
+			blackPoints[y * subWidth + x] = average;
+		}
+		barrier(CLK_GLOBAL_MEM_FENCE);
+	}
+}
+
+// the average of the 5x5 black points around block (x, y)
+__kernel void thresholds(__global const int* blackPoints, int subWidth, int subHeight, __global int* thresholds)
+{
+	int x = get_global_id(0), y = get_global_id(1);
+	int left = clamp(x, 2, subWidth - 3), top = clamp(y, 2, subHeight - 3);
+	int sum = 0;
+	for (int dy = -2; dy <= 2; ++dy)
+		for (int dx = -2; dx <= 2; ++dx)
+			sum += blackPoints[(top + dy) * subWidth + left + dx];
+	thresholds[y * subWidth + x] = sum / 25;
+}
+
+// HybridBinarizer or's the blocks into the matrix, so a pixel in the overlap of the last block column (row) with the
+// one before is black if it is below either threshold, i.e. below the larger one
+int pixelThreshold(__global const int* thresholds, int x, int y, int width, int height, int subWidth, int subHeight)
+{
+	int x0 = min(x / BLOCK_SIZE, subWidth - 1), x1 = x >= width - BLOCK_SIZE ? subWidth - 1 : x0;
+	int y0 = min(y / BLOCK_SIZE, subHeight - 1), y1 = y >= height - BLOCK_SIZE ? subHeight - 1 : y0;
+	return max(max(thresholds[y0 * subWidth + x0], thresholds[y0 * subWidth + x1]),
+			   max(thresholds[y1 * subWidth + x0], thresholds[y1 * subWidth + x1]));
+}
+
+#ifdef PACKED_BITS
+// one work item per 32 bit word of the matrix
+__kernel void binarize(__global const uchar* lum, int width, int height, __global const int* thresholds, int subWidth,
+					   int subHeight, __global uint* bits)
+{
+	int word = get_global_id(0), y = get_global_id(1);
+	uint v = 0;
+	for (int i = 0, x = word * 32; i < 32 && x < width; ++i, ++x)
+		if (lum[y * width + x] <= pixelThreshold(thresholds, x, y, width, height, subWidth, subHeight))
+			v |= 1u << i;
+	bits[y * get_global_size(0) + word] = v;
+}
+#else
+// one work item per pixel, the matrix has one byte per pixel
+__kernel void binarize(__global const uchar* lum, int width, int height, __global const int* thresholds, int subWidth,
+					   int subHeight, __global uchar* bits)
+{
+	int x = get_global_id(0), y = get_global_id(1);
+	bits[y * width + x] = lum[y * width + x] <= pixelThreshold(thresholds, x, y, width, height, subWidth, subHeight);
+}
+#endif
+)";
+
+static void Check(cl_int err, const char* what)
+{
+	if (err != CL_SUCCESS)
+		throw std::runtime_error(std::string(what) + " failed with OpenCL error " + std::to_string(err));
+}
+
+struct Release
+{
+	void operator()(cl_context c) const { clReleaseContext(c); }
+	void operator()(cl_command_queue q) const { clReleaseCommandQueue(q); }
+	void operator()(cl_program p) const { clReleaseProgram(p); }
+	void operator()(cl_kernel k) const { clReleaseKernel(k); }
+	void operator()(cl_mem m) const { clReleaseMemObject(m); }
+};
+
+template <typename T>
+using Handle = std::unique_ptr<std::remove_pointer_t<T>, Release>;
+
+/// Sets the arguments of 'kernel' in order, the cl_mem ones have to be passed as such (not as Handle)
+template <typename... Args>
+static void SetArgs(cl_kernel kernel, const Args&... args)
+{
+	cl_uint i = 0;
+	int unused[] = {0, (Check(clSetKernelArg(kernel, i++, sizeof(args), &args), "clSetKernelArg"), 0)...};
+	(void)unused;
+}
+
+static void Run(cl_command_queue queue, cl_kernel kernel, size_t width, size_t height)
+{
+	const size_t global[] = {width, height};
+	Check(clEnqueueNDRangeKernel(queue, kernel, 2, nullptr, global, nullptr, 0, nullptr, nullptr),
+		  "clEnqueueNDRangeKernel");
+}
+
+struct OpenCLContext::Impl
+{
+	Handle<cl_context> context;
+	Handle<cl_command_queue> queue;
+	Handle<cl_program> program;
+	Handle<cl_kernel> luminance, blockStats, blackPoints, thresholds, binarize;
+	size_t blackPointsGroupSize = 1;
+	std::mutex mutex; // kernel arguments are shared state
+
+	Impl(cl_context ctx, cl_command_queue q, cl_device_id device) : context(ctx), queue(q)
+	{
+		cl_int err;
+		program.reset(clCreateProgramWithSource(ctx, 1, &KERNEL_SOURCE, nullptr, &err));
+		Check(err, "clCreateProgramWithSource");
+#ifdef ZX_FAST_BIT_STORAGE
+		const char* options = "";
+#else
+		const char* options = "-DPACKED_BITS";
+#endif
+		if (clBuildProgram(program.get(), 1, &device, options, nullptr, nullptr) != CL_SUCCESS) {
+			size_t size = 0;
+			clGetProgramBuildInfo(program.get(), device, CL_PROGRAM_BUILD_LOG, 0, nullptr, &size);
+			std::string log(size, '\0');
+			clGetProgramBuildInfo(program.get(), device, CL_PROGRAM_BUILD_LOG, size, &log[0], nullptr);
+			throw std::runtime_error("Building the OpenCLBinarizer kernels failed: " + log);
+		}
+
+		auto kernel = [&](const char* name) {
+			Handle<cl_kernel> res(clCreateKernel(program.get(), name, &err));
+			Check(err, "clCreateKernel");
+			return res;
+		};
+		luminance = kernel("luminance");
+		blockStats = kernel("blockStats");
+		blackPoints = kernel("blackPoints");
+		thresholds = kernel("thresholds");
+		binarize = kernel("binarize");
+
+		Check(clGetKernelWorkGroupInfo(blackPoints.get(), device, CL_KERNEL_WORK_GROUP_SIZE, sizeof(size_t),
+									   &blackPointsGroupSize, nullptr),
+			  "clGetKernelWorkGroupInfo");
+		blackPointsGroupSize = std::min<size_t>(blackPointsGroupSize, 256);
+	}
+
+	Handle<cl_mem> buffer(size_t size, cl_mem_flags flags = CL_MEM_READ_WRITE, const void* data = nullptr)
+	{
+		cl_int err;
+		Handle<cl_mem> res(clCreateBuffer(context.get(), flags, size, const_cast<void*>(data), &err));
+		Check(err, "clCreateBuffer");
+		return res;
+	}
+};
+
+static cl_device_id DefaultDevice(cl_platform_id& platform)
+{
+	cl_uint count = 0;
+	Check(clGetPlatformIDs(0, nullptr, &count), "clGetPlatformIDs");
+	std::vector<cl_platform_id> platforms(count);
+	Check(clGetPlatformIDs(count, platforms.data(), nullptr), "clGetPlatformIDs");
+	for (cl_device_type type : std::initializer_list<cl_device_type>{CL_DEVICE_TYPE_GPU, CL_DEVICE_TYPE_ALL})
+		for (auto p : platforms) {
+			cl_device_id device;
+			if (clGetDeviceIDs(p, type, 1, &device, nullptr) == CL_SUCCESS) {
+				platform = p;
+				return device;
+			}
+		}
+	throw std::runtime_error("No OpenCL device found");
+}
+
+static std::unique_ptr<OpenCLContext::Impl> CreateImpl()
+{
+	cl_platform_id platform;
+	cl_device_id device = DefaultDevice(platform);
+	const cl_context_properties properties[] = {CL_CONTEXT_PLATFORM, reinterpret_cast<cl_context_properties>(platform),
+												0};
+	cl_int err;
+	Handle<cl_context> context(clCreateContext(properties, 1, &device, nullptr, nullptr, &err));
+	Check(err, "clCreateContext");
+	Handle<cl_command_queue> queue(clCreateCommandQueue(context.get(), device, 0, &err));
+	Check(err, "clCreateCommandQueue");
+	return std::make_unique<OpenCLContext::Impl>(context.release(), queue.release(), device);
+}
+
+OpenCLContext::OpenCLContext() : _impl(CreateImpl()) {}
+
+static std::unique_ptr<OpenCLContext::Impl> CreateImpl(cl_command_queue queue)
+{
+	cl_context context;
+	cl_device_id device;
+	Check(clGetCommandQueueInfo(queue, CL_QUEUE_CONTEXT, sizeof(context), &context, nullptr), "clGetCommandQueueInfo");
+	Check(clGetCommandQueueInfo(queue, CL_QUEUE_DEVICE, sizeof(device), &device, nullptr), "clGetCommandQueueInfo");
+	Check(clRetainContext(context), "clRetainContext");
+	Check(clRetainCommandQueue(queue), "clRetainCommandQueue");
+	return std::make_unique<OpenCLContext::Impl>(context, queue, device);
+}
+
+OpenCLContext::OpenCLContext(cl_command_queue queue) : _impl(CreateImpl(queue)) {}
+
+OpenCLContext::~OpenCLContext() = default;
+
+cl_command_queue OpenCLContext::queue() const
+{
+	return _impl->queue.get();
+}
+
+/**
+* The luminance of an image in device memory, computed in the constructor. It is copied to the host on first use, so
+* only the 1D readers pay for that.
+*/
+class OpenCLLuminanceSource : public LuminanceSource
+{
+	std::shared_ptr<OpenCLContext> _context;
+	Handle<cl_mem> _luminances; // width x height, without padding
+	int _width, _height;
+	mutable std::once_flag _once;
+	mutable ByteArray _host;
+
+	const uint8_t* host() const
+	{
+		std::call_once(_once, [this]() {
+			auto& cl = *_context->_impl;
+			_host.resize(_width * _height);
+			std::lock_guard<std::mutex> lock(cl.mutex);
+			Check(clEnqueueReadBuffer(cl.queue.get(), _luminances.get(), CL_TRUE, 0, _host.size(), _host.data(), 0,
+									  nullptr, nullptr),
+				  "clEnqueueReadBuffer");
+		});
+		return _host.data();
+	}
+
+public:
+	OpenCLLuminanceSource(std::shared_ptr<OpenCLContext> context, cl_mem image, size_t offset, int width, int height,
+						  int rowStride, ImageFormat format)
+		: _context(std::move(context)), _width(width), _height(height)
+	{
+		if (IsRawFormat(format) || format == ImageFormat::None)
+			throw std::invalid_argument("OpenCLBinarizer does not support this image format");
+
+		auto& cl = *_context->_impl;
+		_luminances = cl.buffer(width * height);
+		std::lock_guard<std::mutex> lock(cl.mutex);
+		SetArgs(cl.luminance.get(), image, static_cast<cl_ulong>(offset), rowStride, PixStride(format),
+				RedIndex(format), GreenIndex(format), BlueIndex(format), _luminances.get());
+		Run(cl.queue.get(), cl.luminance.get(), width, height);
+	}
+
+	static std::shared_ptr<const LuminanceSource> Upload(std::shared_ptr<OpenCLContext> context, const ImageView& iv)
+	{
+		// the rows may be stored bottom up (negative rowStride), upload from the lowest address
+		const uint8_t* first = iv.data(0, 0);
+		const uint8_t* begin = std::min(first, iv.data(0, iv.height() - 1));
+		size_t size = std::abs(iv.rowStride()) * (iv.height() - 1) + iv.width() * PixStride(iv.format());
+		auto image = context->_impl->buffer(size, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, begin);
+		// releasing 'image' below is fine, OpenCL keeps it alive until the luminance kernel is done
+		return std::make_shared<OpenCLLuminanceSource>(std::move(context), image.get(), first - begin, iv.width(),
+													   iv.height(), iv.rowStride(), iv.format());
+	}
+
+	int width() const override { return _width; }
+	int height() const override { return _height; }
+
+	const uint8_t* getRow(int y, ByteArray& buffer, bool forceCopy) const override
+	{
+		if (y < 0 || y >= _height)
+			throw std::out_of_range("Requested row is outside the image");
+
+		const uint8_t* row = host() + y * _width;
+		if (!forceCopy)
+			return row;
+
+		buffer.assign(row, row + _width);
+		return buffer.data();
+	}
+
+	const uint8_t* getMatrix(ByteArray& buffer, int& outRowBytes, bool forceCopy) const override
+	{
+		outRowBytes = _width;
+		if (!forceCopy)
+			return host();
+
+		buffer.assign(host(), host() + _width * _height);
+		return buffer.data();
+	}
+
+	/// Runs the remaining HybridBinarizer steps on the device and copies the result into a new BitMatrix
+	BitMatrix binarize() const
+	{
+		ZX_TRACE_SCOPE("OpenCLBinarizer::binarize");
+		DecodeStats::StageTimer timer(DecodeStats::Stage::Binarize);
+		auto& cl = *_context->_impl;
+		int subWidth = (_width + BLOCK_SIZE - 1) / BLOCK_SIZE;
+		int subHeight = (_height + BLOCK_SIZE - 1) / BLOCK_SIZE;
+		auto stats = cl.buffer(subWidth * subHeight * sizeof(cl_uint));
+		auto blackPoints = cl.buffer(subWidth * subHeight * sizeof(cl_int));
+		auto thresholds = cl.buffer(subWidth * subHeight * sizeof(cl_int));
+
+		BitMatrix matrix(_width, _height);
+		size_t size = matrix._bits.size() * sizeof(matrix._bits[0]);
+		auto bits = cl.buffer(size, CL_MEM_WRITE_ONLY);
+
+		std::lock_guard<std::mutex> lock(cl.mutex);
+		auto queue = cl.queue.get();
+		SetArgs(cl.blockStats.get(), _luminances.get(), _width, _height, stats.get());
+		Run(queue, cl.blockStats.get(), subWidth, subHeight);
+
+		SetArgs(cl.blackPoints.get(), stats.get(), subWidth, subHeight, blackPoints.get());
+		const size_t groupSize = cl.blackPointsGroupSize;
+		Check(clEnqueueNDRangeKernel(queue, cl.blackPoints.get(), 1, nullptr, &groupSize, &groupSize, 0, nullptr,
+									 nullptr),
+			  "clEnqueueNDRangeKernel");
+
+		SetArgs(cl.thresholds.get(), blackPoints.get(), subWidth, subHeight, thresholds.get());
+		Run(queue, cl.thresholds.get(), subWidth, subHeight);
+
+		SetArgs(cl.binarize.get(), _luminances.get(), _width, _height, thresholds.get(), subWidth, subHeight,
+				bits.get());
+		Run(queue, cl.binarize.get(), matrix._rowSize, _height);
+
+		Check(clEnqueueReadBuffer(queue, bits.get(), CL_TRUE, 0, size, matrix._bits.data(), 0, nullptr, nullptr),
+			  "clEnqueueReadBuffer");
+		return matrix;
+	}
+};
+
+struct OpenCLBinarizer::DataCache
+{
+	std::once_flag once;
+	std::shared_ptr<const BitMatrix> matrix;
+};
+
+OpenCLBinarizer::OpenCLBinarizer(std::shared_ptr<OpenCLContext> context, const ImageView& image)
+	: OpenCLBinarizer(OpenCLLuminanceSource::Upload(std::move(context), image))
+{}
+
+OpenCLBinarizer::OpenCLBinarizer(std::shared_ptr<OpenCLContext> context, cl_mem image, size_t offset, int width,
+								 int height, int rowStride, ImageFormat format)
+	: OpenCLBinarizer(std::make_shared<OpenCLLuminanceSource>(std::move(context), image, offset, width, height,
+															  rowStride, format))
+{}
+
+OpenCLBinarizer::OpenCLBinarizer(std::shared_ptr<const LuminanceSource> deviceSource)
+	: GlobalHistogramBinarizer(std::move(deviceSource)), _cache(new DataCache)
+{}
+
+OpenCLBinarizer::~OpenCLBinarizer() = default;
+
+std::shared_ptr<const BitMatrix> OpenCLBinarizer::getBlackMatrix() const
+{
+	if (width() >= MINIMUM_DIMENSION && height() >= MINIMUM_DIMENSION) {
+		std::call_once(_cache->once, [this]() {
+			auto& source = static_cast<const OpenCLLuminanceSource&>(*_source);
+			_cache->matrix = std::make_shared<const BitMatrix>(source.binarize());
+		});
+		return _cache->matrix;
+	}
+	else {
+		// like HybridBinarizer, fall back to the global histogram approach for small images
+		return GlobalHistogramBinarizer::getBlackMatrix();
+	}
+}
+
+std::shared_ptr<BinaryBitmap> OpenCLBinarizer::newInstance(const std::shared_ptr<const LuminanceSource>& source) const
+{
+	if (std::dynamic_pointer_cast<const OpenCLLuminanceSource>(source))
+		return std::shared_ptr<BinaryBitmap>(new OpenCLBinarizer(source));
+	return std::make_shared<HybridBinarizer>(source);
+}
+
+std::shared_ptr<GlobalHistogramBinarizer> OpenCLBinarizer::sharedCopy() const
+{
+	return std::shared_ptr<GlobalHistogramBinarizer>(new OpenCLBinarizer(*this));
+}
+
+} // ZXing
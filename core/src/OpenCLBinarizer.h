@@ -0,0 +1,103 @@
+#pragma once
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "GlobalHistogramBinarizer.h"
+#include "ReadBarcode.h"
+
+#include <cstddef>
+#include <memory>
+
+// the OpenCL handle types, declared like in CL/cl.h so that this header does not depend on it
+typedef struct _cl_mem* cl_mem;
+typedef struct _cl_command_queue* cl_command_queue;
+
+namespace ZXing {
+
+/**
+* The OpenCL device, command queue and compiled kernels used by OpenCLBinarizer. Creating one compiles the kernels,
+* so it is meant to be created once and shared by all binarizers of a process (or of a pipeline). The enqueued work of
+* different binarizers is serialized, which keeps the kernel arguments consistent when they are used concurrently.
+* All constructors throw std::runtime_error if OpenCL is not usable.
+*/
+class OpenCLContext
+{
+public:
+	/// Uses the first GPU device found (or any device if there is no GPU)
+	OpenCLContext();
+
+	/**
+	* Uses the device and the in-order command queue of an existing pipeline, e.g. the one that produced the frames.
+	* The queue is retained, the work is enqueued behind what is already in it.
+	*/
+	explicit OpenCLContext(cl_command_queue queue);
+	~OpenCLContext();
+
+	cl_command_queue queue() const;
+
+	struct Impl; // the OpenCL objects, see OpenCLBinarizer.cpp
+
+private:
+	std::unique_ptr<Impl> _impl;
+
+	friend class OpenCLLuminanceSource; // does the work, see OpenCLBinarizer.cpp
+};
+
+/**
+* Implements the HybridBinarizer on the GPU: the RGB to luminance conversion, the block black points and the
+* thresholding run as OpenCL kernels and only the finished BitMatrix (one bit per pixel with
+* BUILD_PACKED_BIT_STORAGE) is copied back. The result is bit exact to HybridBinarizer on a GenericLuminanceSource.
+*
+* The luminance itself is only copied to the host if something asks for it, i.e. the 1D readers, which use the
+* GlobalHistogramBinarizer rows like HybridBinarizer does, or images smaller than 40x40 pixels.
+*
+* Usage: MultiFormatReader(hints).read(OpenCLBinarizer(context, image))
+*/
+class OpenCLBinarizer : public GlobalHistogramBinarizer
+{
+public:
+	/**
+	* Uploads a host image. The image formats are the ones of ImageView, the YUV formats use the luma plane, the raw
+	* sensor formats (see IsRawFormat) are not supported (std::invalid_argument).
+	*/
+	OpenCLBinarizer(std::shared_ptr<OpenCLContext> context, const ImageView& image);
+
+	/**
+	* Uses an image already in device memory (of the context of 'context'), e.g. a decoded video frame. The pixel at
+	* (x, y) starts at byte offset + y * rowStride + x * PixStride(format) of 'image'. It is only read by the luminance
+	* kernel enqueued in the constructor, so it may be reused by anything enqueued after that.
+	*/
+	OpenCLBinarizer(std::shared_ptr<OpenCLContext> context, cl_mem image, size_t offset, int width, int height,
+					int rowStride, ImageFormat format);
+	~OpenCLBinarizer() override;
+
+	std::shared_ptr<const BitMatrix> getBlackMatrix() const override;
+	/// Binarizes other (host) luminance sources, e.g. inverted ones, with a HybridBinarizer
+	std::shared_ptr<BinaryBitmap> newInstance(const std::shared_ptr<const LuminanceSource>& source) const override;
+
+protected:
+	OpenCLBinarizer(const OpenCLBinarizer& other) = default;
+	std::shared_ptr<GlobalHistogramBinarizer> sharedCopy() const override;
+
+private:
+	explicit OpenCLBinarizer(std::shared_ptr<const LuminanceSource> deviceSource);
+
+	struct DataCache;
+	std::shared_ptr<DataCache> _cache;
+};
+
+} // ZXing
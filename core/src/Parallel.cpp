@@ -0,0 +1,225 @@
+/*
+* Copyright 2020 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "Parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ZXing {
+
+namespace {
+
+/**
+* The tasks of one ParallelFor call. Every thread that picks up the job claims the next unclaimed task index until
+* none is left, so a job is shared by as many threads as are idle while it runs.
+*/
+class Job
+{
+	const std::function<void(int)>& _task;
+	const int _numTasks;
+	std::atomic<int> _next{0};
+	int _done = 0;
+	std::exception_ptr _error;
+	std::mutex _mutex;
+	std::condition_variable _finished;
+
+public:
+	Job(int numTasks, const std::function<void(int)>& task) : _task(task), _numTasks(numTasks) {}
+
+	bool exhausted() const { return _next >= _numTasks; }
+
+	// runs one task, returns false if all of them are claimed already
+	bool runOne()
+	{
+		int i = _next.fetch_add(1);
+		if (i >= _numTasks)
+			return false;
+
+		std::exception_ptr error;
+		try {
+			_task(i);
+		} catch (...) {
+			error = std::current_exception();
+		}
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		if (error && !_error)
+			_error = error;
+		if (++_done == _numTasks)
+			_finished.notify_all();
+		return true;
+	}
+
+	// waits until the tasks claimed by other threads are done as well, rethrows the first exception of any task
+	void wait()
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		_finished.wait(lock, [this] { return _done == _numTasks; });
+		if (_error)
+			std::rethrow_exception(_error);
+	}
+};
+
+/**
+* Every worker has its own queue of jobs. A ParallelFor call on a worker (i.e. nested parallelism) puts its job into
+* that queue, calls from other threads into a shared one. An idle worker first takes the newest job of its own queue,
+* which keeps nested work together, and otherwise steals the oldest job of any other queue. The calling thread runs
+* tasks of its own job as well, so no thread ever waits for work that nobody is going to do and nesting does not
+* create more threads than the pool has.
+*/
+class WorkStealingPool
+{
+	struct Queue
+	{
+		std::mutex mutex;
+		std::deque<std::shared_ptr<Job>> jobs;
+	};
+
+	std::vector<std::unique_ptr<Queue>> _queues; // one per worker, the last one for the other threads
+	std::mutex _mutex;
+	std::condition_variable _wake;
+	int64_t _pushed = 0;
+
+	static thread_local int t_worker;
+
+	int sharedQueue() const { return static_cast<int>(_queues.size()) - 1; }
+
+	std::shared_ptr<Job> take(Queue& queue, bool newest)
+	{
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		auto& jobs = queue.jobs;
+		jobs.erase(std::remove_if(jobs.begin(), jobs.end(), [](auto& job) { return job->exhausted(); }), jobs.end());
+		if (jobs.empty())
+			return nullptr;
+		return newest ? jobs.back() : jobs.front();
+	}
+
+	std::shared_ptr<Job> find(int self)
+	{
+		if (self >= 0)
+			if (auto job = take(*_queues[self], true))
+				return job;
+		int n = static_cast<int>(_queues.size());
+		for (int i = 1; i <= n; ++i) {
+			int victim = (std::max(self, 0) + i) % n;
+			if (victim != self)
+				if (auto job = take(*_queues[victim], false))
+					return job;
+		}
+		return nullptr;
+	}
+
+	void work(int self)
+	{
+		t_worker = self;
+		for (;;) {
+			int64_t pushed;
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				pushed = _pushed;
+			}
+			if (auto job = find(self)) {
+				while (job->runOne())
+					;
+				continue;
+			}
+			std::unique_lock<std::mutex> lock(_mutex);
+			_wake.wait(lock, [&] { return _pushed != pushed; });
+		}
+	}
+
+public:
+	explicit WorkStealingPool(int numWorkers)
+	{
+		for (int i = 0; i <= numWorkers; ++i)
+			_queues.emplace_back(new Queue);
+		// the workers are never joined: they block in work() at exit and joining them from a static destructor could
+		// deadlock (e.g. on DLL unload on Windows)
+		for (int i = 0; i < numWorkers; ++i)
+			std::thread(&WorkStealingPool::work, this, i).detach();
+	}
+
+	void run(int numTasks, const std::function<void(int)>& task)
+	{
+		auto job = std::make_shared<Job>(numTasks, task);
+		if (_queues.size() > 1) {
+			auto& queue = *_queues[t_worker >= 0 ? t_worker : sharedQueue()];
+			{
+				std::lock_guard<std::mutex> lock(queue.mutex);
+				queue.jobs.push_back(job);
+			}
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				++_pushed;
+			}
+			_wake.notify_all();
+		}
+
+		while (job->runOne())
+			;
+		job->wait();
+	}
+};
+
+thread_local int WorkStealingPool::t_worker = -1;
+
+} // namespace
+
+static void DefaultExecutor(int numTasks, const std::function<void(int)>& task)
+{
+	// the calling thread runs tasks as well, hence one worker less than there are cores. Never destroyed, see above.
+	static auto pool = new WorkStealingPool(std::max(1u, std::thread::hardware_concurrency()) - 1);
+	pool->run(numTasks, task);
+}
+
+static std::mutex s_mutex;
+static std::shared_ptr<const ParallelExecutor> s_executor;
+
+void SetParallelExecutor(ParallelExecutor executor)
+{
+	auto ptr = executor ? std::make_shared<const ParallelExecutor>(std::move(executor)) : nullptr;
+	std::lock_guard<std::mutex> lock(s_mutex);
+	s_executor = std::move(ptr);
+}
+
+void ParallelFor(int numTasks, const std::function<void(int)>& task)
+{
+	if (numTasks <= 1) {
+		if (numTasks == 1)
+			task(0);
+		return;
+	}
+
+	std::shared_ptr<const ParallelExecutor> executor;
+	{
+		std::lock_guard<std::mutex> lock(s_mutex);
+		executor = s_executor;
+	}
+	if (executor)
+		(*executor)(numTasks, task);
+	else
+		DefaultExecutor(numTasks, task);
+}
+
+} // ZXing
@@ -0,0 +1,42 @@
+#pragma once
+/*
+* Copyright 2020 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <functional>
+
+namespace ZXing {
+
+/**
+* An executor runs task(0) ... task(numTasks - 1), possibly concurrently, and returns once all of them are done.
+* Exceptions thrown by a task have to be propagated to the caller.
+*/
+using ParallelExecutor = std::function<void(int numTasks, const std::function<void(int)>& task)>;
+
+/**
+* Replace the executor used for data parallel work inside the library (e.g. by the HybridBinarizer) with one that
+* is backed by the thread pool of the application. Passing an empty function restores the default one, a work
+* stealing pool of hardware_concurrency() - 1 threads shared by all ParallelFor calls. The calling thread runs tasks of
+* its own call too, so nested calls (e.g. a batch of images, each binarized in bands) don't oversubscribe the cores.
+* The tasks must not wait for each other, they may run one after the other on the calling thread.
+*/
+void SetParallelExecutor(ParallelExecutor executor);
+
+/**
+* Run task(0) ... task(numTasks - 1) on the current executor and wait for all of them to finish.
+*/
+void ParallelFor(int numTasks, const std::function<void(int)>& task);
+
+} // ZXing
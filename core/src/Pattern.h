@@ -15,6 +15,7 @@
 * limitations under the License.
 */
 
+#include "MemoryResource.h"
 #include "ZXContainerAlgorithms.h"
 
 #include <algorithm>
@@ -25,7 +26,10 @@
 
 namespace ZXing {
 
-using PatternRow = std::vector<uint16_t>;
+using PatternRow = Vector<uint16_t>;
+
+/// The widths of the elements of a PatternRow with sub-pixel precision, see BinaryBitmap::getSubPixelPatternRow
+using SubPixelPatternRow = std::vector<float>;
 
 class PatternView
 {
@@ -34,15 +38,23 @@ class PatternView
 	int _size = 0;
 	Iterator _base = nullptr;
 	Iterator _end = nullptr;
+	const float* _subPixel = nullptr; // the sub-pixel widths of the elements starting at _base, if available
 
 public:
 	using value_type = PatternRow::value_type;
 
 	PatternView() = default;
 	PatternView(const PatternRow& bars)
-		: _data(bars.data() + 1), _size(bars.size()), _base(bars.data()), _end(bars.data() + bars.size())
+		: _data(bars.data() + 1), _size(Size(bars) - 1), _base(bars.data()), _end(bars.data() + bars.size())
+	{}
+	PatternView(const PatternRow& bars, const SubPixelPatternRow& widths) : PatternView(bars)
+	{
+		if (widths.size() == bars.size())
+			_subPixel = widths.data();
+	}
+	PatternView(Iterator data, int size, Iterator base, Iterator end, const float* subPixel = nullptr)
+		: _data(data), _size(size), _base(base), _end(end), _subPixel(subPixel)
 	{}
-	PatternView(Iterator data, int size, Iterator base, Iterator end) : _data(data), _size(size), _base(base), _end(end) {}
 
 	Iterator data() const { return _data; }
 	Iterator begin() const { return _data; }
@@ -57,11 +69,16 @@ public:
 	int sum(int n = 0) const { return std::accumulate(_data, _data + (n == 0 ? _size : n), 0); }
 	int size() const { return _size; }
 
+	bool hasSubPixelWidths() const { return _subPixel != nullptr; }
+	/// The width of element i with sub-pixel precision if available, otherwise the integer one
+	float subPixelWidth(int i) const { return _subPixel ? _subPixel[_data - _base + i] : _data[i]; }
+
 	int index() const { return _data - _base; }
 	int pixelsInFront() const { return std::accumulate(_base, _data, 0); }
 	bool isAtFirstBar() const { return _data == _base + 1; }
 	bool isAtLastBar() const { return _data + _size == _end - 1; }
 	bool isValid() const { return _data < _end; }
+	bool isValid(int n) const { return _data && _data >= _base && _data + n <= _end; }
 
 	template<bool acceptIfAtFirstBar = false>
 	bool hasQuiteZoneBefore(float scale) const
@@ -84,7 +101,7 @@ public:
 			size = _size - offset;
 		else if (size < 0)
 			size = _size - offset + size;
-		return {begin() + offset, std::max(size, 0), _base, _end};
+		return {begin() + offset, std::max(size, 0), _base, _end, _subPixel};
 	}
 
 	bool skipPair()
@@ -106,6 +123,26 @@ public:
 	}
 };
 
+/**
+ * Turns the run lengths of a row into those of the inverted row (black and white swapped) by shifting the start
+ * color: the first and the last run has to be white, so a white run of length 0 at either end is dropped and
+ * otherwise one is added.
+ */
+template <typename Row>
+void InvertPatternRow(Row& row)
+{
+	if (row.empty())
+		return;
+	if (row.front() == 0)
+		row.erase(row.begin());
+	else
+		row.insert(row.begin(), 0);
+	if (row.back() == 0)
+		row.pop_back();
+	else
+		row.push_back(0);
+}
+
 /**
  * @brief The BarAndSpace struct is a simple 2 element data structure to hold information about bar(s) and space(s).
  *
@@ -193,14 +230,18 @@ template<int LEN, typename Pred>
 PatternView FindPattern(const PatternView& view, Pred isPattern, float quiteZoneScale)
 {
 	auto window = view.subView(0, LEN);
-	if (window.isAtFirstBar() && isPattern(window))
-		return window;
-	while (window.skipPair()) {
+	if (window.isAtFirstBar()) {
+		if (isPattern(window))
+			return window;
+		window.skipPair();
+	}
+	// the pattern has to start within view (which may start in the middle of a row), it may extend beyond its end
+	for (; window.isValid() && window.begin() < view.end(); window.skipPair()) {
 		// Look for guard symbol with sufficient whitespace in front (>= percentage of pattern width).
 		if (window.hasQuiteZoneBefore(quiteZoneScale) && isPattern(window))
-			break;
+			return window;
 	}
-	return window;
+	return {};
 }
 
 template <int LEN, int SUM, bool IS_SPARCE>
@@ -17,12 +17,62 @@
 */
 
 #include "PerspectiveTransform.h"
+#include "CpuFeatures.h"
 
 #include <array>
 #include <tuple>
 
 namespace ZXing {
 
+static_assert(sizeof(PointF) == 2 * sizeof(double), "the batch kernels expect the points as pairs of doubles");
+
+// The coefficients m are a11, a12, a13, a21, a22, a23, a31, a32, a33. Each kernel returns the number of points it
+// transformed, the rest is left to the scalar code.
+
+#ifdef ZX_HAS_X86_DISPATCH
+
+ZX_TARGET("avx2")
+static int TransformAVX2(const double* m, const PointF* src, PointF* dst, int count)
+{
+	// two points per register: (x0, y0, x1, y1)
+	const __m256d a1 = _mm256_setr_pd(m[0], m[1], m[0], m[1]);
+	const __m256d a2 = _mm256_setr_pd(m[3], m[4], m[3], m[4]);
+	const __m256d a3 = _mm256_setr_pd(m[6], m[7], m[6], m[7]);
+	const __m256d w1 = _mm256_set1_pd(m[2]), w2 = _mm256_set1_pd(m[5]), w3 = _mm256_set1_pd(m[8]);
+	int i = 0;
+	for (; i + 2 <= count; i += 2) {
+		__m256d p = _mm256_loadu_pd(&src[i].x);
+		__m256d x = _mm256_permute_pd(p, 0x0); // (x0, x0, x1, x1)
+		__m256d y = _mm256_permute_pd(p, 0xF); // (y0, y0, y1, y1)
+		__m256d num = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(a1, x), _mm256_mul_pd(a2, y)), a3);
+		__m256d den = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(w1, x), _mm256_mul_pd(w2, y)), w3);
+		_mm256_storeu_pd(&dst[i].x, _mm256_div_pd(num, den));
+	}
+	return i;
+}
+
+#endif // ZX_HAS_X86_DISPATCH
+
+#if defined(ZX_HAS_NEON) && defined(__aarch64__)
+
+static int TransformNEON(const double* m, const PointF* src, PointF* dst, int count)
+{
+	// one point per register: (x, y)
+	const float64x2_t a1 = {m[0], m[1]}, a2 = {m[3], m[4]}, a3 = {m[6], m[7]};
+	const float64x2_t w1 = vdupq_n_f64(m[2]), w2 = vdupq_n_f64(m[5]), w3 = vdupq_n_f64(m[8]);
+	for (int i = 0; i < count; ++i) {
+		float64x2_t p = vld1q_f64(&src[i].x);
+		float64x2_t x = vdupq_laneq_f64(p, 0);
+		float64x2_t y = vdupq_laneq_f64(p, 1);
+		float64x2_t num = vaddq_f64(vaddq_f64(vmulq_f64(a1, x), vmulq_f64(a2, y)), a3);
+		float64x2_t den = vaddq_f64(vaddq_f64(vmulq_f64(w1, x), vmulq_f64(w2, y)), w3);
+		vst1q_f64(&dst[i].x, vdivq_f64(num, den));
+	}
+	return count;
+}
+
+#endif // ZX_HAS_NEON
+
 PerspectiveTransform PerspectiveTransform::inverse() const
 {
 	// Here, the adjoint serves as the inverse:
@@ -93,4 +143,21 @@ PointF PerspectiveTransform::operator()(PointF p) const
 	return {(a11 * p.x + a21 * p.y + a31) / denominator, (a12 * p.x + a22 * p.y + a32) / denominator};
 }
 
+void PerspectiveTransform::operator()(const PointF* src, PointF* dst, int count) const
+{
+	int i = 0;
+#if defined(ZX_HAS_X86_DISPATCH) || (defined(ZX_HAS_NEON) && defined(__aarch64__))
+	const double m[] = {a11, a12, a13, a21, a22, a23, a31, a32, a33};
+#if defined(ZX_HAS_X86_DISPATCH)
+	if (CpuFeatures::HasAVX2())
+		i = TransformAVX2(m, src, dst, count);
+#else
+	if (CpuFeatures::HasNEON())
+		i = TransformNEON(m, src, dst, count);
+#endif
+#endif
+	for (; i < count; ++i)
+		dst[i] = (*this)(src[i]);
+}
+
 } // ZXing
@@ -50,6 +50,38 @@ public:
 
 	PointF operator()(PointF p) const;
 
+	/**
+	* Transforms the count points at src into dst (which may be src). Uses AVX2 or NEON where available, the results
+	* are the same as those of transforming the points one by one (the same operations in the same order).
+	*/
+	void operator()(const PointF* src, PointF* dst, int count) const;
+
+	/**
+	* Calls f(i, (*this)(p + i * (1, 0))) for i in [0, count). The homogeneous coordinates are linear along the row, so
+	* they are stepped by additions and each point only costs one reciprocal. Affine transforms (no perspective terms)
+	* skip even that.
+	*/
+	template <typename F>
+	void mapRow(PointF p, int count, F f) const
+	{
+		value_t x = a11 * p.x + a21 * p.y + a31;
+		value_t y = a12 * p.x + a22 * p.y + a32;
+		if (a13 == 0 && a23 == 0) {
+			value_t s = 1 / a33;
+			x *= s, y *= s;
+			value_t dx = a11 * s, dy = a12 * s;
+			for (int i = 0; i < count; ++i, x += dx, y += dy)
+				f(i, PointF(x, y));
+		}
+		else {
+			value_t w = a13 * p.x + a23 * p.y + a33;
+			for (int i = 0; i < count; ++i, x += a11, y += a12, w += a13) {
+				value_t s = 1 / w;
+				f(i, PointF(x * s, y * s));
+			}
+		}
+	}
+
 	bool isValid() const { return _isValid; }
 };
 
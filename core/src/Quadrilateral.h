@@ -18,6 +18,7 @@
 #include "Point.h"
 #include "ZXContainerAlgorithms.h"
 
+#include <algorithm>
 #include <array>
 
 namespace ZXing {
@@ -89,6 +90,20 @@ bool IsConvex(const Quadrilateral<PointT>& poly)
 	return true;
 }
 
+template <typename PointT>
+PointF Center(const Quadrilateral<PointT>& q)
+{
+	return (PointF(q[0]) + PointF(q[1]) + PointF(q[2]) + PointF(q[3])) / 4;
+}
+
+/// Whether p lies within the axis aligned bounding box of the quadrilateral, extended by one pixel in all directions.
+template <typename PointT>
+bool IsInside(const Quadrilateral<PointT>& q, PointF p)
+{
+	auto xs = std::minmax({q[0].x, q[1].x, q[2].x, q[3].x});
+	auto ys = std::minmax({q[0].y, q[1].y, q[2].y, q[3].y});
+	return xs.first - 1 <= p.x && p.x <= xs.second + 1 && ys.first - 1 <= p.y && p.y <= ys.second + 1;
+}
 
 } // ZXing
 
@@ -0,0 +1,268 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "RawImageConverter.h"
+#include "CpuFeatures.h"
+#include "ReadBarcode.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace ZXing {
+
+/**
+* The linear mapping of 16-bit values to 8 bit: t = min(max(v - low, 0), range) >> shift, out = (t * scale) >> 8. The
+* shift keeps t <= 255, so SIMD kernels can compute the product in 16-bit lanes as the high half of (t << 8) * scale.
+*/
+struct Exposure
+{
+	uint16_t low, range, shift, scale;
+};
+
+static inline int Load16(const uint8_t* p)
+{
+	return p[0] | (p[1] << 8);
+}
+
+static inline uint8_t Map16(int v, const Exposure& e)
+{
+	int t = std::min(std::max(v - e.low, 0), int(e.range)) >> e.shift;
+	return static_cast<uint8_t>(std::min((t * e.scale) >> 8, 255));
+}
+
+static Exposure ComputeExposure(const std::array<int, 4096>& histogram)
+{
+	int total = 0;
+	for (int n : histogram)
+		total += n;
+	const int clip = total / 100;
+
+	int lo = 0, hi = 4095;
+	for (int sum = 0; lo < 4095 && (sum += histogram[lo]) <= clip;)
+		++lo;
+	for (int sum = 0; hi > lo && (sum += histogram[hi]) <= clip;)
+		--hi;
+
+	Exposure e;
+	e.low = static_cast<uint16_t>(lo << 4);
+	e.range = static_cast<uint16_t>(std::max(((hi << 4) | 15) - e.low, 1));
+	e.shift = 0;
+	while ((e.range >> e.shift) > 255)
+		++e.shift;
+	e.scale = static_cast<uint16_t>(255 * 256 / std::max(e.range >> e.shift, 1));
+	return e;
+}
+
+/// Unpacks one row of Mono12Packed into 16-bit little endian values, the 12 bits in the upper part
+static void UnpackMono12Row(const uint8_t* src, int width, uint8_t* dst)
+{
+	for (int x = 0; x + 1 < width; x += 2, src += 3, dst += 4) {
+		int p0 = (src[0] << 4) | (src[1] & 0x0F), p1 = (src[2] << 4) | (src[1] >> 4);
+		dst[0] = static_cast<uint8_t>(p0 << 4), dst[1] = static_cast<uint8_t>(p0 >> 4);
+		dst[2] = static_cast<uint8_t>(p1 << 4), dst[3] = static_cast<uint8_t>(p1 >> 4);
+	}
+	if (width & 1) {
+		int p0 = (src[0] << 4) | (src[1] & 0x0F);
+		dst[0] = static_cast<uint8_t>(p0 << 4), dst[1] = static_cast<uint8_t>(p0 >> 4);
+	}
+}
+
+#ifdef ZX_HAS_X86_DISPATCH
+
+ZX_TARGET("sse2")
+static int Map16RowSSE2(const uint8_t* src, int width, const Exposure& e, uint8_t* dst)
+{
+	const __m128i low = _mm_set1_epi16(static_cast<short>(e.low));
+	const __m128i range = _mm_set1_epi16(static_cast<short>(e.range));
+	const __m128i scale = _mm_set1_epi16(static_cast<short>(e.scale));
+	const __m128i shift = _mm_cvtsi32_si128(e.shift);
+
+	auto map8 = [&](__m128i v) {
+		__m128i t = _mm_subs_epu16(v, low);
+		t = _mm_sub_epi16(t, _mm_subs_epu16(t, range)); // min(t, range), there is no _mm_min_epu16 in SSE2
+		return _mm_mulhi_epu16(_mm_slli_epi16(_mm_srl_epi16(t, shift), 8), scale);
+	};
+
+	int x = 0;
+	for (; x + 16 <= width; x += 16) {
+		__m128i a = map8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * x)));
+		__m128i b = map8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * x + 16)));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), _mm_packus_epi16(a, b));
+	}
+	return x;
+}
+
+// needs the pixel right of the last one processed, i.e. x + 16 < width
+ZX_TARGET("sse2")
+static int Bayer2x2RowSSE2(const uint8_t* row0, const uint8_t* row1, int width, uint8_t* dst)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i two = _mm_set1_epi16(2);
+	int x = 0;
+	for (; x + 17 <= width; x += 16) {
+		__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x));
+		__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x + 1));
+		__m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x));
+		__m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x + 1));
+		__m128i lo = _mm_add_epi16(_mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero)),
+								   _mm_add_epi16(_mm_unpacklo_epi8(c, zero), _mm_unpacklo_epi8(d, zero)));
+		__m128i hi = _mm_add_epi16(_mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero)),
+								   _mm_add_epi16(_mm_unpackhi_epi8(c, zero), _mm_unpackhi_epi8(d, zero)));
+		lo = _mm_srli_epi16(_mm_add_epi16(lo, two), 2);
+		hi = _mm_srli_epi16(_mm_add_epi16(hi, two), 2);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), _mm_packus_epi16(lo, hi));
+	}
+	return x;
+}
+
+#endif // ZX_HAS_X86_DISPATCH
+
+#ifdef ZX_HAS_NEON
+
+static int Map16RowNEON(const uint8_t* src, int width, const Exposure& e, uint8_t* dst)
+{
+	const uint16x8_t low = vdupq_n_u16(e.low);
+	const uint16x8_t range = vdupq_n_u16(e.range);
+	const int16x8_t shift = vdupq_n_s16(static_cast<int16_t>(-e.shift));
+
+	auto map8 = [&](uint16x8_t v) {
+		uint16x8_t t = vshlq_u16(vminq_u16(vqsubq_u16(v, low), range), shift);
+		uint32x4_t lo = vmull_n_u16(vget_low_u16(t), e.scale);
+		uint32x4_t hi = vmull_n_u16(vget_high_u16(t), e.scale);
+		return vqmovn_u16(vcombine_u16(vshrn_n_u32(lo, 8), vshrn_n_u32(hi, 8)));
+	};
+
+	int x = 0;
+	for (; x + 16 <= width; x += 16) {
+		uint8x8_t a = map8(vreinterpretq_u16_u8(vld1q_u8(src + 2 * x)));
+		uint8x8_t b = map8(vreinterpretq_u16_u8(vld1q_u8(src + 2 * x + 16)));
+		vst1q_u8(dst + x, vcombine_u8(a, b));
+	}
+	return x;
+}
+
+static int Bayer2x2RowNEON(const uint8_t* row0, const uint8_t* row1, int width, uint8_t* dst)
+{
+	int x = 0;
+	for (; x + 17 <= width; x += 16) {
+		uint8x16_t a = vld1q_u8(row0 + x), b = vld1q_u8(row0 + x + 1);
+		uint8x16_t c = vld1q_u8(row1 + x), d = vld1q_u8(row1 + x + 1);
+		uint16x8_t lo = vaddq_u16(vaddl_u8(vget_low_u8(a), vget_low_u8(b)), vaddl_u8(vget_low_u8(c), vget_low_u8(d)));
+		uint16x8_t hi =
+			vaddq_u16(vaddl_u8(vget_high_u8(a), vget_high_u8(b)), vaddl_u8(vget_high_u8(c), vget_high_u8(d)));
+		vst1q_u8(dst + x, vcombine_u8(vrshrn_n_u16(lo, 2), vrshrn_n_u16(hi, 2)));
+	}
+	return x;
+}
+
+#endif // ZX_HAS_NEON
+
+/// Maps one row of contiguous 16-bit little endian values to 8 bit, all kernels compute exactly the same as Map16
+static void Map16Row(const uint8_t* src, int width, const Exposure& e, uint8_t* dst)
+{
+	int x = 0;
+#if defined(ZX_HAS_X86_DISPATCH)
+	if (CpuFeatures::HasSSE2())
+		x = Map16RowSSE2(src, width, e, dst);
+#elif defined(ZX_HAS_NEON)
+	if (CpuFeatures::HasNEON())
+		x = Map16RowNEON(src, width, e, dst);
+#endif
+	for (; x < width; ++x)
+		dst[x] = Map16(Load16(src + 2 * x), e);
+}
+
+static void ConvertLum16(const ImageView& iv, uint8_t* dst)
+{
+	std::array<int, 4096> histogram = {};
+	for (int y = 0; y < iv.height(); y += 4)
+		for (int x = 0; x < iv.width(); x += 4)
+			++histogram[Load16(iv.data(x, y)) >> 4];
+	const Exposure e = ComputeExposure(histogram);
+
+	for (int y = 0; y < iv.height(); ++y, dst += iv.width()) {
+		if (iv.pixStride() == 2) {
+			Map16Row(iv.data(0, y), iv.width(), e, dst);
+		} else {
+			const uint8_t* src = iv.data(0, y);
+			for (int x = 0; x < iv.width(); ++x, src += iv.pixStride())
+				dst[x] = Map16(Load16(src), e);
+		}
+	}
+}
+
+static void ConvertMono12Packed(const ImageView& iv, uint8_t* dst)
+{
+	std::array<int, 4096> histogram = {};
+	for (int y = 0; y < iv.height(); y += 4)
+		for (int x = 0; x < iv.width(); x += 4)
+			++histogram[(iv.data(x, y)[0] << 4) | (iv.data(x, y)[1] & 0x0F)];
+	const Exposure e = ComputeExposure(histogram);
+
+	// unpacking a row at a time keeps the intermediate 16-bit data in the cache
+	std::vector<uint8_t> row(2 * iv.width() + 2);
+	for (int y = 0; y < iv.height(); ++y, dst += iv.width()) {
+		UnpackMono12Row(iv.data(0, y), iv.width(), row.data());
+		Map16Row(row.data(), iv.width(), e, dst);
+	}
+}
+
+static void ConvertBayer8(const ImageView& iv, uint8_t* dst)
+{
+	const int width = iv.width(), height = iv.height();
+	if (width < 2 || height < 2) {
+		for (int y = 0; y < height; ++y)
+			for (int x = 0; x < width; ++x)
+				dst[y * width + x] = *iv.data(x, y);
+		return;
+	}
+
+	for (int y = 0; y < height; ++y, dst += width) {
+		// the last row and column pair up with the one before, so every block is a complete 2x2 filter tile
+		const uint8_t* row0 = iv.data(0, y);
+		const uint8_t* row1 = iv.data(0, y + 1 < height ? y + 1 : y - 1);
+		int x = 0;
+		if (iv.pixStride() == 1) {
+#if defined(ZX_HAS_X86_DISPATCH)
+			if (CpuFeatures::HasSSE2())
+				x = Bayer2x2RowSSE2(row0, row1, width, dst);
+#elif defined(ZX_HAS_NEON)
+			if (CpuFeatures::HasNEON())
+				x = Bayer2x2RowNEON(row0, row1, width, dst);
+#endif
+		}
+		const int ps = iv.pixStride();
+		for (; x < width; ++x) {
+			int xn = x + 1 < width ? x + 1 : x - 1;
+			dst[x] = static_cast<uint8_t>((row0[x * ps] + row0[xn * ps] + row1[x * ps] + row1[xn * ps] + 2) >> 2);
+		}
+	}
+}
+
+void ConvertRawToLum(const ImageView& iv, uint8_t* dst)
+{
+	switch (iv.format()) {
+	case ImageFormat::Lum16: ConvertLum16(iv, dst); break;
+	case ImageFormat::Mono12Packed: ConvertMono12Packed(iv, dst); break;
+	case ImageFormat::Bayer8: ConvertBayer8(iv, dst); break;
+	default: break;
+	}
+}
+
+} // ZXing
@@ -0,0 +1,35 @@
+#pragma once
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include <cstdint>
+
+namespace ZXing {
+
+class ImageView;
+
+/**
+* Converts an image in one of the raw sensor formats (see IsRawFormat) into 8-bit luminance, width * height bytes
+* without padding at dst.
+*
+* 16-bit and packed 12-bit data is mapped with an automatic exposure: the 1st and 99th percentile of a subsampled
+* histogram become black and white, so under-exposed images keep the full contrast the sensor captured. Bayer mosaics
+* are reduced to the sum of each 2x2 block, which contains every color of the filter once whatever its order.
+*/
+void ConvertRawToLum(const ImageView& iv, uint8_t* dst);
+
+} // ZXing
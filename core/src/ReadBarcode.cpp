@@ -16,34 +16,90 @@
 
 #include "ReadBarcode.h"
 #include "DecodeHints.h"
+#include "Deadline.h"
+#include "DecodeStats.h"
+#include "MemoryResource.h"
 #include "MultiFormatReader.h"
 #include "GenericLuminanceSource.h"
+#include "ViewLuminanceSource.h"
 #include "GlobalHistogramBinarizer.h"
 #include "HybridBinarizer.h"
+#include "IntegralImageBinarizer.h"
 #include "BinaryBitmap.h"
 
 #include "BitMatrix.h"
 #include "BitArray.h"
+#include "ByteArray.h"
+#include "BitHacks.h"
+#include "CpuFeatures.h"
+#include "Parallel.h"
+#include "Pattern.h"
+#include "Quadrilateral.h"
+#include "RawImageConverter.h"
+#include "SlowDecodeCapture.h"
+#include "Trace.h"
+#include "XXHash.h"
+#include "ZXContainerAlgorithms.h"
 
+#include <algorithm>
+#include <atomic>
+#include <list>
 #include <memory>
+#include <mutex>
+#include <numeric>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace ZXing {
 
+/**
+* Appends the run lengths of the row 'src' thresholded with (v <= threshold) to 'res', 'last' is the position of the
+* last transition and 'lastVal' the color of the current run. Returns the number of pixels processed.
+*/
+#ifdef ZX_HAS_X86_DISPATCH
+ZX_TARGET("sse2")
+static int ThresholdPatternRowSSE2(const uint8_t* src, int width, uint8_t threshold, PatternRow& res, int& last, bool& lastVal)
+{
+	const __m128i t = _mm_set1_epi8(static_cast<char>(threshold));
+	uint32_t prev = lastVal;
+	int x = 0;
+	for (; x + 16 <= width; x += 16) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x));
+		uint32_t black = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(v, t), v));
+		// bit i is set if pixel x + i has a different color than pixel x + i - 1
+		for (uint32_t edges = (black ^ ((black << 1) | prev)) & 0xFFFF; edges; edges &= edges - 1) {
+			int pos = x + BitHacks::NumberOfTrailingZeros(edges);
+			res.push_back(pos - last);
+			last = pos;
+		}
+		prev = black >> 15;
+	}
+	lastVal = prev;
+	return x;
+}
+#endif
+
 class ThresholdBinarizer : public BinaryBitmap
 {
 	const ImageView _buffer;
 	const uint8_t _threshold = 0;
+	const int _channel = 0;
 	mutable std::shared_ptr<const BitMatrix> _cache;
+	mutable std::shared_ptr<const RunLengthIndex> _runs;
 
 public:
-	ThresholdBinarizer(const ImageView& buffer, uint8_t threshold = 1) : _buffer(buffer), _threshold(threshold) {}
+	// channel is the byte offset of the thresholded channel in a pixel, -1 means the green one
+	ThresholdBinarizer(const ImageView& buffer, uint8_t threshold = 1, int channel = -1)
+		: _buffer(buffer), _threshold(threshold), _channel(channel < 0 ? GreenIndex(buffer._format) : channel)
+	{}
 
 	int width() const override { return _buffer._width; }
 	int height() const override { return _buffer._height; }
 
 	bool getBlackRow(int y, BitArray& row) const override
 	{
-		const int channel = GreenIndex(_buffer._format);
+		const int channel = _channel;
 
 		if (row.size() != width())
 			row = BitArray(width());
@@ -57,17 +113,51 @@ public:
 		return true;
 	}
 
+	bool getPatternRow(int y, PatternRow& res) const override
+	{
+		// single pass from the pixels to the run lengths without an intermediate BitArray
+		res.clear();
+		const uint8_t* src = _buffer.data(0, y) + _channel;
+		const int pixStride = _buffer._pixStride;
+		int last = 0;
+		bool lastVal = false; // the first value is the number of white pixels (possibly 0)
+		int x = 0;
+#ifdef ZX_HAS_X86_DISPATCH
+		if (pixStride == 1 && CpuFeatures::HasSSE2())
+			x = ThresholdPatternRowSSE2(src, width(), _threshold, res, last, lastVal);
+#endif
+		for (src += x * pixStride; x < width(); ++x, src += pixStride) {
+			bool val = *src <= _threshold;
+			if (val != lastVal) {
+				res.push_back(x - last);
+				last = x;
+				lastVal = val;
+			}
+		}
+		res.push_back(width() - last);
+		if (lastVal)
+			res.push_back(0); // the last value is the number of white pixels, here 0
+
+		return true;
+	}
+
 	std::shared_ptr<const BitMatrix> getBlackMatrix() const override
 	{
 		if (!_cache) {
+			DecodeStats::StageTimer timer(DecodeStats::Stage::Binarize);
+			ZX_TRACE_SCOPE("ThresholdBinarizer::getBlackMatrix");
 			BitMatrix res(width(), height());
 #ifdef ZX_FAST_BIT_STORAGE
-			auto src = _buffer.data(0, 0) + GreenIndex(_buffer._format);
-			for (int y = 0; y < res.height(); ++y)
-				for (auto& dst : res.row(y))
-					dst = *(src += _buffer._pixStride) <= _threshold;
+			const int channel = _channel;
+			for (int y = 0; y < res.height(); ++y) {
+				auto src = _buffer.data(0, y) + channel;
+				for (auto& dst : res.row(y)) {
+					dst = *src <= _threshold;
+					src += _buffer._pixStride;
+				}
+			}
 #else
-			const int channel = GreenIndex(_buffer._format);
+			const int channel = _channel;
 			for (int y = 0; y < res.height(); ++y)
 				for (int x = 0; x < res.width(); ++x)
 					res.set(x, y, _buffer.data(x, y)[channel] <= _threshold);
@@ -76,38 +166,803 @@ public:
 		}
 		return _cache;
 	}
+
+	std::shared_ptr<const RunLengthIndex> getRunLengthIndex() const override
+	{
+		if (!_runs)
+			_runs = std::make_shared<const RunLengthIndex>(*getBlackMatrix());
+		return _runs;
+	}
 };
 
 static Result ReadBarcode(GenericLuminanceSource&& source, const DecodeHints& hints)
 {
 	MultiFormatReader reader(hints);
-	auto srcPtr = std::shared_ptr<LuminanceSource>(&source, [](void*) {});
 
 	if (hints.binarizer() == Binarizer::LocalAverage)
-		return reader.read(HybridBinarizer(srcPtr));
+		return reader.read(HybridBinarizer(source));
 	else
-		return reader.read(GlobalHistogramBinarizer(srcPtr));
+		return reader.read(GlobalHistogramBinarizer(source));
 }
 
-Result ReadBarcode(const ImageView& iv, const DecodeHints& hints)
+struct BarcodeScanner::BufferPool
 {
-	switch (hints.binarizer()) {
-	case Binarizer::BoolCast: return MultiFormatReader(hints).read(ThresholdBinarizer(iv, 0));
-	case Binarizer::FixedThreshold: return MultiFormatReader(hints).read(ThresholdBinarizer(iv, 127));
+	std::mutex mutex;
+	std::vector<std::unique_ptr<ByteArray>> buffers;
+	// the binarized images and the tables of the binarizers, unless the hints bring their own MemoryResource
+	RecyclingMemoryResource memory;
+	// how often each attempt of the retry cascade was run and found a symbol (guarded by the mutex)
+	std::vector<int> cascadeTries, cascadeHits;
+	// the results of the last DecodeHints::resultCacheSize images, most recently used first (guarded by the mutex)
+	using CacheList = std::list<std::pair<uint64_t, Results>>;
+	CacheList cache;
+	std::unordered_map<uint64_t, CacheList::iterator> cacheIndex;
+};
+
+std::vector<DecodeAttempt> CascadeAttempts(const DecodeHints& hints)
+{
+	std::vector<Binarizer> binarizers = {hints.binarizer()};
+	for (auto binarizer : {Binarizer::LocalAverage, Binarizer::GlobalHistogram})
+		if (binarizer != hints.binarizer())
+			binarizers.push_back(binarizer);
+
+	std::vector<DecodeAttempt> attempts;
+	auto addStage = [&](bool tryRotate, bool tryHarder) {
+		for (auto binarizer : binarizers)
+			attempts.push_back({binarizer, tryRotate, tryHarder});
+	};
+	addStage(hints.tryRotate(), hints.tryHarder());
+	if (!hints.tryRotate())
+		addStage(true, hints.tryHarder());
+	if (!hints.tryHarder())
+		addStage(true, true);
+	return attempts;
+}
+
+BarcodeScanner::BarcodeScanner(const DecodeHints& hints) : _hints(hints), _pool(std::make_shared<BufferPool>())
+{
+	// the readers use the stats installed by read(), which are per call with a slowDecodeCallback, and the deadline
+	// installed by read(), which is shared by all tiles, pyramid levels and cascade attempts of one call
+	_reader.reset(new MultiFormatReader(
+		DecodeHints(hints).setTimeout({}).setStats(nullptr).setMemoryResource(memoryResource())));
+
+	if (hints.tryCascade()) {
+		_cascade = CascadeAttempts(hints);
+		for (auto& attempt : _cascade) {
+			auto& reader = _cascadeReaders[attempt.tryRotate + 2 * attempt.tryHarder];
+			// no timeout of their own, see above
+			if (!reader)
+				reader.reset(new MultiFormatReader(DecodeHints(hints)
+													   .setTryRotate(attempt.tryRotate)
+													   .setTryHarder(attempt.tryHarder)
+													   .setTimeout({})
+													   .setStats(nullptr)
+													   .setMemoryResource(memoryResource())));
+		}
+		_pool->cascadeTries.resize(_cascade.size());
+		_pool->cascadeHits.resize(_cascade.size());
+	}
+}
+
+BarcodeScanner::~BarcodeScanner() = default;
+
+BarcodeScanner::BarcodeScanner(BarcodeScanner&&) noexcept = default;
+BarcodeScanner& BarcodeScanner::operator=(BarcodeScanner&&) noexcept = default;
+
+std::shared_ptr<ByteArray> BarcodeScanner::acquireBuffer() const
+{
+	std::unique_ptr<ByteArray> buffer;
+	{
+		std::lock_guard<std::mutex> lock(_pool->mutex);
+		if (!_pool->buffers.empty()) {
+			buffer = std::move(_pool->buffers.back());
+			_pool->buffers.pop_back();
+		}
+	}
+	if (!buffer)
+		buffer.reset(new ByteArray);
+
+	// the buffer is handed back to the pool once the last LuminanceSource referencing it is gone. The pool is kept
+	// alive by the deleter so this is safe even if the BarcodeScanner is destroyed first.
+	return std::shared_ptr<ByteArray>(buffer.release(), [pool = _pool](ByteArray* p) {
+		std::lock_guard<std::mutex> lock(pool->mutex);
+		pool->buffers.emplace_back(p);
+	});
+}
+
+/**
+* The key of an image in the result cache: the xxHash of its size, format and pixel data, row by row with the hash of
+* one row as the seed of the next, so the padding at the end of the rows does not matter. read and readMultiple
+* results are kept apart by the seed of the first hash.
+*/
+uint64_t BarcodeScanner::cacheKey(const ImageView& iv, bool multiple) const
+{
+	ZX_TRACE_SCOPE("CacheKey");
+	const int32_t layout[] = {iv.width(), iv.height(), static_cast<int32_t>(iv.format())};
+	uint64_t hash = XXHash64(layout, sizeof(layout), multiple);
+	size_t rowBytes = iv.format() == ImageFormat::Mono12Packed ? (iv.width() * 3 + 1) / 2 : iv.width() * iv.pixStride();
+	for (int y = 0; y < iv.height(); ++y)
+		hash = XXHash64(iv.data(0, y), rowBytes, hash);
+	return hash;
+}
+
+bool BarcodeScanner::lookupCache(uint64_t key, Results& results) const
+{
+	std::lock_guard<std::mutex> lock(_pool->mutex);
+	auto i = _pool->cacheIndex.find(key);
+	bool hit = i != _pool->cacheIndex.end();
+	DecodeStats::AddCacheLookup(hit);
+	if (hit) {
+		_pool->cache.splice(_pool->cache.begin(), _pool->cache, i->second);
+		results = i->second->second;
+	}
+	return hit;
+}
+
+void BarcodeScanner::storeCache(uint64_t key, const Results& results) const
+{
+	std::lock_guard<std::mutex> lock(_pool->mutex);
+	auto& cache = _pool->cache;
+	auto& index = _pool->cacheIndex;
+	// a concurrent call may have read the same image in the meantime
+	if (index.count(key))
+		return;
+	cache.emplace_front(key, results);
+	index.emplace(key, cache.begin());
+	while (Size(cache) > _hints.resultCacheSize()) {
+		index.erase(cache.back().first);
+		cache.pop_back();
+	}
+}
+
+MemoryResource* BarcodeScanner::memoryResource() const
+{
+	return _hints.memoryResource() ? _hints.memoryResource() : &_pool->memory;
+}
+
+/**
+* Returns the byte offset of the color channel of a 3 or 4 channel image that separates dark and light pixels best, or
+* -1 if the luminance does it as well. The separation is the between-class variance of Otsu's method on a histogram
+* of every 4th pixel of every 4th row, i.e. how far apart the two halves of the best global threshold are. Channels in
+* which the pixels that are dark in the luminance come out light (e.g. the red channel of red on white) are skipped,
+* the symbol would appear inverted.
+*/
+static int BestChannel(const ImageView& iv)
+{
+	constexpr int STEP = 4;
+	constexpr int BINS = 64;
+	const int channels[3] = {RedIndex(iv.format()), GreenIndex(iv.format()), BlueIndex(iv.format())};
+	// candidate 3 is the luminance as computed by GenericLuminanceSource, lumSums the sum of the luminance per bin
+	int histograms[4][BINS] = {};
+	double lumSums[3][BINS] = {};
+	for (int y = STEP / 2; y < iv.height(); y += STEP) {
+		const uint8_t* p = iv.data(0, y);
+		for (int x = 0; x < iv.width(); x += STEP, p += STEP * iv.pixStride()) {
+			int rgb[3] = {p[channels[0]], p[channels[1]], p[channels[2]]};
+			int lum = (306 * rgb[0] + 601 * rgb[1] + 117 * rgb[2] + 0x200) >> 10;
+			for (int c = 0; c < 3; ++c) {
+				++histograms[c][rgb[c] * BINS / 256];
+				lumSums[c][rgb[c] * BINS / 256] += lum;
+			}
+			++histograms[3][lum * BINS / 256];
+		}
+	}
+
+	// returns the largest between-class variance and sets threshold to the last bin of the dark class
+	auto separation = [](const int* histogram, int& threshold) {
+		double total = 0, sum = 0;
+		for (int i = 0; i < BINS; ++i) {
+			total += histogram[i];
+			sum += i * double(histogram[i]);
+		}
+		double best = 0, count0 = 0, sum0 = 0;
+		for (int t = 0; t < BINS - 1; ++t) {
+			count0 += histogram[t];
+			sum0 += t * double(histogram[t]);
+			double count1 = total - count0;
+			if (count0 == 0 || count1 == 0)
+				continue;
+			double diff = sum0 / count0 - (sum - sum0) / count1;
+			if (count0 * count1 * diff * diff > best) {
+				best = count0 * count1 * diff * diff;
+				threshold = t;
+			}
+		}
+		return best;
+	};
+
+	// the luminance has the least noise, a channel has to be better to be used
+	int best = -1, threshold = 0;
+	double bestSeparation = separation(histograms[3], threshold);
+	for (int c = 0; c < 3; ++c) {
+		double s = separation(histograms[c], threshold);
+		if (s <= bestSeparation)
+			continue;
+		double count0 = 0, lum0 = 0, count1 = 0, lum1 = 0;
+		for (int i = 0; i < BINS; ++i) {
+			(i <= threshold ? count0 : count1) += histograms[c][i];
+			(i <= threshold ? lum0 : lum1) += lumSums[c][i];
+		}
+		if (lum0 / count0 < lum1 / count1) {
+			best = channels[c];
+			bestSeparation = s;
+		}
+	}
+	return best;
+}
+
+/// The byte offset of the channel to use according to the ColorStrategy, -1 for the default (luminance)
+int BarcodeScanner::colorChannel(const ImageView& iv) const
+{
+	if (_hints.colorStrategy() != ColorStrategy::BestChannel || PixStride(iv.format()) < 3)
+		return -1;
+	return BestChannel(iv);
+}
+
+std::shared_ptr<const LuminanceSource> BarcodeScanner::luminance(const ImageView& iv) const
+{
+	// 8-bit grayscale input (including the Y plane of YUV formats) can be used in place, everything else gets
+	// converted into a pooled buffer
+	if (PixStride(iv.format()) == 1 && iv.pixStride() == 1)
+		return std::make_shared<ViewLuminanceSource>(iv.width(), iv.height(), iv.data(0, 0), iv.rowStride());
+
+	// a single channel is passed as all three, RGBToGray then returns it unchanged
+	int channel = colorChannel(iv);
+	if (channel >= 0)
+		return std::make_shared<GenericLuminanceSource>(0, 0, iv.width(), iv.height(), iv.data(0, 0), iv.rowStride(),
+														iv.pixStride(), channel, channel, channel, acquireBuffer());
+
+	return std::make_shared<GenericLuminanceSource>(0, 0, iv.width(), iv.height(), iv.data(0, 0), iv.rowStride(),
+													iv.pixStride(), RedIndex(iv.format()), GreenIndex(iv.format()),
+													BlueIndex(iv.format()), acquireBuffer());
+}
+
+std::unique_ptr<BinaryBitmap> BarcodeScanner::binarize(std::shared_ptr<const LuminanceSource> source,
+														Binarizer binarizer) const
+{
+	switch (binarizer) {
+	case Binarizer::LocalAverage: {
+		int blockSize = _hints.binarizerBlockSize();
+		if (blockSize == 0 && _hints.minModuleSize() > 0)
+			blockSize = HybridBinarizer::BlockSizeForModuleSize(_hints.minModuleSize());
+		// with a memory limit, binarize a few lines at a time (see HybridBinarizer::BinarizeRows)
+		bool lowMemory = _hints.maxMemory() > 0;
+		return std::unique_ptr<BinaryBitmap>(
+			new HybridBinarizer(source, _hints.binarizerThreads(), blockSize, lowMemory));
+	}
+	case Binarizer::LocalMean:
+		return std::unique_ptr<BinaryBitmap>(new IntegralImageBinarizer(source, _hints.binarizerWindowSize()));
+	default: return std::unique_ptr<BinaryBitmap>(new GlobalHistogramBinarizer(source));
+	}
+}
+
+std::unique_ptr<BinaryBitmap> BarcodeScanner::binarize(const ImageView& iv) const
+{
+	switch (_hints.binarizer()) {
+	case Binarizer::BoolCast: return std::unique_ptr<BinaryBitmap>(new ThresholdBinarizer(iv, 0, colorChannel(iv)));
+	case Binarizer::FixedThreshold:
+		return std::unique_ptr<BinaryBitmap>(new ThresholdBinarizer(iv, 127, colorChannel(iv)));
 	default:
-		return ReadBarcode(
-			{
-				iv._width,
-				iv._height,
-				iv._data,
-				iv._rowStride,
-				iv._pixStride,
-				RedIndex(iv._format),
-				GreenIndex(iv._format),
-				BlueIndex(iv._format),
-			},
-			hints);
+		return binarize(luminance(iv), _hints.binarizer());
+	}
+}
+
+/**
+* Rough estimate of the memory a reader holds at once when decoding a width x height image: the luminance copy (unless
+* 8-bit grayscale input is used in place), the binarized image and, with tryRotate, the rotated copies of both.
+*/
+static int64_t WorkingSet(int width, int height, bool copiesLuminance, bool tryRotate)
+{
+	int64_t pixels = int64_t(width) * height;
+#ifdef ZX_FAST_BIT_STORAGE
+	int64_t bytes = pixels; // one byte per pixel of the BitMatrix
+#else
+	int64_t bytes = pixels / 8;
+#endif
+	if (copiesLuminance)
+		bytes += pixels;
+	return tryRotate ? 2 * bytes : bytes;
+}
+
+bool BarcodeScanner::fitsMemoryLimit(int width, int height, bool copiesLuminance) const
+{
+	return _hints.maxMemory() <= 0 || WorkingSet(width, height, copiesLuminance, _hints.tryRotate()) <= _hints.maxMemory();
+}
+
+int BarcodeScanner::downscaleFactor() const
+{
+	// the memory limit may need downscaling even if the tryDownscale factor is 1
+	return std::max(2, _hints.downscaleFactor());
+}
+
+std::shared_ptr<const LuminanceSource> BarcodeScanner::downscale(const LuminanceSource& source) const
+{
+	const int factor = downscaleFactor();
+	const int width = source.width() / factor;
+	const int height = source.height() / factor;
+
+	ByteArray tmp;
+	int srcStride = 0;
+	const uint8_t* src = source.getMatrix(tmp, srcStride);
+
+	// simple box filter: each destination pixel is the mean of a factor x factor block of source pixels
+	auto buffer = acquireBuffer();
+	buffer->resize(width * height);
+	uint8_t* dst = buffer->data();
+	std::vector<int> sums(width);
+	for (int y = 0; y < height; ++y) {
+		std::fill(sums.begin(), sums.end(), 0);
+		for (int dy = 0; dy < factor; ++dy) {
+			const uint8_t* row = src + (y * factor + dy) * srcStride;
+			for (int x = 0; x < width; ++x)
+				for (int dx = 0; dx < factor; ++dx)
+					sums[x] += row[x * factor + dx];
+		}
+		for (int x = 0; x < width; ++x)
+			*dst++ = static_cast<uint8_t>(sums[x] / (factor * factor));
 	}
+
+	return std::make_shared<GenericLuminanceSource>(0, 0, width, height, std::move(buffer), width);
+}
+
+// maps the position found in an image downscaled by 'scale' back to full resolution
+static void Upscale(Result& result, int scale)
+{
+	if (scale == 1)
+		return;
+	// (x, y) is the center of a block of scale x scale pixels
+	auto pos = result.position();
+	for (auto& p : pos)
+		p = scale * p + PointI(scale / 2, scale / 2);
+	result.setPosition(pos);
+}
+
+/**
+* A symbol found twice, e.g. in the overlap of two tiles or on two pyramid levels, has (almost) the same position.
+*/
+static bool IsSameSymbol(const Result& a, const Result& b, double maxDistance)
+{
+	if (a.format() != b.format() || a.text() != b.text())
+		return false;
+	auto ca = Center(a.position()), cb = Center(b.position());
+	return IsInside(a.position(), cb) || IsInside(b.position(), ca) || distance(ca, cb) < maxDistance;
+}
+
+static int LevelScale(int factor, int level)
+{
+	int scale = 1;
+	for (int i = 0; i < level; ++i)
+		scale *= factor;
+	return scale;
+}
+
+bool BarcodeScanner::usePyramid(const ImageView& iv) const
+{
+	return _hints.tryDownscale() && _hints.downscaleFactor() > 1 && _hints.binarizer() != Binarizer::BoolCast &&
+		   _hints.binarizer() != Binarizer::FixedThreshold &&
+		   std::min(iv.width(), iv.height()) > _hints.downscaleThreshold();
+}
+
+/**
+* The luminance image and its downscaled versions, finest first. With 'pyramid' they go down to the
+* downscaleThreshold, otherwise only as far as needed to fit into the memory limit. 'finest' is set to the finest
+* level that stays within the memory limit.
+*/
+std::vector<std::shared_ptr<const LuminanceSource>> BarcodeScanner::pyramidLevels(const ImageView& iv, bool pyramid,
+																				   int& finest) const
+{
+	const int factor = downscaleFactor();
+	auto fits = [this](const LuminanceSource& source) {
+		return fitsMemoryLimit(source.width(), source.height(), true);
+	};
+
+	std::vector<std::shared_ptr<const LuminanceSource>> levels;
+	levels.push_back(luminance(iv));
+	while ((pyramid && std::min(levels.back()->width(), levels.back()->height()) > _hints.downscaleThreshold()) ||
+		   (!fits(*levels.back()) && std::min(levels.back()->width(), levels.back()->height()) >= factor))
+		levels.push_back(downscale(*levels.back()));
+
+	finest = 0;
+	while (finest < Size(levels) - 1 && !fits(*levels[finest]))
+		++finest;
+	return levels;
+}
+
+Result BarcodeScanner::readDownscaled(const ImageView& iv, bool pyramid) const
+{
+	int finest;
+	auto levels = pyramidLevels(iv, pyramid, finest);
+
+	for (int level = pyramid ? Size(levels) - 1 : finest; level >= finest; --level) {
+		if (level != finest && Deadline::Expired())
+			return Result(DecodeStatus::Timeout);
+		auto result = _reader->read(*binarize(levels[level], _hints.binarizer()));
+		if (result.isValid() || level == finest) {
+			Upscale(result, LevelScale(downscaleFactor(), level));
+			return result;
+		}
+	}
+	return Result(DecodeStatus::NotFound); // not reached
+}
+
+Results BarcodeScanner::readMultipleDownscaled(const ImageView& iv, bool pyramid, int maxSymbols) const
+{
+	int finest;
+	auto levels = pyramidLevels(iv, pyramid, finest);
+
+	// Unlike read, which stops at the first level with a symbol, every level is scanned: the coarse ones find the
+	// large (or blurry) symbols, the fine ones the small symbols. A symbol found on several levels is reported once.
+	Results res;
+	for (int level = pyramid ? Size(levels) - 1 : finest; level >= finest && Size(res) < maxSymbols; --level) {
+		if (Deadline::Expired())
+			break;
+		int scale = LevelScale(downscaleFactor(), level);
+		for (auto& result : _reader->readMultiple(*binarize(levels[level], _hints.binarizer()), maxSymbols)) {
+			Upscale(result, scale);
+			if (Size(res) < maxSymbols &&
+				std::none_of(res.begin(), res.end(), [&](const Result& r) { return IsSameSymbol(r, result, scale); }))
+				res.push_back(std::move(result));
+		}
+	}
+	return res;
+}
+
+bool BarcodeScanner::fitsMemoryLimit(const ImageView& iv) const
+{
+	bool inPlace = (PixStride(iv.format()) == 1 && iv.pixStride() == 1) || _hints.binarizer() == Binarizer::BoolCast ||
+				   _hints.binarizer() == Binarizer::FixedThreshold;
+	return fitsMemoryLimit(iv.width(), iv.height(), !inPlace);
+}
+
+Result BarcodeScanner::readRegion(const ImageView& iv) const
+{
+	auto tiles = this->tiles(iv);
+	if (!tiles.empty())
+		return readTiled(iv, tiles);
+
+	bool pyramid = usePyramid(iv);
+	if (pyramid || !fitsMemoryLimit(iv))
+		return readDownscaled(iv, pyramid);
+
+	if (_hints.tryCascade())
+		return readCascade(iv);
+
+	return _reader->read(*binarize(iv));
+}
+
+Result BarcodeScanner::readCascade(const ImageView& iv) const
+{
+	auto& tries = _pool->cascadeTries;
+	auto& hits = _pool->cascadeHits;
+
+	// The attempts with the highest success rate first, estimated as (hits + 1) / (tries + 2) so that an attempt
+	// that was never run still gets its turn before one that keeps failing. Ties keep the initial order.
+	std::vector<int> order(_cascade.size());
+	std::iota(order.begin(), order.end(), 0);
+	{
+		std::lock_guard<std::mutex> lock(_pool->mutex);
+		std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+			return int64_t(hits[a] + 1) * (tries[b] + 2) > int64_t(hits[b] + 1) * (tries[a] + 2);
+		});
+	}
+
+	// the luminance image and the binary image of each binarizer are created once, when first needed
+	std::shared_ptr<const LuminanceSource> source;
+	std::unique_ptr<BinaryBitmap> bitmaps[5];
+
+	Result result(DecodeStatus::NotFound);
+	for (int i : order) {
+		if (Deadline::Expired())
+			return Result(DecodeStatus::Timeout);
+
+		const auto& attempt = _cascade[i];
+		auto& bitmap = bitmaps[static_cast<int>(attempt.binarizer)];
+		if (!bitmap) {
+			if (attempt.binarizer == Binarizer::BoolCast || attempt.binarizer == Binarizer::FixedThreshold) {
+				bitmap.reset(new ThresholdBinarizer(iv, attempt.binarizer == Binarizer::BoolCast ? 0 : 127,
+													colorChannel(iv)));
+			}
+			else {
+				if (!source)
+					source = luminance(iv);
+				bitmap = binarize(source, attempt.binarizer);
+			}
+		}
+
+		result = _cascadeReaders[attempt.tryRotate + 2 * attempt.tryHarder]->read(*bitmap);
+
+		{
+			std::lock_guard<std::mutex> lock(_pool->mutex);
+			++tries[i];
+			if (result.isValid())
+				++hits[i];
+			// halve the counts now and then, so the order follows a change of the input
+			if (tries[i] > 1000) {
+				tries[i] /= 2;
+				hits[i] /= 2;
+			}
+		}
+
+		if (result.isValid()) {
+			result.setCascadeAttempt(i);
+			break;
+		}
+	}
+	return result;
+}
+
+Results BarcodeScanner::readMultipleRegion(const ImageView& iv, int maxSymbols) const
+{
+	auto tiles = this->tiles(iv);
+	if (!tiles.empty())
+		return readMultipleTiled(iv, tiles, maxSymbols);
+
+	bool pyramid = usePyramid(iv);
+	if (pyramid || !fitsMemoryLimit(iv))
+		return readMultipleDownscaled(iv, pyramid, maxSymbols);
+
+	return _reader->readMultiple(*binarize(iv), maxSymbols);
+}
+
+static void MoveBy(Result& result, PointI offset)
+{
+	auto pos = result.position();
+	for (auto& p : pos)
+		p = p + offset;
+	result.setPosition(pos);
+}
+
+std::vector<ImageRegion> BarcodeScanner::tiles(const ImageView& iv) const
+{
+	const int overlap = _hints.maxSymbolSize();
+	const int size = 4 * overlap;
+	if (overlap <= 0 || (iv.width() <= size && iv.height() <= size))
+		return {};
+
+	// the start positions along one axis, the last tile ends at the image border
+	auto starts = [&](int length) {
+		std::vector<int> res;
+		for (int pos = 0;; pos += size - overlap) {
+			res.push_back(std::max(0, std::min(pos, length - size)));
+			if (pos + size >= length)
+				break;
+		}
+		return res;
+	};
+
+	std::vector<ImageRegion> res;
+	for (int top : starts(iv.height()))
+		for (int left : starts(iv.width()))
+			res.push_back({left, top, std::min(size, iv.width() - left), std::min(size, iv.height() - top)});
+	return res;
+}
+
+Result BarcodeScanner::readTiled(const ImageView& iv, const std::vector<ImageRegion>& tiles) const
+{
+	// the result of the first tile (in row major order) with a symbol, like a scan of the whole image would find it.
+	// Tiles after one that already has a result are skipped.
+	std::vector<Result> results(tiles.size(), Result(DecodeStatus::NotFound));
+	std::atomic<int> firstFound(Size(tiles));
+	auto stats = DecodeStats::Current();
+	auto deadline = Deadline::Current();
+	ParallelFor(Size(tiles), [&](int i) {
+		if (i > firstFound || Deadline::Expired())
+			return;
+		// the scopes are thread local, install them on the worker thread, too
+		std::unique_ptr<Deadline::Scope> deadlineScope(deadline ? new Deadline::Scope(*deadline) : nullptr);
+		DecodeStats::Scope statsScope(stats);
+		MemoryResource::Scope memoryScope(memoryResource());
+		const auto& tile = tiles[i];
+		auto result = readRegion(iv.cropped(tile.left, tile.top, tile.width, tile.height));
+		if (!result.isValid())
+			return;
+		MoveBy(result, {tile.left, tile.top});
+		results[i] = std::move(result);
+		for (int first = firstFound; i < first && !firstFound.compare_exchange_weak(first, i);)
+			;
+	});
+
+	int first = firstFound;
+	if (first < Size(tiles))
+		return std::move(results[first]);
+	return Result(Deadline::Expired() ? DecodeStatus::Timeout : DecodeStatus::NotFound);
+}
+
+Results BarcodeScanner::readMultipleTiled(const ImageView& iv, const std::vector<ImageRegion>& tiles,
+										   int maxSymbols) const
+{
+	std::vector<Results> tileResults(tiles.size());
+	auto stats = DecodeStats::Current();
+	auto deadline = Deadline::Current();
+	ParallelFor(Size(tiles), [&](int i) {
+		if (Deadline::Expired())
+			return;
+		std::unique_ptr<Deadline::Scope> deadlineScope(deadline ? new Deadline::Scope(*deadline) : nullptr);
+		DecodeStats::Scope statsScope(stats);
+		MemoryResource::Scope memoryScope(memoryResource());
+		const auto& tile = tiles[i];
+		tileResults[i] = readMultipleRegion(iv.cropped(tile.left, tile.top, tile.width, tile.height), maxSymbols);
+		for (auto& result : tileResults[i])
+			MoveBy(result, {tile.left, tile.top});
+	});
+
+	// a symbol in the overlap of two tiles is found in both
+	const double maxDistance = _hints.maxSymbolSize() / 4.;
+	Results res;
+	for (auto& results : tileResults)
+		for (auto& result : results) {
+			if (Size(res) >= maxSymbols)
+				return res;
+			auto isSame = [&](const Result& r) { return IsSameSymbol(r, result, maxDistance); };
+			if (std::none_of(res.begin(), res.end(), isSame))
+				res.push_back(std::move(result));
+		}
+	return res;
+}
+
+/**
+* Converts raw sensor data into 8-bit luminance in a pooled buffer, the returned view is valid as long as 'buffer'.
+*/
+ImageView BarcodeScanner::convertRaw(const ImageView& iv, std::shared_ptr<ByteArray>& buffer) const
+{
+	ZX_TRACE_SCOPE("ConvertRawToLum");
+	buffer = acquireBuffer();
+	buffer->resize(iv.width() * iv.height());
+	ConvertRawToLum(iv, buffer->data());
+	return {buffer->data(), iv.width(), iv.height(), ImageFormat::Lum};
+}
+
+/**
+* Calls read with the DecodeStats of the hints installed, which also accounts the luminance copies made by the
+* BarcodeScanner, not only the work of the MultiFormatReader. With a slowDecodeCallback the call gets stats of its own
+* that are added to the ones of the hints afterwards, and is reported if it took at least the slowDecodeThreshold.
+*/
+template <typename F>
+static auto CaptureSlowDecode(const ImageView& iv, const DecodeHints& hints, F read) -> decltype(read())
+{
+	auto callback = hints.slowDecodeCallback();
+	if (!callback) {
+		DecodeStats::Scope statsScope(hints.stats());
+		return read();
+	}
+
+	DecodeStats stats;
+	auto start = DecodeStats::Clock::now();
+	auto res = [&] {
+		DecodeStats::Scope statsScope(&stats);
+		return read();
+	}();
+	auto time = std::chrono::duration_cast<std::chrono::nanoseconds>(DecodeStats::Clock::now() - start);
+	if (hints.stats())
+		hints.stats()->add(stats);
+	if (time >= hints.slowDecodeThreshold())
+		callback(SlowDecode{iv, hints, stats, time});
+	return res;
+}
+
+/**
+* Whether a call that started at 'start' ran into the timeout of the hints, its result might then be incomplete.
+*/
+static bool TimedOut(const DecodeHints& hints, DecodeStats::Clock::time_point start)
+{
+	return hints.timeout().count() > 0 && DecodeStats::Clock::now() - start >= hints.timeout();
+}
+
+/**
+* The deadline of one call to read or readMultiple. Without a timeout of its own, the call is limited by the deadline of
+* the caller, if any.
+*/
+static Deadline CallDeadline(const DecodeHints& hints)
+{
+	if (hints.timeout().count() > 0)
+		return Deadline(hints.timeout());
+	return Deadline::Current() ? *Deadline::Current() : Deadline();
+}
+
+Result BarcodeScanner::read(const ImageView& iv) const
+{
+	Deadline deadline = CallDeadline(_hints);
+	Deadline::Scope deadlineScope(deadline);
+	return CaptureSlowDecode(iv, _hints, [&] {
+		if (_hints.resultCacheSize() <= 0)
+			return readImage(iv);
+
+		uint64_t key = cacheKey(iv, false);
+		Results cached;
+		if (lookupCache(key, cached))
+			return cached.front();
+		auto start = DecodeStats::Clock::now();
+		auto result = readImage(iv);
+		if (result.status() != DecodeStatus::Timeout && !TimedOut(_hints, start))
+			storeCache(key, {result});
+		return result;
+	});
+}
+
+Results BarcodeScanner::readMultiple(const ImageView& iv) const
+{
+	Deadline deadline = CallDeadline(_hints);
+	Deadline::Scope deadlineScope(deadline);
+	return CaptureSlowDecode(iv, _hints, [&] {
+		if (_hints.resultCacheSize() <= 0)
+			return readMultipleImage(iv);
+
+		uint64_t key = cacheKey(iv, true);
+		Results results;
+		if (lookupCache(key, results))
+			return results;
+		auto start = DecodeStats::Clock::now();
+		results = readMultipleImage(iv);
+		if (!TimedOut(_hints, start))
+			storeCache(key, results);
+		return results;
+	});
+}
+
+Result BarcodeScanner::readImage(const ImageView& iv) const
+{
+	if (IsRawFormat(iv.format())) {
+		std::shared_ptr<ByteArray> buffer;
+		return readImage(convertRaw(iv, buffer));
+	}
+
+	MemoryResource::Scope memoryScope(memoryResource());
+
+	if (_hints.regionsOfInterest().empty())
+		return readRegion(iv);
+
+	Result result(DecodeStatus::NotFound);
+	for (auto& roi : _hints.regionsOfInterest()) {
+		auto view = iv.cropped(roi.left, roi.top, roi.width, roi.height);
+		if (view.width() == 0 || view.height() == 0)
+			continue;
+		result = readRegion(view);
+		if (result.isValid()) {
+			MoveBy(result, {std::max(0, roi.left), std::max(0, roi.top)});
+			break;
+		}
+	}
+	return result;
+}
+
+Results BarcodeScanner::readMultipleImage(const ImageView& iv) const
+{
+	if (IsRawFormat(iv.format())) {
+		std::shared_ptr<ByteArray> buffer;
+		return readMultipleImage(convertRaw(iv, buffer));
+	}
+
+	MemoryResource::Scope memoryScope(memoryResource());
+
+	if (_hints.regionsOfInterest().empty())
+		return readMultipleRegion(iv, _hints.maxNumberOfSymbols());
+
+	Results results;
+	for (auto& roi : _hints.regionsOfInterest()) {
+		int remaining = _hints.maxNumberOfSymbols() - Size(results);
+		if (remaining <= 0)
+			break;
+		auto view = iv.cropped(roi.left, roi.top, roi.width, roi.height);
+		if (view.width() == 0 || view.height() == 0)
+			continue;
+		for (auto& result : readMultipleRegion(view, remaining)) {
+			MoveBy(result, {std::max(0, roi.left), std::max(0, roi.top)});
+			results.push_back(std::move(result));
+		}
+	}
+	return results;
+}
+
+Result ReadBarcode(const ImageView& iv, const DecodeHints& hints)
+{
+	ZX_TRACE_SCOPE("ReadBarcode");
+	return BarcodeScanner(hints).read(iv);
+}
+
+Results ReadBarcodes(const ImageView& iv, const DecodeHints& hints)
+{
+	ZX_TRACE_SCOPE("ReadBarcodes");
+	return BarcodeScanner(hints).readMultiple(iv);
 }
 
 Result ReadBarcode(int width, int height, const uint8_t* data, int rowStride, BarcodeFormats formats, bool tryRotate,
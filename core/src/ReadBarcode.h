@@ -19,7 +19,10 @@
 #include "Result.h"
 #include "DecodeHints.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <memory>
+#include <vector>
 
 namespace ZXing {
 
@@ -33,12 +36,22 @@ enum class ImageFormat : uint32_t
 	XRGB = 0x04010203,
 	BGRX = 0x04020100,
 	XBGR = 0x04030201,
+	// YUV 4:2:0 formats: only the full resolution luma (Y) plane at the start of the buffer is used (in place)
+	NV12 = 0x11000000, ///< semi-planar: Y plane followed by an interleaved U/V plane
+	NV21 = 0x21000000, ///< semi-planar: Y plane followed by an interleaved V/U plane (Android camera default)
+	I420 = 0x31000000, ///< planar: Y plane followed by the U and the V plane
+	YV12 = 0x41000000, ///< planar: Y plane followed by the V and the U plane
+	// raw sensor formats: converted to 8-bit luminance once per image, 16-bit data with an automatic exposure
+	Lum16 = 0x52000000, ///< 16-bit little endian gray, also Mono12/Mono10 unpacked (value range taken from the image)
+	Mono12Packed = 0x60000000, ///< 12-bit gray, 2 pixels in 3 bytes (GenICam Mono12Packed), width must be even
+	Bayer8 = 0x71000000, ///< 8-bit Bayer mosaic, any 2x2 color filter order (RGGB, BGGR, GRBG, GBRG)
 };
 
-constexpr inline int PixStride(ImageFormat format) { return (static_cast<uint32_t>(format) >> 3*8) & 0xFF; }
+constexpr inline int PixStride(ImageFormat format) { return (static_cast<uint32_t>(format) >> 3*8) & 0x0F; }
 constexpr inline int RedIndex(ImageFormat format) { return (static_cast<uint32_t>(format) >> 2*8) & 0xFF; }
 constexpr inline int GreenIndex(ImageFormat format) { return (static_cast<uint32_t>(format) >> 1*8) & 0xFF; }
 constexpr inline int BlueIndex(ImageFormat format) { return (static_cast<uint32_t>(format) >> 0*8) & 0xFF; }
+constexpr inline bool IsRawFormat(ImageFormat format) { return (static_cast<uint32_t>(format) >> 7*4) >= 5; }
 
 /**
  * Simple class that stores a non-owning const pointer to image data plus layout and format information.
@@ -49,7 +62,6 @@ class ImageView
 	ImageFormat _format;
 	int _width = 0, _height = 0, _pixStride = 0, _rowStride = 0;
 
-	friend Result ReadBarcode(const ImageView&, const DecodeHints&);
 	friend class ThresholdBinarizer;
 
 public:
@@ -60,15 +72,142 @@ public:
 	 * @param width  image width in pixels
 	 * @param height  image height in pixels
 	 * @param format  image/pixel format
-	 * @param rowStride  optional row stride in bytes, default is width * pixStride
+	 * @param rowStride  optional row stride in bytes, default is width * pixStride (width * 3 / 2 for Mono12Packed)
 	 * @param pixStride  optional pixel stride in bytes, default is calculated from format
 	 */
 	ImageView(const uint8_t* data, int width, int height, ImageFormat format, int rowStride = 0, int pixStride = 0)
 		: _data(data), _format(format), _width(width), _height(height),
-		  _pixStride(pixStride ? pixStride : PixStride(format)), _rowStride(rowStride ? rowStride : width * _pixStride)
+		  _pixStride(pixStride ? pixStride : PixStride(format)),
+		  _rowStride(rowStride ? rowStride
+							   : (format == ImageFormat::Mono12Packed ? (width * 3 + 1) / 2 : width * _pixStride))
 	{}
 
-	const uint8_t* data(int x, int y) const { return _data + y * _rowStride + x * _pixStride; }
+	int width() const { return _width; }
+	int height() const { return _height; }
+	int pixStride() const { return _pixStride; }
+	int rowStride() const { return _rowStride; }
+	ImageFormat format() const { return _format; }
+
+	/// For Mono12Packed x has to be even (the start of a 3 byte pixel pair)
+	const uint8_t* data(int x, int y) const
+	{
+		return _data + y * _rowStride + (_format == ImageFormat::Mono12Packed ? x / 2 * 3 : x * _pixStride);
+	}
+
+	/**
+	 * Returns a view of a sub-region of this image without copying the pixel data. The region is clamped to the
+	 * image bounds. For Mono12Packed left and width are rounded to whole pixel pairs.
+	 */
+	ImageView cropped(int left, int top, int width, int height) const
+	{
+		if (_format == ImageFormat::Mono12Packed) {
+			width += left & 1;
+			left &= ~1;
+			width += width & 1;
+		}
+		int right = std::max(0, std::min(left + width, _width));
+		int bottom = std::max(0, std::min(top + height, _height));
+		left = std::max(0, std::min(left, _width));
+		top = std::max(0, std::min(top, _height));
+		return {data(left, top), std::max(0, right - left), std::max(0, bottom - top), _format, _rowStride, _pixStride};
+	}
+};
+
+class BinaryBitmap;
+class LuminanceSource;
+class MemoryResource;
+class MultiFormatReader;
+
+/**
+ * The binarizer and reader settings of one attempt of the DecodeHints::tryCascade retry cascade
+ */
+struct DecodeAttempt
+{
+	Binarizer binarizer;
+	bool tryRotate;
+	bool tryHarder;
+};
+
+/**
+ * The attempts of the retry cascade for the given hints in their initial order: the binarizer of the hints, then
+ * LocalAverage and GlobalHistogram, first with the tryRotate and tryHarder of the hints, then with tryRotate and
+ * finally with tryHarder as well.
+ */
+std::vector<DecodeAttempt> CascadeAttempts(const DecodeHints& hints);
+
+/**
+ * A reusable, preconfigured barcode reader.
+ *
+ * Constructing the reader instantiates all format specific readers requested by the hints once. Subsequent calls
+ * to read() reuse them together with internal scratch buffers (the luminance image and, unless
+ * DecodeHints::memoryResource is set, the binarized image and the binarizer tables), so decoding a sequence of equally
+ * sized images (e.g. video frames) does no image sized allocations after the first one. A single instance may be
+ * used concurrently from multiple threads. With DecodeHints::resultCacheSize it remembers the results of the last
+ * images it read and answers byte-identical ones from that cache.
+ */
+class BarcodeScanner
+{
+	struct BufferPool;
+
+	DecodeHints _hints;
+	std::unique_ptr<MultiFormatReader> _reader;
+	std::shared_ptr<BufferPool> _pool;
+	// the attempts of the tryCascade retry cascade and their readers, indexed by tryRotate + 2 * tryHarder
+	std::vector<DecodeAttempt> _cascade;
+	std::unique_ptr<MultiFormatReader> _cascadeReaders[4];
+
+	std::shared_ptr<ByteArray> acquireBuffer() const;
+	uint64_t cacheKey(const ImageView& buffer, bool multiple) const;
+	bool lookupCache(uint64_t key, Results& results) const;
+	void storeCache(uint64_t key, const Results& results) const;
+	ImageView convertRaw(const ImageView& buffer, std::shared_ptr<ByteArray>& converted) const;
+	MemoryResource* memoryResource() const;
+	int colorChannel(const ImageView& buffer) const;
+	std::shared_ptr<const LuminanceSource> luminance(const ImageView& buffer) const;
+	std::unique_ptr<BinaryBitmap> binarize(const ImageView& buffer) const;
+	std::unique_ptr<BinaryBitmap> binarize(std::shared_ptr<const LuminanceSource> source, Binarizer binarizer) const;
+	bool fitsMemoryLimit(int width, int height, bool copiesLuminance) const;
+	bool fitsMemoryLimit(const ImageView& buffer) const;
+	int downscaleFactor() const;
+	std::shared_ptr<const LuminanceSource> downscale(const LuminanceSource& source) const;
+	bool usePyramid(const ImageView& buffer) const;
+	std::vector<std::shared_ptr<const LuminanceSource>> pyramidLevels(const ImageView& buffer, bool pyramid,
+																	  int& finest) const;
+	Result readDownscaled(const ImageView& buffer, bool pyramid) const;
+	Results readMultipleDownscaled(const ImageView& buffer, bool pyramid, int maxSymbols) const;
+	Result readImage(const ImageView& buffer) const;
+	Results readMultipleImage(const ImageView& buffer) const;
+	Result readRegion(const ImageView& buffer) const;
+	Result readCascade(const ImageView& buffer) const;
+	Results readMultipleRegion(const ImageView& buffer, int maxSymbols) const;
+	std::vector<ImageRegion> tiles(const ImageView& buffer) const;
+	Result readTiled(const ImageView& buffer, const std::vector<ImageRegion>& tiles) const;
+	Results readMultipleTiled(const ImageView& buffer, const std::vector<ImageRegion>& tiles, int maxSymbols) const;
+
+public:
+	explicit BarcodeScanner(const DecodeHints& hints = {});
+	~BarcodeScanner();
+
+	BarcodeScanner(BarcodeScanner&&) noexcept;
+	BarcodeScanner& operator=(BarcodeScanner&&) noexcept;
+
+	const DecodeHints& hints() const { return _hints; }
+
+	/**
+	 * Read barcode from an ImageView
+	 *
+	 * @param buffer  view of the image data including layout and format
+	 * @return #Result structure
+	 */
+	Result read(const ImageView& buffer) const;
+
+	/**
+	 * Read all barcodes from an ImageView, at most hints().maxNumberOfSymbols()
+	 *
+	 * @param buffer  view of the image data including layout and format
+	 * @return list of valid #Result structures, possibly empty
+	 */
+	Results readMultiple(const ImageView& buffer) const;
 };
 
 /**
@@ -80,6 +219,18 @@ public:
  */
 Result ReadBarcode(const ImageView& buffer, const DecodeHints& hints = {});
 
+/**
+ * Read all barcodes from an ImageView
+ *
+ * The image is binarized only once, all requested readers run over the same binary image and regions of
+ * already decoded symbols are masked out. The search stops after hints.maxNumberOfSymbols() results.
+ *
+ * @param buffer  view of the image data including layout and format
+ * @param hints  optional DecodeHints to parameterize / speed up decoding
+ * @return list of valid #Result structures, possibly empty
+ */
+Results ReadBarcodes(const ImageView& buffer, const DecodeHints& hints = {});
+
 
 [[deprecated]]
 Result ReadBarcode(int width, int height, const uint8_t* data, int rowStride,
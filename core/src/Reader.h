@@ -16,10 +16,11 @@
 * limitations under the License.
 */
 
+#include "Result.h"
+
 namespace ZXing {
 
 class BinaryBitmap;
-class Result;
 
 /**
 * Implementations of this interface can decode an image of a barcode in some format into
@@ -55,6 +56,23 @@ public:
 	* @throws FormatException if a potential barcode is found but format is invalid
 	*/
 	virtual Result decode(const BinaryBitmap& image) const = 0;
+
+	/**
+	* Locates and decodes up to maxSymbols barcodes within an image. The default implementation
+	* simply forwards to decode(image). Readers that can find more than one symbol per call
+	* override this.
+	*
+	* @param image image of barcodes to decode
+	* @param maxSymbols upper limit for the number of returned results
+	* @return all valid results found, possibly empty
+	*/
+	virtual Results decode(const BinaryBitmap& image, int maxSymbols) const
+	{
+		Result result = decode(image);
+		if (!result.isValid() || maxSymbols <= 0)
+			return {};
+		return {std::move(result)};
+	}
 };
 
 } // ZXing
@@ -17,14 +17,30 @@
 
 #include "ReedSolomonDecoder.h"
 #include "ZXConfig.h"
+#include "CpuFeatures.h"
+#include "DecodeStats.h"
 #include "GenericGF.h"
 
+#include <algorithm>
+#include <array>
 #include <cstddef>
+#include <cstdint>
 #include <stdexcept>
 #include <utility>
 
 namespace ZXing {
 
+// Evaluates the polynomial with the given coefficients (most significant first) at a, see GenericGFPoly::evaluateAt.
+// Leading zero coefficients do not change the result, so there is no need to build a (normalized) GenericGFPoly.
+static int
+EvaluateAt(const GenericGF& field, const std::vector<int>& coefficients, int a)
+{
+	int result = 0;
+	for (int c : coefficients)
+		result = field.addOrSubtract(field.multiply(a, result), c);
+	return result;
+}
+
 // May throw ReedSolomonException
 static bool
 RunEuclideanAlgorithm(const GenericGF& field, std::vector<int>&& rCoefs, int R, GenericGFPoly& sigma, GenericGFPoly& omega)
@@ -32,7 +48,7 @@ RunEuclideanAlgorithm(const GenericGF& field, std::vector<int>&& rCoefs, int R,
 	GenericGFPoly r(field, std::move(rCoefs));
 	GenericGFPoly& tLast = omega;
 	GenericGFPoly& t = sigma;
-	ZX_THREAD_LOCAL GenericGFPoly q, rLast;
+	GenericGFPoly q, rLast;
 
 	field.setMonomial(rLast, R, 1);
 	field.setZero(tLast);
@@ -134,13 +150,13 @@ FindErrorMagnitudes(const GenericGF& field, const GenericGFPoly& errorEvaluator,
 
 
 bool
-ReedSolomonDecoder::Decode(const GenericGF& field, std::vector<int>& received, int twoS)
+ReedSolomonDecoder::DecodeEuclidean(const GenericGF& field, std::vector<int>& received, int twoS)
 {
-	GenericGFPoly poly(field, received);
-	std::vector<int> syndromeCoefficients(twoS, 0);
+	ZX_THREAD_LOCAL std::vector<int> syndromeCoefficients;
+	syndromeCoefficients.assign(twoS, 0);
 	bool noError = true;
 	for (int i = 0; i < twoS; i++) {
-		int eval = poly.evaluateAt(field.exp(i + field.generatorBase()));
+		int eval = EvaluateAt(field, received, field.exp(i + field.generatorBase()));
 		syndromeCoefficients[twoS - 1 - i] = eval;
 		if (eval != 0) {
 			noError = false;
@@ -150,7 +166,7 @@ ReedSolomonDecoder::Decode(const GenericGF& field, std::vector<int>& received, i
 		return true;
 	}
 
-	ZX_THREAD_LOCAL GenericGFPoly sigma, omega;
+	GenericGFPoly sigma, omega;
 
 	if (!RunEuclideanAlgorithm(field, std::move(syndromeCoefficients), twoS, sigma, omega))
 		return false;
@@ -172,4 +188,252 @@ ReedSolomonDecoder::Decode(const GenericGF& field, std::vector<int>& received, i
 	return true;
 }
 
+#ifdef ZX_HAS_X86_DISPATCH
+
+// Split nibble multiplication tables of a GF(256): for every constant c, lo[c][i] = c * i and hi[c][i] = c * (i << 4),
+// so c * x = lo[c][x & 0xF] ^ hi[c][x >> 4], which is what pshufb computes for 16 bytes x at once.
+struct NibbleTables
+{
+	alignas(16) uint8_t lo[256][16];
+	alignas(16) uint8_t hi[256][16];
+
+	explicit NibbleTables(const GenericGF& field)
+	{
+		for (int c = 0; c < 256; ++c)
+			for (int i = 0; i < 16; ++i) {
+				lo[c][i] = static_cast<uint8_t>(field.multiply(c, i));
+				hi[c][i] = static_cast<uint8_t>(field.multiply(c, i << 4));
+			}
+	}
+};
+
+static const NibbleTables& GetNibbleTables(const GenericGF& field)
+{
+	// AztecData8 is a separate instance of the DataMatrix field, so tell the fields apart by their primitive
+	// polynomial, which is what exp(8) reduces to.
+	if (field.exp(8) == GenericGF::QRCodeField256().exp(8)) {
+		static const NibbleTables qrCode(GenericGF::QRCodeField256());
+		return qrCode;
+	}
+	static const NibbleTables dataMatrix(GenericGF::DataMatrixField256());
+	return dataMatrix;
+}
+
+// Computes the syndromes S[j] = received(exp(j + generatorBase)) of a GF(256) block. The codewords are split into 16
+// interleaved streams, each lane of the accumulator evaluates one of them with Horner's scheme in steps of
+// x^16, a multiplication by a constant that pshufb does for all lanes. The lanes are combined at the end.
+ZX_TARGET("ssse3")
+static void ComputeSyndromesSSSE3(const GenericGF& field, const std::vector<int>& received, int twoS, int* S)
+{
+	const auto& tables = GetNibbleTables(field);
+	int count = Size(received);
+	int blocks = (count + 15) / 16;
+
+	// leading zero coefficients do not change the value, they pad the front to whole blocks
+	alignas(16) uint8_t bytes[256 + 16] = {};
+	int offset = blocks * 16 - count;
+	for (int i = 0; i < count; ++i)
+		bytes[offset + i] = static_cast<uint8_t>(received[i]);
+
+	const __m128i nibbleMask = _mm_set1_epi8(0x0F);
+	for (int j = 0; j < twoS; j++) {
+		int logX = (j + field.generatorBase()) % 255;
+		int x16 = field.exp(16 * logX % 255);
+		const __m128i lo = _mm_load_si128(reinterpret_cast<const __m128i*>(tables.lo[x16]));
+		const __m128i hi = _mm_load_si128(reinterpret_cast<const __m128i*>(tables.hi[x16]));
+		__m128i acc = _mm_setzero_si128();
+		for (int b = 0; b < blocks; ++b) {
+			__m128i product = _mm_xor_si128(_mm_shuffle_epi8(lo, _mm_and_si128(acc, nibbleMask)),
+											_mm_shuffle_epi8(hi, _mm_and_si128(_mm_srli_epi16(acc, 4), nibbleMask)));
+			acc = _mm_xor_si128(product, _mm_load_si128(reinterpret_cast<const __m128i*>(bytes + 16 * b)));
+		}
+		alignas(16) uint8_t lanes[16];
+		_mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+		// lane l holds the coefficient of x^(15 - l)
+		int x = field.exp(logX);
+		int sum = 0;
+		for (int l = 0; l < 16; ++l)
+			sum = field.addOrSubtract(field.multiply(x, sum), lanes[l]);
+		S[j] = sum;
+	}
+}
+
+#endif // ZX_HAS_X86_DISPATCH
+
+// Evaluates the polynomial with the given coefficients (least significant first) at a.
+static int
+EvaluateLowFirst(const GenericGF& field, const int* coefficients, int count, int a)
+{
+	int result = 0;
+	for (int i = count - 1; i >= 0; --i)
+		result = field.addOrSubtract(field.multiply(a, result), coefficients[i]);
+	return result;
+}
+
+bool
+ReedSolomonDecoder::Decode(const GenericGF& field, std::vector<int>& received, int twoS)
+{
+	return Decode(field, received, twoS, {});
+}
+
+bool
+ReedSolomonDecoder::Decode(const GenericGF& field, std::vector<int>& received, int twoS, const std::vector<int>& erasures)
+{
+	DecodeStats::StageTimer timer(DecodeStats::Stage::ErrorCorrection);
+	int numErasures = Size(erasures);
+	if (twoS <= 0)
+		return numErasures == 0;
+	if (numErasures > twoS)
+		return false;
+
+	// All polynomials below have at most twoS + 1 coefficients. They live in one buffer on the stack, only the
+	// blocks with very many error correction codewords (possible in large Aztec symbols) need to allocate.
+	constexpr int MAX_STACK_TWO_S = 128;
+	constexpr int NUM_BUFFERS = 8;
+	std::array<int, NUM_BUFFERS * (MAX_STACK_TWO_S + 1)> stackBuffer;
+	std::vector<int> heapBuffer;
+	int* buffer = stackBuffer.data();
+	if (twoS > MAX_STACK_TWO_S) {
+		heapBuffer.resize(NUM_BUFFERS * (twoS + 1));
+		buffer = heapBuffer.data();
+	}
+	int* S = buffer; // syndromes, S[j] = received(exp(j + generatorBase))
+	int* C = S + (twoS + 1); // error locator, least significant coefficient first
+	int* B = C + (twoS + 1); // error locator before the last length change
+	int* T = B + (twoS + 1); // temporary
+	int* omega = T + (twoS + 1); // error evaluator
+	int* roots = omega + (twoS + 1); // exponents p_k of the error locations X_k = exp(p_k)
+	int* magnitudes = roots + (twoS + 1);
+	int* G = magnitudes + (twoS + 1); // erasure locator
+
+#ifdef ZX_HAS_X86_DISPATCH
+	if (field.size() == 256 && Size(received) <= 256 && CpuFeatures::HasSSSE3()) {
+		ComputeSyndromesSSSE3(field, received, twoS, S);
+	}
+	else
+#endif
+	{
+		// Horner's scheme for all syndromes at once: the steps for the different evaluation points are independent of
+		// each other, which keeps the CPU pipeline busy, unlike one long dependency chain per syndrome.
+		for (int j = 0; j < twoS; j++)
+			T[j] = field.exp(j + field.generatorBase());
+		std::fill_n(S, twoS, 0);
+		for (int c : received)
+			for (int j = 0; j < twoS; j++)
+				S[j] = field.addOrSubtract(field.multiply(T[j], S[j]), c);
+	}
+	if (std::all_of(S, S + twoS, [](int s) { return s == 0; }))
+		return true;
+
+	// The erasure locator G(x) = prod(1 - X_e x) is known up front. The Forney syndromes F = S * G mod x^twoS past
+	// the first numErasures coefficients are generated by the locator of the remaining (unknown) errors alone.
+	int receivedCount = Size(received);
+	int order = field.size() - 1;
+	std::fill_n(G, twoS + 1, 0);
+	G[0] = 1;
+	for (int k = 0; k < numErasures; k++) {
+		int p = receivedCount - 1 - erasures[k];
+		if (erasures[k] < 0 || p < 0 || p >= order)
+			return false;
+		int x = field.exp(p);
+		for (int i = k + 1; i > 0; i--)
+			G[i] = field.addOrSubtract(G[i], field.multiply(x, G[i - 1]));
+	}
+	const int* F = S;
+	if (numErasures > 0) {
+		for (int j = numErasures; j < twoS; j++) {
+			int sum = 0;
+			for (int i = 0; i <= numErasures; i++)
+				sum = field.addOrSubtract(sum, field.multiply(G[i], S[j - i]));
+			omega[j] = sum;
+		}
+		F = omega + numErasures;
+	}
+	int numF = twoS - numErasures;
+
+	// Berlekamp-Massey: find the shortest linear feedback shift register C of length L that generates F
+	std::fill_n(C, twoS + 1, 0);
+	std::fill_n(B, twoS + 1, 0);
+	C[0] = B[0] = 1;
+	int L = 0;
+	int m = 1;
+	int b = 1;
+	for (int n = 0; n < numF; n++) {
+		int d = F[n];
+		for (int i = 1; i <= L; i++)
+			d = field.addOrSubtract(d, field.multiply(C[i], F[n - i]));
+		if (d == 0) {
+			m++;
+			continue;
+		}
+		int coef = field.multiply(d, field.inverse(b));
+		bool lengthChange = 2 * L <= n;
+		if (lengthChange)
+			std::copy_n(C, twoS + 1, T);
+		for (int i = 0; i + m <= twoS; i++)
+			C[i + m] = field.addOrSubtract(C[i + m], field.multiply(coef, B[i]));
+		if (lengthChange) {
+			L = n + 1 - L;
+			std::swap(B, T);
+			b = d;
+			m = 1;
+		}
+		else {
+			m++;
+		}
+	}
+	if (2 * L > numF)
+		return false;
+
+	// the complete locator of errors and erasures is C * G
+	if (numErasures > 0) {
+		std::fill_n(T, twoS + 1, 0);
+		for (int i = 0; i <= L; i++)
+			for (int j = 0; j <= numErasures; j++)
+				T[i + j] = field.addOrSubtract(T[i + j], field.multiply(C[i], G[j]));
+		std::copy_n(T, twoS + 1, C);
+		L += numErasures;
+	}
+
+	// Chien search, restricted to the positions that exist in received: C(X^-1) == 0 for the error locations X
+	int numRoots = 0;
+	for (int p = 0; p < std::min(receivedCount, order) && numRoots < L; p++) {
+		if (EvaluateLowFirst(field, C, L + 1, field.exp((order - p) % order)) == 0)
+			roots[numRoots++] = p;
+	}
+	if (numRoots != L)
+		return false;
+
+	// Forney: omega = S * C mod x^twoS (of degree < L) and
+	// magnitude_k = X_k^(1 - generatorBase) * omega(X_k^-1) / C'(X_k^-1)
+	for (int i = 0; i < L; i++) {
+		int sum = 0;
+		for (int j = 0; j <= i; j++)
+			sum = field.addOrSubtract(sum, field.multiply(C[j], S[i - j]));
+		omega[i] = sum;
+	}
+	// the formal derivative in characteristic 2 keeps only the odd powers: C'(x) = sum C[2i+1] x^2i, stored in T
+	int derivativeCount = (L + 1) / 2;
+	for (int i = 0; i < derivativeCount; i++)
+		T[i] = C[2 * i + 1];
+	for (int k = 0; k < L; k++) {
+		int p = roots[k];
+		int xInverse = field.exp((order - p) % order);
+		int xInverse2 = field.multiply(xInverse, xInverse);
+		int denominator = EvaluateLowFirst(field, T, derivativeCount, xInverse2);
+		if (denominator == 0)
+			return false;
+		int magnitude = field.multiply(EvaluateLowFirst(field, omega, L, xInverse), field.inverse(denominator));
+		int e = ((1 - field.generatorBase()) * p) % order;
+		magnitudes[k] = field.multiply(magnitude, field.exp(e < 0 ? e + order : e));
+	}
+	for (int k = 0; k < L; k++) {
+		int position = receivedCount - 1 - roots[k];
+		received[position] = field.addOrSubtract(received[position], magnitudes[k]);
+	}
+	// an erasure may have been right after all, those have a magnitude of 0
+	DecodeStats::AddErrorsCorrected(std::count_if(magnitudes, magnitudes + L, [](int m) { return m != 0; }));
+	return true;
+}
+
 } // ZXing
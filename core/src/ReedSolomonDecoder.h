@@ -50,13 +50,28 @@ public:
 	/**
 	* <p>Decodes given set of received codewords, which include both data and error-correction
 	* codewords. Really, this means it uses Reed-Solomon to detect and correct errors, in-place,
-	* in the input.</p>
+	* in the input, using the Berlekamp-Massey algorithm and Forney's formula.</p>
 	*
 	* @param received data and error-correction codewords
 	* @param twoS number of error-correction codewords available
 	* @throws ReedSolomonException if decoding fails for any reason
 	*/
 	static bool Decode(const GenericGF& field, std::vector<int>& received, int twoS);
+
+	/**
+	* Same as Decode but with the positions of known bad codewords (erasures), e.g. ones that contained modules the
+	* sampler was not confident about. Each erasure only costs one error-correction codeword instead of two, so any
+	* combination of e errors and f erasures with 2e + f <= twoS can be corrected.
+	*
+	* @param erasures indices into received of the codewords that are known to be unreliable
+	*/
+	static bool Decode(const GenericGF& field, std::vector<int>& received, int twoS, const std::vector<int>& erasures);
+
+	/**
+	* Same as Decode but based on the extended Euclidean algorithm instead of Berlekamp-Massey. It allocates a
+	* chain of polynomials and is slower, it is kept as a reference to cross-check Decode with.
+	*/
+	static bool DecodeEuclidean(const GenericGF& field, std::vector<int>& received, int twoS);
 };
 
 } // ZXing
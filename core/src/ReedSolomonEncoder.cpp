@@ -17,32 +17,65 @@
 
 #include "ReedSolomonEncoder.h"
 #include "GenericGF.h"
+#include "ZXContainerAlgorithms.h"
 
-#include <stdexcept>
 #include <algorithm>
-#include <iterator>
+#include <array>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
 
 namespace ZXing {
 
-ReedSolomonEncoder::ReedSolomonEncoder(const GenericGF& field)
-: _field(&field)
+namespace {
+
+struct Generator
 {
-	_cachedGenerators.push_back(GenericGFPoly(field, { 1 }));
-}
+	// coefficients of the monic generator polynomial, most significant first, without the leading 1
+	std::vector<int> coefficients;
+	// products[m * degree + k] == m * coefficients[k], only for fields with up to 256 elements
+	std::vector<uint8_t> products;
+};
+
+} // anonymous
 
-const GenericGFPoly&
-ReedSolomonEncoder::buildGenerator(int degree)
+/**
+* The generator polynomials are shared by all encoders. They only depend on the field and the degree and there are
+* only a few distinct ones in use, so they are built once and kept for the lifetime of the process.
+*/
+static const Generator& GetGenerator(const GenericGF& field, int degree)
 {
-	int cachedGenSize = Size(_cachedGenerators);
-	if (degree >= cachedGenSize) {
-		GenericGFPoly lastGenerator = _cachedGenerators.back();
-		for (int d = cachedGenSize; d <= degree; d++) {
-			lastGenerator.multiply(GenericGFPoly(*_field, { 1, _field->exp(d - 1 + _field->generatorBase()) }));
-			_cachedGenerators.push_back(lastGenerator);
+	static std::mutex mutex;
+	static std::map<std::pair<const GenericGF*, int>, Generator> cache;
+
+	std::lock_guard<std::mutex> lock(mutex);
+	auto& generator = cache[{&field, degree}];
+	if (generator.coefficients.empty()) {
+		// (x - a^b) * (x - a^(b+1)) * ... * (x - a^(b+degree-1))
+		std::vector<int> poly = {1};
+		for (int d = 0; d < degree; d++) {
+			int root = field.exp(d + field.generatorBase());
+			poly.push_back(0);
+			for (int i = Size(poly) - 1; i > 0; i--)
+				poly[i] = field.addOrSubtract(poly[i], field.multiply(poly[i - 1], root));
+		}
+		generator.coefficients.assign(poly.begin() + 1, poly.end());
+		if (field.size() <= 256) {
+			generator.products.resize(field.size() * degree);
+			for (int m = 0; m < field.size(); m++)
+				for (int k = 0; k < degree; k++)
+					generator.products[m * degree + k] = static_cast<uint8_t>(field.multiply(m, generator.coefficients[k]));
 		}
 	}
+	// std::map never moves its nodes, the reference stays valid after the lock is released
+	return generator;
+}
 
-	return *std::next(_cachedGenerators.begin(), degree);
+ReedSolomonEncoder::ReedSolomonEncoder(const GenericGF& field)
+: _field(&field)
+{
 }
 
 void
@@ -55,15 +88,84 @@ ReedSolomonEncoder::encode(std::vector<int>& toEncode, const int ecBytes)
 	if (dataBytes <= 0) {
 		throw std::invalid_argument("No data bytes provided");
 	}
-	GenericGFPoly info = GenericGFPoly(*_field, std::vector<int>(toEncode.begin(), toEncode.begin() + dataBytes));
-	info.multiplyByMonomial(ecBytes, 1);
-	GenericGFPoly _;
-	info.divide(buildGenerator(ecBytes), _);
-	auto& coefficients = info.coefficients();
-	int numZeroCoefficients = ecBytes - Size(coefficients);
-	std::fill_n(toEncode.begin() + dataBytes, numZeroCoefficients, 0);
-	std::copy(coefficients.begin(), coefficients.end(), toEncode.begin() + dataBytes + numZeroCoefficients);
+	// The remainder of data(x) * x^ecBytes divided by the generator is computed in a linear feedback shift register
+	// that lives directly in the error correction part of toEncode.
+	auto& generator = GetGenerator(*_field, ecBytes);
+	int* reg = toEncode.data() + dataBytes;
+	std::fill_n(reg, ecBytes, 0);
+	for (int i = 0; i < dataBytes; i++) {
+		int m = _field->addOrSubtract(toEncode[i], reg[0]);
+		std::copy(reg + 1, reg + ecBytes, reg);
+		reg[ecBytes - 1] = 0;
+		if (m == 0)
+			continue;
+		if (!generator.products.empty()) {
+			const uint8_t* row = generator.products.data() + m * ecBytes;
+			for (int k = 0; k < ecBytes; k++)
+				reg[k] ^= row[k];
+		}
+		else {
+			for (int k = 0; k < ecBytes; k++)
+				reg[k] = _field->addOrSubtract(reg[k], _field->multiply(m, generator.coefficients[k]));
+		}
+	}
 }
 
+void
+ReedSolomonEncoder::encode(const ByteArray& data, const std::vector<int>& blockSizes, int ecBytes, ByteArray& ecOut) const
+{
+	if (ecBytes <= 0) {
+		throw std::invalid_argument("No error correction bytes");
+	}
+	if (_field->size() > 256) {
+		throw std::invalid_argument("Field does not fit into bytes");
+	}
+	if (std::accumulate(blockSizes.begin(), blockSizes.end(), 0) != Size(data)) {
+		throw std::invalid_argument("Block sizes do not match the data");
+	}
+	// With the products of every field element with the generator precomputed, a step of the shift register is a plain
+	// byte wise xor of two arrays. That loop is vectorized by the compiler and does all multiply-accumulates at once.
+	auto& products = GetGenerator(*_field, ecBytes).products;
+	ecOut.resize(blockSizes.size() * ecBytes);
+	const uint8_t* in = data.data();
+	uint8_t* reg = ecOut.data();
+	for (int blockSize : blockSizes) {
+		std::fill_n(reg, ecBytes, 0);
+		for (int i = 0; i < blockSize; i++) {
+			const uint8_t* row = products.data() + (in[i] ^ reg[0]) * ecBytes;
+			for (int k = 0; k < ecBytes - 1; k++)
+				reg[k] = reg[k + 1] ^ row[k];
+			reg[ecBytes - 1] = row[ecBytes - 1];
+		}
+		in += blockSize;
+		reg += ecBytes;
+	}
+}
+
+void
+ReedSolomonEncoder::encodeInterleaved(uint8_t* codewords, int numData, int numBlocks, int ecBytes) const
+{
+	if (ecBytes <= 0 || ecBytes > 255) {
+		throw std::invalid_argument("Invalid number of error correction bytes");
+	}
+	if (_field->size() > 256) {
+		throw std::invalid_argument("Field does not fit into bytes");
+	}
+	// Same shift register as above, but it lives on the stack and reads/writes the codewords with a stride instead of
+	// going through gathered copies of the blocks.
+	auto& products = GetGenerator(*_field, ecBytes).products;
+	std::array<uint8_t, 256> reg;
+	for (int block = 0; block < numBlocks; block++) {
+		std::fill_n(reg.data(), ecBytes, 0);
+		for (int i = block; i < numData; i += numBlocks) {
+			const uint8_t* row = products.data() + (codewords[i] ^ reg[0]) * ecBytes;
+			for (int k = 0; k < ecBytes - 1; k++)
+				reg[k] = reg[k + 1] ^ row[k];
+			reg[ecBytes - 1] = row[ecBytes - 1];
+		}
+		for (int k = 0; k < ecBytes; k++)
+			codewords[numData + block + k * numBlocks] = reg[k];
+	}
+}
 
 } // ZXing
@@ -15,12 +15,14 @@
 * See the License for the specific language governing permissions and
 * limitations under the License.
 */
-#include "GenericGFPoly.h"
-#include <list>
+#include "ByteArray.h"
+
 #include <vector>
 
 namespace ZXing {
 
+class GenericGF;
+
 class ReedSolomonEncoder
 {
 public:
@@ -28,11 +30,31 @@ public:
 
 	void encode(std::vector<int>& toEncode, int ecBytes);
 
+	/**
+	* Computes the error correction codewords of several blocks of data at once. This requires a field with at most
+	* 256 elements.
+	*
+	* @param data the data codewords of all blocks, one block after the other
+	* @param blockSizes the number of data codewords in each block
+	* @param ecBytes the number of error correction codewords per block
+	* @param ecOut receives blockSizes.size() * ecBytes codewords, the ones of each block one after the other
+	*/
+	void encode(const ByteArray& data, const std::vector<int>& blockSizes, int ecBytes, ByteArray& ecOut) const;
+
+	/**
+	* Computes the error correction codewords of interleaved blocks in place, as used by DataMatrix. Block b consists
+	* of the data codewords b, b + numBlocks, b + 2 * numBlocks, ... below numData and its error correction codewords
+	* are interleaved the same way behind the data, at numData + b, numData + b + numBlocks, ...
+	*
+	* @param codewords numData data codewords followed by room for numBlocks * ecBytes error correction codewords
+	* @param numData the total number of data codewords
+	* @param numBlocks the number of interleaved blocks
+	* @param ecBytes the number of error correction codewords per block, at most 255
+	*/
+	void encodeInterleaved(uint8_t* codewords, int numData, int numBlocks, int ecBytes) const;
+
 private:
 	const GenericGF* _field;
-	std::list<GenericGFPoly> _cachedGenerators;
-
-	const GenericGFPoly& buildGenerator(int degree);
 };
 
 } // ZXing
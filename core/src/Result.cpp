@@ -18,6 +18,7 @@
 #include "Result.h"
 #include "DecoderResult.h"
 #include "TextDecoder.h"
+#include "TextUtfEncoding.h"
 
 #include <utility>
 
@@ -40,10 +41,8 @@ Result::Result(DecoderResult&& decodeResult, Position&& position, BarcodeFormat
 	if (!isValid())
 		return;
 
-	//TODO: change ResultMetadata::put interface, so we can move from decodeResult?
-	const auto& byteSegments = decodeResult.byteSegments();
-	if (!byteSegments.empty()) {
-		metadata().put(ResultMetadata::BYTE_SEGMENTS, byteSegments);
+	if (!decodeResult.byteSegments().empty()) {
+		metadata().put(ResultMetadata::BYTE_SEGMENTS, std::move(decodeResult).byteSegments());
 	}
 	const auto& ecLevel = decodeResult.ecLevel();
 	if (!ecLevel.empty()) {
@@ -57,4 +56,9 @@ Result::Result(DecoderResult&& decodeResult, Position&& position, BarcodeFormat
 	//TODO: what about the other optional data in DecoderResult?
 }
 
+std::string Result::utf8() const
+{
+	return TextUtfEncoding::ToUtf8(_text);
+}
+
 } // ZXing
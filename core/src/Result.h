@@ -72,6 +72,9 @@ public:
 		_text = std::move(text);
 	}
 
+	/// text() encoded as UTF-8, for callers that hand the text on as UTF-8 (e.g. the wrappers).
+	std::string utf8() const;
+
 	const Position& position() const {
 		return _position;
 	}
@@ -87,6 +90,41 @@ public:
 		return _numBits;
 	}
 
+	/// Number of scan lines that agreed on the content of a 1D symbol (see DecodeHints::minLineCount), 0 for 2D symbols
+	int lineCount() const {
+		return _lineCount;
+	}
+	void incrementLineCount() {
+		++_lineCount;
+	}
+
+	/// Set by BarcodeTracker if the same symbol was already returned at about the same position within its repeat
+	/// timeout, the text and metadata are then those of that earlier Result
+	bool isRepeat() const {
+		return _isRepeat;
+	}
+	void setIsRepeat(bool isRepeat) {
+		_isRepeat = isRepeat;
+	}
+
+	/// Set if the symbol was found in the inverted image, i.e. light modules on a dark background (see
+	/// DecodeHints::tryInvert)
+	bool isInverted() const {
+		return _isInverted;
+	}
+	void setIsInverted(bool isInverted) {
+		_isInverted = isInverted;
+	}
+
+	/// Index of the attempt of the DecodeHints::tryCascade retry cascade that found the symbol into the list returned
+	/// by CascadeAttempts() for the same hints, -1 if the cascade was not used
+	int cascadeAttempt() const {
+		return _cascadeAttempt;
+	}
+	void setCascadeAttempt(int attempt) {
+		_cascadeAttempt = attempt;
+	}
+
 	[[deprecated]]
 	std::vector<ResultPoint> resultPoints() const {
 		return {position().begin(), position().end()};
@@ -107,7 +145,13 @@ private:
 	Position _position;
 	ByteArray _rawBytes;
 	int _numBits = 0;
+	int _lineCount = 0;
+	int _cascadeAttempt = -1;
+	bool _isRepeat = false;
+	bool _isInverted = false;
 	ResultMetadata _metadata;
 };
 
+using Results = std::vector<Result>;
+
 } // ZXing
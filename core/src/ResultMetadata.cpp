@@ -17,123 +17,99 @@
 
 #include "ResultMetadata.h"
 #include "ByteArray.h"
+#include "ByteSegments.h"
 
 #include <utility>
 
 namespace ZXing {
 
-struct ResultMetadata::Value
-{
-	virtual ~Value() = default;
-	virtual int toInteger(int fallback) const {
-		return fallback;
-	}
-	virtual std::wstring toString() const {
-		return std::wstring();
-	}
-	virtual std::list<ByteArray> toByteArrayList() const {
-		return std::list<ByteArray>();
-	}
-	virtual std::shared_ptr<CustomData> toCustomData() const {
-		return nullptr;
-	}
-};
-
-struct ResultMetadata::IntegerValue : public Value
-{
-	int value;
-	explicit IntegerValue(int v) : value(v) {}
-	int toInteger(int) const override {
-		return value;
-	}
-	std::wstring toString() const override {
-		return std::to_wstring(value);
-	}
-};
-
-struct ResultMetadata::StringValue : public Value
-{
-	std::wstring value;
-	explicit StringValue(std::wstring v) : value(std::move(v)) {}
-	std::wstring toString() const override {
-		return value;
-	}
-};
-
-struct ResultMetadata::ByteArrayListValue : public Value
-{
-	std::list<ByteArray> value;
-	explicit ByteArrayListValue(std::list<ByteArray> v) : value(std::move(v)) {}
-	std::list<ByteArray> toByteArrayList() const override {
-		return value;
-	}
-};
-
-struct ResultMetadata::CustomDataValue : public Value
-{
-	std::shared_ptr<CustomData> value;
-	explicit CustomDataValue(std::shared_ptr<CustomData> v) : value(std::move(v)) {}
-	std::shared_ptr<CustomData> toCustomData() const override {
-		return value;
-	}
-};
-
 int
 ResultMetadata::getInt(Key key, int fallbackValue) const
 {
-	auto it = _contents.find(key);
-	return it != _contents.end() ? it->second->toInteger(fallbackValue) : fallbackValue;
+	const auto& v = _contents[key];
+	return v.type == Type::Integer ? v.integer : fallbackValue;
 }
 
 std::wstring
 ResultMetadata::getString(Key key) const
 {
-	auto it = _contents.find(key);
-	return it != _contents.end() ? it->second->toString() : std::wstring();
+	const auto& v = _contents[key];
+	switch (v.type) {
+	case Type::Integer: return std::to_wstring(v.integer);
+	case Type::String: return v.string;
+	default: return std::wstring();
+	}
 }
 
 std::list<ByteArray>
 ResultMetadata::getByteArrayList(Key key) const
 {
-	auto it = _contents.find(key);
-	return it != _contents.end() ? it->second->toByteArrayList() : std::list<ByteArray>();
+	const auto& v = _contents[key];
+	return v.type == Type::ByteSegments ? std::static_pointer_cast<const ByteSegments>(v.blob)->toList()
+										: std::list<ByteArray>();
+}
+
+std::shared_ptr<const ByteSegments>
+ResultMetadata::getByteSegments(Key key) const
+{
+	const auto& v = _contents[key];
+	return v.type == Type::ByteSegments ? std::static_pointer_cast<const ByteSegments>(v.blob) : nullptr;
 }
 
 std::shared_ptr<CustomData>
 ResultMetadata::getCustomData(Key key) const
 {
-	auto it = _contents.find(key);
-	return it != _contents.end() ? it->second->toCustomData() : nullptr;
+	const auto& v = _contents[key];
+	return v.type == Type::CustomData ? std::static_pointer_cast<CustomData>(v.blob) : nullptr;
 }
 
 void
 ResultMetadata::put(Key key, int value)
 {
-	_contents[key] = std::make_shared<IntegerValue>(value);
+	auto& v = _contents[key] = {};
+	v.type = Type::Integer;
+	v.integer = value;
 }
 
 void
 ResultMetadata::put(Key key, const std::wstring& value)
 {
-	_contents[key] = std::make_shared<StringValue>(value);
+	auto& v = _contents[key] = {};
+	v.type = Type::String;
+	v.string = value;
 }
 
 void
 ResultMetadata::put(Key key, const std::list<ByteArray>& value)
 {
-	_contents[key] = std::make_shared<ByteArrayListValue>(value);
+	auto& v = _contents[key] = {};
+	v.type = Type::ByteSegments;
+	v.blob = std::make_shared<ByteSegments>(value);
+}
+
+void
+ResultMetadata::put(Key key, ByteSegments&& value)
+{
+	auto& v = _contents[key] = {};
+	v.type = Type::ByteSegments;
+	v.blob = std::make_shared<ByteSegments>(std::move(value));
 }
 
 void
 ResultMetadata::put(Key key, const std::shared_ptr<CustomData>& value)
 {
-	_contents[key] = std::make_shared<CustomDataValue>(value);
+	auto& v = _contents[key] = {};
+	v.type = Type::CustomData;
+	v.blob = value;
 }
 
 void
 ResultMetadata::putAll(const ResultMetadata& other)
 {
-	_contents.insert(other._contents.begin(), other._contents.end());
+	// like std::map::insert, keys that are already present keep their value
+	for (int key = 0; key < KEY_COUNT; ++key)
+		if (_contents[key].type == Type::None)
+			_contents[key] = other._contents[key];
 }
 
 } // ZXing
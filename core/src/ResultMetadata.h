@@ -16,14 +16,16 @@
 * limitations under the License.
 */
 
-#include <string>
-#include <map>
-#include <memory>
+#include <array>
+#include <cstdint>
 #include <list>
+#include <memory>
+#include <string>
 
 namespace ZXing {
 
 class ByteArray;
+class ByteSegments;
 class CustomData;
 
 /**
@@ -115,28 +117,37 @@ public:
 		*/
 		STRUCTURED_APPEND_PARITY,
 
+		KEY_COUNT // not a key, the number of keys
 	};
 
 	int getInt(Key key, int fallbackValue = 0) const;
 	std::wstring getString(Key key) const;
 	std::list<ByteArray> getByteArrayList(Key key) const;
+	std::shared_ptr<const ByteSegments> getByteSegments(Key key) const;
 	std::shared_ptr<CustomData> getCustomData(Key key) const;
 	
 	void put(Key key, int value);
 	void put(Key key, const std::wstring& value);
 	void put(Key key, const std::list<ByteArray>& value);
+	void put(Key key, ByteSegments&& value);
 	void put(Key key, const std::shared_ptr<CustomData>& value);
 
 	void putAll(const ResultMetadata& other);
 
 private:
-	struct Value;
-	struct IntegerValue;
-	struct StringValue;
-	struct ByteArrayListValue;
-	struct CustomDataValue;
+	enum class Type : uint8_t { None, Integer, String, ByteSegments, CustomData };
+
+	/// The value of one key. Only byte segments or custom data live on the heap (in blob), a short string
+	/// usually fits into the small string buffer, so most results do not allocate any memory for their metadata.
+	struct Value
+	{
+		Type type = Type::None;
+		int integer = 0;
+		std::wstring string;
+		std::shared_ptr<void> blob;
+	};
 
-	std::map<Key, std::shared_ptr<Value>> _contents;
+	std::array<Value, KEY_COUNT> _contents;
 };
 
 } // ZXing
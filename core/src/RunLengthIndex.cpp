@@ -0,0 +1,110 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "RunLengthIndex.h"
+
+#include "BitMatrix.h"
+
+#include <cstdint>
+
+namespace ZXing {
+
+RunLengthIndex::RunLengthIndex(const BitMatrix& matrix)
+	: _width(matrix.width()), _height(matrix.height()), _rows(_height), _columns(_width)
+{
+	// state of the current run of each column: its color and the row it started in
+	std::vector<uint8_t> colVal(_width, 0);
+	std::vector<int> colLast(_width, 0);
+
+	for (int y = 0; y < _height; ++y) {
+		auto line = matrix.rowView(y);
+		auto& row = _rows[y];
+		bool val = false; // the first run is white
+		int last = 0;
+		for (int x = 0; x < _width; ++x) {
+			bool v = line[x];
+			if (v != val) {
+				row.push_back(x - last);
+				last = x;
+				val = v;
+			}
+			if (v != colVal[x]) {
+				_columns[x].push_back(y - colLast[x]);
+				colLast[x] = y;
+				colVal[x] = v;
+			}
+		}
+		row.push_back(_width - last);
+		if (val)
+			row.push_back(0); // the last run is white
+	}
+
+	for (int x = 0; x < _width; ++x) {
+		_columns[x].push_back(_height - colLast[x]);
+		if (colVal[x])
+			_columns[x].push_back(0);
+	}
+}
+
+RunLengthIndex RunLengthIndex::inverted() const
+{
+	RunLengthIndex res = *this;
+	for (auto& row : res._rows)
+		InvertPatternRow(row);
+	for (auto& column : res._columns)
+		InvertPatternRow(column);
+	return res;
+}
+
+static int Transitions(const PatternRow& runs, int begin, int end)
+{
+	// the run ends are the positions of the color changes, the (possibly empty) first and last run do not count
+	int transitions = 0;
+	int pos = 0;
+	for (int i = 0; i < Size(runs) - 1 && pos < end - 1; ++i) {
+		pos += runs[i];
+		transitions += pos > begin && pos < end;
+	}
+	return transitions;
+}
+
+int RunLengthIndex::rowTransitions(int y, int begin, int end) const
+{
+	return Transitions(_rows[y], begin, end);
+}
+
+int RunLengthIndex::columnTransitions(int x, int begin, int end) const
+{
+	return Transitions(_columns[x], begin, end);
+}
+
+bool RunLengthIndex::columnHasBlack(int x, int begin, int end) const
+{
+	if (begin >= end)
+		return false;
+
+	const auto& runs = _columns[x];
+	// the odd runs are black
+	int pos = 0;
+	for (int i = 0; i < Size(runs) && pos < end; ++i) {
+		if (i % 2 && runs[i] && pos + runs[i] > begin)
+			return true;
+		pos += runs[i];
+	}
+	return false;
+}
+
+} // ZXing
@@ -0,0 +1,59 @@
+#pragma once
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "Pattern.h"
+
+#include <vector>
+
+namespace ZXing {
+
+class BitMatrix;
+
+/**
+* The run lengths of all rows and all columns of a BitMatrix, in the format of GetPatternRow, i.e. alternating white
+* and black runs where the first and the last one are white (possibly 0).
+*
+* It is computed in a single pass over the image and then shared (see BinaryBitmap::getRunLengthIndex) by all
+* detectors that look at the runs of the same binarized image.
+*/
+class RunLengthIndex
+{
+	int _width = 0;
+	int _height = 0;
+	std::vector<PatternRow> _rows, _columns;
+
+public:
+	explicit RunLengthIndex(const BitMatrix& matrix);
+
+	/// The run lengths of the inverted matrix (black and white swapped), derived without looking at the matrix again
+	RunLengthIndex inverted() const;
+
+	int width() const { return _width; }
+	int height() const { return _height; }
+
+	const PatternRow& row(int y) const { return _rows[y]; }
+	const PatternRow& column(int x) const { return _columns[x]; }
+
+	/// Number of color changes between neighboring pixels of [begin, end) in row y or column x
+	int rowTransitions(int y, int begin, int end) const;
+	int columnTransitions(int x, int begin, int end) const;
+
+	/// True if one of the pixels [begin, end) in column x is black
+	bool columnHasBlack(int x, int begin, int end) const;
+};
+
+} // ZXing
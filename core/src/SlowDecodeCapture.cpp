@@ -0,0 +1,164 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "SlowDecodeCapture.h"
+#include "DecodeHints.h"
+#include "DecodeStats.h"
+#include "ReadBarcode.h"
+
+#include <cstdint>
+#include <fstream>
+#include <vector>
+
+namespace ZXing {
+
+static const char* ToString(ImageFormat format)
+{
+	switch (format) {
+	case ImageFormat::None: return "None";
+	case ImageFormat::Lum: return "Lum";
+	case ImageFormat::RGB: return "RGB";
+	case ImageFormat::BGR: return "BGR";
+	case ImageFormat::RGBX: return "RGBX";
+	case ImageFormat::XRGB: return "XRGB";
+	case ImageFormat::BGRX: return "BGRX";
+	case ImageFormat::XBGR: return "XBGR";
+	case ImageFormat::NV12: return "NV12";
+	case ImageFormat::NV21: return "NV21";
+	case ImageFormat::I420: return "I420";
+	case ImageFormat::YV12: return "YV12";
+	case ImageFormat::Lum16: return "Lum16";
+	case ImageFormat::Mono12Packed: return "Mono12Packed";
+	case ImageFormat::Bayer8: return "Bayer8";
+	}
+	return "";
+}
+
+static const char* ToString(Binarizer binarizer)
+{
+	switch (binarizer) {
+	case Binarizer::LocalAverage: return "LocalAverage";
+	case Binarizer::GlobalHistogram: return "GlobalHistogram";
+	case Binarizer::FixedThreshold: return "FixedThreshold";
+	case Binarizer::BoolCast: return "BoolCast";
+	case Binarizer::LocalMean: return "LocalMean";
+	}
+	return "";
+}
+
+static bool IsColor(ImageFormat format)
+{
+	return !IsRawFormat(format) && PixStride(format) >= 3;
+}
+
+/// PGM/PPM ("Netpbm") image, 16-bit values are stored big endian
+static bool WriteNetpbm(const ImageView& iv, const std::string& path)
+{
+	std::ofstream out(path, std::ios::binary);
+	const bool color = IsColor(iv.format());
+	const int maxValue =
+		iv.format() == ImageFormat::Lum16 ? 65535 : iv.format() == ImageFormat::Mono12Packed ? 4095 : 255;
+	out << (color ? "P6" : "P5") << "\n" << iv.width() << " " << iv.height() << "\n" << maxValue << "\n";
+
+	std::vector<uint8_t> row;
+	for (int y = 0; y < iv.height(); ++y) {
+		row.clear();
+		for (int x = 0; x < iv.width(); ++x) {
+			const uint8_t* p = iv.data(x & ~1, y);
+			switch (iv.format()) {
+			case ImageFormat::Lum16: row.insert(row.end(), {iv.data(x, y)[1], iv.data(x, y)[0]}); break;
+			case ImageFormat::Mono12Packed: {
+				int v = x & 1 ? (p[2] << 4) | (p[1] >> 4) : (p[0] << 4) | (p[1] & 0x0F);
+				row.insert(row.end(), {static_cast<uint8_t>(v >> 8), static_cast<uint8_t>(v)});
+				break;
+			}
+			default:
+				p = iv.data(x, y);
+				if (color)
+					row.insert(row.end(),
+							   {p[RedIndex(iv.format())], p[GreenIndex(iv.format())], p[BlueIndex(iv.format())]});
+				else
+					row.push_back(p[0]);
+			}
+		}
+		out.write(reinterpret_cast<const char*>(row.data()), row.size());
+	}
+	return static_cast<bool>(out);
+}
+
+static double Milliseconds(std::chrono::nanoseconds time)
+{
+	return std::chrono::duration<double, std::milli>(time).count();
+}
+
+static bool WriteJson(const SlowDecode& slow, const std::string& imageName, const std::string& path)
+{
+	static const char* stageNames[] = {"Binarize", "Detect", "Sample", "ErrorCorrection", "DecodeText"};
+	static const char* readerNames[] = {"OneD", "QRCode", "DataMatrix", "Aztec", "PDF417", "MaxiCode"};
+	const auto& hints = slow.hints;
+	const auto& stats = slow.stats;
+	auto b = [](bool v) { return v ? "true" : "false"; };
+
+	std::ofstream out(path);
+	out << "{\n  \"image\": \"" << imageName << "\",\n  \"format\": \"" << ToString(slow.image.format())
+		<< "\",\n  \"width\": " << slow.image.width() << ",\n  \"height\": " << slow.image.height()
+		<< ",\n  \"timeMs\": " << Milliseconds(slow.time) << ",\n";
+
+	out << "  \"hints\": {\n    \"formats\": [";
+	const char* sep = "";
+	for (int i = 0; BarcodeFormat(1 << i) <= BarcodeFormat::_max; ++i)
+		if (hints.formats().testFlag(BarcodeFormat(1 << i))) {
+			out << sep << "\"" << ToString(BarcodeFormat(1 << i)) << "\"";
+			sep = ", ";
+		}
+	out << "],\n    \"tryHarder\": " << b(hints.tryHarder()) << ",\n    \"tryRotate\": " << b(hints.tryRotate())
+		<< ",\n    \"tryInvert\": " << b(hints.tryInvert()) << ",\n    \"tryDownscale\": " << b(hints.tryDownscale())
+		<< ",\n    \"tryCascade\": " << b(hints.tryCascade()) << ",\n    \"isPure\": " << b(hints.isPure())
+		<< ",\n    \"binarizer\": \"" << ToString(hints.binarizer()) << "\",\n    \"bestChannel\": "
+		<< b(hints.colorStrategy() == ColorStrategy::BestChannel) << ",\n    \"timeoutMs\": " << hints.timeout().count()
+		<< ",\n    \"maxNumberOfSymbols\": " << hints.maxNumberOfSymbols() << ",\n    \"maxSymbolSize\": "
+		<< hints.maxSymbolSize() << ",\n    \"scanStride\": " << hints.scanStride() << ",\n    \"regionsOfInterest\": [";
+	sep = "";
+	for (auto& roi : hints.regionsOfInterest()) {
+		out << sep << "[" << roi.left << ", " << roi.top << ", " << roi.width << ", " << roi.height << "]";
+		sep = ", ";
+	}
+	out << "]\n  },\n";
+
+	out << "  \"stageMs\": {";
+	for (int i = 0; i < static_cast<int>(DecodeStats::Stage::_count); ++i)
+		out << (i ? ", " : "") << "\"" << stageNames[i]
+			<< "\": " << Milliseconds(stats.time(static_cast<DecodeStats::Stage>(i)));
+	out << "},\n  \"readerMs\": {";
+	for (int i = 0; i < static_cast<int>(DecodeStats::ReaderType::_count); ++i)
+		out << (i ? ", " : "") << "\"" << readerNames[i]
+			<< "\": " << Milliseconds(stats.time(static_cast<DecodeStats::ReaderType>(i)));
+	out << "},\n  \"rowsScanned\": " << stats.rowsScanned() << ",\n  \"finderCandidates\": " << stats.finderCandidates()
+		<< ",\n  \"errorsCorrected\": " << stats.errorsCorrected() << ",\n  \"allocations\": " << stats.allocations()
+		<< ",\n  \"peakBytes\": " << stats.peakBytes() << "\n}\n";
+	return static_cast<bool>(out);
+}
+
+bool WriteSlowDecode(const SlowDecode& slow, const std::string& basePath)
+{
+	std::string imagePath = basePath + (IsColor(slow.image.format()) ? ".ppm" : ".pgm");
+	// the json refers to the image by its file name only, so both can be moved together
+	std::string imageName = imagePath.substr(imagePath.find_last_of("/\\") + 1);
+	return WriteNetpbm(slow.image, imagePath) && WriteJson(slow, imageName, basePath + ".json");
+}
+
+} // ZXing
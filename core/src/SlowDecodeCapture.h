@@ -0,0 +1,47 @@
+#pragma once
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include <chrono>
+#include <string>
+
+namespace ZXing {
+
+class DecodeHints;
+class DecodeStats;
+class ImageView;
+
+/**
+* What DecodeHints::slowDecodeCallback gets to see of a read that took at least DecodeHints::slowDecodeThreshold.
+* The references are only valid during the callback.
+*/
+struct SlowDecode
+{
+	const ImageView& image;   ///< the input as passed to the BarcodeScanner, before any conversion
+	const DecodeHints& hints;
+	const DecodeStats& stats; ///< of this read only
+	std::chrono::nanoseconds time;
+};
+
+/**
+* Writes the image of a slow read as basePath + ".pgm" (".ppm" for color formats, 16-bit values for Lum16 and
+* Mono12Packed, the mosaic itself for Bayer8) and the image format, the time, the hints and the stats as
+* basePath + ".json", so the read can be repeated, e.g. by a benchmark. Returns false if a file could not be written.
+*/
+bool WriteSlowDecode(const SlowDecode& slow, const std::string& basePath);
+
+} // ZXing
@@ -17,11 +17,21 @@
 #include "TextDecoder.h"
 #include "CharacterSet.h"
 #include "TextUtfEncoding.h"
+#include "CpuFeatures.h"
+#ifndef ZX_NO_CODEC_JP
 #include "textcodec/JPTextDecoder.h"
+#endif
+#ifndef ZX_NO_CODEC_GB
 #include "textcodec/GBTextDecoder.h"
+#endif
+#ifndef ZX_NO_CODEC_BIG5
 #include "textcodec/Big5TextDecoder.h"
+#endif
+#ifndef ZX_NO_CODEC_KR
 #include "textcodec/KRTextDecoder.h"
+#endif
 
+#include <cstring>
 #include <vector>
 
 namespace ZXing {
@@ -233,6 +243,21 @@ TextDecoder::Append(std::wstring& str, const uint8_t* bytes, size_t length, Char
 	case CharacterSet::Unknown:
 	case CharacterSet::ISO8859_1:
 	case CharacterSet::ASCII:
+	// Codecs that were left out of the build (see BUILD_TEXT_CODECS) at least keep their ASCII characters
+#ifdef ZX_NO_CODEC_JP
+	case CharacterSet::Shift_JIS:
+	case CharacterSet::EUC_JP:
+#endif
+#ifdef ZX_NO_CODEC_GB
+	case CharacterSet::GB2312:
+	case CharacterSet::GB18030:
+#endif
+#ifdef ZX_NO_CODEC_BIG5
+	case CharacterSet::Big5:
+#endif
+#ifdef ZX_NO_CODEC_KR
+	case CharacterSet::EUC_KR:
+#endif
 	{
 		str.append(bytes, bytes + length);
 		break;
@@ -267,6 +292,7 @@ TextDecoder::Append(std::wstring& str, const uint8_t* bytes, size_t length, Char
 		}
 		break;
 	}
+#ifndef ZX_NO_CODEC_JP
 	case CharacterSet::Shift_JIS:
 	{
 		std::vector<uint16_t> buf;
@@ -274,6 +300,8 @@ TextDecoder::Append(std::wstring& str, const uint8_t* bytes, size_t length, Char
 		TextUtfEncoding::AppendUtf16(str, buf.data(), buf.size());
 		break;
 	}
+#endif
+#ifndef ZX_NO_CODEC_BIG5
 	case CharacterSet::Big5:
 	{
 		std::vector<uint16_t> buf;
@@ -281,6 +309,8 @@ TextDecoder::Append(std::wstring& str, const uint8_t* bytes, size_t length, Char
 		TextUtfEncoding::AppendUtf16(str, buf.data(), buf.size());
 		break;
 	}
+#endif
+#ifndef ZX_NO_CODEC_GB
 	case CharacterSet::GB2312:
 	{
 		std::vector<uint16_t> buf;
@@ -295,6 +325,8 @@ TextDecoder::Append(std::wstring& str, const uint8_t* bytes, size_t length, Char
 		TextUtfEncoding::AppendUtf16(str, buf.data(), buf.size());
 		break;
 	}
+#endif
+#ifndef ZX_NO_CODEC_JP
 	case CharacterSet::EUC_JP:
 	{
 		std::vector<uint16_t> buf;
@@ -302,14 +334,16 @@ TextDecoder::Append(std::wstring& str, const uint8_t* bytes, size_t length, Char
 		TextUtfEncoding::AppendUtf16(str, buf.data(), buf.size());
 		break;
 	}
+#endif
+#ifndef ZX_NO_CODEC_KR
 	case CharacterSet::EUC_KR:
 	{
 		std::vector<uint16_t> buf;
 		KRTextDecoder::AppendEucKr(buf, bytes, length);
 		TextUtfEncoding::AppendUtf16(str, buf.data(), buf.size());
 		break;
-		break;
 	}
+#endif
 	case CharacterSet::UnicodeBig:
 	{
 		str.reserve(str.length() + length / 2);
@@ -328,6 +362,137 @@ TextDecoder::Append(std::wstring& str, const uint8_t* bytes, size_t length, Char
 	}
 }
 
+static bool IsAscii(const uint8_t* bytes, size_t length)
+{
+	size_t i = 0;
+#if defined(ZX_HAS_X86_DISPATCH)
+	if (CpuFeatures::HasSSE2()) {
+		// the movemask collects the high bits of 16 bytes at once
+		for (; i + 16 <= length; i += 16)
+			if (_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i))))
+				return false;
+	}
+#elif defined(ZX_HAS_NEON) && defined(__aarch64__)
+	if (CpuFeatures::HasNEON()) {
+		for (; i + 16 <= length; i += 16)
+			if (vmaxvq_u8(vld1q_u8(bytes + i)) & 0x80)
+				return false;
+	}
+#endif
+	for (; i + 8 <= length; i += 8) {
+		uint64_t word;
+		std::memcpy(&word, bytes + i, 8);
+		if (word & 0x8080808080808080ull)
+			return false;
+	}
+	for (; i < length; ++i)
+		if (bytes[i] & 0x80)
+			return false;
+	return true;
+}
+
+#ifdef ZX_HAS_X86_DISPATCH
+
+namespace {
+
+/**
+* Validates UTF-8 16 bytes at a time with the lookup table algorithm of simdjson (see "Validating UTF-8 In Less Than
+* One Instruction Per Byte" by John Keiser and Daniel Lemire). Every pair of consecutive bytes is classified by
+* three table lookups (high nibble of the first byte, low nibble of the first byte, high nibble of the second byte),
+* each returning the set of errors the pair could be an instance of. An error is flagged if all three agree. The
+* only thing not covered by pairs is whether a continuation byte is expected 2 or 3 bytes after a lead byte.
+*/
+struct Utf8CheckerSSSE3
+{
+	static constexpr char TOO_SHORT = 1 << 0;  // 11______ 0_______ or 11______ 11______
+	static constexpr char TOO_LONG = 1 << 1;   // 0_______ 10______
+	static constexpr char OVERLONG_3 = 1 << 2; // 11100000 100_____
+	static constexpr char TOO_LARGE = 1 << 3;  // 11110100 1001____, 11110100 101_____, 11110101 1001____, ...
+	static constexpr char SURROGATE = 1 << 4;  // 11101101 101_____
+	static constexpr char OVERLONG_2 = 1 << 5; // 1100000_ 10______
+	static constexpr char TOO_LARGE_1000 = 1 << 6; // 11110101 1000____, 1111011_ 1000____, 11111___ 1000____
+	static constexpr char OVERLONG_4 = 1 << 6; // 11110000 1000____
+	static constexpr char TWO_CONTS = char(1 << 7); // 10______ 10______
+	static constexpr char CARRY = TOO_SHORT | TOO_LONG | TWO_CONTS;
+
+	__m128i prev, error;
+
+	ZX_TARGET("ssse3") Utf8CheckerSSSE3() : prev(_mm_setzero_si128()), error(_mm_setzero_si128()) {}
+
+	ZX_TARGET("ssse3") void check(__m128i input)
+	{
+		const __m128i byte1High = _mm_setr_epi8(
+			// 0_______ (ASCII)
+			TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+			// 10______ (continuation)
+			TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+			// 1100____, 1101____ (2 byte lead)
+			TOO_SHORT | OVERLONG_2, TOO_SHORT,
+			// 1110____ (3 byte lead)
+			TOO_SHORT | OVERLONG_3 | SURROGATE,
+			// 1111____ (4 byte lead)
+			TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4);
+		const __m128i byte1Low = _mm_setr_epi8(
+			CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4, // ____0000
+			CARRY | OVERLONG_2,                          // ____0001
+			CARRY, CARRY,                                // ____001_
+			CARRY | TOO_LARGE,                           // ____0100
+			CARRY | TOO_LARGE | TOO_LARGE_1000,          // ____0101
+			CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000, // ____011_
+			CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000, // ____1___
+			CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,
+			CARRY | TOO_LARGE | TOO_LARGE_1000,
+			CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE, // ____1101
+			CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000);
+		const __m128i byte2High = _mm_setr_epi8(
+			// ________ 0_______ (ASCII)
+			TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+			// ________ 1000____
+			TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,
+			// ________ 1001____
+			TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,
+			// ________ 101_____
+			TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+			TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+			// ________ 11______
+			TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT);
+		const __m128i nibble = _mm_set1_epi8(0x0F);
+
+		__m128i prev1 = _mm_alignr_epi8(input, prev, 15);
+		__m128i prev2 = _mm_alignr_epi8(input, prev, 14);
+		__m128i prev3 = _mm_alignr_epi8(input, prev, 13);
+		__m128i special = _mm_and_si128(
+			_mm_and_si128(_mm_shuffle_epi8(byte1High, _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble)),
+						  _mm_shuffle_epi8(byte1Low, _mm_and_si128(prev1, nibble))),
+			_mm_shuffle_epi8(byte2High, _mm_and_si128(_mm_srli_epi16(input, 4), nibble)));
+		// a continuation is required 2 bytes after a 3 or 4 byte lead and 3 bytes after a 4 byte lead
+		__m128i must23 = _mm_or_si128(_mm_subs_epu8(prev2, _mm_set1_epi8(char(0xE0 - 0x80))),
+									  _mm_subs_epu8(prev3, _mm_set1_epi8(char(0xF0 - 0x80))));
+		__m128i must23x80 = _mm_and_si128(must23, _mm_set1_epi8(char(0x80)));
+		error = _mm_or_si128(error, _mm_xor_si128(must23x80, special));
+		prev = input;
+	}
+};
+
+} // namespace
+
+ZX_TARGET("ssse3")
+static bool IsValidUtf8SSSE3(const uint8_t* bytes, size_t length)
+{
+	Utf8CheckerSSSE3 checker;
+	size_t i = 0;
+	for (; i + 16 <= length; i += 16)
+		checker.check(_mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i)));
+	// The rest padded with 0s, which also flags a sequence that is cut off at the end. If there is no rest, the
+	// block of 0s is only needed for that.
+	alignas(16) uint8_t tail[16] = {};
+	std::memcpy(tail, bytes + i, length - i);
+	checker.check(_mm_load_si128(reinterpret_cast<const __m128i*>(tail)));
+	return _mm_movemask_epi8(_mm_cmpeq_epi8(checker.error, _mm_setzero_si128())) == 0xFFFF;
+}
+
+#endif
+
 /**
 * @param bytes bytes encoding a string, whose encoding should be guessed
 * @param hints decode hints if applicable
@@ -338,6 +503,18 @@ TextDecoder::Append(std::wstring& str, const uint8_t* bytes, size_t length, Char
 CharacterSet
 TextDecoder::GuessEncoding(const uint8_t* bytes, size_t length, CharacterSet fallback)
 {
+	bool assumeShiftJIS = fallback == CharacterSet::Shift_JIS || fallback == CharacterSet::EUC_JP;
+
+	// Shortcuts that give the same answer as the full analysis below: plain ASCII (e.g. URLs or GS1 data) can be any
+	// of the three encodings and contains no hint for Shift_JIS. Valid UTF-8 with at least one non-ASCII character
+	// is taken for UTF-8.
+	if (length > 0 && IsAscii(bytes, length))
+		return assumeShiftJIS ? CharacterSet::Shift_JIS : CharacterSet::ISO8859_1;
+#ifdef ZX_HAS_X86_DISPATCH
+	if (length > 0 && CpuFeatures::HasSSSE3() && IsValidUtf8SSSE3(bytes, length))
+		return CharacterSet::UTF8;
+#endif
+
 	// For now, merely tries to distinguish ISO-8859-1, UTF-8 and Shift_JIS,
 	// which should be by far the most common encodings.
 	bool canBeISO88591 = true;
@@ -472,7 +649,6 @@ TextDecoder::GuessEncoding(const uint8_t* bytes, size_t length, CharacterSet fal
 		return CharacterSet::UTF8;
 	}
 
-	bool assumeShiftJIS = fallback == CharacterSet::Shift_JIS || fallback == CharacterSet::EUC_JP;
 	// Easy -- if assuming Shift_JIS or at least 3 valid consecutive not-ascii characters (and no evidence it can't be), done
 	if (canBeShiftJIS && (assumeShiftJIS || sjisMaxKatakanaWordLength >= 3 || sjisMaxDoubleBytesWordLength >= 3)) {
 		return CharacterSet::Shift_JIS;
@@ -17,16 +17,24 @@
 #include "TextEncoder.h"
 #include "CharacterSet.h"
 #include "TextUtfEncoding.h"
+#include "UnicodePageTable.h"
+#ifndef ZX_NO_CODEC_JP
 #include "textcodec/JPTextEncoder.h"
+#endif
+#ifndef ZX_NO_CODEC_BIG5
 #include "textcodec/Big5TextEncoder.h"
+#endif
+#ifndef ZX_NO_CODEC_GB
 #include "textcodec/GBTextEncoder.h"
+#endif
+#ifndef ZX_NO_CODEC_KR
 #include "textcodec/KRTextEncoder.h"
+#endif
 #include "ZXContainerAlgorithms.h"
 
 #include <cstddef>
 #include <cstdint>
 #include <stdexcept>
-#include <algorithm>
 
 namespace ZXing {
 
@@ -39,8 +47,6 @@ struct MapEntry
 	uint8_t charcode;
 };
 
-inline bool operator<(const uint16_t& val, const MapEntry& b) { return val < b.unicode; }
-
 static const MapEntry latin2Mapping[45] = {
     {0x0080,33,  0}, {0x00a4, 1, 36}, {0x00a7, 2, 39}, {0x00ad, 1, 45}, {0x00b0, 1, 48}, {0x00b4, 1, 52}, {0x00b8, 1, 56}, {0x00c1, 2, 65},
     {0x00c4, 1, 68}, {0x00c7, 1, 71}, {0x00c9, 1, 73}, {0x00cb, 1, 75}, {0x00cd, 2, 77}, {0x00d3, 2, 83}, {0x00d6, 2, 86}, {0x00da, 1, 90},
@@ -172,34 +178,38 @@ static const MapEntry cp1256Mapping[43] = {
 };
 
 
-static uint8_t unicodeToCharcode(uint16_t unicode, const MapEntry* entries, size_t entryCount)
+// Expands the run-length encoded mapping of a code page into a table that maps each code point in one lookup.
+static UnicodePageTable<uint8_t> unicodeToCharcodeTable(const MapEntry* entries, size_t entryCount)
 {
-	auto it = std::upper_bound(entries, entries + entryCount, unicode);
-	if (it != entries)
-	{
-		--it;
-		if (unicode < it->unicode + it->count)
-		{
-			return it->charcode + (unicode - it->unicode) + 128;
-		}
-	}
-	throw std::invalid_argument("Unexpected charcode");
+	UnicodePageTable<uint8_t> table;
+	for (auto entry = entries; entry != entries + entryCount; ++entry)
+		for (int i = 0; i < entry->count; ++i)
+			table.insert(entry->unicode + i, static_cast<uint8_t>(entry->charcode + i + 128));
+	return table;
 }
 
-static void mapFromUnicode(const std::wstring& str, const MapEntry* entries, size_t entryCount, std::string& bytes)
+static void mapFromUnicode(const std::wstring& str, const UnicodePageTable<uint8_t>& table, std::string& bytes)
 {
 	bytes.reserve(str.length());
 	for (wchar_t c : str) {
 		if (c < 0x80) {
 			bytes.push_back(static_cast<char>(c));
 		}
+		else if (uint8_t charcode = table[c]) {
+			bytes.push_back(static_cast<char>(charcode));
+		}
 		else {
-			bytes.push_back(static_cast<char>(unicodeToCharcode(c, entries, entryCount)));
+			throw std::invalid_argument("Unexpected charcode");
 		}
 	}
 }
 
-#define CONVERT_USING(table, str, bytes) mapFromUnicode(str, table, Size(table), bytes)
+// The table of each code page is built on its first use (thread-safe as a function local static).
+#define CONVERT_USING(mapping, str, bytes) \
+	{ \
+		static const auto table = unicodeToCharcodeTable(mapping, Size(mapping)); \
+		mapFromUnicode(str, table, bytes); \
+	}
 
 } // anonymous
 
@@ -273,18 +283,39 @@ TextEncoder::GetBytes(const std::wstring& str, CharacterSet charset, std::string
 		CONVERT_USING(cp1252Mapping, str, bytes); break;
 	case CharacterSet::Cp1256:
 		CONVERT_USING(cp1256Mapping, str, bytes); break;
+#ifndef ZX_NO_CODEC_JP
 	case CharacterSet::Shift_JIS:
 		JPTextEncoder::EncodeShiftJIS(str, bytes); break;
+	case CharacterSet::EUC_JP:
+		JPTextEncoder::EncodeEUCJP(str, bytes); break;
+#else
+	case CharacterSet::Shift_JIS:
+	case CharacterSet::EUC_JP:
+#endif
+#ifndef ZX_NO_CODEC_BIG5
 	case CharacterSet::Big5:
 		Big5TextEncoder::EncodeBig5(str, bytes); break;
+#else
+	case CharacterSet::Big5:
+#endif
+#ifndef ZX_NO_CODEC_GB
 	case CharacterSet::GB2312:
 		GBTextEncoder::EncodeGB2312(str, bytes); break;
 	case CharacterSet::GB18030:
 		GBTextEncoder::EncodeGB18030(str, bytes); break;
-	case CharacterSet::EUC_JP:
-		JPTextEncoder::EncodeEUCJP(str, bytes); break;
+#else
+	case CharacterSet::GB2312:
+	case CharacterSet::GB18030:
+#endif
+#ifndef ZX_NO_CODEC_KR
 	case CharacterSet::EUC_KR:
 		KRTextDecoder::EncodeEucKr(str, bytes); break;
+#else
+	case CharacterSet::EUC_KR:
+#endif
+#if defined(ZX_NO_CODEC_JP) || defined(ZX_NO_CODEC_BIG5) || defined(ZX_NO_CODEC_GB) || defined(ZX_NO_CODEC_KR)
+		throw std::invalid_argument("Character set not included in this build (see BUILD_TEXT_CODECS)");
+#endif
 	case CharacterSet::UTF8:
 		TextUtfEncoding::ToUtf8(str, bytes); break;
 	default:
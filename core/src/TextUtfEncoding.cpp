@@ -15,7 +15,10 @@
 */
 
 #include "TextUtfEncoding.h"
+#include "CpuFeatures.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <type_traits>
 
 namespace ZXing {
@@ -83,6 +86,193 @@ static uint32_t Utf8Decode(uint8_t byte, uint32_t& state, uint32_t& codep)
 	return state;
 }
 
+/*
+* SIMD kernels for the common cases of decoded barcode text and writer input: blocks of ASCII and blocks of two byte
+* sequences (Latin, Greek, Cyrillic, Hebrew, Arabic). They advance src and out over the blocks they handle and stop at
+* the first one that needs the scalar code, so any input is converted exactly like by the scalar loops alone.
+*/
+
+#ifdef ZX_HAS_X86_DISPATCH
+
+ZX_TARGET("sse2")
+static void CountUtf8BytesSSE2(const uint32_t*& src, const uint32_t* end, size_t& count)
+{
+	// unsigned comparisons by flipping the sign bit, each exceeded limit adds one byte
+	const __m128i bias = _mm_set1_epi32(INT32_MIN);
+	const __m128i limit1 = _mm_set1_epi32(0x7f ^ INT32_MIN);
+	const __m128i limit2 = _mm_set1_epi32(0x7ff ^ INT32_MIN);
+	const __m128i limit3 = _mm_set1_epi32(0xffff ^ INT32_MIN);
+	__m128i extra = _mm_setzero_si128();
+	const uint32_t* start = src;
+	for (; end - src >= 4; src += 4) {
+		__m128i v = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src)), bias);
+		extra = _mm_sub_epi32(extra, _mm_cmpgt_epi32(v, limit1));
+		extra = _mm_sub_epi32(extra, _mm_cmpgt_epi32(v, limit2));
+		extra = _mm_sub_epi32(extra, _mm_cmpgt_epi32(v, limit3));
+	}
+	alignas(16) uint32_t lanes[4];
+	_mm_store_si128(reinterpret_cast<__m128i*>(lanes), extra);
+	count += (src - start) + lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+
+ZX_TARGET("sse2")
+static void EncodeUtf8SSE2(const uint32_t*& src, const uint32_t* end, char*& out)
+{
+	const __m128i bias = _mm_set1_epi32(INT32_MIN);
+	const __m128i limit1 = _mm_set1_epi32(0x7f ^ INT32_MIN);
+	const __m128i limit2 = _mm_set1_epi32(0x7ff ^ INT32_MIN);
+	while (end - src >= 8) {
+		__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+		__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 4));
+		if (_mm_movemask_epi8(_mm_cmpgt_epi32(_mm_xor_si128(_mm_or_si128(a, b), bias), limit1)) == 0) {
+			__m128i ascii = _mm_packs_epi32(a, b);
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(out), _mm_packus_epi16(ascii, ascii));
+			src += 8, out += 8;
+			continue;
+		}
+		a = _mm_xor_si128(a, bias);
+		if (_mm_movemask_epi8(_mm_cmpgt_epi32(a, limit1)) != 0xffff || _mm_movemask_epi8(_mm_cmpgt_epi32(a, limit2)))
+			break;
+		// four code points of two bytes each: 110xxxxx 10xxxxxx, offset by 0x8000 for the signed saturation of packs
+		a = _mm_xor_si128(a, bias);
+		__m128i lead = _mm_or_si128(_mm_srli_epi32(a, 6), _mm_set1_epi32(0xc0));
+		__m128i trail = _mm_or_si128(_mm_and_si128(a, _mm_set1_epi32(0x3f)), _mm_set1_epi32(0x80));
+		__m128i pairs = _mm_sub_epi32(_mm_or_si128(lead, _mm_slli_epi32(trail, 8)), _mm_set1_epi32(0x8000));
+		pairs = _mm_add_epi16(_mm_packs_epi32(pairs, pairs), _mm_set1_epi16(INT16_MIN));
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(out), pairs);
+		src += 4, out += 8;
+	}
+}
+
+ZX_TARGET("sse2")
+static void DecodeUtf8SSE2(const uint8_t*& src, const uint8_t* end, uint32_t*& out)
+{
+	const __m128i zero = _mm_setzero_si128();
+	while (end - src >= 16) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+		if (_mm_movemask_epi8(v) == 0) {
+			__m128i lo = _mm_unpacklo_epi8(v, zero), hi = _mm_unpackhi_epi8(v, zero);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi16(lo, zero));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4), _mm_unpackhi_epi16(lo, zero));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + 8), _mm_unpacklo_epi16(hi, zero));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + 12), _mm_unpackhi_epi16(hi, zero));
+			src += 16, out += 16;
+			continue;
+		}
+		// eight two byte sequences, each 16-bit lane holding 10xxxxxx 110xxxxx with a lead byte of at least 0xc2
+		__m128i pattern = _mm_cmpeq_epi16(_mm_and_si128(v, _mm_set1_epi16(static_cast<short>(0xc0e0))),
+										  _mm_set1_epi16(static_cast<short>(0x80c0)));
+		__m128i overlong = _mm_cmpeq_epi16(_mm_and_si128(v, _mm_set1_epi16(0x1e)), zero);
+		if (_mm_movemask_epi8(_mm_andnot_si128(overlong, pattern)) != 0xffff)
+			break;
+		__m128i cp = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(v, _mm_set1_epi16(0x1f)), 6),
+								  _mm_and_si128(_mm_srli_epi16(v, 8), _mm_set1_epi16(0x3f)));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi16(cp, zero));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4), _mm_unpackhi_epi16(cp, zero));
+		src += 16, out += 8;
+	}
+}
+
+#endif // ZX_HAS_X86_DISPATCH
+
+// vmaxvq/vminvq are only available on AArch64
+#if defined(ZX_HAS_NEON) && defined(__aarch64__)
+
+static void CountUtf8BytesNEON(const uint32_t*& src, const uint32_t* end, size_t& count)
+{
+	uint32x4_t extra = vdupq_n_u32(0);
+	const uint32_t* start = src;
+	for (; end - src >= 4; src += 4) {
+		uint32x4_t v = vld1q_u32(src);
+		extra = vsubq_u32(extra, vcgtq_u32(v, vdupq_n_u32(0x7f)));
+		extra = vsubq_u32(extra, vcgtq_u32(v, vdupq_n_u32(0x7ff)));
+		extra = vsubq_u32(extra, vcgtq_u32(v, vdupq_n_u32(0xffff)));
+	}
+	count += (src - start) + vgetq_lane_u32(extra, 0) + vgetq_lane_u32(extra, 1) + vgetq_lane_u32(extra, 2) +
+			 vgetq_lane_u32(extra, 3);
+}
+
+static void EncodeUtf8NEON(const uint32_t*& src, const uint32_t* end, char*& out)
+{
+	while (end - src >= 8) {
+		uint32x4_t a = vld1q_u32(src), b = vld1q_u32(src + 4);
+		uint32x4_t big = vcgtq_u32(vorrq_u32(a, b), vdupq_n_u32(0x7f));
+		if ((vgetq_lane_u64(vreinterpretq_u64_u32(big), 0) | vgetq_lane_u64(vreinterpretq_u64_u32(big), 1)) == 0) {
+			vst1_u8(reinterpret_cast<uint8_t*>(out), vmovn_u16(vcombine_u16(vmovn_u32(a), vmovn_u32(b))));
+			src += 8, out += 8;
+			continue;
+		}
+		uint32x4_t twoBytes = vandq_u32(vcgtq_u32(a, vdupq_n_u32(0x7f)), vcltq_u32(a, vdupq_n_u32(0x800)));
+		if (~(vgetq_lane_u64(vreinterpretq_u64_u32(twoBytes), 0) & vgetq_lane_u64(vreinterpretq_u64_u32(twoBytes), 1)))
+			break;
+		uint32x4_t lead = vorrq_u32(vshrq_n_u32(a, 6), vdupq_n_u32(0xc0));
+		uint32x4_t trail = vorrq_u32(vandq_u32(a, vdupq_n_u32(0x3f)), vdupq_n_u32(0x80));
+		vst1_u8(reinterpret_cast<uint8_t*>(out), vreinterpret_u8_u16(vmovn_u32(vorrq_u32(lead, vshlq_n_u32(trail, 8)))));
+		src += 4, out += 8;
+	}
+}
+
+static void DecodeUtf8NEON(const uint8_t*& src, const uint8_t* end, uint32_t*& out)
+{
+	while (end - src >= 16) {
+		uint8x16_t v = vld1q_u8(src);
+		if (vmaxvq_u8(v) < 0x80) {
+			uint16x8_t lo = vmovl_u8(vget_low_u8(v)), hi = vmovl_u8(vget_high_u8(v));
+			vst1q_u32(out, vmovl_u16(vget_low_u16(lo)));
+			vst1q_u32(out + 4, vmovl_u16(vget_high_u16(lo)));
+			vst1q_u32(out + 8, vmovl_u16(vget_low_u16(hi)));
+			vst1q_u32(out + 12, vmovl_u16(vget_high_u16(hi)));
+			src += 16, out += 16;
+			continue;
+		}
+		uint16x8_t w = vreinterpretq_u16_u8(v);
+		uint16x8_t valid = vandq_u16(vceqq_u16(vandq_u16(w, vdupq_n_u16(0xc0e0)), vdupq_n_u16(0x80c0)),
+									 vtstq_u16(w, vdupq_n_u16(0x1e)));
+		if (vminvq_u16(valid) == 0)
+			break;
+		uint16x8_t cp = vorrq_u16(vshlq_n_u16(vandq_u16(w, vdupq_n_u16(0x1f)), 6),
+								  vandq_u16(vshrq_n_u16(w, 8), vdupq_n_u16(0x3f)));
+		vst1q_u32(out, vmovl_u16(vget_low_u16(cp)));
+		vst1q_u32(out + 4, vmovl_u16(vget_high_u16(cp)));
+		src += 16, out += 8;
+	}
+}
+
+#endif // ZX_HAS_NEON && __aarch64__
+
+static void CountUtf8BytesSimd(const uint32_t*& src, const uint32_t* end, size_t& count)
+{
+#if defined(ZX_HAS_X86_DISPATCH)
+	if (CpuFeatures::HasSSE2())
+		CountUtf8BytesSSE2(src, end, count);
+#elif defined(ZX_HAS_NEON) && defined(__aarch64__)
+	if (CpuFeatures::HasNEON())
+		CountUtf8BytesNEON(src, end, count);
+#endif
+}
+
+static void EncodeUtf8Simd(const uint32_t*& src, const uint32_t* end, char*& out)
+{
+#if defined(ZX_HAS_X86_DISPATCH)
+	if (CpuFeatures::HasSSE2())
+		EncodeUtf8SSE2(src, end, out);
+#elif defined(ZX_HAS_NEON) && defined(__aarch64__)
+	if (CpuFeatures::HasNEON())
+		EncodeUtf8NEON(src, end, out);
+#endif
+}
+
+static void DecodeUtf8Simd(const uint8_t*& src, const uint8_t* end, uint32_t*& out)
+{
+#if defined(ZX_HAS_X86_DISPATCH)
+	if (CpuFeatures::HasSSE2())
+		DecodeUtf8SSE2(src, end, out);
+#elif defined(ZX_HAS_NEON) && defined(__aarch64__)
+	if (CpuFeatures::HasNEON())
+		DecodeUtf8NEON(src, end, out);
+#endif
+}
+
 template <typename WCharT>
 static void ConvertFromUtf8(const uint8_t* src, size_t length, std::basic_string<WCharT>& buffer, typename std::enable_if<(sizeof(WCharT) == 2)>::type* = nullptr)
 {
@@ -111,20 +301,28 @@ static void ConvertFromUtf8(const uint8_t* src, size_t length, std::basic_string
 template <typename WCharT>
 static void ConvertFromUtf8(const uint8_t* src, size_t length, std::basic_string<WCharT>& buffer, typename std::enable_if<(sizeof(WCharT) == 4)>::type* = nullptr)
 {
+	// every byte yields at most one code point, so write into the string directly and cut it to size afterwards
+	size_t offset = buffer.size();
+	buffer.resize(offset + length);
+	uint32_t* out = reinterpret_cast<uint32_t*>(&buffer[0] + offset);
 	const uint8_t* srcEnd = src + length;
-	size_t destLen = Utf8CountCodePoints(src, length);
-	if (destLen > 0) {
-		buffer.reserve(buffer.size() + destLen);
-		uint32_t codePoint = 0;
-		uint32_t state = kAccepted;
+	uint32_t codePoint = 0;
+	uint32_t state = kAccepted;
 
-		while (src < srcEnd) {
-			if (Utf8Decode(*src++, state, codePoint) != kAccepted) {
-				continue;
-			}
-			buffer.push_back((WCharT)codePoint);
+	size_t scalarRun = 16;
+	while (src < srcEnd) {
+		const uint8_t* start = src;
+		DecodeUtf8Simd(src, srcEnd, out);
+		// continue in the scalar loop up to a code point boundary, backing off from input the kernels can not handle
+		// (e.g. CJK text) to keep the failed attempts cheap
+		scalarRun = src != start ? 16 : std::min<size_t>(2 * scalarRun, 1024);
+		for (const uint8_t* next = src + std::min<size_t>(scalarRun, srcEnd - src);
+			 src < srcEnd && (src < next || state != kAccepted);) {
+			if (Utf8Decode(*src++, state, codePoint) == kAccepted)
+				*out++ = codePoint;
 		}
 	}
+	buffer.resize(out - reinterpret_cast<uint32_t*>(&buffer[0]));
 }
 
 
@@ -134,9 +332,12 @@ static void ConvertFromUtf8(const uint8_t* src, size_t length, std::basic_string
 template <typename WCharT>
 static size_t Utf8CountBytes(const WCharT* utf32, size_t length, typename std::enable_if<(sizeof(WCharT) == 4)>::type* = nullptr)
 {
-	int result = 0;
-	for (size_t i = 0; i < length; ++i) {
-		unsigned codePoint = (unsigned)utf32[i];
+	const uint32_t* src = reinterpret_cast<const uint32_t*>(utf32);
+	const uint32_t* end = src + length;
+	size_t result = 0;
+	CountUtf8BytesSimd(src, end, result);
+	for (; src < end; ++src) {
+		unsigned codePoint = *src;
 		if (codePoint < 0x80)
 		{
 			result += 1;
@@ -171,7 +372,7 @@ static size_t Utf8CountBytes(const WCharT* utf16, size_t length, typename std::e
 		{
 			result += 2;
 		}
-		else if (TextUtfEncoding::IsUtf16HighSurrogate(codePoint))
+		else if (i + 1 < length && TextUtfEncoding::IsUtf16HighSurrogate(codePoint) && TextUtfEncoding::IsUtf16LowSurrogate(utf16[i + 1]))
 		{
 			result += 4;
 			++i;
@@ -212,33 +413,41 @@ static int Utf8Encode(uint32_t utf32, char* out)
 	return 4;
 }
 
+// Both versions write exactly Utf8CountBytes() bytes to out.
 template <typename WCharT>
-static void ConvertToUtf8(const std::basic_string<WCharT>& str, std::string& utf8, typename std::enable_if<(sizeof(WCharT) == 2)>::type* = nullptr)
+static void ConvertToUtf8(const WCharT* str, size_t length, char* out, typename std::enable_if<(sizeof(WCharT) == 2)>::type* = nullptr)
 {
-	char buffer[4];
-	int bufLength;
-	for (size_t i = 0; i < str.length(); ++i)
+	for (size_t i = 0; i < length; ++i)
 	{
-		if (i + 1 < str.length() && TextUtfEncoding::IsUtf16HighSurrogate(str[i]) && TextUtfEncoding::IsUtf16LowSurrogate(str[i + 1]))
+		if (i + 1 < length && TextUtfEncoding::IsUtf16HighSurrogate(str[i]) && TextUtfEncoding::IsUtf16LowSurrogate(str[i + 1]))
 		{
-			bufLength = Utf8Encode(TextUtfEncoding::CodePointFromUtf16Surrogates(str[i], str[i + 1]), buffer);
+			out += Utf8Encode(TextUtfEncoding::CodePointFromUtf16Surrogates(str[i], str[i + 1]), out);
 			++i;
 		}
 		else
 		{
-			bufLength = Utf8Encode(str[i], buffer);
+			out += Utf8Encode(str[i], out);
 		}
-		utf8.append(buffer, bufLength);
 	}
 }
 
 template <typename WCharT>
-static void ConvertToUtf8(const std::basic_string<WCharT>& str, std::string& utf8, typename std::enable_if<(sizeof(WCharT) == 4)>::type* = nullptr)
+static void ConvertToUtf8(const WCharT* str, size_t length, char* out, typename std::enable_if<(sizeof(WCharT) == 4)>::type* = nullptr)
 {
-	char buffer[4];
-	for (auto c : str) {
-		auto bufLength = Utf8Encode(c, buffer);
-		utf8.append(buffer, bufLength);
+	const uint32_t* src = reinterpret_cast<const uint32_t*>(str);
+	const uint32_t* end = src + length;
+	size_t scalarRun = 8;
+	while (src < end) {
+		const uint32_t* start = src;
+		EncodeUtf8Simd(src, end, out);
+		// the block the kernel stopped at is done here, with the same back off as in ConvertFromUtf8
+		scalarRun = src != start ? 8 : std::min<size_t>(2 * scalarRun, 512);
+		for (const uint32_t* next = src + std::min<size_t>(scalarRun, end - src); src < next; ++src) {
+			if (*src < 0x80)
+				*out++ = static_cast<char>(*src);
+			else
+				out += Utf8Encode(*src, out);
+		}
 	}
 }
 
@@ -246,8 +455,19 @@ static void ConvertToUtf8(const std::basic_string<WCharT>& str, std::string& utf
 void
 TextUtfEncoding::ToUtf8(const std::wstring& str, std::string& utf8)
 {
-	utf8.reserve(str.length() + Utf8CountBytes(str.data(), str.length()));
-	ConvertToUtf8(str, utf8);
+	// size the output once and write into it directly instead of appending one code point at a time
+	size_t offset = utf8.length();
+	utf8.resize(offset + Utf8CountBytes(str.data(), str.length()));
+	ConvertToUtf8(str.data(), str.length(), &utf8[0] + offset);
+}
+
+size_t
+TextUtfEncoding::AppendUtf8(char* utf8, size_t capacity, const wchar_t* str, size_t length)
+{
+	size_t count = Utf8CountBytes(str, length);
+	if (count <= capacity)
+		ConvertToUtf8(str, length, utf8);
+	return count;
 }
 
 std::wstring
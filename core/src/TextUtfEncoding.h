@@ -31,6 +31,13 @@ public:
 	static void AppendUtf16(std::wstring& str, const uint16_t* utf16, size_t length);
 	static void AppendUtf8(std::wstring& str, const uint8_t* utf8, size_t length);
 
+	/**
+	 * Writes str as UTF-8 into the caller supplied buffer utf8 without allocating. Returns the number of bytes the
+	 * complete conversion takes (no terminating 0 is written). If that exceeds capacity nothing is written, so a call
+	 * with capacity 0 queries the size.
+	 */
+	static size_t AppendUtf8(char* utf8, size_t capacity, const wchar_t* str, size_t length);
+
 	template <typename T>
 	static bool IsUtf16HighSurrogate(T c)
 	{
@@ -1,7 +1,5 @@
-#pragma once
 /*
-* Copyright 2016 Nu-book Inc.
-* Copyright 2016 ZXing authors
+* Copyright 2021 ZXing authors
 *
 * Licensed under the Apache License, Version 2.0 (the "License");
 * you may not use this file except in compliance with the License.
@@ -16,21 +14,23 @@
 * limitations under the License.
 */
 
-#include <string>
+
+#include "Trace.h"
+
+#include <atomic>
 
 namespace ZXing {
 
-enum class DecodeStatus;
+static std::atomic<Tracer*> s_tracer(nullptr);
 
-namespace OneD {
-namespace RSS {
+void SetTracer(Tracer* tracer) noexcept
+{
+	s_tracer.store(tracer, std::memory_order_release);
+}
 
-class FieldParser
+Tracer* CurrentTracer() noexcept
 {
-public:
-	static DecodeStatus ParseFieldsInGeneralPurpose(const std::string &rawInfo, std::string& result);
-};
+	return s_tracer.load(std::memory_order_acquire);
+}
 
-} // RSS
-} // OneD
 } // ZXing
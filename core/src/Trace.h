@@ -0,0 +1,81 @@
+#pragma once
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+namespace ZXing {
+
+/**
+* Receives the begin and end of the stages of the decode pipeline (ReadBarcode, the binarizers, the readers and
+* their detectors and decoders), e.g. to show them in a perfetto or VTune timeline next to the stages of the
+* application. begin() and end() are called on the thread doing the work and nest properly per thread. The name is
+* a string literal, the same pointer is passed to both calls.
+*
+* The events are only emitted if the library was built with BUILD_TRACING (i.e. ZX_TRACING defined), otherwise the
+* trace scopes compile to nothing and SetTracer has no effect.
+*/
+class Tracer
+{
+public:
+	virtual ~Tracer() = default;
+	virtual void begin(const char* name) = 0;
+	virtual void end(const char* name) = 0;
+};
+
+/**
+* Installs the tracer for all threads, nullptr removes it. The tracer has to stay alive until it is removed and no
+* decode call started before is running anymore. Trace scopes that began with the previous tracer end with it.
+*/
+void SetTracer(Tracer* tracer) noexcept;
+
+/// Returns the installed tracer or nullptr
+Tracer* CurrentTracer() noexcept;
+
+#ifdef ZX_TRACING
+
+/// Reports the lifetime of the object as one event to the current tracer, see ZX_TRACE_SCOPE
+class TraceScope
+{
+	Tracer* _tracer;
+	const char* _name;
+
+public:
+	explicit TraceScope(const char* name) noexcept : _tracer(CurrentTracer()), _name(name)
+	{
+		if (_tracer)
+			_tracer->begin(_name);
+	}
+	~TraceScope()
+	{
+		if (_tracer)
+			_tracer->end(_name);
+	}
+
+	TraceScope(const TraceScope&) = delete;
+	TraceScope& operator=(const TraceScope&) = delete;
+};
+
+#define ZX_TRACE_CONCAT_(a, b) a##b
+#define ZX_TRACE_CONCAT(a, b) ZX_TRACE_CONCAT_(a, b)
+#define ZX_TRACE_SCOPE(name) ::ZXing::TraceScope ZX_TRACE_CONCAT(zxTraceScope, __LINE__)(name)
+
+#else
+
+#define ZX_TRACE_SCOPE(name) ((void)0)
+
+#endif
+
+} // ZXing
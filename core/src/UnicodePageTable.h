@@ -0,0 +1,61 @@
+#pragma once
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace ZXing {
+
+/**
+* Reverse lookup from BMP code points to the codes of a legacy character set, stored as 256-entry pages that are
+* indexed by the high byte of the code point. Only pages with at least one mapped code point are allocated, so an
+* encoder pays one index and one page access per character instead of searching its sorted mapping tables.
+* A code of 0 means 'not mapped', which is why none of the encoders using this table produce 0 for a mapped character.
+*/
+template <typename T>
+class UnicodePageTable
+{
+	std::array<uint16_t, 256> _pageIndex = {}; // 1-based offset into _pages, 0 = no page
+	std::vector<T> _pages;
+
+public:
+	/// Maps unicode to code unless unicode is already mapped, so the first insertion wins (like a linear search would).
+	void insert(unsigned unicode, T code)
+	{
+		if (unicode > 0xFFFF)
+			return;
+		auto& page = _pageIndex[unicode >> 8];
+		if (page == 0) {
+			_pages.resize(_pages.size() + 256);
+			page = static_cast<uint16_t>(_pages.size() / 256);
+		}
+		auto& slot = _pages[(page - 1) * 256 + (unicode & 0xFF)];
+		if (slot == 0)
+			slot = code;
+	}
+
+	T operator[](unsigned unicode) const
+	{
+		if (unicode > 0xFFFF)
+			return 0;
+		auto page = _pageIndex[unicode >> 8];
+		return page ? _pages[(page - 1) * 256 + (unicode & 0xFF)] : 0;
+	}
+};
+
+} // ZXing
@@ -0,0 +1,112 @@
+/*
+* Copyright 2020 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "ViewLuminanceSource.h"
+#include "GenericLuminanceSource.h"
+#include "ByteArray.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace ZXing {
+
+ViewLuminanceSource::ViewLuminanceSource(int width, int height, const uint8_t* bytes, int rowBytes) :
+	_bytes(bytes),
+	_width(width),
+	_height(height),
+	_rowBytes(rowBytes)
+{
+	if (width < 0 || height < 0) {
+		throw std::out_of_range("Requested size is invalid");
+	}
+}
+
+int
+ViewLuminanceSource::width() const
+{
+	return _width;
+}
+
+int
+ViewLuminanceSource::height() const
+{
+	return _height;
+}
+
+const uint8_t *
+ViewLuminanceSource::getRow(int y, ByteArray& buffer, bool forceCopy) const
+{
+	if (y < 0 || y >= _height) {
+		throw std::out_of_range("Requested row is outside the image");
+	}
+
+	const uint8_t* row = _bytes + y * _rowBytes;
+	if (!forceCopy) {
+		return row;
+	}
+
+	buffer.resize(_width);
+	std::copy_n(row, _width, buffer.begin());
+	return buffer.data();
+}
+
+const uint8_t *
+ViewLuminanceSource::getMatrix(ByteArray& buffer, int& outRowBytes, bool forceCopy) const
+{
+	if (!forceCopy) {
+		outRowBytes = _rowBytes;
+		return _bytes;
+	}
+
+	outRowBytes = _width;
+	buffer.resize(_width * _height);
+	const uint8_t* row = _bytes;
+	uint8_t* dest = buffer.data();
+	for (int y = 0; y < _height; ++y, row += _rowBytes, dest += _width) {
+		std::copy_n(row, _width, dest);
+	}
+	return buffer.data();
+}
+
+bool
+ViewLuminanceSource::canCrop() const
+{
+	return true;
+}
+
+std::shared_ptr<LuminanceSource>
+ViewLuminanceSource::cropped(int left, int top, int width, int height) const
+{
+	if (left < 0 || top < 0 || width < 0 || height < 0 || left + width > _width || top + height > _height) {
+		throw std::out_of_range("Crop rectangle does not fit within image data.");
+	}
+	return std::make_shared<ViewLuminanceSource>(width, height, _bytes + top * _rowBytes + left, _rowBytes);
+}
+
+bool
+ViewLuminanceSource::canRotate() const
+{
+	return true;
+}
+
+std::shared_ptr<LuminanceSource>
+ViewLuminanceSource::rotated(int degreeCW) const
+{
+	// rotation needs a copy anyway, it is made straight from the viewed pixels
+	return GenericLuminanceSource::Rotated(_width, _height, _bytes, _rowBytes, degreeCW);
+}
+
+} // ZXing
@@ -0,0 +1,54 @@
+#pragma once
+/*
+* Copyright 2020 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "LuminanceSource.h"
+
+#include <cstdint>
+#include <memory>
+
+namespace ZXing {
+
+/**
+* A non-owning LuminanceSource on top of 8-bit grayscale image data in memory. In contrast to
+* GenericLuminanceSource, the pixels are neither copied nor converted, so the caller has to keep
+* the image data alive and unmodified for the whole lifetime of the source (and all binarizers using it).
+*/
+class ViewLuminanceSource : public LuminanceSource
+{
+public:
+	/**
+	* Init with a grayscale source, 'bytes' points to the top left pixel of the (sub)image.
+	*/
+	ViewLuminanceSource(int width, int height, const uint8_t* bytes, int rowBytes);
+
+	virtual int width() const override;
+	virtual int height() const override;
+	virtual const uint8_t* getRow(int y, ByteArray& buffer, bool forceCopy = false) const override;
+	virtual const uint8_t* getMatrix(ByteArray& buffer, int& outRowBytes, bool forceCopy = false) const override;
+	virtual bool canCrop() const override;
+	virtual std::shared_ptr<LuminanceSource> cropped(int left, int top, int width, int height) const override;
+	virtual bool canRotate() const override;
+	virtual std::shared_ptr<LuminanceSource> rotated(int degreeCW) const override;
+
+private:
+	const uint8_t* _bytes;
+	int _width;
+	int _height;
+	int _rowBytes;
+};
+
+} // ZXing
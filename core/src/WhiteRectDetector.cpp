@@ -19,19 +19,16 @@
 #include "BitMatrix.h"
 #include "ZXNumeric.h"
 #include "ResultPoint.h"
+#include "RunLengthIndex.h"
 
 namespace ZXing {
 
 static const int INIT_SIZE = 10;
 static const int CORR = 1;
 
-bool WhiteRectDetector::Detect(const BitMatrix& image, ResultPoint& p0, ResultPoint& p1, ResultPoint& p2, ResultPoint& p3)
-{
-	return Detect(image, INIT_SIZE, image.width() / 2, image.height() / 2, p0, p1, p2, p3);
-}
-
 /**
-* Determines whether a segment contains a black point
+* Determines whether a segment contains a black point. Rows are checked a word at a time, columns with the run
+* lengths if they are available.
 *
 * @param a          min value of the scanned coordinate
 * @param b          max value of the scanned coordinate
@@ -39,23 +36,21 @@ bool WhiteRectDetector::Detect(const BitMatrix& image, ResultPoint& p0, ResultPo
 * @param horizontal set to true if scan must be horizontal, false if vertical
 * @return true if a black point has been found, else false.
 */
-static bool ContainsBlackPoint(const BitMatrix& image, int a, int b, int fixed, bool horizontal) {
+static bool ContainsBlackPoint(const BitMatrix& image, const RunLengthIndex* runs, int a, int b, int fixed,
+							   bool horizontal)
+{
+	if (horizontal)
+		return !image.isRowRange(fixed, a, b + 1, false);
 
-	if (horizontal) {
-		for (int x = a; x <= b; x++) {
-			if (image.get(x, fixed)) {
-				return true;
-			}
-		}
-	}
-	else {
-		for (int y = a; y <= b; y++) {
-			if (image.get(fixed, y)) {
-				return true;
-			}
+	if (runs)
+		return runs->columnHasBlack(fixed, a, b + 1);
+
+	auto column = image.columnView(fixed);
+	for (int y = a; y <= b; y++) {
+		if (column[y]) {
+			return true;
 		}
 	}
-
 	return false;
 }
 
@@ -134,7 +129,8 @@ static void CenterEdges(const ResultPoint& y, const ResultPoint& z, const Result
 *         leftmost and the third, the rightmost
 * @throws NotFoundException if no Data Matrix Code can be found
 */
-bool WhiteRectDetector::Detect(const BitMatrix& image, int initSize, int x, int y, ResultPoint& p0, ResultPoint& p1, ResultPoint& p2, ResultPoint& p3)
+static bool DetectImpl(const BitMatrix& image, const RunLengthIndex* runs, int initSize, int x, int y, ResultPoint& p0,
+					   ResultPoint& p1, ResultPoint& p2, ResultPoint& p3)
 {
 	int height = image.height();
 	int width = image.width();
@@ -165,7 +161,7 @@ bool WhiteRectDetector::Detect(const BitMatrix& image, int initSize, int x, int
 		// .....
 		bool rightBorderNotWhite = true;
 		while ((rightBorderNotWhite || !atLeastOneBlackPointFoundOnRight) && right < width) {
-			rightBorderNotWhite = ContainsBlackPoint(image, up, down, right, false);
+			rightBorderNotWhite = ContainsBlackPoint(image, runs, up, down, right, false);
 			if (rightBorderNotWhite) {
 				right++;
 				aBlackPointFoundOnBorder = true;
@@ -186,7 +182,7 @@ bool WhiteRectDetector::Detect(const BitMatrix& image, int initSize, int x, int
 		// .___.
 		bool bottomBorderNotWhite = true;
 		while ((bottomBorderNotWhite || !atLeastOneBlackPointFoundOnBottom) && down < height) {
-			bottomBorderNotWhite = ContainsBlackPoint(image, left, right, down, true);
+			bottomBorderNotWhite = ContainsBlackPoint(image, runs, left, right, down, true);
 			if (bottomBorderNotWhite) {
 				down++;
 				aBlackPointFoundOnBorder = true;
@@ -207,7 +203,7 @@ bool WhiteRectDetector::Detect(const BitMatrix& image, int initSize, int x, int
 		// .....
 		bool leftBorderNotWhite = true;
 		while ((leftBorderNotWhite || !atLeastOneBlackPointFoundOnLeft) && left >= 0) {
-			leftBorderNotWhite = ContainsBlackPoint(image, up, down, left, false);
+			leftBorderNotWhite = ContainsBlackPoint(image, runs, up, down, left, false);
 			if (leftBorderNotWhite) {
 				left--;
 				aBlackPointFoundOnBorder = true;
@@ -228,7 +224,7 @@ bool WhiteRectDetector::Detect(const BitMatrix& image, int initSize, int x, int
 		// .....
 		bool topBorderNotWhite = true;
 		while ((topBorderNotWhite || !atLeastOneBlackPointFoundOnTop) && up >= 0) {
-			topBorderNotWhite = ContainsBlackPoint(image, left, right, up, true);
+			topBorderNotWhite = ContainsBlackPoint(image, runs, left, right, up, true);
 			if (topBorderNotWhite) {
 				up--;
 				aBlackPointFoundOnBorder = true;
@@ -305,4 +301,22 @@ bool WhiteRectDetector::Detect(const BitMatrix& image, int initSize, int x, int
 	}
 }
 
+bool WhiteRectDetector::Detect(const BitMatrix& image, int initSize, int x, int y, ResultPoint& p0, ResultPoint& p1,
+							   ResultPoint& p2, ResultPoint& p3)
+{
+	return DetectImpl(image, nullptr, initSize, x, y, p0, p1, p2, p3);
+}
+
+bool WhiteRectDetector::Detect(const BitMatrix& image, ResultPoint& p0, ResultPoint& p1, ResultPoint& p2,
+							   ResultPoint& p3)
+{
+	return DetectImpl(image, nullptr, INIT_SIZE, image.width() / 2, image.height() / 2, p0, p1, p2, p3);
+}
+
+bool WhiteRectDetector::Detect(const BitMatrix& image, const RunLengthIndex& runs, ResultPoint& p0, ResultPoint& p1,
+							   ResultPoint& p2, ResultPoint& p3)
+{
+	return DetectImpl(image, &runs, INIT_SIZE, image.width() / 2, image.height() / 2, p0, p1, p2, p3);
+}
+
 } // ZXing
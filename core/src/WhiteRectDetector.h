@@ -20,6 +20,7 @@ namespace ZXing {
 
 class BitMatrix;
 class ResultPoint;
+class RunLengthIndex;
 
 /**
 * <p>
@@ -54,6 +55,10 @@ public:
 	*/
 	static bool Detect(const BitMatrix& image, int initSize, int x, int y, ResultPoint& p0, ResultPoint& p1, ResultPoint& p2, ResultPoint& p3);
 	static bool Detect(const BitMatrix& image, ResultPoint& p0, ResultPoint& p1, ResultPoint& p2, ResultPoint& p3);
+
+	/// Same as above, with the run lengths of the image for checking the columns
+	static bool Detect(const BitMatrix& image, const RunLengthIndex& runs, ResultPoint& p0, ResultPoint& p1,
+					   ResultPoint& p2, ResultPoint& p3);
 };
 
 } // ZXing
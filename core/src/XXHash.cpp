@@ -0,0 +1,95 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "XXHash.h"
+
+namespace ZXing {
+
+static constexpr uint64_t PRIME1 = 0x9E3779B185EBCA87ULL;
+static constexpr uint64_t PRIME2 = 0xC2B2AE3D27D4EB4FULL;
+static constexpr uint64_t PRIME3 = 0x165667B19E3779F9ULL;
+static constexpr uint64_t PRIME4 = 0x85EBCA77C2B2AE63ULL;
+static constexpr uint64_t PRIME5 = 0x27D4EB2F165667C5ULL;
+
+static inline uint64_t RotL(uint64_t x, int r)
+{
+	return (x << r) | (x >> (64 - r));
+}
+
+// the hash is defined on little endian words, compilers turn these into a single load on little endian CPUs
+static inline uint32_t Read32(const uint8_t* p)
+{
+	return uint32_t(p[0]) | uint32_t(p[1]) << 8 | uint32_t(p[2]) << 16 | uint32_t(p[3]) << 24;
+}
+
+static inline uint64_t Read64(const uint8_t* p)
+{
+	return uint64_t(Read32(p)) | uint64_t(Read32(p + 4)) << 32;
+}
+
+static inline uint64_t Round(uint64_t acc, uint64_t input)
+{
+	return RotL(acc + input * PRIME2, 31) * PRIME1;
+}
+
+static inline uint64_t MergeRound(uint64_t acc, uint64_t val)
+{
+	return (acc ^ Round(0, val)) * PRIME1 + PRIME4;
+}
+
+uint64_t XXHash64(const void* data, size_t size, uint64_t seed)
+{
+	auto p = static_cast<const uint8_t*>(data);
+	const uint8_t* end = p + size;
+	uint64_t h;
+
+	if (size >= 32) {
+		uint64_t v1 = seed + PRIME1 + PRIME2, v2 = seed + PRIME2, v3 = seed, v4 = seed - PRIME1;
+		for (const uint8_t* limit = end - 32; p <= limit; p += 32) {
+			v1 = Round(v1, Read64(p));
+			v2 = Round(v2, Read64(p + 8));
+			v3 = Round(v3, Read64(p + 16));
+			v4 = Round(v4, Read64(p + 24));
+		}
+		h = RotL(v1, 1) + RotL(v2, 7) + RotL(v3, 12) + RotL(v4, 18);
+		h = MergeRound(h, v1);
+		h = MergeRound(h, v2);
+		h = MergeRound(h, v3);
+		h = MergeRound(h, v4);
+	}
+	else {
+		h = seed + PRIME5;
+	}
+
+	h += size;
+	for (; p + 8 <= end; p += 8)
+		h = RotL(h ^ Round(0, Read64(p)), 27) * PRIME1 + PRIME4;
+	if (p + 4 <= end) {
+		h = RotL(h ^ (Read32(p) * PRIME1), 23) * PRIME2 + PRIME3;
+		p += 4;
+	}
+	for (; p < end; ++p)
+		h = RotL(h ^ (*p * PRIME5), 11) * PRIME1;
+
+	h ^= h >> 33;
+	h *= PRIME2;
+	h ^= h >> 29;
+	h *= PRIME3;
+	h ^= h >> 32;
+	return h;
+}
+
+} // ZXing
@@ -0,0 +1,32 @@
+#pragma once
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ZXing {
+
+/**
+* The 64-bit xxHash (XXH64) of size bytes at data, bit-exact with the reference implementation. It processes four
+* independent 8-byte lanes per 32-byte stripe, which keeps the multipliers of a CPU busy without explicit SIMD, at
+* several GB/s. Not a cryptographic hash: it identifies repeated content (see DecodeHints::resultCacheSize), it does
+* not protect against deliberate collisions.
+*/
+uint64_t XXHash64(const void* data, size_t size, uint64_t seed = 0);
+
+} // ZXing
@@ -18,7 +18,8 @@
 #define ZX_HAVE_CONFIG
 
 // Thread local or static memory may be used to reduce the number of (re-)allocations of temporary variables
-// in e.g. the ReedSolomonDecoder. It is disabled by default. It can be enabled by modifying the following define.
+// in e.g. the ReedSolomonDecoder or the QR Code decoder. It is disabled by default. It can be enabled by modifying
+// the following define.
 // Note: The Apple clang compiler until XCode 8 does not support c++11's thread_local.
 // The alternative 'static' makes the code thread unsafe.
 #define ZX_THREAD_LOCAL // 'thread_local' or 'static'
@@ -27,11 +28,13 @@
 // of information either in one bit or one byte. Storing it in one byte is considerably faster, while obviously
 // using more memory. The effect of the memory usage while running the TestRunner is virtually invisible.
 // On embedded/mobile systems this might be of importance. Note: the BitMatrix in 'fast' mode still requires
-// only 1/3 of the same image in RGB.
-#define ZX_FAST_BIT_STORAGE // undef to disable
+// only 1/3 of the same image in RGB. The packed layout is selected by building with BUILD_PACKED_BIT_STORAGE
+// (i.e. defining ZX_PACKED_BIT_STORAGE), its hot operations work on whole 32-bit words at a time.
+#ifndef ZX_PACKED_BIT_STORAGE
+#define ZX_FAST_BIT_STORAGE
+#endif
 
-// There is a faster and simpler approach to how the ODRowReaders work available. This is currently a WIP and
-// disabled by default. This would ultimately lead to a substantial performance improvement, once every RowReader
-// has been ported. E.g. the new Codabar implementation, that actually decodes one row of the image, is about
-// 10x faster than the original one.
-//#define ZX_USE_NEW_ROW_READERS
+// There is a faster and simpler approach to how the ODRowReaders work available. Every RowReader now implements
+// decodePattern, which works on the run lengths of a row (PatternView) instead of a BitArray. E.g. the new Codabar
+// implementation, that actually decodes one row of the image, is about 10x faster than the original one.
+#define ZX_USE_NEW_ROW_READERS // undef to use the BitArray based decodeRow implementations
@@ -16,18 +16,23 @@
 */
 
 #include "AZDecoder.h"
+#include "BitSource.h"
 #include "AZDetectorResult.h"
+#include "DecodeStats.h"
 #include "DecoderResult.h"
 #include "ReedSolomonDecoder.h"
 #include "GenericGF.h"
 #include "DecodeStatus.h"
 #include "BitMatrix.h"
 #include "TextDecoder.h"
+#include "Trace.h"
 #include "ZXTestSupport.h"
 
 #include <algorithm>
+#include <array>
 #include <cstdint>
 #include <cstring>
+#include <mutex>
 #include <numeric>
 #include <string>
 #include <vector>
@@ -75,14 +80,19 @@ inline static int TotalBitsInLayer(int layers, bool compact)
 }
 
 /**
-* Gets the array of bits from an Aztec Code matrix
-*
-* @return the array of bits
+* Position of a module in the symbol, the largest one (32 layers) is 151 modules wide.
 */
-static std::vector<bool> ExtractBits(const DetectorResult& ddata)
+struct ModulePos
+{
+	uint8_t x, y;
+};
+
+/**
+* Computes the positions of the data bits of an Aztec Code matrix, in the order in which they are read, i.e.
+* layer by layer from the outside in.
+*/
+static std::vector<ModulePos> ComputeBitPositions(bool compact, int layers)
 {
-	bool compact = ddata.isCompact();
-	int layers = ddata.nbLayers();
 	int baseMatrixSize = (compact ? 11 : 14) + layers * 4; // not including alignment lines
 	std::vector<int> alignmentMap(baseMatrixSize, 0);
 
@@ -99,8 +109,10 @@ static std::vector<bool> ExtractBits(const DetectorResult& ddata)
 			alignmentMap[origCenter + i] = center + newOffset + 1;
 		}
 	}
-	auto& matrix = ddata.bits();
-	std::vector<bool> rawbits(TotalBitsInLayer(layers, compact));
+	auto pos = [&alignmentMap](int x, int y) {
+		return ModulePos{static_cast<uint8_t>(alignmentMap[x]), static_cast<uint8_t>(alignmentMap[y])};
+	};
+	std::vector<ModulePos> positions(TotalBitsInLayer(layers, compact));
 	for (int i = 0, rowOffset = 0; i < layers; i++) {
 		int rowSize = (layers - i) * 4 + (compact ? 9 : 12);
 		// The top-left most point of this layer is <low, low> (not including alignment lines)
@@ -112,43 +124,68 @@ static std::vector<bool> ExtractBits(const DetectorResult& ddata)
 			int columnOffset = j * 2;
 			for (int k = 0; k < 2; k++) {
 				// left column
-				rawbits[rowOffset + columnOffset + k] =
-					matrix.get(alignmentMap[low + k], alignmentMap[low + j]);
+				positions[rowOffset + columnOffset + k] = pos(low + k, low + j);
 				// bottom row
-				rawbits[rowOffset + 2 * rowSize + columnOffset + k] =
-					matrix.get(alignmentMap[low + j], alignmentMap[high - k]);
+				positions[rowOffset + 2 * rowSize + columnOffset + k] = pos(low + j, high - k);
 				// right column
-				rawbits[rowOffset + 4 * rowSize + columnOffset + k] =
-					matrix.get(alignmentMap[high - k], alignmentMap[high - j]);
+				positions[rowOffset + 4 * rowSize + columnOffset + k] = pos(high - k, high - j);
 				// top row
-				rawbits[rowOffset + 6 * rowSize + columnOffset + k] =
-					matrix.get(alignmentMap[high - j], alignmentMap[low + k]);
+				positions[rowOffset + 6 * rowSize + columnOffset + k] = pos(high - j, low + k);
 			}
 		}
 		rowOffset += rowSize * 8;
 	}
-	return rawbits;
+	return positions;
 }
 
 /**
-* Reads a code of given length and at given index in an array of bits
+* The bit positions only depend on the symbol type and the number of layers, so they are computed once for each
+* of the 4 compact and 32 full range sizes on first use.
 */
-static int ReadCode(const std::vector<bool>& rawbits, int startIndex, int length)
+static const std::vector<ModulePos>* BitPositions(bool compact, int layers)
 {
-	int res = 0;
-	for (int i = startIndex; i < startIndex + length; i++) {
-		res = (res << 1) | static_cast<int>(rawbits[i]);
+	static constexpr int MAX_COMPACT_LAYERS = 4;
+	static constexpr int MAX_LAYERS = 32;
+	static std::array<std::once_flag, MAX_COMPACT_LAYERS + MAX_LAYERS> once;
+	static std::array<std::vector<ModulePos>, MAX_COMPACT_LAYERS + MAX_LAYERS> positions;
+
+	if (layers < 1 || layers > (compact ? MAX_COMPACT_LAYERS : MAX_LAYERS))
+		return nullptr;
+	int i = compact ? layers - 1 : MAX_COMPACT_LAYERS + layers - 1;
+	std::call_once(once[i], [&] { positions[i] = ComputeBitPositions(compact, layers); });
+	return &positions[i];
+}
+
+/**
+* Reads the codewords of the given size from an Aztec Code matrix. The first (total bits % codewordSize) bits
+* are not part of any codeword.
+*/
+static std::vector<int> ExtractCodewords(const DetectorResult& ddata, int codewordSize)
+{
+	auto positions = BitPositions(ddata.isCompact(), ddata.nbLayers());
+	if (!positions)
+		return {};
+
+	auto& matrix = ddata.bits();
+	std::vector<int> codewords(Size(*positions) / codewordSize);
+	auto pos = positions->begin() + Size(*positions) % codewordSize;
+	for (int& codeword : codewords) {
+		int value = 0;
+		for (int bit = 0; bit < codewordSize; ++bit, ++pos)
+			value = (value << 1) | static_cast<int>(matrix.get(pos->x, pos->y));
+		codeword = value;
 	}
-	return res;
+	return codewords;
 }
 
 /**
-* <p>Performs RS error correction on an array of bits.</p>
+* <p>Performs RS error correction on the codewords of an Aztec Code matrix and removes the bit stuffing.</p>
 *
-* @return the corrected array
-* @throws FormatException if the input contains too many errors
+* @param correctedBytes the corrected data bits packed into bytes, most significant bit first
+* @param numBits the number of corrected data bits
+* @return false if the input contains too many errors
 */
-static bool CorrectBits(const DetectorResult& ddata, const std::vector<bool>& rawbits, std::vector<bool>& correctedBits)
+static bool CorrectBits(const DetectorResult& ddata, ByteArray& correctedBytes, int& numBits)
 {
 	const GenericGF* gf = nullptr;
 	int codewordSize;
@@ -171,19 +208,13 @@ static bool CorrectBits(const DetectorResult& ddata, const std::vector<bool>& ra
 	}
 
 	int numDataCodewords = ddata.nbDatablocks();
-	int numCodewords = Size(rawbits) / codewordSize;
-	if (numCodewords < numDataCodewords) {
+	std::vector<int> dataWords = ExtractCodewords(ddata, codewordSize);
+	int numCodewords = Size(dataWords);
+	if (numCodewords == 0 || numCodewords < numDataCodewords) {
 		return false;
 	}
-	int offset = rawbits.size() % codewordSize;
 	int numECCodewords = numCodewords - numDataCodewords;
 
-	
-	std::vector<int> dataWords(numCodewords);
-	for (int i = 0; i < numCodewords; i++, offset += codewordSize) {
-		dataWords[i] = ReadCode(rawbits, offset, codewordSize);
-	}
-
 	if (!ReedSolomonDecoder::Decode(*gf, dataWords, numECCodewords))
 		return false;
 
@@ -200,22 +231,31 @@ static bool CorrectBits(const DetectorResult& ddata, const std::vector<bool>& ra
 			stuffedBits++;
 		}
 	}
-	// Now, actually unpack the bits and remove the stuffing
-	correctedBits.resize(numDataCodewords * codewordSize - stuffedBits);
-	int index = 0;
+	// Now, actually unpack the bits and remove the stuffing. The codewords are collected in a 64 bit accumulator
+	// and written out byte by byte.
+	numBits = numDataCodewords * codewordSize - stuffedBits;
+	correctedBytes = ByteArray((numBits + 7) / 8);
+	auto out = correctedBytes.begin();
+	uint64_t acc = 0;
+	int accBits = 0;
 	for (int i = 0; i < numDataCodewords; i++) {
 		int dataWord = dataWords[i];
 		if (dataWord == 1 || dataWord == mask - 1) {
-			// next codewordSize-1 bits are all zeros or all ones
-			std::fill_n(correctedBits.begin() + index, codewordSize - 1, dataWord > 1);
-			index += codewordSize - 1;
+			// next codewordSize-1 bits are all zeros or all ones, which is the dataWord without its last bit
+			acc = (acc << (codewordSize - 1)) | (dataWord >> 1);
+			accBits += codewordSize - 1;
 		}
 		else {
-			for (int bit = codewordSize - 1; bit >= 0; --bit) {
-				correctedBits[index++] = (dataWord & (1 << bit)) != 0;
-			}
+			acc = (acc << codewordSize) | dataWord;
+			accBits += codewordSize;
+		}
+		while (accBits >= 8) {
+			accBits -= 8;
+			*out++ = static_cast<uint8_t>(acc >> accBits);
 		}
 	}
+	if (accBits > 0)
+		*out = static_cast<uint8_t>(acc << (8 - accBits));
 	return true;
 }
 
@@ -268,66 +308,97 @@ static const char* GetCharacter(Table table, int code)
 }
 
 /**
-* Gets the string encoded in the aztec code bits
+* The meaning of a code in one of the character tables: either the text it stands for or, if text is nullptr, a
+* shift (or latch) to another table.
+*/
+struct CodeEntry
+{
+	const char* text;
+	Table table;
+	bool latch;
+};
+
+/**
+* The CodeEntry of each of the (up to) 32 codes of the 5 character tables, parsed once from the string tables.
+*/
+static const std::array<std::array<CodeEntry, 32>, 5>& CodeTables()
+{
+	static const auto tables = [] {
+		std::array<std::array<CodeEntry, 32>, 5> res = {};
+		for (auto table : {Table::UPPER, Table::LOWER, Table::MIXED, Table::PUNCT, Table::DIGIT}) {
+			int numCodes = table == Table::DIGIT ? 16 : 32;
+			for (int code = 0; code < numCodes; ++code) {
+				const char* str = GetCharacter(table, code);
+				auto& entry = res[static_cast<int>(table)][code];
+				if (std::strncmp(str, "CTRL_", 5) == 0)
+					entry = {nullptr, GetTable(str[5]), str[6] == 'L'};
+				else
+					entry = {str, table, false};
+			}
+		}
+		return res;
+	}();
+	return tables;
+}
+
+/**
+* Gets the string encoded in the first numBits bits of the corrected aztec code bytes
 *
 * @return the decoded string
 */
-ZXING_EXPORT_TEST_ONLY
-std::string GetEncodedData(const std::vector<bool>& correctedBits)
+static std::string GetEncodedData(const ByteArray& bytes, int numBits)
 {
-	int endIndex = Size(correctedBits);
+	DecodeStats::StageTimer timer(DecodeStats::Stage::DecodeText);
+	const auto& codeTables = CodeTables();
+	BitSource bits(bytes);
+	// the last byte is padded with 0s, which are not part of the data
+	int padding = 8 * Size(bytes) - numBits;
+	auto remaining = [&bits, padding] { return bits.available() - padding; };
 	Table latchTable = Table::UPPER; // table most recently latched to
 	Table shiftTable = Table::UPPER; // table to use for the next read
 	std::string result;
-	result.reserve(20);
-	int index = 0;
-	while (index < endIndex) {
+	result.reserve(numBits / 5);
+	while (remaining() > 0) {
 		if (shiftTable == Table::BINARY) {
-			if (endIndex - index < 5) {
+			if (remaining() < 5) {
 				break;
 			}
-			int length = ReadCode(correctedBits, index, 5);
-			index += 5;
+			int length = bits.readBits(5);
 			if (length == 0) {
-				if (endIndex - index < 11) {
+				if (remaining() < 11) {
 					break;
 				}
-				length = ReadCode(correctedBits, index, 11) + 31;
-				index += 11;
+				length = bits.readBits(11) + 31;
 			}
 			for (int charCount = 0; charCount < length; charCount++) {
-				if (endIndex - index < 8) {
-					index = endIndex;  // Force outer loop to exit
-					break;
+				if (remaining() < 8) {
+					return result;
 				}
-				int code = ReadCode(correctedBits, index, 8);
+				int code = bits.readBits(8);
 				result.push_back((char)code);
-				index += 8;
 			}
 			// Go back to whatever mode we had been in
 			shiftTable = latchTable;
 		}
 		else {
 			int size = shiftTable == Table::DIGIT ? 4 : 5;
-			if (endIndex - index < size) {
+			if (remaining() < size) {
 				break;
 			}
-			int code = ReadCode(correctedBits, index, size);
-			index += size;
-			const char* str = GetCharacter(shiftTable, code);
-			if (std::strncmp(str, "CTRL_", 5) == 0) {
+			const CodeEntry& entry = codeTables[static_cast<int>(shiftTable)][bits.readBits(size)];
+			if (entry.text == nullptr) {
 				// Table changes
 				// ISO/IEC 24778:2008 prescibes ending a shift sequence in the mode from which it was invoked.
 				// That's including when that mode is a shift.
 				// Our test case dlusbs.png for issue #642 exercises that.
 				latchTable = shiftTable;  // Latch the current mode, so as to return to Upper after U/S B/S
-				shiftTable = GetTable(str[5]);
-				if (str[6] == 'L') {
+				shiftTable = entry.table;
+				if (entry.latch) {
 					latchTable = shiftTable;
 				}
 			}
 			else {
-				result.append(str);
+				result.append(entry.text);
 				// Go back to whatever mode we had been in
 				shiftTable = latchTable;
 			}
@@ -336,38 +407,42 @@ std::string GetEncodedData(const std::vector<bool>& correctedBits)
 	return result;
 }
 
+#ifdef ZXING_BUILD_FOR_TEST
+
 /**
-* Reads a code of length 8 in an array of bits, padding with zeros
+* Packs a bit array into bytes, most significant bit first
 */
-static uint8_t ReadByte(const std::vector<bool>& rawbits, int startIndex)
+static ByteArray ConvertBoolArrayToByteArray(const std::vector<bool>& boolArr)
 {
-	int n = Size(rawbits) - startIndex;
-	if (n >= 8) {
-		return static_cast<uint8_t>(ReadCode(rawbits, startIndex, 8));
+	ByteArray byteArr((Size(boolArr) + 7) / 8);
+	for (int i = 0; i < Size(boolArr); ++i) {
+		if (boolArr[i])
+			byteArr[i / 8] |= static_cast<uint8_t>(0x80 >> (i % 8));
 	}
-	return static_cast<uint8_t>(ReadCode(rawbits, startIndex, n) << (8 - n));
+	return byteArr;
 }
 
 /**
-* Packs a bit array into bytes, most significant bit first
+* Gets the string encoded in the aztec code bits
+*
+* @return the decoded string
 */
-static ByteArray ConvertBoolArrayToByteArray(const std::vector<bool>& boolArr)
+ZXING_EXPORT_TEST_ONLY
+std::string GetEncodedData(const std::vector<bool>& correctedBits)
 {
-	ByteArray byteArr(((int)boolArr.size() + 7) / 8);
-	for (int i = 0; i < Size(byteArr); ++i) {
-		byteArr[i] = ReadByte(boolArr, 8 * i);
-	}
-	return byteArr;
+	return GetEncodedData(ConvertBoolArrayToByteArray(correctedBits), Size(correctedBits));
 }
 
+#endif // ZXING_BUILD_FOR_TEST
+
 DecoderResult Decoder::Decode(const DetectorResult& detectorResult)
 {
-	std::vector<bool> rawbits = ExtractBits(detectorResult);
-	std::vector<bool> correctedBits;
-	if (CorrectBits(detectorResult, rawbits, correctedBits)) {
-		return DecoderResult(ConvertBoolArrayToByteArray(correctedBits),
-							 TextDecoder::FromLatin1(GetEncodedData(correctedBits)))
-		        .setNumBits(Size(correctedBits));
+	ZX_TRACE_SCOPE("Aztec::Decoder::Decode");
+	ByteArray correctedBytes;
+	int numBits = 0;
+	if (CorrectBits(detectorResult, correctedBytes, numBits)) {
+		std::string text = GetEncodedData(correctedBytes, numBits);
+		return DecoderResult(std::move(correctedBytes), TextDecoder::FromLatin1(text)).setNumBits(numBits);
 	}
 	else {
 		return DecodeStatus::FormatError;
@@ -25,9 +25,17 @@
 #include "WhiteRectDetector.h"
 #include "GridSampler.h"
 #include "BitMatrix.h"
+#include "Deadline.h"
+#include "Pattern.h"
+#include "Trace.h"
+#include "ZXContainerAlgorithms.h"
 
+#include <algorithm>
 #include <array>
+#include <cmath>
+#include <numeric>
 #include <utility>
+#include <vector>
 
 namespace ZXing {
 namespace Aztec {
@@ -294,7 +302,7 @@ static PointI GetFirstDifferent(const BitMatrix& image, const PointI& init, bool
 	int x = init.x + dx;
 	int y = init.y + dy;
 
-	while (IsValidPoint(x, y, image.width(), image.height()) && image.get(x, y) == color) {
+	while (IsValidPoint(x, y, image.width(), image.height()) && image.rowView(y)[x] == color) {
 		x += dx;
 		y += dy;
 	}
@@ -302,12 +310,12 @@ static PointI GetFirstDifferent(const BitMatrix& image, const PointI& init, bool
 	x -= dx;
 	y -= dy;
 
-	while (IsValidPoint(x, y, image.width(), image.height()) && image.get(x, y) == color) {
+	while (IsValidPoint(x, y, image.width(), image.height()) && image.rowView(y)[x] == color) {
 		x += dx;
 	}
 	x -= dx;
 
-	while (IsValidPoint(x, y, image.width(), image.height()) && image.get(x, y) == color) {
+	while (IsValidPoint(x, y, image.width(), image.height()) && image.rowView(y)[x] == color) {
 		y += dy;
 	}
 	y -= dy;
@@ -475,19 +483,210 @@ static ZXing::DetectorResult SampleGrid(const BitMatrix& image, const ResultPoin
 										   {topLeft, topRight, bottomRight, bottomLeft}});
 }
 
-DetectorResult Detector::Detect(const BitMatrix& image, bool isMirror)
+/**
+* Counts the pixels of the given color, starting next to p and walking in direction d.
+*/
+static int RunLength(const BitMatrix& image, PointI p, PointI d, bool color, int maxLength)
+{
+	int length = 0;
+	for (p = p + d; length < maxLength && IsValidPoint(p.x, p.y, image.width(), image.height()) && image.rowView(p.y)[p.x] == color;
+		 p = p + d)
+		++length;
+	return length;
+}
+
+static bool IsModule(float length, float moduleSize)
+{
+	return std::abs(length - moduleSize) <= std::max(1.f, moduleSize / 2);
+}
+
+/**
+* Checks the bull's eye core (a black module inside white, black and white rings) along the line through center in
+* direction d and moves center to the middle of the black center module on that line.
+*/
+static bool CheckBullsEyeLine(const BitMatrix& image, PointI& center, PointI d, float moduleSize)
+{
+	int maxLength = static_cast<int>(2 * moduleSize) + 2;
+	int back = RunLength(image, center, {-d.x, -d.y}, true, maxLength);
+	int forward = RunLength(image, center, d, true, maxLength);
+	if (!IsModule(static_cast<float>(back + forward + 1), moduleSize))
+		return false;
+
+	for (int dir : {-1, 1}) {
+		PointI dd = {dir * d.x, dir * d.y};
+		PointI p = center + (dir < 0 ? back : forward) * dd;
+		bool color = false;
+		for (int ring = 0; ring < 3; ++ring, color = !color) {
+			int length = RunLength(image, p, dd, color, maxLength);
+			if (!IsModule(static_cast<float>(length), moduleSize))
+				return false;
+			p = p + length * dd;
+		}
+	}
+
+	center = center + ((forward - back) / 2) * d;
+	return true;
+}
+
+struct BullsEyeCandidate
+{
+	PointI center;
+	float moduleSize;
+	int count;
+	int row; // the row the center was found in
+};
+
+/**
+* Scans the run-length encoded rows for the 1:1:1:1:1:1:1 signature of the white/black rings around the black center
+* module of a bull's eye, confirms each match in the column and the row through its center and merges the matches of
+* the same bull's eye. The candidates that were matched in the most rows come first. Only every scanStride-th row
+* is scanned.
+*/
+static std::vector<BullsEyeCandidate> FindBullsEyeCenters(const BitMatrix& image, int scanStride)
+{
+	std::vector<BullsEyeCandidate> res;
+	// the largest module size of all candidates, it bounds how far above the current row a matching one can start
+	float maxModuleSize = 0;
+	PatternRow runs;
+	for (int y = 0; y < image.height(); y += std::max(1, scanStride)) {
+		GetPatternRow(image, y, runs);
+		// runs start with a white one, so the black ones have odd indices, x is where the one at i starts
+		for (int i = 5, x = std::accumulate(runs.begin(), runs.begin() + std::min(5, Size(runs)), 0);
+			 i + 4 < Size(runs); x += runs[i] + runs[i + 1], i += 2) {
+			int total = std::accumulate(runs.begin() + i - 3, runs.begin() + i + 4, 0);
+			float moduleSize = total / 7.f;
+			if (total < 7 || runs[i - 4] < moduleSize / 2 || runs[i + 4] < moduleSize / 2
+				|| !std::all_of(runs.begin() + i - 3, runs.begin() + i + 4, [&](int r) { return IsModule(static_cast<float>(r), moduleSize); }))
+				continue;
+
+			PointI center = {x + runs[i] / 2, y};
+			if (!CheckBullsEyeLine(image, center, {0, 1}, moduleSize) || !CheckBullsEyeLine(image, center, {1, 0}, moduleSize))
+				continue;
+
+			maxModuleSize = std::max(maxModuleSize, moduleSize);
+			// merge with the first candidate close enough. Noise can produce many thousands of them, but they are
+			// sorted by their row and CheckBullsEyeLine moves a center at most one module + 1 off its row, so only
+			// the ones of the last few rows can be close enough.
+			int minRow = y - static_cast<int>(4 * maxModuleSize) - 2;
+			auto known = res.end();
+			for (auto c = res.rbegin(); c != res.rend() && c->row >= minRow; ++c)
+				if (distance(c->center, center) < 2 * std::max(c->moduleSize, moduleSize))
+					known = std::prev(c.base());
+			if (known != res.end())
+				known->count++;
+			else
+				res.push_back({center, moduleSize, 1, y});
+		}
+	}
+	std::stable_sort(res.begin(), res.end(), [](const BullsEyeCandidate& a, const BullsEyeCandidate& b) { return a.count > b.count; });
+	return res;
+}
+
+bool Detector::FindBullsEye(const BitMatrix& image, BullsEye& bullsEye)
 {
 	// 1. Get the center of the aztec matrix
 	auto pCenter = GetMatrixCenter(image);
 
 	// 2. Get the center points of the four diagonal points just outside the bull's eye
 	//  [topRight, bottomRight, bottomLeft, topLeft]
-	std::array<ResultPoint, 4> bullsEyeCorners;
-	bool compact = false;
-	int nbCenterLayers = 0;
-	if (!GetBullsEyeCorners(image, pCenter, bullsEyeCorners, compact, nbCenterLayers)) {
-		return {};
+	return GetBullsEyeCorners(image, pCenter, bullsEye.corners, bullsEye.compact, bullsEye.nbCenterLayers);
+}
+
+std::vector<BullsEye> Detector::FindBullsEyes(const BitMatrix& image, int scanStride)
+{
+	std::vector<BullsEye> res;
+	for (auto& candidate : FindBullsEyeCenters(image, scanStride)) {
+		if (Deadline::Expired())
+			break;
+		BullsEye bullsEye;
+		if (GetBullsEyeCorners(image, candidate.center, bullsEye.corners, bullsEye.compact, bullsEye.nbCenterLayers))
+			res.push_back(bullsEye);
+	}
+	return res;
+}
+
+/**
+* Counts the pixels from p (excluded) in direction d up to and including the first one after the 4th color change,
+* or returns 0 if the image ends before that.
+*/
+static int PureRingDistance(const BitMatrix& image, PointI p, PointI d)
+{
+	bool color = image.get(p.x, p.y);
+	int length = 0;
+	for (int changes = 0; changes < 4; ++length) {
+		p = p + d;
+		if (!IsValidPoint(p.x, p.y, image.width(), image.height()))
+			return 0;
+		if (image.get(p.x, p.y) != color) {
+			color = !color;
+			++changes;
+		}
 	}
+	return length;
+}
+
+/**
+* Checks that all modules on the square ring at the given distance (in modules) around center have the given color.
+*/
+static bool IsPureRing(const BitMatrix& image, float cx, float cy, float moduleSize, int radius, bool color)
+{
+	for (int i = -radius; i <= radius; ++i)
+		for (auto p : {PointI{i, -radius}, PointI{i, radius}, PointI{-radius, i}, PointI{radius, i}}) {
+			int x = RoundToNearest(cx + moduleSize * p.x);
+			int y = RoundToNearest(cy + moduleSize * p.y);
+			if (!IsValidPoint(x, y, image.width(), image.height()) || image.get(x, y) != color)
+				return false;
+		}
+	return true;
+}
+
+bool Detector::FindPureBullsEye(const BitMatrix& image, BullsEye& bullsEye)
+{
+	const int minSize = 15; // compact Aztec codes are at least 15x15 modules
+	int left, top, width, height;
+	if (!image.findBoundingBox(left, top, width, height, minSize))
+		return false;
+
+	// the center of the bounding box lies in the black center module, the borders between the 4 rings around it are
+	// 7 modules apart in each direction
+	PointI c = {left + width / 2, top + height / 2};
+	if (!image.get(c.x, c.y))
+		return false;
+	int right = PureRingDistance(image, c, {1, 0});
+	int back = PureRingDistance(image, c, {-1, 0});
+	int down = PureRingDistance(image, c, {0, 1});
+	int up = PureRingDistance(image, c, {0, -1});
+	if (!right || !back || !down || !up)
+		return false;
+
+	float moduleSizeX = (right + back - 1) / 7.f;
+	float moduleSizeY = (down + up - 1) / 7.f;
+	if (std::abs(moduleSizeX - moduleSizeY) > std::max(1.f, moduleSizeX / 4))
+		return false;
+	float moduleSize = (moduleSizeX + moduleSizeY) / 2;
+	// the quarter pixel offset keeps the module centers inside the right pixel at a module size of 1 for both the
+	// rounding in SampleLine and the truncation in the grid sampler
+	float cx = c.x + (right - back) / 2.f + 0.25f;
+	float cy = c.y + (down - up) / 2.f + 0.25f;
+
+	// a full range symbol has a white and a black ring where a compact one has its mode message and orientation marks
+	bool full = IsPureRing(image, cx, cy, moduleSize, 5, false) && IsPureRing(image, cx, cy, moduleSize, 6, true);
+	bullsEye.compact = !full;
+	bullsEye.nbCenterLayers = full ? 7 : 5;
+
+	// the centers of the diagonal modules just outside the bull's eye, [topRight, bottomRight, bottomLeft, topLeft]
+	float d = bullsEye.nbCenterLayers * moduleSize;
+	bullsEye.corners = {{ResultPoint(cx + d, cy - d), ResultPoint(cx + d, cy + d), ResultPoint(cx - d, cy + d),
+						 ResultPoint(cx - d, cy - d)}};
+	return true;
+}
+
+DetectorResult Detector::Detect(const BitMatrix& image, const BullsEye& bullsEye, bool isMirror)
+{
+	ZX_TRACE_SCOPE("Aztec::Detector::Detect");
+	auto bullsEyeCorners = bullsEye.corners;
+	bool compact = bullsEye.compact;
+	int nbCenterLayers = bullsEye.nbCenterLayers;
 
 	if (isMirror) {
 		std::swap(bullsEyeCorners[0], bullsEyeCorners[2]);
@@ -508,5 +707,25 @@ DetectorResult Detector::Detect(const BitMatrix& image, bool isMirror)
 			compact, nbDataBlocks, nbLayers};
 }
 
+DetectorResult Detector::Detect(const BitMatrix& image, bool isMirror)
+{
+	ZX_TRACE_SCOPE("Aztec::Detector::Detect");
+	BullsEye bullsEye;
+	if (!FindBullsEye(image, bullsEye))
+		return {};
+	return Detect(image, bullsEye, isMirror);
+}
+
+std::vector<DetectorResult> Detector::DetectMultiple(const BitMatrix& image, bool isMirror, int scanStride)
+{
+	std::vector<DetectorResult> res;
+	for (auto& bullsEye : FindBullsEyes(image, scanStride)) {
+		auto result = Detect(image, bullsEye, isMirror);
+		if (result.isValid())
+			res.push_back(std::move(result));
+	}
+	return res;
+}
+
 } // Aztec
 } // ZXing
@@ -16,6 +16,11 @@
 * limitations under the License.
 */
 
+#include "ResultPoint.h"
+
+#include <array>
+#include <vector>
+
 namespace ZXing {
 
 class BitMatrix;
@@ -24,6 +29,17 @@ namespace Aztec {
 
 class DetectorResult;
 
+/**
+* The center points of the four diagonal points just outside the bull's eye, [topRight, bottomRight, bottomLeft,
+* topLeft], and its size. It does not depend on whether the symbol is mirrored.
+*/
+struct BullsEye
+{
+	std::array<ResultPoint, 4> corners;
+	bool compact = false;
+	int nbCenterLayers = 0;
+};
+
 /**
 * Encapsulates logic that can detect an Aztec Code in an image, even if the Aztec Code
 * is rotated or skewed, or partially obscured.
@@ -42,6 +58,37 @@ public:
 	* @throws NotFoundException if no Aztec Code can be found
 	*/
 	static DetectorResult Detect(const BitMatrix& image, bool isMirror);
+
+	/**
+	* Finds the bull's eye of the Aztec Code closest to the center of the image.
+	*/
+	static bool FindBullsEye(const BitMatrix& image, BullsEye& bullsEye);
+
+	/**
+	* Finds the bull's eyes of all Aztec Codes in an image by scanning every row for the ring pattern around their
+	* center module, so the symbols may be anywhere in the image. The ones that matched in the most rows come first.
+	* With a scanStride > 1 only every scanStride-th row is scanned.
+	*/
+	static std::vector<BullsEye> FindBullsEyes(const BitMatrix& image, int scanStride = 1);
+
+	/**
+	* Finds the bull's eye in a "pure" image, which contains only an unskewed Aztec Code with some white border around
+	* it: the center of its bounding box lies in the center module and the module size follows from the rings.
+	*/
+	static bool FindPureBullsEye(const BitMatrix& image, BullsEye& bullsEye);
+
+	/**
+	* Reads the parameters around a bull's eye found by FindBullsEye(s) and samples the symbol. Trying both values
+	* of isMirror only repeats these last steps.
+	*/
+	static DetectorResult Detect(const BitMatrix& image, const BullsEye& bullsEye, bool isMirror);
+
+	/**
+	* Detects all Aztec Codes in an image, see FindBullsEyes.
+	*
+	* @param isMirror if true, image is a mirror-image of original
+	*/
+	static std::vector<DetectorResult> DetectMultiple(const BitMatrix& image, bool isMirror, int scanStride = 1);
 };
 
 } // Aztec
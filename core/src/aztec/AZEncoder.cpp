@@ -165,26 +165,29 @@ ZXING_EXPORT_TEST_ONLY
 void StuffBits(const BitArray& bits, int wordSize, BitArray& out)
 {
 	out = BitArray();
-	int n = bits.size();
-	int mask = (1 << wordSize) - 2;
-	for (int i = 0; i < n; i += wordSize) {
+	// Every input bit is read exactly once: a word whose first wordSize-1 bits are all 0s or all 1s gets a
+	// complementary stuffing bit appended and its last bit becomes the first one of the next word. Past the end the
+	// input is padded with 1s.
+	auto i = bits.begin();
+	auto end = bits.end();
+	auto next = [&i, &end]() {
+		if (i == end)
+			return 1;
+		int bit = *i;
+		++i;
+		return bit;
+	};
+	int allOnes = (1 << (wordSize - 1)) - 1;
+	while (i != end) {
 		int word = 0;
-		for (int j = 0; j < wordSize; j++) {
-			if (i + j >= n || bits.get(i + j)) {
-				word |= 1 << (wordSize - 1 - j);
-			}
-		}
-		if ((word & mask) == mask) {
-			out.appendBits(word & mask, wordSize);
-			i--;
-		}
-		else if ((word & mask) == 0) {
-			out.appendBits(word | 1, wordSize);
-			i--;
-		}
-		else {
-			out.appendBits(word, wordSize);
-		}
+		for (int j = 0; j < wordSize - 1; j++)
+			word = (word << 1) | next();
+		if (word == allOnes)
+			out.appendBits(word << 1, wordSize);
+		else if (word == 0)
+			out.appendBits(1, wordSize);
+		else
+			out.appendBits((word << 1) | next(), wordSize);
 	}
 }
 
@@ -249,13 +252,20 @@ Encoder::Encode(const std::string& data, int minECCPercent, int userSpecifiedLay
 			if (totalSizeBits > totalBitsInLayer) {
 				continue;
 			}
+			int usableBitsInLayers = totalBitsInLayer - (totalBitsInLayer % WORD_SIZE[layers]);
+			// Stuffing never shrinks the data, it only rounds it up to whole words. Skip the sizes that can't hold
+			// even that, so the bits are usually stuffed only once, for the size that is chosen.
+			int minStuffedSize = (bits.size() + WORD_SIZE[layers] - 1) / WORD_SIZE[layers] * WORD_SIZE[layers];
+			if (minStuffedSize + eccBits > usableBitsInLayers
+				|| (compact && minStuffedSize > WORD_SIZE[layers] * 64)) {
+				continue;
+			}
 			// [Re]stuff the bits if this is the first opportunity, or if the
 			// wordSize has changed
 			if (wordSize != WORD_SIZE[layers]) {
 				wordSize = WORD_SIZE[layers];
 				StuffBits(bits, wordSize, stuffedBits);
 			}
-			int usableBitsInLayers = totalBitsInLayer - (totalBitsInLayer % wordSize);
 			if (compact && stuffedBits.size() > wordSize * 64) {
 				// Compact format only allows 64 data words, though C4 can hold more words than that
 				continue;
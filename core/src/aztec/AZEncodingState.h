@@ -21,7 +21,36 @@
 namespace ZXing {
 namespace Aztec {
 
-class Token;
+/**
+* The tokens of all states of the encoder, each one linked to the one before it, so that the states share the tokens
+* they have in common instead of copying them.
+*/
+class TokenChains
+{
+	struct Link
+	{
+		Token token;
+		int previous;
+	};
+	std::vector<Link> _links;
+
+public:
+	// Returns the index of token appended to the chain ending at last
+	int append(int last, Token token)
+	{
+		_links.push_back({token, last});
+		return static_cast<int>(_links.size()) - 1;
+	}
+
+	// Returns the tokens of the chain ending at last, in output order
+	std::vector<Token> get(int last) const
+	{
+		std::vector<Token> result;
+		for (; last >= 0; last = _links[last].previous)
+			result.push_back(_links[last].token);
+		return {result.rbegin(), result.rend()};
+	}
+};
 
 /**
 * State represents all information about a sequence necessary to generate the current output.
@@ -30,9 +59,11 @@ class Token;
 class EncodingState
 {
 public:
-	// The list of tokens that we output.  If we are in Binary Shift mode, this
-	// token list does *not* yet included the token for those bytes
-	std::vector<Token> tokens;
+	// The index of the last token that we output in the TokenChains of the
+	// encoder (-1 if none), it links back to all the previous ones. If we are in
+	// Binary Shift mode, this token list does *not* yet included the token for
+	// those bytes
+	int lastToken;
 
 	// The current mode of the encoding (or the mode to which we'll return if
 	// we're in Binary Shift mode.
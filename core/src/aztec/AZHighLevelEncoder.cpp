@@ -24,7 +24,6 @@
 #include <array>
 #include <cstdint>
 #include <algorithm>
-#include <list>
 #include <vector>
 
 namespace ZXing {
@@ -137,66 +136,65 @@ const std::array<std::array<int8_t, 6>, 6>& SHIFT_TABLE = InitShiftTable();
 
 // Create a new state representing this state with a latch to a (not
 // necessary different) mode, and then a code.
-static EncodingState LatchAndAppend(const EncodingState& state, int mode, int value)
+static EncodingState LatchAndAppend(TokenChains& tokens, const EncodingState& state, int mode, int value)
 {
 	//assert binaryShiftByteCount == 0;
 	int bitCount = state.bitCount;
-	auto tokens = state.tokens;
+	int last = state.lastToken;
 	if (mode != state.mode) {
 		int latch = LATCH_TABLE[state.mode][mode];
-		tokens.push_back(Token::CreateSimple(latch & 0xFFFF, latch >> 16));
+		last = tokens.append(last, Token::CreateSimple(latch & 0xFFFF, latch >> 16));
 		bitCount += latch >> 16;
 	}
 	int latchModeBitCount = mode == MODE_DIGIT ? 4 : 5;
-	tokens.push_back(Token::CreateSimple(value, latchModeBitCount));
-	return EncodingState{ tokens, mode, 0, bitCount + latchModeBitCount };
+	last = tokens.append(last, Token::CreateSimple(value, latchModeBitCount));
+	return EncodingState{ last, mode, 0, bitCount + latchModeBitCount };
 }
 
 // Create a new state representing this state, with a temporary shift
 // to a different mode to output a single value.
-static EncodingState ShiftAndAppend(const EncodingState& state, int mode, int value)
+static EncodingState ShiftAndAppend(TokenChains& tokens, const EncodingState& state, int mode, int value)
 {
 	//assert binaryShiftByteCount == 0 && this.mode != mode;
 	int thisModeBitCount = state.mode == MODE_DIGIT ? 4 : 5;
 	// Shifts exist only to UPPER and PUNCT, both with tokens size 5.
-	auto tokens = state.tokens;
-	tokens.push_back(Token::CreateSimple(SHIFT_TABLE[state.mode][mode], thisModeBitCount));
-	tokens.push_back(Token::CreateSimple(value, 5));
-	return EncodingState{ tokens, state.mode, 0, state.bitCount + thisModeBitCount + 5 };
+	int last = tokens.append(state.lastToken, Token::CreateSimple(SHIFT_TABLE[state.mode][mode], thisModeBitCount));
+	last = tokens.append(last, Token::CreateSimple(value, 5));
+	return EncodingState{ last, state.mode, 0, state.bitCount + thisModeBitCount + 5 };
 }
 
 // Create the state identical to this one, but we are no longer in
 // Binary Shift mode.
-static EncodingState EndBinaryShift(const EncodingState& state, int index)
+static EncodingState EndBinaryShift(TokenChains& tokens, const EncodingState& state, int index)
 {
 	if (state.binaryShiftByteCount == 0) {
 		return state;
 	}
-	auto tokens = state.tokens;
-	tokens.push_back(Token::CreateBinaryShift(index - state.binaryShiftByteCount, state.binaryShiftByteCount));
+	int last = tokens.append(state.lastToken, Token::CreateBinaryShift(index - state.binaryShiftByteCount,
+																	  state.binaryShiftByteCount));
 	//assert token.getTotalBitCount() == this.bitCount;
-	return EncodingState{ tokens, state.mode, 0, state.bitCount };
+	return EncodingState{ last, state.mode, 0, state.bitCount };
 }
 
 // Create a new state representing this state, but an additional character
 // output in Binary Shift mode.
-static EncodingState AddBinaryShiftChar(const EncodingState& state, int index)
+static EncodingState AddBinaryShiftChar(TokenChains& tokens, const EncodingState& state, int index)
 {
-	auto tokens = state.tokens;
+	int last = state.lastToken;
 	int mode = state.mode;
 	int bitCount = state.bitCount;
 	if (state.mode == MODE_PUNCT || state.mode == MODE_DIGIT) {
 		//assert binaryShiftByteCount == 0;
 		int latch = LATCH_TABLE[mode][MODE_UPPER];
-		tokens.push_back(Token::CreateSimple(latch & 0xFFFF, latch >> 16));
+		last = tokens.append(last, Token::CreateSimple(latch & 0xFFFF, latch >> 16));
 		bitCount += latch >> 16;
 		mode = MODE_UPPER;
 	}
 	int deltaBitCount = (state.binaryShiftByteCount == 0 || state.binaryShiftByteCount == 31) ? 18 : (state.binaryShiftByteCount == 62) ? 9 : 8;
-	EncodingState result{ tokens, mode, state.binaryShiftByteCount + 1, bitCount + deltaBitCount };
+	EncodingState result{ last, mode, state.binaryShiftByteCount + 1, bitCount + deltaBitCount };
 	if (result.binaryShiftByteCount == 2047 + 31) {
 		// The string is as long as it's allowed to be.  We should end it.
-		result = EndBinaryShift(result, index + 1);
+		result = EndBinaryShift(tokens, result, index + 1);
 	}
 	return result;
 }
@@ -231,44 +229,47 @@ static bool IsBetterThanOrEqualTo(const EncodingState& state, const EncodingStat
 	return newModeBitCount <= other.bitCount;
 }
 
-static BitArray ToBitArray(const EncodingState& state, const std::string& text)
+static BitArray ToBitArray(TokenChains& tokens, const EncodingState& state, const std::string& text)
 {
-	auto endState = EndBinaryShift(state, Size(text));
+	auto endState = EndBinaryShift(tokens, state, Size(text));
 	BitArray bits;
 	// Add each token to the result.
-	for (const Token& symbol : endState.tokens) {
+	for (const Token& symbol : tokens.get(endState.lastToken)) {
 		symbol.appendTo(bits, text);
 	}
 	//assert bitArray.getSize() == this.bitCount;
 	return bits;
 }
 
-static void UpdateStateForPair(const EncodingState& state, int index, int pairCode, std::list<EncodingState>& result)
+static void UpdateStateForPair(TokenChains& tokens, const EncodingState& state, int index, int pairCode,
+							   std::vector<EncodingState>& result)
 {
-	EncodingState stateNoBinary = EndBinaryShift(state, index);
+	EncodingState stateNoBinary = EndBinaryShift(tokens, state, index);
 	// Possibility 1.  Latch to MODE_PUNCT, and then append this code
-	result.push_back(LatchAndAppend(stateNoBinary, MODE_PUNCT, pairCode));
+	result.push_back(LatchAndAppend(tokens, stateNoBinary, MODE_PUNCT, pairCode));
 	if (state.mode != MODE_PUNCT) {
 		// Possibility 2.  Shift to MODE_PUNCT, and then append this code.
 		// Every state except MODE_PUNCT (handled above) can shift
-		result.push_back(ShiftAndAppend(stateNoBinary, MODE_PUNCT, pairCode));
+		result.push_back(ShiftAndAppend(tokens, stateNoBinary, MODE_PUNCT, pairCode));
 	}
 	if (pairCode == 3 || pairCode == 4) {
 		// both characters are in DIGITS.  Sometimes better to just add two digits
-		auto digitState = LatchAndAppend(stateNoBinary, MODE_DIGIT, 16 - pairCode);	// period or comma in DIGIT
-		result.push_back(LatchAndAppend(digitState, MODE_DIGIT, 1));				// space in DIGIT
+		auto digitState = LatchAndAppend(tokens, stateNoBinary, MODE_DIGIT, 16 - pairCode);	// period or comma in DIGIT
+		result.push_back(LatchAndAppend(tokens, digitState, MODE_DIGIT, 1));					// space in DIGIT
 	}
 	if (state.binaryShiftByteCount > 0) {
 		// It only makes sense to do the characters as binary if we're already
 		// in binary mode.
-		result.push_back(AddBinaryShiftChar(AddBinaryShiftChar(state, index), index + 1));
+		result.push_back(AddBinaryShiftChar(tokens, AddBinaryShiftChar(tokens, state, index), index + 1));
 	}
 }
 
-
-static std::list<EncodingState> SimplifyStates(const std::list<EncodingState>& states)
+// Removes the states for which another state is better or equal, keeping the order of the remaining ones. As the
+// surviving states are few (bounded by the number of modes and binary shift lengths that can still pay off), this
+// is a constant amount of work per character.
+static void SimplifyStates(const std::vector<EncodingState>& states, std::vector<EncodingState>& result)
 {
-	std::list<EncodingState> result;
+	result.clear();
 	for (auto& newState : states) {
 		bool add = true;
 		for (auto iterator = result.begin(); iterator != result.end();) {
@@ -288,24 +289,13 @@ static std::list<EncodingState> SimplifyStates(const std::list<EncodingState>& s
 			result.push_back(newState);
 		}
 	}
-	return result;
-}
-
-static std::list<EncodingState> UpdateStateListForPair(const std::list<EncodingState>& states, int index, int pairCode)
-{
-	std::list<EncodingState> result;
-	for (auto& state : states) {
-		UpdateStateForPair(state, index, pairCode, result);
-	}
-	return SimplifyStates(result);
 }
 
-
-
 // Return a set of states that represent the possible ways of updating this
 // state for the next character.  The resulting set of states are added to
 // the "result" list.
-static void UpdateStateForChar(const EncodingState& state, const std::string& text, int index, std::list<EncodingState>& result)
+static void UpdateStateForChar(TokenChains& tokens, const EncodingState& state, const std::string& text, int index,
+							   std::vector<EncodingState>& result)
 {
 	int ch = text[index] & 0xff;
 	bool charInCurrentTable = CHAR_MAP[state.mode][ch] > 0;
@@ -316,7 +306,7 @@ static void UpdateStateForChar(const EncodingState& state, const std::string& te
 		if (charInMode > 0) {
 			if (firstTime) {
 				// Only create stateNoBinary the first time it's required.
-				stateNoBinary = EndBinaryShift(state, index);
+				stateNoBinary = EndBinaryShift(tokens, state, index);
 				firstTime = false;
 			}
 			// Try generating the character by latching to its mode
@@ -325,13 +315,13 @@ static void UpdateStateForChar(const EncodingState& state, const std::string& te
 				// any other mode except possibly digit (which uses only 4 bits).  Any
 				// other latch would be equally successful *after* this character, and
 				// so wouldn't save any bits.
-				result.push_back(LatchAndAppend(stateNoBinary, mode, charInMode));
+				result.push_back(LatchAndAppend(tokens, stateNoBinary, mode, charInMode));
 			}
 			// Try generating the character by switching to its mode.
 			if (!charInCurrentTable && SHIFT_TABLE[state.mode][mode] >= 0) {
 				// It never makes sense to temporarily shift to another mode if the
 				// character exists in the current mode.  That can never save bits.
-				result.push_back(ShiftAndAppend(stateNoBinary, mode, charInMode));
+				result.push_back(ShiftAndAppend(tokens, stateNoBinary, mode, charInMode));
 			}
 		}
 	}
@@ -339,30 +329,21 @@ static void UpdateStateForChar(const EncodingState& state, const std::string& te
 		// It's never worthwhile to go into binary shift mode if you're not already
 		// in binary shift mode, and the character exists in your current mode.
 		// That can never save bits over just outputting the char in the current mode.
-		result.push_back(AddBinaryShiftChar(state, index));
+		result.push_back(AddBinaryShiftChar(tokens, state, index));
 	}
 }
 
-// We update a set of states for a new character by updating each state
-// for the new character, merging the results, and then removing the
-// non-optimal states.
-static std::list<EncodingState> UpdateStateListForChar(const std::list<EncodingState>& states, const std::string& text, int index)
-{
-	std::list<EncodingState> result;
-	for (auto& state : states) {
-		UpdateStateForChar(state, text, index, result);
-	}
-	return result.size() > 1 ? SimplifyStates(result) : result;
-}
-
 /**
 * @return text represented by this encoder encoded as a {@link BitArray}
 */
 BitArray
 HighLevelEncoder::Encode(const std::string& text)
 {
-	std::list<EncodingState> states;
-	states.push_back(EncodingState{ std::vector<Token>(), MODE_UPPER, 0, 0 });
+	// The tokens of all states go into one arena and the state lists are reused, so there is no per state
+	// allocation and no copying of token lists while going through the text.
+	TokenChains tokens;
+	std::vector<EncodingState> states, candidates;
+	states.push_back(EncodingState{ -1, MODE_UPPER, 0, 0 });
 	for (int index = 0; index < Size(text); index++) {
 		int pairCode;
 		int nextChar = index + 1 < Size(text) ? text[index + 1] : 0;
@@ -382,21 +363,27 @@ HighLevelEncoder::Encode(const std::string& text)
 		default:
 			pairCode = 0;
 		}
-		if (pairCode > 0) {
-			// We have one of the four special PUNCT pairs.  Treat them specially.
-			// Get a new set of states for the two new characters.
-			states = UpdateStateListForPair(states, index, pairCode);
-			index++;
-		}
-		else {
-			// Get a new set of states for the new character.
-			states = UpdateStateListForChar(states, text, index);
+		// We update the set of states for a new character (or one of the four special
+		// PUNCT pairs) by updating each state, merging the results, and then removing
+		// the non-optimal states.
+		candidates.clear();
+		for (auto& state : states) {
+			if (pairCode > 0)
+				UpdateStateForPair(tokens, state, index, pairCode, candidates);
+			else
+				UpdateStateForChar(tokens, state, text, index, candidates);
 		}
+		if (pairCode > 0)
+			index++;
+		if (candidates.size() > 1)
+			SimplifyStates(candidates, states);
+		else
+			std::swap(states, candidates);
 	}
 	// We are left with a set of states.  Find the shortest one.
 	EncodingState minState = *std::min_element(states.begin(), states.end(), [](const EncodingState& a, const EncodingState& b) { return a.bitCount < b.bitCount; });
 	// Convert it to a bit array, and return.
-	return ToBitArray(minState, text);
+	return ToBitArray(tokens, minState, text);
 }
 
 } // Aztec
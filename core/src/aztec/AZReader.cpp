@@ -25,34 +25,81 @@
 #include <vector>
 #include "Result.h"
 #include "BinaryBitmap.h"
+#include "DecodeHints.h"
+#include "Deadline.h"
+#include "DecodeStats.h"
 #include "DecoderResult.h"
+#include "Trace.h"
+#include "ZXContainerAlgorithms.h"
 
 namespace ZXing {
 namespace Aztec {
 
+static Result DecodeBullsEye(const BitMatrix& image, const BullsEye& bullsEye)
+{
+	DetectorResult detectResult;
+	DecoderResult decodeResult = DecodeStatus::NotFound;
+	// the bull's eye does not depend on the orientation, only the parameters and the sampled grid do
+	for (bool isMirror : {false, true}) {
+		if (isMirror && Deadline::Expired())
+			break;
+		detectResult = Detector::Detect(image, bullsEye, isMirror);
+		if (detectResult.isValid()) {
+			decodeResult = Decoder::Decode(detectResult);
+			if (decodeResult.isValid())
+				break;
+		}
+	}
+	return Result(std::move(decodeResult), std::move(detectResult).position(), BarcodeFormat::AZTEC);
+}
+
+Reader::Reader(const DecodeHints& hints) : _isPure(hints.isPure()), _scanStride(hints.scanStride()) {}
+
 Result
 Reader::decode(const BinaryBitmap& image) const
 {
-	auto binImg = image.getBlackMatrix();
+	ZX_TRACE_SCOPE("Aztec::Reader::decode");
+	DecodeStats::ReaderTimer readerTimer(DecodeStats::ReaderType::Aztec);
+	DecodeStats::StageTimer detectTimer(DecodeStats::Stage::Detect);
+	auto binImg = image.getBitMatrix();
 	if (binImg == nullptr) {
 		return Result(DecodeStatus::NotFound);
 	}
 
-	DetectorResult detectResult = Detector::Detect(*binImg, false);
-	DecoderResult decodeResult = DecodeStatus::NotFound;
-	if (detectResult.isValid()) {
-		decodeResult = Decoder::Decode(detectResult);
+	BullsEye bullsEye;
+	if (!(_isPure ? Detector::FindPureBullsEye(*binImg, bullsEye) : Detector::FindBullsEye(*binImg, bullsEye))) {
+		return Result(DecodeStatus::NotFound);
 	}
 
-	//TODO: don't start detection all over again, just to swap 2 corner points
-	if (!decodeResult.isValid()) {
-		detectResult = Detector::Detect(*binImg, true);
-		if (detectResult.isValid()) {
-			decodeResult = Decoder::Decode(detectResult);
-		}
+	return DecodeBullsEye(*binImg, bullsEye);
+}
+
+Results
+Reader::decode(const BinaryBitmap& image, int maxSymbols) const
+{
+	ZX_TRACE_SCOPE("Aztec::Reader::decode");
+	DecodeStats::ReaderTimer readerTimer(DecodeStats::ReaderType::Aztec);
+	DecodeStats::StageTimer detectTimer(DecodeStats::Stage::Detect);
+	if (_isPure)
+		return ZXing::Reader::decode(image, maxSymbols);
+
+	auto binImg = image.getBitMatrix();
+	if (binImg == nullptr)
+		return {};
+
+	Results results;
+	for (auto& bullsEye : Detector::FindBullsEyes(*binImg, _scanStride)) {
+		if (Size(results) >= maxSymbols || Deadline::Expired())
+			break;
+		auto result = DecodeBullsEye(*binImg, bullsEye);
+		if (result.isValid())
+			results.push_back(std::move(result));
 	}
 
-	return Result(std::move(decodeResult), std::move(detectResult).position(), BarcodeFormat::AZTEC);
+	// the bull's eye scan needs a clean ring pattern in at least one row, the old detector might still find a symbol
+	if (results.empty())
+		return ZXing::Reader::decode(image, maxSymbols);
+	return results;
 }
 
 } // Aztec
@@ -19,6 +19,9 @@
 #include "Reader.h"
 
 namespace ZXing {
+
+class DecodeHints;
+
 namespace Aztec {
 
 /**
@@ -28,8 +31,17 @@ namespace Aztec {
 */
 class Reader : public ZXing::Reader
 {
+	bool _isPure = false;
+	int _scanStride = 1;
 public:
+	Reader() = default;
+	explicit Reader(const DecodeHints& hints);
 	Result decode(const BinaryBitmap& image) const override;
+
+	/**
+	* Decodes all Aztec codes in the image, at most maxSymbols, see Detector::DetectMultiple.
+	*/
+	Results decode(const BinaryBitmap& image, int maxSymbols) const override;
 };
 
 } // Aztec
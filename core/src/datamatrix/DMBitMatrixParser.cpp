@@ -20,9 +20,9 @@
 #include "DMVersion.h"
 #include "BitMatrix.h"
 #include "ByteArray.h"
+#include "ZXContainerAlgorithms.h"
 
 #include <cstdint>
-#include <stdexcept>
 
 namespace ZXing {
 namespace DataMatrix {
@@ -38,53 +38,7 @@ BitMatrixParser::ReadVersion(const BitMatrix& bits)
 }
 
 /**
-* <p>Extracts the data region from a {@link BitMatrix} that contains
-* alignment patterns.</p>
-*
-* @param bitMatrix Original {@link BitMatrix} with alignment patterns
-* @return BitMatrix that has the alignment patterns removed
-*/
-static BitMatrix ExtractDataRegion(const Version& version, const BitMatrix& bitMatrix)
-{
-	int symbolSizeRows = version.symbolSizeRows();
-	int symbolSizeColumns = version.symbolSizeColumns();
-
-	if (bitMatrix.height() != symbolSizeRows) {
-		throw std::invalid_argument("Dimension of bitMarix must match the version size");
-	}
-
-	int dataRegionSizeRows = version.dataRegionSizeRows();
-	int dataRegionSizeColumns = version.dataRegionSizeColumns();
-
-	int numDataRegionsRow = symbolSizeRows / dataRegionSizeRows;
-	int numDataRegionsColumn = symbolSizeColumns / dataRegionSizeColumns;
-
-	int sizeDataRegionRow = numDataRegionsRow * dataRegionSizeRows;
-	int sizeDataRegionColumn = numDataRegionsColumn * dataRegionSizeColumns;
-
-	BitMatrix result(sizeDataRegionColumn, sizeDataRegionRow);
-	for (int dataRegionRow = 0; dataRegionRow < numDataRegionsRow; ++dataRegionRow) {
-		int dataRegionRowOffset = dataRegionRow * dataRegionSizeRows;
-		for (int dataRegionColumn = 0; dataRegionColumn < numDataRegionsColumn; ++dataRegionColumn) {
-			int dataRegionColumnOffset = dataRegionColumn * dataRegionSizeColumns;
-			for (int i = 0; i < dataRegionSizeRows; ++i) {
-				int readRowOffset = dataRegionRow * (dataRegionSizeRows + 2) + 1 + i;
-				int writeRowOffset = dataRegionRowOffset + i;
-				for (int j = 0; j < dataRegionSizeColumns; ++j) {
-					int readColumnOffset = dataRegionColumn * (dataRegionSizeColumns + 2) + 1 + j;
-					if (bitMatrix.get(readColumnOffset, readRowOffset)) {
-						int writeColumnOffset = dataRegionColumnOffset + j;
-						result.set(writeColumnOffset, writeRowOffset);
-					}
-				}
-			}
-		}
-	}
-	return result;
-}
-
-/**
-* <p>Reads the bits in the {@link BitMatrix} representing the mapping matrix (No alignment patterns)
+* <p>Reads the bits in the {@link BitMatrix} representing the Data Matrix Code
 * in the correct order in order to reconstitute the codewords bytes contained within the
 * Data Matrix Code.</p>
 *
@@ -99,23 +53,18 @@ BitMatrixParser::ReadCodewords(const BitMatrix& bits)
 		return {};
 	}
 
-	BitMatrix dataBits = ExtractDataRegion(*version, bits);
+	const auto& placement = SymbolPlacement(*version);
+	if (Size(placement) != 8 * version->totalCodewords())
+		return {};
 
 	ByteArray result(version->totalCodewords());
-	auto codeword = result.begin();
-
-	VisitMatrix(dataBits.height(), dataBits.width(), [&codeword, &dataBits](const BitPosArray& bitPos) {
-		// Read the 8 bits of one of the special corner/utah symbols into the current codeword
-		*codeword = 0;
-		for (auto& p : bitPos) {
-			*codeword <<= 1;
-			*codeword |= static_cast<uint8_t>(dataBits.get(p.col, p.row));
-		}
-		++codeword;
-	});
-
-	if (codeword != result.end())
-		return {};
+	auto pos = placement.begin();
+	for (auto& codeword : result) {
+		int value = 0;
+		for (int bit = 0; bit < 8; ++bit, ++pos)
+			value = (value << 1) | static_cast<int>(bits.get(pos->x, pos->y));
+		codeword = static_cast<uint8_t>(value);
+	}
 
 	return result;
 }
@@ -18,19 +18,20 @@
 #include "DMDecoder.h"
 #include "DMBitMatrixParser.h"
 #include "DMDataBlock.h"
+#include "DecodeStats.h"
 #include "DecoderResult.h"
 #include "ReedSolomonDecoder.h"
 #include "GenericGF.h"
 #include "BitSource.h"
 #include "DecodeStatus.h"
 #include "TextDecoder.h"
+#include "Trace.h"
 #include "ZXContainerAlgorithms.h"
 #include "ZXStrConvWorkaround.h"
 #include "ZXTestSupport.h"
 
 #include <array>
 #include <algorithm>
-#include <list>
 #include <string>
 #include <utility>
 #include <vector>
@@ -179,15 +180,92 @@ static std::array<int, 3> ParseTwoBytes(int firstByte, int secondByte)
 }
 
 /**
-* See ISO 16022:2006, 5.2.5 and Annex C, Table C.1
+* The first value of a triple can be 40 for the codewords 253 and up, the other two are always < 40.
 */
-static bool DecodeC40Segment(BitSource& bits, std::string& result)
+static constexpr int NUM_TRIPLE_VALUES = 41;
+
+/**
+* Meaning of a C40, Text or ANSI X12 value: a character (>= 0) or one of the following.
+*/
+enum : int16_t
+{
+	INVALID = -1,
+	SHIFT1 = -2,
+	SHIFT2 = -3,
+	SHIFT3 = -4,
+	FNC1 = -5,
+	UPPER_SHIFT = -6,
+};
+
+using ValueTable = std::array<int16_t, NUM_TRIPLE_VALUES>;
+
+/**
+* The value tables of the basic set and the 3 shift sets of C40 or Text, see ISO 16022:2006, Annex C.
+*/
+using ShiftSetTables = std::array<ValueTable, 4>;
+
+/**
+* Fills the basic set and the shift 1 and 2 sets, which only differ in the basic set between C40 and Text.
+*/
+template <size_t N>
+static ShiftSetTables MakeShiftSetTables(const char (&basicSet)[N])
+{
+	ShiftSetTables res;
+	for (auto& table : res)
+		table.fill(INVALID);
+	for (int i = 0; i < NUM_TRIPLE_VALUES; ++i) {
+		if (i < 3)
+			res[0][i] = SHIFT1 - i;
+		else if (i < Size(basicSet))
+			res[0][i] = static_cast<uint8_t>(basicSet[i]);
+
+		res[1][i] = i;
+
+		if (i < Size(C40_SHIFT2_SET_CHARS))
+			res[2][i] = static_cast<uint8_t>(C40_SHIFT2_SET_CHARS[i]);
+		else if (i == 27)
+			res[2][i] = FNC1;
+		else if (i == 30)
+			res[2][i] = UPPER_SHIFT;
+	}
+	return res;
+}
+
+static const ShiftSetTables& C40Tables()
+{
+	static const auto tables = [] {
+		auto res = MakeShiftSetTables(C40_BASIC_SET_CHARS);
+		for (int i = 0; i < NUM_TRIPLE_VALUES; ++i)
+			res[3][i] = static_cast<int16_t>(i + 96);
+		return res;
+	}();
+	return tables;
+}
+
+static const ShiftSetTables& TextTables()
+{
+	static const auto tables = [] {
+		auto res = MakeShiftSetTables(TEXT_BASIC_SET_CHARS);
+		for (int i = 0; i < Size(TEXT_SHIFT3_SET_CHARS); ++i)
+			res[3][i] = static_cast<uint8_t>(TEXT_SHIFT3_SET_CHARS[i]);
+		return res;
+	}();
+	return tables;
+}
+
+/**
+* See ISO 16022:2006, 5.2.5 and 5.2.6, Annex C, Tables C.1 and C.2
+*/
+static bool DecodeC40OrTextSegment(BitSource& bits, std::string& result, const ShiftSetTables& tables)
 {
-	// Three C40 values are encoded in a 16-bit value as
+	// Three C40/Text values are encoded in a 16-bit value as
 	// (1600 * C1) + (40 * C2) + C3 + 1
 	// TODO(bbrown): The Upper Shift with C40 doesn't work in the 4 value scenario all the time
 	bool upperShift = false;
 
+	// at most 3 characters per 2 codewords
+	result.reserve(result.size() + bits.available() / 16 * 3);
+
 	int shift = 0;
 	do {
 		// If there is only one byte left then it will be encoded as ASCII
@@ -200,171 +278,43 @@ static bool DecodeC40Segment(BitSource& bits, std::string& result)
 		}
 
 		for (int cValue : ParseTwoBytes(firstByte, bits.readBits(8))) {
-			switch (shift) {
-			case 0:
-				if (cValue < 3) {
-					shift = cValue + 1;
-				}
-				else if (cValue < Size(C40_BASIC_SET_CHARS)) {
-					char c40char = C40_BASIC_SET_CHARS[cValue];
-					if (upperShift) {
-						result.push_back((char)(c40char + 128));
-						upperShift = false;
-					}
-					else {
-						result.push_back(c40char);
-					}
-				}
-				else {
-					return false;
-				}
-				break;
-			case 1:
-				if (upperShift) {
-					result.push_back((char)(cValue + 128));
-					upperShift = false;
-				}
-				else {
-					result.push_back((char)cValue);
-				}
-				shift = 0;
-				break;
-			case 2:
-				if (cValue < Size(C40_SHIFT2_SET_CHARS)) {
-					char c40char = C40_SHIFT2_SET_CHARS[cValue];
-					if (upperShift) {
-						result.push_back((char)(c40char + 128));
-						upperShift = false;
-					}
-					else {
-						result.push_back(c40char);
-					}
-				}
-				else if (cValue == 27) {  // FNC1
-					result.push_back((char)29); // translate as ASCII 29
-				}
-				else if (cValue == 30) {  // Upper Shift
-					upperShift = true;
-				}
-				else {
-					return false;
-				}
-				shift = 0;
-				break;
-			case 3:
-				if (upperShift) {
-					result.push_back((char)(cValue + 224));
-					upperShift = false;
-				}
-				else {
-					result.push_back((char)(cValue + 96));
-				}
-				shift = 0;
-				break;
-			default:
+			if (cValue < 0) { // the 16-bit value 0 is not valid
 				return false;
 			}
+			int value = tables[shift][cValue];
+			shift = 0;
+			if (value >= 0) {
+				result.push_back(static_cast<char>(upperShift ? value + 128 : value));
+				upperShift = false;
+				continue;
+			}
+			switch (value) {
+			case SHIFT1:
+			case SHIFT2:
+			case SHIFT3: shift = SHIFT1 - value + 1; break;
+			case FNC1: result.push_back((char)29); break; // translate as ASCII 29
+			case UPPER_SHIFT: upperShift = true; break;
+			default: return false;
+			}
 		}
 	} while (bits.available() > 0);
 	return true;
 }
 
+/**
+* See ISO 16022:2006, 5.2.5 and Annex C, Table C.1
+*/
+static bool DecodeC40Segment(BitSource& bits, std::string& result)
+{
+	return DecodeC40OrTextSegment(bits, result, C40Tables());
+}
+
 /**
 * See ISO 16022:2006, 5.2.6 and Annex C, Table C.2
 */
 static bool DecodeTextSegment(BitSource& bits, std::string& result)
 {
-	// Three Text values are encoded in a 16-bit value as
-	// (1600 * C1) + (40 * C2) + C3 + 1
-	// TODO(bbrown): The Upper Shift with Text doesn't work in the 4 value scenario all the time
-	bool upperShift = false;
-
-	int shift = 0;
-	do {
-		// If there is only one byte left then it will be encoded as ASCII
-		if (bits.available() == 8) {
-			return true;
-		}
-		int firstByte = bits.readBits(8);
-		if (firstByte == 254) {  // Unlatch codeword
-			return true;
-		}
-
-		for (int cValue : ParseTwoBytes(firstByte, bits.readBits(8))) {
-			switch (shift) {
-			case 0:
-				if (cValue < 3) {
-					shift = cValue + 1;
-				}
-				else if (cValue < Size(TEXT_BASIC_SET_CHARS)) {
-					char textChar = TEXT_BASIC_SET_CHARS[cValue];
-					if (upperShift) {
-						result.push_back((char)(textChar + 128));
-						upperShift = false;
-					}
-					else {
-						result.push_back(textChar);
-					}
-				}
-				else {
-					return false;
-				}
-				break;
-			case 1:
-				if (upperShift) {
-					result.push_back((char)(cValue + 128));
-					upperShift = false;
-				}
-				else {
-					result.push_back((char)cValue);
-				}
-				shift = 0;
-				break;
-			case 2:
-				// Shift 2 for Text is the same encoding as C40
-				if (cValue < Size(TEXT_SHIFT2_SET_CHARS)) {
-					char textChar = TEXT_SHIFT2_SET_CHARS[cValue];
-					if (upperShift) {
-						result.push_back((char)(textChar + 128));
-						upperShift = false;
-					}
-					else {
-						result.push_back(textChar);
-					}
-				}
-				else if (cValue == 27) {  // FNC1
-					result.push_back((char)29); // translate as ASCII 29
-				}
-				else if (cValue == 30) {  // Upper Shift
-					upperShift = true;
-				}
-				else {
-					return false;
-				}
-				shift = 0;
-				break;
-			case 3:
-				if (cValue < Size(TEXT_SHIFT3_SET_CHARS)) {
-					char textChar = TEXT_SHIFT3_SET_CHARS[cValue];
-					if (upperShift) {
-						result.push_back((char)(textChar + 128));
-						upperShift = false;
-					}
-					else {
-						result.push_back(textChar);
-					}
-					shift = 0;
-				}
-				else {
-					return false;
-				}
-				break;
-			default:
-				return false;
-			}
-		}
-	} while (bits.available() > 0);
-	return true;
+	return DecodeC40OrTextSegment(bits, result, TextTables());
 }
 
 /**
@@ -374,6 +324,22 @@ static bool DecodeAnsiX12Segment(BitSource& bits, std::string& result)
 {
 	// Three ANSI X12 values are encoded in a 16-bit value as
 	// (1600 * C1) + (40 * C2) + C3 + 1
+	static const auto table = [] {
+		ValueTable res;
+		res.fill(INVALID);
+		res[0] = '\r'; // X12 segment terminator <CR>
+		res[1] = '*';  // X12 segment separator *
+		res[2] = '>';  // X12 sub-element separator >
+		res[3] = ' ';
+		for (int i = 4; i < 14; ++i)
+			res[i] = static_cast<int16_t>('0' + i - 4);
+		for (int i = 14; i < 40; ++i)
+			res[i] = static_cast<int16_t>('A' + i - 14);
+		return res;
+	}();
+
+	// exactly 3 characters per 2 codewords
+	result.reserve(result.size() + bits.available() / 16 * 3);
 
 	do {
 		// If there is only one byte left then it will be encoded as ASCII
@@ -385,28 +351,11 @@ static bool DecodeAnsiX12Segment(BitSource& bits, std::string& result)
 			return true;
 		}
 
-		for (auto cValue : ParseTwoBytes(firstByte, bits.readBits(8))) {
-			if (cValue == 0) {  // X12 segment terminator <CR>
-				result.push_back('\r');
-			}
-			else if (cValue == 1) {  // X12 segment separator *
-				result.push_back('*');
-			}
-			else if (cValue == 2) {  // X12 sub-element separator >
-				result.push_back('>');
-			}
-			else if (cValue == 3) {  // space
-				result.push_back(' ');
-			}
-			else if (cValue < 14) {  // 0 - 9
-				result.push_back((char)(cValue + 44));
-			}
-			else if (cValue < 40) {  // A - Z
-				result.push_back((char)(cValue + 51));
-			}
-			else {
+		for (int cValue : ParseTwoBytes(firstByte, bits.readBits(8))) {
+			if (cValue < 0 || table[cValue] == INVALID) {
 				return false;
 			}
+			result.push_back(static_cast<char>(table[cValue]));
 		}
 	} while (bits.available() > 0);
 	return true;
@@ -457,7 +406,7 @@ static int Unrandomize255State(int randomizedBase256Codeword, int base256Codewor
 /**
 * See ISO 16022:2006, 5.2.9 and Annex B, B.2
 */
-static bool DecodeBase256Segment(BitSource& bits, std::string& result, std::list<ByteArray>& byteSegments)
+static bool DecodeBase256Segment(BitSource& bits, std::string& result, ByteSegments& byteSegments)
 {
 	// Figure out how long the Base 256 Segment is.
 	int codewordPosition = 1 + bits.byteOffset(); // position is 1-indexed
@@ -470,6 +419,9 @@ static bool DecodeBase256Segment(BitSource& bits, std::string& result, std::list
 		count = d1;
 	}
 	else {
+		if (bits.available() < 8) {
+			return false;
+		}
 		count = 250 * (d1 - 249) + Unrandomize255State(bits.readBits(8), codewordPosition++);
 	}
 
@@ -478,7 +430,7 @@ static bool DecodeBase256Segment(BitSource& bits, std::string& result, std::list
 		return false;
 	}
 
-	ByteArray bytes(count);
+	uint8_t* bytes = byteSegments.append(count);
 	for (int i = 0; i < count; i++) {
 		// Have seen this particular error in the wild, such as at
 		// http://www.bcgen.com/demo/IDAutomationStreamingDataMatrix.aspx?MODE=3&D=Fred&PFMT=3&PT=F&X=0.3&O=0&LM=0.2
@@ -487,21 +439,21 @@ static bool DecodeBase256Segment(BitSource& bits, std::string& result, std::list
 		}
 		bytes[i] = (uint8_t)Unrandomize255State(bits.readBits(8), codewordPosition++);
 	}
-	byteSegments.push_back(bytes);
 
 	// bytes is in ISO-8859-1
-	result.append(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+	result.append(reinterpret_cast<const char*>(bytes), count);
 	return true;
 }
 
 ZXING_EXPORT_TEST_ONLY
 DecoderResult Decode(ByteArray&& bytes)
 {
+	DecodeStats::StageTimer timer(DecodeStats::Stage::DecodeText);
 	BitSource bits(bytes);
 	std::string result;
 	result.reserve(100);
 	std::string resultTrailer;
-	std::list<ByteArray> byteSegments;
+	ByteSegments byteSegments;
 	Mode mode = Mode::ASCII_ENCODE;
 	do {
 		if (mode == Mode::ASCII_ENCODE) {
@@ -584,6 +536,7 @@ CorrectErrors(ByteArray& codewordBytes, int numDataCodewords)
 
 DecoderResult Decoder::Decode(const BitMatrix& bits)
 {
+	ZX_TRACE_SCOPE("DataMatrix::Decoder::Decode");
 	// Construct a parser and read version, error-correction level
 	const Version* version = BitMatrixParser::ReadVersion(bits);
 	if (version == nullptr) {
@@ -16,9 +16,12 @@
 */
 
 #include "DMDefaultPlacement.h"
+#include "DMVersion.h"
 #include "ByteArray.h"
 
+#include <array>
 #include <cstdint>
+#include <mutex>
 #include <vector>
 
 namespace ZXing {
@@ -53,5 +56,41 @@ BitMatrix DefaultPlacement::Place(const ByteArray& codewords, int numCols, int n
 	return result;
 }
 
+/**
+* <p>Computes the positions of the codeword bits of a symbol of the given version in the order in which they are read,
+* i.e. the ECC200 placement of ISO 16022:2006, Annex F mapped from the data region without alignment patterns back
+* to the symbol.</p>
+*/
+static std::vector<ModulePos> ComputePlacement(const Version& version)
+{
+	int regionRows = version.dataRegionSizeRows();
+	int regionCols = version.dataRegionSizeColumns();
+	int numRows = version.symbolSizeRows() / regionRows * regionRows;
+	int numCols = version.symbolSizeColumns() / regionCols * regionCols;
+
+	std::vector<ModulePos> placement;
+	placement.reserve(8 * version.totalCodewords());
+	VisitMatrix(numRows, numCols, [&](const BitPosArray& bitPos) {
+		for (auto& p : bitPos) {
+			// each data region is surrounded by a 1 module wide finder/alignment pattern
+			int x = p.col / regionCols * (regionCols + 2) + 1 + p.col % regionCols;
+			int y = p.row / regionRows * (regionRows + 2) + 1 + p.row % regionRows;
+			placement.push_back({static_cast<uint8_t>(x), static_cast<uint8_t>(y)});
+		}
+	});
+	return placement;
+}
+
+const std::vector<ModulePos>& SymbolPlacement(const Version& version)
+{
+	static constexpr int NUM_VERSIONS = 30;
+	static std::array<std::once_flag, NUM_VERSIONS> once;
+	static std::array<std::vector<ModulePos>, NUM_VERSIONS> placements;
+
+	int i = version.versionNumber() - 1;
+	std::call_once(once[i], [&] { placements[i] = ComputePlacement(version); });
+	return placements[i];
+}
+
 } // DataMatrix
 } // ZXing
@@ -21,10 +21,14 @@
 
 #include <array>
 #include <cstddef>
+#include <cstdint>
+#include <vector>
 
 namespace ZXing {
 namespace DataMatrix {
 
+class Version;
+
 struct BitPos
 {
 	int row, col;
@@ -130,5 +134,22 @@ public:
 	static BitMatrix Place(const ByteArray& codewords, int numcols, int numrows);
 };
 
+/**
+* Position of a module in the symbol, i.e. including the finder and alignment patterns. 144 is the largest size.
+*/
+struct ModulePos
+{
+	uint8_t x, y;
+};
+
+/**
+* <p>The positions of the codeword bits of a symbol of the given version, 8 per codeword with the most significant bit
+* first, i.e. the ECC200 placement of ISO 16022:2006, Annex F mapped from the data region back to the symbol. Shared
+* by the reader and the writer.</p>
+*
+* The placement only depends on the version, so it is computed once per version on first use.
+*/
+const std::vector<ModulePos>& SymbolPlacement(const Version& version);
+
 } // DataMatrix
 } // ZXing
@@ -21,12 +21,21 @@
 //#endif
 
 #include "DMDetector.h"
+#include "BinaryBitmap.h"
 #include "BitMatrix.h"
+#include "Deadline.h"
 #include "DetectorResult.h"
 #include "ResultPoint.h"
+#include "RunLengthIndex.h"
 #include "GridSampler.h"
+#include "MemoryResource.h"
+#include "Parallel.h"
 #include "Point.h"
+#include "Quadrilateral.h"
+#include "Trace.h"
 #include "WhiteRectDetector.h"
+#include "ZXConfig.h"
+#include "ZXContainerAlgorithms.h"
 
 #ifdef PRINT_DEBUG
 #include "Matrix.h"
@@ -40,8 +49,10 @@ static LogBuffer _log;
 #include <array>
 #include <cassert>
 #include <cmath>
+#include <cstdint>
 #include <cstdlib>
 #include <map>
+#include <memory>
 #include <numeric>
 #include <utility>
 #include <vector>
@@ -72,9 +83,10 @@ struct ResultPointsAndTransitions
 
 /**
 * Counts the number of black/white transitions between two points, using something like Bresenham's algorithm.
+* Horizontal and vertical lines are looked up in the run lengths of the image instead, if they are available.
 */
-static ResultPointsAndTransitions TransitionsBetween(const BitMatrix& image, const ResultPoint& from,
-													 const ResultPoint& to)
+static ResultPointsAndTransitions TransitionsBetween(const BitMatrix& image, const RunLengthIndex* runs,
+													 const ResultPoint& from, const ResultPoint& to)
 {
 	// See QR Code Detector, sizeOfBlackWhiteBlackRun()
 	int fromX = static_cast<int>(from.x());
@@ -93,6 +105,19 @@ static ResultPointsAndTransitions TransitionsBetween(const BitMatrix& image, con
 	int ystep = fromY < toY ? 1 : -1;
 	int xstep = fromX < toX ? 1 : -1;
 	int transitions = 0;
+
+	if (runs && dy == 0) {
+		// the pixels visited below, up to but not including 'to'
+		int begin = xstep > 0 ? fromX : toX + 1;
+		int end = xstep > 0 ? toX : fromX + 1;
+		int size = steep ? image.height() : image.width();
+		int lines = steep ? image.width() : image.height();
+		if (begin >= 0 && end <= size && fromY >= 0 && fromY < lines) {
+			transitions = steep ? runs->columnTransitions(fromY, begin, end) : runs->rowTransitions(fromY, begin, end);
+			return ResultPointsAndTransitions{ &from, &to, transitions };
+		}
+	}
+
 	bool inBlack = image.get(steep ? fromY : fromX, steep ? fromX : fromY);
 	for (int x = fromX, y = fromY; x != toX; x += xstep) {
 		bool isBlack = image.get(steep ? y : x, steep ? x : y);
@@ -126,10 +151,10 @@ inline static float RoundToNearest(float x)
 * Calculates the position of the white top right module using the output of the rectangle detector
 * for a rectangular matrix
 */
-static bool CorrectTopRightRectangular(const BitMatrix& image, const ResultPoint& bottomLeft,
-									   const ResultPoint& bottomRight, const ResultPoint& topLeft,
-									   const ResultPoint& topRight, int dimensionTop, int dimensionRight,
-									   ResultPoint& result)
+static bool CorrectTopRightRectangular(const BitMatrix& image, const RunLengthIndex* runs,
+									   const ResultPoint& bottomLeft, const ResultPoint& bottomRight,
+									   const ResultPoint& topLeft, const ResultPoint& topRight, int dimensionTop,
+									   int dimensionRight, ResultPoint& result)
 {
 	float corr = RoundToNearest(distance(bottomLeft, bottomRight)) / static_cast<float>(dimensionTop);
 	float norm = RoundToNearest(distance(topLeft, topRight));
@@ -157,10 +182,10 @@ static bool CorrectTopRightRectangular(const BitMatrix& image, const ResultPoint
 		return true;
 	}
 
-	int l1 = std::abs(dimensionTop - TransitionsBetween(image, topLeft, c1).transitions) +
-			 std::abs(dimensionRight - TransitionsBetween(image, bottomRight, c1).transitions);
-	int l2 = std::abs(dimensionTop - TransitionsBetween(image, topLeft, c2).transitions) +
-			 std::abs(dimensionRight - TransitionsBetween(image, bottomRight, c2).transitions);
+	int l1 = std::abs(dimensionTop - TransitionsBetween(image, runs, topLeft, c1).transitions) +
+			 std::abs(dimensionRight - TransitionsBetween(image, runs, bottomRight, c1).transitions);
+	int l2 = std::abs(dimensionTop - TransitionsBetween(image, runs, topLeft, c2).transitions) +
+			 std::abs(dimensionRight - TransitionsBetween(image, runs, bottomRight, c2).transitions);
 
 	result = l1 <= l2 ? c1 : c2;
 	return true;
@@ -170,8 +195,9 @@ static bool CorrectTopRightRectangular(const BitMatrix& image, const ResultPoint
 * Calculates the position of the white top right module using the output of the rectangle detector
 * for a square matrix
 */
-static ResultPoint CorrectTopRight(const BitMatrix& image, const ResultPoint& bottomLeft, const ResultPoint& bottomRight,
-                                   const ResultPoint& topLeft, const ResultPoint& topRight, int dimension)
+static ResultPoint CorrectTopRight(const BitMatrix& image, const RunLengthIndex* runs, const ResultPoint& bottomLeft,
+								   const ResultPoint& bottomRight, const ResultPoint& topLeft,
+								   const ResultPoint& topRight, int dimension)
 {
 	float corr = RoundToNearest(distance(bottomLeft, bottomRight)) / (float)dimension;
 	float norm = RoundToNearest(distance(topLeft, topRight));
@@ -195,10 +221,10 @@ static ResultPoint CorrectTopRight(const BitMatrix& image, const ResultPoint& bo
 	if (!IsValidPoint(c2, image.width(), image.height()))
 		return c1;
 
-	int l1 = std::abs(TransitionsBetween(image, topLeft, c1).transitions -
-					  TransitionsBetween(image, bottomRight, c1).transitions);
-	int l2 = std::abs(TransitionsBetween(image, topLeft, c2).transitions -
-					  TransitionsBetween(image, bottomRight, c2).transitions);
+	int l1 = std::abs(TransitionsBetween(image, runs, topLeft, c1).transitions -
+					  TransitionsBetween(image, runs, bottomRight, c1).transitions);
+	int l2 = std::abs(TransitionsBetween(image, runs, topLeft, c2).transitions -
+					  TransitionsBetween(image, runs, bottomRight, c2).transitions);
 	return l1 <= l2 ? c1 : c2;
 }
 
@@ -263,10 +289,11 @@ static void OrderByBestPatterns(const ResultPoint*& p0, const ResultPoint*& p1,
 	p2 = pointC;
 }
 
-static DetectorResult DetectOld(const BitMatrix& image)
+static DetectorResult DetectOld(const BitMatrix& image, const RunLengthIndex* runs)
 {
 	ResultPoint pointA, pointB, pointC, pointD;
-	if (!WhiteRectDetector::Detect(image, pointA, pointB, pointC, pointD)) {
+	if (!(runs ? WhiteRectDetector::Detect(image, *runs, pointA, pointB, pointC, pointD)
+			   : WhiteRectDetector::Detect(image, pointA, pointB, pointC, pointD))) {
 		return {};
 	}
 
@@ -274,10 +301,10 @@ static DetectorResult DetectOld(const BitMatrix& image)
 	// as are B and C. Figure out which are the solid black lines
 	// by counting transitions
 	std::array<ResultPointsAndTransitions, 4> transitions = {
-		TransitionsBetween(image, pointA, pointB),
-		TransitionsBetween(image, pointA, pointC),
-		TransitionsBetween(image, pointB, pointD),
-		TransitionsBetween(image, pointC, pointD),
+		TransitionsBetween(image, runs, pointA, pointB),
+		TransitionsBetween(image, runs, pointA, pointC),
+		TransitionsBetween(image, runs, pointB, pointD),
+		TransitionsBetween(image, runs, pointC, pointD),
 	};
 	std::sort(transitions.begin(), transitions.end(),
 			  [](const ResultPointsAndTransitions& a, const ResultPointsAndTransitions& b) {
@@ -347,8 +374,8 @@ static DetectorResult DetectOld(const BitMatrix& image)
 	// adjacent to the white module at the top right. Tracing to that corner from either the top left
 	// or bottom right should work here.
 
-	int dimensionTop = TransitionsBetween(image, *topLeft, *topRight).transitions;
-	int dimensionRight = TransitionsBetween(image, *bottomRight, *topRight).transitions;
+	int dimensionTop = TransitionsBetween(image, runs, *topLeft, *topRight).transitions;
+	int dimensionRight = TransitionsBetween(image, runs, *bottomRight, *topRight).transitions;
 
 	if ((dimensionTop & 0x01) == 1) {
 		// it can't be odd, so, round... up?
@@ -373,13 +400,13 @@ static DetectorResult DetectOld(const BitMatrix& image)
 	if (4 * dimensionTop >= 7 * dimensionRight || 4 * dimensionRight >= 7 * dimensionTop) {
 		// The matrix is rectangular
 
-		if (!CorrectTopRightRectangular(image, *bottomLeft, *bottomRight, *topLeft, *topRight, dimensionTop,
+		if (!CorrectTopRightRectangular(image, runs, *bottomLeft, *bottomRight, *topLeft, *topRight, dimensionTop,
 										dimensionRight, correctedTopRight)) {
 			correctedTopRight = *topRight;
 		}
 
-		dimensionTop = TransitionsBetween(image, *topLeft, correctedTopRight).transitions;
-		dimensionRight = TransitionsBetween(image, *bottomRight, correctedTopRight).transitions;
+		dimensionTop = TransitionsBetween(image, runs, *topLeft, correctedTopRight).transitions;
+		dimensionRight = TransitionsBetween(image, runs, *bottomRight, correctedTopRight).transitions;
 
 		if ((dimensionTop & 0x01) == 1) {
 			// it can't be odd, so, round... up?
@@ -396,11 +423,11 @@ static DetectorResult DetectOld(const BitMatrix& image)
 
 		int dimension = std::min(dimensionRight, dimensionTop);
 		// correct top right point to match the white module
-		correctedTopRight = CorrectTopRight(image, *bottomLeft, *bottomRight, *topLeft, *topRight, dimension);
+		correctedTopRight = CorrectTopRight(image, runs, *bottomLeft, *bottomRight, *topLeft, *topRight, dimension);
 
 		// Redetermine the dimension using the corrected top right point
-		int dimensionCorrected = std::max(TransitionsBetween(image, *topLeft, correctedTopRight).transitions,
-		                                  TransitionsBetween(image, *bottomRight, correctedTopRight).transitions);
+		int dimensionCorrected = std::max(TransitionsBetween(image, runs, *topLeft, correctedTopRight).transitions,
+		                                  TransitionsBetween(image, runs, *bottomRight, correctedTopRight).transitions);
 		dimensionCorrected++;
 		if ((dimensionCorrected & 0x01) == 1) {
 			dimensionCorrected++;
@@ -423,20 +450,32 @@ static DetectorResult DetectOld(const BitMatrix& image)
 class RegressionLine
 {
 	std::vector<PointI> _points;
+	std::vector<double> _gapSizes; // scratch buffer of modules()
 	PointF _directionInward;
 	double a = NAN, b = NAN, c = NAN;
+	// running sums over _points, so that (re-)fitting the line is O(1)
+	int64_t _sumX = 0, _sumY = 0, _sumXX = 0, _sumYY = 0, _sumXY = 0;
 
 	friend PointF intersect(const RegressionLine& l1, const RegressionLine& l2);
 
-	bool evaluate(const std::vector<PointI>& ps)
+	void accumulate(PointI p, int sign)
 	{
-		auto mean = std::accumulate(ps.begin(), ps.end(), PointF()) / ps.size();
-		double sumXX = 0, sumYY = 0, sumXY = 0;
-		for (auto& p : ps) {
-			sumXX += (p.x - mean.x) * (p.x - mean.x);
-			sumYY += (p.y - mean.y) * (p.y - mean.y);
-			sumXY += (p.x - mean.x) * (p.y - mean.y);
-		}
+		_sumX += sign * p.x;
+		_sumY += sign * p.y;
+		_sumXX += sign * int64_t(p.x) * p.x;
+		_sumYY += sign * int64_t(p.y) * p.y;
+		_sumXY += sign * int64_t(p.x) * p.y;
+	}
+
+	bool fit()
+	{
+		// least squares fit of the points: the sums of the squared deviations from the mean, scaled by the number
+		// of points n (which cancels out below), are n * sum(x*x) - sum(x) * sum(x), etc.
+		int64_t n = _points.size();
+		auto mean = PointF(_sumX, _sumY) / n;
+		double sumXX = n * _sumXX - _sumX * _sumX;
+		double sumYY = n * _sumYY - _sumY * _sumY;
+		double sumXY = n * _sumXY - _sumX * _sumY;
 		if (sumYY >= sumXX) {
 			a = +sumYY / std::sqrt(sumYY * sumYY + sumXY * sumXY);
 			b = -sumXY / std::sqrt(sumYY * sumYY + sumXY * sumXY);
@@ -478,41 +517,59 @@ public:
 	void add(PointI p) {
 		assert(_directionInward != PointF());
 		_points.push_back(p);
+		accumulate(p, 1);
 		if (_points.size() == 1)
 			c = normal() * p;
 	}
 
-	void pop_back() { _points.pop_back(); }
+	void pop_back()
+	{
+		accumulate(_points.back(), -1);
+		_points.pop_back();
+	}
+
+	/// Reset to a default constructed line but keep the allocated storage.
+	void clear()
+	{
+		_points.clear();
+		_directionInward = {};
+		a = b = c = NAN;
+		_sumX = _sumY = _sumXX = _sumYY = _sumXY = 0;
+	}
 
 	void setDirectionInward(PointF d) { _directionInward = normalized(d); }
 
 	bool evaluate(double maxDist = -1)
 	{
-		auto ps = _points;
-		bool ret = evaluate(ps);
+		bool ret = fit();
 		if (maxDist > 0) {
 			size_t old_points_size;
 			while (true) {
 				old_points_size = _points.size();
 				_points.erase(std::remove_if(_points.begin(), _points.end(),
-											 [this, maxDist](PointI p) { return this->signedDistance(p) > maxDist; }),
+											 [this, maxDist](PointI p) {
+												 if (this->signedDistance(p) <= maxDist)
+													 return false;
+												 accumulate(p, -1);
+												 return true;
+											 }),
 							  _points.end());
 				if (old_points_size == _points.size())
 					break;
 #ifdef PRINT_DEBUG
 				printf("removed %zu points\n", old_points_size - _points.size());
 #endif
-				ret = evaluate(_points);
+				ret = fit();
 			}
 		}
 		return ret;
 	}
 
-	double modules(PointF beg, PointF end) const
+	double modules(PointF beg, PointF end)
 	{
 		assert(_points.size() > 3);
-		std::vector<double> gapSizes;
-		gapSizes.reserve(_points.size());
+		auto& gapSizes = _gapSizes;
+		gapSizes.clear();
 
 		// calculate the distance between the points projected onto the regression line
 		for (size_t i = 1; i < _points.size(); ++i)
@@ -686,6 +743,7 @@ public:
 		return true;
 	}
 
+	PointI position() const { return p; }
 	PointF front() const { return d; }
 	PointF back() const { return {-d.x, -d.y}; }
 	PointF right() const { return {-d.y, d.x}; }
@@ -848,152 +906,170 @@ static DetectorResult SampleGrid(const BitMatrix& image, PointF tl, PointF bl, P
 	return SampleGrid(image, width, height, PerspectiveTransform(Rectangle(width, height, 0), {tl, tr, br, bl}));
 }
 
-static DetectorResult DetectNew(const BitMatrix& image, bool tryRotate)
+/**
+* Tries to trace the L-shape and the timing pattern of a symbol starting at the white/black edge "startTracer" is
+* located on.
+*/
+static DetectorResult DetectAtEdge(const BitMatrix& image, const EdgeTracer& startTracer, std::array<RegressionLine, 4>& lines)
 {
-	// walk to the left at first
-	for (auto startDirection : {PointF(-1, 0), PointF(1, 0), PointF(0, -1), PointF(0, 1)}) {
-		EdgeTracer startTracer(image, PointF(image.width()/2, image.height()/2), startDirection);
-		while (startTracer.step()) {
-			// go forward until we reach a white/black border
-			if (!startTracer.isEdgeBehind())
-				continue;
-
-#ifdef PRINT_DEBUG
-#define continue { \
-			printf("broke at %d\n", __LINE__); \
-			for (auto* l : {&lineL, &lineB, &lineT, &lineR}) log(l->points()); \
-			continue; \
-		}
-#endif
-
-			PointF tl, bl, br, tr;
-			RegressionLine lineL, lineB, lineR, lineT;
-
-			auto t = startTracer;
-
-			// follow left leg upwards
-			t.setDirection(t.right());
-			if (!t.traceLine(t.right(), lineL))
-				continue;
+	PointF tl, bl, br, tr;
+	// the lines are reused across start positions to not allocate their point storage again for every attempt
+	for (auto& l : lines)
+		l.clear();
+	auto& lineL = lines[0];
+	auto& lineB = lines[1];
+	auto& lineR = lines[2];
+	auto& lineT = lines[3];
+
+	auto t = startTracer;
+
+	// follow left leg upwards
+	t.setDirection(t.right());
+	if (!t.traceLine(t.right(), lineL))
+		return {};
 
-			if (!t.traceCorner(t.right(), tl))
-				continue;
-			lineL.reverse();
-			auto tlTracer = t;
+	if (!t.traceCorner(t.right(), tl))
+		return {};
+	lineL.reverse();
+	auto tlTracer = t;
 
-			// follow left leg downwards
-			t = startTracer;
-			t.setDirection(tlTracer.right());
-			if (!t.traceLine(t.left(), lineL))
-				continue;
+	// follow left leg downwards
+	t = startTracer;
+	t.setDirection(tlTracer.right());
+	if (!t.traceLine(t.left(), lineL))
+		return {};
 
-			if (!lineL.isValid())
-				t.updateDirectionFromOrigin(tl);
-			auto up = t.back();
-			if (!t.traceCorner(t.left(), bl))
-				continue;
+	if (!lineL.isValid())
+		t.updateDirectionFromOrigin(tl);
+	auto up = t.back();
+	if (!t.traceCorner(t.left(), bl))
+		return {};
 
-			// follow bottom leg right
-			if (!t.traceLine(t.left(), lineB))
-				continue;
+	// follow bottom leg right
+	if (!t.traceLine(t.left(), lineB))
+		return {};
 
-			if (!lineB.isValid())
-				t.updateDirectionFromOrigin(bl);
-			auto right = t.front();
-			if (!t.traceCorner(t.left(), br))
-				continue;
+	if (!lineB.isValid())
+		t.updateDirectionFromOrigin(bl);
+	auto right = t.front();
+	if (!t.traceCorner(t.left(), br))
+		return {};
 
-			auto lenL = distance(tl, bl) - 1;
-			auto lenB = distance(bl, br) - 1;
-			if (lenL < 10 || lenB < 10 || lenB < lenL / 4 || lenB > lenL * 8)
-				continue;
+	auto lenL = distance(tl, bl) - 1;
+	auto lenB = distance(bl, br) - 1;
+	if (lenL < 10 || lenB < 10 || lenB < lenL / 4 || lenB > lenL * 8)
+		return {};
 
-			auto maxStepSize = static_cast<int>(lenB / 5 + 1); // datamatrix dim is at least 10x10
+	auto maxStepSize = static_cast<int>(lenB / 5 + 1); // datamatrix dim is at least 10x10
 
-			// at this point we found a plausible L-shape and are now looking for the b/w pattern at the top and right:
-			// follow top row right 'half way' (4 gaps), see traceGaps break condition with 'invalid' line
-			tlTracer.setDirection(right);
-			if (!tlTracer.traceGaps(tlTracer.right(), lineT, maxStepSize, RegressionLine()))
-				continue;
+	// at this point we found a plausible L-shape and are now looking for the b/w pattern at the top and right:
+	// follow top row right 'half way' (4 gaps), see traceGaps break condition with 'invalid' line
+	tlTracer.setDirection(right);
+	if (!tlTracer.traceGaps(tlTracer.right(), lineT, maxStepSize, RegressionLine()))
+		return {};
 
-			maxStepSize = std::min(lineT.length() / 3, static_cast<int>(lenL / 5)) * 2;
+	maxStepSize = std::min(lineT.length() / 3, static_cast<int>(lenL / 5)) * 2;
 
-			// follow up until we reach the top line
-			t.setDirection(up);
-			if (!t.traceGaps(t.left(), lineR, maxStepSize, lineT))
-				continue;
+	// follow up until we reach the top line
+	t.setDirection(up);
+	if (!t.traceGaps(t.left(), lineR, maxStepSize, lineT))
+		return {};
 
-			if (!t.traceCorner(t.left(), tr))
-				continue;
+	if (!t.traceCorner(t.left(), tr))
+		return {};
 
-			auto lenT = distance(tl, tr) - 1;
-			auto lenR = distance(tr, br) - 1;
+	auto lenT = distance(tl, tr) - 1;
+	auto lenR = distance(tr, br) - 1;
 
-			if (std::abs(lenT - lenB) / lenB > 0.5 || std::abs(lenR - lenL) / lenL > 0.5 ||
-			        lineT.points().size() < 5 || lineR.points().size() < 5)
-				continue;
+	if (std::abs(lenT - lenB) / lenB > 0.5 || std::abs(lenR - lenL) / lenL > 0.5 ||
+	        lineT.points().size() < 5 || lineR.points().size() < 5)
+		return {};
 
-			// continue top row right until we cross the right line
-			if (!tlTracer.traceGaps(tlTracer.right(), lineT, maxStepSize, lineR))
-				continue;
+	// continue top row right until we cross the right line
+	if (!tlTracer.traceGaps(tlTracer.right(), lineT, maxStepSize, lineR))
+		return {};
 
 #ifdef PRINT_DEBUG
-			printf("L: %f, %f ^ %f, %f > %f, %f (%d : %d : %d : %d)\n", bl.x, bl.y,
-			       tl.x - bl.x, tl.y - bl.y, br.x - bl.x, br.y - bl.y, (int)lenL, (int)lenB, (int)lenT, (int)lenR);
+	printf("L: %f, %f ^ %f, %f > %f, %f (%d : %d : %d : %d)\n", bl.x, bl.y,
+	       tl.x - bl.x, tl.y - bl.y, br.x - bl.x, br.y - bl.y, (int)lenL, (int)lenB, (int)lenT, (int)lenR);
 #endif
 
-			for (RegressionLine* l : {&lineL, &lineB, &lineT, &lineR})
-				l->evaluate(1.0);
+	for (RegressionLine* l : {&lineL, &lineB, &lineT, &lineR})
+		l->evaluate(1.0);
 
-			// find the bounding box corners of the code with sub-pixel precision by intersecting the 4 border lines
-			bl = intersect(lineB, lineL);
-			tl = intersect(lineT, lineL);
-			tr = intersect(lineT, lineR);
-			br = intersect(lineB, lineR);
+	// find the bounding box corners of the code with sub-pixel precision by intersecting the 4 border lines
+	bl = intersect(lineB, lineL);
+	tl = intersect(lineT, lineL);
+	tr = intersect(lineT, lineR);
+	br = intersect(lineB, lineR);
 
-			int dimT, dimR;
-			double fracT, fracR;
-			auto splitDouble = [](double d, int* i, double* f) {
-				*i = std::isnormal(d) ? static_cast<int>(d + 0.5) : 0;
-				*f = std::isnormal(d) ? std::abs(d - *i) : INFINITY;
-			};
-			splitDouble(lineT.modules(tl, tr), &dimT, &fracT);
-			splitDouble(lineR.modules(br, tr), &dimR, &fracR);
+	int dimT, dimR;
+	double fracT, fracR;
+	auto splitDouble = [](double d, int* i, double* f) {
+		*i = std::isnormal(d) ? static_cast<int>(d + 0.5) : 0;
+		*f = std::isnormal(d) ? std::abs(d - *i) : INFINITY;
+	};
+	splitDouble(lineT.modules(tl, tr), &dimT, &fracT);
+	splitDouble(lineR.modules(br, tr), &dimR, &fracR);
 
 #ifdef PRINT_DEBUG
-			printf("L: %f, %f ^ %f, %f > %f, %f ^> %f, %f\n", bl.x, bl.y,
-			       tl.x - bl.x, tl.y - bl.y, br.x - bl.x, br.y - bl.y, tr.x, tr.y);
-			printf("dim: %d x %d\n", dimT, dimR);
+	printf("L: %f, %f ^ %f, %f > %f, %f ^> %f, %f\n", bl.x, bl.y,
+	       tl.x - bl.x, tl.y - bl.y, br.x - bl.x, br.y - bl.y, tr.x, tr.y);
+	printf("dim: %d x %d\n", dimT, dimR);
 #endif
 
-			// if we have an invalid rectangular data matrix dimension, we try to parse it by assuming a square
-			// we use the dimension that is closer to an integral value
-			if (dimT < 2 * dimR || dimT > 4 * dimR)
-				dimT = dimR = fracR < fracT ? dimR : dimT;
+	// if we have an invalid rectangular data matrix dimension, we try to parse it by assuming a square
+	// we use the dimension that is closer to an integral value
+	if (dimT < 2 * dimR || dimT > 4 * dimR)
+		dimT = dimR = fracR < fracT ? dimR : dimT;
 
-			// the dimension is 2x the number of black/white transitions
-			dimT *= 2;
-			dimR *= 2;
+	// the dimension is 2x the number of black/white transitions
+	dimT *= 2;
+	dimR *= 2;
 
-			if (dimT < 10 || dimT > 144 || dimR < 8 || dimR > 144 )
-				continue;
+	if (dimT < 10 || dimT > 144 || dimR < 8 || dimR > 144 )
+		return {};
 
-			auto res = SampleGrid(image, tl, bl, br, tr, dimT, dimR);
+	auto res = SampleGrid(image, tl, bl, br, tr, dimT, dimR);
 
 #ifdef PRINT_DEBUG
-			printf("modules top: %d, right: %d\n", dimT, dimR);
-			printf("%s", ToString(bits).c_str());
+	printf("modules top: %d, right: %d\n", dimT, dimR);
+	printf("%s", ToString(bits).c_str());
 
-			for (RegressionLine* l : {&lineL, &lineB, &lineT, &lineR})
-				log(l->points());
+	for (RegressionLine* l : {&lineL, &lineB, &lineT, &lineR})
+		log(l->points());
 
-			dumpDebugPPM(image, "binary.pnm");
+	dumpDebugPPM(image, "binary.pnm");
 #endif
 
-			if (!res.isValid())
+	return res;
+}
+
+static DetectorResult DetectNew(const BitMatrix& image, bool tryRotate, int scanStride)
+{
+	// reused for all start positions, see DetectAtEdge and ZX_THREAD_LOCAL
+	ZX_THREAD_LOCAL std::array<RegressionLine, 4> lines;
+
+	// walk to the left at first
+	for (auto startDirection : {PointF(-1, 0), PointF(1, 0), PointF(0, -1), PointF(0, 1)}) {
+		EdgeTracer startTracer(image, PointF(image.width()/2, image.height()/2), startDirection);
+		PointF lastStart(-scanStride, -scanStride);
+		while (startTracer.step()) {
+			if (Deadline::Expired())
+				return {};
+
+			// go forward until we reach a white/black border
+			if (!startTracer.isEdgeBehind())
+				continue;
+
+			// with a scanStride > 1 only try edges at least that far apart (see DecodeHints::scanStride)
+			if (scanStride > 1 && distance(PointF(startTracer.position()), lastStart) < scanStride)
 				continue;
+			lastStart = PointF(startTracer.position());
 
-			return res;
+			auto res = DetectAtEdge(image, startTracer, lines);
+			if (res.isValid())
+				return res;
 		}
 		// reached border of image -> try next scan direction
 #ifndef PRINT_DEBUG
@@ -1009,6 +1085,89 @@ static DetectorResult DetectNew(const BitMatrix& image, bool tryRotate)
 	return {};
 }
 
+/**
+* Walks from "origin" in direction "dir" across the whole image and tries every white/black edge on the way as the
+* start of an L-shape. Edges inside a symbol found earlier on the same line are skipped, as are edges closer than
+* scanStride pixels to the last one tried.
+*/
+static std::vector<DetectorResult> DetectAlongLine(const BitMatrix& image, PointF origin, PointF dir, int scanStride)
+{
+	std::vector<DetectorResult> res;
+	ZX_THREAD_LOCAL std::array<RegressionLine, 4> lines;
+	EdgeTracer startTracer(image, origin, dir);
+	PointF lastStart = origin - scanStride * dir;
+	do {
+		if (Deadline::Expired())
+			break;
+		if (!startTracer.isEdgeBehind())
+			continue;
+		PointF p(startTracer.position());
+		if (std::any_of(res.begin(), res.end(), [p](const DetectorResult& r) { return IsInside(r.position(), p); }))
+			continue;
+		if (scanStride > 1 && distance(p, lastStart) < scanStride)
+			continue;
+		lastStart = p;
+		auto r = DetectAtEdge(image, startTracer, lines);
+		if (r.isValid())
+			res.push_back(std::move(r));
+	} while (startTracer.step());
+	return res;
+}
+
+std::vector<DetectorResult> Detector::DetectMultiple(const BitMatrix& image, bool tryRotate, int threads,
+														int scanStride)
+{
+	// Seed lines every 16 pixels (fewer on large images) are dense enough to cross every symbol from a size of
+	// about 1.5 pixels per module on. A scanStride > 1 trades the smallest symbols for fewer lines.
+	scanStride = std::max(1, scanStride);
+	int width = image.width(), height = image.height();
+	int spacing = std::max(16, std::max(width, height) / 64) * scanStride;
+
+	// the walking direction determines which orientation of the L-shape is found (see DetectNew)
+	std::vector<std::pair<PointF, PointF>> lines;
+	for (int y = spacing / 2; y < height; y += spacing)
+		lines.emplace_back(PointF(width - 1, y), PointF(-1, 0));
+	if (tryRotate) {
+		for (int y = spacing / 2; y < height; y += spacing)
+			lines.emplace_back(PointF(0, y), PointF(1, 0));
+		for (int x = spacing / 2; x < width; x += spacing) {
+			lines.emplace_back(PointF(x, height - 1), PointF(0, -1));
+			lines.emplace_back(PointF(x, 0), PointF(0, 1));
+		}
+	}
+
+	// every line is traced independently, so the result does not depend on the number of threads
+	std::vector<std::vector<DetectorResult>> found(lines.size());
+	int numTasks = std::max(1, std::min(threads, Size(lines)));
+	auto traceLines = [&](int task) {
+		for (int i = task; i < Size(lines); i += numTasks)
+			found[i] = DetectAlongLine(image, lines[i].first, lines[i].second, scanStride);
+	};
+	if (numTasks > 1) {
+		const Deadline* deadline = Deadline::Current();
+		MemoryResource* memoryResource = MemoryResource::Current();
+		ParallelFor(numTasks, [&](int task) {
+			// The deadline and memory resource are installed per thread, so forward the ones of the calling thread
+			std::unique_ptr<Deadline::Scope> scope(deadline ? new Deadline::Scope(*deadline) : nullptr);
+			MemoryResource::Scope memoryScope(memoryResource);
+			traceLines(task);
+		});
+	} else {
+		traceLines(0);
+	}
+
+	std::vector<DetectorResult> res;
+	for (auto& rs : found)
+		for (auto& r : rs) {
+			auto center = Center(r.position());
+			if (std::none_of(res.begin(), res.end(), [&](const DetectorResult& o) {
+					return IsInside(o.position(), center) || IsInside(r.position(), Center(o.position()));
+				}))
+				res.push_back(std::move(r));
+		}
+	return res;
+}
+
 /**
 * This method detects a code in a "pure" image -- that is, pure monochrome image
 * which contains only an unrotated, unskewed, image of a code, with some white border
@@ -1046,14 +1205,33 @@ static DetectorResult DetectPure(const BitMatrix& image)
 			{{left, top}, {right, top}, {right, bottom}, {left, bottom}}};
 }
 
-DetectorResult Detector::Detect(const BitMatrix& image, bool tryHarder, bool tryRotate, bool isPure)
+DetectorResult Detector::Detect(const BitMatrix& image, bool tryHarder, bool tryRotate, bool isPure, int scanStride)
 {
+	ZX_TRACE_SCOPE("DataMatrix::Detector::Detect");
 	if (isPure)
 		return DetectPure(image);
 
-	auto result = DetectNew(image, tryRotate);
-	if (!result.isValid() && tryHarder)
-		result = DetectOld(image);
+	auto result = DetectNew(image, tryRotate, scanStride);
+	if (!result.isValid() && tryHarder && !Deadline::Expired())
+		result = DetectOld(image, nullptr);
+	return result;
+}
+
+DetectorResult Detector::Detect(const BinaryBitmap& image, bool tryHarder, bool tryRotate, bool isPure,
+								int scanStride)
+{
+	auto binImg = image.getBitMatrix();
+	if (binImg == nullptr)
+		return {};
+
+	ZX_TRACE_SCOPE("DataMatrix::Detector::Detect");
+	if (isPure)
+		return DetectPure(*binImg);
+
+	auto result = DetectNew(*binImg, tryRotate, scanStride);
+	// the run lengths are only computed (or taken from an earlier reader) if the fallback is needed
+	if (!result.isValid() && tryHarder && !Deadline::Expired())
+		result = DetectOld(*binImg, image.getRunLengths());
 	return result;
 }
 
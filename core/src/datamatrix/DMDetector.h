@@ -16,8 +16,11 @@
 * limitations under the License.
 */
 
+#include <vector>
+
 namespace ZXing {
 
+class BinaryBitmap;
 class BitMatrix;
 class DetectorResult;
 
@@ -35,10 +38,30 @@ public:
 	/**
 	* <p>Detects a Data Matrix Code in an image.</p>
 	*
+	* @param scanStride only edges at least that many pixels apart are tried as the start of a symbol
 	* @return {@link DetectorResult} encapsulating results of detecting a Data Matrix Code
 	* @throws NotFoundException if no Data Matrix Code can be found
 	*/
-	static DetectorResult Detect(const BitMatrix& image, bool tryHarder, bool tryRotate, bool isPure);
+	static DetectorResult Detect(const BitMatrix& image, bool tryHarder, bool tryRotate, bool isPure,
+								 int scanStride = 1);
+
+	/**
+	* Same as above, but the tryHarder fallback, which looks for a white rectangle around the image center, uses the
+	* run lengths of the image (see BinaryBitmap::getRunLengths) instead of stepping through the pixels.
+	*/
+	static DetectorResult Detect(const BinaryBitmap& image, bool tryHarder, bool tryRotate, bool isPure,
+								 int scanStride = 1);
+
+	/**
+	* <p>Detects all Data Matrix Codes in an image. Instead of only walking from the image center, the edge tracer
+	* is started from every white/black edge on a grid of horizontal (and with tryRotate also vertical) lines.
+	* The lines are traced concurrently (see ParallelFor) if threads > 1, which does not change the result.
+	* With a scanStride > 1 the lines are that many times further apart and edges are skipped as in Detect.</p>
+	*
+	* @return one {@link DetectorResult} per symbol, ordered by the line they were first found on
+	*/
+	static std::vector<DetectorResult> DetectMultiple(const BitMatrix& image, bool tryRotate, int threads = 1,
+													  int scanStride = 1);
 };
 
 } // DataMatrix
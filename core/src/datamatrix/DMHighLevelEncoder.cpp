@@ -28,6 +28,7 @@
 #include <string>
 #include <algorithm>
 #include <array>
+#include <deque>
 #include <limits>
 #include <cmath>
 #include <numeric>
@@ -949,5 +950,371 @@ HighLevelEncoder::Encode(const std::wstring& msg, SymbolShape shape, int minWdit
 	return context.codewords();
 }
 
+namespace MinimalEncoder {
+
+	// The graph nodes per message position: ASCII, C40/Text/X12 with 0..2 and EDIFACT with 0..3 values that are not
+	// written yet, and the end of a Base 256 segment. Leaving any mode other than ASCII goes through ASCII.
+	static const int ASCII_NODE = 0;
+	static const int C40_NODE = 1;
+	static const int TEXT_NODE = 4;
+	static const int X12_NODE = 7;
+	static const int EDIFACT_NODE = 10;
+	static const int BASE256_NODE = 14;
+	static const int NODE_COUNT = 15;
+
+	static const int UNREACHABLE = std::numeric_limits<int>::max();
+	static const int MAX_SHORT_BASE256_LENGTH = 249; // longer segments need a 2 byte length field
+
+	struct Node
+	{
+		int cost = UNREACHABLE;
+		int prevPos = -1;
+		int prevNode = -1;
+	};
+
+	struct ValueCounts
+	{
+		// number of C40/Text/X12 values needed for each byte, 0 if it can not be encoded
+		std::array<uint8_t, 256> c40, text, x12;
+	};
+
+	static const ValueCounts& GetValueCounts()
+	{
+		static const ValueCounts counts = [] {
+			ValueCounts res;
+			std::string buffer;
+			for (int c = 0; c < 256; ++c) {
+				res.c40[c] = static_cast<uint8_t>(C40Encoder::EncodeChar(c, buffer));
+				res.text[c] = static_cast<uint8_t>(DMTextEncoder::EncodeChar(c, buffer));
+				res.x12[c] = IsNativeX12(c) ? 1 : 0;
+			}
+			return res;
+		}();
+		return counts;
+	}
+
+	static int NodeMode(int node)
+	{
+		if (node >= BASE256_NODE)
+			return BASE256_ENCODATION;
+		if (node >= EDIFACT_NODE)
+			return EDIFACT_ENCODATION;
+		if (node >= X12_NODE)
+			return X12_ENCODATION;
+		if (node >= TEXT_NODE)
+			return TEXT_ENCODATION;
+		if (node >= C40_NODE)
+			return C40_ENCODATION;
+		return ASCII_ENCODATION;
+	}
+
+	// codewords written when unlatching EDIFACT with the given number of buffered values: the values plus the unlatch
+	// value (31) packed into 6 bits each
+	static int EdifactUnlatchSize(int pending)
+	{
+		return pending == 3 ? 3 : pending + 1;
+	}
+
+	/**
+	* Finds the shortest path through the graph of (position, mode) nodes. Every edge either encodes one character
+	* (two digits in ASCII) or switches mode. Nodes only depend on earlier positions, so one pass is enough.
+	*/
+	static std::vector<Node> FindShortestPaths(const std::string& msg, int start, int end, int prefixCost, bool longEdifactUnlatch)
+	{
+		const auto& counts = GetValueCounts();
+		int n = end - start;
+		std::vector<Node> nodes((n + 1) * NODE_COUNT);
+		auto at = [&](int pos, int node) -> Node& { return nodes[pos * NODE_COUNT + node]; };
+		auto relax = [&](int pos, int node, int cost, int prevPos, int prevNode) {
+			auto& dst = at(pos, node);
+			if (cost < dst.cost)
+				dst = {cost, prevPos, prevNode};
+		};
+
+		at(0, ASCII_NODE).cost = prefixCost;
+
+		// Base 256 segments cost 2 + length codewords (3 + length if the length is > 249). The best entry position
+		// for short segments is kept in a monotonic queue, for long ones a single running minimum suffices.
+		std::deque<int> window;
+		int longEntry = -1;
+		auto entryKey = [&](int pos) { return at(pos, ASCII_NODE).cost - pos; };
+
+		for (int pos = 0; pos <= n; ++pos) {
+			if (pos > 0 && at(pos - 1, ASCII_NODE).cost < UNREACHABLE) {
+				while (!window.empty() && entryKey(window.back()) >= entryKey(pos - 1))
+					window.pop_back();
+				window.push_back(pos - 1);
+			}
+			while (!window.empty() && window.front() < pos - MAX_SHORT_BASE256_LENGTH)
+				window.pop_front();
+			int longPos = pos - MAX_SHORT_BASE256_LENGTH - 1;
+			if (longPos >= 0 && at(longPos, ASCII_NODE).cost < UNREACHABLE
+				&& (longEntry < 0 || entryKey(longPos) < entryKey(longEntry)))
+				longEntry = longPos;
+			if (!window.empty())
+				relax(pos, BASE256_NODE, entryKey(window.front()) + pos + 2, window.front(), ASCII_NODE);
+			if (longEntry >= 0)
+				relax(pos, BASE256_NODE, entryKey(longEntry) + pos + 3, longEntry, ASCII_NODE);
+
+			// unlatch to ASCII, C40 and Text can pad an incomplete triplet with a Shift 1
+			auto unlatch = [&](int node, int extra) {
+				if (at(pos, node).cost < UNREACHABLE)
+					relax(pos, ASCII_NODE, at(pos, node).cost + extra, pos, node);
+			};
+			unlatch(BASE256_NODE, 0);
+			for (int node : {C40_NODE, TEXT_NODE}) {
+				unlatch(node, 1);
+				unlatch(node + 2, 3);
+			}
+			unlatch(X12_NODE, 1);
+			// the decoder reads the last 1 or 2 codewords of a symbol as ASCII, so a short EDIFACT unlatch at the very
+			// end would be misread, see Encode() below
+			for (int r = longEdifactUnlatch ? 2 : 0; r < 4; ++r)
+				unlatch(EDIFACT_NODE + r, EdifactUnlatchSize(r));
+
+			int asciiCost = at(pos, ASCII_NODE).cost;
+			if (asciiCost == UNREACHABLE)
+				continue;
+			for (int node : {C40_NODE, TEXT_NODE, X12_NODE, EDIFACT_NODE})
+				relax(pos, node, asciiCost + 1, pos, ASCII_NODE);
+
+			if (pos == n)
+				break;
+
+			int c = (uint8_t)msg[start + pos];
+			if (pos + 1 < n && IsDigit(c) && IsDigit(msg[start + pos + 1]))
+				relax(pos + 2, ASCII_NODE, asciiCost + 1, pos, ASCII_NODE);
+			else
+				relax(pos + 1, ASCII_NODE, asciiCost + (IsExtendedASCII(c) ? 2 : 1), pos, ASCII_NODE);
+
+			const std::pair<int, const std::array<uint8_t, 256>*> valueCounts[] = {
+				{C40_NODE, &counts.c40}, {TEXT_NODE, &counts.text}, {X12_NODE, &counts.x12}};
+			for (auto& modeCounts : valueCounts) {
+				int node = modeCounts.first;
+				int k = (*modeCounts.second)[c];
+				if (k == 0)
+					continue;
+				for (int r = 0; r < 3; ++r) {
+					int cost = at(pos, node + r).cost;
+					if (cost < UNREACHABLE)
+						relax(pos + 1, node + (r + k) % 3, cost + 2 * ((r + k) / 3), pos, node + r);
+				}
+			}
+
+			if (IsNativeEDIFACT(c)) {
+				for (int r = 0; r < 4; ++r) {
+					int cost = at(pos, EDIFACT_NODE + r).cost;
+					if (cost < UNREACHABLE)
+						relax(pos + 1, EDIFACT_NODE + (r + 1) % 4, cost + (r == 3 ? 3 : 0), pos, EDIFACT_NODE + r);
+				}
+			}
+		}
+		return nodes;
+	}
+
+	static int AsciiCost(const std::string& msg, int begin, int end)
+	{
+		int cost = 0;
+		for (int i = begin; i < end; ++i) {
+			if (i + 1 < end && IsDigit(msg[i]) && IsDigit(msg[i + 1]))
+				++i;
+			cost += IsExtendedASCII((uint8_t)msg[i]) ? 2 : 1;
+		}
+		return cost;
+	}
+
+	static void WriteAscii(const std::string& msg, int begin, int end, ByteArray& codewords)
+	{
+		for (int i = begin; i < end; ++i) {
+			int c = (uint8_t)msg[i];
+			if (i + 1 < end && IsDigit(c) && IsDigit(msg[i + 1])) {
+				codewords.push_back(ASCIIEncoder::EncodeASCIIDigits(c, msg[++i]));
+			}
+			else if (IsExtendedASCII(c)) {
+				codewords.push_back(UPPER_SHIFT);
+				codewords.push_back(static_cast<uint8_t>(c - 128 + 1));
+			}
+			else {
+				codewords.push_back(static_cast<uint8_t>(c + 1));
+			}
+		}
+	}
+
+	static void WriteTriplets(std::string& buffer, ByteArray& codewords)
+	{
+		while (buffer.length() >= 3) {
+			int v = (1600 * buffer[0]) + (40 * buffer[1]) + buffer[2] + 1;
+			codewords.push_back(static_cast<uint8_t>(v / 256));
+			codewords.push_back(static_cast<uint8_t>(v % 256));
+			buffer.erase(0, 3);
+		}
+	}
+
+	/**
+	* Writes the codewords along the path that ends in the given node. Returns the start of the last EDIFACT unlatch
+	* that is shorter than 3 codewords, or -1.
+	*/
+	static int WritePath(const std::string& msg, int start, const std::vector<Node>& nodes, int endPos, int endNode,
+						 ByteArray& codewords)
+	{
+		std::vector<std::pair<int, int>> path;
+		for (int pos = endPos, node = endNode; pos >= 0;) {
+			path.emplace_back(pos, node);
+			auto& prev = nodes[pos * NODE_COUNT + node];
+			pos = prev.prevPos;
+			node = prev.prevNode;
+		}
+		std::reverse(path.begin(), path.end());
+
+		int shortEdifactUnlatch = -1;
+		std::string buffer;
+		for (size_t i = 1; i < path.size(); ++i) {
+			int fromPos = path[i - 1].first, fromNode = path[i - 1].second;
+			int toPos = path[i].first, toNode = path[i].second;
+			int fromMode = NodeMode(fromNode);
+
+			if (toNode == BASE256_NODE) {
+				int count = toPos - fromPos;
+				buffer.clear();
+				if (count <= MAX_SHORT_BASE256_LENGTH) {
+					buffer.push_back((char)count);
+				}
+				else {
+					buffer.push_back((char)((count / 250) + 249));
+					buffer.push_back((char)(count % 250));
+				}
+				buffer.append(msg, start + fromPos, count);
+				codewords.push_back(LATCHES[BASE256_ENCODATION]);
+				for (char c : buffer)
+					codewords.push_back(static_cast<uint8_t>(Base256Encoder::Randomize255State((uint8_t)c, Size(codewords) + 1)));
+				buffer.clear();
+			}
+			else if (fromPos == toPos && toNode != ASCII_NODE) {
+				codewords.push_back(LATCHES[NodeMode(toNode)]);
+			}
+			else if (fromPos == toPos) {
+				switch (fromMode) {
+				case C40_ENCODATION:
+				case TEXT_ENCODATION:
+					if (buffer.length() == 2)
+						buffer.push_back('\0'); // Shift 1 as pad
+					// fall through
+				case X12_ENCODATION:
+					WriteTriplets(buffer, codewords);
+					codewords.push_back(C40_UNLATCH);
+					break;
+				case EDIFACT_ENCODATION:
+					buffer.push_back(31); // Unlatch
+					if (buffer.length() < 4)
+						shortEdifactUnlatch = Size(codewords);
+					for (uint8_t cw : EdifactEncoder::EncodeToCodewords(buffer, 0))
+						codewords.push_back(cw);
+					buffer.clear();
+					break;
+				}
+			}
+			else {
+				int c = (uint8_t)msg[start + fromPos];
+				switch (fromMode) {
+				case ASCII_ENCODATION: WriteAscii(msg, start + fromPos, start + toPos, codewords); break;
+				case C40_ENCODATION: C40Encoder::EncodeChar(c, buffer); WriteTriplets(buffer, codewords); break;
+				case TEXT_ENCODATION: DMTextEncoder::EncodeChar(c, buffer); WriteTriplets(buffer, codewords); break;
+				case X12_ENCODATION: X12Encoder::EncodeChar(c, buffer); WriteTriplets(buffer, codewords); break;
+				case EDIFACT_ENCODATION:
+					EdifactEncoder::EncodeChar(c, buffer);
+					if (buffer.length() == 4) {
+						for (uint8_t cw : EdifactEncoder::EncodeToCodewords(buffer, 0))
+							codewords.push_back(cw);
+						buffer.clear();
+					}
+					break;
+				}
+			}
+		}
+
+		// the path ends in C40/Text without unlatch only if the symbol is full
+		if (buffer.length() == 2) {
+			buffer.push_back('\0');
+			WriteTriplets(buffer, codewords);
+		}
+		return shortEdifactUnlatch;
+	}
+
+	static ByteArray Encode(const std::string& msg, int start, int end, const ByteArray& prefix, SymbolShape shape,
+							int minWidth, int minHeight, int maxWidth, int maxHeight, bool longEdifactUnlatch)
+	{
+		auto nodes = FindShortestPaths(msg, start, end, Size(prefix), longEdifactUnlatch);
+		int n = end - start;
+		auto lookup = [&](int len) { return SymbolInfo::Lookup(len, shape, minWidth, minHeight, maxWidth, maxHeight); };
+
+		// Ending in ASCII may need an unlatch the symbol can do without: at the end of the symbol the decoder reads the
+		// last codeword after a C40/Text/X12 triplet and the last 2 codewords after an EDIFACT group as ASCII.
+		int endPos = n, endNode = ASCII_NODE;
+		int len = nodes[n * NODE_COUNT + ASCII_NODE].cost;
+		auto symbolInfo = lookup(len);
+		for (int pos = n; pos >= std::max(0, n - 4); --pos) {
+			int asciiCost = AsciiCost(msg, start + pos, start + n);
+			if (asciiCost > 2)
+				break;
+			for (int node : {C40_NODE, C40_NODE + 2, TEXT_NODE, TEXT_NODE + 2, X12_NODE, EDIFACT_NODE}) {
+				int cost = nodes[pos * NODE_COUNT + node].cost;
+				if (cost == UNREACHABLE)
+					continue;
+				if (node == C40_NODE + 2 || node == TEXT_NODE + 2)
+					cost += 2; // pad triplet
+				auto info = lookup(cost + asciiCost);
+				if (!info || (symbolInfo && info->dataCapacity() >= symbolInfo->dataCapacity()))
+					continue;
+				int left = info->dataCapacity() - cost;
+				if (left <= (node == EDIFACT_NODE ? 2 : 1)) {
+					endPos = pos;
+					endNode = node;
+					len = cost + asciiCost;
+					symbolInfo = info;
+				}
+			}
+		}
+		if (symbolInfo == nullptr)
+			throw std::invalid_argument("Can't find a symbol arrangement that matches the message. Data codewords: " + std::to_string(len));
+
+		ByteArray codewords = prefix;
+		codewords.reserve(symbolInfo->dataCapacity());
+		int shortEdifactUnlatch = WritePath(msg, start, nodes, endPos, endNode, codewords);
+		WriteAscii(msg, start + endPos, start + n, codewords);
+		int capacity = symbolInfo->dataCapacity();
+		if (shortEdifactUnlatch >= 0 && capacity - shortEdifactUnlatch <= 2)
+			return Encode(msg, start, end, prefix, shape, minWidth, minHeight, maxWidth, maxHeight, true);
+
+		//Padding
+		if (Size(codewords) < capacity) {
+			codewords.push_back(PAD);
+		}
+		while (Size(codewords) < capacity) {
+			codewords.push_back(Randomize253State(PAD, Size(codewords) + 1));
+		}
+		return codewords;
+	}
+
+} // MinimalEncoder
+
+ByteArray
+HighLevelEncoder::EncodeMinimal(const std::wstring& msg, SymbolShape shape, int minWidth, int minHeight, int maxWidth, int maxHeight)
+{
+	std::string bytes = TextEncoder::FromUnicode(msg, CharacterSet::ISO8859_1);
+	ByteArray prefix;
+	int start = 0, end = Size(bytes);
+	if (StartsWith(msg, MACRO_05_HEADER) && EndsWith(msg, MACRO_TRAILER)) {
+		prefix.push_back(MACRO_05);
+		start = Size(MACRO_05_HEADER);
+		end -= Size(MACRO_TRAILER);
+	}
+	else if (StartsWith(msg, MACRO_06_HEADER) && EndsWith(msg, MACRO_TRAILER)) {
+		prefix.push_back(MACRO_06);
+		start = Size(MACRO_06_HEADER);
+		end -= Size(MACRO_TRAILER);
+	}
+	return MinimalEncoder::Encode(bytes, start, end, prefix, shape, minWidth, minHeight, maxWidth, maxHeight, false);
+}
+
 } // DataMatrix
 } // ZXing
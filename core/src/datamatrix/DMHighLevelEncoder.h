@@ -34,6 +34,12 @@ class HighLevelEncoder
 public:
 	static ByteArray Encode(const std::wstring& msg);
 	static ByteArray Encode(const std::wstring& msg, SymbolShape shape, int minWdith, int minHeight, int maxWidth, int maxHeight);
+
+	/**
+	* Encodes the message with the fewest codewords by searching all mode switches instead of deciding them with the
+	* look ahead test of annex S. Runs in linear time and never produces more codewords than Encode().
+	*/
+	static ByteArray EncodeMinimal(const std::wstring& msg, SymbolShape shape, int minWidth, int minHeight, int maxWidth, int maxHeight);
 };
 
 } // DataMatrix
@@ -22,8 +22,11 @@
 #include "BitMatrix.h"
 #include "BinaryBitmap.h"
 #include "DecodeHints.h"
+#include "DecodeStats.h"
 #include "DecoderResult.h"
 #include "DetectorResult.h"
+#include "Trace.h"
+#include "ZXContainerAlgorithms.h"
 
 #include <utility>
 #include <vector>
@@ -32,7 +35,8 @@ namespace ZXing {
 namespace DataMatrix {
 
 Reader::Reader(const DecodeHints& hints)
-	: _tryRotate(hints.tryRotate()), _tryHarder(hints.tryHarder()), _isPure(hints.isPure())
+	: _tryRotate(hints.tryRotate()), _tryHarder(hints.tryHarder()), _isPure(hints.isPure()),
+	  _rowScanThreads(hints.rowScanThreads()), _scanStride(hints.scanStride())
 {
 }
 
@@ -47,12 +51,10 @@ Reader::Reader(const DecodeHints& hints)
 Result
 Reader::decode(const BinaryBitmap& image) const
 {
-	auto binImg = image.getBlackMatrix();
-	if (binImg == nullptr) {
-		return Result(DecodeStatus::NotFound);
-	}
-
-	auto detectorResult = Detector::Detect(*binImg, _tryHarder, _tryRotate, _isPure);
+	ZX_TRACE_SCOPE("DataMatrix::Reader::decode");
+	DecodeStats::ReaderTimer readerTimer(DecodeStats::ReaderType::DataMatrix);
+	DecodeStats::StageTimer detectTimer(DecodeStats::Stage::Detect);
+	auto detectorResult = Detector::Detect(image, _tryHarder, _tryRotate, _isPure, _scanStride);
 	if (!detectorResult.isValid())
 		return Result(DecodeStatus::NotFound);
 
@@ -60,5 +62,29 @@ Reader::decode(const BinaryBitmap& image) const
 				  BarcodeFormat::DATA_MATRIX);
 }
 
+Results
+Reader::decode(const BinaryBitmap& image, int maxSymbols) const
+{
+	ZX_TRACE_SCOPE("DataMatrix::Reader::decode");
+	DecodeStats::ReaderTimer readerTimer(DecodeStats::ReaderType::DataMatrix);
+	DecodeStats::StageTimer detectTimer(DecodeStats::Stage::Detect);
+	if (_isPure)
+		return ZXing::Reader::decode(image, maxSymbols);
+
+	auto binImg = image.getBitMatrix();
+	if (binImg == nullptr)
+		return {};
+
+	Results results;
+	for (auto& detectorResult : Detector::DetectMultiple(*binImg, _tryRotate, _rowScanThreads, _scanStride)) {
+		if (Size(results) >= maxSymbols)
+			break;
+		Result result(Decoder::Decode(detectorResult.bits()), std::move(detectorResult).position(), BarcodeFormat::DATA_MATRIX);
+		if (result.isValid())
+			results.push_back(std::move(result));
+	}
+	return results;
+}
+
 } // DataMatrix
 } // ZXing
@@ -32,9 +32,16 @@ namespace DataMatrix {
 class Reader : public ZXing::Reader
 {
 	bool _tryRotate, _tryHarder, _isPure;
+	int _rowScanThreads;
+	int _scanStride;
 public:
 	explicit Reader(const DecodeHints& hints);
 	Result decode(const BinaryBitmap& image) const override;
+
+	/**
+	* Decodes all Data Matrix codes in the image, at most maxSymbols, see Detector::DetectMultiple.
+	*/
+	Results decode(const BinaryBitmap& image, int maxSymbols) const override;
 };
 
 } // DataMatrix
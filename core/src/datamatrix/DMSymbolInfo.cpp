@@ -26,7 +26,7 @@
 namespace ZXing {
 namespace DataMatrix {
 
-static const SymbolInfo PROD_SYMBOLS[] = {
+static constexpr SymbolInfo PROD_SYMBOLS[] = {
 	{ false, 3, 5, 8, 8, 1 },
 	{ false, 5, 7, 10, 10, 1 },
 	{ true, 5, 7, 16, 6, 1 },
@@ -20,16 +20,6 @@
 namespace ZXing {
 namespace DataMatrix {
 
-Version::Version(int versionNumber, int symbolSizeRows, int symbolSizeColumns, int dataRegionSizeRows, int dataRegionSizeColumns, const ECBlocks& ecBlocks) :
-	_versionNumber(versionNumber),
-	_symbolSizeRows(symbolSizeRows),
-	_symbolSizeColumns(symbolSizeColumns),
-	_dataRegionSizeRows(dataRegionSizeRows),
-	_dataRegionSizeColumns(dataRegionSizeColumns),
-	_ecBlocks(ecBlocks)
-{
-}
-
 /**
 * <p>Deduces version information from Data Matrix dimensions.</p>
 *
@@ -81,12 +71,33 @@ Version::VersionForDimensions(int numRows, int numColumns)
 			{30, 16, 48, 14, 22,   {28, 1, 49 , 0, 0}},
 	};
 
-	for (auto& version : allVersions) {
-		if (version._symbolSizeRows == numRows && version._symbolSizeColumns == numColumns) {
-			return &version;
+	// The square sizes grow in steps of 2, 4, 8 and 12 modules, the rectangular ones come in pairs of equal height.
+	// So the index can be computed directly from the dimensions, which only need to be checked against the entry.
+	int index = -1;
+	if (numRows == numColumns) {
+		if (numRows >= 10 && numRows <= 26)
+			index = (numRows - 10) / 2;
+		else if (numRows >= 32 && numRows <= 52)
+			index = 9 + (numRows - 32) / 4;
+		else if (numRows >= 64 && numRows <= 104)
+			index = 15 + (numRows - 64) / 8;
+		else if (numRows >= 120)
+			index = 21 + (numRows - 120) / 12;
+	}
+	else {
+		switch (numRows) {
+		case 8: index = numColumns == 18 ? 24 : 25; break;
+		case 12: index = numColumns == 26 ? 26 : 27; break;
+		case 16: index = numColumns == 36 ? 28 : 29; break;
 		}
 	}
-	return nullptr;
+
+	if (index < 0)
+		return nullptr;
+	const Version& version = allVersions[index];
+	if (version._symbolSizeRows != numRows || version._symbolSizeColumns != numColumns)
+		return nullptr;
+	return &version;
 }
 
 } // DataMatrix
@@ -76,7 +76,16 @@ private:
 	int _dataRegionSizeColumns;
 	ECBlocks _ecBlocks;
 
-	Version(int versionNumber, int symbolSizeRows, int symbolSizeColumns, int dataRegionSizeRows, int dataRegionSizeColumns, const ECBlocks& ecBlocks);
+	constexpr Version(int versionNumber, int symbolSizeRows, int symbolSizeColumns, int dataRegionSizeRows,
+					  int dataRegionSizeColumns, const ECBlocks& ecBlocks) :
+		_versionNumber(versionNumber),
+		_symbolSizeRows(symbolSizeRows),
+		_symbolSizeColumns(symbolSizeColumns),
+		_dataRegionSizeRows(dataRegionSizeRows),
+		_dataRegionSizeColumns(dataRegionSizeColumns),
+		_ecBlocks(ecBlocks)
+	{
+	}
 };
 
 } // DataMatrix
@@ -21,8 +21,10 @@
 #include "DMSymbolInfo.h"
 #include "DMECEncoder.h"
 #include "DMDefaultPlacement.h"
+#include "DMVersion.h"
 #include "BitMatrix.h"
 #include "ByteArray.h"
+#include "ZXContainerAlgorithms.h"
 #include "ZXStrConvWorkaround.h"
 
 #include <stdexcept>
@@ -86,6 +88,55 @@ static BitMatrix EncodeLowLevel(const BitMatrix& placement, const SymbolInfo& sy
 	return matrix;
 }
 
+/**
+* Builds the final symbol directly, without the intermediate placement matrix: the finder and alignment patterns
+* around each data region first, then the codeword bits at their cached positions (see SymbolPlacement).
+*/
+static BitMatrix EncodeSymbol(const ByteArray& codewords, const SymbolInfo& symbolInfo, const Version& version)
+{
+	int width = symbolInfo.symbolWidth();
+	int height = symbolInfo.symbolHeight();
+	int regionWidth = symbolInfo.matrixWidth() + 2;
+	int regionHeight = symbolInfo.matrixHeight() + 2;
+
+	BitMatrix matrix(width, height);
+	for (int y = 0; y < height; y += regionHeight)
+		for (int x = 0; x < width; x++) {
+			// alternating top edge and solid bottom edge of each row of data regions
+			if (x % 2 == 0)
+				matrix.set(x, y);
+			matrix.set(x, y + regionHeight - 1);
+		}
+	for (int x = 0; x < width; x += regionWidth)
+		for (int y = 0; y < height; y++) {
+			// solid left edge and alternating right edge of each column of data regions
+			matrix.set(x, y);
+			if (y % 2 == 1)
+				matrix.set(x + regionWidth - 1, y);
+		}
+
+	auto& placement = SymbolPlacement(version);
+	auto pos = placement.begin();
+	for (uint8_t codeword : codewords)
+		for (int bit = 7; bit >= 0; --bit, ++pos)
+			if ((codeword >> bit) & 1)
+				matrix.set(pos->x, pos->y);
+
+	// if the lower righthand corner of the data area is not covered by the placement, fill in the fixed pattern
+	int numRows = symbolInfo.symbolDataHeight();
+	int numCols = symbolInfo.symbolDataWidth();
+	if (Size(placement) < numRows * numCols) {
+		auto set = [&](int col, int row) {
+			matrix.set(col / symbolInfo.matrixWidth() * regionWidth + 1 + col % symbolInfo.matrixWidth(),
+					   row / symbolInfo.matrixHeight() * regionHeight + 1 + row % symbolInfo.matrixHeight());
+		};
+		set(numCols - 1, numRows - 1);
+		set(numCols - 2, numRows - 2);
+	}
+
+	return matrix;
+}
+
 Writer::Writer() :
 	_shapeHint(SymbolShape::NONE)
 {
@@ -103,7 +154,9 @@ Writer::encode(const std::wstring& contents, int width, int height) const
 	}
 
 	//1. step: Data encodation
-	auto encoded = HighLevelEncoder::Encode(contents, _shapeHint, _minWidth, _minHeight, _maxWidth, _maxHeight);
+	auto encoded = _minimalEncoding
+					   ? HighLevelEncoder::EncodeMinimal(contents, _shapeHint, _minWidth, _minHeight, _maxWidth, _maxHeight)
+					   : HighLevelEncoder::Encode(contents, _shapeHint, _minWidth, _minHeight, _maxWidth, _maxHeight);
 	const SymbolInfo* symbolInfo = SymbolInfo::Lookup(Size(encoded), _shapeHint, _minWidth, _minHeight, _maxWidth, _maxHeight);
 	if (symbolInfo == nullptr) {
 		throw std::invalid_argument("Can't find a symbol arrangement that matches the message. Data codewords: " + std::to_string(encoded.size()));
@@ -112,11 +165,16 @@ Writer::encode(const std::wstring& contents, int width, int height) const
 	//2. step: ECC generation
 	ECEncoder::EncodeECC200(encoded, *symbolInfo);
 
-	//3. step: Module placement in Matrix
-	BitMatrix placement = DefaultPlacement::Place(encoded, symbolInfo->symbolDataWidth(), symbolInfo->symbolDataHeight());
-
-	//4. step: low-level encoding
-	BitMatrix result = EncodeLowLevel(placement, *symbolInfo);
+	//3. + 4. step: Module placement in Matrix and low-level encoding, in one go for all regular symbol sizes
+	BitMatrix result;
+	auto version = Version::VersionForDimensions(symbolInfo->symbolHeight(), symbolInfo->symbolWidth());
+	if (version && version->totalCodewords() == symbolInfo->codewordCount())
+		result = EncodeSymbol(encoded, *symbolInfo, *version);
+	else {
+		int numCols = symbolInfo->symbolDataWidth();
+		int numRows = symbolInfo->symbolDataHeight();
+		result = EncodeLowLevel(DefaultPlacement::Place(encoded, numCols, numRows), *symbolInfo);
+	}
 
 	//5. step: scale-up to requested size, minimum required quite zone is 1
 	return Inflate(std::move(result), width, height, _quiteZone);
@@ -52,10 +52,20 @@ public:
 		return *this;
 	}
 
+	/**
+	* Use the shortest possible encodation (see HighLevelEncoder::EncodeMinimal) instead of the one from annex S
+	* of ISO/IEC 16022. May result in smaller symbols.
+	*/
+	Writer& setMinimalEncoding(bool minimal) {
+		_minimalEncoding = minimal;
+		return *this;
+	}
+
 	BitMatrix encode(const std::wstring& contents, int width, int height) const;
 
 private:
 	SymbolShape _shapeHint;
+	bool _minimalEncoding = false;
 	int _quiteZone = 1, _minWidth = -1, _minHeight = -1, _maxWidth = -1, _maxHeight = -1;
 };
 
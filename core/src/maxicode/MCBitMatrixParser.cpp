@@ -18,8 +18,10 @@
 #include "MCBitMatrixParser.h"
 #include "ByteArray.h"
 #include "BitMatrix.h"
+#include "ZXContainerAlgorithms.h"
 
 #include <array>
+#include <cstdint>
 
 namespace ZXing {
 namespace MaxiCode {
@@ -60,22 +62,55 @@ static const std::array<std::array<int, BitMatrixParser::MATRIX_WIDTH>, BitMatri
 	737,736,743,742,749,748,755,754,761,760,767,766,773,772,779,778,785,784,791,790,797,796,803,802,809,808,815,814,863,862,
 };
 
-ByteArray BitMatrixParser::ReadCodewords(const BitMatrix& image)
+struct ModulePosition
+{
+	uint8_t x, y;
+};
+
+/**
+* The inverse of BITNR: the grid position of each codeword bit, most significant bit of the first codeword first.
+*/
+static const std::array<ModulePosition, 864>& BitPositions()
+{
+	static const auto positions = [] {
+		std::array<ModulePosition, 864> res = {};
+		for (int y = 0; y < BitMatrixParser::MATRIX_HEIGHT; ++y)
+			for (int x = 0; x < BitMatrixParser::MATRIX_WIDTH; ++x)
+				if (BITNR[y][x] >= 0)
+					res[BITNR[y][x]] = {static_cast<uint8_t>(x), static_cast<uint8_t>(y)};
+		return res;
+	}();
+	return positions;
+}
+
+template <typename GetModule>
+static ByteArray ReadCodewords(GetModule getModule)
 {
+	auto& positions = BitPositions();
 	ByteArray result(144);
-	int height = image.height();
-	int width = image.width();
-	for (int y = 0; y < height; y++) {
-		for (int x = 0; x < width; x++) {
-			int bit = BITNR[y][x];
-			if (bit >= 0 && image.get(x, y)) {
-				result[bit / 6] |= static_cast<uint8_t>(1 << (5 - (bit % 6)));
-			}
+	for (int i = 0; i < Size(result); ++i) {
+		int codeword = 0;
+		for (int bit = 0; bit < 6; ++bit) {
+			auto& p = positions[6 * i + bit];
+			codeword = (codeword << 1) | getModule(p.x, p.y);
 		}
+		result[i] = static_cast<uint8_t>(codeword);
 	}
 	return result;
 }
 
+ByteArray BitMatrixParser::ReadCodewords(const BitMatrix& image)
+{
+	return MaxiCode::ReadCodewords([&image](int x, int y) { return image.get(x, y); });
+}
+
+ByteArray BitMatrixParser::ReadCodewords(const BitMatrix& image, int left, int top, int width, int height)
+{
+	return MaxiCode::ReadCodewords([&](int x, int y) {
+		return image.get(left + (x * width + width / 2 + (y & 1) * width / 2) / MATRIX_WIDTH,
+						 top + (y * height + height / 2) / MATRIX_HEIGHT);
+	});
+}
 
 } // MaxiCode
 } // ZXing
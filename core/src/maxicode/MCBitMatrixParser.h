@@ -32,6 +32,12 @@ class BitMatrixParser
 public:
 	static ByteArray ReadCodewords(const BitMatrix& image);
 
+	/**
+	* Reads the codewords of a pure symbol straight from the image, where it fills the given bounding box. The odd rows
+	* are shifted by half a module to the right.
+	*/
+	static ByteArray ReadCodewords(const BitMatrix& image, int left, int top, int width, int height);
+
 	static const int MATRIX_WIDTH = 30;
 	static const int MATRIX_HEIGHT = 33;
 };
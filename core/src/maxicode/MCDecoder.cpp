@@ -18,11 +18,13 @@
 #include "MCDecoder.h"
 #include "MCBitMatrixParser.h"
 #include "ByteArray.h"
+#include "DecodeStats.h"
 #include "DecoderResult.h"
 #include "ReedSolomonDecoder.h"
 #include "GenericGF.h"
 #include "DecodeStatus.h"
 #include "TextDecoder.h"
+#include "Trace.h"
 #include "ZXStrConvWorkaround.h"
 
 #include <array>
@@ -248,6 +250,7 @@ namespace DecodedBitStreamParser
 
 	static DecoderResult Decode(ByteArray&& bytes, int mode)
 	{
+		DecodeStats::StageTimer timer(DecodeStats::Stage::DecodeText);
 		std::string result;
 		result.reserve(144);
 		switch (mode) {
@@ -282,8 +285,13 @@ namespace DecodedBitStreamParser
 DecoderResult
 Decoder::Decode(const BitMatrix& bits)
 {
-	ByteArray codewords = BitMatrixParser::ReadCodewords(bits);
+	return Decode(BitMatrixParser::ReadCodewords(bits));
+}
 
+DecoderResult
+Decoder::Decode(ByteArray&& codewords)
+{
+	ZX_TRACE_SCOPE("MaxiCode::Decoder::Decode");
 	if (!CorrectErrors(codewords, 0, 10, 10, ALL)) {
 		return DecodeStatus::ChecksumError;
 	}
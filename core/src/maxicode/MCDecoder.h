@@ -20,6 +20,7 @@ namespace ZXing {
 
 class DecoderResult;
 class BitMatrix;
+class ByteArray;
 
 namespace MaxiCode {
 
@@ -33,6 +34,7 @@ class Decoder
 {
 public:
 	static DecoderResult Decode(const BitMatrix& bits);
+	static DecoderResult Decode(ByteArray&& codewords);
 };
 
 } // MaxiCode
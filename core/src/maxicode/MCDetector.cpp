@@ -0,0 +1,770 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "MCDetector.h"
+#include "MCBitMatrixParser.h"
+#include "BitMatrix.h"
+#include "Deadline.h"
+#include "DetectorResult.h"
+#include "Pattern.h"
+#include "PerspectiveTransform.h"
+#include "Quadrilateral.h"
+#include "Trace.h"
+#include "ZXContainerAlgorithms.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numeric>
+#include <utility>
+
+namespace ZXing {
+namespace MaxiCode {
+
+static const int WIDTH = BitMatrixParser::MATRIX_WIDTH;
+static const int HEIGHT = BitMatrixParser::MATRIX_HEIGHT;
+
+// The bull's eye is centered on row 16, between the modules 14 and 15 of that (unshifted) row.
+static const double CENTER_X = 14.5;
+static const double CENTER_Y = 16.5;
+
+// The row pitch in units of the module pitch within a row, the nominal symbol is 28.14mm x 26.91mm for 30 x 33 modules.
+static const double ROW_PITCH = 0.87;
+
+// The radius of the middle of the outer black ring in units of the module pitch.
+static const double OUTER_RING_RADIUS = 4.2;
+
+static const int RAY_COUNT = 36;
+
+static const double PI = 3.14159265358979323846;
+
+struct OrientationModule
+{
+	int x, y;
+	bool black;
+};
+
+// The 6 clusters of 3 modules around the bull's eye that fix the orientation: the one top left is all black, the one
+// top right all white and each of the other four has a single white module.
+static const std::array<OrientationModule, 18> ORIENTATION_MODULES = {{
+	{10, 9, true}, {11, 9, true}, {11, 10, true},
+	{17, 9, false}, {17, 10, false}, {18, 10, false},
+	{7, 15, true}, {7, 16, false}, {8, 16, true},
+	{20, 16, true}, {21, 16, false}, {20, 17, true},
+	{10, 22, true}, {11, 22, false}, {10, 23, true},
+	{17, 22, true}, {16, 23, false}, {17, 23, true},
+}};
+
+static const int MIN_ORIENTATION_MATCHES = 15;
+
+static bool IsInside(const BitMatrix& image, PointI p)
+{
+	return p.x >= 0 && p.y >= 0 && p.x < image.width() && p.y < image.height();
+}
+
+/**
+* Counts the pixels of the given color, starting next to p and walking in direction d.
+*/
+static int RunLength(const BitMatrix& image, PointI p, PointI d, bool color, int maxLength)
+{
+	int length = 0;
+	for (p = p + d; length < maxLength && IsInside(image, p) && image.get(p.x, p.y) == color; p = p + d)
+		++length;
+	return length;
+}
+
+/**
+* Checks the run lengths of the black, white, black, white, black rings on both sides of the center, each side given
+* from the center outwards, and returns their mean width or 0. Print gain and blur often make the black rings twice
+* as wide as the white ones, so the black and the white ones are only compared among themselves.
+*/
+static float RingWidth(const std::array<int, 10>& rings)
+{
+	auto isBlack = [](int i) { return i % 5 % 2 == 0; };
+	int black = 0, white = 0;
+	for (int i = 0; i < 10; ++i)
+		(isBlack(i) ? black : white) += rings[i];
+	float blackWidth = black / 6.f, whiteWidth = white / 4.f;
+	if (white == 0 || black == 0 || blackWidth > 3 * whiteWidth || whiteWidth > 3 * blackWidth)
+		return 0;
+	for (int i = 0; i < 10; ++i) {
+		float width = isBlack(i) ? blackWidth : whiteWidth;
+		// the same ring on both sides must match closely, or else this line is a chord through one of the white rings
+		if (std::abs(rings[i] - width) > std::max(1.5f, width / 2)
+			|| (i < 5 && std::abs(rings[i] - rings[i + 5]) > std::max(1.5f, width / 2)))
+			return 0;
+	}
+	return (black + white) / 10.f;
+}
+
+static bool IsCenter(float length, float ringWidth)
+{
+	// the white center circle is between 1 and 4 ring widths wide depending on the encoder, print gain may close it
+	// almost completely
+	return length >= 1 && length <= 6 * ringWidth;
+}
+
+/**
+* Checks the white center and the rings around it along the line through center in direction d and moves center to
+* the middle of the white center on that line. Returns the mean ring width or 0.
+*/
+static float CheckBullsEyeLine(const BitMatrix& image, PointI& center, PointI d, float ringWidth)
+{
+	int maxLength = static_cast<int>(6 * ringWidth) + 2;
+	if (!IsInside(image, center) || image.get(center.x, center.y))
+		return 0;
+	int back = RunLength(image, center, {-d.x, -d.y}, false, maxLength);
+	int forward = RunLength(image, center, d, false, maxLength);
+
+	std::array<int, 10> rings;
+	for (int dir : {0, 1}) {
+		PointI dd = {dir ? d.x : -d.x, dir ? d.y : -d.y};
+		PointI p = center + (dir ? forward : back) * dd;
+		bool color = true;
+		for (int i = 0; i < 5; ++i, color = !color) {
+			rings[dir * 5 + i] = RunLength(image, p, dd, color, maxLength);
+			p = p + rings[dir * 5 + i] * dd;
+		}
+	}
+
+	// the ring width along this line may differ from the one along the row by the tilt of the symbol
+	float lineRingWidth = RingWidth(rings);
+	if (lineRingWidth < ringWidth / 3 || lineRingWidth > 3 * ringWidth
+		|| !IsCenter(static_cast<float>(back + forward + 1), lineRingWidth))
+		return 0;
+
+	center = center + ((forward - back) / 2) * d;
+	return lineRingWidth;
+}
+
+struct BullsEyeCandidate
+{
+	std::vector<PointI> centers;
+	float ringWidth;
+	int row; // the row the first center was found in
+
+	PointF center() const
+	{
+		// the median is robust against the occasional chord through a white ring that still matched
+		std::vector<int> xs, ys;
+		for (auto& c : centers) {
+			xs.push_back(c.x);
+			ys.push_back(c.y);
+		}
+		std::nth_element(xs.begin(), xs.begin() + Size(xs) / 2, xs.end());
+		std::nth_element(ys.begin(), ys.begin() + Size(ys) / 2, ys.end());
+		return {double(xs[Size(xs) / 2]), double(ys[Size(ys) / 2])};
+	}
+};
+
+/**
+* Scans the run-length encoded rows for the 1:1:1:1:1:n:1:1:1:1:1 signature of the three black rings around the white
+* center of a bull's eye, confirms each match in the column and the row through its center and merges the matches of
+* the same bull's eye. The candidates that were matched in the most rows come first. Only every scanStride-th row
+* is scanned.
+*/
+static std::vector<BullsEyeCandidate> FindBullsEyeCenters(const BitMatrix& image, int scanStride)
+{
+	std::vector<BullsEyeCandidate> res;
+	// the largest ring width of all candidates, it bounds how far above the current row a matching one can start
+	float maxRingWidth = 0;
+	PatternRow runs;
+	for (int y = 0; y < image.height(); y += std::max(1, scanStride)) {
+		if (Deadline::Expired())
+			break;
+		GetPatternRow(image, y, runs);
+		// runs start with a white one, so the center of a bull's eye has an even index, x is where it starts
+		for (int i = 6, x = std::accumulate(runs.begin(), runs.begin() + std::min(6, Size(runs)), 0);
+			 i + 5 < Size(runs); x += runs[i] + runs[i + 1], i += 2) {
+			std::array<int, 10> rings;
+			for (int j = 0; j < 5; ++j) {
+				rings[j] = runs[i - 1 - j];
+				rings[5 + j] = runs[i + 1 + j];
+			}
+			float ringWidth = RingWidth(rings);
+			if (ringWidth < 1 || !IsCenter(runs[i], ringWidth))
+				continue;
+
+			PointI center = {x + runs[i] / 2, y};
+			float colRingWidth = CheckBullsEyeLine(image, center, {0, 1}, ringWidth);
+			if (colRingWidth == 0)
+				continue;
+			if (CheckBullsEyeLine(image, center, {1, 0}, ringWidth) == 0)
+				continue;
+
+			ringWidth = std::max(ringWidth, colRingWidth);
+			maxRingWidth = std::max(maxRingWidth, ringWidth);
+			// extend the first candidate close enough. Noise can produce many thousands of them, but they are sorted
+			// by their row and CheckBullsEyeLine moves a center less than 3 ring widths + 1 off its row, so only the
+			// ones of the last few rows can be close enough.
+			int minRow = y - static_cast<int>(11 * maxRingWidth) - 2;
+			auto known = res.end();
+			for (auto c = res.rbegin(); c != res.rend() && c->row >= minRow; ++c)
+				if (distance(c->centers.front(), center) < 5 * std::max(c->ringWidth, ringWidth))
+					known = std::prev(c.base());
+			if (known != res.end())
+				known->centers.push_back(center);
+			else
+				res.push_back({{center}, ringWidth, y});
+		}
+	}
+	std::stable_sort(res.begin(), res.end(), [](const BullsEyeCandidate& a, const BullsEyeCandidate& b) {
+		return a.centers.size() > b.centers.size();
+	});
+	return res;
+}
+
+/**
+* Walks from the center of a bull's eye in direction d across the rings and returns the distance to the middle of the
+* outer black ring, or 0 if it is not found within maxDistance.
+*/
+static double OuterRingDistance(const BitMatrix& image, PointF center, PointF d, double maxDistance)
+{
+	int transitions = 0;
+	double inner = 0;
+	bool color = false;
+	for (double t = 0; t < maxDistance; t += 0.5) {
+		auto p = round(center + t * d);
+		if (!IsInside(image, p))
+			return 0;
+		if (image.get(p.x, p.y) != color) {
+			color = !color;
+			if (++transitions == 5)
+				inner = t;
+			else if (transitions == 6)
+				return (inner + t) / 2;
+		}
+	}
+	return 0;
+}
+
+/**
+* Fits the conic a*x^2 + b*x*y + c*y^2 + d*x + e*y = 1 to the points by least squares and returns its center and the
+* symmetric matrix m = {m11, m12, m22} of the ellipse (p - center)^T m (p - center) = 1.
+*/
+static bool FitEllipse(const std::vector<PointF>& points, PointF& center, std::array<double, 3>& m)
+{
+	// normal equations of the linear least squares problem, solved by Gaussian elimination
+	double a[5][6] = {};
+	for (auto& p : points) {
+		const double row[5] = {p.x * p.x, p.x * p.y, p.y * p.y, p.x, p.y};
+		for (int i = 0; i < 5; ++i) {
+			for (int j = 0; j < 5; ++j)
+				a[i][j] += row[i] * row[j];
+			a[i][5] += row[i];
+		}
+	}
+	for (int col = 0; col < 5; ++col) {
+		int pivot = col;
+		for (int i = col + 1; i < 5; ++i)
+			if (std::abs(a[i][col]) > std::abs(a[pivot][col]))
+				pivot = i;
+		if (std::abs(a[pivot][col]) < 1e-9)
+			return false;
+		std::swap(a[col], a[pivot]);
+		for (int i = 0; i < 5; ++i) {
+			if (i == col)
+				continue;
+			double f = a[i][col] / a[col][col];
+			for (int j = col; j < 6; ++j)
+				a[i][j] -= f * a[col][j];
+		}
+	}
+	double q11 = a[0][5] / a[0][0], q12 = a[1][5] / a[1][1] / 2, q22 = a[2][5] / a[2][2];
+	double l1 = a[3][5] / a[3][3], l2 = a[4][5] / a[4][4];
+
+	double det = q11 * q22 - q12 * q12;
+	if (det <= 0)
+		return false;
+	// the linear terms vanish around the center: 2 Q center = -l
+	center = {(-q22 * l1 + q12 * l2) / (2 * det), (q12 * l1 - q11 * l2) / (2 * det)};
+	double k = 1 + q11 * center.x * center.x + 2 * q12 * center.x * center.y + q22 * center.y * center.y;
+	if (q11 <= 0 || k <= 0)
+		return false;
+	m = {q11 / k, q12 / k, q22 / k};
+	return true;
+}
+
+/**
+* Samples the outer ring of a bull's eye along RAY_COUNT rays from center and fits an ellipse to it. The points are
+* relative to center and in units of the ring width to keep the normal equations well conditioned.
+*/
+static bool FitOuterRing(const BitMatrix& image, PointF center, double ringWidth, PointF& c, std::array<double, 3>& m)
+{
+	std::vector<PointF> points;
+	for (int i = 0; i < RAY_COUNT; ++i) {
+		double alpha = 2 * PI * i / RAY_COUNT;
+		PointF d = {std::cos(alpha), std::sin(alpha)};
+		double r = OuterRingDistance(image, center, d, 12 * ringWidth + 2);
+		if (r > 0)
+			points.push_back((r / ringWidth) * d);
+	}
+
+	// drop the rays that hit a defect or a data module touching the ring and fit again
+	for (int pass = 0; pass < 3; ++pass) {
+		if (Size(points) < RAY_COUNT / 2 || !FitEllipse(points, c, m))
+			return false;
+		auto end = std::remove_if(points.begin(), points.end(), [&](PointF p) {
+			auto q = p - c;
+			return std::abs(std::sqrt(m[0] * q.x * q.x + 2 * m[1] * q.x * q.y + m[2] * q.y * q.y) - 1) > 0.1;
+		});
+		if (end == points.end())
+			return true;
+		points.erase(end, points.end());
+	}
+	return false;
+}
+
+/**
+* Fits the outer ring of a bull's eye, a second time from the center of the first fit, and derives the two axes that
+* map a circle of one module pitch radius onto the image.
+*/
+static bool FitBullsEye(const BitMatrix& image, const BullsEyeCandidate& candidate, BullsEye& bullsEye)
+{
+	PointF center = candidate.center();
+	double ringWidth = candidate.ringWidth;
+	PointF c;
+	std::array<double, 3> m;
+	for (int i = 0; i < 2; ++i) {
+		if (!FitOuterRing(image, center, ringWidth, c, m))
+			return false;
+		center = center + ringWidth * c;
+	}
+
+	// the axes are the columns of the inverse square root of m, scaled from the ring to one module pitch
+	double det = m[0] * m[2] - m[1] * m[1];
+	double n11 = m[2] / det, n12 = -m[1] / det, n22 = m[0] / det;
+	double s = std::sqrt(n11 * n22 - n12 * n12);
+	double t = std::sqrt(n11 + n22 + 2 * s) * OUTER_RING_RADIUS / ringWidth;
+	bullsEye.center = center;
+	bullsEye.axisX = {(n11 + s) / t, n12 / t};
+	bullsEye.axisY = {n12 / t, (n22 + s) / t};
+	return true;
+}
+
+std::vector<BullsEye> Detector::FindBullsEyes(const BitMatrix& image, int scanStride)
+{
+	std::vector<BullsEye> res;
+	for (auto& candidate : FindBullsEyeCenters(image, scanStride)) {
+		if (Deadline::Expired())
+			break;
+		BullsEye bullsEye;
+		if (FitBullsEye(image, candidate, bullsEye))
+			res.push_back(bullsEye);
+	}
+	return res;
+}
+
+/**
+* Symbol plane coordinates, in module pitches relative to the bull's eye center, of the grid position (x, y).
+*/
+static PointF SymbolPoint(double x, double y)
+{
+	return {x - CENTER_X, (y - CENTER_Y) * ROW_PITCH};
+}
+
+static PointF ModuleCenter(int x, int y)
+{
+	return SymbolPoint(x + (y & 1 ? 1.0 : 0.5), y + 0.5);
+}
+
+/**
+* The affine map from the symbol plane to the image around the bull's eye, for a given rotation and mirroring.
+*/
+struct SymbolTransform
+{
+	PointF center, axisX, axisY;
+
+	SymbolTransform(const BullsEye& bullsEye, double angle, bool isMirror) : center(bullsEye.center)
+	{
+		double cos = std::cos(angle), sin = std::sin(angle);
+		axisX = (isMirror ? -cos : cos) * bullsEye.axisX + (isMirror ? -sin : sin) * bullsEye.axisY;
+		axisY = -sin * bullsEye.axisX + cos * bullsEye.axisY;
+	}
+
+	PointF operator()(PointF p) const { return center + p.x * axisX + p.y * axisY; }
+};
+
+/**
+* Finds the rotation and mirroring around a bull's eye by trying all rotations in steps of one degree. The ones that
+* match the most orientation modules form a range of a few degrees, its middle is the best estimate.
+*/
+static bool FindOrientation(const BitMatrix& image, const BullsEye& bullsEye, double& angle, bool& isMirror)
+{
+	int bestMatches[2] = {};
+	PointF bestDirection[2];
+	for (bool mirror : {false, true}) {
+		for (int degree = 0; degree < 360; ++degree) {
+			double alpha = degree * PI / 180;
+			SymbolTransform transform(bullsEye, alpha, mirror);
+			int matches = 0;
+			for (auto& module : ORIENTATION_MODULES) {
+				auto p = round(transform(ModuleCenter(module.x, module.y)));
+				matches += IsInside(image, p) && image.get(p.x, p.y) == module.black;
+			}
+			if (matches > bestMatches[mirror]) {
+				bestMatches[mirror] = matches;
+				bestDirection[mirror] = {};
+			}
+			if (matches == bestMatches[mirror])
+				bestDirection[mirror] = bestDirection[mirror] + PointF(std::cos(alpha), std::sin(alpha));
+		}
+	}
+	isMirror = bestMatches[1] > bestMatches[0];
+	// a range of matching rotations adds up to a long vector, ambiguous ones far apart cancel each other out, a tilt
+	// can narrow the range down to a single rotation, i.e. a vector of length 1 give or take the rounding
+	if (bestMatches[isMirror] < MIN_ORIENTATION_MATCHES || distance(bestDirection[isMirror], {}) < 0.99)
+		return false;
+	angle = std::atan2(bestDirection[isMirror].y, bestDirection[isMirror].x);
+	return true;
+}
+
+static QuadrilateralF GridCorners()
+{
+	return {PointF(0, 0), PointF(WIDTH, 0), PointF(WIDTH, HEIGHT), PointF(0, HEIGHT)};
+}
+
+// The grid position on the given side (top, right, bottom, left) at s along that side and u outwards from it.
+static PointF SidePoint(int side, double s, double u)
+{
+	switch (side) {
+	case 0: return {s, -u};
+	case 1: return {WIDTH + u, s};
+	case 2: return {s, HEIGHT + u};
+	default: return {-u, s};
+	}
+}
+
+/**
+* The outer edge of the modules along one side as the line u = a + b * s.
+*/
+struct SideLine
+{
+	double a = 0, b = 0;
+	int score = 0;
+
+	double operator()(double s) const { return a + b * s; }
+};
+
+/**
+* Fits lines to the outermost black samples found along one side. Where the outer module is white, the sample lies
+* one or more rows further in, so a line is scored by the samples on it, the ones beyond it and the ones less than a
+* row inside of it, then fitted by least squares to the ones on it. Only a tilt the transform does not know yet lets a
+* line through the samples of two different rows compete with the true edge, so the best two lines that differ by more
+* than half a row are returned.
+*/
+static std::vector<SideLine> FitSideLines(const std::vector<PointF>& points)
+{
+	static const double TOLERANCE = 0.3;
+	int minScore = std::max(4, Size(points) / 6);
+	std::vector<SideLine> lines;
+	for (size_t i = 0; i < points.size(); ++i) {
+		for (size_t j = i + 1; j < points.size(); ++j) {
+			if (points[j].x - points[i].x < 4)
+				continue;
+			SideLine line;
+			line.b = (points[j].y - points[i].y) / (points[j].x - points[i].x);
+			line.a = points[i].y - line.b * points[i].x;
+			for (auto& p : points) {
+				double d = p.y - line(p.x);
+				if (std::abs(d) < TOLERANCE)
+					line.score += 1;
+				else if (d > 2 * TOLERANCE)
+					line.score -= 5;
+				else if (d > -0.7 && d < -TOLERANCE)
+					line.score -= 1;
+			}
+			if (line.score < minScore)
+				continue;
+			double end = points.back().x;
+			auto isSame = [&](const SideLine& other) {
+				return std::abs(line(0) - other(0)) < 0.5 && std::abs(line(end) - other(end)) < 0.5;
+			};
+			auto same = std::find_if(lines.begin(), lines.end(), isSame);
+			if (same != lines.end()) {
+				if (line.score > same->score)
+					*same = line;
+			} else {
+				lines.push_back(line);
+			}
+			std::sort(lines.begin(), lines.end(), [](const SideLine& l, const SideLine& r) { return l.score > r.score; });
+			if (lines.size() > 2)
+				lines.pop_back();
+		}
+	}
+
+	for (auto& line : lines) {
+		double n = 0, s = 0, u = 0, ss = 0, su = 0;
+		for (auto& p : points) {
+			if (std::abs(p.y - line(p.x)) < TOLERANCE)
+				n += 1, s += p.x, u += p.y, ss += p.x * p.x, su += p.x * p.y;
+		}
+		line.b = (n * su - s * u) / (n * ss - s * s);
+		line.a = (u - line.b * s) / n;
+	}
+	return lines;
+}
+
+/**
+* The line of the opposite side, mirrored at the middle of the sides.
+*/
+static SideLine MirrorLine(const SideLine& line, double middle)
+{
+	SideLine res;
+	res.b = -line.b;
+	res.a = line(middle) - res.b * middle;
+	return res;
+}
+
+/**
+* Finds the candidate lines for the outer edge of the modules on one side of the symbol by walking outwards across
+* each module of the first or last row or column until the quiet zone is reached.
+*/
+static std::vector<SideLine> FindSideLines(const BitMatrix& image, const PerspectiveTransform& transform, int side)
+{
+	static const double STEP = 0.1;
+	static const double QUIET_ZONE = 1.2;
+	// the binarizer turns the noise in a flat quiet zone into specks, a black run shorter than this is not a module
+	static const int MIN_RUN = 5;
+
+	std::vector<PointF> points;
+	int length = side % 2 ? HEIGHT : WIDTH;
+	for (int i = 0; i < length; ++i) {
+		double edge = 0;
+		bool found = false;
+		int run = 0;
+		for (double u = -3; u < 4; u += STEP) {
+			auto p = round(transform(SidePoint(side, i + 0.5, u)));
+			if (IsInside(image, p) && image.get(p.x, p.y)) {
+				if (++run >= MIN_RUN) {
+					edge = u + STEP / 2;
+					found = true;
+				}
+				continue;
+			}
+			run = 0;
+			if (found && u - edge > QUIET_ZONE) {
+				// the odd rows are shifted right by half a module and one module shorter, so they end half a module
+				// short of both the left and the right side
+				points.emplace_back(i + 0.5, side % 2 && i % 2 ? edge + 0.5 : edge);
+				break;
+			}
+		}
+	}
+	return FitSideLines(points);
+}
+
+/**
+* The corners where the lines of neighboring sides meet, in the grid coordinates the lines were measured in.
+*/
+static bool Intersect(const std::array<SideLine, 4>& lines, QuadrilateralF& corners)
+{
+	for (int side = 0; side < 4; ++side) {
+		int prev = (side + 3) % 4;
+		auto point = [&](int side, double s) { return SidePoint(side, s, lines[side](s)); };
+		PointF p = point(side, 0), d = point(side, 10) - p;
+		PointF q = point(prev, 0), e = point(prev, 10) - q;
+		double det = d.x * e.y - d.y * e.x;
+		if (std::abs(det) < 1e-3)
+			return false;
+		corners[side] = p + ((q.x - p.x) * e.y - (q.y - p.y) * e.x) / det * d;
+	}
+	return true;
+}
+
+/**
+* Counts how many samples a quarter module off the centers of the black modules within radius module pitches of the
+* bull's eye are black as well. This is at its maximum if the transform puts the centers onto the modules all across
+* that part of the symbol. The white modules are left out, they would favor a grid that reaches out into the quiet
+* zone.
+*/
+static int GridFit(const BitMatrix& image, const PerspectiveTransform& transform, double radius = WIDTH)
+{
+	struct Samples
+	{
+		// each center is followed by its 4 offset samples, the modules are sorted by their distance from the bull's eye
+		std::vector<PointF> points;
+		std::vector<double> radii;
+	};
+	static const Samples samples = [] {
+		std::vector<std::pair<double, PointF>> centers;
+		for (int y = 0; y < HEIGHT; ++y)
+			for (int x = 0; x < WIDTH - (y & 1); ++x)
+				centers.emplace_back(distance(ModuleCenter(x, y), {}), PointF(x + (y & 1 ? 1.0 : 0.5), y + 0.5));
+		std::sort(centers.begin(), centers.end(), [](auto& a, auto& b) { return a.first < b.first; });
+		const PointF offsets[] = {{0.25, 0}, {-0.25, 0}, {0, 0.25}, {0, -0.25}};
+		Samples res;
+		for (auto& c : centers) {
+			res.radii.push_back(c.first);
+			res.points.push_back(c.second);
+			for (auto& offset : offsets)
+				res.points.push_back(c.second + offset);
+		}
+		return res;
+	}();
+
+	int count = 5 * static_cast<int>(std::upper_bound(samples.radii.begin(), samples.radii.end(), radius)
+									 - samples.radii.begin());
+	std::vector<PointF> mapped(count);
+	transform(samples.points.data(), mapped.data(), count);
+	int fit = 0;
+	for (auto c = mapped.begin(); c != mapped.end(); c += 5) {
+		auto p = round(*c);
+		if (!IsInside(image, p) || !image.get(p.x, p.y))
+			continue;
+		for (auto o = c + 1; o != c + 5; ++o) {
+			auto q = round(*o);
+			fit += IsInside(image, q) && image.get(q.x, q.y);
+		}
+	}
+	return fit;
+}
+
+/**
+* Whether the transform puts the center of the grid within half a module of the bull's eye. A grid shifted by a whole
+* row or module still puts many samples onto modules, but never onto the rings.
+*/
+static bool IsCentered(const PerspectiveTransform& transform, const BullsEye& bullsEye)
+{
+	double moduleSize = std::min(distance(bullsEye.axisX, {}), distance(bullsEye.axisY, {}));
+	return distance(transform({CENTER_X, CENTER_Y}), bullsEye.center) < moduleSize / 2;
+}
+
+/**
+* Moves one corner of the grid at a time by a step in each direction for as long as that improves the grid fit, then
+* halves the step. The side lines can be off by up to a module where a strong tilt bends the rows the most, so a first
+* round with half module steps only fits the modules close to the bull's eye, where the transform is good already,
+* before the second one takes in the whole symbol down to an eighth of a module.
+*/
+static PerspectiveTransform RefineCorners(const BitMatrix& image, const BullsEye& bullsEye,
+										  PerspectiveTransform transform)
+{
+	auto gridCorners = GridCorners();
+	QuadrilateralF corners;
+	for (int i = 0; i < 4; ++i)
+		corners[i] = transform(gridCorners[i]);
+	double moduleSize = distance(corners[0], corners[1]) / WIDTH;
+	for (double radius : {10.0, double(WIDTH)}) {
+		int fit = GridFit(image, transform, radius);
+		double minStep = radius < WIDTH ? moduleSize / 2 : moduleSize / 8;
+		for (double step = moduleSize / 2; step >= minStep; step /= 2) {
+			for (bool improved = true; improved;) {
+				improved = false;
+				for (int i = 0; i < 4; ++i) {
+					for (PointF d : {PointF(step, 0), PointF(-step, 0), PointF(0, step), PointF(0, -step)}) {
+						auto trialCorners = corners;
+						trialCorners[i] = corners[i] + d;
+						PerspectiveTransform trial(gridCorners, trialCorners);
+						if (!IsCentered(trial, bullsEye))
+							continue;
+						int trialFit = GridFit(image, trial, radius);
+						if (trialFit > fit) {
+							fit = trialFit;
+							corners = trialCorners;
+							transform = trial;
+							improved = true;
+						}
+					}
+				}
+			}
+		}
+	}
+	return transform;
+}
+
+DetectorResult Detector::Detect(const BitMatrix& image, const BullsEye& bullsEye)
+{
+	ZX_TRACE_SCOPE("MaxiCode::Detector::Detect");
+	double angle;
+	bool isMirror;
+	if (!FindOrientation(image, bullsEye, angle, isMirror))
+		return {};
+
+	// The bull's eye gives the pose of the symbol around its center, but a tilt only becomes visible towards the edges,
+	// where the modules move by the square of their distance from the center. The outer edges of the symbol against the
+	// quiet zone give the corners, measuring them once more in the corrected grid takes care of the larger tilts.
+	SymbolTransform symbol(bullsEye, angle, isMirror);
+	auto gridCorners = GridCorners();
+	QuadrilateralF imageCorners;
+	for (int i = 0; i < 4; ++i)
+		imageCorners[i] = symbol(SymbolPoint(gridCorners[i].x, gridCorners[i].y));
+	PerspectiveTransform transform(gridCorners, imageCorners);
+	for (int pass = 0; pass < 2; ++pass) {
+		std::array<std::vector<SideLine>, 4> candidates;
+		for (int side = 0; side < 4; ++side)
+			candidates[side] = FindSideLines(image, transform, side);
+		// the scale and the rotation left over from the bull's eye move opposite sides alike, so a side without a line
+		// of its own, e.g. because the binarizer left specks in its quiet zone, borrows the mirror image of the other
+		for (int side = 0; side < 4; ++side) {
+			auto& opposite = candidates[(side + 2) % 4];
+			if (candidates[side].empty() && !opposite.empty())
+				candidates[side].push_back(MirrorLine(opposite.front(), (side % 2 ? HEIGHT : WIDTH) / 2.0));
+		}
+		if (std::any_of(candidates.begin(), candidates.end(), [](const std::vector<SideLine>& c) { return c.empty(); }))
+			break;
+
+		// where a side has two candidates, the one that puts more samples onto the modules wins, one side at a time
+		auto hasTwo = [](const std::vector<SideLine>& c) { return c.size() == 2; };
+		bool isAmbiguous = std::any_of(candidates.begin(), candidates.end(), hasTwo);
+		std::array<int, 4> choice = {};
+		PerspectiveTransform best = transform;
+		int bestFit = -1;
+		for (int side = -1; side < 4; ++side) {
+			if (side >= 0 && !hasTwo(candidates[side]))
+				continue;
+			auto trialChoice = choice;
+			if (side >= 0)
+				trialChoice[side] = 1;
+			std::array<SideLine, 4> lines;
+			for (int i = 0; i < 4; ++i)
+				lines[i] = candidates[i][trialChoice[i]];
+			QuadrilateralF corners;
+			if (!Intersect(lines, corners))
+				continue;
+			for (auto& corner : corners)
+				corner = transform(corner);
+			PerspectiveTransform trial(gridCorners, corners);
+			if (!IsCentered(trial, bullsEye))
+				continue;
+			int fit = isAmbiguous ? GridFit(image, trial) : 0;
+			if (fit > bestFit) {
+				bestFit = fit;
+				best = trial;
+				choice = trialChoice;
+			}
+		}
+		transform = best;
+	}
+	transform = RefineCorners(image, bullsEye, transform);
+
+	BitMatrix bits(WIDTH, HEIGHT);
+	for (int y = 0; y < HEIGHT; ++y) {
+		// the last module of the odd rows does not exist
+		for (int x = 0; x < WIDTH - (y & 1); ++x) {
+			auto p = round(transform({x + (y & 1 ? 1.0 : 0.5), y + 0.5}));
+			if (!IsInside(image, p))
+				return {};
+			if (image.get(p.x, p.y))
+				bits.set(x, y);
+		}
+	}
+
+	auto corner = [&](double x, double y) { return round(transform({x, y})); };
+	return {std::move(bits), {corner(0, 0), corner(WIDTH, 0), corner(WIDTH, HEIGHT), corner(0, HEIGHT)}};
+}
+
+} // MaxiCode
+} // ZXing
@@ -0,0 +1,63 @@
+#pragma once
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "Point.h"
+
+#include <vector>
+
+namespace ZXing {
+
+class BitMatrix;
+class DetectorResult;
+
+namespace MaxiCode {
+
+/**
+* The center of a bull's eye and the image displacements axisX and axisY of one module pitch along two orthogonal
+* directions of the symbol plane. They map a circle around the center onto the ellipse formed by the outer ring in the
+* image, the rotation of the symbol within that plane is still unknown.
+*/
+struct BullsEye
+{
+	PointF center;
+	PointF axisX, axisY;
+};
+
+/**
+* Detects a MaxiCode in an image that is not pure, i.e. where the symbol may be anywhere, rotated, mirrored or seen
+* at an angle by a camera.
+*/
+class Detector
+{
+public:
+	/**
+	* Finds the bull's eyes in an image by scanning every row for the three concentric rings and fitting an ellipse
+	* to the outer ring of each match. The ones that matched in the most rows come first. With a scanStride > 1 only
+	* every scanStride-th row is scanned.
+	*/
+	static std::vector<BullsEye> FindBullsEyes(const BitMatrix& image, int scanStride = 1);
+
+	/**
+	* Finds the rotation and mirroring of the symbol around a bull's eye from the orientation modules, corrects for the
+	* tilt of the symbol plane from the outer edges of the symbol and samples the hexagonal grid into a
+	* MATRIX_WIDTH x MATRIX_HEIGHT BitMatrix, odd rows shifted by half a module to the right.
+	*/
+	static DetectorResult Detect(const BitMatrix& image, const BullsEye& bullsEye);
+};
+
+} // MaxiCode
+} // ZXing
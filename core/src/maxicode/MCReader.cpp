@@ -17,61 +17,59 @@
 
 #include "MCReader.h"
 #include "MCDecoder.h"
+#include "MCDetector.h"
 #include "MCBitMatrixParser.h"
 #include "Result.h"
 #include "DecodeHints.h"
+#include "DecodeStats.h"
 #include "DecoderResult.h"
+#include "DetectorResult.h"
 #include "BinaryBitmap.h"
 #include "BitMatrix.h"
+#include "ByteArray.h"
+#include "Deadline.h"
+#include "Trace.h"
+
+#include <utility>
 
 namespace ZXing {
 namespace MaxiCode {
 
-
-/**
-* This method detects a code in a "pure" image -- that is, pure monochrome image
-* which contains only an unrotated, unskewed, image of a code, with some white border
-* around it. This is a specialized method that works exceptionally fast in this special
-* case.
-*/
-static BitMatrix ExtractPureBits(const BitMatrix& image)
-{
-	int left, top, width, height;
-	if (!image.findBoundingBox(left, top, width, height, BitMatrixParser::MATRIX_WIDTH)) {
-		return {};
-	}
-
-	// Now just read off the bits
-	BitMatrix result(BitMatrixParser::MATRIX_WIDTH, BitMatrixParser::MATRIX_HEIGHT);
-	for (int y = 0; y < BitMatrixParser::MATRIX_HEIGHT; y++) {
-		int iy = top + (y * height + height / 2) / BitMatrixParser::MATRIX_HEIGHT;
-		for (int x = 0; x < BitMatrixParser::MATRIX_WIDTH; x++) {
-			int ix = left + (x * width + width / 2 + (y & 0x01) *  width / 2) / BitMatrixParser::MATRIX_WIDTH;
-			if (image.get(ix, iy)) {
-				result.set(x, y);
-			}
-		}
-	}
-	return result;
-}
-
-Reader::Reader(const DecodeHints& hints) : _isPure(hints.isPure()) {}
+Reader::Reader(const DecodeHints& hints) : _isPure(hints.isPure()), _scanStride(hints.scanStride()) {}
 
 Result
 Reader::decode(const BinaryBitmap& image) const
 {
-	auto binImg = image.getBlackMatrix();
+	ZX_TRACE_SCOPE("MaxiCode::Reader::decode");
+	DecodeStats::ReaderTimer readerTimer(DecodeStats::ReaderType::MaxiCode);
+	DecodeStats::StageTimer detectTimer(DecodeStats::Stage::Detect);
+	auto binImg = image.getBitMatrix();
 	if (binImg == nullptr) {
 		return Result(DecodeStatus::NotFound);
 	}
 
-	//TODO: this only works with effectively 'pure' barcodes. Needs proper detector.
-	BitMatrix bits = ExtractPureBits(*binImg);
-	if (bits.empty()) {
+	if (!_isPure) {
+		for (auto& bullsEye : Detector::FindBullsEyes(*binImg, _scanStride)) {
+			if (Deadline::Expired())
+				return Result(DecodeStatus::NotFound);
+			auto detectorResult = Detector::Detect(*binImg, bullsEye);
+			if (!detectorResult.isValid())
+				continue;
+			auto decoderResult = Decoder::Decode(detectorResult.bits());
+			if (decoderResult.isValid())
+				return Result(std::move(decoderResult), std::move(detectorResult).position(), BarcodeFormat::MAXICODE);
+		}
+	}
+
+	// a symbol too small for the rings to be resolved might still be read if it is the only thing in the image, i.e. if
+	// it is 'pure': unrotated, unskewed and with some white border around it
+	int left, top, width, height;
+	if (!binImg->findBoundingBox(left, top, width, height, BitMatrixParser::MATRIX_WIDTH)) {
 		return Result(DecodeStatus::NotFound);
 	}
 
-	return Result(Decoder::Decode(bits), {}, BarcodeFormat::MAXICODE);
+	return Result(Decoder::Decode(BitMatrixParser::ReadCodewords(*binImg, left, top, width, height)), {},
+				  BarcodeFormat::MAXICODE);
 }
 
 } // MaxiCode
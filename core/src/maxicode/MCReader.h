@@ -27,6 +27,7 @@ namespace MaxiCode {
 class Reader : public ZXing::Reader
 {
 	bool _isPure;
+	int _scanStride;
 
 public:
 	explicit Reader(const DecodeHints& hints);
@@ -303,8 +303,19 @@ CodabarReader::decodeRow(int rowNumber, const BitArray& row, std::unique_ptr<Dec
 
 // each character has 4 bars and 3 spaces
 constexpr int CHAR_LEN = 7;
+
+static const BitPatternTable<CHAR_LEN>& CharTable()
+{
+	static const BitPatternTable<CHAR_LEN> table(CHARACTER_ENCODINGS, ALPHABET);
+	return table;
+}
+
 // quite zone is half the width of a character symbol
 constexpr float QUITE_ZONE_SCALE = 0.5f;
+// minimal number of characters that must be present (including start, stop and checksum characters)
+// absolute minimum would be 2 (meaning 0 'content'). everything below 4 produces too many false
+// positives.
+constexpr int MIN_CHAR_COUNT = 4;
 
 // official start and stop symbols are "ABCD"
 // some codabar generator allow the codabar string to be closed by every
@@ -315,16 +326,25 @@ inline bool IsStartOrStopPattern(const PatternView& view)
 	return Contains({0x1A, 0x29, 0x0B, 0x0E}, RowReader::NarrowWideBitPattern(view));
 }
 
+int CodabarReader::minPatternSize() const
+{
+	// start, stop and 2 payload characters, separated by inter-character spaces
+	return 4 * (CHAR_LEN + 1) - 1;
+}
+
+Result
+CodabarReader::decodePattern(int rowNumber, const PatternView& row, std::unique_ptr<DecodingState>& state) const
+{
+	return DecodeNearPreviousSymbol(row.subView(0, -MIN_CHAR_COUNT * CHAR_LEN), state,
+									[&](const PatternView& range) { return decodeSymbol(rowNumber, range); });
+}
+
 Result
-CodabarReader::decodePattern(int rowNumber, const PatternView& row, std::unique_ptr<DecodingState>&) const
+CodabarReader::decodeSymbol(int rowNumber, const PatternView& range) const
 {
-	// minimal number of characters that must be present (including start, stop and checksum characters)
-	// absolute minimum would be 2 (meaning 0 'content'). everything below 4 produces too many false
-	// positives.
-	const int minCharCount = 4;
 	auto isStartOrStopSymbol = [](char c) { return 'A' <= c && c <= 'D'; };
 
-	auto next = ZXing::FindPattern<CHAR_LEN>(row.subView(0, -minCharCount * CHAR_LEN), IsStartOrStopPattern, QUITE_ZONE_SCALE);
+	auto next = ZXing::FindPattern<CHAR_LEN>(range, IsStartOrStopPattern, QUITE_ZONE_SCALE);
 	if (!next.isValid())
 		return Result(DecodeStatus::NotFound);
 
@@ -333,7 +353,7 @@ CodabarReader::decodePattern(int rowNumber, const PatternView& row, std::unique_
 
 	std::string txt;
 	txt.reserve(20);
-	txt += DecodeNarrowWidePattern(next, CHARACTER_ENCODINGS, ALPHABET); // read off the start pattern
+	txt += DecodeNarrowWidePattern(next, CharTable()); // read off the start pattern
 
 	if (!isStartOrStopSymbol(txt.back()))
 		return Result(DecodeStatus::NotFound);
@@ -343,14 +363,14 @@ CodabarReader::decodePattern(int rowNumber, const PatternView& row, std::unique_
 		if (!next.skipSymbol() || !next.skipSingle(maxInterCharacterSpace))
 			return Result(DecodeStatus::NotFound);
 
-		txt += DecodeNarrowWidePattern(next, CHARACTER_ENCODINGS, ALPHABET);
+		txt += DecodeNarrowWidePattern(next, CharTable());
 		if (txt.back() < 0)
 			return Result(DecodeStatus::NotFound);
 	} while (!isStartOrStopSymbol(txt.back()));
 
 	// next now points to the last decoded symbol
 	// check txt length and whitespace after the last char. See also FindStartPattern.
-	if (Size(txt) < minCharCount || !next.hasQuiteZoneAfter(QUITE_ZONE_SCALE))
+	if (Size(txt) < MIN_CHAR_COUNT || !next.hasQuiteZoneAfter(QUITE_ZONE_SCALE))
 		return Result(DecodeStatus::NotFound);
 
 	// remove stop/start characters
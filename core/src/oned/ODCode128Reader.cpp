@@ -173,6 +173,13 @@ static int DetectStartCode(const C& c)
 	return bestVariance < MAX_AVG_VARIANCE ? bestCode : 0;
 }
 
+// every code is 6 bars/spaces and 11 modules wide (the stop code has a 7th bar that is not part of the lookup)
+static const PatternTable<6, 11, std::array<std::vector<int>, 107>>& CodeTable()
+{
+	static const PatternTable<6, 11, std::array<std::vector<int>, 107>> table(Code128::CODE_PATTERNS);
+	return table;
+}
+
 static BitArray::Range
 FindStartPattern(const BitArray& row, int* startCode)
 {
@@ -219,7 +226,7 @@ Code128Reader::decodeRow(int rowNumber, const BitArray& row, std::unique_ptr<Dec
 			return Result(DecodeStatus::NotFound);
 
 		// Decode another code from image
-		int code = RowReader::DecodeDigit(counters, Code128::CODE_PATTERNS, MAX_AVG_VARIANCE, MAX_INDIVIDUAL_VARIANCE);
+		int code = RowReader::DecodeDigit(counters, CodeTable(), MAX_AVG_VARIANCE, MAX_INDIVIDUAL_VARIANCE);
 		if (code == -1)
 			return Result(DecodeStatus::NotFound);
 		if (code == CODE_STOP)
@@ -256,10 +263,9 @@ constexpr auto START_PATTERN_PREFIX = FixedPattern<3, 4>{2, 1, 1};
 // quite zone is 10 modules, prefix covers 4 -> require at least 8
 constexpr float QUITE_ZONE_SCALE = 2;
 constexpr int CHAR_LEN = 6;
-
-//#define USE_FAST_1_TO_4_BIT_PATTERN_DECODING
-#ifdef USE_FAST_1_TO_4_BIT_PATTERN_DECODING
 constexpr int CHAR_SUM = 11;
+// widths further off from a whole number of modules are left to the more tolerant DecodeDigit
+constexpr float FAST_MAX_ERROR = 0.3f;
 constexpr int CHARACTER_ENCODINGS[] = {
 	0b11011001100, 0b11001101100, 0b11001100110, 0b10010011000, 0b10010001100, // 0
 	0b10001001100, 0b10011001000, 0b10011000100, 0b10001100100, 0b11001001000, // 5
@@ -284,21 +290,26 @@ constexpr int CHARACTER_ENCODINGS[] = {
 	0b10111101110, 0b11101011110, 0b11110101110, 0b11010000100, 0b11010010000, // 100
 	0b11010011100, 0b11000111010,                                              // 105
 };
-#endif
+
+int Code128Reader::minPatternSize() const
+{
+	// start, payload, checksum and stop code (including the termination bar)
+	return 4 * CHAR_LEN + 1;
+}
 
 Result Code128Reader::decodePattern(int rowNumber, const PatternView& row, std::unique_ptr<DecodingState>&) const
 {
 	int minCharCount = 4; // start + payload + checksum + stop
 	auto decodePattern = [](const PatternView& view, bool start = false) {
-	// TODO: the intention was to always use the way faster OneToFourBitPattern approach but it turned out
-	// the old DecodeDigit currently detects more test samples. There could be gained another 20% in
-	// in performance. This might work once the subpixel binarizer is in place.
-#ifdef USE_FAST_1_TO_4_BIT_PATTERN_DECODING
-		return IndexOf(CHARACTER_ENCODINGS, OneToFourBitPattern<CHAR_LEN, CHAR_SUM>(view));
-#else
+		// The constant time lookup of the module counts is only reliable with sub-pixel widths. Where it fails, the
+		// variance search over all CODE_PATTERNS still detects more symbols.
+		if (view.hasSubPixelWidths()) {
+			int code = IndexOf(CHARACTER_ENCODINGS, OneToFourBitPattern<CHAR_LEN, CHAR_SUM>(view, FAST_MAX_ERROR));
+			if (start ? CODE_START_A <= code && code <= CODE_START_C : code != -1)
+				return code;
+		}
 		return start ? DetectStartCode(view)
-					 : DecodeDigit(view, Code128::CODE_PATTERNS, MAX_AVG_VARIANCE, MAX_INDIVIDUAL_VARIANCE);
-#endif
+					 : DecodeDigit(view, CodeTable(), MAX_AVG_VARIANCE, MAX_INDIVIDUAL_VARIANCE);
 	};
 
 	auto next = ZXing::FindPattern(row.subView(0, -minCharCount * CHAR_LEN), START_PATTERN_PREFIX, QUITE_ZONE_SCALE);
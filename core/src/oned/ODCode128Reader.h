@@ -35,6 +35,7 @@ public:
 	explicit Code128Reader(const DecodeHints& hints);
 	Result decodeRow(int rowNumber, const BitArray& row, std::unique_ptr<DecodingState>& state) const override;
 	Result decodePattern(int rowNumber, const PatternView& row, std::unique_ptr<DecodingState>&) const override;
+	int minPatternSize() const override;
 
 private:
 	bool _convertFNC1;
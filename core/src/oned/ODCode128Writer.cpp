@@ -20,7 +20,6 @@
 #include "ODCode128Patterns.h"
 
 #include <list>
-#include <numeric>
 #include <stdexcept>
 #include <vector>
 
@@ -260,17 +259,10 @@ Code128Writer::encode(const std::wstring& contents, int width, int height) const
 	// Append stop code
 	patterns.push_back(Code128::CODE_PATTERNS[CODE_STOP]);
 
-	// Compute code width
-	int codeWidth = 0;
+	// Compute result, each pattern starts with a bar and all but the stop code end with a space
+	PatternRow result = {0};
 	for (const std::vector<int>& pattern : patterns) {
-		codeWidth += std::accumulate(pattern.begin(), pattern.end(), 0);
-	}
-
-	// Compute result
-	std::vector<bool> result(codeWidth, false);
-	int pos = 0;
-	for (const std::vector<int>& pattern : patterns) {
-		pos += WriterHelper::AppendPattern(result, pos, pattern, true);
+		result.insert(result.end(), pattern.begin(), pattern.end());
 	}
 
 	return WriterHelper::RenderResult(result, width, height, _sidesMargin >= 0 ? _sidesMargin : 10);
@@ -122,6 +122,12 @@ FindAsteriskPattern(const BitArray& row)
 // each character has 5 bars and 4 spaces
 constexpr int CHAR_LEN = 9;
 
+static const BitPatternTable<CHAR_LEN>& CharTable()
+{
+	static const BitPatternTable<CHAR_LEN> table(CHARACTER_ENCODINGS, ALPHABET);
+	return table;
+}
+
 inline bool IsStartOrStopChar(char c)
 {
 	return c == '*';
@@ -218,17 +224,31 @@ constexpr auto START_PATTERN = FixedSparcePattern<CHAR_LEN, 6>{1, 0, 1, 1, 0, 1,
 // quite zone is half the width of a character symbol
 constexpr float QUITE_ZONE_SCALE = 0.5f;
 
-Result Code39Reader::decodePattern(int rowNumber, const PatternView& row, std::unique_ptr<RowReader::DecodingState>&) const
+int Code39Reader::minPatternSize() const
+{
+	// start, stop, optional checksum and 1 payload character, separated by inter-character spaces
+	return (_usingCheckDigit ? 4 : 3) * (CHAR_LEN + 1) - 1;
+}
+
+Result Code39Reader::decodePattern(int rowNumber, const PatternView& row,
+								   std::unique_ptr<RowReader::DecodingState>& state) const
 {
 	// minimal number of characters that must be present (including start, stop and checksum characters)
+	int minCharCount = _usingCheckDigit ? 4 : 3;
+	return DecodeNearPreviousSymbol(row.subView(0, -minCharCount * CHAR_LEN), state,
+									[&](const PatternView& range) { return decodeSymbol(rowNumber, range); });
+}
+
+Result Code39Reader::decodeSymbol(int rowNumber, const PatternView& range) const
+{
 	int minCharCount = _usingCheckDigit ? 4 : 3;
 	auto isStartOrStopSymbol = [](char c) { return c == '*'; };
 
-	auto next = ZXing::FindPattern(row.subView(0, -minCharCount * CHAR_LEN), START_PATTERN, QUITE_ZONE_SCALE);
+	auto next = ZXing::FindPattern(range, START_PATTERN, QUITE_ZONE_SCALE);
 	if (!next.isValid())
 		return Result(DecodeStatus::NotFound);
 
-	if (!isStartOrStopSymbol(DecodeNarrowWidePattern(next, CHARACTER_ENCODINGS, ALPHABET))) // read off the start pattern
+	if (!isStartOrStopSymbol(DecodeNarrowWidePattern(next, CharTable()))) // read off the start pattern
 		return Result(DecodeStatus::NotFound);
 
 	int xStart = next.pixelsInFront();
@@ -242,7 +262,7 @@ Result Code39Reader::decodePattern(int rowNumber, const PatternView& row, std::u
 		if (!next.skipSymbol() || !next.skipSingle(maxInterCharacterSpace))
 			return Result(DecodeStatus::NotFound);
 
-		txt += DecodeNarrowWidePattern(next, CHARACTER_ENCODINGS, ALPHABET);
+		txt += DecodeNarrowWidePattern(next, CharTable());
 		if (txt.back() < 0)
 			return Result(DecodeStatus::NotFound);
 	} while (!isStartOrStopSymbol(txt.back()));
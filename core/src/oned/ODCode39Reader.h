@@ -46,9 +46,13 @@ public:
 	explicit Code39Reader(const DecodeHints& hints);
 	
 	Result decodeRow(int rowNumber, const BitArray& row, std::unique_ptr<DecodingState>& state) const override;
-	Result decodePattern(int rowNumber, const PatternView& row, std::unique_ptr<DecodingState>&) const override;
+	Result decodePattern(int rowNumber, const PatternView& row, std::unique_ptr<DecodingState>& state) const override;
+	int minPatternSize() const override;
 
 private:
+	// decodes the first symbol whose start pattern begins in range
+	Result decodeSymbol(int rowNumber, const PatternView& range) const;
+
 	bool _extendedMode;
 	bool _usingCheckDigit;
 };
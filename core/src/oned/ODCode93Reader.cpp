@@ -167,6 +167,12 @@ constexpr auto START_PATTERN = FixedPattern<CHAR_LEN, CHAR_SUM>{1, 1, 1, 1, 4, 1
 // quite zone is half the width of a character symbol
 constexpr float QUITE_ZONE_SCALE = 0.5f;
 
+int Code93Reader::minPatternSize() const
+{
+	// start, stop, 2 checksum and 1 payload characters plus the termination bar
+	return 5 * CHAR_LEN + 1;
+}
+
 Result Code93Reader::decodePattern(int rowNumber, const PatternView &row, std::unique_ptr<DecodingState> &) const
 {
 	// minimal number of characters that must be present (including start, stop, checksum and 1 payload characters)
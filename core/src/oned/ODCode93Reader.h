@@ -32,6 +32,7 @@ class Code93Reader : public RowReader
 public:
 	Result decodeRow(int rowNumber, const BitArray& row, std::unique_ptr<DecodingState>& state) const override;
 	Result decodePattern(int rowNumber, const PatternView& row, std::unique_ptr<DecodingState>&) const override;
+	int minPatternSize() const override;
 };
 
 } // OneD
@@ -100,5 +100,34 @@ BitArray::Range EAN13Reader::decodeMiddle(const BitArray& row, BitArray::Iterato
 	return {begin, next.begin};
 }
 
+bool EAN13Reader::decodeMiddle(PatternView& next, std::string& resultString) const
+{
+	int lgPatternFound = 0;
+
+	for (int x = 0; x < 6; x++) {
+		int bestMatch = DecodeDigit(&next, UPCEANCommon::L_AND_G_PATTERNS, &resultString);
+		if (bestMatch == -1)
+			return false;
+
+		if (bestMatch >= 10) {
+			lgPatternFound |= 1 << (5 - x);
+		}
+	}
+
+	int index = IndexOf(FIRST_DIGIT_ENCODINGS, lgPatternFound);
+	if (index == -1)
+		return false;
+	resultString.insert(0, 1, (char)('0' + index));
+
+	if (!ReadGuardPattern(&next, UPCEANCommon::MIDDLE_PATTERN))
+		return false;
+
+	for (int x = 0; x < 6; x++) {
+		if (DecodeDigit(&next, UPCEANCommon::L_PATTERNS, &resultString) == -1)
+			return false;
+	}
+	return true;
+}
+
 } // OneD
 } // ZXing
@@ -35,6 +35,7 @@ public:
 
 	BarcodeFormat expectedFormat() const override;
 	BitArray::Range decodeMiddle(const BitArray& row, BitArray::Iterator begin, std::string& resultString) const override;
+	bool decodeMiddle(PatternView& next, std::string& resultString) const override;
 };
 
 } // OneD
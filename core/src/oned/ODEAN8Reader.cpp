@@ -52,5 +52,23 @@ EAN8Reader::decodeMiddle(const BitArray& row, BitArray::Iterator begin, std::str
 	return {begin, next.begin};
 }
 
+bool
+EAN8Reader::decodeMiddle(PatternView& next, std::string& resultString) const
+{
+	for (int x = 0; x < 4; x++) {
+		if (DecodeDigit(&next, UPCEANCommon::L_PATTERNS, &resultString) == -1)
+			return false;
+	}
+
+	if (!ReadGuardPattern(&next, UPCEANCommon::MIDDLE_PATTERN))
+		return false;
+
+	for (int x = 0; x < 4; x++) {
+		if (DecodeDigit(&next, UPCEANCommon::L_PATTERNS, &resultString) == -1)
+			return false;
+	}
+	return true;
+}
+
 } // OneD
 } // ZXing
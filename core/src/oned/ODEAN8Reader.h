@@ -34,6 +34,7 @@ public:
 protected:
 	BarcodeFormat expectedFormat() const override;
 	BitArray::Range decodeMiddle(const BitArray& row, BitArray::Iterator begin, std::string& resultString) const override;
+	bool decodeMiddle(PatternView& next, std::string& resultString) const override;
 };
 
 } // OneD
@@ -200,6 +200,8 @@ ITFReader::ITFReader(const DecodeHints& hints) :
 	if (_allowedLengths.empty()) {
 		_allowedLengths.assign(DEFAULT_ALLOWED_LENGTHS.begin(), DEFAULT_ALLOWED_LENGTHS.end());
 	}
+	_minLength = *std::min_element(_allowedLengths.begin(), _allowedLengths.end());
+	_maxLength = *std::max_element(_allowedLengths.begin(), _allowedLengths.end());
 }
 
 Result
@@ -220,12 +222,8 @@ ITFReader::decodeRow(int rowNumber, const BitArray& row, std::unique_ptr<Decodin
 
 	// To avoid false positives with 2D barcodes (and other patterns), make
 	// an assumption that the decoded string must be a 'standard' length if it's short
-	int length = Size(result);
-	if (!_allowedLengths.empty() && !Contains(_allowedLengths, length)) {
-		int maxAllowedLength = *std::max_element(_allowedLengths.begin(), _allowedLengths.end());
-		if (length < maxAllowedLength)
-			return Result(DecodeStatus::FormatError);
-	}
+	if (!isAllowedLength(Size(result)))
+		return Result(DecodeStatus::FormatError);
 
 	int xStart = static_cast<int>(startRange.begin - row.begin());
 	int xStop = static_cast<int>(endRange.end - row.begin() - 1);
@@ -237,47 +235,77 @@ constexpr auto STOP_PATTERN_1 = FixedPattern<3, 4>{2, 1, 1};
 constexpr auto STOP_PATTERN_2 = FixedPattern<3, 5>{3, 1, 1};
 
 constexpr float QUITE_ZONE_SCALE = 2.5; // spec says 10 modules
+constexpr int MIN_CHAR_COUNT = 6;
+
+/**
+* Maps the narrow/wide bit pattern of the 10 bars and spaces of a pair of interleaved digits (see
+* RowReader::NarrowWideBitPattern) to the value of the pair (0-99) or -1 if it does not encode one.
+*/
+static const std::array<int8_t, 1 << 10>& PairTable()
+{
+	static const auto table = [] {
+		std::array<int8_t, 1 << 10> res;
+		res.fill(-1);
+		for (int first = 0; first < 10; ++first)
+			for (int second = 0; second < 10; ++second) {
+				// the bars encode the first digit, the spaces the second one
+				int key = 0;
+				for (int i = 0; i < 5; ++i)
+					key = (key << 2) | (PATTERNS[first][i] != N) << 1 | (PATTERNS[second][i] != N);
+				res[key] = static_cast<int8_t>(10 * first + second);
+			}
+		return res;
+	}();
+	return table;
+}
+
+bool ITFReader::isAllowedLength(int length) const
+{
+	// anything longer than the largest allowed length is accepted as well
+	return length > _maxLength || Contains(_allowedLengths, length);
+}
 
-Result ITFReader::decodePattern(int rowNumber, const PatternView& row, std::unique_ptr<DecodingState>&) const
+int ITFReader::minPatternSize() const
 {
-	const int minCharCount = 6;
+	// start pattern, 3 pairs of digits and stop pattern
+	return 4 + 3 * 10 + 3;
+}
 
-	auto next = ZXing::FindPattern(row.subView(0, -(4 + minCharCount/2 + 3)), START_PATTERN_, QUITE_ZONE_SCALE);
+Result ITFReader::decodePattern(int rowNumber, const PatternView& row, std::unique_ptr<DecodingState>& state) const
+{
+	// a start pattern with not enough room for the shortest allowed symbol behind it is not even looked at
+	int minPairs = (std::max(MIN_CHAR_COUNT, _minLength) + 1) / 2;
+	return DecodeNearPreviousSymbol(row.subView(0, -(4 + minPairs * 10 + 3)), state,
+									[&](const PatternView& range) { return decodeSymbol(rowNumber, range); });
+}
+
+Result ITFReader::decodeSymbol(int rowNumber, const PatternView& range) const
+{
+	auto next = ZXing::FindPattern(range, START_PATTERN_, QUITE_ZONE_SCALE);
 	if (!next.isValid())
 		return Result(DecodeStatus::NotFound);
 
 	std::string txt;
 	txt.reserve(20);
 
-	constexpr int weights[] = {1, 2, 4, 7, 0};
 	int xStart = next.pixelsInFront();
 	next = next.subView(4, 10);
 
-	while (next.index() < row.size() - (10 + 3)) {
-		const auto threshold = NarrowWideThreshold(next);
-		if (!threshold.isValid())
-			break;
-
-		BarAndSpace<int> digits, numWide;
-		for (int i = 0; i < 10; ++i) {
-			if (next[i] > threshold[i] * 2)
-				break;
-			numWide[i] += next[i] > threshold[i];
-			digits[i] += weights[i/2] * (next[i] > threshold[i]);
-		}
-
-		if (numWide.bar != 2 || numWide.space != 2)
+	// each loop iteration needs room for the 10 bars/spaces of a digit pair, the stop pattern and the quite zone
+	while (next.isValid(10 + 3 + 1)) {
+		int pair = PairTable()[std::max(0, NarrowWideBitPattern(next))];
+		if (pair == -1)
 			break;
 
-		for (int i = 0; i < 2; ++i)
-			txt.push_back((char)('0' + (digits[i] == 11 ? 0 : digits[i])));
+		txt.push_back(static_cast<char>('0' + pair / 10));
+		txt.push_back(static_cast<char>('0' + pair % 10));
 
 		next.skipSymbol();
 	}
 
 	next = next.subView(0, 3);
 
-	if (Size(txt) < minCharCount || !next.hasQuiteZoneAfter(QUITE_ZONE_SCALE))
+	if (Size(txt) < MIN_CHAR_COUNT || !isAllowedLength(Size(txt)) || !next.hasQuiteZoneAfter(QUITE_ZONE_SCALE))
 		return Result(DecodeStatus::NotFound);
 
 	if (!IsPattern(next, STOP_PATTERN_1) && !IsPattern(next, STOP_PATTERN_2))
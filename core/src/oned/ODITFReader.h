@@ -47,10 +47,17 @@ class ITFReader : public RowReader
 public:
 	explicit ITFReader(const DecodeHints& hints);
 	Result decodeRow(int rowNumber, const BitArray& row, std::unique_ptr<DecodingState>& state) const override;
-	Result decodePattern(int rowNumber, const PatternView& row, std::unique_ptr<DecodingState>&) const override;
+	Result decodePattern(int rowNumber, const PatternView& row, std::unique_ptr<DecodingState>& state) const override;
+	int minPatternSize() const override;
 
 private:
+	// decodes the first symbol whose start pattern begins in range
+	Result decodeSymbol(int rowNumber, const PatternView& range) const;
+	bool isAllowedLength(int length) const;
+
 	std::vector<int> _allowedLengths;
+	int _minLength;
+	int _maxLength;
 };
 
 } // OneD
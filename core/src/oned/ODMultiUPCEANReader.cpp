@@ -54,8 +54,33 @@ MultiUPCEANReader::MultiUPCEANReader(const DecodeHints& hints)
 
 MultiUPCEANReader::~MultiUPCEANReader() = default;
 
+/**
+* Special case: a 12-digit code encoded in UPC-A is identical to a "0"
+* followed by those 12 digits encoded as EAN-13. Each will recognize such a code,
+* UPC-A as a 12-digit string and EAN-13 as a 13-digit string starting with "0".
+* Individually these are correct and their readers will both read such a code
+* and correctly call it EAN-13, or UPC-A, respectively.
+*
+* In this case, if we've been looking for both types, we'd like to call it
+* a UPC-A code. But for efficiency we only run the EAN-13 decoder to also read
+* UPC-A. So we special case it here, and convert an EAN-13 result to a UPC-A
+* result if appropriate.
+*
+* But, don't return UPC-A if UPC-A was not a requested format!
+*/
+static void
+MaybeConvertToUPCA(Result& result, bool canReturnUPCA)
+{
+	const std::wstring& resultText = result.text();
+	bool ean13MayBeUPCA = result.format() == BarcodeFormat::EAN_13 && !resultText.empty() && resultText[0] == '0';
+	if (ean13MayBeUPCA && canReturnUPCA) {
+		result.setText(resultText.substr(1));
+		result.setFormat(BarcodeFormat::UPC_A);
+	}
+}
+
 Result
-MultiUPCEANReader::decodeRow(int rowNumber, const BitArray& row, std::unique_ptr<DecodingState>&) const
+MultiUPCEANReader::decodeRow(int rowNumber, const BitArray& row, std::unique_ptr<DecodingState>& state) const
 {
 	// Compute this location once and reuse it on multiple implementations
 	auto range = UPCEANReader::FindStartGuardPattern(row);
@@ -63,28 +88,35 @@ MultiUPCEANReader::decodeRow(int rowNumber, const BitArray& row, std::unique_ptr
 		return Result(DecodeStatus::NotFound);
 
 	for (auto& reader : _readers) {
-		Result result = reader->decodeRow(rowNumber, row, range);
+		Result result = reader->decodeRow(rowNumber, row, range, state);
+		if (!result.isValid())
+			continue;
+
+		MaybeConvertToUPCA(result, _canReturnUPCA);
+		return result;
+	}
+	return Result(DecodeStatus::NotFound);
+}
+
+int MultiUPCEANReader::minPatternSize() const
+{
+	// UPC-E: start guard, 6 digits and end guard
+	return 3 + 6 * 4 + 6;
+}
+
+Result
+MultiUPCEANReader::decodePattern(int rowNumber, const PatternView& row, std::unique_ptr<DecodingState>& state) const
+{
+	auto startGuard = UPCEANReader::FindStartGuardPattern(row);
+	if (!startGuard.isValid())
+		return Result(DecodeStatus::NotFound);
+
+	for (auto& reader : _readers) {
+		Result result = reader->decodeAtStartGuard(rowNumber, startGuard, state);
 		if (!result.isValid())
 			continue;
 
-		// Special case: a 12-digit code encoded in UPC-A is identical to a "0"
-		// followed by those 12 digits encoded as EAN-13. Each will recognize such a code,
-		// UPC-A as a 12-digit string and EAN-13 as a 13-digit string starting with "0".
-		// Individually these are correct and their readers will both read such a code
-		// and correctly call it EAN-13, or UPC-A, respectively.
-		//
-		// In this case, if we've been looking for both types, we'd like to call it
-		// a UPC-A code. But for efficiency we only run the EAN-13 decoder to also read
-		// UPC-A. So we special case it here, and convert an EAN-13 result to a UPC-A
-		// result if appropriate.
-		//
-		// But, don't return UPC-A if UPC-A was not a requested format!
-		const std::wstring& resultText = result.text();
-		bool ean13MayBeUPCA = result.format() == BarcodeFormat::EAN_13 && !resultText.empty() && resultText[0] == '0';
-		if (ean13MayBeUPCA && _canReturnUPCA) {
-			result.setText(resultText.substr(1));
-			result.setFormat(BarcodeFormat::UPC_A);
-		}
+		MaybeConvertToUPCA(result, _canReturnUPCA);
 		return result;
 	}
 	return Result(DecodeStatus::NotFound);
@@ -44,6 +44,8 @@ public:
 	~MultiUPCEANReader() override;
 
 	Result decodeRow(int rowNumber, const BitArray& row, std::unique_ptr<DecodingState>& state) const override;
+	Result decodePattern(int rowNumber, const PatternView& row, std::unique_ptr<DecodingState>& state) const override;
+	int minPatternSize() const override;
 
 private:
 	std::vector<std::unique_ptr<const UPCEANReader>> _readers;
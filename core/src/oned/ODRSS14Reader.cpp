@@ -30,6 +30,7 @@
 #include <numeric>
 #include <sstream>
 #include <iomanip>
+#include <iterator>
 
 namespace ZXing {
 namespace OneD {
@@ -59,6 +60,7 @@ struct RSS14DecodingState : public RowReader::DecodingState
 {
 	std::list<RSS::Pair> possibleLeftPairs;
 	std::list<RSS::Pair> possibleRightPairs;
+	PatternRow reversedRow;
 };
 
 //private final List<Pair> possibleLeftPairs;
@@ -85,6 +87,26 @@ FindFinderPattern(const BitArray& row, bool rightFinderPattern, FinderCounters&
 		});
 }
 
+static PatternView
+FindFinderPattern(const PatternView& row, bool rightFinderPattern)
+{
+	int width = row.pixelsInFront() + row.sum();
+	if (width < 2 * 18 + 14)
+		return {};
+
+	// Same as above: the left finder pattern starts with a bar, the right one (the row is reversed) with a space.
+	auto window = row.subView(rightFinderPattern ? 1 : 0, 4);
+	for (int begin = window.pixelsInFront(); window.isValid(4); begin += window[0] + window[1], window.skipPair()) {
+		if (begin < 18)
+			continue;
+		FinderCounters counters = {window[0], window[1], window[2], window[3]};
+		int end = begin + Reduce(counters);
+		if (ReaderHelper::IsFinderPattern(counters) && begin > (end - begin) && (width - end) > (end - begin))
+			return window;
+	}
+	return {};
+}
+
 static RSS::FinderPattern
 ParseFoundFinderPattern(const BitArray& row, int rowNumber, bool right, BitArray::Range range, FinderCounters& finderCounters)
 {
@@ -117,6 +139,26 @@ ParseFoundFinderPattern(const BitArray& row, int rowNumber, bool right, BitArray
 			{ResultPoint(start, rowNumber), ResultPoint(end, rowNumber)}};
 }
 
+static RSS::FinderPattern
+ParseFoundFinderPattern(const PatternView& row, int rowNumber, bool right, const PatternView& window)
+{
+	if (!window.isValid())
+		return {};
+
+	// Actually we found elements 2-5 -> element 1 is the one in front of them
+	FinderCounters finderCounters = {window[-1], window[0], window[1], window[2]};
+	int value = RSS::ReaderHelper::ParseFinderValue(finderCounters, FINDER_PATTERNS);
+	if (value < 0)
+		return {};
+
+	int start = window.pixelsInFront() - window[-1];
+	int end = window.pixelsInFront() + window.sum();
+	int width = row.pixelsInFront() + row.sum();
+
+	return {value, start, end,
+			{ResultPoint(right ? width - 1 - start : start, rowNumber), ResultPoint(right ? width - 1 - end : end, rowNumber)}};
+}
+
 static bool
 AdjustOddEvenCounts(bool outsideChar, int numModules, std::array<int, 4>& oddCounts, std::array<int, 4>& evenCounts,
 	const std::array<float, 4>& oddRoundingErrors, const std::array<float, 4>& evenRoundingErrors)
@@ -250,20 +292,8 @@ AdjustOddEvenCounts(bool outsideChar, int numModules, std::array<int, 4>& oddCou
 }
 
 static RSS::DataCharacter
-DecodeDataCharacter(const BitArray& row, const RSS::FinderPattern& pattern, bool outsideChar)
+DecodeDataCharacter(const std::array<int, 8>& counters, bool outsideChar)
 {
-	std::array<int, 8> counters = {};
-
-	if (outsideChar) {
-		if (!RowReader::RecordPatternInReverse(row.begin(), row.iterAt(pattern.startPos()), counters))
-			return {};
-	}
-	else {
-		if (!RowReader::RecordPattern(row.iterAt(pattern.endPos()), row.end(), counters))
-			return {};
-		std::reverse(counters.begin(), counters.end());
-	}
-
 	int numModules = outsideChar ? 16 : 15;
 	float elementWidth = static_cast<float>(std::accumulate(counters.begin(), counters.end(), 0)) / static_cast<float>(numModules);
 
@@ -338,6 +368,60 @@ DecodeDataCharacter(const BitArray& row, const RSS::FinderPattern& pattern, bool
 
 }
 
+static RSS::DataCharacter
+DecodeDataCharacter(const BitArray& row, const RSS::FinderPattern& pattern, bool outsideChar)
+{
+	std::array<int, 8> counters = {};
+
+	if (outsideChar) {
+		if (!RowReader::RecordPatternInReverse(row.begin(), row.iterAt(pattern.startPos()), counters))
+			return {};
+	}
+	else {
+		if (!RowReader::RecordPattern(row.iterAt(pattern.endPos()), row.end(), counters))
+			return {};
+		std::reverse(counters.begin(), counters.end());
+	}
+
+	return DecodeDataCharacter(counters, outsideChar);
+}
+
+static RSS::DataCharacter
+DecodeDataCharacter(const PatternView& finder, bool outsideChar)
+{
+	// the outside character are the 8 elements in front of element 1 of the finder pattern, the inside
+	// character the 8 elements following element 5 (in reverse order)
+	auto view = outsideChar ? finder.subView(-1 - 8, 8) : finder.subView(4, 8);
+	// the run touching the end of the row must not be empty
+	if (!view.isValid(8) || view[outsideChar ? 0 : 7] == 0)
+		return {};
+
+	std::array<int, 8> counters;
+	if (outsideChar)
+		std::copy(view.begin(), view.end(), counters.begin());
+	else
+		std::reverse_copy(view.begin(), view.end(), counters.begin());
+
+	return DecodeDataCharacter(counters, outsideChar);
+}
+
+static RSS::Pair
+DecodePair(const PatternView& row, bool right, int rowNumber)
+{
+	auto finder = FindFinderPattern(row, right);
+	auto pattern = ParseFoundFinderPattern(row, rowNumber, right, finder);
+	if (pattern.isValid()) {
+		auto outside = DecodeDataCharacter(finder, true);
+		if (outside.isValid()) {
+			auto inside = DecodeDataCharacter(finder, false);
+			if (inside.isValid()) {
+				return {1597 * outside.value() + inside.value(), outside.checksumPortion() + 4 * inside.checksumPortion(), pattern};
+			}
+		}
+	}
+	return {};
+}
+
 static RSS::Pair
 DecodePair(const BitArray& row, bool right, int rowNumber)
 {
@@ -416,27 +500,16 @@ ConstructResult(const RSS::Pair& leftPair, const RSS::Pair& rightPair)
 	return Result(buffer.str(), { leftPoints[0], leftPoints[1], rightPoints[0], rightPoints[1] }, BarcodeFormat::RSS_14);
 }
 
-Result
-RSS14Reader::decodeRow(int rowNumber, const BitArray& row_, std::unique_ptr<DecodingState>& state) const
+static Result
+CombinePairs(const RSS14DecodingState& state)
 {
-	if (!state) {
-		state.reset(new RSS14DecodingState);
-	}
-	auto* prevState = static_cast<RSS14DecodingState*>(state.get());
-
-	BitArray row = row_.copy();
-	AddOrTally(prevState->possibleLeftPairs, DecodePair(row, false, rowNumber));
-	row.reverse();
-	AddOrTally(prevState->possibleRightPairs, DecodePair(row, true, rowNumber));
-//	row.reverse();
-
 	// To be able to detect "stacked" RSS codes (split over multiple lines)
 	// we need to store the parts we found and try all possible left/right
 	// combinations. To prevent lots of false positives, we require each
 	// pair to have been seen in at least two lines.
-	for (const auto& left : prevState->possibleLeftPairs) {
+	for (const auto& left : state.possibleLeftPairs) {
 		if (left.count() > 1) {
-			for (const auto& right : prevState->possibleRightPairs) {
+			for (const auto& right : state.possibleRightPairs) {
 				if (right.count() > 1) {
 					if (CheckChecksum(left, right)) {
 						return ConstructResult(left, right);
@@ -448,5 +521,45 @@ RSS14Reader::decodeRow(int rowNumber, const BitArray& row_, std::unique_ptr<Deco
 	return Result(DecodeStatus::NotFound);
 }
 
+Result
+RSS14Reader::decodeRow(int rowNumber, const BitArray& row_, std::unique_ptr<DecodingState>& state) const
+{
+	if (!state) {
+		state.reset(new RSS14DecodingState);
+	}
+	auto* prevState = static_cast<RSS14DecodingState*>(state.get());
+
+	BitArray row = row_.copy();
+	AddOrTally(prevState->possibleLeftPairs, DecodePair(row, false, rowNumber));
+	row.reverse();
+	AddOrTally(prevState->possibleRightPairs, DecodePair(row, true, rowNumber));
+//	row.reverse();
+
+	return CombinePairs(*prevState);
+}
+
+int RSS14Reader::minPatternSize() const
+{
+	// outside data character, finder pattern and inside data character of one pair
+	return 8 + 4 + 8;
+}
+
+Result
+RSS14Reader::decodePattern(int rowNumber, const PatternView& row, std::unique_ptr<DecodingState>& state) const
+{
+	if (!state) {
+		state.reset(new RSS14DecodingState);
+	}
+	auto* prevState = static_cast<RSS14DecodingState*>(state.get());
+
+	auto& reversed = prevState->reversedRow;
+	reversed.assign(std::make_reverse_iterator(row.end()), std::make_reverse_iterator(row.data() - row.index()));
+
+	AddOrTally(prevState->possibleLeftPairs, DecodePair(row, false, rowNumber));
+	AddOrTally(prevState->possibleRightPairs, DecodePair(reversed, true, rowNumber));
+
+	return CombinePairs(*prevState);
+}
+
 } // OneD
 } // ZXing
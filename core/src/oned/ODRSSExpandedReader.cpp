@@ -27,8 +27,8 @@
 #include <algorithm>
 #include <array>
 #include <cmath>
+#include <cstdint>
 #include <iterator>
-#include <list>
 #include <numeric>
 #include <vector>
 
@@ -97,14 +97,14 @@ static const std::array<std::vector<int>, 10> FINDER_PATTERN_SEQUENCES = { {
 
 struct RSSExpandedDecodingState : public RowReader::DecodingState
 {
-	std::list<RSS::ExpandedRow> rows;
+	std::vector<RSS::ExpandedRow> rows;
 };
 
 
 using namespace RSS;
 
 static BitArray::Range
-FindNextPair(const BitArray& row, const std::list<ExpandedPair>& previousPairs, int forcedOffset, bool startFromEven, FinderCounters& counters)
+FindNextPair(const BitArray& row, const ExpandedPairs& previousPairs, int forcedOffset, bool startFromEven, FinderCounters& counters)
 {
 	int rowOffset;
 	if (forcedOffset >= 0) {
@@ -167,6 +167,42 @@ ParseFoundFinderPattern(const BitArray& row, int rowNumber, bool oddPattern, Bit
 	return {value, start, end, {ResultPoint(start, rowNumber), ResultPoint(end, rowNumber)}};
 }
 
+static PatternView
+FindNextPair(const PatternView& next, bool searchingEvenPair)
+{
+	// like above, the search starts at a bar and the last element touching the end of the row is not considered
+	for (auto window = next.subView(0, 4); window.isValid(4 + 1); window.skipPair()) {
+		FinderCounters counters = {window[0], window[1], window[2], window[3]};
+		if (ReaderHelper::IsFinderPatternExtended(counters, searchingEvenPair))
+			return window;
+	}
+	return {};
+}
+
+static FinderPattern
+ParseFoundFinderPattern(const PatternView& window, int rowNumber, bool oddPattern)
+{
+	// Actually we found elements 2-5. Element 1 is in front of them for odd patterns and, as even patterns
+	// are reversed, behind them for even ones.
+	FinderCounters counters;
+	int start = window.pixelsInFront();
+	int end = start + window.sum();
+	if (oddPattern) {
+		counters = {window[-1], window[0], window[1], window[2]};
+		start -= window[-1];
+	}
+	else {
+		counters = {window[4], window[3], window[2], window[1]};
+		end += window[4];
+	}
+
+	int value = ReaderHelper::ParseFinderValue(counters, FINDER_PATTERNS);
+	if (value < 0)
+		return {};
+
+	return {value, start, end, {ResultPoint(start, rowNumber), ResultPoint(end, rowNumber)}};
+}
+
 static bool
 IsNotA1left(FinderPattern pattern, bool isOddPattern, bool leftChar)
 {
@@ -278,20 +314,8 @@ AdjustOddEvenCounts(int numModules, std::array<int, 4>& oddCounts, std::array<in
 }
 
 static DataCharacter
-DecodeDataCharacter(const BitArray& row, const FinderPattern& pattern, bool isOddPattern, bool leftChar)
+DecodeDataCharacter(const std::array<int, 8>& counters, const FinderPattern& pattern, bool isOddPattern, bool leftChar)
 {
-	std::array<int, 8> counters = {};
-
-	if (leftChar) {
-		if (!RowReader::RecordPatternInReverse(row.begin(), row.iterAt(pattern.startPos()), counters))
-			return {};
-	}
-	else {
-		if (!RowReader::RecordPattern(row.iterAt(pattern.endPos()), row.end(), counters))
-			return {};
-		std::reverse(counters.begin(), counters.end());
-	}
-
 	int numModules = 17; //left and right data characters have all the same length
 	float elementWidth = static_cast<float>(std::accumulate(counters.begin(), counters.end(), 0)) / static_cast<float>(numModules);
 
@@ -374,9 +398,46 @@ DecodeDataCharacter(const BitArray& row, const FinderPattern& pattern, bool isOd
 	return {value, checksumPortion};
 }
 
+static DataCharacter
+DecodeDataCharacter(const BitArray& row, const FinderPattern& pattern, bool isOddPattern, bool leftChar)
+{
+	std::array<int, 8> counters = {};
+
+	if (leftChar) {
+		if (!RowReader::RecordPatternInReverse(row.begin(), row.iterAt(pattern.startPos()), counters))
+			return {};
+	}
+	else {
+		if (!RowReader::RecordPattern(row.iterAt(pattern.endPos()), row.end(), counters))
+			return {};
+		std::reverse(counters.begin(), counters.end());
+	}
+
+	return DecodeDataCharacter(counters, pattern, isOddPattern, leftChar);
+}
+
+static DataCharacter
+DecodeDataCharacter(const PatternView& window, const FinderPattern& pattern, bool isOddPattern, bool leftChar)
+{
+	// window holds the elements 2-5 of the finder pattern (see ParseFoundFinderPattern), the left character
+	// are the 8 elements in front of the pattern, the right one the 8 elements behind it (in reverse order)
+	auto view = leftChar ? window.subView(isOddPattern ? -1 - 8 : -8, 8) : window.subView(isOddPattern ? 4 : 5, 8);
+	// the run touching the end of the row must not be empty
+	if (!view.isValid(8) || view[leftChar ? 0 : 7] == 0)
+		return {};
+
+	std::array<int, 8> counters;
+	if (leftChar)
+		std::copy(view.begin(), view.end(), counters.begin());
+	else
+		std::reverse_copy(view.begin(), view.end(), counters.begin());
+
+	return DecodeDataCharacter(counters, pattern, isOddPattern, leftChar);
+}
+
 // not private for testing
 static bool
-RetrieveNextPair(const BitArray& row, const std::list<ExpandedPair>& previousPairs, int rowNumber, bool startFromEven, ExpandedPair& outPair)
+RetrieveNextPair(const BitArray& row, const ExpandedPairs& previousPairs, int rowNumber, bool startFromEven, ExpandedPair& outPair)
 {
 	bool isOddPattern = previousPairs.size() % 2 == 0;
 	if (startFromEven) {
@@ -419,7 +480,43 @@ RetrieveNextPair(const BitArray& row, const std::list<ExpandedPair>& previousPai
 }
 
 static bool
-CheckChecksum(const std::list<ExpandedPair>& myPairs)
+RetrieveNextPair(PatternView& next, const ExpandedPairs& previousPairs, int rowNumber, bool startFromEven, ExpandedPair& outPair)
+{
+	bool isOddPattern = previousPairs.size() % 2 == 0;
+	if (startFromEven) {
+		isOddPattern = !isOddPattern;
+	}
+
+	PatternView window = next;
+	FinderPattern pattern;
+	do {
+		window = FindNextPair(window, !isOddPattern);
+		if (!window.isValid())
+			return false;
+
+		pattern = ParseFoundFinderPattern(window, rowNumber, isOddPattern);
+		if (!pattern.isValid()) {
+			// goto next bar of same color than current position
+			window.skipPair();
+		}
+	} while (!pattern.isValid());
+
+	DataCharacter leftChar = DecodeDataCharacter(window, pattern, isOddPattern, true);
+	if (!leftChar.isValid() || (!previousPairs.empty() && previousPairs.back().mustBeLast())) {
+		return false;
+	}
+
+	DataCharacter rightChar = DecodeDataCharacter(window, pattern, isOddPattern, false);
+	bool mayBeLast = true;
+	outPair = ExpandedPair(leftChar, rightChar, pattern, mayBeLast);
+
+	// continue the search with the first bar after the finder pattern
+	next = window.subView(isOddPattern ? 4 : 6);
+	return true;
+}
+
+static bool
+CheckChecksum(const ExpandedPairs& myPairs)
 {
 	if (myPairs.empty())
 		return false;
@@ -433,7 +530,7 @@ CheckChecksum(const std::list<ExpandedPair>& myPairs)
 	int checksum = firstPair.rightChar().checksumPortion();
 	int s = 2;
 
-	for (auto it = ++myPairs.begin(); it != myPairs.end(); ++it) {
+	for (auto it = myPairs.begin() + 1; it != myPairs.end(); ++it) {
 		checksum += it->leftChar().checksumPortion();
 		s++;
 		auto& currentRightChar = it->rightChar();
@@ -450,18 +547,11 @@ CheckChecksum(const std::list<ExpandedPair>& myPairs)
 
 // Returns true when one of the rows already contains all the pairs
 static bool
-IsPartialRow(const std::list<ExpandedPair>& pairs, const std::list<ExpandedRow>& rows) {
+IsPartialRow(const ExpandedPairs& pairs, const std::vector<ExpandedRow>& rows) {
 	for (const ExpandedRow& r : rows) {
 		bool allFound = true;
 		for (const ExpandedPair& p : pairs) {
-			bool found = false;
-			for (const ExpandedPair& pp : r.pairs()) {
-				if (p == pp) {
-					found = true;
-					break;
-				}
-			}
-			if (!found) {
+			if (std::find(r.pairs().begin(), r.pairs().end(), p) == r.pairs().end()) {
 				allFound = false;
 				break;
 			}
@@ -476,43 +566,18 @@ IsPartialRow(const std::list<ExpandedPair>& pairs, const std::list<ExpandedRow>&
 
 // Remove all the rows that contains only specified pairs 
 static void
-RemovePartialRows(std::list<ExpandedRow>& rows, const std::list<ExpandedPair>& pairs)
+RemovePartialRows(std::vector<ExpandedRow>& rows, const ExpandedPairs& pairs)
 {
-	auto it = rows.begin();
-	while (it != rows.end()) {
-		//ExpandedRow r = iterator.next();
-		if (it->pairs().size() == pairs.size()) {
-			++it;
-			continue;
-		}
-		bool allFound = true;
-		for (const ExpandedPair& p : it->pairs()) {
-			bool found = false;
-			for (const ExpandedPair& pp : pairs) {
-				if (p == pp) {
-					found = true;
-					break;
-				}
-			}
-			if (!found) {
-				allFound = false;
-				break;
-			}
-		}
-		if (allFound) {
-			// 'pairs' contains all the pairs from the row 'r'
-			auto remPos = it;
-			++it;
-			rows.erase(remPos);
-		}
-		else {
-			++it;
-		}
-	}
+	auto containsAll = [&pairs](const ExpandedRow& r) {
+		// 'pairs' contains all the pairs from the row 'r'
+		auto inPairs = [&pairs](auto& p) { return std::find(pairs.begin(), pairs.end(), p) != pairs.end(); };
+		return r.pairs().size() != pairs.size() && std::all_of(r.pairs().begin(), r.pairs().end(), inPairs);
+	};
+	rows.erase(std::remove_if(rows.begin(), rows.end(), containsAll), rows.end());
 }
 
 static void
-StoreRow(std::list<ExpandedRow>& rows, const std::list<ExpandedPair>& pairs, int rowNumber, bool wasReversed)
+StoreRow(std::vector<ExpandedRow>& rows, const ExpandedPairs& pairs, int rowNumber, bool wasReversed)
 {
 	// Discard if duplicate above or below; otherwise insert in order by row number.
 	bool prevIsSame = false;
@@ -543,80 +608,129 @@ StoreRow(std::list<ExpandedRow>& rows, const std::list<ExpandedPair>& pairs, int
 	RemovePartialRows(rows, pairs);
 }
 
+// Returns a bit mask of the FINDER_PATTERN_SEQUENCES the pairs are a complete sequence or a prefix of
+static int
+MatchingSequences(const ExpandedPairs& pairs)
+{
+	int res = 0;
+	for (int i = 0; i < Size(FINDER_PATTERN_SEQUENCES); ++i) {
+		auto& sequence = FINDER_PATTERN_SEQUENCES[i];
+		if (pairs.size() <= Size(sequence) &&
+			std::equal(pairs.begin(), pairs.end(), sequence.begin(),
+					   [](const ExpandedPair& p, int seq) { return p.finderPattern().value() == seq; })) {
+			res |= 1 << i;
+		}
+	}
+	return res;
+}
+
 // Whether the pairs form a valid find pattern seqience,
 // either complete or a prefix
 static bool
-IsValidSequence(const std::list<ExpandedPair>& pairs)
+IsValidSequence(const ExpandedPairs& pairs)
 {
-	for (auto& sequence : FINDER_PATTERN_SEQUENCES) {
-		if (pairs.size() <= sequence.size() && std::equal(pairs.begin(), pairs.end(), sequence.begin(), [](const ExpandedPair& p, int seq) { return p.finderPattern().value() == seq; })) {
-			return true;
-		}
-	}
-	return false;
+	return MatchingSequences(pairs) != 0;
 }
 
-// Try to construct a valid rows sequence
-// Recursion is used to implement backtracking
-template <typename RowIterator>
-static std::list<ExpandedPair>
-CheckRows(RowIterator currentRow, RowIterator endRow, const std::list<ExpandedRow>& collectedRows)
+// Everything that decides whether the pairs collected by CheckRows can be completed by the rows starting at nextRow:
+// the number of pairs, the sequences they match, the check character and the checksum over the others so far.
+static uint64_t
+SearchState(const ExpandedPairs& pairs, int nextRow)
 {
-	std::list<ExpandedPair> collectedPairs;
-	for (const auto& collectedRow : collectedRows) {
-		auto &p = collectedRow.pairs();
-		collectedPairs.insert(collectedPairs.end(), p.begin(), p.end());
+	uint64_t res = (static_cast<uint64_t>(nextRow) << 4 | pairs.size()) << 10 | MatchingSequences(pairs);
+	if (pairs.empty() || pairs.front().mustBeLast())
+		return res << 45;
+
+	int checksum = pairs.front().rightChar().checksumPortion();
+	int s = 2;
+	for (auto it = pairs.begin() + 1; it != pairs.end(); ++it) {
+		checksum += it->leftChar().checksumPortion();
+		s++;
+		if (it->rightChar().isValid()) {
+			checksum += it->rightChar().checksumPortion();
+			s++;
+		}
 	}
+	return ((res << 8 | checksum % 211) << 5 | s) << 32 | static_cast<uint32_t>(pairs.front().leftChar().value());
+}
 
-	for (; currentRow != endRow; ++currentRow) {
-		//ExpandedRow row = rows.get(i);
-		std::list<ExpandedPair> result = collectedPairs;
-		auto &p = currentRow->pairs();
-		result.insert(result.end(), p.begin(), p.end());
+// Try to construct a valid rows sequence from the collected pairs and the rows starting at currentRow.
+// Recursion is used to implement backtracking. The states that lead nowhere are remembered in the sorted
+// deadEnds, so the search visits every SearchState at most once.
+static bool
+CheckRows(const std::vector<ExpandedRow>& rows, bool reverse, int currentRow, const ExpandedPairs& collectedPairs,
+		  std::vector<uint64_t>& deadEnds, ExpandedPairs& result)
+{
+	uint64_t state = SearchState(collectedPairs, currentRow);
+	auto deadEnd = std::lower_bound(deadEnds.begin(), deadEnds.end(), state);
+	if (deadEnd != deadEnds.end() && *deadEnd == state)
+		return false;
 
-		if (!IsValidSequence(result)) {
+	for (int i = currentRow; i < Size(rows); ++i) {
+		result = collectedPairs;
+		if (!result.append(rows[reverse ? Size(rows) - 1 - i : i].pairs()) || !IsValidSequence(result)) {
 			continue;
 		}
 
 		if (CheckChecksum(result)) {
-			return result;
+			return true;
 		}
 
-		std::list<ExpandedRow> rs = collectedRows;
-		rs.push_back(*currentRow);
-		auto nextRow = currentRow;
-		result = CheckRows(++nextRow, endRow, rs);
-		if (!result.empty()) {
-			return result;
+		ExpandedPairs pairs = result;
+		if (CheckRows(rows, reverse, i + 1, pairs, deadEnds, result)) {
+			return true;
 		}
 	}
-	return std::list<ExpandedPair>();
+
+	deadEnds.insert(std::lower_bound(deadEnds.begin(), deadEnds.end(), state), state);
+	return false;
 }
 
-static std::list<ExpandedPair>
-CheckRows(std::list<ExpandedRow>& rows, bool reverse) {
+static ExpandedPairs
+CheckRows(std::vector<ExpandedRow>& rows, bool reverse) {
 	// Limit number of rows we are checking
-	// We use recursive algorithm with pure complexity and don't want it to take forever
 	// Stacked barcode can have up to 11 rows, so 25 seems reasonable enough
 	if (rows.size() > 25) {
 		rows.clear();  // We will never have a chance to get result, so clear it
-		return std::list<ExpandedPair>();
+		return {};
 	}
 
-	return reverse ?
-		CheckRows(rows.rbegin(), rows.rend(), std::list<ExpandedRow>()) :
-		CheckRows(rows.begin(), rows.end(), std::list<ExpandedRow>());
+	std::vector<uint64_t> deadEnds;
+	ExpandedPairs result;
+	if (!CheckRows(rows, reverse, 0, ExpandedPairs(), deadEnds, result))
+		result.clear();
+	return result;
 }
 
-// Not private for testing
-static std::list<ExpandedPair>
-DecodeRow2Pairs(int rowNumber, const BitArray& row, bool startFromEven, std::list<ExpandedRow>& rows)
+static ExpandedPairs
+ReadPairs(int rowNumber, const BitArray& row, bool startFromEven)
 {
-	std::list<ExpandedPair> pairs;
+	ExpandedPairs pairs;
 	ExpandedPair nextPair;
-	while (RetrieveNextPair(row, pairs, rowNumber, startFromEven, nextPair)) {
+	while (!pairs.full() && RetrieveNextPair(row, pairs, rowNumber, startFromEven, nextPair)) {
 		pairs.push_back(nextPair);
 	}
+	return pairs;
+}
+
+static ExpandedPairs
+ReadPairs(int rowNumber, const PatternView& row, bool startFromEven)
+{
+	ExpandedPairs pairs;
+	ExpandedPair nextPair;
+	PatternView next = row;
+	while (!pairs.full() && RetrieveNextPair(next, pairs, rowNumber, startFromEven, nextPair)) {
+		pairs.push_back(nextPair);
+	}
+	return pairs;
+}
+
+// Not private for testing
+template <typename Row>
+static ExpandedPairs
+DecodeRow2Pairs(int rowNumber, const Row& row, bool startFromEven, std::vector<ExpandedRow>& rows)
+{
+	ExpandedPairs pairs = ReadPairs(rowNumber, row, startFromEven);
 
 	if (pairs.empty()) {
 		return pairs;
@@ -642,7 +756,7 @@ DecodeRow2Pairs(int rowNumber, const BitArray& row, bool startFromEven, std::lis
 			return ps;
 		}
 	}
-	return std::list<ExpandedPair>();
+	return {};
 }
 
 /**
@@ -650,7 +764,7 @@ DecodeRow2Pairs(int rowNumber, const BitArray& row, bool startFromEven, std::lis
 * @author Eduardo Castillejo, University of Deusto (eduardo.castillejo@deusto.es)
 */
 static BitArray
-BuildBitArray(const std::list<ExpandedPair>& pairs)
+BuildBitArray(const ExpandedPairs& pairs)
 {
 	int charNumber = (Size(pairs) * 2) - 1;
 	if (pairs.back().mustBeLast()) {
@@ -692,7 +806,7 @@ BuildBitArray(const std::list<ExpandedPair>& pairs)
 
 // Not private for unit testing
 static Result
-ConstructResult(const std::list<ExpandedPair>& pairs)
+ConstructResult(const ExpandedPairs& pairs)
 {
 	if (pairs.empty()) {
 		return Result(DecodeStatus::NotFound);
@@ -710,8 +824,9 @@ ConstructResult(const std::list<ExpandedPair>& pairs)
 	return Result(TextDecoder::FromLatin1(resultString), { firstPoints[0], firstPoints[1], lastPoints[0], lastPoints[1] }, BarcodeFormat::RSS_EXPANDED);
 }
 
-Result
-RSSExpandedReader::decodeRow(int rowNumber, const BitArray& row, std::unique_ptr<DecodingState>& state) const
+template <typename Row>
+static Result
+DecodeRow(int rowNumber, const Row& row, std::unique_ptr<RowReader::DecodingState>& state)
 {
 	if (!state) {
 		state.reset(new RSSExpandedDecodingState);
@@ -727,5 +842,23 @@ RSSExpandedReader::decodeRow(int rowNumber, const BitArray& row, std::unique_ptr
 	return r;
 }
 
+Result
+RSSExpandedReader::decodeRow(int rowNumber, const BitArray& row, std::unique_ptr<DecodingState>& state) const
+{
+	return DecodeRow(rowNumber, row, state);
+}
+
+int RSSExpandedReader::minPatternSize() const
+{
+	// left data character and finder pattern of one pair
+	return 8 + 4;
+}
+
+Result
+RSSExpandedReader::decodePattern(int rowNumber, const PatternView& row, std::unique_ptr<DecodingState>& state) const
+{
+	return DecodeRow(rowNumber, row, state);
+}
+
 } // OneD
 } // ZXing
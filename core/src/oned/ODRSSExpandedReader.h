@@ -29,6 +29,9 @@ class RSSExpandedReader : public RowReader
 {
 public:
 	Result decodeRow(int rowNumber, const BitArray& row, std::unique_ptr<DecodingState>& state) const override;
+	Result decodePattern(int rowNumber, const PatternView& row, std::unique_ptr<DecodingState>& state) const override;
+	int minPatternSize() const override;
+	bool isStateful() const override { return true; }
 };
 
 } // OneD
@@ -16,70 +16,137 @@
 */
 
 #include "ODReader.h"
+#ifndef ZX_NO_FORMAT_UPCEAN
 #include "ODMultiUPCEANReader.h"
+#endif
+#ifndef ZX_NO_FORMAT_CODE39
 #include "ODCode39Reader.h"
+#endif
+#ifndef ZX_NO_FORMAT_CODE93
 #include "ODCode93Reader.h"
+#endif
+#ifndef ZX_NO_FORMAT_CODE128
 #include "ODCode128Reader.h"
+#endif
+#ifndef ZX_NO_FORMAT_ITF
 #include "ODITFReader.h"
+#endif
+#ifndef ZX_NO_FORMAT_CODABAR
 #include "ODCodabarReader.h"
+#endif
+#ifndef ZX_NO_FORMAT_RSS
 #include "ODRSS14Reader.h"
 #include "ODRSSExpandedReader.h"
+#endif
 #include "Result.h"
 #include "BitArray.h"
 #include "BinaryBitmap.h"
+#include "BitMatrix.h"
+#include "Deadline.h"
 #include "DecodeHints.h"
+#include "DecodeStats.h"
+#include "EdgeOrientation.h"
+#include "MemoryResource.h"
+#include "Parallel.h"
+#include "Trace.h"
+#include "ZXContainerAlgorithms.h"
 
 #include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <numeric>
+#include <tuple>
 #include <utility>
 
 namespace ZXing {
 namespace OneD {
 
-Reader::Reader(const DecodeHints& hints) :
-	_tryHarder(hints.tryHarder()),
-	_tryRotate(hints.tryRotate())
+static std::vector<std::unique_ptr<RowReader>> CreateReaders(const DecodeHints& hints)
 {
-	_readers.reserve(8);
+	std::vector<std::unique_ptr<RowReader>> readers;
+	readers.reserve(8);
 
 	if (hints.hasNoFormat()) {
-		_readers.emplace_back(new MultiUPCEANReader(hints));
-		_readers.emplace_back(new Code39Reader(hints));
-		_readers.emplace_back(new CodabarReader(hints));
-		_readers.emplace_back(new Code93Reader());
-		_readers.emplace_back(new Code128Reader(hints));
-		_readers.emplace_back(new ITFReader(hints));
-		_readers.emplace_back(new RSS14Reader());
-		_readers.emplace_back(new RSSExpandedReader());
+#ifndef ZX_NO_FORMAT_UPCEAN
+		readers.emplace_back(new MultiUPCEANReader(hints));
+#endif
+#ifndef ZX_NO_FORMAT_CODE39
+		readers.emplace_back(new Code39Reader(hints));
+#endif
+#ifndef ZX_NO_FORMAT_CODABAR
+		readers.emplace_back(new CodabarReader(hints));
+#endif
+#ifndef ZX_NO_FORMAT_CODE93
+		readers.emplace_back(new Code93Reader());
+#endif
+#ifndef ZX_NO_FORMAT_CODE128
+		readers.emplace_back(new Code128Reader(hints));
+#endif
+#ifndef ZX_NO_FORMAT_ITF
+		readers.emplace_back(new ITFReader(hints));
+#endif
+#ifndef ZX_NO_FORMAT_RSS
+		readers.emplace_back(new RSS14Reader());
+		readers.emplace_back(new RSSExpandedReader());
+#endif
 	}
 	else {
+#ifndef ZX_NO_FORMAT_UPCEAN
 		if (hints.hasFormat(BarcodeFormat::EAN_13) ||
 			hints.hasFormat(BarcodeFormat::UPC_A) ||
 			hints.hasFormat(BarcodeFormat::EAN_8) ||
 			hints.hasFormat(BarcodeFormat::UPC_E)) {
-			_readers.emplace_back(new MultiUPCEANReader(hints));
+			readers.emplace_back(new MultiUPCEANReader(hints));
 		}
+#endif
+#ifndef ZX_NO_FORMAT_CODE39
 		if (hints.hasFormat(BarcodeFormat::CODE_39)) {
-			_readers.emplace_back(new Code39Reader(hints));
+			readers.emplace_back(new Code39Reader(hints));
 		}
+#endif
+#ifndef ZX_NO_FORMAT_CODE93
 		if (hints.hasFormat(BarcodeFormat::CODE_93)) {
-			_readers.emplace_back(new Code93Reader());
+			readers.emplace_back(new Code93Reader());
 		}
+#endif
+#ifndef ZX_NO_FORMAT_CODE128
 		if (hints.hasFormat(BarcodeFormat::CODE_128)) {
-			_readers.emplace_back(new Code128Reader(hints));
+			readers.emplace_back(new Code128Reader(hints));
 		}
+#endif
+#ifndef ZX_NO_FORMAT_ITF
 		if (hints.hasFormat(BarcodeFormat::ITF)) {
-			_readers.emplace_back(new ITFReader(hints));
+			readers.emplace_back(new ITFReader(hints));
 		}
+#endif
+#ifndef ZX_NO_FORMAT_CODABAR
 		if (hints.hasFormat(BarcodeFormat::CODABAR)) {
-			_readers.emplace_back(new CodabarReader(hints));
+			readers.emplace_back(new CodabarReader(hints));
 		}
+#endif
+#ifndef ZX_NO_FORMAT_RSS
 		if (hints.hasFormat(BarcodeFormat::RSS_14)) {
-			_readers.emplace_back(new RSS14Reader());
+			readers.emplace_back(new RSS14Reader());
 		}
 		if (hints.hasFormat(BarcodeFormat::RSS_EXPANDED)) {
-			_readers.emplace_back(new RSSExpandedReader());
+			readers.emplace_back(new RSSExpandedReader());
 		}
+#endif
 	}
+	return readers;
+}
+
+Reader::Reader(const DecodeHints& hints) :
+	_readers(CreateReaders(hints)),
+	_tryHarder(hints.tryHarder()),
+	_tryRotate(hints.tryRotate()),
+	_adaptiveRowOrder(hints.adaptiveRowOrder()),
+	_tryOmnidirectional(hints.tryOmnidirectional()),
+	_minLineCount(hints.minLineCount()),
+	_scanStride(hints.scanStride()),
+	_rowScanThreads(hints.rowScanThreads())
+{
 }
 
 Reader::~Reader() = default;
@@ -98,45 +165,151 @@ Reader::~Reader() = default;
 * @return The contents of the decoded barcode
 * @throws NotFoundException Any spontaneous errors which occur
 */
-static Result
-DoDecode(const std::vector<std::unique_ptr<RowReader>>& readers, const BinaryBitmap& image, bool tryHarder)
+static bool HasSameContent(const Results& results, const Result& r)
 {
-	std::vector<std::unique_ptr<RowReader::DecodingState>> decodingState(readers.size());
+	return std::any_of(results.begin(), results.end(),
+					   [&r](const Result& o) { return o.format() == r.format() && o.text() == r.text(); });
+}
 
-	int width = image.width();
-	int height = image.height();
+#ifdef ZX_USE_NEW_ROW_READERS
+/**
+* Returns the number of elements in the largest cluster of bars in the row. Clusters are separated by spaces that
+* are more than 8 times as wide as the 4 elements before them and more than 8 times as wide as the 4 elements after
+* them. No symbol contains such a space (relative to its neighbours, the widest one is the 9 module element of an RSS
+* finder pattern), so every symbol is completely contained in one cluster and the result is an upper bound for the
+* size of any symbol in the row, independent of the scan direction.
+*/
+static int MaxClusterSize(const PatternRow& bars)
+{
+	constexpr int QZ_SCALE = 8;
+	constexpr int N = 4;
 
-	int middle = height >> 1;
-	int rowStep = std::max(1, height >> (tryHarder ? 8 : 5));
-	int maxLines = tryHarder ?
-		height :	// Look at the whole image, not just the center
-		15;			// 15 rows spaced 1/32 apart is roughly the middle half of the image
+	int size = Size(bars);
+	int res = 0;
+	int start = 1;
+	for (int i = 2; i < size - 1; i += 2) {
+		int sumBefore = std::accumulate(bars.begin() + std::max(0, i - N), bars.begin() + i, 0);
+		int sumAfter = std::accumulate(bars.begin() + i + 1, bars.begin() + std::min(size, i + 1 + N), 0);
+		if (bars[i] > QZ_SCALE * std::max(sumBefore, sumAfter)) {
+			res = std::max(res, i - start);
+			start = i + 1;
+		}
+	}
+	return std::max(res, size - 1 - start);
+}
+#endif
 
-	BitArray row(width);
+/**
+* Decodes single rows of an image with all readers in both directions. The DecodingState of the stateful readers can
+* be shared between the RowDecoders of several threads (see DoDecodeParallel), access to it is then serialized with
+* one mutex per reader. All other state is owned by the RowDecoder.
+*/
+class RowDecoder
+{
+public:
+	struct SharedState
+	{
+		std::vector<std::unique_ptr<RowReader::DecodingState>> states;
+		std::unique_ptr<std::mutex[]> mutexes;
+
+		explicit SharedState(size_t numReaders) : states(numReaders), mutexes(new std::mutex[numReaders]) {}
+	};
+
+	RowDecoder(const std::vector<std::unique_ptr<RowReader>>& readers, const BinaryBitmap& image,
+			   SharedState* sharedState = nullptr)
+		: RowDecoder(readers, sharedState)
+	{
+		_image = &image;
+		_row = BitArray(image.width());
+	}
+
+	/// Without an image, every decode call passes its own (e.g. the rows of a stream, see StreamDecoder)
+	explicit RowDecoder(const std::vector<std::unique_ptr<RowReader>>& readers, SharedState* sharedState = nullptr)
+		: _readers(readers), _sharedState(sharedState), _states(readers.size())
+	{
 #ifdef ZX_USE_NEW_ROW_READERS
-	PatternRow bars;
-	bars.reserve(128); // e.g. EAN-13 has 96 bars
+		_bars.reserve(128); // e.g. EAN-13 has 96 bars
+		_minPatternSizes.reserve(readers.size());
+		for (auto& reader : readers)
+			_minPatternSizes.push_back(reader->minPatternSize());
+		_minPatternSize = readers.empty() ? 0 : *std::min_element(_minPatternSizes.begin(), _minPatternSizes.end());
 #endif
-	for (int x = 0; x < maxLines; x++) {
+	}
 
-		// Scanning from the middle out. Determine which row we're looking at next:
-		int rowStepsAboveOrBelow = (x + 1) / 2;
-		bool isAbove = (x & 0x01) == 0; // i.e. is x even?
-		int rowNumber = middle + rowStep * (isAbove ? rowStepsAboveOrBelow : -rowStepsAboveOrBelow);
-		if (rowNumber < 0 || rowNumber >= height) {
-			// Oops, if we run off the top or bottom, stop
-			break;
-		}
+	/// Let every (stateless) reader look for more symbols behind each one it found in a row, not just the first one
+	void setMultiplePerRow(bool on) { _multiplePerRow = on; }
+
+	/**
+	* Calls onResult(result, order) for every valid result found in the row, where order is the position of the
+	* reader/direction combination in which it was found (both cover all results of a row in that order). Stops as
+	* soon as onResult returns false and returns false in that case.
+	*/
+	template <typename OnResult>
+	bool decode(int rowNumber, OnResult onResult)
+	{
+		return decode(*_image, rowNumber, rowNumber, onResult);
+	}
 
+	/// Decodes row y of image, the readers see it as row rowNumber
+	template <typename OnResult>
+	bool decode(const BinaryBitmap& image, int y, int rowNumber, OnResult onResult)
+	{
+		if (_row.size() != image.width())
+			_row = BitArray(image.width());
 #ifdef ZX_USE_NEW_ROW_READERS
-		image.getPatternRow(rowNumber, bars);
-		bool hasBitArray = false;
+		if (!image.getSubPixelPatternRow(y, _bars, _widths))
+			return true;
 #else
 		// Estimate black point for this row and load it:
-		if (!image.getBlackRow(rowNumber, row)) {
-			continue;
+		if (!image.getBlackRow(y, _row)) {
+			return true;
 		}
 #endif
+		return decodeRow(image.width(), rowNumber, onResult);
+	}
+
+#ifdef ZX_USE_NEW_ROW_READERS
+	/**
+	* Decodes the straight line from p0 to p1 of matrix (see GetPatternLine), the readers see it as row rowNumber.
+	* The positions of the results are in samples along the line, x = 0 being p0.
+	*/
+	template <typename OnResult>
+	bool decode(const BitMatrix& matrix, PointI p0, PointI p1, int rowNumber, OnResult onResult)
+	{
+		int length = GetPatternLine(matrix, p0, p1, _bars);
+		_widths.clear();
+		if (_row.size() != length)
+			_row = BitArray(length);
+		return decodeRow(length, rowNumber, onResult);
+	}
+#endif
+
+private:
+	const std::vector<std::unique_ptr<RowReader>>& _readers;
+	const BinaryBitmap* _image = nullptr;
+	SharedState* _sharedState;
+	std::vector<std::unique_ptr<RowReader::DecodingState>> _states;
+	BitArray _row;
+	bool _multiplePerRow = false;
+#ifdef ZX_USE_NEW_ROW_READERS
+	PatternRow _bars;
+	SubPixelPatternRow _widths;
+	std::vector<int> _minPatternSizes;
+	int _minPatternSize = 0;
+	bool _hasBitArray = false;
+#endif
+
+	/// Passes the current row (_bars or _row) of the given width to the readers, see decode()
+	template <typename OnResult>
+	bool decodeRow(int width, int rowNumber, OnResult onResult)
+	{
+#ifdef ZX_USE_NEW_ROW_READERS
+		// Only pass the row to the readers that could find a symbol in it (in either direction)
+		int maxClusterSize = MaxClusterSize(_bars);
+		if (maxClusterSize < _minPatternSize)
+			return true;
+		_hasBitArray = false;
+#endif
 
 		// While we have the image data in a BitArray, it's fairly cheap to reverse it in place to
 		// handle decoding upside down barcodes.
@@ -149,35 +322,23 @@ DoDecode(const std::vector<std::unique_ptr<RowReader>>& readers, const BinaryBit
 			// trying again?
 			if (upsideDown) {
 				// reverse the row and continue
-				row.reverse();
+				_row.reverse();
 #ifdef ZX_USE_NEW_ROW_READERS
-				std::reverse(bars.begin(), bars.end());
+				std::reverse(_bars.begin(), _bars.end());
+				std::reverse(_widths.begin(), _widths.end());
 #endif
 			}
 			// Look for a barcode
-			for (size_t r = 0; r < readers.size(); ++r) {
-#ifdef ZX_USE_NEW_ROW_READERS
-				Result result = readers[r]->decodePattern(rowNumber, bars, decodingState[r]);
-				if (result.status() == DecodeStatus::_internal) {
-					if (!std::exchange(hasBitArray, true)) {
-						row.clearBits();
-						bool set = false;
-						int pos = 0;
-						for(int w : bars) {
-							if (set)
-								for (int i = 0; i < w; ++i)
-									row.set(pos++);
-							else
-								pos += w;
-							set = !set;
-						}
-					}
-					result = readers[r]->decodeRow(rowNumber, row, decodingState[r]);
-				}
-#else
-				Result result = readers[r]->decodeRow(rowNumber, row, decodingState[r]);
+			for (size_t r = 0; r < _readers.size(); ++r) {
+#ifdef ZX_USE_NEW_ROW_READERS
+				if (maxClusterSize < _minPatternSizes[r])
+					continue;
+#endif
+				Result result = decodeWith(r, rowNumber);
+				while (result.isValid()) {
+#ifdef ZX_USE_NEW_ROW_READERS
+					int xStop = std::max(result.position().topLeft().x, result.position().topRight().x);
 #endif
-				if (result.isValid()) {
 					// We found our barcode
 					if (upsideDown) {
 						// But it was upside down, so note that
@@ -189,26 +350,447 @@ DoDecode(const std::vector<std::unique_ptr<RowReader>>& readers, const BinaryBit
 						}
 						result.setPosition(std::move(points));
 					}
-					return result;
+					if (!onResult(std::move(result), upsideDown * Size(_readers) + static_cast<int>(r)))
+						return false;
+#ifdef ZX_USE_NEW_ROW_READERS
+					// keep looking for more symbols behind the one just found (the state of a stateful reader
+					// refers to the whole row)
+					int begin = firstBarBehind(xStop);
+					if (!_multiplePerRow || _readers[r]->isStateful() || Size(_bars) - begin < _minPatternSizes[r])
+						break;
+					result = decodeWith(r, rowNumber, begin);
+#else
+					break;
+#endif
 				}
 			}
 		}
+		return true;
+	}
+
+#ifdef ZX_USE_NEW_ROW_READERS
+	/// Returns the index of the first bar in _bars that starts behind pixel x
+	int firstBarBehind(int x) const
+	{
+		int i = 0;
+		for (int pos = 0; i < Size(_bars) && pos <= x; ++i)
+			pos += _bars[i];
+		return i | 1;
+	}
+#endif
+
+	/// Decodes the current row with reader r, only looking for symbols that start at bar index begin or later
+	Result decodeWith(size_t r, int rowNumber, int begin = 1)
+	{
+		if (_sharedState && _readers[r]->isStateful()) {
+			std::lock_guard<std::mutex> lock(_sharedState->mutexes[r]);
+			return decodeWith(r, rowNumber, begin, _sharedState->states[r]);
+		}
+		return decodeWith(r, rowNumber, begin, _states[r]);
 	}
-	return Result(DecodeStatus::NotFound);
+
+	Result decodeWith(size_t r, int rowNumber, int begin, std::unique_ptr<RowReader::DecodingState>& state)
+	{
+#ifdef ZX_USE_NEW_ROW_READERS
+		Result result = _readers[r]->decodePattern(rowNumber, PatternView(_bars, _widths).subView(begin - 1), state);
+		// the BitArray based readers can only search the whole row
+		if (result.status() == DecodeStatus::_internal && begin > 1)
+			return Result(DecodeStatus::NotFound);
+		if (result.status() == DecodeStatus::_internal) {
+			if (!std::exchange(_hasBitArray, true)) {
+				_row.clearBits();
+				bool set = false;
+				int pos = 0;
+				for(int w : _bars) {
+					if (set)
+						for (int i = 0; i < w; ++i)
+							_row.set(pos++);
+					else
+						pos += w;
+					set = !set;
+				}
+			}
+			result = _readers[r]->decodeRow(rowNumber, _row, state);
+		}
+		return result;
+#else
+		(void)begin;
+		return _readers[r]->decodeRow(rowNumber, _row, state);
+#endif
+	}
+};
+
+/**
+* Returns the numbers of the rows to scan in the order they are scanned (see above). With a scanStride (see
+* DecodeHints::scanStride), only every scanStride-th of these rows is scanned, covering the same part of the image.
+*/
+static std::vector<int> RowNumbers(int height, bool tryHarder, int scanStride)
+{
+	scanStride = std::max(1, scanStride);
+	int middle = height >> 1;
+	int rowStep = std::max(1, height >> (tryHarder ? 8 : 5)) * scanStride;
+	int maxLines = tryHarder ?
+		height :	// Look at the whole image, not just the center
+		(15 + scanStride - 1) / scanStride; // 15 rows spaced 1/32 apart is roughly the middle half of the image
+
+	std::vector<int> res;
+	res.reserve(std::min(maxLines, height));
+	for (int x = 0; x < maxLines; x++) {
+
+		// Scanning from the middle out. Determine which row we're looking at next:
+		int rowStepsAboveOrBelow = (x + 1) / 2;
+		bool isAbove = (x & 0x01) == 0; // i.e. is x even?
+		int rowNumber = middle + rowStep * (isAbove ? rowStepsAboveOrBelow : -rowStepsAboveOrBelow);
+		if (rowNumber < 0 || rowNumber >= height) {
+			// Oops, if we run off the top or bottom, stop
+			break;
+		}
+		res.push_back(rowNumber);
+	}
+	return res;
 }
 
-Result
-Reader::decode(const BinaryBitmap& image) const
+#ifdef ZX_USE_NEW_ROW_READERS
+/**
+* Returns the numbers of the rows to scan with DecodeHints::adaptiveRowOrder. The image is split into horizontal
+* bands, each one rated by the MaxClusterSize of its center row. The bands that could contain a symbol (see
+* minPatternSize) are scanned first, the ones with more bars before those with fewer and the ones closer to the middle
+* before the others. First only their center rows, then more densely, from the center outward. The usual rows of
+* RowNumbers() follow, so with tryHarder nothing is skipped and without it, the scan is still limited to 15 rows.
+*/
+static std::vector<int> BarRegionRowNumbers(const BinaryBitmap& image, bool tryHarder, int scanStride,
+											int minPatternSize)
 {
-	Result result = DoDecode(_readers, image, _tryHarder);
-	if (result.isValid()) {
-		return result;
+	constexpr int MAX_BANDS = 32;
+
+	struct Band
+	{
+		int center, halfHeight, barCount;
+	};
+
+	int height = image.height();
+	int numBands = std::min(MAX_BANDS, height);
+	std::vector<Band> bands;
+	PatternRow bars;
+	for (int i = 0; i < numBands; ++i) {
+		int top = i * height / numBands;
+		int bottom = (i + 1) * height / numBands;
+		int center = (top + bottom) / 2;
+		if (!image.getPatternRow(center, bars))
+			continue;
+		int barCount = MaxClusterSize(bars);
+		if (barCount >= minPatternSize)
+			bands.push_back({center, (bottom - top) / 2, barCount});
 	}
 
-	if (_tryRotate && image.canRotate()) {
+	int middle = height >> 1;
+	std::stable_sort(bands.begin(), bands.end(), [middle](const Band& a, const Band& b) {
+		return a.barCount != b.barCount ? a.barCount > b.barCount
+										: std::abs(a.center - middle) < std::abs(b.center - middle);
+	});
+
+	auto rowNumbers = RowNumbers(height, tryHarder, scanStride);
+	int maxLines = Size(rowNumbers);
+	std::vector<int> res;
+	res.reserve(maxLines);
+	std::vector<bool> scheduled(height, false);
+	auto add = [&](int y) {
+		if (y >= 0 && y < height && !scheduled[y] && Size(res) < maxLines) {
+			scheduled[y] = true;
+			res.push_back(y);
+		}
+	};
+
+	for (auto& band : bands)
+		add(band.center);
+	// the bands are scanned 4 times (2 times with tryHarder) as densely as the image in RowNumbers()
+	int rowStep = std::max(1, height >> (tryHarder ? 9 : 7)) * std::max(1, scanStride);
+	for (auto& band : bands)
+		for (int offset = rowStep; offset <= band.halfHeight; offset += rowStep) {
+			add(band.center - offset);
+			add(band.center + offset);
+		}
+	for (int y : rowNumbers)
+		add(y);
+
+	return res;
+}
+#endif
+
+/**
+* Returns true if the horizontal pixel ranges covered by a and b overlap.
+*/
+static bool OverlapHorizontally(const Result& a, const Result& b)
+{
+	auto range = [](const Result& r) {
+		auto xs = {r.position()[0].x, r.position()[1].x, r.position()[2].x, r.position()[3].x};
+		return std::minmax(xs);
+	};
+	auto ra = range(a), rb = range(b);
+	return ra.first <= rb.second && rb.first <= ra.second;
+}
+
+/**
+* Collects the results of the scanned rows in scan order. The same symbol is usually found in many rows, it is only
+* reported once, after it was found in minLineCount rows (in either direction). Its lineCount() is the number of
+* rows that agreed on it until the scan stopped, results found in fewer rows (e.g. misreads) are dropped. Results
+* with the same content are only taken for the same symbol if they overlap horizontally, so e.g. several identical
+* labels next to each other are all reported.
+*/
+class ResultCollector
+{
+	int _minLineCount;
+	int _maxSymbols;
+	Results _candidates;        // all distinct symbols found so far
+	std::vector<int> _accepted; // indices of the candidates found in at least minLineCount rows, in that order
+
+public:
+	ResultCollector(int minLineCount, int maxSymbols) : _minLineCount(std::max(1, minLineCount)), _maxSymbols(maxSymbols)
+	{}
+
+	/// Returns false once maxSymbols symbols are accepted, i.e. when the scan can stop. Only the result that starts
+	/// a new candidate is kept, the others just count as votes for an existing one.
+	bool add(Result&& result)
+	{
+		auto i = FindIf(_candidates, [&result](const Result& c) {
+			return c.format() == result.format() && c.text() == result.text() && OverlapHorizontally(c, result);
+		});
+		if (i == _candidates.end())
+			i = _candidates.insert(i, std::move(result));
+		i->incrementLineCount();
+		if (i->lineCount() == _minLineCount)
+			_accepted.push_back(static_cast<int>(i - _candidates.begin()));
+		return Size(_accepted) < _maxSymbols;
+	}
+
+	/// Moves the accepted candidates out, the collector is empty afterwards
+	Results results()
+	{
+		Results res;
+		res.reserve(_accepted.size());
+		for (int i : _accepted)
+			res.push_back(std::move(_candidates[i]));
+		_candidates.clear();
+		_accepted.clear();
+		return res;
+	}
+};
+
+/**
+* Scans the rows with numThreads workers. Every worker takes every numThreads-th row of the scan order, so all of
+* them move outward from the middle together. The results are reported in scan order as well, i.e. the same row
+* wins as in the serial scan. Only the stateful readers (RSS) may see their rows in a different order and therefore
+* find a stacked symbol in a different row.
+*
+* The results of a row are buffered until all rows before it are done, then the rows are handed to the collector in
+* scan order, each result once. As soon as the collector has enough symbols, the workers stop behind that row.
+*/
+static Results DoDecodeParallel(const std::vector<std::unique_ptr<RowReader>>& readers, const BinaryBitmap& image,
+								const std::vector<int>& rowNumbers, int minLineCount, int maxSymbols, int numThreads)
+{
+	RowDecoder::SharedState sharedState(readers.size());
+	const Deadline* deadline = Deadline::Current();
+	DecodeStats* stats = DecodeStats::Current();
+	MemoryResource* memoryResource = MemoryResource::Current();
+
+	// guarded by the mutex: the results of the rows that are not yet collected, the rows done and the next row to
+	// collect, all indexed in scan order
+	std::mutex mutex;
+	std::vector<Results> rowResults(rowNumbers.size());
+	std::vector<bool> done(rowNumbers.size(), false);
+	int next = 0;
+	ResultCollector collector(minLineCount, maxSymbols);
+	std::atomic<int> lastIndex(Size(rowNumbers) - 1);
+
+	// collects the rows from next on up to the first one that is not done (or all with force), call with the lock held
+	auto collect = [&](bool force) {
+		for (; next <= lastIndex && (force || done[next]); ++next) {
+			for (auto& result : rowResults[next])
+				if (!collector.add(std::move(result))) {
+					lastIndex = next;
+					break;
+				}
+			Results().swap(rowResults[next]);
+		}
+	};
+
+	ParallelFor(numThreads, [&](int worker) {
+		// deadlines are installed per thread
+		std::unique_ptr<Deadline::Scope> scope(deadline ? new Deadline::Scope(*deadline) : nullptr);
+		DecodeStats::Scope statsScope(stats);
+		MemoryResource::Scope memoryScope(memoryResource);
+		RowDecoder decoder(readers, image, &sharedState);
+		decoder.setMultiplePerRow(maxSymbols > 1);
+		int rowsScanned = 0;
+		Results results;
+		for (int i = worker; i <= lastIndex && !Deadline::Expired(); i += numThreads, ++rowsScanned) {
+			decoder.decode(rowNumbers[i], [&](Result&& result, int) {
+				results.push_back(std::move(result));
+				return true;
+			});
+			std::lock_guard<std::mutex> lock(mutex);
+			rowResults[i].swap(results);
+			done[i] = true;
+			collect(false);
+		}
+		DecodeStats::AddRowsScanned(rowsScanned);
+	});
+
+	// after a timeout, rows that were not scanned count as empty
+	collect(true);
+	return collector.results();
+}
+
+static Results
+DoDecode(const std::vector<std::unique_ptr<RowReader>>& readers, const BinaryBitmap& image, bool tryHarder,
+		 int scanStride, bool adaptiveRowOrder, int minLineCount, int maxSymbols, int numThreads)
+{
+#ifdef ZX_USE_NEW_ROW_READERS
+	std::vector<int> rowNumbers;
+	if (adaptiveRowOrder && !readers.empty()) {
+		int minPatternSize = (*std::min_element(readers.begin(), readers.end(), [](auto& a, auto& b) {
+			return a->minPatternSize() < b->minPatternSize();
+		}))->minPatternSize();
+		rowNumbers = BarRegionRowNumbers(image, tryHarder, scanStride, minPatternSize);
+	}
+	else
+		rowNumbers = RowNumbers(image.height(), tryHarder, scanStride);
+#else
+	(void)adaptiveRowOrder;
+	auto rowNumbers = RowNumbers(image.height(), tryHarder, scanStride);
+#endif
+
+	if (tryHarder && numThreads > 1)
+		return DoDecodeParallel(readers, image, rowNumbers, minLineCount, maxSymbols,
+								std::min(numThreads, Size(rowNumbers)));
+
+	ResultCollector collector(minLineCount, maxSymbols);
+	RowDecoder decoder(readers, image);
+	decoder.setMultiplePerRow(maxSymbols > 1);
+
+	int rowsScanned = 0;
+	for (int rowNumber : rowNumbers) {
+		if (Deadline::Expired())
+			break;
+
+		++rowsScanned;
+		if (!decoder.decode(rowNumber, [&collector](Result&& result, int) { return collector.add(std::move(result)); }))
+			break;
+	}
+	DecodeStats::AddRowsScanned(rowsScanned);
+	return collector.results();
+}
+
+#ifdef ZX_USE_NEW_ROW_READERS
+/**
+* Scans the image along parallel lines at the angles in between the rows and the columns, in steps of 22.5 degrees
+* (see DecodeHints::tryOmnidirectional). For every angle, the lines are spaced like the rows in RowNumbers(), measured
+* perpendicular to them. Symbols already contained in found are skipped.
+*/
+static Results
+DoDecodeOmnidirectional(const std::vector<std::unique_ptr<RowReader>>& readers, const BinaryBitmap& image,
+						bool tryHarder, int scanStride, bool scanColumns, int minLineCount, int maxSymbols,
+						const Results& found)
+{
+	constexpr int NUM_ANGLES = 8;
+	constexpr double PI = 3.14159265358979323846;
+
+	auto matrix = image.getBitMatrix();
+	if (!matrix)
+		return {};
+
+	int width = image.width();
+	int height = image.height();
+	ResultCollector collector(minLineCount, maxSymbols);
+	int linesScanned = 0;
+	bool more = true;
+	// the angles crossing the most edges at a right angle first, the rows (angle 0) were scanned before
+	static_assert(EdgeOrientation::NUM_BINS == NUM_ANGLES, "one bin per angle");
+	for (int a : image.getEdgeOrientation().binsByCount()) {
+		if (!more)
+			break;
+		if (a == 0 || (a == NUM_ANGLES / 2 && !scanColumns))
+			continue;
+		int degrees = a * 180 / NUM_ANGLES;
+		double radians = a * PI / NUM_ANGLES;
+		PointF dir(std::cos(radians), std::sin(radians));
+		PointF normal(-dir.y, dir.x);
+
+		// the range of the distances of the image corners from the line through the origin
+		double minDist = std::min(0., normal.x * (width - 1)) + std::min(0., normal.y * (height - 1));
+		double maxDist = std::max(0., normal.x * (width - 1)) + std::max(0., normal.y * (height - 1));
+
+		// a new decoder for every angle, the stateful readers must not combine lines of different angles
+		RowDecoder decoder(readers);
+		decoder.setMultiplePerRow(maxSymbols > 1);
+		int lineNumber = 0;
+		for (int offset : RowNumbers(static_cast<int>(maxDist - minDist) + 1, tryHarder, scanStride)) {
+			if (!more || Deadline::Expired())
+				break;
+
+			// clip the line through origin in direction dir to the image
+			PointF origin = (minDist + offset) * normal;
+			double tMin = -1e9, tMax = 1e9;
+			auto clip = [&](double o, double d, int size) {
+				if (std::abs(d) < 1e-9)
+					return o >= 0 && o <= size - 1;
+				double t0 = -o / d, t1 = (size - 1 - o) / d;
+				tMin = std::max(tMin, std::min(t0, t1));
+				tMax = std::min(tMax, std::max(t0, t1));
+				return true;
+			};
+			if (!clip(origin.x, dir.x, width) || !clip(origin.y, dir.y, height) || tMax - tMin < 1)
+				continue;
+			auto inside = [&](PointI p) {
+				return PointI(std::min(std::max(p.x, 0), width - 1), std::min(std::max(p.y, 0), height - 1));
+			};
+			PointI p0 = inside(round(origin + tMin * dir));
+			PointI p1 = inside(round(origin + tMax * dir));
+			auto step = PointF(p1 - p0) / std::max(1, std::max(std::abs(p1.x - p0.x), std::abs(p1.y - p0.y)));
+
+			++linesScanned;
+			more = decoder.decode(*matrix, p0, p1, lineNumber++, [&](Result&& result, int) {
+				if (HasSameContent(found, result))
+					return true;
+				// map the samples along the line back to the image
+				auto points = result.position();
+				for (auto& p : points)
+					p = round(PointF(p0) + p.x * step);
+				result.setPosition(std::move(points));
+				auto& metadata = result.metadata();
+				metadata.put(ResultMetadata::ORIENTATION,
+							 (360 - degrees + metadata.getInt(ResultMetadata::ORIENTATION)) % 360);
+				return collector.add(std::move(result));
+			});
+		}
+	}
+	DecodeStats::AddRowsScanned(linesScanned);
+	return collector.results();
+}
+#endif
+
+Results
+Reader::decode(const BinaryBitmap& image, int maxSymbols) const
+{
+	ZX_TRACE_SCOPE("OneD::Reader::decode");
+	DecodeStats::ReaderTimer readerTimer(DecodeStats::ReaderType::OneD);
+	DecodeStats::StageTimer detectTimer(DecodeStats::Stage::Detect);
+	Results results;
+	auto decodeRows = [&]() {
+		auto rowResults = DoDecode(_readers, image, _tryHarder, _scanStride, _adaptiveRowOrder, _minLineCount,
+								   maxSymbols - Size(results), _rowScanThreads);
+		// identical symbols next to each other in the rows are all kept, only the ones of the rotated scan are skipped
+		if (results.empty())
+			results = std::move(rowResults);
+		else
+			for (auto& result : rowResults)
+				if (!HasSameContent(results, result))
+					results.push_back(std::move(result));
+	};
+	auto decodeColumns = [&]() {
 		auto rotatedImage = image.rotated(270);
-		result = DoDecode(_readers, *rotatedImage, _tryHarder);
-		if (result.isValid()) {
+		for (auto& result : DoDecode(_readers, *rotatedImage, _tryHarder, _scanStride, _adaptiveRowOrder, _minLineCount,
+									maxSymbols - Size(results), _rowScanThreads)) {
 			// Record that we found it rotated 90 degrees CCW / 270 degrees CW
 			auto& metadata = result.metadata();
 			metadata.put(ResultMetadata::ORIENTATION, (270 + metadata.getInt(ResultMetadata::ORIENTATION)) % 360);
@@ -219,9 +801,62 @@ Reader::decode(const BinaryBitmap& image) const
 				p = {height - p.y - 1, p.x};
 			}
 			result.setPosition(std::move(points));
+			if (!HasSameContent(results, result))
+				results.push_back(std::move(result));
 		}
+	};
+
+	// most rotated symbols are found in the first attempt if the direction of the edges decides which one comes first
+	bool tryRotate = _tryRotate && image.canRotate();
+	bool columnsFirst = tryRotate && image.getEdgeOrientation().prefersColumns();
+	if (columnsFirst)
+		decodeColumns();
+	if (Size(results) < maxSymbols && !(columnsFirst && Deadline::Expired()))
+		decodeRows();
+	if (!columnsFirst && tryRotate && Size(results) < maxSymbols && !Deadline::Expired())
+		decodeColumns();
+
+#ifdef ZX_USE_NEW_ROW_READERS
+	if (_tryOmnidirectional && Size(results) < maxSymbols && !Deadline::Expired()) {
+		for (auto& result :
+			 DoDecodeOmnidirectional(_readers, image, _tryHarder, _scanStride, !_tryRotate || !image.canRotate(),
+									 _minLineCount, maxSymbols - Size(results), results))
+			results.push_back(std::move(result));
 	}
-	return result;
+#endif
+	return results;
+}
+
+Result
+Reader::decode(const BinaryBitmap& image) const
+{
+	auto results = decode(image, 1);
+	return results.empty() ? Result(DecodeStatus::NotFound) : std::move(results.front());
+}
+
+StreamDecoder::StreamDecoder(const DecodeHints& hints)
+	: _readers(CreateReaders(hints)), _decoder(new RowDecoder(_readers))
+{
+}
+
+StreamDecoder::~StreamDecoder() = default;
+
+Results
+StreamDecoder::decode(const BinaryBitmap& image, int y, int rowNumber)
+{
+	Results results;
+	_decoder->decode(image, y, rowNumber, [&results](Result&& result, int) {
+		if (!HasSameContent(results, result))
+			results.push_back(std::move(result));
+		return true;
+	});
+	return results;
+}
+
+void
+StreamDecoder::resetState()
+{
+	_decoder.reset(new RowDecoder(_readers));
 }
 
 
@@ -26,6 +26,7 @@ class DecodeHints;
 
 namespace OneD {
 
+class RowDecoder;
 class RowReader;
 
 /**
@@ -39,11 +40,39 @@ public:
     ~Reader() override;
 
 	Result decode(const BinaryBitmap& image) const override;
+	Results decode(const BinaryBitmap& image, int maxSymbols) const override;
 
 private:
 	std::vector<std::unique_ptr<RowReader>> _readers;
 	bool _tryHarder;
 	bool _tryRotate;
+	bool _adaptiveRowOrder;
+	bool _tryOmnidirectional;
+	int _minLineCount;
+	int _scanStride;
+	int _rowScanThreads;
+};
+
+/**
+* Decodes the rows of a continuous stream one at a time (see LineScanReader). The DecodingState of the stateful readers
+* (RSS) is carried from one row to the next until resetState(), so stacked symbols are combined across rows like in a
+* complete image.
+*/
+class StreamDecoder
+{
+public:
+	explicit StreamDecoder(const DecodeHints& hints);
+	~StreamDecoder();
+
+	/// Returns the distinct symbols found in row y of image, their positions refer to row rowNumber of the stream
+	Results decode(const BinaryBitmap& image, int y, int rowNumber);
+
+	/// Forget the partial symbols the stateful readers collected so far
+	void resetState();
+
+private:
+	std::vector<std::unique_ptr<RowReader>> _readers;
+	std::unique_ptr<RowDecoder> _decoder;
 };
 
 } // OneD
@@ -22,11 +22,15 @@
 #include "Pattern.h"
 
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
 #include <iterator>
+#include <limits>
 #include <memory>
 #include <type_traits>
+#include <utility>
 
 /*
 Code39 : 1:2/3, 5+4+1 (0x3|2x1 wide) -> 12-15 mods, v1-? | ToNarrowWide(OMG 1) == *
@@ -50,6 +54,86 @@ class Result;
 
 namespace OneD {
 
+/**
+* Maps the module counts of the characters in a set of patterns to their index in that set. All patterns have (at
+* least) LEN elements and the first LEN of them add up to SUM modules. The key of a character is the bit pattern of
+* its modules, i.e. the bars are 1 bits and the spaces are 0 bits (see RowReader::OneToFourBitPattern).
+*/
+template <int LEN, int SUM, typename Patterns>
+class PatternTable
+{
+	static_assert(SUM <= 16, "table has 2^SUM entries");
+
+	const Patterns& _patterns;
+	std::array<int8_t, 1 << SUM> _index;
+
+public:
+	explicit PatternTable(const Patterns& patterns) : _patterns(patterns)
+	{
+		assert(patterns.size() < 128);
+		_index.fill(-1);
+		for (int i = 0; i < static_cast<int>(patterns.size()); ++i) {
+			int key = 0, sum = 0;
+			for (int j = 0; j < LEN; ++j) {
+				key = (key << patterns[i][j]) | ~(0xffffffff << patterns[i][j]) * (~j & 1);
+				sum += patterns[i][j];
+			}
+			assert(sum == SUM && _index[key] == -1);
+			_index[key] = static_cast<int8_t>(i);
+		}
+	}
+
+	const Patterns& patterns() const { return _patterns; }
+
+	/**
+	* Rounds the counters to whole modules and returns the index of the pattern with these module counts or -1 if
+	* there is none.
+	*/
+	template <typename Counters>
+	int lookup(const Counters& counters) const
+	{
+		int total = 0;
+		for (int i = 0; i < LEN; ++i)
+			total += counters[i];
+		if (total < SUM)
+			return -1;
+
+		int key = 0, sum = 0;
+		for (int i = 0; i < LEN; ++i) {
+			int modules = (2 * counters[i] * SUM + total) / (2 * total);
+			if (modules < 1 || (sum += modules) > SUM)
+				return -1;
+			key = (key << modules) | ~(0xffffffff << modules) * (~i & 1);
+		}
+		return sum == SUM ? _index[key] : -1;
+	}
+};
+
+/**
+* Maps the bit patterns of BITS narrow (0) and wide (1) elements (see RowReader::NarrowWideBitPattern) directly to the
+* characters they encode, instead of searching the list of encodings for every character.
+*/
+template <int BITS>
+class BitPatternTable
+{
+	static_assert(BITS <= 12, "table has 2^BITS entries");
+
+	std::array<char, 1 << BITS> _chars;
+
+public:
+	template <typename INDEX, typename ALPHABET>
+	BitPatternTable(const INDEX& encodings, const ALPHABET& alphabet)
+	{
+		_chars.fill(-1);
+		// backwards, so the first of several equal encodings wins like in LookupBitPattern
+		for (auto i = std::end(encodings) - std::begin(encodings) - 1; i >= 0; --i)
+			_chars[encodings[i]] = alphabet[i];
+	}
+
+	/// Returns the character encoded by pattern or -1 if there is none (or pattern is -1)
+	char operator[](int pattern) const { return pattern < 0 || pattern >= (1 << BITS) ? -1 : _chars[pattern]; }
+};
+
 /**
 * Encapsulates functionality and implementation that is common to all families
 * of one-dimensional barcodes.
@@ -86,6 +170,18 @@ public:
 
 	virtual Result decodePattern(int rowNumber, const PatternView& row, std::unique_ptr<DecodingState>& state) const;
 
+	/**
+	* Returns a lower bound for the number of bars and spaces of any symbol this reader can detect. Rows that do
+	* not contain a cluster of at least that many elements are not passed to decodePattern.
+	*/
+	virtual int minPatternSize() const { return 0; }
+
+	/**
+	* Returns true if the reader keeps DecodingState across rows (e.g. to combine the rows of stacked symbols). The
+	* rows of an image then all have to be passed with the same state object, and not concurrently.
+	*/
+	virtual bool isStateful() const { return false; }
+
 	/**
 	* Scans the given bit range for a pattern identified by evaluating the function object match for each
 	* successive run of counters.size() bars. If the pattern is found, it returns the bit range with the
@@ -228,6 +324,88 @@ public:
 		return bestMatch;
 	}
 
+	/**
+	* Same as DecodeDigit above but looks the counters up in the table first. If they deviate from the pattern found
+	* there by less than one module in total, every other pattern deviates by more than one module (two patterns with
+	* the same sum differ by at least two modules), so the variance search over all patterns is skipped.
+	*/
+	template <typename Counters, int LEN, int SUM, typename Patterns>
+	static int DecodeDigit(const Counters& counters, const PatternTable<LEN, SUM, Patterns>& table,
+						   float maxAvgVariance, float maxIndividualVariance, bool requireUnambiguousMatch = true)
+	{
+		assert(Size(counters) == LEN);
+		int index = table.lookup(counters);
+		if (index != -1) {
+			const auto& pattern = table.patterns()[index];
+			int total = 0, deviation = 0;
+			for (int i = 0; i < LEN; ++i)
+				total += counters[i];
+			for (int i = 0; i < LEN; ++i)
+				deviation += std::abs(counters[i] * SUM - pattern[i] * total);
+			if (deviation < total) {
+				float variance = PatternMatchVariance(counters, pattern, maxIndividualVariance);
+				// if the pattern failed the individual variance test, some other pattern still might pass it
+				if (variance != std::numeric_limits<float>::max())
+					return variance < maxAvgVariance ? index : -1;
+			}
+		}
+		return DecodeDigit(counters, table.patterns(), maxAvgVariance, maxIndividualVariance, requireUnambiguousMatch);
+	}
+
+	/**
+	* The pixel range of the symbol a reader found in the previous row, see DecodeNearPreviousSymbol.
+	*/
+	struct PreviousSymbol : public DecodingState
+	{
+		int xStart = -1;
+		int xStop = -1;
+	};
+
+	/**
+	* Calls decode(range), which looks for the start pattern of a symbol in range and decodes it. If a symbol was found
+	* in a previous row (as remembered in state), it first tries only the elements of range around the start of that
+	* symbol, since neighboring rows usually cross a symbol at about the same position. If that does not give a result,
+	* it calls decode with the whole range.
+	*/
+	template <typename Decode>
+	static auto DecodeNearPreviousSymbol(const PatternView& range, std::unique_ptr<DecodingState>& state, Decode decode)
+	{
+		if (!state)
+			state.reset(new PreviousSymbol);
+		auto& previous = static_cast<PreviousSymbol&>(*state);
+
+		auto remember = [&previous](auto&& result) {
+			if (result.isValid()) {
+				previous.xStart = static_cast<int>(result.position().topLeft().x);
+				previous.xStop = static_cast<int>(result.position().topRight().x);
+			}
+			return std::move(result);
+		};
+
+		if (previous.xStart >= 0) {
+			// the window starts with a bar like range and covers the previous start +/- margin
+			int margin = std::max(4, (previous.xStop - previous.xStart) / 16);
+			int x = range.pixelsInFront();
+			int begin = 0;
+			for (; begin + 2 < range.size(); begin += 2) {
+				int pair = range[begin] + range[begin + 1];
+				if (x + pair >= previous.xStart - margin)
+					break;
+				x += pair;
+			}
+			int end = begin;
+			for (; end < range.size() && x <= previous.xStart + margin; ++end)
+				x += range[end];
+			if (end > begin) {
+				auto result = decode(range.subView(begin, end - begin));
+				if (result.isValid())
+					return remember(std::move(result));
+			}
+		}
+
+		return remember(decode(range));
+	}
+
 	/**
 	 * @brief NarrowWideThreshold calculates width thresholds to separate narrow and wide bars and spaces.
 	 *
@@ -283,16 +461,23 @@ public:
 
 	/**
 	 * @brief each bar/space is 1-4 modules wide, we have N bars/spaces, they are SUM modules wide in total
+	 *
+	 * Uses the sub-pixel widths of the view if available. Returns -1 if the widths don't add up or if any of them
+	 * deviates from its module count by more than maxError modules.
 	 */
 	template <int LEN, int SUM>
-	static int OneToFourBitPattern(const PatternView& view)
+	static int OneToFourBitPattern(const PatternView& view, float maxError = SUM)
 	{
-		float moduleSize = static_cast<float>(view.sum(LEN)) / SUM;
+		float widths[LEN];
+		float sum = 0;
+		for (int i = 0; i < LEN; i++)
+			sum += widths[i] = view.subPixelWidth(i);
+		float moduleSize = sum / SUM;
 		int err = SUM;
 		int is[LEN];
 		float rs[LEN];
 		for (int i = 0; i < LEN; i++) {
-			float v = view[i] / moduleSize;
+			float v = widths[i] / moduleSize;
 			is[i] = int(v + .5f);
 			rs[i] = v - is[i];
 			err -= is[i];
@@ -308,6 +493,10 @@ public:
 			rs[mi] -= err;
 		}
 
+		for (int i = 0; i < LEN; i++)
+			if (is[i] < 1 || std::abs(rs[i]) > maxError)
+				return -1;
+
 		int pattern = 0;
 		for (size_t i = 0; i < LEN; i++)
 			pattern = (pattern << is[i]) | ~(0xffffffff << is[i]) * (~i & 1);
@@ -327,6 +516,12 @@ public:
 	{
 		return LookupBitPattern(NarrowWideBitPattern(view), table, alphabet);
 	}
+
+	template <int BITS>
+	static char DecodeNarrowWidePattern(const PatternView& view, const BitPatternTable<BITS>& table)
+	{
+		return table[NarrowWideBitPattern(view)];
+	}
 };
 
 } // OneD
@@ -43,9 +43,23 @@ UPCAReader::decodeRow(int rowNumber, const BitArray& row, std::unique_ptr<Decodi
 }
 
 Result
-UPCAReader::decodeRow(int rowNumber, const BitArray& row, BitArray::Range startGuard) const
+UPCAReader::decodeRow(int rowNumber, const BitArray& row, BitArray::Range startGuard,
+					  std::unique_ptr<DecodingState>& state) const
 {
-	return MaybeReturnResult(_reader.decodeRow(rowNumber, row, startGuard));
+	return MaybeReturnResult(_reader.decodeRow(rowNumber, row, startGuard, state));
+}
+
+Result
+UPCAReader::decodePattern(int rowNumber, const PatternView& row, std::unique_ptr<DecodingState>& state) const
+{
+	return MaybeReturnResult(_reader.decodePattern(rowNumber, row, state));
+}
+
+Result
+UPCAReader::decodeAtStartGuard(int rowNumber, const PatternView& startGuard,
+							   std::unique_ptr<DecodingState>& state) const
+{
+	return MaybeReturnResult(_reader.decodeAtStartGuard(rowNumber, startGuard, state));
 }
 
 BarcodeFormat
@@ -60,5 +74,11 @@ UPCAReader::decodeMiddle(const BitArray& row, BitArray::Iterator begin, std::str
 	return _reader.decodeMiddle(row, begin, resultString);
 }
 
+bool
+UPCAReader::decodeMiddle(PatternView& next, std::string& resultString) const
+{
+	return _reader.decodeMiddle(next, resultString);
+}
+
 } // OneD
 } // ZXing
@@ -33,11 +33,16 @@ public:
 	explicit UPCAReader(const DecodeHints& hints) : UPCEANReader(hints), _reader(hints) {}
 
 	Result decodeRow(int rowNumber, const BitArray& row, std::unique_ptr<DecodingState>& state) const override;
-	Result decodeRow(int rowNumber, const BitArray& row, BitArray::Range startGuard) const override;
+	Result decodeRow(int rowNumber, const BitArray& row, BitArray::Range startGuard,
+					 std::unique_ptr<DecodingState>& state) const override;
+	Result decodePattern(int rowNumber, const PatternView& row, std::unique_ptr<DecodingState>& state) const override;
+	Result decodeAtStartGuard(int rowNumber, const PatternView& startGuard,
+							  std::unique_ptr<DecodingState>& state) const override;
 
 protected:
 	BarcodeFormat expectedFormat() const override;
 	BitArray::Range decodeMiddle(const BitArray& row, BitArray::Iterator begin, std::string& resultString) const override;
+	bool decodeMiddle(PatternView& next, std::string& resultString) const override;
 
 private:
 	EAN13Reader _reader;
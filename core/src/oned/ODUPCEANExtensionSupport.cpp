@@ -94,8 +94,9 @@ namespace UPCEANExtension5Support
 } // UPCEANExtension5Support
 
 
+template <typename Cursor>
 static std::string
-DecodeMiddle(BitArray::Range* next_, int N)
+DecodeMiddle(Cursor* next_, int N)
 {
 	assert(N == 2 || N == 5);
 	int lgPatternFound = 0;
@@ -130,16 +131,45 @@ DecodeMiddle(BitArray::Range* next_, int N)
 
 static const std::array<int, 3> EXTENSION_START_PATTERN = { 1,1,2 };
 
+static Result
+ConstructResult(const std::string& resultString, int rowNumber, int xStart, int xStop)
+{
+	Result result(resultString, rowNumber, xStart, xStop, BarcodeFormat::UPC_EAN_EXTENSION);
+
+	if (resultString.size() == 2) {
+		result.metadata().put(ResultMetadata::ISSUE_NUMBER, std::stoi(resultString));
+	} else {
+		std::string price = UPCEANExtension5Support::ParseExtension5String(resultString);
+		if (!price.empty())
+			result.metadata().put(ResultMetadata::SUGGESTED_PRICE, TextDecoder::FromLatin1(price));
+	}
+
+	return result;
+}
+
+// The extension is separated from the main symbol by 7 to 12 modules. Allow for some distortion and for the print
+// gain, the start guard is 4 modules wide.
+static bool IsInExtensionWindow(int quiteZone, int startGuard, float moduleSize)
+{
+	return moduleSize <= 0 || (quiteZone >= 5 * moduleSize && quiteZone <= 16 * moduleSize &&
+							   startGuard >= 2 * moduleSize && startGuard <= 8 * moduleSize);
+}
+
 Result
-UPCEANExtensionSupport::DecodeRow(int rowNumber, const BitArray& row, BitArray::Iterator begin)
+UPCEANExtensionSupport::DecodeRow(int rowNumber, const BitArray& row, BitArray::Iterator begin, float moduleSize)
 {
 	BitArray::Range next = {row.getNextSet(begin), row.end()};
 
 	int xStart = static_cast<int>(next.begin - row.begin());
 
+	auto guardBegin = next.begin;
 	if (!UPCEANReader::ReadGuardPattern(&next, EXTENSION_START_PATTERN))
 		return Result(DecodeStatus::NotFound);
 
+	int quiteZone = static_cast<int>(guardBegin - begin);
+	if (!IsInExtensionWindow(quiteZone, static_cast<int>(next.begin - guardBegin), moduleSize))
+		return Result(DecodeStatus::NotFound);
+
 	auto resultString = DecodeMiddle(&next, 5);
 	if (resultString.empty())
 		resultString = DecodeMiddle(&next, 2);
@@ -149,17 +179,34 @@ UPCEANExtensionSupport::DecodeRow(int rowNumber, const BitArray& row, BitArray::
 
 	int xStop = static_cast<int>(next.begin - row.begin() - 1);
 
-	Result result(resultString, rowNumber, xStart, xStop, BarcodeFormat::UPC_EAN_EXTENSION);
+	return ConstructResult(resultString, rowNumber, xStart, xStop);
+}
 
-	if (resultString.size() == 2) {
-		result.metadata().put(ResultMetadata::ISSUE_NUMBER, std::stoi(resultString));
-	} else {
-		std::string price = UPCEANExtension5Support::ParseExtension5String(resultString);
-		if (!price.empty())
-			result.metadata().put(ResultMetadata::SUGGESTED_PRICE, TextDecoder::FromLatin1(price));
-	}
+Result
+UPCEANExtensionSupport::DecodePattern(int rowNumber, PatternView next, float moduleSize)
+{
+	int quiteZone = next[0];
+	// skip the quite zone
+	next = next.subView(1);
+	if (!next.isValid(Size(EXTENSION_START_PATTERN)) ||
+		!IsInExtensionWindow(quiteZone, next.subView(0, Size(EXTENSION_START_PATTERN)).sum(), moduleSize))
+		return Result(DecodeStatus::NotFound);
 
-	return result;
+	int xStart = next.pixelsInFront();
+
+	if (!UPCEANReader::ReadGuardPattern(&next, EXTENSION_START_PATTERN))
+		return Result(DecodeStatus::NotFound);
+
+	auto resultString = DecodeMiddle(&next, 5);
+	if (resultString.empty())
+		resultString = DecodeMiddle(&next, 2);
+
+	if (resultString.empty())
+		return Result(DecodeStatus::NotFound);
+
+	int xStop = next.pixelsInFront() - 1;
+
+	return ConstructResult(resultString, rowNumber, xStart, xStop);
 }
 
 } // OneD
@@ -17,6 +17,7 @@
 */
 
 #include "BitArray.h"
+#include "Pattern.h"
 
 namespace ZXing {
 
@@ -27,7 +28,14 @@ namespace OneD {
 class UPCEANExtensionSupport
 {
 public:
-	static Result DecodeRow(int rowNumber, const BitArray& row, BitArray::Iterator begin);
+	/**
+	* Decodes the extension starting after the quite zone at begin. If moduleSize (of the main symbol) is > 0, the
+	* extension is only searched for if the quite zone and its start guard fit its size.
+	*/
+	static Result DecodeRow(int rowNumber, const BitArray& row, BitArray::Iterator begin, float moduleSize = 0);
+
+	// next points to the quite zone element following the end guard of the main symbol
+	static Result DecodePattern(int rowNumber, PatternView next, float moduleSize = 0);
 };
 
 
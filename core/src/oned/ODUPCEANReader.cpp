@@ -25,6 +25,9 @@
 #include "TextDecoder.h"
 #include "ZXContainerAlgorithms.h"
 
+#include <algorithm>
+#include <array>
+#include <cstdlib>
 #include <string>
 #include <type_traits>
 
@@ -78,14 +81,79 @@ UPCEANReader::FindStartGuardPattern(const BitArray& row)
 #endif
 }
 
+PatternView
+UPCEANReader::FindStartGuardPattern(const PatternView& row)
+{
+	// same as above: a 111 pattern with a quite zone in front that is at least as wide as the pattern itself
+	const auto& pattern = UPCEANCommon::START_END_PATTERN;
+
+	return ZXing::FindPattern<3>(
+		row,
+		[&pattern](const PatternView& window) {
+			return window.isValid(3) && window.hasQuiteZoneBefore(1) &&
+				   RowReader::PatternMatchVariance(window, pattern, MAX_INDIVIDUAL_VARIANCE) < MAX_AVG_VARIANCE;
+		},
+		1);
+}
+
+/**
+* Remembers the extensions found next to the main symbols of previous rows. Rows that cross a main symbol but not its
+* (shorter) extension, e.g. the ones through the digits printed above it, then still report the extension. This is
+* only a cache, the reader is not stateful (each thread of a parallel scan has its own).
+*/
+struct ExtensionCache : public RowReader::DecodingState
+{
+	struct Entry
+	{
+		std::string text;
+		int xStop = 0;
+		Result extension = Result(DecodeStatus::NotFound);
+	};
+	std::array<Entry, 4> entries;
+	int next = 0;
+};
+
+// The width of the main symbol in modules, including the guards
+static int SymbolModules(BarcodeFormat format)
+{
+	return format == BarcodeFormat::EAN_8 ? 67 : format == BarcodeFormat::UPC_E ? 51 : 95;
+}
+
+template <typename Decode>
+Result
+UPCEANReader::decodeExtension(const std::string& result, int xStop, float moduleSize,
+							  std::unique_ptr<DecodingState>& state, Decode decode) const
+{
+	if (!state)
+		state.reset(new ExtensionCache);
+	auto& cache = static_cast<ExtensionCache&>(*state);
+
+	// the end of the main symbol moves from row to row if the symbol is slightly rotated
+	auto sameSymbol = [&](const ExtensionCache::Entry& e) {
+		return e.text == result && std::abs(e.xStop - xStop) <= 8 * moduleSize;
+	};
+	auto entry = std::find_if(cache.entries.begin(), cache.entries.end(), sameSymbol);
+
+	Result extension = decode();
+	if (extension.isValid()) {
+		if (entry == cache.entries.end())
+			entry = cache.entries.begin() + cache.next++ % Size(cache.entries);
+		*entry = {result, xStop, extension};
+	}
+	else if (entry != cache.entries.end()) {
+		return entry->extension;
+	}
+	return extension;
+}
+
 Result
-UPCEANReader::decodeRow(int rowNumber, const BitArray& row, std::unique_ptr<DecodingState>&) const
+UPCEANReader::decodeRow(int rowNumber, const BitArray& row, std::unique_ptr<DecodingState>& state) const
 {
 	auto range = FindStartGuardPattern(row);
 	if (!range)
 		return Result(DecodeStatus::NotFound);
 
-	return decodeRow(rowNumber, row, range);
+	return decodeRow(rowNumber, row, range, state);
 }
 
 BitArray::Range
@@ -97,7 +165,26 @@ UPCEANReader::decodeEnd(const BitArray& row, BitArray::Iterator begin) const
 }
 
 Result
-UPCEANReader::decodeRow(int rowNumber, const BitArray& row, BitArray::Range startGuard) const
+UPCEANReader::decodePattern(int rowNumber, const PatternView& row, std::unique_ptr<DecodingState>& state) const
+{
+	auto startGuard = FindStartGuardPattern(row);
+	if (!startGuard.isValid())
+		return Result(DecodeStatus::NotFound);
+
+	return decodeAtStartGuard(rowNumber, startGuard, state);
+}
+
+PatternView
+UPCEANReader::decodeEnd(const PatternView& next) const
+{
+	auto guard = next.subView(0, Size(UPCEANCommon::START_END_PATTERN));
+	auto end = guard;
+	return ReadGuardPattern(&end, UPCEANCommon::START_END_PATTERN) ? guard : PatternView();
+}
+
+Result
+UPCEANReader::decodeRow(int rowNumber, const BitArray& row, BitArray::Range startGuard,
+						std::unique_ptr<DecodingState>& state) const
 {
 	std::string result;
 	result.reserve(20);
@@ -117,12 +204,56 @@ UPCEANReader::decodeRow(int rowNumber, const BitArray& row, BitArray::Range star
 	if (!checkChecksum(result))
 		return Result(DecodeStatus::ChecksumError);
 
-	BarcodeFormat format = expectedFormat();
 	int xStart = static_cast<int>(startGuard.begin - row.begin());
 	int xStop = static_cast<int>(stopGuard.end - row.begin() - 1);
 
+	float moduleSize = float(xStop + 1 - xStart) / SymbolModules(expectedFormat());
+	auto extension = decodeExtension(result, xStop, moduleSize, state, [&] {
+		return UPCEANExtensionSupport::DecodeRow(rowNumber, row, stopGuard.end, moduleSize);
+	});
+
+	return constructResult(result, rowNumber, xStart, xStop, extension);
+}
+
+Result
+UPCEANReader::decodeAtStartGuard(int rowNumber, const PatternView& startGuard,
+								 std::unique_ptr<DecodingState>& state) const
+{
+	std::string result;
+	result.reserve(20);
+	auto next = startGuard.subView(startGuard.size());
+	if (!decodeMiddle(next, result))
+		return Result(DecodeStatus::NotFound);
+
+	auto stopGuard = decodeEnd(next);
+	if (!stopGuard.isValid())
+		return Result(DecodeStatus::NotFound);
+
+	// Make sure there is a quiet zone at least as big as the end pattern after the barcode (see above). Like
+	// BitArray::hasQuiteZone, a zone reaching up to the end of the row has to be one pixel wider than that.
+	if (!stopGuard.isValid(stopGuard.size() + 1) || stopGuard[stopGuard.size()] < stopGuard.sum() + stopGuard.isAtLastBar())
+		return Result(DecodeStatus::NotFound);
+
+	if (!checkChecksum(result))
+		return Result(DecodeStatus::ChecksumError);
+
+	int xStart = startGuard.pixelsInFront();
+	int xStop = stopGuard.pixelsInFront() + stopGuard.sum() - 1;
+
+	float moduleSize = float(xStop + 1 - xStart) / SymbolModules(expectedFormat());
+	auto extension = decodeExtension(result, xStop, moduleSize, state, [&] {
+		return UPCEANExtensionSupport::DecodePattern(rowNumber, stopGuard.subView(stopGuard.size()), moduleSize);
+	});
+
+	return constructResult(result, rowNumber, xStart, xStop, extension);
+}
+
+Result
+UPCEANReader::constructResult(const std::string& result, int rowNumber, int xStart, int xStop, const Result& extensionResult) const
+{
+	BarcodeFormat format = expectedFormat();
+
 	Result decodeResult(result, rowNumber, xStart, xStop, format);
-	Result extensionResult = UPCEANExtensionSupport::DecodeRow(rowNumber, row, stopGuard.end);
 	if (extensionResult.isValid())
 	{
 		decodeResult.metadata().put(ResultMetadata::UPC_EAN_EXTENSION, extensionResult.text());
@@ -52,13 +52,23 @@ public:
 	* @param rowNumber row index into the image
 	* @param row encoding of the row of the barcode image
 	* @param startGuardRange start/end column where the opening start pattern was found
-	* @param hints optional hints that influence decoding
+	* @param state remembers the extensions found in previous rows
 	* @return {@link Result} encapsulating the result of decoding a barcode in the row
 	* @throws NotFoundException if no potential barcode is found
 	* @throws ChecksumException if a potential barcode is found but does not pass its checksum
 	* @throws FormatException if a potential barcode is found but format is invalid
 	*/
-	virtual Result decodeRow(int rowNumber, const BitArray& row, BitArray::Range startGuard) const;
+	virtual Result decodeRow(int rowNumber, const BitArray& row, BitArray::Range startGuard,
+							 std::unique_ptr<DecodingState>& state) const;
+
+	Result decodePattern(int rowNumber, const PatternView& row, std::unique_ptr<DecodingState>& state) const override;
+
+	/**
+	* Like {@link #decodeRow(int, BitArray, BitArray::Range)}, but operating on the bars/spaces of a
+	* PatternView. startGuard is the view covering the 3 elements of the start guard pattern.
+	*/
+	virtual Result decodeAtStartGuard(int rowNumber, const PatternView& startGuard,
+									  std::unique_ptr<DecodingState>& state) const;
 
 	using Digit = std::array<int, 4>;
 
@@ -68,6 +78,8 @@ protected:
 	// lets false positives creep in quickly.
 	static constexpr float MAX_AVG_VARIANCE = 0.48f;
 	static constexpr float MAX_INDIVIDUAL_VARIANCE = 0.7f;
+	// sub-pixel widths further off from a whole number of modules are left to the variance search
+	static constexpr float FAST_MAX_ERROR = 0.2f;
 
 	explicit UPCEANReader(const DecodeHints& hints);
 
@@ -87,6 +99,12 @@ protected:
 	*/
 	virtual BitArray::Range decodeMiddle(const BitArray& row, BitArray::Iterator begin, std::string& resultString) const = 0;
 
+	/**
+	* Same as above for the PatternView based decoder. On input, next points to the first element after
+	* the start guard pattern, on output to the first element after the "middle" that was decoded.
+	*/
+	virtual bool decodeMiddle(PatternView& next, std::string& resultString) const = 0;
+
 	/**
 	* @param s string of digits to check
 	* @return {@link #checkStandardUPCEANChecksum(CharSequence)}
@@ -96,9 +114,21 @@ protected:
 
 
 	virtual BitArray::Range decodeEnd(const BitArray& row, BitArray::Iterator begin) const;
+	virtual PatternView decodeEnd(const PatternView& next) const;
+
+	Result constructResult(const std::string& result, int rowNumber, int xStart, int xStop, const Result& extensionResult) const;
+
+	/**
+	* Returns the extension decoded by decode or, if there is none, the one found in a previous row next to the
+	* same main symbol (result) ending at (about) the same xStop.
+	*/
+	template <typename Decode>
+	Result decodeExtension(const std::string& result, int xStop, float moduleSize,
+						   std::unique_ptr<DecodingState>& state, Decode decode) const;
 
 public:
 	static BitArray::Range FindStartGuardPattern(const BitArray& row);
+	static PatternView FindStartGuardPattern(const PatternView& row);
 
 	/**
 	* Attempts to read and decode a single UPC/EAN-encoded digit.
@@ -120,7 +150,8 @@ public:
 			return -1;
 		next->begin = range.end;
 
-		int bestMatch = RowReader::DecodeDigit(counters, patterns, MAX_AVG_VARIANCE, MAX_INDIVIDUAL_VARIANCE, false);
+		int bestMatch =
+			RowReader::DecodeDigit(counters, Table(patterns), MAX_AVG_VARIANCE, MAX_INDIVIDUAL_VARIANCE, false);
 		if (bestMatch != -1)
 			resultString->push_back((char)('0' + bestMatch % 10));
 
@@ -142,6 +173,64 @@ public:
 		next->begin = range.end;
 		return true;
 	}
+
+	template <size_t N>
+	static int DecodeDigit(PatternView* next, const std::array<Digit, N>& patterns, std::string* resultString) {
+		assert(next && resultString);
+
+		// each digit consists of 2 spaces and 2 bars
+		*next = next->subView(0, 4);
+		if (!next->isValid(next->size()))
+			return -1;
+
+		int bestMatch = -1;
+		// with sub-pixel widths, the module counts of a clean digit can be looked up directly
+		if (next->hasSubPixelWidths())
+			bestMatch = IndexOfBitPattern(RowReader::OneToFourBitPattern<4, 7>(*next, FAST_MAX_ERROR), patterns);
+		if (bestMatch == -1)
+			bestMatch = RowReader::DecodeDigit(*next, Table(patterns), MAX_AVG_VARIANCE, MAX_INDIVIDUAL_VARIANCE, false);
+		if (bestMatch != -1)
+			resultString->push_back((char)('0' + bestMatch % 10));
+
+		next->skipSymbol();
+		return bestMatch;
+	}
+
+	// The L_PATTERNS and L_AND_G_PATTERNS are the only digit sets, they differ in size, so there is one table per N.
+	template <size_t N>
+	static const PatternTable<4, 7, std::array<Digit, N>>& Table(const std::array<Digit, N>& patterns) {
+		static const PatternTable<4, 7, std::array<Digit, N>> table(patterns);
+		assert(&table.patterns() == &patterns);
+		return table;
+	}
+
+	// Returns the index of the digit whose module counts give bitPattern (see RowReader::OneToFourBitPattern) or -1.
+	template <size_t N>
+	static int IndexOfBitPattern(int bitPattern, const std::array<Digit, N>& patterns) {
+		if (bitPattern == -1)
+			return -1;
+		for (size_t i = 0; i < N; ++i) {
+			int pattern = 0;
+			for (int j = 0; j < 4; ++j)
+				pattern = (pattern << patterns[i][j]) | ~(0xffffffff << patterns[i][j]) * (~j & 1);
+			if (pattern == bitPattern)
+				return static_cast<int>(i);
+		}
+		return -1;
+	}
+
+	template <size_t N>
+	static bool ReadGuardPattern(PatternView* next, const std::array<int, N>& pattern) {
+		assert(next);
+
+		auto view = next->subView(0, N);
+		if (!view.isValid(N) || RowReader::PatternMatchVariance(view, pattern, MAX_INDIVIDUAL_VARIANCE) >= MAX_AVG_VARIANCE)
+			return false;
+
+		view.skipSymbol();
+		*next = view;
+		return true;
+	}
 private:
 	std::vector<int> _allowedExtensions;
 };
@@ -58,6 +58,29 @@ UPCEReader::decodeMiddle(const BitArray& row, BitArray::Iterator begin, std::str
 	return {begin, next.begin};
 }
 
+bool
+UPCEReader::decodeMiddle(PatternView& next, std::string& resultString) const
+{
+	int lgPatternFound = 0;
+
+	for (int x = 0; x < 6; x++) {
+		int bestMatch = DecodeDigit(&next, UPCEANCommon::L_AND_G_PATTERNS, &resultString);
+		if (bestMatch == -1)
+			return false;
+
+		if (bestMatch >= 10) {
+			lgPatternFound |= 1 << (5 - x);
+		}
+	}
+
+	int i = IndexOf(UPCEANCommon::NUMSYS_AND_CHECK_DIGIT_PATTERNS, lgPatternFound);
+	if (i == -1)
+		return false;
+
+	resultString = std::to_string(i/10) + resultString + std::to_string(i % 10);
+	return true;
+}
+
 bool UPCEReader::checkChecksum(const std::string& s) const
 {
 	return UPCEANReader::checkChecksum(UPCEANCommon::ConvertUPCEtoUPCA(s));
@@ -71,5 +94,13 @@ UPCEReader::decodeEnd(const BitArray& row, BitArray::Iterator begin) const
 	return {begin, next.begin};
 }
 
+PatternView
+UPCEReader::decodeEnd(const PatternView& next) const
+{
+	auto guard = next.subView(0, Size(UPCEANCommon::UPCE_END_PATTERN));
+	auto end = guard;
+	return ReadGuardPattern(&end, UPCEANCommon::UPCE_END_PATTERN) ? guard : PatternView();
+}
+
 } // OneD
 } // ZXing
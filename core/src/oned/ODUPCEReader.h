@@ -36,8 +36,10 @@ public:
 protected:
 	BarcodeFormat expectedFormat() const override;
 	BitArray::Range decodeMiddle(const BitArray& row, BitArray::Iterator, std::string& resultString) const override;
+	bool decodeMiddle(PatternView& next, std::string& resultString) const override;
 	bool checkChecksum(const std::string& s) const override;
 	BitArray::Range decodeEnd(const BitArray& row, BitArray::Iterator begin) const override;
+	PatternView decodeEnd(const PatternView& next) const override;
 };
 
 } // OneD
@@ -17,6 +17,8 @@
 
 #include "ODWriterHelper.h"
 #include "BitMatrix.h"
+#include "ZXContainerAlgorithms.h"
+
 #include <algorithm>
 
 namespace ZXing {
@@ -28,7 +30,13 @@ namespace OneD {
 BitMatrix
 WriterHelper::RenderResult(const std::vector<bool>& code, int width, int height, int sidesMargin)
 {
-	int inputWidth = Size(code);
+	return RenderResult(ToRuns(code), width, height, sidesMargin);
+}
+
+BitMatrix
+WriterHelper::RenderResult(const PatternRow& runs, int width, int height, int sidesMargin)
+{
+	int inputWidth = Reduce(runs, 0);
 	// Add quiet zone on both sides.
 	int fullWidth = inputWidth + sidesMargin;
 	int outputWidth = std::max(width, fullWidth);
@@ -38,14 +46,34 @@ WriterHelper::RenderResult(const std::vector<bool>& code, int width, int height,
 	int leftPadding = (outputWidth - (inputWidth * multiple)) / 2;
 
 	BitMatrix result(outputWidth, outputHeight);
-	for (int inputX = 0, outputX = leftPadding; inputX < inputWidth; inputX++, outputX += multiple) {
-		if (code[inputX]) {
-			result.setRegion(outputX, 0, multiple, outputHeight);
-		}
+	int outputX = leftPadding;
+	for (size_t i = 0; i < runs.size(); ++i) {
+		int runWidth = runs[i] * multiple;
+		if (i % 2 && runWidth > 0)
+			result.setRegion(outputX, 0, runWidth, 1);
+		outputX += runWidth;
 	}
+	for (int y = 1; y < outputHeight; ++y)
+		result.copyRow(0, y);
 	return result;
 }
 
+PatternRow
+WriterHelper::ToRuns(const std::vector<bool>& code)
+{
+	PatternRow runs;
+	bool color = false;
+	runs.push_back(0);
+	for (bool module : code) {
+		if (module != color) {
+			runs.push_back(0);
+			color = module;
+		}
+		++runs.back();
+	}
+	return runs;
+}
+
 /**
 * @param target encode black/white pattern into this array
 * @param pos position to start encoding at in {@code target}
@@ -16,6 +16,7 @@
 * limitations under the License.
 */
 #include "BitMatrix.h"
+#include "Pattern.h"
 
 #include <vector>
 #include <cstddef>
@@ -37,6 +38,17 @@ public:
 	*/
 	static BitMatrix RenderResult(const std::vector<bool>& code, int width, int height, int sidesMargin);
 
+	/**
+	* Renders the bars given as run lengths in modules (alternating white and black, starting with white like
+	* GetPatternRow). Only the first row is drawn bar by bar, the others are copies of it.
+	*/
+	static BitMatrix RenderResult(const PatternRow& runs, int width, int height, int sidesMargin);
+
+	/**
+	* @return the run lengths of the modules of code in the format of GetPatternRow
+	*/
+	static PatternRow ToRuns(const std::vector<bool>& code);
+
 	/**
 	* @param target encode black/white pattern into this array
 	* @param pos position to start encoding at in {@code target}
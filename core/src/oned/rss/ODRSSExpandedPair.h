@@ -19,6 +19,10 @@
 #include "ODRSSDataCharacter.h"
 #include "ODRSSFinderPattern.h"
 
+#include <algorithm>
+#include <array>
+#include <cassert>
+
 namespace ZXing {
 namespace OneD {
 namespace RSS {
@@ -69,6 +73,48 @@ public:
 	}	
 };
 
+/**
+* The pairs of one row or of a whole symbol, stored in place. A symbol consists of at most 11 pairs (the longest
+* finder pattern sequence), the pairs of a row of a stacked symbol are a part of those.
+*/
+class ExpandedPairs
+{
+public:
+	static constexpr int MAX_SIZE = 11;
+
+private:
+	std::array<ExpandedPair, MAX_SIZE> _pairs;
+	int _size = 0;
+
+public:
+	int size() const { return _size; }
+	bool empty() const { return _size == 0; }
+	bool full() const { return _size == MAX_SIZE; }
+	void clear() { _size = 0; }
+
+	const ExpandedPair* begin() const { return _pairs.data(); }
+	const ExpandedPair* end() const { return _pairs.data() + _size; }
+	const ExpandedPair& operator[](int i) const { return _pairs[i]; }
+	const ExpandedPair& front() const { return _pairs[0]; }
+	const ExpandedPair& back() const { return _pairs[_size - 1]; }
+
+	void push_back(const ExpandedPair& pair) {
+		assert(!full());
+		_pairs[_size++] = pair;
+	}
+
+	/**
+	* Appends the pairs of other, returns false (and leaves this unchanged) if they do not fit.
+	*/
+	bool append(const ExpandedPairs& other) {
+		if (_size + other._size > MAX_SIZE)
+			return false;
+		std::copy(other.begin(), other.end(), _pairs.begin() + _size);
+		_size += other._size;
+		return true;
+	}
+};
+
 } // RSS
 } // OneD
 } // ZXing
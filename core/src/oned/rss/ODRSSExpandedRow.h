@@ -19,7 +19,6 @@
 #include "ODRSSExpandedPair.h"
 
 #include <algorithm>
-#include <vector>
 
 namespace ZXing {
 namespace OneD {
@@ -30,19 +29,16 @@ namespace RSS {
 */
 class ExpandedRow
 {
-	std::vector<ExpandedPair> _pairs;
+	ExpandedPairs _pairs;
 	int _rowNumber;
 	/** Did this row of the image have to be reversed (mirrored) to recognize the pairs? */
 	bool _wasReversed;
 
 public:
-	template <typename U>
-	ExpandedRow(const U& pairs, int rowNumber, bool wasReversed) : _rowNumber(rowNumber), _wasReversed(wasReversed) {
-		_pairs.reserve(pairs.size());
-		_pairs.assign(pairs.begin(), pairs.end());
-	}
+	ExpandedRow(const ExpandedPairs& pairs, int rowNumber, bool wasReversed) :
+		_pairs(pairs), _rowNumber(rowNumber), _wasReversed(wasReversed) {}
 
-	const std::vector<ExpandedPair>& pairs() const {
+	const ExpandedPairs& pairs() const {
 		return _pairs;
 	}
 
@@ -54,9 +50,8 @@ public:
 		return _wasReversed;
 	}
 
-	template <typename U>
-	bool isEquivalent(const U& list) const {
-		return _pairs.size() == list.size() && std::equal(_pairs.begin(), _pairs.end(), list.begin());
+	bool isEquivalent(const ExpandedPairs& pairs) const {
+		return _pairs.size() == pairs.size() && std::equal(_pairs.begin(), _pairs.end(), pairs.begin());
 	}
 };
 
@@ -16,13 +16,12 @@
 */
 
 #include "ODRSSGenericAppIdDecoder.h"
-#include "ODRSSFieldParser.h"
 #include "BitArray.h"
 #include "DecodeStatus.h"
+#include "GS1.h"
 #include "ZXStrConvWorkaround.h"
 
 #include <limits>
-#include <stdexcept>
 #include <utility>
 
 namespace ZXing {
@@ -128,6 +127,7 @@ struct ParsingState
 
 	int position = 0;
 	State encoding = NUMERIC;
+	bool error = false; // an invalid value was found, the field can not be decoded
 };
 
 #define ExtractNumeric GenericAppIdDecoder::ExtractNumeric
@@ -218,7 +218,7 @@ DecodeAlphanumeric(const BitArray& bits, int pos)
 	}
 
 	if (sixBitValue < 58 || sixBitValue > 62)
-		throw std::runtime_error("Decoding invalid alphanumeric value");
+		return {};
 
 	constexpr char const* lut58to62 = R"(*,-./)";
 	char c = lut58to62[sixBitValue - 58];
@@ -284,6 +284,10 @@ ParseAlphaBlock(const BitArray& bits, ParsingState& state, std::string& buffer)
 {
 	while (IsStillAlpha(bits, state.position)) {
 		DecodedChar alpha = DecodeAlphanumeric(bits, state.position);
+		if (!alpha.isValid()) {
+			state.error = true;
+			return DecodedInformation();
+		}
 		state.position = alpha.newPosition;
 
 		if (alpha.isFNC1()) {
@@ -332,7 +336,7 @@ DecodeIsoIec646(const BitArray& bits, int pos)
 
 	int eightBitValue = ExtractNumeric(bits, pos, 8);
 	if (eightBitValue < 232 || eightBitValue > 252)
-		throw std::runtime_error("Decoding invalid ISO-IEC-646 value");
+		return {};
 
 	constexpr char const* lut232to252 = R"(!"%&'()*+,-./:;<=>?_ )";
 	char c = lut232to252[eightBitValue - 232];
@@ -345,6 +349,10 @@ ParseIsoIec646Block(const BitArray& bits, ParsingState& state, std::string& buff
 {
 	while (IsStillIsoIec646(bits, state.position)) {
 		DecodedChar iso = DecodeIsoIec646(bits, state.position);
+		if (!iso.isValid()) {
+			state.error = true;
+			return DecodedInformation();
+		}
 		state.position = iso.newPosition;
 		if (iso.isFNC1()) {
 			return DecodedInformation(state.position, buffer);
@@ -390,6 +398,10 @@ ParseNumericBlock(const BitArray& bits, ParsingState& state, std::string& buffer
 {
 	while (IsStillNumeric(bits, state.position)) {
 		DecodedNumeric numeric = DecodeNumeric(bits, state.position);
+		if (!numeric.isValid()) {
+			state.error = true;
+			return DecodedInformation();
+		}
 		state.position = numeric.newPosition;
 
 		if (numeric.isFirstDigitFNC1()) {
@@ -429,7 +441,7 @@ ParseBlocks(const BitArray& bits, ParsingState& state, std::string& buffer)
 				ParseIsoIec646Block(bits, state, buffer) :
 				// else
 				ParseNumericBlock(bits, state, buffer));
-		if (result.isValid() || initialPosition == state.position)
+		if (result.isValid() || initialPosition == state.position || state.error)
 		{
 			return result;
 		}
@@ -449,53 +461,46 @@ DoDecodeGeneralPurposeField(ParsingState& state, const BitArray& bits, std::stri
 DecodeStatus
 GenericAppIdDecoder::DecodeGeneralPurposeField(const BitArray& bits, int pos, std::string& result)
 {
-	try
-	{
-		ParsingState state;
-		state.position = pos;
-		result += DoDecodeGeneralPurposeField(state, bits, std::string()).newString;
-		return DecodeStatus::NoError;
-	}
-	catch (const std::exception &)
-	{
-	}
-	return DecodeStatus::FormatError;
+	ParsingState state;
+	state.position = pos;
+	auto decoded = DoDecodeGeneralPurposeField(state, bits, std::string());
+	if (state.error) {
+		return DecodeStatus::FormatError;
+	}
+	result += decoded.newString;
+	return DecodeStatus::NoError;
 }
 
 DecodeStatus
 GenericAppIdDecoder::DecodeAllCodes(const BitArray& bits, int pos, std::string& result)
 {
-	try
-	{
-		ParsingState state;
-		std::string remaining;
-		while (true) {
-			state.position = pos;
-			DecodedInformation info = DoDecodeGeneralPurposeField(state, bits, remaining);
-			std::string parsedFields;
-			auto status = FieldParser::ParseFieldsInGeneralPurpose(info.newString, parsedFields);
-			if (StatusIsError(status)) {
-				return status;
-			}
-			result += parsedFields;
-			if (info.isRemaining()) {
-				remaining = std::to_string(info.remainingValue);
-			}
-			else {
-				remaining.clear();
-			}
+	ParsingState state;
+	std::string remaining;
+	while (true) {
+		state.position = pos;
+		DecodedInformation info = DoDecodeGeneralPurposeField(state, bits, remaining);
+		if (state.error) {
+			return DecodeStatus::FormatError;
+		}
+		std::string parsedFields;
+		auto status = GS1::HRIFromGS1(info.newString, parsedFields);
+		if (StatusIsError(status)) {
+			return status;
+		}
+		result += parsedFields;
+		if (info.isRemaining()) {
+			remaining = std::to_string(info.remainingValue);
+		}
+		else {
+			remaining.clear();
+		}
 
-			if (pos == info.newPosition) {// No step forward!
-				break;
-			}
-			pos = info.newPosition;
-		};
-		return DecodeStatus::NoError;
-	}
-	catch (const std::exception &)
-	{
-	}
-	return DecodeStatus::FormatError;
+		if (pos == info.newPosition) {// No step forward!
+			break;
+		}
+		pos = info.newPosition;
+	};
+	return DecodeStatus::NoError;
 }
 
 } // RSS
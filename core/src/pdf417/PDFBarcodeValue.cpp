@@ -17,16 +17,27 @@
 
 #include "PDFBarcodeValue.h"
 
+#include <algorithm>
+
 namespace ZXing {
 namespace Pdf417 {
 
+static bool IsLess(const std::pair<int, int>& entry, int value)
+{
+	return entry.first < value;
+}
+
 /**
 * Add an occurrence of a value
 */
 void
 BarcodeValue::setValue(int value)
 {
-	_values[value] += 1;
+	auto it = std::lower_bound(_values.begin(), _values.end(), value, IsLess);
+	if (it != _values.end() && it->first == value)
+		it->second++;
+	else
+		_values.emplace(it, value, 1);
 }
 
 /**
@@ -54,8 +65,8 @@ BarcodeValue::value() const
 int
 BarcodeValue::confidence(int value) const
 {
-	auto it = _values.find(value);
-	return it != _values.end() ? it->second : 0;
+	auto it = std::lower_bound(_values.begin(), _values.end(), value, IsLess);
+	return it != _values.end() && it->first == value ? it->second : 0;
 }
 
 } // Pdf417
@@ -16,7 +16,7 @@
 * limitations under the License.
 */
 
-#include <map>
+#include <utility>
 #include <vector>
 
 namespace ZXing {
@@ -27,7 +27,8 @@ namespace Pdf417 {
 */
 class BarcodeValue
 {
-	std::map<int, int> _values;
+	// the values in ascending order with the number of their occurrences, there are rarely more than one or two
+	std::vector<std::pair<int, int>> _values;
 
 public:
 	/**
@@ -19,6 +19,8 @@
 
 #include <array>
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <numeric>
 #include <limits>
 
@@ -482,9 +484,67 @@ static int GetDecodedCodewordValue(const ModuleBitCountType& moduleBitCount)
 	return CodewordDecoder::GetCodeword(decodedValue) == -1 ? -1 : decodedValue;
 }
 
+// The symbols are indexed by the widths of their first INDEX_BARS bars, each 1 to MAX_BAR_WIDTH modules wide.
+static const int INDEX_BARS = 3;
+static const int MAX_BAR_WIDTH = 6;
+static const int INDEX_BUCKETS = MAX_BAR_WIDTH * MAX_BAR_WIDTH * MAX_BAR_WIDTH;
+
+struct RatioIndex
+{
+	// the symbols of bucket i are symbols[offsets[i]] up to symbols[offsets[i + 1]], in the order of the ratio table
+	std::array<uint16_t, INDEX_BUCKETS + 1> offsets;
+	std::array<uint16_t, SYMBOL_COUNT> symbols;
+};
+
+static int BucketOf(const std::array<int, INDEX_BARS>& widths)
+{
+	int bucket = 0;
+	for (int width : widths)
+		bucket = bucket * MAX_BAR_WIDTH + width - 1;
+	return bucket;
+}
+
+static std::array<int, INDEX_BARS> IndexWidths(const std::array<float, CodewordDecoder::BARS_IN_MODULE>& ratios)
+{
+	std::array<int, INDEX_BARS> widths;
+	for (int i = 0; i < INDEX_BARS; i++)
+		widths[i] = std::min(std::max(static_cast<int>(std::lround(ratios[i] * CodewordDecoder::MODULES_IN_CODEWORD)), 1),
+							 MAX_BAR_WIDTH);
+	return widths;
+}
+
+static const RatioIndex& GetRatioIndex()
+{
+	auto initIndex = [](RatioIndex& index) -> RatioIndex& {
+		const RatioTableType& ratioTable = GetRatioTable();
+		std::array<int, SYMBOL_COUNT> buckets;
+		index.offsets.fill(0);
+		for (int i = 0; i < SYMBOL_COUNT; i++) {
+			buckets[i] = BucketOf(IndexWidths(ratioTable[i]));
+			index.offsets[buckets[i] + 1]++;
+		}
+		std::partial_sum(index.offsets.begin(), index.offsets.end(), index.offsets.begin());
+		auto next = index.offsets;
+		for (int i = 0; i < SYMBOL_COUNT; i++)
+			index.symbols[next[buckets[i]]++] = static_cast<uint16_t>(i);
+		return index;
+	};
+
+	static RatioIndex index;
+	static const auto& ref = initIndex(index);
+	return ref;
+}
+
+/**
+* Finds the symbol with the smallest squared error between its bar width ratios and the observed ones. The error of
+* the first INDEX_BARS bars is the same for all symbols of a bucket, so it is a lower bound for the whole bucket: only
+* the buckets where it does not exceed the best error found so far need to be searched, starting with the one the
+* observed widths round to. Of several equally good symbols the first one in the table wins.
+*/
 static int GetClosestDecodedValue(const ModuleBitCountType& moduleBitCount)
 {
 	static const RatioTableType& ratioTable = GetRatioTable();
+	static const RatioIndex& ratioIndex = GetRatioIndex();
 
 	int bitCountSum = std::accumulate(moduleBitCount.begin(), moduleBitCount.end(), 0);
 	std::array<float, CodewordDecoder::BARS_IN_MODULE> bitCountRatios = {};
@@ -493,24 +553,52 @@ static int GetClosestDecodedValue(const ModuleBitCountType& moduleBitCount)
 			bitCountRatios[i] = moduleBitCount[i] / (float)bitCountSum;
 		}
 	}
+
+	// the squared error of each possible width of the indexed bars
+	std::array<std::array<float, MAX_BAR_WIDTH + 1>, INDEX_BARS> barErrors;
+	for (int i = 0; i < INDEX_BARS; i++) {
+		for (int width = 1; width <= MAX_BAR_WIDTH; width++) {
+			float diff = static_cast<float>(width) / CodewordDecoder::MODULES_IN_CODEWORD - bitCountRatios[i];
+			barErrors[i][width] = diff * diff;
+		}
+	}
+
 	float bestMatchError = std::numeric_limits<float>::max();
 	int bestMatch = -1;
-	for (size_t j = 0; j < ratioTable.size(); j++) {
-		float error = 0.0f;
-		auto& ratioTableRow = ratioTable[j];
-		for (int k = 0; k < CodewordDecoder::BARS_IN_MODULE; k++) {
-			float diff = ratioTableRow[k] - bitCountRatios[k];
-			error += diff * diff;
-			if (error >= bestMatchError) {
-				break;
+	auto searchBucket = [&](int bucket) {
+		if (ratioIndex.offsets[bucket] == ratioIndex.offsets[bucket + 1])
+			return;
+		int widths[INDEX_BARS];
+		for (int i = INDEX_BARS - 1, rest = bucket; i >= 0; i--, rest /= MAX_BAR_WIDTH)
+			widths[i] = rest % MAX_BAR_WIDTH + 1;
+		// summed in the same order as the remaining bars below, so that it is exactly the partial error of each symbol
+		float bucketError = 0.0f;
+		for (int i = 0; i < INDEX_BARS; i++)
+			bucketError += barErrors[i][widths[i]];
+		if (bucketError > bestMatchError)
+			return;
+		for (int s = ratioIndex.offsets[bucket]; s < ratioIndex.offsets[bucket + 1]; s++) {
+			int j = ratioIndex.symbols[s];
+			float error = bucketError;
+			auto& ratioTableRow = ratioTable[j];
+			for (int k = INDEX_BARS; k < CodewordDecoder::BARS_IN_MODULE && error <= bestMatchError; k++) {
+				float diff = ratioTableRow[k] - bitCountRatios[k];
+				error += diff * diff;
+			}
+			if (error < bestMatchError || (error == bestMatchError && j < bestMatch)) {
+				bestMatchError = error;
+				bestMatch = j;
 			}
 		}
-		if (error < bestMatchError) {
-			bestMatchError = error;
-			bestMatch = SYMBOL_TABLE[j];
-		}
+	};
+
+	int first = BucketOf(IndexWidths(bitCountRatios));
+	searchBucket(first);
+	for (int bucket = 0; bucket < INDEX_BUCKETS; bucket++) {
+		if (bucket != first)
+			searchBucket(bucket);
 	}
-	return bestMatch;
+	return bestMatch == -1 ? -1 : SYMBOL_TABLE[bestMatch];
 }
 
 int
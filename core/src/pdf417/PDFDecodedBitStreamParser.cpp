@@ -20,15 +20,18 @@
 #include "CharacterSetECI.h"
 #include "CharacterSet.h"
 #include "TextDecoder.h"
-#include "ZXBigInteger.h"
 #include "ByteArray.h"
 #include "DecodeStatus.h"
+#include "DecodeStats.h"
 #include "DecoderResult.h"
+#include "ZXContainerAlgorithms.h"
 #include "ZXStrConvWorkaround.h"
 #include "ZXTestSupport.h"
 
 #include <array>
 #include <cassert>
+#include <cstdint>
+#include <limits>
 #include <utility>
 
 namespace ZXing {
@@ -476,24 +479,35 @@ Remove leading 1 =>  Result is 000213298174000
 */
 static DecodeStatus DecodeBase900toBase10(const std::vector<int>& codewords, int count, std::string& resultString)
 {
-	// Table containing values for the exponent of 900.
-	static const auto EXP900 = []() {
-		std::array<BigInteger, 16> table = {1, 900};
-		for (size_t i = 2; i < table.size(); ++i) {
-			table[i] = table[i - 1] * 900;
-		}
-		return table;
-	}();
+	// 900^16 < 10^48, so the value of up to 16 codewords fits into 6 'digits' of base 10^9. Accumulating it with Horner's
+	// scheme in these fixed size limbs avoids the heap allocating BigInteger arithmetic.
+	constexpr uint32_t BASE = 1000000000;
+	constexpr int BASE_DIGITS = 9;
+	constexpr int LIMBS = 6;
 
 	assert(count <= 16);
 
-	BigInteger result;
+	std::array<uint32_t, LIMBS> limbs = {}; // least significant first
 	for (int i = 0; i < count; i++) {
-		result += EXP900[count - i - 1] * codewords[i];
+		uint64_t carry = codewords[i];
+		for (auto& limb : limbs) {
+			carry += uint64_t(limb) * 900;
+			limb = static_cast<uint32_t>(carry % BASE);
+			carry /= BASE;
+		}
+	}
+
+	int top = LIMBS - 1;
+	while (top > 0 && limbs[top] == 0) {
+		--top;
+	}
+	resultString = std::to_string(limbs[top]);
+	for (int i = top - 1; i >= 0; --i) {
+		auto digits = std::to_string(limbs[i]);
+		resultString.append(BASE_DIGITS - digits.size(), '0').append(digits);
 	}
-	resultString = result.toString();
-	if (!resultString.empty() && resultString.front() == '1') {
-		resultString = resultString.substr(1);
+	if (resultString.front() == '1') {
+		resultString.erase(0, 1);
 		return DecodeStatus::NoError;
 	}
 	return DecodeStatus::FormatError;
@@ -555,6 +569,25 @@ static DecodeStatus NumericCompaction(const std::vector<int>& codewords, int cod
 	return DecodeStatus::NoError;
 }
 
+/**
+* Decodes a numeric optional field of the macro control block. Empty fields and ones with more digits than fit into T
+* are a FormatError.
+*/
+template <typename T>
+static DecodeStatus NumericField(const std::vector<int>& codewords, int codeIndex, T& value, int& next)
+{
+	std::string buf;
+	auto status = NumericCompaction(codewords, codeIndex, buf, next);
+	if (StatusIsError(status)) {
+		return status;
+	}
+	if (buf.empty() || Size(buf) > std::numeric_limits<T>::digits10) {
+		return DecodeStatus::FormatError;
+	}
+	value = static_cast<T>(std::stoll(buf));
+	return DecodeStatus::NoError;
+}
+
 ZXING_EXPORT_TEST_ONLY
 DecodeStatus DecodeMacroBlock(const std::vector<int>& codewords, int codeIndex, DecoderResultExtra& resultMetadata, int& next)
 {
@@ -608,27 +641,39 @@ DecodeStatus DecodeMacroBlock(const std::vector<int>& codewords, int codeIndex,
 						break;
 					}
 					case MACRO_PDF417_OPTIONAL_FIELD_SEGMENT_COUNT: {
-						std::string segmentCount;
-						status = NumericCompaction(codewords, codeIndex + 1, segmentCount, codeIndex);
-						resultMetadata.setSegmentCount(std::stoi(segmentCount));
+						int segmentCount;
+						status = NumericField(codewords, codeIndex + 1, segmentCount, codeIndex);
+						if (StatusIsError(status)) {
+							return status;
+						}
+						resultMetadata.setSegmentCount(segmentCount);
 						break;
 					}
 					case MACRO_PDF417_OPTIONAL_FIELD_TIME_STAMP: {
-						std::string timestamp;
-						status = NumericCompaction(codewords, codeIndex + 1, timestamp, codeIndex);
-						resultMetadata.setTimestamp(std::stoll(timestamp));
+						int64_t timestamp;
+						status = NumericField(codewords, codeIndex + 1, timestamp, codeIndex);
+						if (StatusIsError(status)) {
+							return status;
+						}
+						resultMetadata.setTimestamp(timestamp);
 						break;
 					}
 					case MACRO_PDF417_OPTIONAL_FIELD_CHECKSUM: {
-						std::string checksum;
-						status = NumericCompaction(codewords, codeIndex + 1, checksum, codeIndex);
-						resultMetadata.setChecksum(std::stoi(checksum));
+						int checksum;
+						status = NumericField(codewords, codeIndex + 1, checksum, codeIndex);
+						if (StatusIsError(status)) {
+							return status;
+						}
+						resultMetadata.setChecksum(checksum);
 						break;
 					}
 					case MACRO_PDF417_OPTIONAL_FIELD_FILE_SIZE: {
-						std::string fileSize;
-						status = NumericCompaction(codewords, codeIndex + 1, fileSize, codeIndex);
-						resultMetadata.setFileSize(std::stoll(fileSize));
+						int64_t fileSize;
+						status = NumericField(codewords, codeIndex + 1, fileSize, codeIndex);
+						if (StatusIsError(status)) {
+							return status;
+						}
+						resultMetadata.setFileSize(fileSize);
 						break;
 					}
 					default: {
@@ -647,10 +692,9 @@ DecodeStatus DecodeMacroBlock(const std::vector<int>& codewords, int codeIndex,
 				status = DecodeStatus::FormatError;
 				break;
 			}
-
-			if (StatusIsError(status)) {
-				return status;
-			}
+		}
+		if (StatusIsError(status)) {
+			return status;
 		}
 	}
 
@@ -671,6 +715,7 @@ DecodeStatus DecodeMacroBlock(const std::vector<int>& codewords, int codeIndex,
 DecoderResult
 DecodedBitStreamParser::Decode(const std::vector<int>& codewords, int ecLevel)
 {
+	DecodeStats::StageTimer timer(DecodeStats::Stage::DecodeText);
 	std::wstring resultString;
 	auto encoding = DEFAULT_ENCODING;
 	// Get compaction mode
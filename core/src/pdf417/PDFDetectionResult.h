@@ -20,6 +20,8 @@
 #include "PDFBoundingBox.h"
 #include "PDFDetectionResultColumn.h"
 #include "ZXNullable.h"
+
+#include <utility>
 #include <vector>
 
 namespace ZXing {
@@ -70,6 +72,10 @@ public:
 		_detectionResultColumns[barcodeColumn] = detectionResultColumn;
 	}
 
+	void setColumn(int barcodeColumn, Nullable<DetectionResultColumn>&& detectionResultColumn) {
+		_detectionResultColumns[barcodeColumn] = std::move(detectionResultColumn);
+	}
+
 	const Nullable<DetectionResultColumn>& column(int barcodeColumn) const {
 		return _detectionResultColumns[barcodeColumn];
 	}
@@ -19,6 +19,10 @@
 #include "BinaryBitmap.h"
 #include "DecodeStatus.h"
 #include "BitMatrix.h"
+#include "Deadline.h"
+#include "Pattern.h"
+#include "RunLengthIndex.h"
+#include "Trace.h"
 #include "ZXNullable.h"
 
 #include <algorithm>
@@ -38,9 +42,9 @@ static const float MAX_INDIVIDUAL_VARIANCE = 0.8f;
 
 // B S B S B S B S Bar/Space pattern
 // 11111111 0 1 0 1 0 1 000
-static const std::vector<int> START_PATTERN = { 8, 1, 1, 1, 1, 1, 1, 3 };
+static const std::array<int, 8> START_PATTERN = { 8, 1, 1, 1, 1, 1, 1, 3 };
 // 1111111 0 1 000 1 0 1 00 1
-static const std::vector<int> STOP_PATTERN = { 7, 1, 1, 3, 1, 1, 1, 2, 1 };
+static const std::array<int, 9> STOP_PATTERN = { 7, 1, 1, 3, 1, 1, 1, 2, 1 };
 static const int MAX_PIXEL_DRIFT = 3;
 static const int MAX_PATTERN_DRIFT = 5;
 // if we set the value too low, then we don't detect the correct height of the bar if the start patterns are damaged.
@@ -62,8 +66,9 @@ static const int BARCODE_MIN_HEIGHT = 10;
 * @param maxIndividualVariance The most any counter can differ before we give up
 * @return ratio of total variance between counters and pattern compared to total pattern size
 */
+template <size_t N>
 static float
-PatternMatchVariance(const std::vector<int>& counters, const std::vector<int>& pattern, float maxIndividualVariance)
+PatternMatchVariance(const std::array<int, N>& counters, const std::array<int, N>& pattern, float maxIndividualVariance)
 {
 	int total = 0;
 	int patternLength = 0;
@@ -97,75 +102,98 @@ PatternMatchVariance(const std::vector<int>& counters, const std::vector<int>& p
 
 
 /**
-* @param matrix row of black/white values to search
+* The run lengths of the rows of an image, taken from its RunLengthIndex. With rotated set, these are the rows of the
+* image rotated by 180 degrees, i.e. the reversed runs of the rows in reverse order (each reversed once on first
+* access), so the search for an upside down symbol does not need a rotated copy of the image.
+*/
+class RowRuns
+{
+	const RunLengthIndex& _index;
+	bool _rotated;
+	std::vector<PatternRow> _rows;
+
+public:
+	RowRuns(const RunLengthIndex& index, bool rotated)
+		: _index(index), _rotated(rotated), _rows(rotated ? index.height() : 0)
+	{}
+
+	int width() const { return _index.width(); }
+	int height() const { return _index.height(); }
+
+	const PatternRow& operator[](int y)
+	{
+		if (!_rotated)
+			return _index.row(y);
+		auto& runs = _rows[y];
+		if (runs.empty()) {
+			const auto& src = _index.row(height() - 1 - y);
+			runs.assign(src.rbegin(), src.rend());
+		}
+		return runs;
+	}
+};
+
+/**
+* @param runs run lengths of the row to search, starting with a white one
 * @param column x position to start search
-* @param row y position to start search
-* @param width the number of pixels to search on this row
+* @param width the number of pixels in the row
 * @param pattern pattern of counts of number of black and white pixels that are
 *                 being searched for as a pattern
-* @param counters array of counters, as long as pattern, to re-use
-* @return start/end horizontal offset of guard pattern, as an array of two ints.
+* @return start/end horizontal offset of guard pattern.
 */
+template <size_t N>
 static bool
-FindGuardPattern(const BitMatrix& matrix, int column, int row, int width, bool whiteFirst, const std::vector<int>& pattern, std::vector<int>& counters, int& startPos, int& endPos)
+FindGuardPattern(const PatternRow& runs, int column, int width, const std::array<int, N>& pattern, int& startPos, int& endPos)
 {
-	std::fill(counters.begin(), counters.end(), 0);
-	int patternLength = Size(pattern);
-	bool isWhite = whiteFirst;
-	int patternStart = column;
-	int pixelDrift = 0;
-
-	// if there are black pixels left of the current pixel shift to the left, but only for MAX_PIXEL_DRIFT pixels 
-	while (matrix.get(patternStart, row) && patternStart > 0 && pixelDrift++ < MAX_PIXEL_DRIFT) {
-		patternStart--;
+	// find the run containing column
+	int i = 0;
+	int x = 0;
+	while (i < Size(runs) && x + runs[i] <= column) {
+		x += runs[i++];
 	}
-	int x = patternStart;
-	int counterPosition = 0;
-	for (; x < width; x++) {
-		bool pixel = matrix.get(x, row);
-		if (pixel != isWhite) {
-			counters[counterPosition]++;
-		}
-		else {
-			if (counterPosition == patternLength - 1) {
-				if (PatternMatchVariance(counters, pattern, MAX_INDIVIDUAL_VARIANCE) < MAX_AVG_VARIANCE) {
-					startPos = patternStart;
-					endPos = x;
-					return true;
-				}
-				patternStart += counters[0] + counters[1];
-				std::copy(counters.begin() + 2, counters.end(), counters.begin());
-				counters[patternLength - 2] = 0;
-				counters[patternLength - 1] = 0;
-				counterPosition--;
-			}
-			else {
-				counterPosition++;
-			}
-			counters[counterPosition] = 1;
-			isWhite = !isWhite;
-		}
+	if (i == Size(runs)) {
+		return false;
 	}
-	if (counterPosition == patternLength - 1) {
+	int patternStart;
+	if (i % 2 == 1) {
+		// if the black run reaches left of the current pixel shift to the left, but only for MAX_PIXEL_DRIFT pixels
+		patternStart = std::max(x, column - MAX_PIXEL_DRIFT);
+	}
+	else {
+		x += runs[i++];
+		patternStart = x;
+	}
+
+	// slide a window of N runs over the row, starting at every black run
+	std::array<int, N> counters;
+	for (; i + Size(pattern) <= Size(runs); i += 2) {
+		std::copy_n(runs.begin() + i, N, counters.begin());
+		counters[0] -= patternStart - x;
 		if (PatternMatchVariance(counters, pattern, MAX_INDIVIDUAL_VARIANCE) < MAX_AVG_VARIANCE) {
 			startPos = patternStart;
-			endPos = x - 1;
+			// the end is the first pixel after the pattern or the last pixel of the row
+			endPos = std::min(patternStart + Reduce(counters), width - 1);
 			return true;
 		}
+		x += runs[i] + runs[i + 1];
+		patternStart = x;
 	}
 	return false;
 }
 
+template <size_t N>
 static std::array<Nullable<ResultPoint>, 4>&
-FindRowsWithPattern(const BitMatrix& matrix, int height, int width, int startRow, int startColumn, const std::vector<int>& pattern, std::array<Nullable<ResultPoint>, 4>& result)
+FindRowsWithPattern(RowRuns& rows, int startRow, int startColumn, int rowStep, const std::array<int, N>& pattern,
+					std::array<Nullable<ResultPoint>, 4>& result)
 {
+	int height = rows.height();
+	int width = rows.width();
 	bool found = false;
 	int startPos, endPos;
-	std::vector<int> counters(pattern.size(), 0);
-	for (; startRow < height; startRow += ROW_STEP) {
-		if (FindGuardPattern(matrix, startColumn, startRow, width, false, pattern, counters, startPos, endPos)) {
+	for (; startRow < height; startRow += rowStep) {
+		if (FindGuardPattern(rows[startRow], startColumn, width, pattern, startPos, endPos)) {
 			while (startRow > 0) {
-				if (!FindGuardPattern(matrix, startColumn, --startRow, width, false, pattern, counters, startPos, endPos)) {
+				if (!FindGuardPattern(rows[--startRow], startColumn, width, pattern, startPos, endPos)) {
 					startRow++;
 					break;
 				}
@@ -184,7 +212,7 @@ FindRowsWithPattern(const BitMatrix& matrix, int height, int width, int startRow
 		int previousRowEnd = static_cast<int>(result[1].value().x());
 		for (; stopRow < height; stopRow++) {
 			int startPos, endPos;
-			found = FindGuardPattern(matrix, previousRowStart, stopRow, width, false, pattern, counters, startPos, endPos);
+			found = FindGuardPattern(rows[stopRow], previousRowStart, width, pattern, startPos, endPos);
 			// a found pattern is only considered to belong to the same barcode if the start and end positions
 			// don't differ too much. Pattern drift should be not bigger than two for consecutive rows. With
 			// a higher number of skipped rows drift could be larger. To keep it simple for now, we allow a slightly
@@ -223,7 +251,8 @@ CopyToResult(std::array<Nullable<ResultPoint>, 8>& result, const std::array<Null
 * Locate the vertices and the codewords area of a black blob using the Start
 * and Stop patterns as locators.
 *
-* @param matrix the scanned barcode image.
+* @param rows the run lengths of the rows of the scanned barcode image.
+* @param rowStep the distance of the rows searched for the start pattern until it is found
 * @return an array containing the vertices:
 *           vertices[0] x, y top left barcode
 *           vertices[1] x, y bottom left barcode
@@ -234,39 +263,40 @@ CopyToResult(std::array<Nullable<ResultPoint>, 8>& result, const std::array<Null
 *           vertices[6] x, y top right codeword area
 *           vertices[7] x, y bottom right codeword area
 */
-static std::array<Nullable<ResultPoint>, 8> FindVertices(const BitMatrix& matrix, int startRow, int startColumn)
+static std::array<Nullable<ResultPoint>, 8> FindVertices(RowRuns& rows, int startRow, int startColumn, int rowStep)
 {
-	int width = matrix.width();
-	int height = matrix.height();
-
 	std::array<Nullable<ResultPoint>, 4> tmp;
 	std::array<Nullable<ResultPoint>, 8> result;
-	CopyToResult(result, FindRowsWithPattern(matrix, height, width, startRow, startColumn, START_PATTERN, tmp), INDEXES_START_PATTERN);
+	CopyToResult(result, FindRowsWithPattern(rows, startRow, startColumn, rowStep, START_PATTERN, tmp),
+				 INDEXES_START_PATTERN);
 
 	if (result[4] != nullptr) {
 		startColumn = static_cast<int>(result[4].value().x());
 		startRow = static_cast<int>(result[4].value().y());
 	}
-	CopyToResult(result, FindRowsWithPattern(matrix, height, width, startRow, startColumn, STOP_PATTERN, tmp), INDEXES_STOP_PATTERN);
+	CopyToResult(result, FindRowsWithPattern(rows, startRow, startColumn, rowStep, STOP_PATTERN, tmp),
+				 INDEXES_STOP_PATTERN);
 	return result;
 }
 
 /**
-* Detects PDF417 codes in an image. Only checks 0 degree rotation
+* Detects PDF417 codes in an image. Only checks the one rotation the rows are given in
 * @param multiple if true, then the image is searched for multiple codes. If false, then at most one code will
 * be found and returned
-* @param bitMatrix bit matrix to detect barcodes in
+* @param rows run lengths of the rows of the image to detect barcodes in
+* @param scanStride the guard patterns are searched in only every (ROW_STEP * scanStride)-th row
 * @return List of ResultPoint arrays containing the coordinates of found barcodes
 */
-static std::list<std::array<Nullable<ResultPoint>, 8>> DetectBarcode(const BitMatrix& bitMatrix, bool multiple)
+static std::list<std::array<Nullable<ResultPoint>, 8>> DetectBarcode(RowRuns&& rows, bool multiple, int scanStride)
 {
+	const int rowStep = ROW_STEP * std::max(1, scanStride);
 	int row = 0;
 	int column = 0;
 	bool foundBarcodeInRow = false;
 	std::list<std::array<Nullable<ResultPoint>, 8>> barcodeCoordinates;
 
-	while (row < bitMatrix.height()) {
-		auto vertices = FindVertices(bitMatrix, row, column);
+	while (row < rows.height() && !Deadline::Expired()) {
+		auto vertices = FindVertices(rows, row, column, rowStep);
 
 		if (vertices[0] == nullptr && vertices[3] == nullptr) {
 			if (!foundBarcodeInRow) {
@@ -285,7 +315,7 @@ static std::list<std::array<Nullable<ResultPoint>, 8>> DetectBarcode(const BitMa
 					row = std::max(row, static_cast<int>(barcodeCoordinate[3].value().y()));
 				}
 			}
-			row += ROW_STEP;
+			row += rowStep;
 			continue;
 		}
 		foundBarcodeInRow = true;
@@ -308,6 +338,75 @@ static std::list<std::array<Nullable<ResultPoint>, 8>> DetectBarcode(const BitMa
 }
 
 
+/**
+* Reads the runs of row y starting at the black pixel x in direction dx and checks them against the guard pattern,
+* which is mirrored when reading to the left.
+*
+* @param length the number of pixels covered by the pattern
+*/
+template <size_t N>
+static bool IsPureGuardPattern(const BitMatrix& image, int x, int y, int dx, const std::array<int, N>& pattern,
+							   int& length)
+{
+	std::array<int, N> counters = {};
+	bool color = true;
+	size_t i = 0;
+	for (; x >= 0 && x < image.width(); x += dx) {
+		if (image.get(x, y) != color) {
+			if (++i == N)
+				break;
+			color = !color;
+		}
+		counters[i]++;
+	}
+	if (i < N - 1)
+		return false;
+	if (dx < 0)
+		std::reverse(counters.begin(), counters.end());
+	length = Reduce(counters);
+	return PatternMatchVariance(counters, pattern, MAX_INDIVIDUAL_VARIANCE) < MAX_AVG_VARIANCE;
+}
+
+/**
+* This method detects a code in a "pure" image -- that is, pure monochrome image which contains only an unrotated,
+* unskewed image of a code, with some white border around it. The vertices follow from the bounding box and the guard
+* patterns in its top row, so neither run lengths nor a row by row search are needed.
+*/
+static bool DetectPure(const BitMatrix& image, std::array<Nullable<ResultPoint>, 8>& vertices)
+{
+	int left, top, width, height;
+	if (!image.findBoundingBox(left, top, width, height, BARCODE_MIN_HEIGHT))
+		return false;
+
+	// the start pattern spans all rows of the symbol, a speck of noise may still have extended the bounding box
+	int right = left + width - 1;
+	int bottom = top + height - 1;
+	while (top < bottom && !image.get(left, top))
+		++top;
+	while (bottom > top && !image.get(left, bottom))
+		--bottom;
+	while (right > left && !image.get(right, top))
+		--right;
+	int startLength, stopLength;
+	if (bottom - top + 1 < BARCODE_MIN_HEIGHT || !IsPureGuardPattern(image, left, top, 1, START_PATTERN, startLength))
+		return false;
+
+	vertices.fill(nullptr);
+	vertices[0] = ResultPoint(left, top);
+	vertices[1] = ResultPoint(left, bottom);
+	vertices[4] = ResultPoint(left + startLength, top);
+	vertices[5] = ResultPoint(left + startLength, bottom);
+	// like FindGuardPattern, the end is the first pixel after the pattern or the last pixel of the row
+	if (IsPureGuardPattern(image, right, top, -1, STOP_PATTERN, stopLength)) {
+		int end = std::min(right + 1, image.width() - 1);
+		vertices[6] = ResultPoint(right + 1 - stopLength, top);
+		vertices[2] = ResultPoint(end, top);
+		vertices[7] = ResultPoint(right + 1 - stopLength, bottom);
+		vertices[3] = ResultPoint(end, bottom);
+	}
+	return true;
+}
+
 /**
 * <p>Detects a PDF417 Code in an image. Only checks 0 and 180 degree rotations.</p>
 *
@@ -315,27 +414,50 @@ static std::list<std::array<Nullable<ResultPoint>, 8>> DetectBarcode(const BitMa
 * @param hints optional hints to detector
 * @param multiple if true, then the image is searched for multiple codes. If false, then at most one code will
 * be found and returned
+* @param isPure if true, the image contains only the code, see DetectPure
+* @param scanStride see DecodeHints::scanStride
 * @return {@link PDF417DetectorResult} encapsulating results of detecting a PDF417 code
 * @throws NotFoundException if no PDF417 Code can be found
 */
 DecodeStatus
-Detector::Detect(const BinaryBitmap& image, bool multiple, Result& result)
+Detector::Detect(const BinaryBitmap& image, bool multiple, bool isPure, int scanStride, Result& result)
 {
+	ZX_TRACE_SCOPE("Pdf417::Detector::Detect");
 	// TODO detection improvement, tryHarder could try several different luminance thresholds/blackpoints or even 
 	// different binarizers
 	//boolean tryHarder = hints != null && hints.containsKey(DecodeHintType.TRY_HARDER);
 
-	auto binImg = image.getBlackMatrix();
+	// non-owning (no control block), the image outlives the result
+	auto binImg = std::shared_ptr<const BitMatrix>(std::shared_ptr<const BitMatrix>(), image.getBitMatrix());
 	if (binImg == nullptr) {
 		return DecodeStatus::NotFound;
 	}
 
-	auto barcodeCoordinates = DetectBarcode(*binImg, multiple);
-	if (barcodeCoordinates.empty()) {
-		auto newBits = std::make_shared<BitMatrix>(binImg->copy());
-		newBits->rotate180();
-		binImg = newBits;
-		barcodeCoordinates = DetectBarcode(*binImg, multiple);
+	if (isPure) {
+		std::array<Nullable<ResultPoint>, 8> vertices;
+		if (!DetectPure(*binImg, vertices)) {
+			// an upside down symbol has the mirrored stop pattern on the left
+			auto newBits = std::make_shared<BitMatrix>(binImg->copy());
+			newBits->rotate180();
+			if (!DetectPure(*newBits, vertices))
+				return DecodeStatus::NotFound;
+			binImg = newBits;
+		}
+		result.points = {vertices};
+		result.bits = binImg;
+		return DecodeStatus::NoError;
+	}
+
+	auto runs = image.getRunLengths();
+	auto barcodeCoordinates = DetectBarcode(RowRuns(*runs, false), multiple, scanStride);
+	if (barcodeCoordinates.empty() && !Deadline::Expired()) {
+		barcodeCoordinates = DetectBarcode(RowRuns(*runs, true), multiple, scanStride);
+		// the coordinates refer to the rotated image, which the decoder needs to sample
+		if (!barcodeCoordinates.empty()) {
+			auto newBits = std::make_shared<BitMatrix>(binImg->copy());
+			newBits->rotate180();
+			binImg = newBits;
+		}
 	}
 	if (barcodeCoordinates.empty()) {
 		return DecodeStatus::NotFound;
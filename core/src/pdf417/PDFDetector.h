@@ -48,7 +48,7 @@ public:
 		std::list<std::array<Nullable<ResultPoint>, 8>> points;
 	};
 
-	static DecodeStatus Detect(const BinaryBitmap& image, bool multiple, Result& result);
+	static DecodeStatus Detect(const BinaryBitmap& image, bool multiple, bool isPure, int scanStride, Result& result);
 };
 
 } // Pdf417
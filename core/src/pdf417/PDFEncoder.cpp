@@ -323,28 +323,24 @@ static inline int GetErrorCorrectionCodewordCount(int errorCorrectionLevel)
 */
 static void GenerateErrorCorrection(std::vector<int>& dataCodewords, int errorCorrectionLevel)
 {
+	// The shift register lives directly in the error correction part of dataCodewords, in reverse order: reg[i] holds
+	// the coefficient of x^(k-1-i), which is the order in which the codewords are appended.
 	int k = GetErrorCorrectionCodewordCount(errorCorrectionLevel);
-	std::vector<int> e(k, 0);
-	int sld = (int)dataCodewords.size();
+	int sld = Size(dataCodewords);
+	const short* coefficients = EC_COEFFICIENTS[errorCorrectionLevel];
+	dataCodewords.resize(sld + k, 0);
+	int* reg = dataCodewords.data() + sld;
 	for (int i = 0; i < sld; i++) {
-		int t1 = (dataCodewords[i] + e[k - 1]) % 929;
-		int t2;
-		int t3;
-		for (int j = k - 1; j >= 1; j--) {
-			t2 = (t1 * EC_COEFFICIENTS[errorCorrectionLevel][j]) % 929;
-			t3 = 929 - t2;
-			e[j] = (e[j - 1] + t3) % 929;
-		}
-		t2 = (t1 * EC_COEFFICIENTS[errorCorrectionLevel][0]) % 929;
-		t3 = 929 - t2;
-		e[0] = t3 % 929;
+		int t1 = (dataCodewords[i] + reg[0]) % 929;
+		for (int j = 0; j < k - 1; j++)
+			reg[j] = (reg[j + 1] + 929 - (t1 * coefficients[k - 1 - j]) % 929) % 929;
+		reg[k - 1] = (929 - (t1 * coefficients[0]) % 929) % 929;
 	}
 	for (int j = 0; j < k; ++j) {
-		if (e[j] != 0) {
-			e[j] = 929 - e[j];
+		if (reg[j] != 0) {
+			reg[j] = 929 - reg[j];
 		}
 	}
-	dataCodewords.insert(dataCodewords.end(), e.rbegin(), e.rend());
 }
 
 
@@ -413,8 +409,8 @@ static BarcodeMatrix EncodeLowLevel(const std::vector<int>& fullCodewords, int c
 	int idx = 0;
 	for (int y = 0; y < r; y++) {
 		int cluster = y % 3;
-		logic.startRow();
-		EncodeChar(START_PATTERN, 17, logic.currentRow());
+		BarcodeRow row = logic.row(y);
+		EncodeChar(START_PATTERN, 17, row);
 
 		int left;
 		int right;
@@ -432,21 +428,21 @@ static BarcodeMatrix EncodeLowLevel(const std::vector<int>& fullCodewords, int c
 		}
 
 		int pattern = CODEWORD_TABLE[cluster][left];
-		EncodeChar(pattern, 17, logic.currentRow());
+		EncodeChar(pattern, 17, row);
 
 		for (int x = 0; x < c; x++) {
 			pattern = CODEWORD_TABLE[cluster][fullCodewords[idx]];
-			EncodeChar(pattern, 17, logic.currentRow());
+			EncodeChar(pattern, 17, row);
 			idx++;
 		}
 
 		if (compact) {
-			EncodeChar(STOP_PATTERN, 1, logic.currentRow()); // encodes stop line for compact pdf417
+			EncodeChar(STOP_PATTERN, 1, row); // encodes stop line for compact pdf417
 		}
 		else {
 			pattern = CODEWORD_TABLE[cluster][right];
-			EncodeChar(pattern, 17, logic.currentRow());
-			EncodeChar(STOP_PATTERN, 18, logic.currentRow());
+			EncodeChar(pattern, 17, row);
+			EncodeChar(STOP_PATTERN, 18, row);
 		}
 	}
 	return logic;
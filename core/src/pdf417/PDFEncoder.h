@@ -19,6 +19,9 @@
 #include "PDFCompaction.h"
 #include "ZXContainerAlgorithms.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -27,23 +30,24 @@ namespace ZXing {
 namespace Pdf417 {
 
 /**
+* View of one row of a BarcodeMatrix that the bars are appended to from left to right.
+*
 * @author Jacob Haynes
 */
 class BarcodeRow
 {
-	std::vector<bool> _row;
+	uint8_t* _row = nullptr;
+	int _width = 0;
 	int _currentLocation = 0; // A tacker for position in the bar
 
 public:
-	explicit BarcodeRow(int width = 0) : _row(width, false) {}
-
-	void init(int width) {
-		_row.resize(width, false);
-		_currentLocation = 0;
-	}
+	BarcodeRow() = default;
+	BarcodeRow(uint8_t* row, int width) : _row(row), _width(width) {}
 
 	void set(int x, bool black) {
-		_row.at(x) = black;
+		if (x < 0 || x >= _width)
+			throw std::out_of_range("BarcodeRow::set");
+		_row[x] = black;
 	}
 
 	/**
@@ -51,35 +55,24 @@ public:
 	* @param width How many spots wide the bar is.
 	*/
 	void addBar(bool black, int width) {
-		for (int ii = 0; ii < width; ii++) {
-			_row.at(_currentLocation++) = black;
-		}
-	}
-
-	/**
-	* This function scales the row
-	*
-	* @param scale How much you want the image to be scaled, must be greater than or equal to 1.
-	* @return the scaled row
-	*/
-	void getScaledRow(int scale, std::vector<bool>& output) const {
-		output.resize(_row.size() * scale);
-		for (size_t i = 0; i < output.size(); ++i) {
-			output[i] = _row[i / scale];
-		}
+		if (width < 0 || _currentLocation + width > _width)
+			throw std::out_of_range("BarcodeRow::addBar");
+		std::fill_n(_row + _currentLocation, width, black);
+		_currentLocation += width;
 	}
 };
 
 /**
-* Holds all of the information for a barcode in a format where it can be easily accessable
+* Holds all of the information for a barcode in a format where it can be easily accessable. The modules of all rows
+* are stored in one contiguous buffer with one byte per module, like a BitMatrix with ZX_FAST_BIT_STORAGE.
 *
 * @author Jacob Haynes
 */
 class BarcodeMatrix
 {
-	std::vector<BarcodeRow> _matrix;
+	std::vector<uint8_t> _bits;
 	int _width = 0;
-	int _currentRow = -1;
+	int _height = 0;
 
 public:
 	BarcodeMatrix() {}
@@ -93,37 +86,28 @@ public:
 	}
 
 	void init(int height, int width) {
-		_matrix.resize(height);
-		for (int i = 0; i < height; ++i) {
-			_matrix[i].init((width + 4) * 17 + 1);
-		}
-		_width = width * 17;
-		_currentRow = -1;
+		// start pattern, left and right row indicators and the stop pattern, which is 18 modules wide
+		_width = (width + 4) * 17 + 1;
+		_height = height;
+		_bits.assign(_width * _height, 0);
 	}
 
-	void set(int x, int y, bool value) {
-		_matrix[y].set(x, value);
-	}
+	/// width of a row in modules
+	int width() const { return _width; }
 
-	void startRow() {
-		++_currentRow;
-	}
+	/// number of rows
+	int height() const { return _height; }
 
-	const BarcodeRow& currentRow() const {
-		return _matrix[_currentRow];
+	bool get(int x, int y) const {
+		return _bits[y * _width + x] != 0;
 	}
 
-	BarcodeRow& currentRow() {
-		return _matrix[_currentRow];
+	void set(int x, int y, bool value) {
+		row(y).set(x, value);
 	}
 
-	void getScaledMatrix(int xScale, int yScale, std::vector<std::vector<bool>>& output)
-	{
-		output.resize(_matrix.size() * yScale);
-		int yMax = Size(output);
-		for (int i = 0; i < yMax; i++) {
-			_matrix[i / yScale].getScaledRow(xScale, output[yMax - i - 1]);
-		}
+	BarcodeRow row(int y) {
+		return {_bits.data() + y * _width, _width};
 	}
 };
 
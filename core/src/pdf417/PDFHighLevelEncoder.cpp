@@ -21,11 +21,11 @@
 #include "CharacterSet.h"
 #include "CharacterSetECI.h"
 #include "TextEncoder.h"
-#include "ZXBigInteger.h"
 #include "ZXContainerAlgorithms.h"
 
 #include <cstdint>
 #include <algorithm>
+#include <array>
 #include <string>
 #include <stdexcept>
 
@@ -385,24 +385,38 @@ static void EncodeBinary(const std::string& bytes, int startpos, int count, int
 
 static void EncodeNumeric(const std::wstring& msg, int startpos, int count, std::vector<int>& output)
 {
-	int idx = 0;
-	std::vector<int> tmp;
-	tmp.reserve(count / 3 + 1);
-	BigInteger num900(900);
-	while (idx < count) {
-		tmp.clear();
+	// Each group of up to 44 digits, prefixed with a 1, is converted to base 900. The (at most 45 digit) number is held
+	// in base 10^9 limbs, most significant first, which are divided by 900 until nothing is left.
+	for (int idx = 0; idx < count;) {
 		int len = std::min(44, count - idx);
-		auto part = L"1" + msg.substr(startpos + idx, len);
-
-		BigInteger bigint, r;
-		BigInteger::TryParse(part, bigint);
-		do {
-			BigInteger::Divide(bigint, num900, bigint, r);
-			tmp.push_back(r.toInt());
-		} while (!bigint.isZero());
+		std::array<uint32_t, 5> limbs = {};
+		int numLimbs = (len + 1 + 8) / 9;
+		int limbDigits = (len + 1) - (numLimbs - 1) * 9; // digits in the first limb
+		limbs[0] = 1;
+		--limbDigits;
+		for (int i = 0, limb = 0; i < len; ++i) {
+			if (limbDigits == 0) {
+				++limb;
+				limbDigits = 9;
+			}
+			limbs[limb] = limbs[limb] * 10 + (msg[startpos + idx + i] - '0');
+			--limbDigits;
+		}
 
-		//Reverse temporary string
-		output.insert(output.end(), tmp.rbegin(), tmp.rend());
+		std::array<int, 16> codewords; // 10^45 < 900^16
+		int numCodewords = 0;
+		for (int first = 0; first < numLimbs;) {
+			uint64_t remainder = 0;
+			for (int i = first; i < numLimbs; ++i) {
+				uint64_t current = remainder * 1000000000 + limbs[i];
+				limbs[i] = static_cast<uint32_t>(current / 900);
+				remainder = current % 900;
+			}
+			codewords[numCodewords++] = static_cast<int>(remainder);
+			while (first < numLimbs && limbs[first] == 0)
+				++first;
+		}
+		output.insert(output.end(), codewords.rend() - numCodewords, codewords.rend());
 		idx += len;
 	}
 }
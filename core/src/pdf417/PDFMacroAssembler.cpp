@@ -0,0 +1,100 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "PDFMacroAssembler.h"
+#include "PDFDecoderResultExtra.h"
+#include "ZXContainerAlgorithms.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace ZXing {
+namespace Pdf417 {
+
+// A Macro PDF417 file consists of at most 99999 segments.
+static const int MAX_SEGMENT_COUNT = 99999;
+
+MacroAssembler::MacroAssembler(int maxPendingFiles) : _maxPendingFiles(std::max(maxPendingFiles, 1))
+{
+	_files.reserve(_maxPendingFiles);
+}
+
+bool MacroAssembler::hasSegment(const std::string& fileId, int segmentIndex) const
+{
+	return std::any_of(_files.begin(), _files.end(), [&](const File& f) {
+		return f.fileId == fileId && f.segments.count(segmentIndex) != 0;
+	});
+}
+
+Result MacroAssembler::add(const Result& result)
+{
+	if (!result.isValid() || result.format() != BarcodeFormat::PDF_417)
+		return Result(DecodeStatus::NotFound);
+
+	auto customData = result.metadata().getCustomData(ResultMetadata::PDF417_EXTRA_METADATA);
+	auto extra = std::dynamic_pointer_cast<DecoderResultExtra>(customData);
+	if (!extra || extra->fileId().empty())
+		return Result(DecodeStatus::NotFound);
+
+	int segmentIndex = extra->segmentIndex();
+	int segmentCount = extra->segmentCount() > 0 ? extra->segmentCount() : -1;
+	if (segmentCount < 0 && extra->isLastSegment())
+		segmentCount = segmentIndex + 1;
+	if (segmentIndex < 0 || segmentCount > MAX_SEGMENT_COUNT || segmentIndex >= (segmentCount > 0 ? segmentCount : MAX_SEGMENT_COUNT))
+		return Result(DecodeStatus::NotFound);
+
+	auto file = FindIf(_files, [&extra](const File& f) { return f.fileId == extra->fileId(); });
+	if (file != _files.end() && file->segmentCount > 0 && segmentCount > 0 && file->segmentCount != segmentCount) {
+		// Same file ID but a different length: this is a different file, start over.
+		_files.erase(file);
+		file = _files.end();
+	}
+	if (file == _files.end()) {
+		if (Size(_files) >= _maxPendingFiles)
+			_files.erase(std::min_element(_files.begin(), _files.end(), [](const File& a, const File& b) {
+				return a.lastUpdate < b.lastUpdate;
+			}));
+		_files.push_back({extra->fileId(), -1, 0, {}, nullptr});
+		file = _files.end() - 1;
+	}
+
+	file->lastUpdate = ++_updateCounter;
+	if (file->segmentCount > 0 && segmentIndex >= file->segmentCount)
+		return Result(DecodeStatus::NotFound);
+	if (!file->segments.emplace(segmentIndex, result.text()).second)
+		return Result(DecodeStatus::NotFound);
+	if (segmentCount > 0)
+		file->segmentCount = segmentCount;
+	if (segmentIndex == 0)
+		file->firstSegmentExtra = customData;
+	// the segments are keyed by their index, so the file is complete once the last index is there and nothing is missing
+	if (file->segmentCount < 0 || Size(file->segments) != file->segmentCount
+		|| file->segments.rbegin()->first != file->segmentCount - 1)
+		return Result(DecodeStatus::NotFound);
+
+	std::wstring text;
+	for (const auto& segment : file->segments)
+		text.append(segment.second);
+	auto firstSegmentExtra = std::move(file->firstSegmentExtra);
+	_files.erase(file);
+
+	Result res(std::move(text), {}, BarcodeFormat::PDF_417);
+	res.metadata().put(ResultMetadata::PDF417_EXTRA_METADATA, firstSegmentExtra);
+	return res;
+}
+
+} // Pdf417
+} // ZXing
@@ -0,0 +1,81 @@
+#pragma once
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "Result.h"
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ZXing {
+
+class CustomData;
+
+namespace Pdf417 {
+
+/**
+* Combines the segments of Macro PDF417 files (see Annex H of ISO/IEC 15438:2015) that arrive one at a time, e.g. from
+* the results of one image with several symbols or from consecutive frames of a video.
+*
+* Pending files are identified by their file ID. The number of segments is taken from the optional segment count
+* field or else from the segment that is marked as the last one. At most "maxPendingFiles" files are kept, the one that
+* got updated least recently is dropped to make room for a new one. Segments that were already received are ignored.
+*/
+class MacroAssembler
+{
+public:
+	explicit MacroAssembler(int maxPendingFiles = 4);
+
+	/**
+	* Add a decoded symbol. Invalid results and results without a Macro PDF417 control block are ignored.
+	* @return the combined result once the last missing segment of a file has been added, a Result with
+	*   DecodeStatus::NotFound otherwise. Its PDF417_EXTRA_METADATA is the one of the first segment. The completed
+	*   file is removed from the pending ones.
+	*/
+	Result add(const Result& result);
+
+	/**
+	* @return true if the segment with the given file ID and index is part of a pending file
+	*/
+	bool hasSegment(const std::string& fileId, int segmentIndex) const;
+
+	int pendingFiles() const { return static_cast<int>(_files.size()); }
+
+	/**
+	* Drop all pending files.
+	*/
+	void clear() { _files.clear(); }
+
+private:
+	struct File
+	{
+		std::string fileId;
+		int segmentCount; // -1 while unknown
+		uint64_t lastUpdate;
+		std::map<int, std::wstring> segments;
+		std::shared_ptr<CustomData> firstSegmentExtra;
+	};
+
+	int _maxPendingFiles;
+	uint64_t _updateCounter = 0;
+	std::vector<File> _files;
+};
+
+} // Pdf417
+} // ZXing
@@ -50,12 +50,16 @@ public:
 
 	ModulusPoly buildMonomial(int degree, int coefficient) const;
 
+	// add, subtract and multiply avoid the '%' modulo operator, see GenericGF::multiply. The arguments are field
+	// elements, i.e. in [0, size()), so one conditional subtraction is enough.
 	int add(int a, int b) const {
-		return (a + b) % _modulus;
+		int sum = a + b;
+		return sum < _modulus ? sum : sum - _modulus;
 	}
 
 	int subtract(int a, int b) const {
-		return (_modulus + a - b) % _modulus;
+		int diff = a - b;
+		return diff < 0 ? diff + _modulus : diff;
 	}
 
 	int exp(int a) const {
@@ -80,7 +84,8 @@ public:
 		if (a == 0 || b == 0) {
 			return 0;
 		}
-		return _expTable[(_logTable[a] + _logTable[b]) % (_modulus - 1)];
+		int log = _logTable[a] + _logTable[b];
+		return _expTable[log < _modulus - 1 ? log : log - (_modulus - 1)];
 	}
 
 	int size() const {
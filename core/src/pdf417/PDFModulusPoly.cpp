@@ -20,30 +20,27 @@
 
 #include <algorithm>
 #include <stdexcept>
+#include <utility>
 
 namespace ZXing {
 namespace Pdf417 {
 
 ModulusPoly::ModulusPoly(const ModulusGF& field, const std::vector<int>& coefficients) :
-	_field(&field)
+	ModulusPoly(field, std::vector<int>(coefficients))
 {
-	size_t coefficientsLength = coefficients.size();
-	if (coefficientsLength > 1 && coefficients[0] == 0) {
-		// Leading term must be non-zero for anything except the constant polynomial "0"
-		size_t firstNonZero = 1;
-		while (firstNonZero < coefficientsLength && coefficients[firstNonZero] == 0) {
-			firstNonZero++;
-		}
-		if (firstNonZero == coefficientsLength) {
-			_coefficients.resize(1, 0);
-		}
-		else {
-			_coefficients.resize(coefficientsLength - firstNonZero);
-			std::copy(coefficients.begin() + firstNonZero, coefficients.end(), _coefficients.begin());
-		}
+}
+
+ModulusPoly::ModulusPoly(const ModulusGF& field, std::vector<int>&& coefficients) :
+	_field(&field),
+	_coefficients(std::move(coefficients))
+{
+	// Leading term must be non-zero for anything except the constant polynomial "0"
+	auto firstNonZero = std::find_if(_coefficients.begin(), _coefficients.end(), [](int c) { return c != 0; });
+	if (firstNonZero == _coefficients.end()) {
+		_coefficients.resize(1, 0);
 	}
 	else {
-		_coefficients = coefficients;
+		_coefficients.erase(_coefficients.begin(), firstNonZero);
 	}
 }
 
@@ -192,20 +189,33 @@ ModulusPoly::divide(const ModulusPoly& other, ModulusPoly& quotient, ModulusPoly
 		throw std::invalid_argument("Divide by 0");
 	}
 
-	quotient = _field->zero();
-	remainder = *this;
+	int otherDegree = other.degree();
+	if (degree() < otherDegree || isZero()) {
+		quotient = _field->zero();
+		remainder = *this;
+		return;
+	}
 
-	int denominatorLeadingTerm = other.coefficient(other.degree());
+	int denominatorLeadingTerm = other.coefficient(otherDegree);
 	int inverseDenominatorLeadingTerm = _field->inverse(denominatorLeadingTerm);
 
-	while (remainder.degree() >= other.degree() && !remainder.isZero()) {
-		int degreeDifference = remainder.degree() - other.degree();
-		int scale = _field->multiply(remainder.coefficient(remainder.degree()), inverseDenominatorLeadingTerm);
-		ModulusPoly term = other.multiplyByMonomial(degreeDifference, scale);
-		ModulusPoly iterationQuotient = _field->buildMonomial(degreeDifference, scale);
-		quotient = quotient.add(iterationQuotient);
-		remainder = remainder.subtract(term);
+	// Long division in place on the coefficients, each step cancels the leading term of the remainder without
+	// building the intermediate polynomials.
+	std::vector<int> rem = _coefficients;
+	std::vector<int> quo(rem.size() - otherDegree, 0);
+	for (size_t i = 0; i < quo.size(); i++) {
+		int scale = _field->multiply(rem[i], inverseDenominatorLeadingTerm);
+		if (scale == 0) {
+			continue;
+		}
+		quo[i] = scale;
+		rem[i] = 0;
+		for (int j = 1; j <= otherDegree; j++) {
+			rem[i + j] = _field->subtract(rem[i + j], _field->multiply(other._coefficients[j], scale));
+		}
 	}
+	quotient = ModulusPoly(*_field, std::move(quo));
+	remainder = ModulusPoly(*_field, std::move(rem));
 }
 
 
@@ -41,6 +41,7 @@ public:
 	ModulusPoly() = default;
 
 	ModulusPoly(const ModulusGF& field, const std::vector<int>& coefficients);
+	ModulusPoly(const ModulusGF& field, std::vector<int>&& coefficients);
 
 	const std::vector<int>& coefficients() const {
 		return _coefficients;
@@ -20,14 +20,19 @@
 #include "PDFScanningDecoder.h"
 #include "PDFCodewordDecoder.h"
 #include "PDFDecoderResultExtra.h"
+#include "DecodeHints.h"
+#include "DecodeStats.h"
 #include "DecodeStatus.h"
 #include "DecoderResult.h"
 #include "Result.h"
+#include "Trace.h"
+#include "ZXContainerAlgorithms.h"
 
 #include <vector>
 #include <cstdlib>
 #include <algorithm>
 #include <limits>
+#include <iterator>
 #include <utility>
 
 namespace ZXing {
@@ -64,10 +69,10 @@ static int GetMaxCodewordWidth(const std::array<Nullable<ResultPoint>, 8>& p)
 					std::max(GetMaxWidth(p[1], p[5]), GetMaxWidth(p[7], p[3]) * CodewordDecoder::MODULES_IN_CODEWORD / MODULES_IN_STOP_PATTERN));
 }
 
-DecodeStatus DoDecode(const BinaryBitmap& image, bool multiple, std::list<Result>& results)
+DecodeStatus DoDecode(const BinaryBitmap& image, bool multiple, bool isPure, int scanStride, std::list<Result>& results)
 {
 	Detector::Result detectorResult;
-	DecodeStatus status = Detector::Detect(image, multiple, detectorResult);
+	DecodeStatus status = Detector::Detect(image, multiple, isPure, scanStride, detectorResult);
 	if (StatusIsError(status)) {
 		return status;
 	}
@@ -95,22 +100,40 @@ DecodeStatus DoDecode(const BinaryBitmap& image, bool multiple, std::list<Result
 	return results.empty() ? DecodeStatus::NotFound : DecodeStatus::NoError;
 }
 
+Reader::Reader(const DecodeHints& hints) : _isPure(hints.isPure()), _scanStride(hints.scanStride()) {}
+
 Result
 Reader::decode(const BinaryBitmap& image) const
 {
+	ZX_TRACE_SCOPE("Pdf417::Reader::decode");
+	DecodeStats::ReaderTimer readerTimer(DecodeStats::ReaderType::PDF417);
+	DecodeStats::StageTimer detectTimer(DecodeStats::Stage::Detect);
 	std::list<Result> results;
-	DecodeStatus status = DoDecode(image, false, results);
+	DecodeStatus status = DoDecode(image, false, _isPure, _scanStride, results);
 	if (StatusIsOK(status)) {
 		return results.front();
 	}
 	return Result(status);
 }
 
+Results
+Reader::decode(const BinaryBitmap& image, int maxSymbols) const
+{
+	ZX_TRACE_SCOPE("Pdf417::Reader::decode");
+	DecodeStats::ReaderTimer readerTimer(DecodeStats::ReaderType::PDF417);
+	DecodeStats::StageTimer detectTimer(DecodeStats::Stage::Detect);
+	std::list<Result> results;
+	DoDecode(image, true, _isPure, _scanStride, results);
+	if (Size(results) > maxSymbols)
+		results.erase(std::next(results.begin(), maxSymbols), results.end());
+	return {std::make_move_iterator(results.begin()), std::make_move_iterator(results.end())};
+}
+
 std::list<Result>
 Reader::decodeMultiple(const BinaryBitmap& image) const
 {
 	std::list<Result> results;
-	DoDecode(image, true, results);
+	DoDecode(image, true, _isPure, _scanStride, results);
 	return results;
 }
 
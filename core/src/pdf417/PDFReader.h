@@ -20,6 +20,9 @@
 #include <list>
 
 namespace ZXing {
+
+class DecodeHints;
+
 namespace Pdf417 {
 
 /**
@@ -29,8 +32,13 @@ namespace Pdf417 {
 */
 class Reader : public ZXing::Reader
 {
+	bool _isPure = false;
+	int _scanStride = 1;
 public:
+	Reader() = default;
+	explicit Reader(const DecodeHints& hints);
 	Result decode(const BinaryBitmap& image) const override;
+	Results decode(const BinaryBitmap& image, int maxSymbols) const override;
 	std::list<Result> decodeMultiple(const BinaryBitmap& image) const;
 };
 
@@ -27,14 +27,18 @@
 #include "ResultPoint.h"
 #include "ZXNullable.h"
 #include "BitMatrix.h"
+#include "DecodeStats.h"
 #include "DecodeStatus.h"
 #include "DecoderResult.h"
+#include "Trace.h"
 #include "ZXTestSupport.h"
+#include "ZXContainerAlgorithms.h"
 
 #include <cstdlib>
 #include <numeric>
 #include <array>
 #include <algorithm>
+#include <utility>
 
 namespace ZXing {
 namespace Pdf417 {
@@ -321,12 +325,26 @@ static int GetStartColumn(const DetectionResult& detectionResult, int barcodeCol
 	return leftToRight ? detectionResult.getBoundingBox().value().minX() : detectionResult.getBoundingBox().value().maxX();
 }
 
-static std::vector<std::vector<BarcodeValue>> CreateBarcodeMatrix(DetectionResult& detectionResult)
+/**
+* The values detected for each codeword of the symbol, row by row and including the two row indicator columns, in one
+* block sized from the barcode metadata.
+*/
+class BarcodeValueMatrix
 {
-	std::vector<std::vector<BarcodeValue>> barcodeMatrix(detectionResult.barcodeRowCount());
-	for (auto& row : barcodeMatrix) {
-		row.resize(detectionResult.barcodeColumnCount() + 2);
-	}
+	int _columns;
+	std::vector<BarcodeValue> _values;
+
+public:
+	BarcodeValueMatrix(int rows, int columns) : _columns(columns), _values(rows * columns) {}
+
+	int rows() const { return Size(_values) / _columns; }
+
+	BarcodeValue& operator()(int row, int column) { return _values[row * _columns + column]; }
+};
+
+static BarcodeValueMatrix CreateBarcodeMatrix(DetectionResult& detectionResult)
+{
+	BarcodeValueMatrix barcodeMatrix(detectionResult.barcodeRowCount(), detectionResult.barcodeColumnCount() + 2);
 
 	int column = 0;
 	for (auto& resultColumn : detectionResult.allColumns()) {
@@ -335,11 +353,11 @@ static std::vector<std::vector<BarcodeValue>> CreateBarcodeMatrix(DetectionResul
 				if (codeword != nullptr) {
 					int rowNumber = codeword.value().rowNumber();
 					if (rowNumber >= 0) {
-						if (rowNumber >= (int)barcodeMatrix.size()) {
+						if (rowNumber >= barcodeMatrix.rows()) {
 							// We have more rows than the barcode metadata allows for, ignore them.
 							continue;
 						}
-						barcodeMatrix[rowNumber][column].setValue(codeword.value().value());
+						barcodeMatrix(rowNumber, column).setValue(codeword.value().value());
 					}
 				}
 			}
@@ -354,19 +372,19 @@ static int GetNumberOfECCodeWords(int barcodeECLevel)
 	return 2 << barcodeECLevel;
 }
 
-static bool AdjustCodewordCount(const DetectionResult& detectionResult, std::vector<std::vector<BarcodeValue>>& barcodeMatrix)
+static bool AdjustCodewordCount(const DetectionResult& detectionResult, BarcodeValueMatrix& barcodeMatrix)
 {
-	auto numberOfCodewords = barcodeMatrix[0][1].value();
+	auto numberOfCodewords = barcodeMatrix(0, 1).value();
 	int calculatedNumberOfCodewords = detectionResult.barcodeColumnCount() * detectionResult.barcodeRowCount() - GetNumberOfECCodeWords(detectionResult.barcodeECLevel());
 	if (numberOfCodewords.empty()) {
 		if (calculatedNumberOfCodewords < 1 || calculatedNumberOfCodewords > CodewordDecoder::MAX_CODEWORDS_IN_BARCODE) {
 			return false;
 		}
-		barcodeMatrix[0][1].setValue(calculatedNumberOfCodewords);
+		barcodeMatrix(0, 1).setValue(calculatedNumberOfCodewords);
 	}
 	else if (numberOfCodewords[0] != calculatedNumberOfCodewords) {
 		// The calculated one is more reliable as it is derived from the row indicator columns
-		barcodeMatrix[0][1].setValue(calculatedNumberOfCodewords);
+		barcodeMatrix(0, 1).setValue(calculatedNumberOfCodewords);
 	}
 	return true;
 }
@@ -404,16 +422,8 @@ static bool RunEuclideanAlgorithm(ModulusPoly a, ModulusPoly b, int R, ModulusPo
 			// Oops, Euclidean algorithm already terminated?
 			return false;
 		}
-		r = rLastLast;
-		ModulusPoly q = field.zero();
-		int denominatorLeadingTerm = rLast.coefficient(rLast.degree());
-		int dltInverse = field.inverse(denominatorLeadingTerm);
-		while (r.degree() >= rLast.degree() && !r.isZero()) {
-			int degreeDiff = r.degree() - rLast.degree();
-			int scale = field.multiply(r.coefficient(r.degree()), dltInverse);
-			q = q.add(field.buildMonomial(degreeDiff, scale));
-			r = r.subtract(rLast.multiplyByMonomial(degreeDiff, scale));
-		}
+		ModulusPoly q;
+		rLastLast.divide(rLast, q, r);
 
 		t = q.multiply(tLast).subtract(tLastLast).negative();
 	}
@@ -474,16 +484,36 @@ static std::vector<int> FindErrorMagnitudes(const ModulusPoly& errorEvaluator, c
 * @throws ChecksumException if errors cannot be corrected, maybe because of too many errors
 */
 ZXING_EXPORT_TEST_ONLY
-bool DecodeErrorCorrection(std::vector<int>& received, int numECCodewords, const std::vector<int>& erasures, int& nbErrors)
+bool DecodeErrorCorrection(std::vector<int>& received, int numECCodewords, const std::vector<int>& /*erasures*/, int& nbErrors)
 {
 	const ModulusGF& field = GetModulusGF();
-	ModulusPoly poly(field, received);
+	const int order = field.size() - 1; // of the multiplicative group, exp(order) == 1
+	int receivedSize = Size(received);
+
+	// The syndromes are the received polynomial evaluated at exp(i) for i = numECCodewords..1. Instead of Horner's
+	// scheme per syndrome, the terms received[j] * exp(i * (receivedSize - 1 - j)) are summed up in the log domain,
+	// so each term costs one table lookup and the sum only needs to be reduced once per syndrome.
+	std::vector<int> logReceived(receivedSize);
+	for (int j = 0; j < receivedSize; j++) {
+		logReceived[j] = received[j] == 0 ? -1 : field.log(received[j]);
+	}
 	std::vector<int> S(numECCodewords);
 	bool error = false;
 	for (int i = numECCodewords; i > 0; i--) {
-		int eval = poly.evaluateAt(field.exp(i));
-		S[numECCodewords - i] = eval;
-		if (eval != 0) {
+		int exponent = (i * (receivedSize - 1)) % order;
+		int sum = 0;
+		for (int logCoefficient : logReceived) {
+			if (logCoefficient >= 0) {
+				int log = logCoefficient + exponent;
+				sum += field.exp(log < order ? log : log - order);
+			}
+			exponent -= i;
+			if (exponent < 0) {
+				exponent += order;
+			}
+		}
+		S[numECCodewords - i] = sum % field.size();
+		if (S[numECCodewords - i] != 0) {
 			error = true;
 		}
 	}
@@ -493,24 +523,15 @@ bool DecodeErrorCorrection(std::vector<int>& received, int numECCodewords, const
 		return true;
 	}
 
-	ModulusPoly knownErrors = field.one();
-	for (int erasure : erasures) {
-		int b = field.exp(Size(received) - 1 - erasure);
-		// Add (1 - bx) term:
-		ModulusPoly term(field, { field.subtract(0, b), 1 });
-		knownErrors = knownErrors.multiply(term);
-	}
-
-	ModulusPoly syndrome(field, S);
-	//syndrome = syndrome.multiply(knownErrors);
+	// The erasures are not taken into account (yet). That would mean multiplying the syndrome and sigma below with
+	// the product of the (1 - bx) terms of the erasure positions, b = exp(receivedSize - 1 - erasure).
+	ModulusPoly syndrome(field, std::move(S));
 
 	ModulusPoly sigma, omega;
 	if (!RunEuclideanAlgorithm(field.buildMonomial(numECCodewords, 1), syndrome, numECCodewords, sigma, omega)) {
 		return false;
 	}
 
-	//sigma = sigma.multiply(knownErrors);
-
 	std::vector<int> errorLocations;
 	if (!FindErrorLocations(sigma, errorLocations)) {
 		return false;
@@ -518,7 +539,6 @@ bool DecodeErrorCorrection(std::vector<int>& received, int numECCodewords, const
 
 	std::vector<int> errorMagnitudes = FindErrorMagnitudes(omega, sigma, errorLocations);
 
-	int receivedSize = Size(received);
 	for (size_t i = 0; i < errorLocations.size(); i++) {
 		int position = receivedSize - 1 - field.log(errorLocations[i]);
 		if (position < 0) {
@@ -549,7 +569,11 @@ static bool CorrectErrors(std::vector<int>& codewords, const std::vector<int>& e
 		// Too many errors or EC Codewords is corrupted
 		return false;
 	}
-	return DecodeErrorCorrection(codewords, numECCodewords, erasures, errorCount);
+	DecodeStats::StageTimer timer(DecodeStats::Stage::ErrorCorrection);
+	if (!DecodeErrorCorrection(codewords, numECCodewords, erasures, errorCount))
+		return false;
+	DecodeStats::AddErrorsCorrected(errorCount);
+	return true;
 }
 
 /**
@@ -664,7 +688,7 @@ static DecoderResult CreateDecoderResult(DetectionResult& detectionResult)
 	std::vector<int> ambiguousIndexesList;
 	for (int row = 0; row < detectionResult.barcodeRowCount(); row++) {
 		for (int column = 0; column < detectionResult.barcodeColumnCount(); column++) {
-			auto values = barcodeMatrix[row][column + 1].value();
+			auto values = barcodeMatrix(row, column + 1).value();
 			int codewordIndex = row * detectionResult.barcodeColumnCount() + column;
 			if (values.empty()) {
 				erasures.push_back(codewordIndex);
@@ -691,6 +715,7 @@ ScanningDecoder::Decode(const BitMatrix& image, const Nullable<ResultPoint>& ima
 	const Nullable<ResultPoint>& imageTopRight, const Nullable<ResultPoint>& imageBottomRight,
 	int minCodewordWidth, int maxCodewordWidth)
 {
+	ZX_TRACE_SCOPE("Pdf417::ScanningDecoder::Decode");
 	BoundingBox boundingBox;
 	if (!BoundingBox::Create(image.width(), image.height(), imageTopLeft, imageBottomLeft, imageTopRight, imageBottomRight, boundingBox)) {
 		return DecodeStatus::NotFound;
@@ -718,10 +743,10 @@ ScanningDecoder::Decode(const BitMatrix& image, const Nullable<ResultPoint>& ima
 	}
 
 	int maxBarcodeColumn = detectionResult.barcodeColumnCount() + 1;
-	detectionResult.setColumn(0, leftRowIndicatorColumn);
-	detectionResult.setColumn(maxBarcodeColumn, rightRowIndicatorColumn);
-
 	bool leftToRight = leftRowIndicatorColumn != nullptr;
+	detectionResult.setColumn(0, std::move(leftRowIndicatorColumn));
+	detectionResult.setColumn(maxBarcodeColumn, std::move(rightRowIndicatorColumn));
+
 	for (int barcodeColumnCount = 1; barcodeColumnCount <= maxBarcodeColumn; barcodeColumnCount++) {
 		int barcodeColumn = leftToRight ? barcodeColumnCount : maxBarcodeColumn - barcodeColumnCount;
 		if (detectionResult.column(barcodeColumn) != nullptr) {
@@ -35,44 +35,27 @@ static const int WHITE_SPACE = 30;
 static const int DEFAULT_ERROR_CORRECTION_LEVEL = 2;
 
 /**
-* Takes and rotates the it 90 degrees
+* Renders the barcode scaled by xScale and yScale, optionally rotated by 90 degrees, into a BitMatrix with a white
+* border of the given margin. Each horizontal run of black modules is filled in one go.
 */
-static void RotateArray(const std::vector<std::vector<bool>>& input, std::vector<std::vector<bool>>& output)
+static BitMatrix RenderScaled(const BarcodeMatrix& matrix, int xScale, int yScale, bool rotated, int margin)
 {
-	size_t height = input.size();
-	size_t width = input[0].size();
-	output.resize(width);
-	for (size_t i = 0; i < width; ++i) {
-		output[i].resize(height);
-	}
-	for (size_t ii = 0; ii < height; ++ii) {
-		// This makes the direction consistent on screen when rotating the screen
-		size_t inverseii = height - ii - 1;
-		for (size_t jj = 0; jj < width; ++jj) {
-			output[jj][inverseii] = input[ii][jj];
-		}
-	}
-}
-
-/**
-* This takes an array holding the values of the PDF 417
-*
-* @param input a byte array of information with 0 is black, and 1 is white
-* @param margin border around the barcode
-* @return BitMatrix of the input
-*/
-static BitMatrix BitMatrixFromBitArray(const std::vector<std::vector<bool>>& input, int margin)
-{
-	// Creates the bitmatrix with extra space for whitespace
-	int width = Size(input[0]);
-	int height = Size(input);
-	BitMatrix result(width + 2 * margin, height + 2 * margin);
-	for (int y = 0, yOutput = static_cast<int>(result.height()) - margin - 1; y < height; y++, yOutput--) {
-		for (int x = 0; x < width; ++x) {
-			// Zero is white in the bytematrix
-			if (input[y][x]) {
-				result.set(x + margin, yOutput);
-			}
+	// size of the scaled barcode before the rotation
+	int width = matrix.width() * xScale;
+	int height = matrix.height() * yScale;
+	BitMatrix result = rotated ? BitMatrix(height + 2 * margin, width + 2 * margin)
+							   : BitMatrix(width + 2 * margin, height + 2 * margin);
+	for (int y = 0; y < matrix.height(); ++y) {
+		for (int x = 0, end = 0; x < matrix.width(); x = end) {
+			for (end = x + 1; end < matrix.width() && matrix.get(end, y) == matrix.get(x, y); ++end)
+				;
+			if (!matrix.get(x, y))
+				continue;
+			// This makes the direction consistent on screen when rotating the screen
+			if (rotated)
+				result.setRegion(margin + y * yScale, margin + width - end * xScale, yScale, (end - x) * xScale);
+			else
+				result.setRegion(margin + x * xScale, margin + y * yScale, (end - x) * xScale, yScale);
 		}
 	}
 	return result;
@@ -86,18 +69,14 @@ Writer::encode(const std::wstring& contents, int width, int height) const
 
 	BarcodeMatrix resultMatrix = _encoder->generateBarcodeLogic(contents, ecLevel);
 	int aspectRatio = 4;
-	std::vector<std::vector<bool>> originalScale;
-	resultMatrix.getScaledMatrix(1, aspectRatio, originalScale);
-	bool rotated = false;
-	if ((height > width) != (originalScale[0].size() < originalScale.size())) {
-		std::vector<std::vector<bool>> temp;
-		RotateArray(originalScale, temp);
-		originalScale = temp;
-		rotated = true;
-	}
+	int originalWidth = resultMatrix.width();
+	int originalHeight = resultMatrix.height() * aspectRatio;
+	bool rotated = (height > width) != (originalWidth < originalHeight);
+	if (rotated)
+		std::swap(originalWidth, originalHeight);
 
-	int scaleX = width / Size(originalScale[0]);
-	int scaleY = height / Size(originalScale);
+	int scaleX = width / originalWidth;
+	int scaleY = height / originalHeight;
 
 	int scale;
 	if (scaleX < scaleY) {
@@ -106,20 +85,10 @@ Writer::encode(const std::wstring& contents, int width, int height) const
 	else {
 		scale = scaleY;
 	}
+	if (scale < 1)
+		scale = 1;
 
-	if (scale > 1) {
-		std::vector<std::vector<bool>> scaledMatrix;
-		resultMatrix.getScaledMatrix(scale, scale * aspectRatio, scaledMatrix);
-		if (rotated) {
-			std::vector<std::vector<bool>> temp;
-			RotateArray(scaledMatrix, temp);
-			scaledMatrix = temp;
-		}
-		return BitMatrixFromBitArray(scaledMatrix, margin);
-	}
-	else {
-		return BitMatrixFromBitArray(originalScale, margin);
-	}
+	return RenderScaled(resultMatrix, scale, scale * aspectRatio, rotated, margin);
 }
 
 Writer::Writer()
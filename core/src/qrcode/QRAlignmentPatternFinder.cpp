@@ -146,13 +146,15 @@ HandlePossibleCenter(const BitMatrix& image, const StateCount& stateCount, int i
 	return {};
 }
 
-AlignmentPattern
-AlignmentPatternFinder::Find(const BitMatrix& image, int startX, int startY, int width, int height, float moduleSize)
+/**
+* Runs the horizontal 1:1:1 scan over the given region, starting from the middle row outwards, and calls
+* "onCrossing(stateCount, i, j)" for every crossing with the right proportions. Stops when it returns true.
+*/
+template <typename F>
+static void ScanRegion(const BitMatrix& image, int startX, int startY, int width, int height, float moduleSize, F onCrossing)
 {
 	int maxJ = startX + width;
 	int middleI = startY + (height / 2);
-	std::vector<AlignmentPattern> possibleCenters;
-	possibleCenters.reserve(5);
 
 	// We are looking for black/white/black modules in 1:1:1 ratio;
 	// this tracks the number of black/white/black modules seen so far
@@ -177,9 +179,8 @@ AlignmentPatternFinder::Find(const BitMatrix& image, int startX, int startY, int
 				else { // Counting white pixels
 					if (currentState == 2) { // A winner?
 						if (FoundPatternCross(stateCount, moduleSize)) { // Yes
-							auto result = HandlePossibleCenter(image, stateCount, i, j, moduleSize, possibleCenters);
-							if (result.isValid())
-								return result;
+							if (onCrossing(stateCount, i, j))
+								return;
 						}
 						stateCount[0] = stateCount[2];
 						stateCount[1] = 1;
@@ -200,12 +201,26 @@ AlignmentPatternFinder::Find(const BitMatrix& image, int startX, int startY, int
 			j++;
 		}
 		if (FoundPatternCross(stateCount, moduleSize)) {
-			auto result = HandlePossibleCenter(image, stateCount, i, maxJ, moduleSize, possibleCenters);
-			if (result.isValid())
-				return result;
+			if (onCrossing(stateCount, i, maxJ))
+				return;
 		}
 
 	}
+}
+
+AlignmentPattern
+AlignmentPatternFinder::Find(const BitMatrix& image, int startX, int startY, int width, int height, float moduleSize)
+{
+	std::vector<AlignmentPattern> possibleCenters;
+	possibleCenters.reserve(5);
+	AlignmentPattern result;
+
+	ScanRegion(image, startX, startY, width, height, moduleSize, [&](const StateCount& stateCount, int i, int j) {
+		result = HandlePossibleCenter(image, stateCount, i, j, moduleSize, possibleCenters);
+		return result.isValid();
+	});
+	if (result.isValid())
+		return result;
 
 	// Hmm, nothing we saw was observed and confirmed twice. If we had
 	// any guess at all, return it.
@@ -216,5 +231,29 @@ AlignmentPatternFinder::Find(const BitMatrix& image, int startX, int startY, int
 	return {};
 }
 
+std::vector<AlignmentPatternFinder::Candidate>
+AlignmentPatternFinder::FindAll(const BitMatrix& image, int startX, int startY, int width, int height, float moduleSize)
+{
+	std::vector<Candidate> candidates;
+
+	ScanRegion(image, startX, startY, width, height, moduleSize, [&](const StateCount& stateCount, int i, int j) {
+		int stateCountTotal = Reduce(stateCount);
+		float centerJ = CenterFromEnd(stateCount, j);
+		float centerI = CrossCheckVertical(image, i, static_cast<int>(centerJ), 2 * stateCount[1], stateCountTotal, moduleSize);
+		if (!std::isnan(centerI)) {
+			float estimatedModuleSize = stateCountTotal / 3.0f;
+			auto c = FindIf(candidates, [&](const Candidate& c) { return c.pattern.aboutEquals(estimatedModuleSize, centerI, centerJ); });
+			if (c == candidates.end())
+				candidates.push_back({{centerJ, centerI, estimatedModuleSize}, 1});
+			else if (c->count++ == 1)
+				// Same estimate Find() returns when confirming this pattern
+				c->pattern = c->pattern.combineEstimate(centerI, centerJ, estimatedModuleSize);
+		}
+		return false;
+	});
+
+	return candidates;
+}
+
 } // QRCode
 } // ZXing
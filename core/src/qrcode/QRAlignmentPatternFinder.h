@@ -16,14 +16,16 @@
 * limitations under the License.
 */
 
+#include "QRAlignmentPattern.h"
+
+#include <vector>
+
 namespace ZXing {
 
 class BitMatrix;
 
 namespace QRCode {
 
-class AlignmentPattern;
-
 /**
 * <p>This class attempts to find alignment patterns in a QR Code. Alignment patterns look like finder
 * patterns but are smaller and appear at regular intervals throughout the image.</p>
@@ -55,6 +57,19 @@ public:
 	* @throws NotFoundException if not found
 	*/
 	static AlignmentPattern Find(const BitMatrix& image, int startX, int startY, int width, int height, float moduleSize);
+
+	struct Candidate
+	{
+		AlignmentPattern pattern;
+		int count; // number of rows the pattern was seen on
+	};
+
+	/**
+	* Same scan as {@link Find} but it does not stop at the first pattern confirmed on a second row. Instead it
+	* returns every possible pattern of the region, so that the caller can answer the question for any sub-region
+	* without scanning again.
+	*/
+	static std::vector<Candidate> FindAll(const BitMatrix& image, int startX, int startY, int width, int height, float moduleSize);
 };
 
 } // QRCode
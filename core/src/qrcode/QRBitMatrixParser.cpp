@@ -18,6 +18,7 @@
 #include "QRBitMatrixParser.h"
 #include "QRVersion.h"
 #include "QRFormatInformation.h"
+#include "QRDataMask.h"
 #include "BitMatrix.h"
 #include "ByteArray.h"
 
@@ -126,28 +127,19 @@ BitMatrixParser::ReadFormatInformation(const BitMatrix& bitMatrix, bool mirrored
 }
 
 /**
-* <p>Reads the bits in the {@link BitMatrix} representing the finder pattern in the
-* correct order in order to reconstruct the codewords bytes contained within the
-* QR Code.</p>
-*
-* @return bytes encoded within the QR Code
-* @throws FormatException if the exact number of bytes expected is not read
+* Walks the data modules in zig-zag order and assembles the codewords. getBit(x, y) returns the (unmasked) value of
+* the module in column x and row y of the symbol.
 */
-ByteArray
-BitMatrixParser::ReadCodewords(const BitMatrix& bitMatrix, const Version& version)
+template <typename GetBit>
+static bool ReadCodewords(int dimension, const Version& version, ByteArray& result, GetBit getBit)
 {
-	if (!hasValidDimension(bitMatrix))
-		return {};
-
-	BitMatrix functionPattern;
-	version.buildFunctionPattern(functionPattern);
+	const BitMatrix& functionPattern = version.functionPattern();
 
 	bool readingUp = true;
-	ByteArray result(version.totalCodewords());
+	result.resize(version.totalCodewords());
 	int resultOffset = 0;
 	int currentByte = 0;
 	int bitsRead = 0;
-	int dimension = bitMatrix.height();
 	// Read columns in pairs, from right to left
 	for (int j = dimension - 1; j > 0; j -= 2) {
 		if (j == 6) {
@@ -163,7 +155,7 @@ BitMatrixParser::ReadCodewords(const BitMatrix& bitMatrix, const Version& versio
 				if (!functionPattern.get(j - col, i)) {
 					// Read a bit
 					bitsRead++;
-					currentByte = (currentByte << 1) | static_cast<int>(bitMatrix.get(j - col, i));
+					currentByte = (currentByte << 1) | static_cast<int>(getBit(j - col, i));
 					// If we've made a whole byte, save it off
 					if (bitsRead == 8) {
 						result[resultOffset++] = static_cast<uint8_t>(currentByte);
@@ -175,11 +167,43 @@ BitMatrixParser::ReadCodewords(const BitMatrix& bitMatrix, const Version& versio
 		}
 		readingUp ^= true; // readingUp = !readingUp; // switch directions
 	}
-	if (resultOffset != version.totalCodewords())
-		return {};
+	return resultOffset == version.totalCodewords();
+}
 
+/**
+* <p>Reads the bits in the {@link BitMatrix} representing the finder pattern in the
+* correct order in order to reconstruct the codewords bytes contained within the
+* QR Code.</p>
+*
+* @return bytes encoded within the QR Code
+* @throws FormatException if the exact number of bytes expected is not read
+*/
+ByteArray
+BitMatrixParser::ReadCodewords(const BitMatrix& bitMatrix, const Version& version)
+{
+	ByteArray result;
+	if (!hasValidDimension(bitMatrix) ||
+		!QRCode::ReadCodewords(bitMatrix.height(), version, result, [&](int x, int y) { return bitMatrix.get(x, y); }))
+		return {};
 	return result;
 }
 
+bool
+BitMatrixParser::ReadCodewords(const BitMatrix& bitMatrix, const Version& version,
+							   const FormatInformation& formatInfo, bool mirrored, ByteArray& result)
+{
+	if (!hasValidDimension(bitMatrix))
+		return false;
+
+	DataMask mask(formatInfo.dataMask());
+	// The mask is defined with i as the row and j as the column, see DataMask
+	if (mirrored)
+		return QRCode::ReadCodewords(bitMatrix.height(), version, result,
+									 [&](int x, int y) { return bitMatrix.get(y, x) != mask.isMasked(y, x); });
+	else
+		return QRCode::ReadCodewords(bitMatrix.height(), version, result,
+									 [&](int x, int y) { return bitMatrix.get(x, y) != mask.isMasked(y, x); });
+}
+
 } // QRCode
 } // ZXing
@@ -48,6 +48,17 @@ public:
 	* or empty array if the exact number of bytes expected is not read
 	*/
 	static ByteArray ReadCodewords(const BitMatrix& bitMatrix, const Version& version);
+
+	/**
+	* Same as above but reads the codewords of a still masked QR Code, the data mask given by formatInfo is removed
+	* module by module while reading. If mirrored is true, the symbol is read transposed (see
+	* ReadFormatInformation). The bitMatrix is not modified. The result is resized as needed, which allows reusing
+	* its storage.
+	*
+	* @return false if the exact number of bytes expected is not read
+	*/
+	static bool ReadCodewords(const BitMatrix& bitMatrix, const Version& version, const FormatInformation& formatInfo,
+							  bool mirrored, ByteArray& result);
 };
 
 } // QRCode
@@ -44,10 +44,16 @@ static const int CHAR_COUNT_PER_MODE[] = {
 
 } // anonymous
 
+bool
+CodecMode::IsValidModeBits(int bits)
+{
+	return (bits >= 0x00 && bits <= 0x05) || (bits >= 0x07 && bits <= 0x09) || bits == 0x0d;
+}
+
 CodecMode::Mode
 CodecMode::ModeForBits(int bits)
 {
-	if ((bits >= 0x00 && bits <= 0x05) || (bits >= 0x07 && bits <= 0x09) || bits == 0x0d)
+	if (IsValidModeBits(bits))
 	{
 		return static_cast<Mode>(bits);
 	}
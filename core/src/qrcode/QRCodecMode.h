@@ -52,6 +52,12 @@ public:
 	*/
 	static Mode ModeForBits(int bits);
 
+	/**
+	* @param bits four bits encoding a QR Code data mode
+	* @return true if ModeForBits accepts these bits, for callers that must not throw (e.g. the decoder)
+	*/
+	static bool IsValidModeBits(int bits);
+
 	/**
 	* @param version version in question
 	* @return number of bits used, in this QR Code symbol {@link Version}, to encode the
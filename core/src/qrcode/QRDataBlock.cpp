@@ -26,8 +26,17 @@ namespace QRCode {
 
 std::vector<DataBlock> DataBlock::GetDataBlocks(const ByteArray& rawCodewords, const Version& version, ErrorCorrectionLevel ecLevel)
 {
-	if (Size(rawCodewords) != version.totalCodewords())
+	std::vector<DataBlock> result;
+	if (!GetDataBlocks(rawCodewords, version, ecLevel, result))
 		return {};
+	return result;
+}
+
+bool DataBlock::GetDataBlocks(const ByteArray& rawCodewords, const Version& version, ErrorCorrectionLevel ecLevel,
+							  std::vector<DataBlock>& result)
+{
+	if (Size(rawCodewords) != version.totalCodewords())
+		return false;
 
 	// Figure out the number and size of data blocks used by this version and
 	// error correction level
@@ -36,7 +45,7 @@ std::vector<DataBlock> DataBlock::GetDataBlocks(const ByteArray& rawCodewords, c
 	// First count the total number of data blocks
 	int totalBlocks = ecBlocks.numBlocks();
 
-	std::vector<DataBlock> result(totalBlocks);
+	result.resize(totalBlocks);
 	// Now establish DataBlocks of the appropriate size and number of data codewords
 	int numResultBlocks = 0;
 	for (auto& ecBlock : ecBlocks.blockArray()) {
@@ -81,7 +90,7 @@ std::vector<DataBlock> DataBlock::GetDataBlocks(const ByteArray& rawCodewords, c
 			result[j]._codewords[iOffset] = rawCodewords[rawCodewordsOffset++];
 		}
 	}
-	return result;
+	return true;
 }
 
 } // QRCode
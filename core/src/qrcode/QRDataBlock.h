@@ -61,6 +61,14 @@ public:
 	*/
 	static std::vector<DataBlock> GetDataBlocks(const ByteArray& rawCodewords, const Version& version, ErrorCorrectionLevel ecLevel);
 
+	/**
+	* Same as above but fills result, which is resized as needed. The storage of result and its blocks is reused.
+	*
+	* @return false if the number of raw codewords does not match the version
+	*/
+	static bool GetDataBlocks(const ByteArray& rawCodewords, const Version& version, ErrorCorrectionLevel ecLevel,
+							  std::vector<DataBlock>& result);
+
 private:
 	int _numDataCodewords = 0;
 	ByteArray _codewords;
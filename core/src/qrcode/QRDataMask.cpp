@@ -19,6 +19,7 @@
 #include "BitMatrix.h"
 #include "ZXContainerAlgorithms.h"
 
+#include <array>
 #include <stdexcept>
 
 namespace ZXing {
@@ -116,7 +117,16 @@ DataMask::DataMask(int reference)
 	if (reference < 0 || reference >= Size(DATA_MASKS)) {
 		throw std::invalid_argument("Invalid data mask");
 	}
-	_isMasked = DATA_MASKS[reference];
+
+	static const auto tables = []() {
+		std::array<std::array<uint16_t, PERIOD>, Size(DATA_MASKS)> res = {};
+		for (int m = 0; m < Size(DATA_MASKS); ++m)
+			for (int i = 0; i < PERIOD; ++i)
+				for (int j = 0; j < PERIOD; ++j)
+					res[m][i] |= DATA_MASKS[m](i, j) << j;
+		return res;
+	}();
+	_table = tables[reference].data();
 }
 
 void
@@ -124,7 +134,7 @@ DataMask::unmaskBitMatrix(BitMatrix& bits, int dimension) const
 {
 	for (int i = 0; i < dimension; i++) {
 		for (int j = 0; j < dimension; j++) {
-			if (_isMasked(i, j)) {
+			if (isMasked(i, j)) {
 				bits.flip(j, i);
 			}
 		}
@@ -16,6 +16,8 @@
 * limitations under the License.
 */
 
+#include <cstdint>
+
 namespace ZXing {
 
 class BitMatrix;
@@ -52,8 +54,17 @@ public:
 	*/
 	void unmaskBitMatrix(BitMatrix& bits, int dimension) const;
 
+	/**
+	* @return true if the module in row i and column j is flipped by this mask
+	*/
+	bool isMasked(int i, int j) const {
+		// All masks repeat every 12 modules in both directions, see the precomputed table in the constructor
+		return (_table[i % PERIOD] >> (j % PERIOD)) & 1;
+	}
+
 private:
-	bool(*_isMasked)(int, int);
+	static constexpr int PERIOD = 12;
+	const uint16_t* _table; // PERIOD rows of PERIOD bits each
 };
 
 } // QRCode
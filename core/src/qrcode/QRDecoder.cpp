@@ -19,9 +19,9 @@
 #include "QRBitMatrixParser.h"
 #include "QRFormatInformation.h"
 #include "QRDecoderMetadata.h"
-#include "QRDataMask.h"
 #include "QRDataBlock.h"
 #include "QRCodecMode.h"
+#include "DecodeStats.h"
 #include "DecoderResult.h"
 #include "BitMatrix.h"
 #include "ReedSolomonDecoder.h"
@@ -31,12 +31,13 @@
 #include "CharacterSet.h"
 #include "CharacterSetECI.h"
 #include "DecodeStatus.h"
+#include "Trace.h"
+#include "ZXConfig.h"
 #include "ZXContainerAlgorithms.h"
 #include "ZXTestSupport.h"
 
 #include <algorithm>
-#include <list>
-#include <stdexcept>
+#include <array>
 #include <vector>
 #include <utility>
 
@@ -55,7 +56,8 @@ static bool
 CorrectErrors(ByteArray& codewordBytes, int numDataCodewords)
 {
 	// First read into an array of ints
-	std::vector<int> codewordsInts(codewordBytes.begin(), codewordBytes.end());
+	ZX_THREAD_LOCAL std::vector<int> codewordsInts;
+	codewordsInts.assign(codewordBytes.begin(), codewordBytes.end());
 
 	int numECCodewords = Size(codewordBytes) - numDataCodewords;
 	if (!ReedSolomonDecoder::Decode(GenericGF::QRCodeField256(), codewordsInts, numECCodewords))
@@ -72,7 +74,7 @@ CorrectErrors(ByteArray& codewordBytes, int numDataCodewords)
 * See specification GBT 18284-2000
 */
 static DecodeStatus
-DecodeHanziSegment(BitSource& bits, int count, std::wstring& result)
+DecodeHanziSegment(BitSource& bits, int count, bool decodeText, std::wstring& result)
 {
 	// Don't crash trying to read more bits than we have available.
 	if (count * 13 > bits.available()) {
@@ -100,12 +102,13 @@ DecodeHanziSegment(BitSource& bits, int count, std::wstring& result)
 		count--;
 	}
 
-	TextDecoder::Append(result, buffer.data(), Size(buffer), CharacterSet::GB2312);
+	if (decodeText)
+		TextDecoder::Append(result, buffer.data(), Size(buffer), CharacterSet::GB2312);
 	return DecodeStatus::NoError;
 }
 
 static DecodeStatus
-DecodeKanjiSegment(BitSource& bits, int count, std::wstring& result)
+DecodeKanjiSegment(BitSource& bits, int count, bool decodeText, std::wstring& result)
 {
 	// Don't crash trying to read more bits than we have available.
 	if (count * 13 > bits.available()) {
@@ -133,81 +136,107 @@ DecodeKanjiSegment(BitSource& bits, int count, std::wstring& result)
 		count--;
 	}
 
-	TextDecoder::Append(result, buffer.data(), Size(buffer), CharacterSet::Shift_JIS);
+	if (decodeText)
+		TextDecoder::Append(result, buffer.data(), Size(buffer), CharacterSet::Shift_JIS);
 	return DecodeStatus::NoError;
 }
 
 static DecodeStatus
-DecodeByteSegment(BitSource& bits, int count, CharacterSet currentCharset, const std::string& hintedCharset, std::wstring& result, std::list<ByteArray>& byteSegments)
+DecodeByteSegment(BitSource& bits, int count, CharacterSet currentCharset, CharacterSet hintedCharset, bool decodeText,
+				  std::wstring& result, ByteSegments& byteSegments)
 {
 	// Don't crash trying to read more bits than we have available.
 	if (8 * count > bits.available()) {
 		return DecodeStatus::FormatError;
 	}
 
-	ByteArray readBytes(count);
+	uint8_t* readBytes = byteSegments.append(count);
 	for (int i = 0; i < count; i++) {
 		readBytes[i] = static_cast<uint8_t>(bits.readBits(8));
 	}
- 	if (currentCharset == CharacterSet::Unknown) {
+	if (!decodeText) {
+		return DecodeStatus::NoError;
+	}
+	if (currentCharset == CharacterSet::Unknown) {
 		// The spec isn't clear on this mode; see
 		// section 6.4.5: t does not say which encoding to assuming
 		// upon decoding. I have seen ISO-8859-1 used as well as
 		// Shift_JIS -- without anything like an ECI designator to
 		// give a hint.
-		if (!hintedCharset.empty())
-		{
-			currentCharset = CharacterSetECI::CharsetFromName(hintedCharset.c_str());
-		}
+		currentCharset = hintedCharset;
 		if (currentCharset == CharacterSet::Unknown)
 		{
-			currentCharset = TextDecoder::GuessEncoding(readBytes.data(), Size(readBytes));
+			currentCharset = TextDecoder::GuessEncoding(readBytes, count);
 		}
 	}
-	TextDecoder::Append(result, readBytes.data(), Size(readBytes), currentCharset);
-	byteSegments.push_back(readBytes);
+	TextDecoder::Append(result, readBytes, count, currentCharset);
 	return DecodeStatus::NoError;
 }
 
-static char
-ToAlphaNumericChar(int value)
+/**
+* See ISO 18004:2006, 6.4.4 Table 5
+*/
+static const char ALPHANUMERIC_CHARS[] = {
+	'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B',
+	'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M', 'N',
+	'O', 'P', 'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X', 'Y', 'Z',
+	' ', '$', '%', '*', '+', '-', '.', '/', ':'
+};
+
+/**
+* The two characters encoded by each of the 45 * 45 possible 11 bit values of an alphanumeric segment.
+*/
+static const std::array<std::array<char, 2>, 45 * 45>& AlphanumericPairTable()
 {
-	/**
-	* See ISO 18004:2006, 6.4.4 Table 5
-	*/
-	static const char ALPHANUMERIC_CHARS[] = {
-		'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B',
-		'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M', 'N',
-		'O', 'P', 'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X', 'Y', 'Z',
-		' ', '$', '%', '*', '+', '-', '.', '/', ':'
-	};
+	static const auto table = [] {
+		std::array<std::array<char, 2>, 45 * 45> res;
+		for (int i = 0; i < Size(res); ++i)
+			res[i] = {ALPHANUMERIC_CHARS[i / 45], ALPHANUMERIC_CHARS[i % 45]};
+		return res;
+	}();
+	return table;
+}
 
-	if (value < 0 || value >= Size(ALPHANUMERIC_CHARS)) {
-		throw std::out_of_range("ToAlphaNumericChar: out of range");
-	}
-	return ALPHANUMERIC_CHARS[value];
+/**
+* The three digits encoded by each of the 1000 possible 10 bit values of a numeric segment.
+*/
+static const std::array<std::array<char, 3>, 1000>& DigitTripletTable()
+{
+	static const auto table = [] {
+		std::array<std::array<char, 3>, 1000> res;
+		for (int i = 0; i < Size(res); ++i)
+			res[i] = {char('0' + i / 100), char('0' + i / 10 % 10), char('0' + i % 10)};
+		return res;
+	}();
+	return table;
 }
 
 static DecodeStatus
 DecodeAlphanumericSegment(BitSource& bits, int count, bool fc1InEffect, std::wstring& result)
 {
-	// Read two characters at a time
-	std::string buffer;
-	while (count > 1) {
-		if (bits.available() < 11) {
+	// Each pair of characters takes 11 bits, a single one left over 6 bits. Checking all of them upfront lets us
+	// fill the presized buffer without any further bounds checks.
+	if (bits.available() < count / 2 * 11 + count % 2 * 6) {
+		return DecodeStatus::FormatError;
+	}
+	const auto& pairs = AlphanumericPairTable();
+	std::string buffer(count, '\0');
+	char* out = &buffer[0];
+	for (; count > 1; count -= 2) {
+		int nextTwoCharsBits = bits.readBits(11);
+		if (nextTwoCharsBits >= 45 * 45) {
 			return DecodeStatus::FormatError;
 		}
-		int nextTwoCharsBits = bits.readBits(11);
-		buffer += ToAlphaNumericChar(nextTwoCharsBits / 45);
-		buffer += ToAlphaNumericChar(nextTwoCharsBits % 45);
-		count -= 2;
+		*out++ = pairs[nextTwoCharsBits][0];
+		*out++ = pairs[nextTwoCharsBits][1];
 	}
 	if (count == 1) {
 		// special case: one character left
-		if (bits.available() < 6) {
+		int charBits = bits.readBits(6);
+		if (charBits >= 45) {
 			return DecodeStatus::FormatError;
 		}
-		buffer += ToAlphaNumericChar(bits.readBits(6));
+		*out = ALPHANUMERIC_CHARS[charBits];
 	}
 	// See section 6.4.8.1, 6.4.8.2
 	if (fc1InEffect) {
@@ -216,7 +245,7 @@ DecodeAlphanumericSegment(BitSource& bits, int count, bool fc1InEffect, std::wst
 			if (buffer[i] == '%') {
 				if (i < buffer.length() - 1 && buffer[i + 1] == '%') {
 					// %% is rendered as %
-					buffer.erase(i + 1);
+					buffer.erase(i + 1, 1);
 				}
 				else {
 					// In alpha mode, % should be converted to FNC1 separator 0x1D
@@ -232,44 +261,37 @@ DecodeAlphanumericSegment(BitSource& bits, int count, bool fc1InEffect, std::wst
 static DecodeStatus
 DecodeNumericSegment(BitSource& bits, int count, std::wstring& result)
 {
-	// Read three digits at a time
-	std::string buffer;
-	while (count >= 3) {
-		// Each 10 bits encodes three digits
-		if (bits.available() < 10) {
-			return DecodeStatus::FormatError;
-		}
+	// Each three digits take 10 bits, two digits left over 7 bits and a single one 4 bits
+	static const int remainderBits[] = {0, 4, 7};
+	if (bits.available() < count / 3 * 10 + remainderBits[count % 3]) {
+		return DecodeStatus::FormatError;
+	}
+	const auto& triplets = DigitTripletTable();
+	std::string buffer(count, '\0');
+	char* out = &buffer[0];
+	for (; count >= 3; count -= 3) {
 		int threeDigitsBits = bits.readBits(10);
 		if (threeDigitsBits >= 1000) {
 			return DecodeStatus::FormatError;
 		}
-		buffer += ToAlphaNumericChar(threeDigitsBits / 100);
-		buffer += ToAlphaNumericChar((threeDigitsBits / 10) % 10);
-		buffer += ToAlphaNumericChar(threeDigitsBits % 10);
-		count -= 3;
+		out = std::copy_n(triplets[threeDigitsBits].data(), 3, out);
 	}
 	if (count == 2) {
 		// Two digits left over to read, encoded in 7 bits
-		if (bits.available() < 7) {
-			return DecodeStatus::FormatError;
-		}
 		int twoDigitsBits = bits.readBits(7);
 		if (twoDigitsBits >= 100) {
 			return DecodeStatus::FormatError;
 		}
-		buffer += ToAlphaNumericChar(twoDigitsBits / 10);
-		buffer += ToAlphaNumericChar(twoDigitsBits % 10);
+		// the last two digits of the triplet with leading 0
+		std::copy_n(triplets[twoDigitsBits].data() + 1, 2, out);
 	}
 	else if (count == 1) {
 		// One digit left over to read
-		if (bits.available() < 4) {
-			return DecodeStatus::FormatError;
-		}
 		int digitBits = bits.readBits(4);
 		if (digitBits >= 10) {
 			return DecodeStatus::FormatError;
 		}
-		buffer += ToAlphaNumericChar(digitBits);
+		*out = static_cast<char>('0' + digitBits);
 	}
 
 	TextDecoder::AppendLatin1(result, buffer);
@@ -279,6 +301,9 @@ DecodeNumericSegment(BitSource& bits, int count, std::wstring& result)
 static DecodeStatus
 ParseECIValue(BitSource& bits, int &outValue)
 {
+	if (bits.available() < 8) {
+		return DecodeStatus::FormatError;
+	}
 	int firstByte = bits.readBits(8);
 	if ((firstByte & 0x80) == 0) {
 		// just one byte
@@ -287,12 +312,18 @@ ParseECIValue(BitSource& bits, int &outValue)
 	}
 	if ((firstByte & 0xC0) == 0x80) {
 		// two bytes
+		if (bits.available() < 8) {
+			return DecodeStatus::FormatError;
+		}
 		int secondByte = bits.readBits(8);
 		outValue = ((firstByte & 0x3F) << 8) | secondByte;
 		return DecodeStatus::NoError;
 	}
 	if ((firstByte & 0xE0) == 0xC0) {
 		// three bytes
+		if (bits.available() < 16) {
+			return DecodeStatus::FormatError;
+		}
 		int secondThirdBytes = bits.readBits(16);
 		outValue = ((firstByte & 0x1F) << 16) | secondThirdBytes;
 		return DecodeStatus::NoError;
@@ -305,110 +336,124 @@ ParseECIValue(BitSource& bits, int &outValue)
 * in one QR Code. This method decodes the bits back into text.</p>
 *
 * <p>See ISO 18004:2006, 6.4.3 - 6.4.7</p>
+*
+* @param decodeText if false, the segments are only parsed (for the byte segments and the structured append data)
+* and the text of the result is left empty
 */
 ZXING_EXPORT_TEST_ONLY DecoderResult
-DecodeBitStream(ByteArray&& bytes, const Version& version, ErrorCorrectionLevel ecLevel, const std::string& hintedCharset)
+DecodeBitStream(ByteArray&& bytes, const Version& version, ErrorCorrectionLevel ecLevel, CharacterSet hintedCharset,
+				bool decodeText)
 {
+	DecodeStats::StageTimer timer(DecodeStats::Stage::DecodeText);
 	BitSource bits(bytes);
 	std::wstring result;
-	std::list<ByteArray> byteSegments;
+	// Numeric mode is the densest one with 3 digits per 10 bits, so this is enough to never grow the string
+	if (decodeText)
+		result.reserve(Size(bytes) * 12 / 5 + 1);
+	ByteSegments byteSegments;
 	int codeSequence = -1;
 	int codeCount = -1;
 	int parityData = -1;
 	static const int GB2312_SUBSET = 1;
 
-	try
-	{
-		CharacterSet currentCharset = CharacterSet::Unknown;
-		bool fc1InEffect = false;
-		CodecMode::Mode mode;
-		do {
-			// While still another segment to read...
-			if (bits.available() < 4) {
-				// OK, assume we're done. Really, a TERMINATOR mode should have been recorded here
-				mode = CodecMode::TERMINATOR;
+	CharacterSet currentCharset = CharacterSet::Unknown;
+	bool fc1InEffect = false;
+	CodecMode::Mode mode;
+	do {
+		// While still another segment to read...
+		if (bits.available() < 4) {
+			// OK, assume we're done. Really, a TERMINATOR mode should have been recorded here
+			mode = CodecMode::TERMINATOR;
+		}
+		else {
+			int modeBits = bits.readBits(4); // mode is encoded by 4 bits
+			if (!CodecMode::IsValidModeBits(modeBits)) {
+				return DecodeStatus::FormatError;
 			}
-			else {
-				mode = CodecMode::ModeForBits(bits.readBits(4)); // mode is encoded by 4 bits
+			mode = static_cast<CodecMode::Mode>(modeBits);
+		}
+		switch (mode) {
+		case CodecMode::TERMINATOR:
+			break;
+		case CodecMode::FNC1_FIRST_POSITION:
+		case CodecMode::FNC1_SECOND_POSITION:
+			// We do little with FNC1 except alter the parsed result a bit according to the spec
+			fc1InEffect = true;
+			break;
+		case CodecMode::STRUCTURED_APPEND:
+			if (bits.available() < 16) {
+				return DecodeStatus::FormatError;
 			}
-			switch (mode) {
-			case CodecMode::TERMINATOR:
-				break;
-			case CodecMode::FNC1_FIRST_POSITION:
-			case CodecMode::FNC1_SECOND_POSITION:
-				// We do little with FNC1 except alter the parsed result a bit according to the spec
-				fc1InEffect = true;
-				break;
-			case CodecMode::STRUCTURED_APPEND:
-				if (bits.available() < 16) {
-					return DecodeStatus::FormatError;
-				}
-				// sequence number and parity is added later to the result metadata
-				// Read next 4 bits of sequence #, 4 bits of code count, and 8 bits of parity data, then continue
-				codeSequence = bits.readBits(4);
-				codeCount = bits.readBits(4) + 1;
-				parityData = bits.readBits(8);
-				break;
-			case CodecMode::ECI: {
-				// Count doesn't apply to ECI
-				int value;
-				auto status = ParseECIValue(bits, value);
-				if (StatusIsError(status)) {
-					return status;
-				}
-				currentCharset = CharacterSetECI::CharsetFromValue(value);
-				if (currentCharset == CharacterSet::Unknown) {
-					return DecodeStatus::FormatError;
-				}
-				break;
+			// sequence number and parity is added later to the result metadata
+			// Read next 4 bits of sequence #, 4 bits of code count, and 8 bits of parity data, then continue
+			codeSequence = bits.readBits(4);
+			codeCount = bits.readBits(4) + 1;
+			parityData = bits.readBits(8);
+			break;
+		case CodecMode::ECI: {
+			// Count doesn't apply to ECI
+			int value;
+			auto status = ParseECIValue(bits, value);
+			if (StatusIsError(status)) {
+				return status;
 			}
-			case CodecMode::HANZI: {
-				// First handle Hanzi mode which does not start with character count
-				// chinese mode contains a sub set indicator right after mode indicator
-				int subset = bits.readBits(4);
-				int countHanzi = bits.readBits(CodecMode::CharacterCountBits(mode, version));
-				if (subset == GB2312_SUBSET) {
-					auto status = DecodeHanziSegment(bits, countHanzi, result);
-					if (StatusIsError(status)) {
-						return status;
-					}
-				}
-				break;
+			currentCharset = CharacterSetECI::CharsetFromValue(value);
+			if (currentCharset == CharacterSet::Unknown) {
+				return DecodeStatus::FormatError;
 			}
-			default: {
-				// "Normal" QR code modes:
-				// How many characters will follow, encoded in this mode?
-				int count = bits.readBits(CodecMode::CharacterCountBits(mode, version));
-				DecodeStatus status;
-				switch (mode) {
-				case CodecMode::NUMERIC:
-					status = DecodeNumericSegment(bits, count, result);
-					break;
-				case CodecMode::ALPHANUMERIC:
-					status = DecodeAlphanumericSegment(bits, count, fc1InEffect, result);
-					break;
-				case CodecMode::BYTE:
-					status = DecodeByteSegment(bits, count, currentCharset, hintedCharset, result, byteSegments);
-					break;
-				case CodecMode::KANJI:
-					status = DecodeKanjiSegment(bits, count, result);
-					break;
-				default:
-					status = DecodeStatus::FormatError;
-				}
+			break;
+		}
+		case CodecMode::HANZI: {
+			// First handle Hanzi mode which does not start with character count
+			// chinese mode contains a sub set indicator right after mode indicator
+			if (bits.available() < 4 + CodecMode::CharacterCountBits(mode, version)) {
+				return DecodeStatus::FormatError;
+			}
+			int subset = bits.readBits(4);
+			int countHanzi = bits.readBits(CodecMode::CharacterCountBits(mode, version));
+			if (subset == GB2312_SUBSET) {
+				auto status = DecodeHanziSegment(bits, countHanzi, decodeText, result);
 				if (StatusIsError(status)) {
 					return status;
 				}
+			}
+			break;
+		}
+		default: {
+			// "Normal" QR code modes:
+			// How many characters will follow, encoded in this mode?
+			if (bits.available() < CodecMode::CharacterCountBits(mode, version)) {
+				return DecodeStatus::FormatError;
+			}
+			int count = bits.readBits(CodecMode::CharacterCountBits(mode, version));
+			DecodeStatus status;
+			switch (mode) {
+			case CodecMode::NUMERIC:
+				status = DecodeNumericSegment(bits, count, result);
+				break;
+			case CodecMode::ALPHANUMERIC:
+				status = DecodeAlphanumericSegment(bits, count, fc1InEffect, result);
+				break;
+			case CodecMode::BYTE:
+				status = DecodeByteSegment(bits, count, currentCharset, hintedCharset, decodeText, result,
+										   byteSegments);
+				break;
+			case CodecMode::KANJI:
+				status = DecodeKanjiSegment(bits, count, decodeText, result);
 				break;
+			default:
+				status = DecodeStatus::FormatError;
 			}
+			if (StatusIsError(status)) {
+				return status;
 			}
-		} while (mode != CodecMode::TERMINATOR);
-	}
-	catch (const std::exception &)
-	{
-		// from readBits() calls
-		return DecodeStatus::FormatError;
-	}
+			break;
+		}
+		}
+	} while (mode != CodecMode::TERMINATOR);
+
+	if (!decodeText)
+		result.clear();
 
 	return DecoderResult(std::move(bytes), std::move(result))
 		.setByteSegments(std::move(byteSegments))
@@ -419,18 +464,21 @@ DecodeBitStream(ByteArray&& bytes, const Version& version, ErrorCorrectionLevel
 }
 
 static DecoderResult
-DoDecode(const BitMatrix& bits, const Version& version, const FormatInformation& formatInfo, const std::string& hintedCharset)
+DoDecode(const BitMatrix& bits, const Version& version, const FormatInformation& formatInfo, bool mirrored,
+		 CharacterSet hintedCharset, bool decodeText)
 {
 	auto ecLevel = formatInfo.errorCorrectionLevel();
 
-	// Read codewords
-	ByteArray codewords = BitMatrixParser::ReadCodewords(bits, version);
-	if (codewords.empty())
+	// The intermediate buffers can be reused across calls, see ZX_THREAD_LOCAL
+	ZX_THREAD_LOCAL ByteArray codewords;
+	ZX_THREAD_LOCAL std::vector<DataBlock> dataBlocks;
+
+	// Read codewords, removing the data mask on the fly
+	if (!BitMatrixParser::ReadCodewords(bits, version, formatInfo, mirrored, codewords))
 		return DecodeStatus::FormatError;
 
 	// Separate into data blocks
-	std::vector<DataBlock> dataBlocks = DataBlock::GetDataBlocks(codewords, version, ecLevel);
-	if (dataBlocks.empty())
+	if (!DataBlock::GetDataBlocks(codewords, version, ecLevel, dataBlocks))
 		return DecodeStatus::FormatError;
 
 	// Count total number of data bytes
@@ -454,60 +502,51 @@ DoDecode(const BitMatrix& bits, const Version& version, const FormatInformation&
 	}
 
 	// Decode the contents of that stream of bytes
-	return DecodeBitStream(std::move(resultBytes), version, ecLevel, hintedCharset);
+	return DecodeBitStream(std::move(resultBytes), version, ecLevel, hintedCharset, decodeText);
 }
 
-static void
-ReMask(BitMatrix& bitMatrix, const FormatInformation& formatInfo)
+DecoderResult
+Decoder::Decode(const BitMatrix& bits, const std::string& hintedCharset, bool decodeText)
 {
-	int dimension = bitMatrix.height();
-	DataMask(formatInfo.dataMask()).unmaskBitMatrix(bitMatrix, dimension);
+	return Decode(bits, CharacterSetECI::CharsetFromName(hintedCharset.c_str()), decodeText);
 }
 
-
 DecoderResult
-Decoder::Decode(const BitMatrix& bits_, const std::string& hintedCharset)
+Decoder::Decode(const BitMatrix& bits, CharacterSet hintedCharset, bool decodeText)
 {
-	BitMatrix bits = bits_.copy();
-
-	// Construct a parser and read version, error-correction level
-	const Version* version = BitMatrixParser::ReadVersion(bits, false);
-	FormatInformation formatInfo = BitMatrixParser::ReadFormatInformation(bits, false);
-
-	if (version != nullptr && formatInfo.isValid()) {
-		ReMask(bits, formatInfo);
-		auto result = DoDecode(bits, *version, formatInfo, hintedCharset);
+	ZX_TRACE_SCOPE("QRCode::Decoder::Decode");
+	// Read version and format information (error-correction level, mask) both as is and mirrored. They are only a few
+	// bits, so this is cheap compared to the codeword extraction and the error correction, which are then done for
+	// the orientation whose format information matches better (the normal one on a tie). The other one is only tried
+	// if that fails, so a mirrored code usually costs one decoding attempt instead of two.
+	struct Candidate
+	{
+		bool mirrored;
+		const Version* version;
+		FormatInformation formatInfo;
+		bool isValid() const { return version != nullptr && formatInfo.isValid(); }
+	};
+	Candidate candidates[] = {
+		{false, BitMatrixParser::ReadVersion(bits, false), BitMatrixParser::ReadFormatInformation(bits, false)},
+		{true, BitMatrixParser::ReadVersion(bits, true), BitMatrixParser::ReadFormatInformation(bits, true)},
+	};
+	if (candidates[1].isValid() &&
+		(!candidates[0].isValid() ||
+		 candidates[1].formatInfo.hammingDistance() < candidates[0].formatInfo.hammingDistance()))
+		std::swap(candidates[0], candidates[1]);
+
+	DecoderResult result = DecodeStatus::FormatError;
+	for (const auto& c : candidates) {
+		if (!c.isValid())
+			continue;
+		result = DoDecode(bits, *c.version, c.formatInfo, c.mirrored, hintedCharset, decodeText);
 		if (result.isValid()) {
-			return result;
+			if (c.mirrored)
+				result.setExtra(std::make_shared<DecoderMetadata>(true));
+			break;
 		}
 	}
-
-	if (version != nullptr) {
-		// Revert the bit matrix
-		ReMask(bits, formatInfo);
-	}
-
-	version = BitMatrixParser::ReadVersion(bits, true);
-	formatInfo = BitMatrixParser::ReadFormatInformation(bits, true);
-
-	if (version != nullptr && formatInfo.isValid()) {
-		/*
-		* Since we're here, this means we have successfully detected some kind
-		* of version and format information when mirrored. This is a good sign,
-		* that the QR code may be mirrored, and we should try once more with a
-		* mirrored content.
-		*/
-		// Prepare for a mirrored reading.
-		bits.mirror();
-
-		ReMask(bits, formatInfo);
-		auto result = DoDecode(bits, *version, formatInfo, hintedCharset);
-		if (result.isValid())
-			result.setExtra(std::make_shared<DecoderMetadata>(true));
-
-		return result;
-	}
-	return DecodeStatus::FormatError;
+	return result;
 }
 
 } // QRCode
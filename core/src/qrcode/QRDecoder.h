@@ -22,6 +22,7 @@ namespace ZXing {
 
 class DecoderResult;
 class BitMatrix;
+enum class CharacterSet;
 
 namespace QRCode {
 
@@ -51,12 +52,17 @@ public:
 	* <p>Decodes a QR Code represented as a {@link BitMatrix}. A 1 or "true" is taken to mean a black module.</p>
 	*
 	* @param bits booleans representing white/black QR Code modules
-	* @param hints decoding hints that should be used to influence decoding
+	* @param hintedCharset the encoding of byte segments without an ECI, CharacterSet::Unknown to guess it
+	* @param decodeText if false, only the bytes are returned and the text is left empty, see
+	*                   DecodeHints::skipTextDecoding
 	* @return text and bytes encoded within the QR Code
 	* @throws FormatException if the QR Code cannot be decoded
 	* @throws ChecksumException if error correction fails
 	*/
-	static DecoderResult Decode(const BitMatrix& bits, const std::string& hintedCharset);
+	static DecoderResult Decode(const BitMatrix& bits, CharacterSet hintedCharset, bool decodeText = true);
+
+	/// Same as above with the name of the charset (see CharacterSetECI::CharsetFromName), resolved on every call
+	static DecoderResult Decode(const BitMatrix& bits, const std::string& hintedCharset, bool decodeText = true);
 };
 
 } // QRCode
@@ -20,16 +20,20 @@
 #include "QRFinderPatternInfo.h"
 #include "QRAlignmentPattern.h"
 #include "QRAlignmentPatternFinder.h"
+#include "QRBitMatrixParser.h"
+#include "QRFormatInformation.h"
 #include "QRVersion.h"
 #include "BitMatrix.h"
 #include "DetectorResult.h"
 #include "PerspectiveTransform.h"
 #include "GridSampler.h"
+#include "Trace.h"
 #include "ZXNumeric.h"
 
 #include <algorithm>
 #include <cmath>
 #include <cstdlib>
+#include <initializer_list>
 #include <limits>
 #include <utility>
 
@@ -181,6 +185,23 @@ static float CalculateModuleSize(const BitMatrix& image, const ResultPoint& topL
 }
 
 
+/**
+* Computes the region of the image "allowanceFactor" modules around the estimated alignment pattern position.
+* @return false if the region is too small to contain an alignment pattern
+*/
+static bool AlignmentRegion(const BitMatrix& image, float overallEstModuleSize, int estAlignmentX, int estAlignmentY,
+							float allowanceFactor, int& left, int& top, int& right, int& bottom)
+{
+	// Look for an alignment pattern (3 modules in size) around where it
+	// should be
+	int allowance = (int)(allowanceFactor * overallEstModuleSize);
+	left = std::max(0, estAlignmentX - allowance);
+	right = std::min(image.width() - 1, estAlignmentX + allowance);
+	top = std::max(0, estAlignmentY - allowance);
+	bottom = std::min(image.height() - 1, estAlignmentY + allowance);
+	return right - left >= overallEstModuleSize * 3 && bottom - top >= overallEstModuleSize * 3;
+}
+
 /**
 * <p>Attempts to locate an alignment pattern in a limited region of the image, which is
 * guessed to contain it. This method uses {@link AlignmentPattern}.</p>
@@ -194,22 +215,45 @@ static float CalculateModuleSize(const BitMatrix& image, const ResultPoint& topL
 */
 AlignmentPattern FindAlignmentInRegion(const BitMatrix& image, float overallEstModuleSize, int estAlignmentX, int estAlignmentY, float allowanceFactor)
 {
-	// Look for an alignment pattern (3 modules in size) around where it
-	// should be
-	int allowance = (int)(allowanceFactor * overallEstModuleSize);
-	int alignmentAreaLeftX = std::max(0, estAlignmentX - allowance);
-	int alignmentAreaRightX = std::min(image.width() - 1, estAlignmentX + allowance);
-	if (alignmentAreaRightX - alignmentAreaLeftX < overallEstModuleSize * 3) {
+	int left, top, right, bottom;
+	if (!AlignmentRegion(image, overallEstModuleSize, estAlignmentX, estAlignmentY, allowanceFactor, left, top, right, bottom))
 		return {};
-	}
 
-	int alignmentAreaTopY = std::max(0, estAlignmentY - allowance);
-	int alignmentAreaBottomY = std::min(image.height() - 1, estAlignmentY + allowance);
-	if (alignmentAreaBottomY - alignmentAreaTopY < overallEstModuleSize * 3) {
+	return AlignmentPatternFinder::Find(image, left, top, right - left, bottom - top, overallEstModuleSize);
+}
+
+/**
+* Like calling {@link FindAlignmentInRegion} for each of the increasing "allowanceFactors" until a pattern is
+* found, but the largest region is only scanned once. The candidates are ranked by whether they were confirmed
+* on a second row and by their distance to the estimated position. Each allowance level is answered with the
+* best ranked candidate inside its region.
+*/
+static AlignmentPattern FindAlignmentInRegions(const BitMatrix& image, float overallEstModuleSize, int estAlignmentX, int estAlignmentY,
+											   std::initializer_list<float> allowanceFactors)
+{
+	int left, top, right, bottom;
+	if (!AlignmentRegion(image, overallEstModuleSize, estAlignmentX, estAlignmentY, *(allowanceFactors.end() - 1), left, top, right, bottom))
 		return {};
+
+	auto candidates = AlignmentPatternFinder::FindAll(image, left, top, right - left, bottom - top, overallEstModuleSize);
+	auto distance = [&](const AlignmentPattern& p) {
+		return std::max(std::abs(p.x() - estAlignmentX), std::abs(p.y() - estAlignmentY));
+	};
+	std::stable_sort(candidates.begin(), candidates.end(), [&](const AlignmentPatternFinder::Candidate& a, const AlignmentPatternFinder::Candidate& b) {
+		bool aConfirmed = a.count > 1, bConfirmed = b.count > 1;
+		return aConfirmed != bConfirmed ? aConfirmed : distance(a.pattern) < distance(b.pattern);
+	});
+
+	for (float allowanceFactor : allowanceFactors) {
+		if (!AlignmentRegion(image, overallEstModuleSize, estAlignmentX, estAlignmentY, allowanceFactor, left, top, right, bottom))
+			continue;
+		for (auto& c : candidates) {
+			if (c.pattern.x() >= left && c.pattern.x() <= right && c.pattern.y() >= top && c.pattern.y() <= bottom)
+				return c.pattern;
+		}
 	}
 
-	return AlignmentPatternFinder::Find(image, alignmentAreaLeftX, alignmentAreaTopY, alignmentAreaRightX - alignmentAreaLeftX, alignmentAreaBottomY - alignmentAreaTopY, overallEstModuleSize);
+	return {};
 }
 
 static PerspectiveTransform CreateTransform(const ResultPoint& topLeft, const ResultPoint& topRight, const ResultPoint& bottomLeft, const AlignmentPattern& alignmentPattern, int dimension)
@@ -248,15 +292,66 @@ static int ComputeDimension(const ResultPoint& topLeft, const ResultPoint& topRi
 	return -1; // to signal error;
 }
 
+/**
+* Cheap test whether the transform hits a QR Code before the whole grid is sampled and decoded: samples only the
+* modules around the finder patterns, i.e. the timing patterns and the format and version information, the same way
+* SampleGrid does. At least 3/4 of the timing pattern modules have to alternate and the format and version information
+* have to be readable as is or mirrored, otherwise the decoder would fail anyway.
+*/
+static bool HasFunctionPatterns(const BitMatrix& image, int dimension, const PerspectiveTransform& transform)
+{
+	auto isInside = [&](PointI p) {
+		p = PointI(transform(p + PointF(0.5, 0.5)));
+		return 0 <= p.x && p.x < image.width() && 0 <= p.y && p.y < image.height();
+	};
+	// let SampleGrid reject what it can't sample
+	if (!transform.isValid() || !isInside({0, 0}) || !isInside({dimension - 1, 0}) ||
+		!isInside({dimension - 1, dimension - 1}) || !isInside({0, dimension - 1}))
+		return true;
+
+	// the top 9 rows and the left 9 columns contain the timing patterns and both copies of the format and version
+	// information. mapRow is called with the same start as in SampleGrid, so each module gets the same pixel.
+	BitMatrix bits(dimension);
+	for (int y = 0; y < dimension; ++y)
+		transform.mapRow(PointF(0.5, y + 0.5), y < 9 ? dimension : 9, [&](int x, PointF pf) {
+			auto p = PointI(pf);
+			if (image.get(p.x, p.y))
+				bits.set(x, y);
+		});
+
+	int timingModules = 2 * (dimension - 16);
+	int matches = 0;
+	for (int i = 8; i < dimension - 8; ++i)
+		matches += (bits.get(i, 6) == (i % 2 == 0)) + (bits.get(6, i) == (i % 2 == 0));
+	if (4 * matches < 3 * timingModules)
+		return false;
+
+	auto isReadable = [&bits](bool mirrored) {
+		return BitMatrixParser::ReadVersion(bits, mirrored) != nullptr &&
+			   BitMatrixParser::ReadFormatInformation(bits, mirrored).isValid();
+	};
+	return isReadable(false) || isReadable(true);
+}
+
 static DetectorResult
-ProcessFinderPatternInfo(const BitMatrix& image, const FinderPatternInfo& info)
+ProcessFinderPatternInfo(const BitMatrix& image, const FinderPatternInfo& info, const ExpectedGeometry& expected)
 {
-	float moduleSize = CalculateModuleSize(image, info.topLeft, info.topRight, info.bottomLeft);
-	if (moduleSize < 1.0f) {
+	if (!expected.acceptsTopEdge(info.topRight - info.topLeft))
 		return {};
+
+	float moduleSize;
+	int dimension;
+	if (expected.dimension > 7) {
+		// The finder pattern centers are 3.5 modules inside the corners, no need to measure the patterns
+		dimension = expected.dimension;
+		float centerDistance = (distance(info.topLeft, info.topRight) + distance(info.topLeft, info.bottomLeft)) / 2;
+		moduleSize = centerDistance / (dimension - 7);
+	}
+	else {
+		moduleSize = CalculateModuleSize(image, info.topLeft, info.topRight, info.bottomLeft);
+		dimension = moduleSize < 1.0f ? -1 : ComputeDimension(info.topLeft, info.topRight, info.bottomLeft, moduleSize);
 	}
-	int dimension = ComputeDimension(info.topLeft, info.topRight, info.bottomLeft, moduleSize);
-	if (dimension < 0)
+	if (moduleSize < 1.0f || dimension < 0 || !expected.acceptsModuleSize(moduleSize))
 		return {};
 
 	const Version* provisionalVersion = Version::ProvisionalVersionForDimension(dimension);
@@ -280,16 +375,17 @@ ProcessFinderPatternInfo(const BitMatrix& image, const FinderPatternInfo& info)
 		int estAlignmentX = static_cast<int>(info.topLeft.x() + correctionToTopLeft * (bottomRightX - info.topLeft.x()));
 		int estAlignmentY = static_cast<int>(info.topLeft.y() + correctionToTopLeft * (bottomRightY - info.topLeft.y()));
 
-		// Kind of arbitrary -- expand search radius before giving up
-		for (int i = 4; i <= 16; i <<= 1) {
-			alignmentPattern = FindAlignmentInRegion(image, moduleSize, estAlignmentX, estAlignmentY, static_cast<float>(i));
-			if (alignmentPattern.isValid())
-				break;
-		}
+		// Kind of arbitrary -- expand search radius before giving up. The small region usually succeeds, the
+		// larger ones are scanned together.
+		alignmentPattern = FindAlignmentInRegion(image, moduleSize, estAlignmentX, estAlignmentY, 4.f);
+		if (!alignmentPattern.isValid())
+			alignmentPattern = FindAlignmentInRegions(image, moduleSize, estAlignmentX, estAlignmentY, {8.f, 16.f});
 		// If we didn't find alignment pattern... well try anyway without it
 	}
 
 	PerspectiveTransform transform = CreateTransform(info.topLeft, info.topRight, info.bottomLeft, alignmentPattern, dimension);
+	if (!HasFunctionPatterns(image, dimension, transform))
+		return {};
 
 	return SampleGrid(image, dimension, dimension, transform);
 }
@@ -331,17 +427,25 @@ static DetectorResult DetectPure(const BitMatrix& image)
 			{{left, top}, {right, top}, {right, bottom}, {left, bottom}}};
 }
 
-DetectorResult Detector::Detect(const BitMatrix& image, bool tryHarder, bool isPure)
+DetectorResult Detector::Detect(const BitMatrix& image, bool tryHarder, bool isPure, int threads,
+								const RunLengthIndex* runs, const ExpectedGeometry& expected, int scanStride)
 {
+	ZX_TRACE_SCOPE("QRCode::Detector::Detect");
 	if (isPure)
 		return DetectPure(image);
 
-	FinderPatternInfo info = FinderPatternFinder::Find(image, tryHarder);
+	FinderPatternInfo info = FinderPatternFinder::Find(image, tryHarder, threads, runs, expected, scanStride);
 
 	if (!info.isValid())
 		return {};
 	
-	return ProcessFinderPatternInfo(image, info);
+	return ProcessFinderPatternInfo(image, info, expected);
+}
+
+DetectorResult Detector::Detect(const BitMatrix& image, const FinderPatternInfo& info, const ExpectedGeometry& expected)
+{
+	ZX_TRACE_SCOPE("QRCode::Detector::Detect");
+	return ProcessFinderPatternInfo(image, info, expected);
 }
 
 } // QRCode
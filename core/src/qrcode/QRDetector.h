@@ -16,13 +16,18 @@
 * limitations under the License.
 */
 
+#include "ExpectedGeometry.h"
+
 namespace ZXing {
 
 class DetectorResult;
 class BitMatrix;
+class RunLengthIndex;
 
 namespace QRCode {
 
+class FinderPatternInfo;
+
 /**
 * <p>Encapsulates logic that can detect a QR Code in an image, even if the QR Code
 * is rotated or skewed, or partially obscured.</p>
@@ -36,11 +41,25 @@ public:
 	* <p>Detects a QR Code in an image.</p>
 	*
 	* @param hints optional hints to detector
+	* @param threads number of threads used to scan for finder patterns, see FinderPatternFinder::Find
+	* @param runs optional run lengths of image, see FinderPatternFinder::Find
+	* @param expected what is known about the symbol in advance, candidates that don't match are ignored
+	* @param scanStride see FinderPatternFinder::Find
 	* @return {@link DetectorResult} encapsulating results of detecting a QR Code
 	* @throws NotFoundException if QR Code cannot be found
 	* @throws FormatException if a QR Code cannot be decoded
 	*/
-	static DetectorResult Detect(const BitMatrix& image, bool tryHarder, bool isPure);
+	static DetectorResult Detect(const BitMatrix& image, bool tryHarder, bool isPure, int threads = 1,
+								 const RunLengthIndex* runs = nullptr, const ExpectedGeometry& expected = {},
+								 int scanStride = 1);
+
+	/**
+	* <p>Detects a QR Code in an image, given the location of its three finder patterns.</p>
+	*
+	* @return {@link DetectorResult} encapsulating results of detecting a QR Code
+	*/
+	static DetectorResult Detect(const BitMatrix& image, const FinderPatternInfo& info,
+								 const ExpectedGeometry& expected = {});
 };
 
 } // QRCode
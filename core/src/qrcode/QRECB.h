@@ -47,20 +47,20 @@ struct ECBlocks
 	int codewordsPerBlock;
 	std::array<ECB, 2> blocks;
 
-	int numBlocks() const {
+	constexpr int numBlocks() const {
 		return blocks[0].count + blocks[1].count;
 	}
 
-	int totalCodewords() const {
+	constexpr int totalCodewords() const {
 		return codewordsPerBlock * numBlocks();
 	}
 
-	int totalDataCodewords() const {
+	constexpr int totalDataCodewords() const {
 		return blocks[0].count * (blocks[0].dataCodewords + codewordsPerBlock)
 			+ blocks[1].count * (blocks[1].dataCodewords + codewordsPerBlock);
 	}
 
-	const std::array<ECB, 2>& blockArray() const {
+	constexpr const std::array<ECB, 2>& blockArray() const {
 		return blocks;
 	}
 };
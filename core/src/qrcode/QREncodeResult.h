@@ -34,7 +34,7 @@ class EncodeResult
 {
 public:
 	ErrorCorrectionLevel ecLevel = ErrorCorrectionLevel::Invalid;
-	CodecMode::Mode mode = CodecMode::TERMINATOR;
+	CodecMode::Mode mode = CodecMode::TERMINATOR; // the mode of the first segment if there are several
 	const Version* version = nullptr;
 	int maskPattern = -1;
 	BitMatrix matrix;
@@ -25,7 +25,9 @@
 #include "BitArray.h"
 #include "CharacterSet.h"
 #include "CharacterSetECI.h"
+#include "Parallel.h"
 #include "TextEncoder.h"
+#include "ZXContainerAlgorithms.h"
 #include "ZXStrConvWorkaround.h"
 #include "ZXTestSupport.h"
 
@@ -378,19 +380,13 @@ void GetNumDataBytesAndNumECBytesForBlockID(int numTotalBytes, int numDataBytes,
 	}
 }
 
-ZXING_EXPORT_TEST_ONLY
+#ifdef ZXING_BUILD_FOR_TEST
+// InterleaveWithECBytes encodes all blocks in one batch, this single block version is only used by the tests
 void GenerateECBytes(const ByteArray& dataBytes, int numEcBytesInBlock, ByteArray& ecBytes)
 {
-	size_t numDataBytes = dataBytes.size();
-	std::vector<int> toEncode(numDataBytes + numEcBytesInBlock, 0);
-	std::copy(dataBytes.begin(), dataBytes.end(), toEncode.begin());
-	ReedSolomonEncoder(GenericGF::QRCodeField256()).encode(toEncode, numEcBytesInBlock);
-
-	ecBytes.resize(numEcBytesInBlock);
-	for (int i = 0; i < numEcBytesInBlock; i++) {
-		ecBytes[i] = static_cast<uint8_t>(toEncode[numDataBytes + i]);
-	}
+	ReedSolomonEncoder(GenericGF::QRCodeField256()).encode(dataBytes, {Size(dataBytes)}, numEcBytesInBlock, ecBytes);
 }
+#endif
 
 
 /**
@@ -409,28 +405,35 @@ BitArray InterleaveWithECBytes(const BitArray& bits, int numTotalBytes, int numD
 	// store the divided data bytes blocks and error correction bytes blocks into "blocks".
 	int dataBytesOffset = 0;
 	int maxNumDataBytes = 0;
-	int maxNumEcBytes = 0;
 
 	// Since, we know the number of reedsolmon blocks, we can initialize the vector with the number.
 	std::vector<BlockPair> blocks(numRSBlocks);
 
+	std::vector<int> blockSizes(numRSBlocks);
+	int numEcBytesInBlock = 0;
 	for (int i = 0; i < numRSBlocks; ++i) {
 		int numDataBytesInBlock = 0;
-		int numEcBytesInBlock = 0;
 		GetNumDataBytesAndNumECBytesForBlockID(numTotalBytes, numDataBytes, numRSBlocks, i, numDataBytesInBlock, numEcBytesInBlock);
 
 		int size = numDataBytesInBlock;
 		blocks[i].dataBytes = bits.toBytes(8 * dataBytesOffset, size);
-		GenerateECBytes(blocks[i].dataBytes, numEcBytesInBlock, blocks[i].ecBytes);
+		blockSizes[i] = size;
 
 		maxNumDataBytes = std::max(maxNumDataBytes, size);
-		maxNumEcBytes = std::max(maxNumEcBytes, (int)blocks[i].ecBytes.size());
 		dataBytesOffset += numDataBytesInBlock;
 	}
 	if (numDataBytes != dataBytesOffset) {
 		throw std::invalid_argument("Data bytes does not match offset");
 	}
 
+	// all blocks have the same number of error correction bytes, so they are computed in one batch
+	ByteArray ecBytes;
+	ReedSolomonEncoder(GenericGF::QRCodeField256())
+		.encode(bits.toBytes(0, numDataBytes), blockSizes, numEcBytesInBlock, ecBytes);
+	for (int i = 0; i < numRSBlocks; ++i)
+		blocks[i].ecBytes.assign(ecBytes.begin() + i * numEcBytesInBlock, ecBytes.begin() + (i + 1) * numEcBytesInBlock);
+	int maxNumEcBytes = numEcBytesInBlock;
+
 	BitArray output;
 	// First, place data blocks.
 	for (int i = 0; i < maxNumDataBytes; ++i) {
@@ -455,20 +458,30 @@ BitArray InterleaveWithECBytes(const BitArray& bits, int numTotalBytes, int numD
 }
 
 
-static int ChooseMaskPattern(const BitArray& bits, ErrorCorrectionLevel ecLevel, const Version& version, TritMatrix& matrix)
+static int ChooseMaskPattern(const BitArray& bits, ErrorCorrectionLevel ecLevel, const Version& version, TritMatrix& matrix,
+							 int threads)
 {
-	int minPenalty = std::numeric_limits<int>::max();  // Lower penalty is better.
-	int bestMaskPattern = -1;
 	// We try all mask patterns to choose the best one.
-	for (int maskPattern = 0; maskPattern < MatrixUtil::NUM_MASK_PATTERNS; maskPattern++) {
-		MatrixUtil::BuildMatrix(bits, ecLevel, version, maskPattern, matrix);
-		int penalty = MaskUtil::CalculateMaskPenalty(matrix);
-		if (penalty < minPenalty) {
-			minPenalty = penalty;
-			bestMaskPattern = maskPattern;
-		}
-	}
-	return bestMaskPattern;
+	std::array<int, MatrixUtil::NUM_MASK_PATTERNS> penalties;
+	auto evaluate = [&](int maskPattern, TritMatrix& m) {
+		MatrixUtil::BuildMatrix(bits, ecLevel, version, maskPattern, m);
+		penalties[maskPattern] = MaskUtil::CalculateMaskPenalty(m);
+	};
+
+	int numTasks = std::min(threads, Size(penalties));
+	if (numTasks > 1) {
+		ParallelFor(numTasks, [&](int task) {
+			TritMatrix m(matrix.width(), matrix.height());
+			for (int maskPattern = task; maskPattern < Size(penalties); maskPattern += numTasks)
+				evaluate(maskPattern, m);
+		});
+	} else {
+		for (int maskPattern = 0; maskPattern < Size(penalties); maskPattern++)
+			evaluate(maskPattern, matrix);
+	}
+
+	// Lower penalty is better, the first one wins a tie.
+	return static_cast<int>(std::min_element(penalties.begin(), penalties.end()) - penalties.begin());
 }
 
 static int CalculateBitsNeeded(CodecMode::Mode mode, const BitArray& headerBits, const BitArray& dataBits, const Version& version)
@@ -493,16 +506,250 @@ static const Version& RecommendVersion(ErrorCorrectionLevel ecLevel, CodecMode::
 	return ChooseVersion(bitsNeeded, ecLevel);
 }
 
+/**
+* Terminates and interleaves the mode, length and data bits in "headerAndDataBits" and places them in the symbol.
+*/
+static EncodeResult EncodeMatrix(BitArray& headerAndDataBits, ErrorCorrectionLevel ecLevel, CodecMode::Mode mode,
+								 const Version& version, int maskPattern, int maskThreads)
+{
+	auto& ecBlocks = version.ecBlocksForLevel(ecLevel);
+	int numDataBytes = version.totalCodewords() - ecBlocks.totalCodewords();
+
+	// Terminate the bits properly.
+	TerminateBits(numDataBytes, headerAndDataBits);
+
+	// Interleave data bits with error correction code.
+	BitArray finalBits =
+		InterleaveWithECBytes(headerAndDataBits, version.totalCodewords(), numDataBytes, ecBlocks.numBlocks());
+
+	EncodeResult output;
+	output.ecLevel = ecLevel;
+	output.mode = mode;
+	output.version = &version;
+
+	//  Choose the mask pattern and set to "qrCode".
+	int dimension = version.dimensionForVersion();
+	TritMatrix matrix(dimension, dimension);
+	output.maskPattern = maskPattern != -1 ? maskPattern : ChooseMaskPattern(finalBits, ecLevel, version, matrix, maskThreads);
+
+	// Build the matrix and set it to "qrCode".
+	MatrixUtil::BuildMatrix(finalBits, ecLevel, version, output.maskPattern, matrix);
+
+	output.matrix = ToBitMatrix(matrix);
+
+	return output;
+}
+
+struct Segment
+{
+	CodecMode::Mode mode;
+	int begin, end;
+};
+
+static bool IsKanji(const std::string& shiftJisBytes)
+{
+	if (shiftJisBytes.size() != 2)
+		return false;
+	int code = ((shiftJisBytes[0] & 0xff) << 8) | (shiftJisBytes[1] & 0xff);
+	return (code >= 0x8140 && code <= 0x9ffc) || (code >= 0xe040 && code <= 0xebbf);
+}
+
+/**
+* Splits "content" into the sequence of segments that needs the fewest bits in all versions sharing the character
+* count bit lengths of "version". This is a shortest path search over the characters, where the state is the mode of
+* the current segment plus its number of characters modulo the group size of the mode (3 digits share 10 bits, 2
+* alphanumeric characters 11 bits). That makes every step cost the exact number of bits it adds to the symbol. Kanji
+* mode is only considered if "encoding" is Shift_JIS.
+* @param numBits receives the number of bits of all segments including mode and length info
+* @return an empty vector if "content" is empty or if "allowByte" is false and some character can not be encoded
+*   otherwise
+*/
+static std::vector<Segment> MinimalSegments(const std::wstring& content, CharacterSet encoding, const Version& version,
+											bool allowByte, int& numBits)
+{
+	// states: NUMERIC with 1, 2, 0 digits pending, ALPHANUMERIC with 1, 0 characters pending, BYTE, KANJI
+	constexpr int NUM_STATES = 7;
+	constexpr int INF = std::numeric_limits<int>::max() / 2;
+	static const CodecMode::Mode MODES[] = {CodecMode::NUMERIC, CodecMode::ALPHANUMERIC, CodecMode::BYTE, CodecMode::KANJI};
+	static const int FIRST_STATE[] = {0, 3, 5, 6};
+	static const int GROUP_SIZE[] = {3, 2, 1, 1};
+	static const int NUMERIC_BITS[] = {4, 3, 3};
+	static const int ALPHANUMERIC_BITS[] = {6, 5};
+
+	int length = Size(content);
+	if (length == 0) {
+		numBits = 0;
+		return {};
+	}
+
+	std::vector<int> numBytes(length);
+	std::vector<bool> isKanji(length);
+	for (int i = 0; i < length; ++i) {
+		auto bytes = TextEncoder::FromUnicode(content.substr(i, 1), encoding);
+		numBytes[i] = Size(bytes);
+		isKanji[i] = encoding == CharacterSet::Shift_JIS && IsKanji(bytes);
+	}
+
+	// bits of the i-th character in mode m with "pending" characters of the current group already in the segment
+	auto charBits = [&](int m, int pending, int i) {
+		wchar_t c = content[i];
+		switch (MODES[m]) {
+		case CodecMode::NUMERIC: return c >= '0' && c <= '9' ? NUMERIC_BITS[pending] : -1;
+		case CodecMode::ALPHANUMERIC: return GetAlphanumericCode(c) != -1 ? ALPHANUMERIC_BITS[pending] : -1;
+		case CodecMode::BYTE: return allowByte ? 8 * numBytes[i] : -1;
+		default: return isKanji[i] ? 13 : -1;
+		}
+	};
+
+	// cost[i][s] is the minimal number of bits for the first i characters ending in state s, from[i][s] the state
+	// before the i-th character, plus NUM_STATES if that character starts a new segment
+	std::vector<int> cost((length + 1) * NUM_STATES, INF);
+	std::vector<int> from((length + 1) * NUM_STATES, -1);
+	auto update = [&](int i, int s, int bits, int f) {
+		if (bits < cost[i * NUM_STATES + s]) {
+			cost[i * NUM_STATES + s] = bits;
+			from[i * NUM_STATES + s] = f;
+		}
+	};
+
+	for (int i = 0; i < length; ++i) {
+		int best = 0;
+		for (int s = 1; s < NUM_STATES; ++s)
+			if (cost[i * NUM_STATES + s] < cost[i * NUM_STATES + best])
+				best = s;
+		int bestCost = i == 0 ? 0 : cost[i * NUM_STATES + best];
+		if (bestCost == INF)
+			break;
+
+		for (int m = 0; m < 4; ++m) {
+			// continuing the current segment is checked first, so it wins a tie against starting a new one
+			for (int pending = 0; pending < GROUP_SIZE[m]; ++pending) {
+				int s = FIRST_STATE[m] + pending;
+				int bits = charBits(m, pending, i);
+				if (bits >= 0 && cost[i * NUM_STATES + s] < INF)
+					update(i + 1, FIRST_STATE[m] + (pending + 1) % GROUP_SIZE[m], cost[i * NUM_STATES + s] + bits, s);
+			}
+			int bits = charBits(m, 0, i);
+			if (bits >= 0)
+				update(i + 1, FIRST_STATE[m] + 1 % GROUP_SIZE[m],
+					   bestCost + 4 + CodecMode::CharacterCountBits(MODES[m], version) + bits, NUM_STATES + best);
+		}
+	}
+
+	int state = 0;
+	for (int s = 1; s < NUM_STATES; ++s)
+		if (cost[length * NUM_STATES + s] < cost[length * NUM_STATES + state])
+			state = s;
+	numBits = cost[length * NUM_STATES + state];
+	if (numBits == INF)
+		return {};
+
+	std::vector<Segment> segments;
+	for (int i = length, end = length; i > 0; --i) {
+		int f = from[i * NUM_STATES + state];
+		if (f >= NUM_STATES) {
+			int m = static_cast<int>(std::upper_bound(std::begin(FIRST_STATE), std::end(FIRST_STATE), state) - std::begin(FIRST_STATE)) - 1;
+			segments.push_back({MODES[m], i - 1, end});
+			end = i - 1;
+			f -= NUM_STATES;
+		}
+		state = f;
+	}
+	std::reverse(segments.begin(), segments.end());
+	return segments;
+}
+
+/**
+* Encodes "content" with the sequence of segments that results in the smallest symbol (see MinimalSegments), or in the
+* version "versionNumber" if that is valid. Stores the mode of the first segment in "mode".
+*/
+static const Version& EncodeMinimal(const std::wstring& content, ErrorCorrectionLevel ecLevel, CharacterSet charset,
+									bool charsetWasUnknown, int versionNumber, bool useGs1Format, CodecMode::Mode& mode,
+									BitArray& bits)
+{
+	static const int GROUP_FIRST_VERSION[] = {1, 10, 27, 41};
+
+	const Version* requested = Version::VersionForNumber(versionNumber);
+	for (int g = 0; g < 3; ++g) {
+		if (requested && (versionNumber < GROUP_FIRST_VERSION[g] || versionNumber >= GROUP_FIRST_VERSION[g + 1]))
+			continue;
+		const Version& groupVersion = *Version::VersionForNumber(GROUP_FIRST_VERSION[g]);
+		int headerBits = useGs1Format ? 4 : 0;
+
+		int numBits;
+		auto segments = MinimalSegments(content, charset, groupVersion, true, numBits);
+		bool hasByte = FindIf(segments, [](const Segment& s) { return s.mode == CodecMode::BYTE; }) != segments.end();
+		if (hasByte && !charsetWasUnknown) {
+			// the ECI costs 12 bits, avoiding byte mode altogether might be cheaper
+			int numBitsWithoutByte;
+			auto segmentsWithoutByte = MinimalSegments(content, charset, groupVersion, false, numBitsWithoutByte);
+			if (!segmentsWithoutByte.empty() && numBitsWithoutByte <= numBits + 12) {
+				segments = std::move(segmentsWithoutByte);
+				numBits = numBitsWithoutByte;
+				hasByte = false;
+			}
+			else {
+				headerBits += 12;
+			}
+		}
+
+		const Version* version = nullptr;
+		if (requested) {
+			if (!WillFit(headerBits + numBits, *requested, ecLevel))
+				throw std::invalid_argument("Data too big for requested version");
+			version = requested;
+		}
+		else {
+			for (int v = GROUP_FIRST_VERSION[g]; v < GROUP_FIRST_VERSION[g + 1] && !version; ++v)
+				if (WillFit(headerBits + numBits, *Version::VersionForNumber(v), ecLevel))
+					version = Version::VersionForNumber(v);
+			if (!version)
+				continue;
+		}
+
+		if (hasByte && !charsetWasUnknown) {
+			AppendECI(charset, bits);
+		}
+		if (useGs1Format) {
+			AppendModeInfo(CodecMode::FNC1_FIRST_POSITION, bits);
+		}
+		for (auto& segment : segments) {
+			auto text = content.substr(segment.begin, segment.end - segment.begin);
+			BitArray dataBits;
+			AppendBytes(text, segment.mode, charset, dataBits);
+			AppendModeInfo(segment.mode, bits);
+			AppendLengthInfo(segment.mode == CodecMode::BYTE ? dataBits.sizeInBytes() : Size(text), *version, segment.mode, bits);
+			bits.appendBitArray(dataBits);
+		}
+		mode = segments.empty() ? CodecMode::BYTE : segments.front().mode;
+		if (segments.empty()) {
+			// empty content, same as what the single mode encoder produces
+			AppendModeInfo(mode, bits);
+			AppendLengthInfo(0, *version, mode, bits);
+		}
+		return *version;
+	}
+	throw std::invalid_argument("Data too big");
+}
+
 EncodeResult
-Encoder::Encode(const std::wstring& content, ErrorCorrectionLevel ecLevel, CharacterSet charset, int versionNumber, bool useGs1Format, int maskPattern)
+Encoder::Encode(const std::wstring& content, ErrorCorrectionLevel ecLevel, CharacterSet charset, int versionNumber, bool useGs1Format, int maskPattern, int maskThreads,
+				bool minimalEncoding)
 {
 	bool charsetWasUnknown = charset == CharacterSet::Unknown;
 	if (charsetWasUnknown) {
 		charset = DEFAULT_BYTE_MODE_ENCODING;
 	}
 
+	if (minimalEncoding) {
+		CodecMode::Mode mode;
+		BitArray bits;
+		const Version& version = EncodeMinimal(content, ecLevel, charset, charsetWasUnknown, versionNumber, useGs1Format, mode, bits);
+		return EncodeMatrix(bits, ecLevel, mode, version, maskPattern, maskThreads);
+	}
+
 	// Pick an encoding mode appropriate for the content. Note that this will not attempt to use
-	// multiple modes / segments even if that were more efficient. Twould be nice.
+	// multiple modes / segments even if that were more efficient, see EncodeMinimal for that.
 	CodecMode::Mode mode = ChooseMode(content, charset);
 
 	// This will store the header information, like mode and
@@ -553,32 +800,114 @@ Encoder::Encode(const std::wstring& content, ErrorCorrectionLevel ecLevel, Chara
 	// Put data together into the overall payload
 	headerAndDataBits.appendBitArray(dataBits);
 
-	auto& ecBlocks = version->ecBlocksForLevel(ecLevel);
-	int numDataBytes = version->totalCodewords() - ecBlocks.totalCodewords();
+	return EncodeMatrix(headerAndDataBits, ecLevel, mode, *version, maskPattern, maskThreads);
+}
 
-	// Terminate the bits properly.
-	TerminateBits(numDataBytes, headerAndDataBits);
+BatchEncoder::BatchEncoder(ErrorCorrectionLevel ecLevel, CharacterSet encoding, int versionNumber, bool useGs1Format, int maskPattern)
+	: _ecLevel(ecLevel), _encoding(encoding), _charsetWasUnknown(encoding == CharacterSet::Unknown), _useGs1Format(useGs1Format),
+	  _version(Version::VersionForNumber(versionNumber)), _rsEncoder(GenericGF::QRCodeField256())
+{
+	if (_version == nullptr) {
+		throw std::invalid_argument("Invalid version number: " + std::to_string(versionNumber));
+	}
+	if (_charsetWasUnknown) {
+		_encoding = DEFAULT_BYTE_MODE_ENCODING;
+	}
+	_numDataBytes = _version->totalCodewords() - _version->ecBlocksForLevel(ecLevel).totalCodewords();
 
-	// Interleave data bits with error correction code.
-	BitArray finalBits =
-		InterleaveWithECBytes(headerAndDataBits, version->totalCodewords(), numDataBytes, ecBlocks.numBlocks());
+	int dimension = _version->dimensionForVersion();
+	TritMatrix matrix(dimension, dimension);
+	MatrixUtil::BuildFunctionPatterns(ecLevel, *_version, maskPattern, matrix);
+	_dataModules = MatrixUtil::DataModules(matrix);
+	// With all data bits being 0 the data modules end up holding the mask, encode() then only has to flip the set bits.
+	MatrixUtil::BuildMatrix(BitArray(), ecLevel, *_version, maskPattern, matrix);
+	_template = ToBitMatrix(matrix);
+}
 
-	EncodeResult output;
-	output.ecLevel = ecLevel;
-	output.mode = mode;
-	output.version = version;
+void
+BatchEncoder::encode(const std::wstring& content, BitMatrix& output)
+{
+	CodecMode::Mode mode = ChooseMode(content, _encoding);
 
-	//  Choose the mask pattern and set to "qrCode".
-	int dimension = version->dimensionForVersion();
-	TritMatrix matrix(dimension, dimension);
-	output.maskPattern = maskPattern != -1 ? maskPattern : ChooseMaskPattern(finalBits, ecLevel, *version, matrix);
+	BitArray bits;
+	if (mode == CodecMode::BYTE && !_charsetWasUnknown) {
+		AppendECI(_encoding, bits);
+	}
+	if (_useGs1Format) {
+		AppendModeInfo(CodecMode::FNC1_FIRST_POSITION, bits);
+	}
+	AppendModeInfo(mode, bits);
 
-	// Build the matrix and set it to "qrCode".
-	MatrixUtil::BuildMatrix(finalBits, ecLevel, *version, output.maskPattern, matrix);
+	BitArray dataBits;
+	AppendBytes(content, mode, _encoding, dataBits);
 
-	output.matrix = ToBitMatrix(matrix);
+	if (!WillFit(CalculateBitsNeeded(mode, bits, dataBits, *_version), *_version, _ecLevel)) {
+		throw std::invalid_argument("Data too big for requested version");
+	}
 
-	return output;
+	int numLetters = mode == CodecMode::BYTE ? dataBits.sizeInBytes() : Size(content);
+	AppendLengthInfo(numLetters, *_version, mode, bits);
+	bits.appendBitArray(dataBits);
+	TerminateBits(_numDataBytes, bits);
+
+	_dataBytes.resize(_numDataBytes);
+	for (int i = 0; i < _numDataBytes; ++i) {
+		int value = 0;
+		for (int j = 0; j < 8; ++j)
+			value = (value << 1) | bits.get(8 * i + j);
+		_dataBytes[i] = static_cast<uint8_t>(value);
+	}
+
+	// Same block layout and interleaving as InterleaveWithECBytes, but with the generator polynomials cached in
+	// _rsEncoder and without any per block allocations.
+	int numTotalBytes = _version->totalCodewords();
+	int numBlocks = _version->ecBlocksForLevel(_ecLevel).numBlocks();
+	int numEcBytesInBlock = 0;
+	int maxNumDataBytes = 0;
+	for (int i = 0, offset = 0; i < numBlocks; ++i) {
+		int numDataBytesInBlock = 0;
+		GetNumDataBytesAndNumECBytesForBlockID(numTotalBytes, _numDataBytes, numBlocks, i, numDataBytesInBlock, numEcBytesInBlock);
+		_blockBuffer.assign(_dataBytes.begin() + offset, _dataBytes.begin() + offset + numDataBytesInBlock);
+		_blockBuffer.resize(numDataBytesInBlock + numEcBytesInBlock, 0);
+		_rsEncoder.encode(_blockBuffer, numEcBytesInBlock);
+		_ecBytes.resize(numBlocks * numEcBytesInBlock);
+		std::copy(_blockBuffer.begin() + numDataBytesInBlock, _blockBuffer.end(), _ecBytes.begin() + i * numEcBytesInBlock);
+		maxNumDataBytes = std::max(maxNumDataBytes, numDataBytesInBlock);
+		offset += numDataBytesInBlock;
+	}
+
+	// All blocks have the same number of ec bytes, the ones in the second group have one more data byte.
+	int numShortBlocks = numBlocks - _numDataBytes % numBlocks;
+	int shortBlockSize = _numDataBytes / numBlocks;
+	_codewords.clear();
+	for (int i = 0; i < maxNumDataBytes; ++i) {
+		for (int b = 0, offset = 0; b < numBlocks; ++b) {
+			int size = shortBlockSize + (b >= numShortBlocks);
+			if (i < size)
+				_codewords.push_back(_dataBytes[offset + i]);
+			offset += size;
+		}
+	}
+	for (int i = 0; i < numEcBytesInBlock; ++i) {
+		for (int b = 0; b < numBlocks; ++b)
+			_codewords.push_back(_ecBytes[b * numEcBytesInBlock + i]);
+	}
+
+	int dimension = _template.width();
+	if (output.width() != dimension || output.height() != dimension) {
+		output = _template.copy();
+	} else {
+		for (int y = 0; y < dimension; ++y)
+			for (int x = 0; x < dimension; ++x)
+				output.set(x, y, _template.get(x, y));
+	}
+
+	for (int i = 0; i < 8 * Size(_codewords); ++i) {
+		if ((_codewords[i / 8] >> (7 - i % 8)) & 1) {
+			auto& p = _dataModules[i];
+			output.flip(p.x, p.y);
+		}
+	}
 }
 
 } // QRCode
@@ -15,7 +15,13 @@
 * See the License for the specific language governing permissions and
 * limitations under the License.
 */
+#include "BitMatrix.h"
+#include "ByteArray.h"
+#include "Point.h"
+#include "ReedSolomonEncoder.h"
+
 #include <string>
+#include <vector>
 
 namespace ZXing {
 
@@ -25,6 +31,7 @@ namespace QRCode {
 
 enum class ErrorCorrectionLevel;
 class EncodeResult;
+class Version;
 
 /**
 * @author satorux@google.com (Satoru Takabayashi) - creator
@@ -37,11 +44,57 @@ public:
 	* @param content text to encode
 	* @param ecLevel error correction level to use
 	* @param maskPattern Mask patern to use or -1 for automatically chosen pattern
+	* @param maskThreads number of threads (see ParallelFor) used to evaluate the 8 possible mask patterns, this does
+	*   not change the result
+	* @param minimalEncoding split the content into numeric, alphanumeric, byte and kanji segments such that the symbol
+	*   gets as small as possible, instead of encoding all of it in the one mode that fits every character
 	* @return {@link QRCode} representing the encoded QR code
 	* @throws WriterException if encoding can't succeed, because of for example invalid content
 	*   or configuration
 	*/
-	static EncodeResult Encode(const std::wstring& content, ErrorCorrectionLevel ecLevel, CharacterSet encoding, int versionNumber, bool useGs1Format, int maskPattern);
+	static EncodeResult Encode(const std::wstring& content, ErrorCorrectionLevel ecLevel, CharacterSet encoding, int versionNumber, bool useGs1Format, int maskPattern, int maskThreads = 1, bool minimalEncoding = false);
+};
+
+/**
+* Encodes many payloads sharing one format. Everything that only depends on the version, error correction level
+* and mask pattern (the Reed-Solomon generator polynomials, the function patterns and the data module layout) is
+* set up once in the constructor, so {@link encode} only does the per payload work. The result is identical to
+* what {@link Encoder::Encode} produces for the same parameters.
+*
+* An instance is not thread safe, use one per thread.
+*/
+class BatchEncoder
+{
+public:
+	/**
+	* @param versionNumber version (1-40) every payload is encoded with
+	* @param maskPattern mask pattern (0-7) every payload is encoded with
+	* @throws std::invalid_argument if the version or mask pattern is out of range
+	*/
+	BatchEncoder(ErrorCorrectionLevel ecLevel, CharacterSet encoding, int versionNumber, bool useGs1Format, int maskPattern);
+
+	/**
+	* Encode "content" into "output". If "output" already has the dimension of the symbol, its storage is reused.
+	* @throws std::invalid_argument if the content does not fit into the version
+	*/
+	void encode(const std::wstring& content, BitMatrix& output);
+
+	const Version& version() const { return *_version; }
+
+private:
+	ErrorCorrectionLevel _ecLevel;
+	CharacterSet _encoding;
+	bool _charsetWasUnknown;
+	bool _useGs1Format;
+	const Version* _version;
+	int _numDataBytes;
+	ReedSolomonEncoder _rsEncoder;
+	BitMatrix _template;
+	std::vector<PointI> _dataModules;
+	std::vector<int> _blockBuffer;
+	ByteArray _dataBytes;
+	ByteArray _ecBytes;
+	ByteArray _codewords;
 };
 
 } // QRCode
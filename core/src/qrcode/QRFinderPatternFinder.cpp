@@ -18,6 +18,12 @@
 #include "QRFinderPatternFinder.h"
 #include "QRFinderPatternInfo.h"
 #include "BitMatrix.h"
+#include "Deadline.h"
+#include "DecodeStats.h"
+#include "MemoryResource.h"
+#include "Parallel.h"
+#include "Pattern.h"
+#include "RunLengthIndex.h"
 #include "ZXContainerAlgorithms.h"
 
 #include <cassert>
@@ -25,6 +31,7 @@
 #include <cstdlib>
 #include <limits>
 #include <algorithm>
+#include <memory>
 
 namespace ZXing {
 namespace QRCode {
@@ -32,6 +39,9 @@ namespace QRCode {
 static const int CENTER_QUORUM = 2;
 static const int MIN_SKIP = 3; // 1 pixel/module times 3 modules/center
 static const int MAX_MODULES = 97; // support up to version 20 for mobile clients
+static const int MIN_MODULES_BETWEEN_CENTERS = 9;
+static const int MAX_MODULES_BETWEEN_CENTERS = 180;
+static const int MAX_CANDIDATES = 96; // bound of the O(n^3) searches for triples of finder patterns
 
 using StateCount = std::array<int, 5>;
 
@@ -94,7 +104,7 @@ static bool CrossCheckDiagonal(const BitMatrix& image, int centerI, int centerJ)
 
 	// Start counting up, left from center finding black center mass
 	int i = 0;
-	while (centerI >= i && centerJ >= i && image.get(centerJ - i, centerI - i)) {
+	while (centerI >= i && centerJ >= i && image.rowView(centerI - i)[centerJ - i]) {
 		stateCount[2]++;
 		i++;
 	}
@@ -103,7 +113,7 @@ static bool CrossCheckDiagonal(const BitMatrix& image, int centerI, int centerJ)
 	}
 
 	// Continue up, left finding white space
-	while (centerI >= i && centerJ >= i && !image.get(centerJ - i, centerI - i)) {
+	while (centerI >= i && centerJ >= i && !image.rowView(centerI - i)[centerJ - i]) {
 		stateCount[1]++;
 		i++;
 	}
@@ -112,7 +122,7 @@ static bool CrossCheckDiagonal(const BitMatrix& image, int centerI, int centerJ)
 	}
 
 	// Continue up, left finding black border
-	while (centerI >= i && centerJ >= i && image.get(centerJ - i, centerI - i)) {
+	while (centerI >= i && centerJ >= i && image.rowView(centerI - i)[centerJ - i]) {
 		stateCount[0]++;
 		i++;
 	}
@@ -125,12 +135,12 @@ static bool CrossCheckDiagonal(const BitMatrix& image, int centerI, int centerJ)
 
 	// Now also count down, right from center
 	i = 1;
-	while (centerI + i < maxI && centerJ + i < maxJ && image.get(centerJ + i, centerI + i)) {
+	while (centerI + i < maxI && centerJ + i < maxJ && image.rowView(centerI + i)[centerJ + i]) {
 		stateCount[2]++;
 		i++;
 	}
 
-	while (centerI + i < maxI && centerJ + i < maxJ && !image.get(centerJ + i, centerI + i)) {
+	while (centerI + i < maxI && centerJ + i < maxJ && !image.rowView(centerI + i)[centerJ + i]) {
 		stateCount[3]++;
 		i++;
 	}
@@ -138,7 +148,7 @@ static bool CrossCheckDiagonal(const BitMatrix& image, int centerI, int centerJ)
 		return false;
 	}
 
-	while (centerI + i < maxI && centerJ + i < maxJ && image.get(centerJ + i, centerI + i)) {
+	while (centerI + i < maxI && centerJ + i < maxJ && image.rowView(centerI + i)[centerJ + i]) {
 		stateCount[4]++;
 		i++;
 	}
@@ -149,79 +159,144 @@ static bool CrossCheckDiagonal(const BitMatrix& image, int centerI, int centerJ)
 	return FoundPatternDiagonal(stateCount);
 }
 
+/**
+* Run-length representation of the rows and columns of the image, each line is computed lazily and at most once. A
+* line is stored as the start positions of its runs (alternating white and black, starting with a possibly empty
+* white one) followed by the length of the line. If the runs of the whole image are already known (see
+* BinaryBitmap::getRunLengthIndex), they are taken from there instead of scanning the pixels again.
+*/
+class RunLengthLines
+{
+	const BitMatrix& _image;
+	const RunLengthIndex* _index;
+	std::vector<std::vector<int>> _rows, _columns;
+	PatternRow _buffer;
+
+	const std::vector<int>& get(std::vector<int>& line, int index, bool transpose)
+	{
+		if (line.empty()) {
+			const PatternRow* runs = &_buffer;
+			if (_index)
+				runs = transpose ? &_index->column(index) : &_index->row(index);
+			else
+				GetPatternRow(_image, index, _buffer, transpose);
+			line.reserve(runs->size() + 1);
+			int pos = 0;
+			for (int width : *runs) {
+				line.push_back(pos);
+				pos += width;
+			}
+			line.push_back(pos);
+		}
+		return line;
+	}
+
+public:
+	RunLengthLines(const BitMatrix& image, const RunLengthIndex* index)
+		: _image(image), _index(index), _rows(image.height()), _columns(image.width())
+	{}
+
+	const std::vector<int>& row(int y) { return get(_rows[y], y, false); }
+	const std::vector<int>& column(int x) { return get(_columns[x], x, true); }
+};
+
+/**
+* Walks the runs of a line (see RunLengthLines) from a start position towards its beginning (dir == -1) or its end
+* (dir == 1).
+*/
+class RunCursor
+{
+	const std::vector<int>& _line;
+	int _pos;
+	int _run;
+	int _dir;
+
+public:
+	RunCursor(const std::vector<int>& line, int pos, int dir)
+		: _line(line), _pos(pos), _run(static_cast<int>(std::upper_bound(line.begin(), line.end(), pos) - line.begin()) - 1),
+		  _dir(dir)
+	{}
+
+	bool atEnd() const { return _pos < 0 || _pos >= _line.back(); }
+	int pos() const { return _pos; }
+
+	/// Consumes the rest of the current run if it has the given color and returns the number of consumed pixels
+	int take(bool black)
+	{
+		if (atEnd() || (_run & 1) != black)
+			return 0;
+		int count = _dir > 0 ? _line[_run + 1] - _pos : _pos - _line[_run] + 1;
+		_pos += _dir * count;
+		_run += _dir;
+		return count;
+	}
+};
+
 /**
 * <p>After a horizontal scan finds a potential finder pattern, this method
 * "cross-checks" by scanning down vertically through the center of the possible
 * finder pattern to see if the same proportion is detected.</p>
 *
-* @param startI row where a finder pattern was detected
-* @param centerJ center of the section that appears to cross a finder pattern
+* This works on the run-length representation of the column (or row, see CrossCheckHorizontal), which gives the
+* same result as counting the pixels one by one.
+*
+* @param line runs of the column to check
+* @param start row where a finder pattern was detected
 * @param maxCount maximum reasonable number of modules that should be
 * observed in any reading state, based on the results of the horizontal scan
+* @param maxDeviation maximum deviation of the total size from originalStateCountTotal in fifths of it
 * @return vertical center of finder pattern, or {@link Float#NaN} if not found
 */
-static float CrossCheckVertical(const BitMatrix& image, int startI, int centerJ, int maxCount, int originalStateCountTotal)
+static float CrossCheck(const std::vector<int>& line, int start, int maxCount, int originalStateCountTotal,
+						int maxDeviation)
 {
 	StateCount stateCount = {};
-	int maxI = image.height();
 
 	// Start counting up from center
-	int i = startI;
-	while (i >= 0 && image.get(centerJ, i)) {
-		stateCount[2]++;
-		i--;
-	}
-	if (i < 0) {
+	RunCursor up(line, start, -1);
+	stateCount[2] = up.take(true);
+	if (up.atEnd()) {
 		return std::numeric_limits<float>::quiet_NaN();
 	}
-	while (i >= 0 && !image.get(centerJ, i) && stateCount[1] <= maxCount) {
-		stateCount[1]++;
-		i--;
-	}
+	stateCount[1] = up.take(false);
 	// If already too many modules in this state or ran off the edge:
-	if (i < 0 || stateCount[1] > maxCount) {
+	if (up.atEnd() || stateCount[1] > maxCount) {
 		return std::numeric_limits<float>::quiet_NaN();
 	}
-	while (i >= 0 && image.get(centerJ, i) && stateCount[0] <= maxCount) {
-		stateCount[0]++;
-		i--;
-	}
+	stateCount[0] = up.take(true);
 	if (stateCount[0] > maxCount) {
 		return std::numeric_limits<float>::quiet_NaN();
 	}
 
 	// Now also count down from center
-	i = startI + 1;
-	while (i < maxI && image.get(centerJ, i)) {
-		stateCount[2]++;
-		i++;
-	}
-	if (i == maxI) {
+	RunCursor down(line, start + 1, 1);
+	stateCount[2] += down.take(true);
+	if (down.atEnd()) {
 		return std::numeric_limits<float>::quiet_NaN();
 	}
-	while (i < maxI && !image.get(centerJ, i) && stateCount[3] < maxCount) {
-		stateCount[3]++;
-		i++;
-	}
-	if (i == maxI || stateCount[3] >= maxCount) {
+	stateCount[3] = down.take(false);
+	if (down.atEnd() || stateCount[3] >= maxCount) {
 		return std::numeric_limits<float>::quiet_NaN();
 	}
-	while (i < maxI && image.get(centerJ, i) && stateCount[4] < maxCount) {
-		stateCount[4]++;
-		i++;
-	}
+	stateCount[4] = down.take(true);
 	if (stateCount[4] >= maxCount) {
 		return std::numeric_limits<float>::quiet_NaN();
 	}
 
-	// If we found a finder-pattern-like section, but its size is more than 40% different than
+	// If we found a finder-pattern-like section, but its size is too different than
 	// the original, assume it's a false positive
 	int stateCountTotal = Reduce(stateCount);
-	if (5 * std::abs(stateCountTotal - originalStateCountTotal) >= 2 * originalStateCountTotal) {
+	if (5 * std::abs(stateCountTotal - originalStateCountTotal) >= maxDeviation * originalStateCountTotal) {
 		return std::numeric_limits<float>::quiet_NaN();
 	}
 
-	return FoundPatternCross(stateCount) ? CenterFromEnd(stateCount, i) : std::numeric_limits<float>::quiet_NaN();
+	return FoundPatternCross(stateCount) ? CenterFromEnd(stateCount, down.pos()) : std::numeric_limits<float>::quiet_NaN();
+}
+
+static float CrossCheckVertical(RunLengthLines& lines, int startI, int centerJ, int maxCount, int originalStateCountTotal)
+{
+	// more than 40% different than the original is a false positive
+	return CrossCheck(lines.column(centerJ), startI, maxCount, originalStateCountTotal, 2);
 }
 
 /**
@@ -229,65 +304,10 @@ static float CrossCheckVertical(const BitMatrix& image, int startI, int centerJ,
 * except it reads horizontally instead of vertically. This is used to cross-cross
 * check a vertical cross check and locate the real center of the alignment pattern.</p>
 */
-static float CrossCheckHorizontal(const BitMatrix& image, int startJ, int centerI, int maxCount, int originalStateCountTotal)
+static float CrossCheckHorizontal(RunLengthLines& lines, int startJ, int centerI, int maxCount, int originalStateCountTotal)
 {
-	StateCount stateCount = {};
-	int maxJ = image.width();
-
-	int j = startJ;
-	while (j >= 0 && image.get(j, centerI)) {
-		stateCount[2]++;
-		j--;
-	}
-	if (j < 0) {
-		return std::numeric_limits<float>::quiet_NaN();
-	}
-	while (j >= 0 && !image.get(j, centerI) && stateCount[1] <= maxCount) {
-		stateCount[1]++;
-		j--;
-	}
-	if (j < 0 || stateCount[1] > maxCount) {
-		return std::numeric_limits<float>::quiet_NaN();
-	}
-	while (j >= 0 && image.get(j, centerI) && stateCount[0] <= maxCount) {
-		stateCount[0]++;
-		j--;
-	}
-	if (stateCount[0] > maxCount) {
-		return std::numeric_limits<float>::quiet_NaN();
-	}
-
-	j = startJ + 1;
-	while (j < maxJ && image.get(j, centerI)) {
-		stateCount[2]++;
-		j++;
-	}
-	if (j == maxJ) {
-		return std::numeric_limits<float>::quiet_NaN();
-	}
-	while (j < maxJ && !image.get(j, centerI) && stateCount[3] < maxCount) {
-		stateCount[3]++;
-		j++;
-	}
-	if (j == maxJ || stateCount[3] >= maxCount) {
-		return std::numeric_limits<float>::quiet_NaN();
-	}
-	while (j < maxJ && image.get(j, centerI) && stateCount[4] < maxCount) {
-		stateCount[4]++;
-		j++;
-	}
-	if (stateCount[4] >= maxCount) {
-		return std::numeric_limits<float>::quiet_NaN();
-	}
-
-	// If we found a finder-pattern-like section, but its size is significantly different than
-	// the original, assume it's a false positive
-	int stateCountTotal = Reduce(stateCount);
-	if (5 * std::abs(stateCountTotal - originalStateCountTotal) >= originalStateCountTotal) {
-		return std::numeric_limits<float>::quiet_NaN();
-	}
-
-	return FoundPatternCross(stateCount) ? CenterFromEnd(stateCount, j) : std::numeric_limits<float>::quiet_NaN();
+	// more than 20% different than the original is a false positive
+	return CrossCheck(lines.row(centerI), startJ, maxCount, originalStateCountTotal, 1);
 }
 
 /**
@@ -324,47 +344,50 @@ static int FindRowSkip(const std::vector<FinderPattern>& possibleCenters, bool&
 }
 
 /**
-* <p>This is called when a horizontal scan finds a possible alignment pattern. It will
-* cross check with a vertical scan, and if successful, will, ah, cross-cross-check
-* with another horizontal scan. This is needed primarily to locate the real horizontal
-* center of the pattern in cases of extreme skew.
-* And then we cross-cross-cross check with another diagonal scan.</p>
-*
-* <p>If that succeeds the finder pattern location is added to a list that tracks
-* the number of times each location has been nearly-matched as a finder pattern.
-* Each additional find is more evidence that the location is in fact a finder
-* pattern center
+* This is called when a horizontal scan finds a possible finder pattern. It will cross check with a vertical scan,
+* and if successful, will, ah, cross-cross-check with another horizontal scan. This is needed primarily to locate the
+* real horizontal center of the pattern in cases of extreme skew. And then we cross-cross-cross check with another
+* diagonal scan.
 *
 * @param stateCount reading state module counts from horizontal scan
 * @param i row where finder pattern may be found
 * @param j end of possible finder pattern in row
-* @param possibleCenters [in/out] current list of centers to be updated
-* @return true if a finder pattern candidate was found this time
+* @return the refined center of the pattern or an invalid one if the checks failed
 */
-static bool HandlePossibleCenter(const BitMatrix& image, const StateCount& stateCount, int i, int j, std::vector<FinderPattern>& possibleCenters)
+static FinderPattern CrossCheckCenter(const BitMatrix& image, RunLengthLines& lines, const StateCount& stateCount, int i,
+									  int j)
 {
 	int stateCountTotal = Reduce(stateCount);
 	float centerJ = CenterFromEnd(stateCount, j);
-	float centerI = CrossCheckVertical(image, i, static_cast<int>(centerJ), stateCount[2], stateCountTotal);
+	float centerI = CrossCheckVertical(lines, i, static_cast<int>(centerJ), stateCount[2], stateCountTotal);
 	if (std::isnan(centerI))
-		return false;
+		return {};
 
 	// Re-cross check
-	centerJ = CrossCheckHorizontal(image, static_cast<int>(centerJ), static_cast<int>(centerI), stateCount[2],
+	centerJ = CrossCheckHorizontal(lines, static_cast<int>(centerJ), static_cast<int>(centerI), stateCount[2],
 								   stateCountTotal);
 	if (std::isnan(centerJ) || !CrossCheckDiagonal(image, (int)centerI, (int)centerJ))
-		return false;
+		return {};
+
+	return {centerJ, centerI, stateCountTotal / 7.0f};
+}
 
-	float estimatedModuleSize = stateCountTotal / 7.0f;
+/**
+* Adds a cross-checked center to the list of possible centers or, if it is about equal to an existing one,
+* combines it with that one.
+*/
+static void HandlePossibleCenter(const FinderPattern& pattern, std::vector<FinderPattern>& possibleCenters)
+{
+	float estimatedModuleSize = pattern.estimatedModuleSize();
+	float centerI = pattern.y();
+	float centerJ = pattern.x();
 	auto center = ZXing::FindIf(possibleCenters, [=](const FinderPattern& center) {
         return center.aboutEquals(estimatedModuleSize, centerI, centerJ);
     });
 	if (center != possibleCenters.end())
 		*center = center->combineEstimate(centerI, centerJ, estimatedModuleSize);
 	else
-		possibleCenters.emplace_back(centerJ, centerI, estimatedModuleSize);
-
-	return true;
+		possibleCenters.push_back(pattern);
 }
 
 /**
@@ -397,13 +420,57 @@ static bool HaveMultiplyConfirmedCenters(const std::vector<FinderPattern>& possi
 	return totalDeviation <= 0.05f * totalModuleSize;
 }
 
+/**
+* Orders three finder patterns in an order [A,B,C] such that AB is less than AC
+* and BC is less than AC, and the angle between BC and BA is less than 180 degrees.
+*/
+static FinderPatternInfo OrderPatterns(FinderPattern a, FinderPattern b, FinderPattern c)
+{
+	// Find distances between pattern centers
+	float distAB = distance(a, b);
+	float distBC = distance(b, c);
+	float distAC = distance(a, c);
+
+	// Assume one closest to other two is B; A and C will just be guesses at first
+	if (distBC >= distAB && distBC >= distAC)
+		std::swap(a, b);
+	else if (distAC >= distBC && distAC >= distAB)
+		; // do nothing, the order is correct
+	else
+		std::swap(b, c);
+
+	// Use cross product to figure out whether A and C are correct or flipped.
+	// This asks whether BC x BA has a positive z component, which is the arrangement
+	// we want for A, B, C. If it's negative, then we've got it flipped around and
+	// should swap A and C.
+	if (crossProduct(c - b, a - b) < 0) {
+		std::swap(a, c);
+	}
+
+	return {a, b, c};
+}
+
 /**
 * @return the 3 best {@link FinderPattern}s from our list of candidates. The "best" are
 *         those have similar module size and form a shape closer to a isosceles right triangle.
 *         Return invalid if 3 such finder patterns do not exist.
 */
+/**
+* Keeps only the MAX_CANDIDATES patterns confirmed in the most rows. Images full of finder like structures (e.g. high
+* frequency noise or a tiled logo) can produce thousands of candidates, which would stall the triple searches below.
+*/
+static void LimitCandidates(std::vector<FinderPattern>& possibleCenters)
+{
+	if (Size(possibleCenters) <= MAX_CANDIDATES)
+		return;
+	std::stable_sort(possibleCenters.begin(), possibleCenters.end(),
+					 [](const FinderPattern& a, const FinderPattern& b) { return a.count() > b.count(); });
+	possibleCenters.resize(MAX_CANDIDATES);
+}
+
 static FinderPatternInfo SelectBestPatterns(std::vector<FinderPattern> possibleCenters)
 {
+	LimitCandidates(possibleCenters);
 	int nbPossibleCenters = Size(possibleCenters);
 	if (nbPossibleCenters < 3) {
 		// Couldn't find enough finder patterns
@@ -455,137 +522,229 @@ static FinderPatternInfo SelectBestPatterns(std::vector<FinderPattern> possibleC
 		}
 	}
 
-	// Orders an array of three Points in an order [A,B,C] such that AB is less than AC
-	// and BC is less than AC, and the angle between BC and BA is less than 180 degrees.
-	// TODO: c++17
-	auto &a = bestPatterns[0], &b = bestPatterns[1], &c = bestPatterns[2];
+	if (!bestPatterns[0].isValid() && bestPatterns[1].isValid() && bestPatterns[2].isValid())
+		return {};
 
-	if (!a.isValid() && b.isValid() && c.isValid())
+	return OrderPatterns(bestPatterns[0], bestPatterns[1], bestPatterns[2]);
+}
+
+/**
+* @return all triples of {@link FinderPattern}s from our list of candidates that form a QR Code like shape, the ones
+*         closest to an isosceles right triangle first. A pattern may be part of more than one triple.
+*/
+static std::vector<FinderPatternInfo> SelectMultiplePatterns(std::vector<FinderPattern> possibleCenters)
+{
+	// Only consider patterns that have been found in more than one row
+	possibleCenters.erase(std::remove_if(possibleCenters.begin(), possibleCenters.end(),
+										 [](const FinderPattern& p) { return p.count() < CENTER_QUORUM; }),
+						  possibleCenters.end());
+	LimitCandidates(possibleCenters);
+
+	int nbPossibleCenters = Size(possibleCenters);
+	if (nbPossibleCenters < 3)
 		return {};
 
-	// Find distances between pattern centers
-	float distAB = distance(a, b);
-	float distBC = distance(b, c);
-	float distAC = distance(a, c);
+	std::sort(possibleCenters.begin(), possibleCenters.end(), [](const auto& a, const auto& b) {
+		return a.estimatedModuleSize() < b.estimatedModuleSize();
+	});
 
-	// Assume one closest to other two is B; A and C will just be guesses at first
-	if (distBC >= distAB && distBC >= distAC)
-		std::swap(a, b);
-	else if (distAC >= distBC && distAC >= distAB)
-		; // do nothing, the order is correct
-	else
-		std::swap(b, c);
+	std::vector<std::pair<double, FinderPatternInfo>> candidates;
 
-	// Use cross product to figure out whether A and C are correct or flipped.
-	// This asks whether BC x BA has a positive z component, which is the arrangement
-	// we want for A, B, C. If it's negative, then we've got it flipped around and
-	// should swap A and C.
-	if (crossProduct(c - b, a - b) < 0) {
-		std::swap(a, c);
+	for (int i = 0; i < nbPossibleCenters - 2; i++) {
+		float minModuleSize = possibleCenters[i].estimatedModuleSize();
+
+		for (int j = i + 1; j < nbPossibleCenters - 1; j++) {
+			for (int k = j + 1; k < nbPossibleCenters; k++) {
+				float maxModuleSize = possibleCenters[k].estimatedModuleSize();
+				if (maxModuleSize > minModuleSize * 1.4f)
+					break;
+
+				auto info = OrderPatterns(possibleCenters[i], possibleCenters[j], possibleCenters[k]);
+				float dA = distance(info.bottomLeft, info.topLeft);
+				float dB = distance(info.topLeft, info.topRight);
+				float dC = distance(info.topRight, info.bottomLeft);
+
+				// The distance between the centers has to be plausible for the module size
+				float moduleCount = (dA + dB) / (minModuleSize + maxModuleSize);
+				if (moduleCount < MIN_MODULES_BETWEEN_CENTERS || moduleCount > MAX_MODULES_BETWEEN_CENTERS)
+					continue;
+
+				// The two legs have to be of similar length and the triangle has to be close to right angled
+				float dCpy = std::sqrt(dA * dA + dB * dB);
+				if (std::abs(dA - dB) >= 0.1f * std::min(dA, dB) || std::abs(dC - dCpy) >= 0.1f * std::min(dC, dCpy))
+					continue;
+
+				// Same measure as in SelectBestPatterns but relative to the size of the triangle
+				double d = (std::abs(dC * dC - 2 * dB * dB) + std::abs(dC * dC - 2 * dA * dA)) / (dC * dC);
+				candidates.emplace_back(d, info);
+			}
+		}
 	}
 
-	return {a, b, c};
+	std::stable_sort(candidates.begin(), candidates.end(),
+					 [](const auto& a, const auto& b) { return a.first < b.first; });
+
+	std::vector<FinderPatternInfo> res;
+	res.reserve(candidates.size());
+	for (const auto& c : candidates)
+		res.push_back(c.second);
+	return res;
 }
 
-FinderPatternInfo FinderPatternFinder::Find(const BitMatrix& image, bool tryHarder)
+static StateCount RunWindow(const std::vector<int>& row, int k)
 {
-	int maxI = image.height();
-	int maxJ = image.width();
-	// We are looking for black/white/black/white/black modules in
-	// 1:1:3:1:1 ratio; this tracks the number of such modules seen so far
+	StateCount stateCount;
+	for (int n = 0; n < 5; ++n)
+		stateCount[n] = row[k + n + 1] - row[k + n];
+	return stateCount;
+}
 
+static int InitialRowSkip(int height, bool tryHarder, int scanStride)
+{
 	// Let's assume that the maximum version QR Code we support takes up 1/4 the height of the
 	// image, and then account for the center being 3 modules in size. This gives the smallest
 	// number of pixels the center could be, so skip this often. When trying harder, look for all
 	// QR versions regardless of how dense they are.
-	int iSkip = (3 * maxI) / (4 * MAX_MODULES);
+	int iSkip = (3 * height) / (4 * MAX_MODULES);
 	if (iSkip < MIN_SKIP || tryHarder) {
 		iSkip = MIN_SKIP;
 	}
+	return iSkip * std::max(1, scanStride);
+}
+
+/// A confirmed finder pattern center found in a row, together with the runs it was found in.
+struct RowHit
+{
+	StateCount stateCount;
+	int end; // column after the last run of the pattern
+	FinderPattern center;
+};
+
+using RowHits = std::vector<RowHit>;
+
+/**
+* Looks at every sequence of 5 runs of row i starting with a black one for black/white/black/white/black modules
+* in 1:1:3:1:1 ratio and returns the ones that survive the cross-checks, from left to right. The runs of a confirmed
+* pattern are not part of another one. This only depends on the image, so rows can be scanned in any order.
+*/
+static RowHits FindRowHits(const BitMatrix& image, RunLengthLines& lines, int i)
+{
+	RowHits hits;
+	// Get a row of black/white runs, the first one is white, the last one is the row length
+	const auto& row = lines.row(i);
+	int numRuns = Size(row) - 1;
+	for (int k = 1; k + 4 < numRuns; k += 2) {
+		StateCount stateCount = RunWindow(row, k);
+		if (!FoundPatternCross(stateCount))
+			continue;
+
+		int j = row[k + 5]; // end of the pattern
+		auto center = CrossCheckCenter(image, lines, stateCount, i, j);
+		if (!center.isValid())
+			continue;
+
+		hits.push_back({stateCount, j, center});
+		// Continue with the runs after the confirmed pattern
+		k += 4;
+	}
+	return hits;
+}
+
+/**
+* Provides the RowHits of the rows of an image. With one thread they are computed on demand. With more threads, the
+* image is split into bands of rows that are scanned concurrently up front. The caller then walks the rows in the
+* same order as with one thread, so the result does not depend on the number of threads.
+*/
+class RowScanner
+{
+	const BitMatrix& _image;
+	RunLengthLines _lines;
+	std::vector<RowHits> _rows;
+	RowHits _current;
+
+public:
+	RowScanner(const BitMatrix& image, const RunLengthIndex* runs, int threads) : _image(image), _lines(image, runs)
+	{
+		int height = image.height();
+		int numBands = std::min(threads, height);
+		if (numBands <= 1)
+			return;
+
+		_rows.resize(height);
+		const Deadline* deadline = Deadline::Current();
+		MemoryResource* memoryResource = MemoryResource::Current();
+		ParallelFor(numBands, [&](int band) {
+			// The deadline and memory resource are installed per thread, so forward the ones of the calling thread
+			std::unique_ptr<Deadline::Scope> scope(deadline ? new Deadline::Scope(*deadline) : nullptr);
+			MemoryResource::Scope memoryScope(memoryResource);
+			RunLengthLines lines(_image, runs);
+			for (int i = band * height / numBands; i < (band + 1) * height / numBands && !Deadline::Expired(); ++i)
+				_rows[i] = FindRowHits(_image, lines, i);
+		});
+	}
+
+	const RowHits& hits(int i)
+	{
+		const RowHits& res = _rows.empty() ? (_current = FindRowHits(_image, _lines, i)) : _rows[i];
+		// counted here and not in FindRowHits, so the rows scanned up front but never visited don't count
+		DecodeStats::AddFinderCandidates(Size(res));
+		return res;
+	}
+};
+
+FinderPatternInfo FinderPatternFinder::Find(const BitMatrix& image, bool tryHarder, int threads,
+											 const RunLengthIndex* runs, const ExpectedGeometry& expected,
+											 int scanStride)
+{
+	int maxI = image.height();
+	int maxJ = image.width();
+	int iSkip = InitialRowSkip(maxI, tryHarder, scanStride);
 
 	bool hasSkipped = false;
 	std::vector<FinderPattern> possibleCenters;
+	RowScanner scanner(image, runs, threads);
 
 	bool done = false;
 	for (int i = iSkip - 1; i < maxI && !done; i += iSkip) {
-		// Get a row of black/white values
-		StateCount stateCount = {};
-		size_t currentState = 0;
-		for (int j = 0; j < maxJ; j++) {
-			if (image.get(j, i)) {
-				// Black pixel
-				if ((currentState & 1) == 1) { // Counting white pixels
-					currentState++;
-				}
-				stateCount[currentState]++;
-			}
-			else { // White pixel
-				if ((currentState & 1) == 0) { // Counting black pixels
-					if (currentState == 4) { // A winner?
-						if (FoundPatternCross(stateCount)) { // Yes
-							bool confirmed = HandlePossibleCenter(image, stateCount, i, j, possibleCenters);
-							if (confirmed) {
-								// Start examining every other line. Checking each line turned out to be too
-								// expensive and didn't improve performance.
-								iSkip = 2;
-								if (hasSkipped) {
-									done = HaveMultiplyConfirmedCenters(possibleCenters);
-								}
-								else {
-									int rowSkip = FindRowSkip(possibleCenters, hasSkipped);
-									if (rowSkip > stateCount[2]) {
-										// Skip rows between row of lower confirmed center
-										// and top of presumed third confirmed center
-										// but back up a bit to get a full chance of detecting
-										// it, entire width of center of finder pattern
-
-										// Skip by rowSkip, but back off by stateCount[2] (size of last center
-										// of pattern we saw) to be conservative, and also back off by iSkip which
-										// is about to be re-added
-										i += rowSkip - stateCount[2] - iSkip;
-										j = maxJ - 1;
-									}
-								}
-								// Clear state to start looking again
-								currentState = 0;
-								stateCount.fill(0);
-							}
-							else {
-								stateCount[0] = stateCount[2];
-								stateCount[1] = stateCount[3];
-								stateCount[2] = stateCount[4];
-								stateCount[3] = 1;
-								stateCount[4] = 0;
-								currentState = 3;
-								continue;
-							}
-						}
-						else { // No, shift counts back by two
-							stateCount[0] = stateCount[2];
-							stateCount[1] = stateCount[3];
-							stateCount[2] = stateCount[4];
-							stateCount[3] = 1;
-							stateCount[4] = 0;
-							currentState = 3;
-						}
-					}
-					else {
-						stateCount[++currentState]++;
-					}
-				}
-				else { // Counting white pixels
-					stateCount[currentState]++;
-				}
-			}
-		}
-		if (FoundPatternCross(stateCount)) {
-			bool confirmed = HandlePossibleCenter(image, stateCount, i, maxJ, possibleCenters);
-			if (confirmed) {
+		if (Deadline::Expired())
+			return {};
+
+		for (const auto& hit : scanner.hits(i)) {
+			if (!expected.acceptsModuleSize(hit.center.estimatedModuleSize()))
+				continue;
+			const auto& stateCount = hit.stateCount;
+			HandlePossibleCenter(hit.center, possibleCenters);
+
+			if (hit.end == maxJ) {
+				// the pattern touches the right edge of the image
 				iSkip = stateCount[0];
 				if (hasSkipped) {
 					// Found a third one
 					done = HaveMultiplyConfirmedCenters(possibleCenters);
 				}
+				break;
+			}
+
+			// Start examining every other line. Checking each line turned out to be too
+			// expensive and didn't improve performance.
+			iSkip = 2;
+			if (hasSkipped) {
+				done = HaveMultiplyConfirmedCenters(possibleCenters);
+			}
+			else {
+				int rowSkip = FindRowSkip(possibleCenters, hasSkipped);
+				if (rowSkip > stateCount[2]) {
+					// Skip rows between row of lower confirmed center
+					// and top of presumed third confirmed center
+					// but back up a bit to get a full chance of detecting
+					// it, entire width of center of finder pattern
+
+					// Skip by rowSkip, but back off by stateCount[2] (size of last center
+					// of pattern we saw) to be conservative, and also back off by iSkip which
+					// is about to be re-added
+					i += rowSkip - stateCount[2] - iSkip;
+					break;
+				}
 			}
 		}
 	}
@@ -593,5 +752,30 @@ FinderPatternInfo FinderPatternFinder::Find(const BitMatrix& image, bool tryHard
 	return SelectBestPatterns(possibleCenters);
 }
 
+std::vector<FinderPatternInfo> FinderPatternFinder::FindMultiple(const BitMatrix& image, bool tryHarder, int threads,
+															   const RunLengthIndex* runs,
+															   const ExpectedGeometry& expected, int scanStride)
+{
+	int iSkip = InitialRowSkip(image.height(), tryHarder, scanStride);
+	std::vector<FinderPattern> possibleCenters;
+	RowScanner scanner(image, runs, threads);
+
+	// Unlike Find, scan the whole image and do not stop at the first three confirmed centers
+	for (int i = iSkip - 1; i < image.height(); i += iSkip) {
+		if (Deadline::Expired())
+			return {};
+
+		for (const auto& hit : scanner.hits(i)) {
+			if (!expected.acceptsModuleSize(hit.center.estimatedModuleSize()))
+				continue;
+			HandlePossibleCenter(hit.center, possibleCenters);
+			// Examine every other line from now on, see Find
+			iSkip = 2;
+		}
+	}
+
+	return SelectMultiplePatterns(possibleCenters);
+}
+
 } // QRCode
 } // ZXing
@@ -16,12 +16,15 @@
 * limitations under the License.
 */
 
+#include "ExpectedGeometry.h"
+
 #include <array>
 #include <vector>
 
 namespace ZXing {
 
 class BitMatrix;
+class RunLengthIndex;
 
 namespace QRCode {
 
@@ -37,7 +40,25 @@ class FinderPatternInfo;
 class FinderPatternFinder
 {
 public:
-	static FinderPatternInfo Find(const BitMatrix& image, bool tryHarder);
+	/**
+	* Finds the three finder patterns of a QR Code in the image.
+	*
+	* @param threads number of bands of rows that are scanned concurrently, this does not change the result
+	* @param runs optional run lengths of image, saves scanning its pixels, this does not change the result either
+	* @param expected patterns with a module size outside of the expected range are ignored
+	* @param scanStride the rows are searched that many times more sparsely, see DecodeHints::scanStride
+	*/
+	static FinderPatternInfo Find(const BitMatrix& image, bool tryHarder, int threads = 1,
+								  const RunLengthIndex* runs = nullptr, const ExpectedGeometry& expected = {},
+								  int scanStride = 1);
+
+	/**
+	* Finds all finder patterns in the image and returns every triple of them that could belong to one QR Code,
+	* best matching first. The triples are not disjoint, a pattern may show up in several of them.
+	*/
+	static std::vector<FinderPatternInfo> FindMultiple(const BitMatrix& image, bool tryHarder, int threads = 1,
+													   const RunLengthIndex* runs = nullptr,
+													   const ExpectedGeometry& expected = {}, int scanStride = 1);
 };
 
 } // QRCode
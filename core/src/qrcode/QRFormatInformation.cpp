@@ -68,7 +68,8 @@ static const std::array<int, 2> FORMAT_INFO_DECODE_LOOKUP[] = {
 
 } // anonymous
 
-FormatInformation::FormatInformation(int formatInfo)
+FormatInformation::FormatInformation(int formatInfo, int hammingDistance)
+	: _hammingDistance(static_cast<uint8_t>(hammingDistance))
 {
 	// Bits 3,4
 	_errorCorrectionLevel = ECLevelFromBits((formatInfo >> 3) & 0x03);
@@ -126,7 +127,7 @@ FormatInformation::DoDecodeFormatInformation(int maskedFormatInfo1, int maskedFo
 	// Hamming distance of the 32 masked codes is 7, by construction, so <= 3 bits
 	// differing means we found a match
 	if (bestDifference <= 3) {
-		return {bestFormatInfo};
+		return {bestFormatInfo, bestDifference};
 	}
 	return {};
 }
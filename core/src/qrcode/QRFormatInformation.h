@@ -46,6 +46,11 @@ public:
 		return _dataMask;
 	}
 
+	/// Number of bits of the closer one of the two copies that differ from the valid code word, at most 3
+	int hammingDistance() const {
+		return _hammingDistance;
+	}
+
 	bool isValid() const { return _errorCorrectionLevel != ErrorCorrectionLevel::Invalid; }
 
 	bool operator==(const FormatInformation& other) const {
@@ -55,8 +60,9 @@ public:
 private:
 	ErrorCorrectionLevel _errorCorrectionLevel = ErrorCorrectionLevel::Invalid;
 	uint8_t _dataMask = 0;
+	uint8_t _hammingDistance = 0;
 
-	FormatInformation(int formatInfo);
+	FormatInformation(int formatInfo, int hammingDistance = 0);
 
 	static FormatInformation DoDecodeFormatInformation(int maskedFormatInfo1, int maskedFormatInfo2);
 };
@@ -16,11 +16,13 @@
 */
 
 #include "QRMaskUtil.h"
+#include "BitHacks.h"
+#include "ZXContainerAlgorithms.h"
 
-#include <algorithm>
 #include <array>
+#include <cstdint>
 #include <cstdlib>
-#include <cassert>
+#include <vector>
 
 namespace ZXing {
 namespace QRCode {
@@ -33,46 +35,124 @@ static const int N3 = 40;
 static const int N4 = 10;
 
 /**
-* Helper function for applyMaskPenaltyRule1. We need this for doing this calculation in both
-* vertical and horizontal orders respectively.
+* A row or column of the matrix with one bit per module, so that the penalty rules can look at 32 modules at once.
+* Bit x of the line is the module at position x, all bits beyond the length of the line are 0.
 */
-static int ApplyMaskPenaltyRule1Internal(const TritMatrix& matrix, bool isHorizontal) {
-	int penalty = 0;
-	int width = matrix.width();
-	int height = matrix.height();
-	int iLimit = isHorizontal ? height : width;
-	int jLimit = isHorizontal ? width : height;
-	for (int i = 0; i < iLimit; i++) {
-		int numSameBitCells = 0;
-		int prevBit = -1;
-		for (int j = 0; j < jLimit; j++) {
-			int bit = isHorizontal ? matrix.get(j, i) : matrix.get(i, j);
-			if (bit == prevBit) {
-				numSameBitCells++;
-			}
-			else {
-				if (numSameBitCells >= 5) {
-					penalty += N1 + (numSameBitCells - 5);
-				}
-				numSameBitCells = 1;  // Include the cell itself.
-				prevBit = bit;
-			}
-		}
-		if (numSameBitCells >= 5) {
-			penalty += N1 + (numSameBitCells - 5);
-		}
+class PackedLine
+{
+	static constexpr int NUM_WORDS = 6; // enough for the 177 modules of version 40
+	std::array<uint32_t, NUM_WORDS> _words = {};
+
+public:
+	/// Line with the bits [0, length) set
+	static PackedLine Ones(int length)
+	{
+		PackedLine res;
+		for (int i = 0; i < NUM_WORDS && length > 0; ++i, length -= 32)
+			res._words[i] = length >= 32 ? 0xFFFFFFFF : (1u << length) - 1;
+		return res;
 	}
-	return penalty;
+
+	void set(int x) { _words[x / 32] |= 1u << (x % 32); }
+
+	int count() const
+	{
+		int res = 0;
+		for (auto w : _words)
+			res += BitHacks::CountBitsSet(w);
+		return res;
+	}
+
+	/// Bit x of the result is bit x + n of this line (0 < n < 32)
+	PackedLine operator>>(int n) const
+	{
+		PackedLine res;
+		for (int i = 0; i < NUM_WORDS; ++i)
+			res._words[i] = (_words[i] >> n) | (i + 1 < NUM_WORDS ? _words[i + 1] << (32 - n) : 0);
+		return res;
+	}
+
+	/// Bit x of the result is bit x - n of this line (0 < n < 32), bits before the start are 0
+	PackedLine operator<<(int n) const
+	{
+		PackedLine res;
+		for (int i = 0; i < NUM_WORDS; ++i)
+			res._words[i] = (_words[i] << n) | (i > 0 ? _words[i - 1] >> (32 - n) : 0);
+		return res;
+	}
+
+	PackedLine operator~() const
+	{
+		PackedLine res;
+		for (int i = 0; i < NUM_WORDS; ++i)
+			res._words[i] = ~_words[i];
+		return res;
+	}
+
+	PackedLine operator&(const PackedLine& o) const
+	{
+		PackedLine res;
+		for (int i = 0; i < NUM_WORDS; ++i)
+			res._words[i] = _words[i] & o._words[i];
+		return res;
+	}
+
+	PackedLine operator|(const PackedLine& o) const
+	{
+		PackedLine res;
+		for (int i = 0; i < NUM_WORDS; ++i)
+			res._words[i] = _words[i] | o._words[i];
+		return res;
+	}
+
+	PackedLine operator^(const PackedLine& o) const
+	{
+		PackedLine res;
+		for (int i = 0; i < NUM_WORDS; ++i)
+			res._words[i] = _words[i] ^ o._words[i];
+		return res;
+	}
+};
+
+/**
+* Helper function for applyMaskPenaltyRule1. A run of n >= 5 cells of the same color gives a penalty of
+* N1 + (n - 5). Such a run contains n - 4 windows of 5 equal cells and starts at exactly one of them, so the penalty
+* is the number of those windows plus (N1 - 1) times the number of runs.
+*/
+static int ApplyMaskPenaltyRule1Internal(const PackedLine& line, const PackedLine& notLast)
+{
+	auto same = ~(line ^ (line >> 1)) & notLast; // bit x: cell x equals cell x + 1
+	auto windows = same & (same >> 1) & (same >> 2) & (same >> 3);
+	auto runStarts = windows & ~(same << 1);
+	return windows.count() + (N1 - 1) * runStarts.count();
 }
 
+/**
+* Helper function for applyMaskPenaltyRule3. Counts the 1:1:3:1:1 patterns with 4 white cells before or after them.
+* Cells outside of the matrix count as white.
+*/
+static int ApplyMaskPenaltyRule3Internal(const PackedLine& line)
+{
+	auto finder = line & ~(line >> 1) & (line >> 2) & (line >> 3) & (line >> 4) & ~(line >> 5) & (line >> 6);
+	auto whiteBefore = ~((line << 1) | (line << 2) | (line << 3) | (line << 4));
+	auto whiteAfter = ~((line >> 7) | (line >> 8) | (line >> 9) | (line >> 10));
+	return (finder & (whiteBefore | whiteAfter)).count();
+}
 
 /**
 * Apply mask penalty rule 1 and return the penalty. Find repetitive cells with the same color and
 * give penalty to them. Example: 00000 or 11111.
 */
-static int ApplyMaskPenaltyRule1(const TritMatrix& matrix)
+static int ApplyMaskPenaltyRule1(const std::vector<PackedLine>& rows, const std::vector<PackedLine>& columns)
 {
-	return ApplyMaskPenaltyRule1Internal(matrix, true) + ApplyMaskPenaltyRule1Internal(matrix, false);
+	auto notLast = PackedLine::Ones(Size(columns) - 1);
+	int penalty = 0;
+	for (auto& row : rows)
+		penalty += ApplyMaskPenaltyRule1Internal(row, notLast);
+	notLast = PackedLine::Ones(Size(rows) - 1);
+	for (auto& column : columns)
+		penalty += ApplyMaskPenaltyRule1Internal(column, notLast);
+	return penalty;
 }
 
 /**
@@ -80,63 +160,30 @@ static int ApplyMaskPenaltyRule1(const TritMatrix& matrix)
 * penalty to them. This is actually equivalent to the spec's rule, which is to find MxN blocks and give a
 * penalty proportional to (M-1)x(N-1), because this is the number of 2x2 blocks inside such a block.
 */
-static int ApplyMaskPenaltyRule2(const TritMatrix& matrix)
+static int ApplyMaskPenaltyRule2(const std::vector<PackedLine>& rows, int width)
 {
+	auto notLast = PackedLine::Ones(width - 1);
 	int penalty = 0;
-	for (int y = 0; y < matrix.height() - 1; y++) {
-		for (int x = 0; x < matrix.width() - 1; x++) {
-			auto value = matrix.get(x, y);
-			if (value == matrix.get(x+1, y) && value == matrix.get(x, y+1) && value == matrix.get(x+1, y+1)) {
-				penalty++;
-			}
-		}
+	for (size_t y = 0; y + 1 < rows.size(); y++) {
+		auto& a = rows[y];
+		auto& b = rows[y + 1];
+		penalty += (~(a ^ (a >> 1)) & ~(a ^ b) & ~(b ^ (b >> 1)) & notLast).count();
 	}
 	return N2 * penalty;
 }
 
-template<size_t N>
-static bool HasPatternAt(const std::array<bool, N>& pattern, const Trit* begin, int count, int stride) {
-	assert(std::abs(count) <= (int)N);
-	auto end = begin + count * stride;
-	if (count < 0)
-		std::swap(begin, end);
-	auto a = begin;
-	for (auto b = pattern.begin(); a < end && b != pattern.end(); a += stride, ++b)
-		if (*a != *b)
-			return false;
-	return true;
-}
-
 /**
 * Apply mask penalty rule 3 and return the penalty. Find consecutive runs of 1:1:3:1:1:4
 * starting with black, or 4:1:1:3:1:1 starting with white, and give penalty to them.  If we
 * find patterns like 000010111010000, we give penalty once.
 */
-static int ApplyMaskPenaltyRule3(const TritMatrix& matrix)
+static int ApplyMaskPenaltyRule3(const std::vector<PackedLine>& rows, const std::vector<PackedLine>& columns)
 {
-	const std::array<bool, 4> white = {0, 0, 0, 0};
-	const std::array<bool, 7> finder = {1, 0, 1, 1, 1, 0, 1};
-	const int whiteSize = (int)white.size();
-	const int finderSize = (int)finder.size();
-
 	int numPenalties = 0;
-	int width = matrix.width();
-	int height = matrix.height();
-	for (int y = 0; y < height; y++) {
-		for (int x = 0; x < width; x++) {
-			auto i = &matrix.get(x, y);
-			if (x <= width - finderSize && HasPatternAt(finder, i, finderSize, 1) &&
-				(HasPatternAt(white, i, -std::min(x, whiteSize), 1) ||
-				 HasPatternAt(white, i + finderSize, std::min(width - x - finderSize, whiteSize), 1))) {
-				numPenalties++;
-			}
-			if (y <= height - finderSize && HasPatternAt(finder, i, finderSize, width) &&
-				(HasPatternAt(white, i, -std::min(y, whiteSize), width) ||
-				 HasPatternAt(white, i + finderSize * width, std::min(height - y - finderSize, whiteSize), width))) {
-				numPenalties++;
-			}
-		}
-	}
+	for (auto& row : rows)
+		numPenalties += ApplyMaskPenaltyRule3Internal(row);
+	for (auto& column : columns)
+		numPenalties += ApplyMaskPenaltyRule3Internal(column);
 	return numPenalties * N3;
 }
 
@@ -144,22 +191,34 @@ static int ApplyMaskPenaltyRule3(const TritMatrix& matrix)
 * Apply mask penalty rule 4 and return the penalty. Calculate the ratio of dark cells and give
 * penalty if the ratio is far from 50%. It gives 10 penalty for 5% distance.
 */
-static int ApplyMaskPenaltyRule4(const TritMatrix& matrix)
+static int ApplyMaskPenaltyRule4(const std::vector<PackedLine>& rows, int width)
 {
-	auto numDarkCells = std::count_if(matrix.begin(), matrix.end(), [](int8_t cell){ return cell == 1; });
-	auto numTotalCells = matrix.size();
-	auto fivePercentVariances = std::abs(numDarkCells * 2 - numTotalCells) * 10 / numTotalCells;
-	return static_cast<int>(fivePercentVariances * N4);
+	int numDarkCells = 0;
+	for (auto& row : rows)
+		numDarkCells += row.count();
+	int numTotalCells = width * Size(rows);
+	int fivePercentVariances = std::abs(numDarkCells * 2 - numTotalCells) * 10 / numTotalCells;
+	return fivePercentVariances * N4;
 }
 
 // The mask penalty calculation is complicated.  See Table 21 of JISX0510:2004 (p.45) for details.
 // Basically it applies four rules and summate all penalties.
 int CalculateMaskPenalty(const TritMatrix& matrix)
 {
-	return MaskUtil::ApplyMaskPenaltyRule1(matrix)
-		   + MaskUtil::ApplyMaskPenaltyRule2(matrix)
-		   + MaskUtil::ApplyMaskPenaltyRule3(matrix)
-		   + MaskUtil::ApplyMaskPenaltyRule4(matrix);
+	int width = matrix.width();
+	int height = matrix.height();
+	std::vector<PackedLine> rows(height), columns(width);
+	for (int y = 0; y < height; y++)
+		for (int x = 0; x < width; x++)
+			if (matrix.get(x, y)) {
+				rows[y].set(x);
+				columns[x].set(y);
+			}
+
+	return MaskUtil::ApplyMaskPenaltyRule1(rows, columns)
+		   + MaskUtil::ApplyMaskPenaltyRule2(rows, width)
+		   + MaskUtil::ApplyMaskPenaltyRule3(rows, columns)
+		   + MaskUtil::ApplyMaskPenaltyRule4(rows, width);
 }
 
 } // MaskUtil
@@ -20,11 +20,16 @@
 #include "QRVersion.h"
 #include "BitArray.h"
 #include "BitHacks.h"
+#include "MemoryResource.h"
 #include "ZXStrConvWorkaround.h"
 
+#include <algorithm>
 #include <array>
+#include <cstdint>
+#include <mutex>
 #include <string>
 #include <stdexcept>
+#include <vector>
 
 namespace ZXing {
 namespace QRCode {
@@ -413,12 +418,11 @@ static bool GetDataMaskBit(int maskPattern, int x, int y)
 	return intermediate == 0;
 }
 
-// Embed "dataBits" using "getMaskPattern". On success, modify the matrix and return true.
-// For debugging purposes, it skips masking process if "getMaskPattern" is -1.
-// See 8.7 of JISX0510:2004 (p.38) for how to embed data bits.
-static void EmbedDataBits(const BitArray& dataBits, int maskPattern, TritMatrix& matrix)
+// Visit the empty (data) cells of "matrix" in the order the data bits are placed. See 8.7 of
+// JISX0510:2004 (p.38).
+template <typename F>
+static void ForEachDataModule(const TritMatrix& matrix, F f)
 {
-	int bitIndex = 0;
 	int direction = -1;
 	// Start from the right bottom cell.
 	int x = matrix.width() - 1;
@@ -431,19 +435,9 @@ static void EmbedDataBits(const BitArray& dataBits, int maskPattern, TritMatrix&
 		while (y >= 0 && y < matrix.height()) {
 			for (int xx = x; xx > x - 2; --xx) {
 				// Skip the cell if it's not empty.
-				if (!matrix.get(xx, y).isEmpty()) {
-					continue;
+				if (matrix.get(xx, y).isEmpty()) {
+					f(xx, y);
 				}
-				// Padding bit. If there is no bit left, we'll fill the left cells with 0, as described
-				// in 8.4.9 of JISX0510:2004 (p. 24).
-				bool bit = bitIndex < dataBits.size() ? dataBits.get(bitIndex) : false;
-				++bitIndex;
-
-				// Skip masking if mask_pattern is -1.
-				if (maskPattern != -1 && GetDataMaskBit(maskPattern, xx, y)) {
-					bit = !bit;
-				}
-				matrix.set(xx, y, bit);
 			}
 			y += direction;
 		}
@@ -451,25 +445,98 @@ static void EmbedDataBits(const BitArray& dataBits, int maskPattern, TritMatrix&
 		y += direction;
 		x -= 2;  // Move to the left.
 	}
+}
+
+/**
+* What BuildMatrix needs of a version, computed once per version: the function patterns (with the type information
+* for ecLevel L and mask pattern 0, which BuildMatrix overwrites) and the data modules in the order the data bits are
+* placed, each with the mask patterns that flip it (bit i for mask pattern i).
+*/
+struct DataLayout
+{
+	struct Module
+	{
+		uint8_t x, y, masks;
+	};
+
+	TritMatrix functionPatterns;
+	std::vector<Module> modules;
+};
+
+static const DataLayout& DataLayoutForVersion(const Version& version)
+{
+	// the layouts are cached for the lifetime of the process, so keep them out of the memory resource of the call
+	MemoryResource::Scope scope(nullptr);
+	static std::array<std::once_flag, 40> once;
+	static std::array<DataLayout, 40> layouts;
+	int index = version.versionNumber() - 1;
+	std::call_once(once[index], [&]() {
+		auto& layout = layouts[index];
+		int dimension = version.dimensionForVersion();
+		layout.functionPatterns = TritMatrix(dimension, dimension);
+		EmbedBasicPatterns(version, layout.functionPatterns);
+		EmbedTypeInfo(ErrorCorrectionLevel::Low, 0, layout.functionPatterns);
+		MaybeEmbedVersionInfo(version, layout.functionPatterns);
+		ForEachDataModule(layout.functionPatterns, [&](int x, int y) {
+			uint8_t masks = 0;
+			for (int maskPattern = 0; maskPattern < MatrixUtil::NUM_MASK_PATTERNS; ++maskPattern)
+				masks |= GetDataMaskBit(maskPattern, x, y) << maskPattern;
+			layout.modules.push_back({static_cast<uint8_t>(x), static_cast<uint8_t>(y), masks});
+		});
+	});
+	return layouts[index];
+}
+
+static void CopyFunctionPatterns(const DataLayout& layout, TritMatrix& matrix)
+{
+	const auto& patterns = layout.functionPatterns;
+	if (matrix.width() == patterns.width() && matrix.height() == patterns.height())
+		std::copy(patterns.begin(), patterns.end(), &matrix(0, 0));
+	else
+		matrix = patterns.copy();
+}
+
+// Build 2D matrix of QR Code from "dataBits" with "ecLevel", "version" and "getMaskPattern". The function patterns
+// are copied from the cached layout of the version and the data bits scattered to its data modules, see 8.7 of
+// JISX0510:2004 (p.38).
+void
+MatrixUtil::BuildMatrix(const BitArray& dataBits, ErrorCorrectionLevel ecLevel, const Version& version, int maskPattern, TritMatrix& matrix)
+{
+	const auto& layout = DataLayoutForVersion(version);
+	CopyFunctionPatterns(layout, matrix);
+	EmbedTypeInfo(ecLevel, maskPattern, matrix);
+
 	// All bits should be consumed.
-	if (bitIndex < dataBits.size()) {
-		throw std::invalid_argument("Not all bits consumed: " + std::to_string(bitIndex) + '/' + std::to_string(dataBits.size()));
+	int numModules = Size(layout.modules);
+	if (numModules < dataBits.size()) {
+		throw std::invalid_argument("Not all bits consumed: " + std::to_string(numModules) + '/' +
+									std::to_string(dataBits.size()));
+	}
+
+	const uint8_t mask = static_cast<uint8_t>(1 << maskPattern);
+	for (int i = 0; i < numModules; ++i) {
+		const auto& module = layout.modules[i];
+		// Padding bit. If there is no bit left, we'll fill the left cells with 0, as described
+		// in 8.4.9 of JISX0510:2004 (p. 24).
+		bool bit = i < dataBits.size() && dataBits.get(i);
+		matrix(module.x, module.y) = bit != ((module.masks & mask) != 0);
 	}
 }
 
-// Build 2D matrix of QR Code from "dataBits" with "ecLevel", "version" and "getMaskPattern". On
-// success, store the result in "matrix" and return true.
 void
-MatrixUtil::BuildMatrix(const BitArray& dataBits, ErrorCorrectionLevel ecLevel, const Version& version, int maskPattern, TritMatrix& matrix)
+MatrixUtil::BuildFunctionPatterns(ErrorCorrectionLevel ecLevel, const Version& version, int maskPattern, TritMatrix& matrix)
 {
-	matrix.clear();
-	EmbedBasicPatterns(version, matrix);
-	// Type information appear with any version.
+	CopyFunctionPatterns(DataLayoutForVersion(version), matrix);
+	// Type information appear with any version, version info (if version >= 7) is part of the layout.
 	EmbedTypeInfo(ecLevel, maskPattern, matrix);
-	// Version info appear if version >= 7.
-	MaybeEmbedVersionInfo(version, matrix);
-	// Data should be embedded at end.
-	EmbedDataBits(dataBits, maskPattern, matrix);
+}
+
+std::vector<PointI>
+MatrixUtil::DataModules(const TritMatrix& functionPatterns)
+{
+	std::vector<PointI> res;
+	ForEachDataModule(functionPatterns, [&](int x, int y) { res.push_back({x, y}); });
+	return res;
 }
 
 } // QRCode
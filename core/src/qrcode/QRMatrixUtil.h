@@ -16,8 +16,11 @@
 * limitations under the License.
 */
 
+#include "Point.h"
 #include "TritMatrix.h"
 
+#include <vector>
+
 namespace ZXing {
 
 class BitArray;
@@ -33,6 +36,17 @@ public:
 	static const int NUM_MASK_PATTERNS = 8;
 
 	static void BuildMatrix(const BitArray& dataBits, ErrorCorrectionLevel ecLevel, const Version& version, int maskPattern, TritMatrix& matrix);
+
+	/**
+	* Everything {@link BuildMatrix} embeds except the data bits: finder, alignment and timing patterns plus the
+	* type and version information. The data cells are left empty.
+	*/
+	static void BuildFunctionPatterns(ErrorCorrectionLevel ecLevel, const Version& version, int maskPattern, TritMatrix& matrix);
+
+	/**
+	* The positions of the empty cells of "functionPatterns" in the order {@link BuildMatrix} places the data bits.
+	*/
+	static std::vector<PointI> DataModules(const TritMatrix& functionPatterns);
 };
 
 } // QRCode
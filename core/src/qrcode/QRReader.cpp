@@ -19,47 +19,109 @@
 #include "QRDecoder.h"
 #include "QRDetector.h"
 #include "QRDecoderMetadata.h"
+#include "QRFinderPatternFinder.h"
+#include "QRFinderPatternInfo.h"
 #include "Result.h"
 #include "DecoderResult.h"
 #include "DetectorResult.h"
 #include "ResultPoint.h"
 #include "DecodeHints.h"
+#include "DecodeStats.h"
 #include "BinaryBitmap.h"
 #include "BitMatrix.h"
+#include "CharacterSetECI.h"
+#include "Deadline.h"
+#include "Trace.h"
+#include "ZXContainerAlgorithms.h"
 #include "ZXNumeric.h"
 
 #include <utility>
+#include <vector>
 
 namespace ZXing {
 namespace QRCode {
 
 Reader::Reader(const DecodeHints& hints)
-	: _tryHarder(hints.tryHarder()), _isPure(hints.isPure()), _charset(hints.characterSet())
+	: _tryHarder(hints.tryHarder()), _isPure(hints.isPure()), _rowScanThreads(hints.rowScanThreads()),
+	  _scanStride(hints.scanStride()), _decodeText(!hints.skipTextDecoding()),
+	  _charset(CharacterSetECI::CharsetFromName(hints.characterSet().c_str())),
+	  _expected(hints)
 {
 }
 
+static Result DecodeDetected(const DetectorResult& detectorResult, CharacterSet charset, bool decodeText)
+{
+	auto decoderResult = Decoder::Decode(detectorResult.bits(), charset, decodeText);
+	auto position = detectorResult.position();
+
+	// If the code was mirrored: swap the bottom-left and the top-right position.
+	// No need to 'fix' top-left and alignment pattern.
+	if (decoderResult.extra() && static_cast<DecoderMetadata*>(decoderResult.extra().get())->isMirrored()) {
+		std::swap(position[1], position[3]);
+	}
+
+	return Result(std::move(decoderResult), std::move(position), BarcodeFormat::QR_CODE);
+}
+
 Result
 Reader::decode(const BinaryBitmap& image) const
 {
-	auto binImg = image.getBlackMatrix();
+	ZX_TRACE_SCOPE("QRCode::Reader::decode");
+	DecodeStats::ReaderTimer readerTimer(DecodeStats::ReaderType::QRCode);
+	DecodeStats::StageTimer detectTimer(DecodeStats::Stage::Detect);
+	auto binImg = image.getBitMatrix();
 	if (binImg == nullptr) {
 		return Result(DecodeStatus::NotFound);
 	}
 
-	auto detectorResult = Detector::Detect(*binImg, _tryHarder, _isPure);
+	auto runs = _isPure ? nullptr : image.getRunLengths();
+	auto detectorResult = Detector::Detect(*binImg, _tryHarder, _isPure, _rowScanThreads, runs, _expected, _scanStride);
 	if (!detectorResult.isValid())
 		return Result(DecodeStatus::NotFound);
 
-	auto decoderResult = Decoder::Decode(detectorResult.bits(), _charset);
-	auto position = detectorResult.position();
+	return DecodeDetected(detectorResult, _charset, _decodeText);
+}
 
-	// If the code was mirrored: swap the bottom-left and the top-right position.
-	// No need to 'fix' top-left and alignment pattern.
-	if (decoderResult.extra() && static_cast<DecoderMetadata*>(decoderResult.extra().get())->isMirrored()) {
-		std::swap(position[1], position[3]);
-	}
+Results
+Reader::decode(const BinaryBitmap& image, int maxSymbols) const
+{
+	ZX_TRACE_SCOPE("QRCode::Reader::decode");
+	DecodeStats::ReaderTimer readerTimer(DecodeStats::ReaderType::QRCode);
+	DecodeStats::StageTimer detectTimer(DecodeStats::Stage::Detect);
+	if (_isPure)
+		return ZXing::Reader::decode(image, maxSymbols);
 
-	return Result(std::move(decoderResult), std::move(position), BarcodeFormat::QR_CODE);
+	auto binImg = image.getBitMatrix();
+	if (binImg == nullptr)
+		return {};
+
+	std::vector<FinderPattern> usedPatterns;
+	auto isUsed = [&usedPatterns](const FinderPattern& p) {
+		return Contains(usedPatterns, p);
+	};
+
+	auto runs = image.getRunLengths();
+	Results results;
+	auto infos = FinderPatternFinder::FindMultiple(*binImg, _tryHarder, _rowScanThreads, runs, _expected,
+													  _scanStride);
+	for (const auto& info : infos) {
+		if (Size(results) >= maxSymbols || Deadline::Expired())
+			break;
+		if (isUsed(info.topLeft) || isUsed(info.topRight) || isUsed(info.bottomLeft))
+			continue;
+
+		auto detectorResult = Detector::Detect(*binImg, info, _expected);
+		if (!detectorResult.isValid())
+			continue;
+
+		auto result = DecodeDetected(detectorResult, _charset, _decodeText);
+		if (!result.isValid())
+			continue;
+
+		usedPatterns.insert(usedPatterns.end(), {info.topLeft, info.topRight, info.bottomLeft});
+		results.push_back(std::move(result));
+	}
+	return results;
 }
 
 } // QRCode
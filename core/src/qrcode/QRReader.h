@@ -16,10 +16,10 @@
 * limitations under the License.
 */
 
+#include "CharacterSet.h"
+#include "ExpectedGeometry.h"
 #include "Reader.h"
 
-#include <string>
-
 namespace ZXing {
 
 class DecodeHints;
@@ -37,9 +37,19 @@ public:
 	explicit Reader(const DecodeHints& hints);
 	Result decode(const BinaryBitmap& image) const override;
 
+	/**
+	* Decodes all QR Codes in the image, at most maxSymbols. The image is scanned only once for finder
+	* patterns and every plausible triple of them is tried, each pattern is used by at most one symbol.
+	*/
+	Results decode(const BinaryBitmap& image, int maxSymbols) const override;
+
 private:
 	bool _tryHarder, _isPure;
-	std::string _charset;
+	int _rowScanThreads;
+	int _scanStride;
+	bool _decodeText;
+	CharacterSet _charset; // the resolved DecodeHints::characterSet
+	ExpectedGeometry _expected;
 };
 
 } // QRCode
@@ -0,0 +1,90 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "QRStructuredAppend.h"
+#include "ZXContainerAlgorithms.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace ZXing {
+namespace QRCode {
+
+// A structured append sequence consists of up to 16 symbols (4 bit sequence number and code count).
+static const int MAX_CODE_COUNT = 16;
+
+StructuredAppendAssembler::StructuredAppendAssembler(int maxPendingSequences)
+	: _maxPendingSequences(std::max(maxPendingSequences, 1))
+{
+	_sequences.reserve(_maxPendingSequences);
+}
+
+bool StructuredAppendAssembler::hasPart(int parity, int sequenceNumber) const
+{
+	return std::any_of(_sequences.begin(), _sequences.end(), [&](const Sequence& s) {
+		return s.parity == parity && sequenceNumber >= 0 && sequenceNumber < s.codeCount && (s.received >> sequenceNumber) & 1;
+	});
+}
+
+Result StructuredAppendAssembler::add(const Result& result)
+{
+	if (!result.isValid() || result.format() != BarcodeFormat::QR_CODE)
+		return Result(DecodeStatus::NotFound);
+
+	const auto& metadata = result.metadata();
+	int parity = metadata.getInt(ResultMetadata::STRUCTURED_APPEND_PARITY, -1);
+	int sequenceNumber = metadata.getInt(ResultMetadata::STRUCTURED_APPEND_SEQUENCE, -1);
+	int codeCount = metadata.getInt(ResultMetadata::STRUCTURED_APPEND_CODE_COUNT, -1);
+	if (parity < 0 || codeCount < 1 || codeCount > MAX_CODE_COUNT || sequenceNumber < 0 || sequenceNumber >= codeCount)
+		return Result(DecodeStatus::NotFound);
+
+	auto seq = FindIf(_sequences, [parity](const Sequence& s) { return s.parity == parity; });
+	if (seq != _sequences.end() && seq->codeCount != codeCount) {
+		// Same parity but a different length: this is a different message, start over.
+		_sequences.erase(seq);
+		seq = _sequences.end();
+	}
+	if (seq == _sequences.end()) {
+		if (Size(_sequences) >= _maxPendingSequences)
+			_sequences.erase(std::min_element(_sequences.begin(), _sequences.end(), [](const Sequence& a, const Sequence& b) {
+				return a.lastUpdate < b.lastUpdate;
+			}));
+		_sequences.push_back({parity, codeCount, 0, 0, std::vector<std::wstring>(codeCount)});
+		seq = _sequences.end() - 1;
+	}
+
+	seq->lastUpdate = ++_updateCounter;
+	if ((seq->received >> sequenceNumber) & 1)
+		return Result(DecodeStatus::NotFound);
+
+	seq->parts[sequenceNumber] = result.text();
+	seq->received |= 1u << sequenceNumber;
+	if (seq->received != (1u << codeCount) - 1)
+		return Result(DecodeStatus::NotFound);
+
+	std::wstring text;
+	for (const auto& part : seq->parts)
+		text.append(part);
+	_sequences.erase(seq);
+
+	Result res(std::move(text), {}, BarcodeFormat::QR_CODE);
+	res.metadata().put(ResultMetadata::STRUCTURED_APPEND_CODE_COUNT, codeCount);
+	res.metadata().put(ResultMetadata::STRUCTURED_APPEND_PARITY, parity);
+	return res;
+}
+
+} // QRCode
+} // ZXing
@@ -0,0 +1,75 @@
+#pragma once
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "Result.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ZXing {
+namespace QRCode {
+
+/**
+* Combines the symbols of QR Code Structured Append sequences (see 8.3.7 of ISO/IEC 18004:2015) that arrive one
+* at a time, e.g. while scanning the frames of a video.
+*
+* Pending sequences are identified by their parity byte. At most "maxPendingSequences" of them are kept, the one
+* that got updated least recently is dropped to make room for a new one. Parts that were already received are
+* ignored, so feeding the same symbol from many frames is cheap.
+*/
+class StructuredAppendAssembler
+{
+public:
+	explicit StructuredAppendAssembler(int maxPendingSequences = 4);
+
+	/**
+	* Add a decoded symbol. Invalid results and results without structured append metadata are ignored.
+	* @return the combined result once the last missing part of a sequence has been added, a Result with
+	*   DecodeStatus::NotFound otherwise. The completed sequence is removed from the pending ones.
+	*/
+	Result add(const Result& result);
+
+	/**
+	* @return true if the symbol with the given parity and sequence number is part of a pending sequence
+	*/
+	bool hasPart(int parity, int sequenceNumber) const;
+
+	int pendingSequences() const { return static_cast<int>(_sequences.size()); }
+
+	/**
+	* Drop all pending sequences.
+	*/
+	void clear() { _sequences.clear(); }
+
+private:
+	struct Sequence
+	{
+		int parity;
+		int codeCount;
+		uint32_t received; // bit i is set if part i has been added
+		uint64_t lastUpdate;
+		std::vector<std::wstring> parts;
+	};
+
+	int _maxPendingSequences;
+	uint64_t _updateCounter = 0;
+	std::vector<Sequence> _sequences;
+};
+
+} // QRCode
+} // ZXing
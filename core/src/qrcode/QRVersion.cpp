@@ -19,8 +19,11 @@
 #include "QRECB.h"
 #include "BitHacks.h"
 #include "BitMatrix.h"
+#include "MemoryResource.h"
 
+#include <array>
 #include <limits>
+#include <mutex>
 
 namespace ZXing {
 namespace QRCode {
@@ -50,7 +53,7 @@ Version::AllVersions()
 	/**
 	* See ISO 18004:2006 6.5.1 Table 9
 	*/
-	static const Version allVersions[] = {
+	static constexpr Version allVersions[] = {
 		{1, {}, {
 			7,  1, 19, 0, 0,
 			10, 1, 16, 0, 0,
@@ -295,14 +298,6 @@ Version::AllVersions()
 	return allVersions;
 }
 
-Version::Version(int versionNumber, std::initializer_list<int> alignmentPatternCenters, const std::array<ECBlocks, 4> &ecBlocks) :
-	_versionNumber(versionNumber),
-	_alignmentPatternCenters(alignmentPatternCenters),
-	_ecBlocks(ecBlocks)
-{
-	_totalCodewords = ecBlocks[0].totalDataCodewords();
-}
-
 const Version *
 Version::VersionForNumber(int versionNumber)
 {
@@ -370,10 +365,10 @@ Version::buildFunctionPattern(BitMatrix& bitMatrix) const
 	bitMatrix.setRegion(0, dimension - 8, 9, 8);
 
 	// Alignment patterns
-	size_t max = _alignmentPatternCenters.size();
-	for (size_t x = 0; x < max; ++x) {
+	int max = _numAlignmentPatternCenters;
+	for (int x = 0; x < max; ++x) {
 		int i = _alignmentPatternCenters[x] - 2;
-		for (size_t y = 0; y < max; ++y) {
+		for (int y = 0; y < max; ++y) {
 			if ((x == 0 && (y == 0 || y == max - 1)) || (x == max - 1 && y == 0)) {
 				// No alignment patterns near the three finder paterns
 				continue;
@@ -395,5 +390,17 @@ Version::buildFunctionPattern(BitMatrix& bitMatrix) const
 	}
 }
 
+const BitMatrix&
+Version::functionPattern() const
+{
+	// the patterns are cached for the lifetime of the process, so keep them out of the memory resource of the call
+	MemoryResource::Scope scope(nullptr);
+	static std::array<std::once_flag, 40> once;
+	static std::array<BitMatrix, 40> patterns;
+	int i = _versionNumber - 1;
+	std::call_once(once[i], [this, i]() { buildFunctionPattern(patterns[i]); });
+	return patterns[i];
+}
+
 } // QRCode
 } // ZXing
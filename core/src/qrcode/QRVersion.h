@@ -21,7 +21,6 @@
 
 #include <array>
 #include <initializer_list>
-#include <vector>
 
 namespace ZXing {
 
@@ -41,8 +40,27 @@ public:
 		return _versionNumber;
 	}
 
-	const std::vector<int>& alignmentPatternCenters() const {
-		return _alignmentPatternCenters;
+	/**
+	* Read-only view of the row/column coordinates of the alignment pattern centers (the same list applies to both
+	* directions).
+	*/
+	class AlignmentPatternCenters
+	{
+		const int* _data;
+		int _size;
+
+	public:
+		constexpr AlignmentPatternCenters(const int* data, int size) : _data(data), _size(size) {}
+
+		const int* begin() const { return _data; }
+		const int* end() const { return _data + _size; }
+		int size() const { return _size; }
+		bool empty() const { return _size == 0; }
+		int operator[](int i) const { return _data[i]; }
+	};
+
+	AlignmentPatternCenters alignmentPatternCenters() const {
+		return {_alignmentPatternCenters, _numAlignmentPatternCenters};
 	}
 	
 	int totalCodewords() const {
@@ -58,6 +76,11 @@ public:
 	}
 
 	void buildFunctionPattern(BitMatrix& bitMatrix) const;
+
+	/**
+	* @return the function pattern mask of this version (see buildFunctionPattern), built once on first use
+	*/
+	const BitMatrix& functionPattern() const;
 	
 	/**
 	* <p>Deduces version information purely from QR Code dimensions.</p>
@@ -73,12 +96,25 @@ public:
 	static const Version* DecodeVersionInformation(int versionBits);
 	
 private:
+	static constexpr int MAX_ALIGNMENT_PATTERN_CENTERS = 7;
+
 	int _versionNumber;
-	std::vector<int> _alignmentPatternCenters;
+	int _alignmentPatternCenters[MAX_ALIGNMENT_PATTERN_CENTERS];
+	int _numAlignmentPatternCenters;
 	std::array<ECBlocks, 4> _ecBlocks;
 	int _totalCodewords;
 
-	Version(int versionNumber, std::initializer_list<int> alignmentPatternCenters, const std::array<ECBlocks, 4> &ecBlocks);
+	constexpr Version(int versionNumber, std::initializer_list<int> alignmentPatternCenters,
+					  const std::array<ECBlocks, 4>& ecBlocks)
+		: _versionNumber(versionNumber), _alignmentPatternCenters{},
+		  _numAlignmentPatternCenters(static_cast<int>(alignmentPatternCenters.size())), _ecBlocks(ecBlocks),
+		  _totalCodewords(ecBlocks[0].totalDataCodewords())
+	{
+		int i = 0;
+		for (int c : alignmentPatternCenters)
+			_alignmentPatternCenters[i++] = c;
+	}
+
 	static const Version* AllVersions();
 };
 
@@ -36,7 +36,9 @@ Writer::Writer() :
 	_encoding(CharacterSet::Unknown),
 	_version(0),
 	_useGs1Format(false),
-	_maskPattern(-1)
+	_maskPattern(-1),
+	_maskSelectionThreads(1),
+	_minimalEncoding(false)
 {
 }
 
@@ -51,7 +53,8 @@ Writer::encode(const std::wstring& contents, int width, int height) const
 		throw std::invalid_argument("Requested dimensions are invalid");
 	}
 
-	EncodeResult code = Encoder::Encode(contents, _ecLevel, _encoding, _version, _useGs1Format, _maskPattern);
+	EncodeResult code = Encoder::Encode(contents, _ecLevel, _encoding, _version, _useGs1Format, _maskPattern,
+										_maskSelectionThreads, _minimalEncoding);
 	return Inflate(std::move(code.matrix), width, height, _margin);
 }
 
@@ -66,6 +66,18 @@ public:
 		return *this;
 	}
 
+	/// Number of threads used to evaluate the candidate mask patterns (see ParallelFor), the output is the same
+	Writer& setMaskSelectionThreads(int threads) {
+		_maskSelectionThreads = threads;
+		return *this;
+	}
+
+	/// Use the sequence of mode segments that results in the smallest symbol instead of a single mode for all content
+	Writer& setMinimalEncoding(bool minimal) {
+		_minimalEncoding = minimal;
+		return *this;
+	}
+
 	BitMatrix encode(const std::wstring& contents, int width, int height) const;
 
 private:
@@ -75,6 +87,8 @@ private:
 	int _version;
 	bool _useGs1Format;
 	int _maskPattern;
+	int _maskSelectionThreads;
+	bool _minimalEncoding;
 };
 
 } // QRCode
@@ -33,6 +33,7 @@
 
 #include "Big5TextEncoder.h"
 #include "Big5MapTable.h"
+#include "UnicodePageTable.h"
 
 /*
  * ucs4 to big5hkscs convert routing
@@ -4219,27 +4220,24 @@ static int qt_UnicodeToBig5hkscs(unsigned wc, uint8_t *r)
 	return 0;
 }
 
-static int qt_UnicodeToBig5(unsigned ch, uint8_t *buf)
+static ZXing::UnicodePageTable<uint16_t> buildUnicodeToBig5Table()
 {
-	//all the tables are individually sorted on Y
-	for (int i = 0; i < 5; i++) {
-		int start = 0;
-		int end = b5_map_table[i].tableSize - 1;
+	ZXing::UnicodePageTable<uint16_t> table;
+	// insert() keeps the first code of a character, matching the order the tables used to be searched in
+	for (const auto& index : b5_map_table)
+		for (int i = 0; i < index.tableSize; ++i)
+			table.insert(index.table[i].y, index.table[i].x);
+	return table;
+}
 
-		while (start <= end) {
-			int middle = (end + start + 1) / 2;
-			if (b5_map_table[i].table[middle].y == ch) {
-				buf[0] = b5_map_table[i].table[middle].x >> 8;
-				buf[1] = b5_map_table[i].table[middle].x & 0xff;
-				return 2;
-			}
-			else if (b5_map_table[i].table[middle].y > ch) {
-				end = middle - 1;
-			}
-			else {
-				start = middle + 1;
-			}
-		}
+static int qt_UnicodeToBig5(unsigned ch, uint8_t *buf)
+{
+	// One lookup instead of a binary search in each of the 5 tables, built on first use.
+	static const auto table = buildUnicodeToBig5Table();
+	if (uint16_t code = table[ch]) {
+		buf[0] = code >> 8;
+		buf[1] = code & 0xff;
+		return 2;
 	}
 	return qt_UnicodeToBig5hkscs(ch, buf);
 }
@@ -36,6 +36,7 @@
 
 #include "KRTextEncoder.h"
 #include "KRHangulMapping.h"
+#include "UnicodePageTable.h"
 
 struct Mapping
 {
@@ -641,66 +642,23 @@ static const Mapping unicode_to_ksc5601_hanja[4888] = {
     {0xfa04,0x7748}, {0xfa05,0x7753}, {0xfa06,0x785b}, {0xfa07,0x7870}, {0xfa08,0x7a21}, {0xfa09,0x7a22}, {0xfa0a,0x7a66}, {0xfa0b,0x7c29},
 };
 
-static uint16_t unicode2ksc(unsigned unicode)
+static ZXing::UnicodePageTable<uint16_t> buildUnicodeToKscTable()
 {
-	unsigned lo, hi, mid, c2;
-	uint8_t s[2];
-
-	lo = mid = c2 = 0;
-
-	if (unicode >= 0xac00 && unicode <= 0xd7a3) {
-		// Hangul
-		hi = 2349;
-
-		while (lo <= hi) { // binary search
-			mid = (lo + hi) / 2;
-			c2 = ksc5601_hangul_to_unicode[mid];
-			if (unicode < c2)
-				hi = mid - 1;
-			else if (unicode > c2)
-				lo = mid + 1;
-			else { // unicode == c2
-				s[0] = (mid / 94) + 0x30;
-				s[1] = (mid % 94) + 0x21;
-
-				return ((s[0] << 8) | s[1]);
-			}
-		}
-	}
-	else if ((unicode >= 0x4e00 && unicode <= 0x9fff)
-		|| (unicode >= 0xf900 && unicode <= 0xfa0b)) {
-		// Hanja
-		hi = 4887;
-
-		while (lo <= hi) { // binary search
-			mid = (lo + hi) / 2;
-			c2 = unicode_to_ksc5601_hanja[mid].unicode;
-			if (unicode < c2)
-				hi = mid - 1;
-			else if (unicode > c2)
-				lo = mid + 1;
-			else { // unicode == c2
-				return unicode_to_ksc5601_hanja[mid].kscode;
-			}
-		}
-	}
-	else {
-		// Symbol
-		hi = 985;
+	ZXing::UnicodePageTable<uint16_t> table;
+	for (unsigned i = 0; i < 2350; ++i)
+		table.insert(ksc5601_hangul_to_unicode[i], static_cast<uint16_t>((((i / 94) + 0x30) << 8) | ((i % 94) + 0x21)));
+	for (const auto& m : unicode_to_ksc5601_hanja)
+		table.insert(m.unicode, m.kscode);
+	for (const auto& m : unicode_to_ksc5601_symbol)
+		table.insert(m.unicode, m.kscode);
+	return table;
+}
 
-		while (lo <= hi) { // binary search
-			mid = (lo + hi) / 2;
-			c2 = unicode_to_ksc5601_symbol[mid].unicode;
-			if (unicode < c2)
-				hi = mid - 1;
-			else if (unicode > c2)
-				lo = mid + 1;
-			else { // unicode == c2
-				return unicode_to_ksc5601_symbol[mid].kscode;
-			}
-		}
-	}
-	return 0;
+static uint16_t unicode2ksc(unsigned unicode)
+{
+	// Replaces three binary searches (hangul, hanja, symbols) by a single lookup, built on first use.
+	static const auto table = buildUnicodeToKscTable();
+	return table[unicode];
 }
 
 void KRTextDecoder::EncodeEucKr(const std::wstring& str, std::string& bytes)
@@ -0,0 +1,84 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "JpegLuma.h"
+
+#include <csetjmp>
+#include <cstdio>
+#include <memory>
+
+#include <jpeglib.h>
+
+namespace ZXing {
+
+namespace {
+
+// libjpeg calls error_exit on any error and expects it not to return. The default one calls exit(), this one jumps
+// back into LoadJpegLuma, as it is C code that can't be unwound by an exception.
+struct ErrorManager
+{
+	jpeg_error_mgr pub;
+	std::jmp_buf jump;
+};
+
+void ErrorExit(j_common_ptr cinfo)
+{
+	std::longjmp(reinterpret_cast<ErrorManager*>(cinfo->err)->jump, 1);
+}
+
+} // anonymous
+
+bool LoadJpegLuma(const char* filePath, int scaleDenom, std::vector<uint8_t>& pixels, int& width, int& height)
+{
+	std::unique_ptr<FILE, int (*)(FILE*)> file(std::fopen(filePath, "rb"), std::fclose);
+	if (!file)
+		return false;
+
+	// nothing with a destructor may be created after the setjmp, the longjmp would skip it
+	jpeg_decompress_struct cinfo;
+	ErrorManager err;
+	cinfo.err = jpeg_std_error(&err.pub);
+	err.pub.error_exit = ErrorExit;
+	if (setjmp(err.jump)) {
+		jpeg_destroy_decompress(&cinfo);
+		return false;
+	}
+
+	jpeg_create_decompress(&cinfo);
+	jpeg_stdio_src(&cinfo, file.get());
+	jpeg_read_header(&cinfo, TRUE);
+
+	// only the Y component of a YCbCr image is decoded for a gray scale output
+	cinfo.out_color_space = JCS_GRAYSCALE;
+	cinfo.scale_num = 1;
+	cinfo.scale_denom = scaleDenom;
+	jpeg_start_decompress(&cinfo);
+
+	width = cinfo.output_width;
+	height = cinfo.output_height;
+	pixels.resize(size_t(width) * height);
+	while (cinfo.output_scanline < cinfo.output_height) {
+		JSAMPROW row = pixels.data() + size_t(cinfo.output_scanline) * width;
+		jpeg_read_scanlines(&cinfo, &row, 1);
+	}
+
+	jpeg_finish_decompress(&cinfo);
+	jpeg_destroy_decompress(&cinfo);
+	return true;
+}
+
+} // ZXing
@@ -0,0 +1,35 @@
+#pragma once
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include <cstdint>
+#include <vector>
+
+namespace ZXing {
+
+/**
+* Decodes only the luminance (Y) component of a JPEG file with libjpeg(-turbo), which skips the chroma upsampling, the
+* color conversion and the inverse DCT of the chroma components. With a scaleDenom of 2, 4 or 8 the image is also
+* scaled down by that factor in the DCT domain, so most of the remaining inverse DCT work is skipped, too.
+*
+* The result is a width x height 8 bit gray scale image without padding, i.e. an ImageFormat::Lum ImageView.
+*
+* @return false if the file can not be read or is not a (supported) JPEG
+*/
+bool LoadJpegLuma(const char* filePath, int scaleDenom, std::vector<uint8_t>& pixels, int& width, int& height);
+
+} // ZXing
@@ -0,0 +1,213 @@
+#pragma once
+/*
+ * Copyright 2020 Axel Waggershauser
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ReadBarcode.h"
+
+#include <QDebug>
+#include <QImage>
+#include <QMetaType>
+
+#ifdef QT_MULTIMEDIA_LIB
+#include <QMutex>
+#include <QThread>
+#include <QVideoFrame>
+#include <QWaitCondition>
+#endif
+
+// This is some sample code to start a discussion about how a minimal and header-only Qt wrapper/helper could look like.
+
+namespace ZXing {
+namespace Qt {
+
+using ZXing::DecodeHints;
+using ZXing::BarcodeFormat;
+using ZXing::BarcodeFormats;
+using ZXing::Binarizer;
+
+template <typename T, typename _ = decltype(ToString(T()))>
+QDebug operator<<(QDebug dbg, const T& v)
+{
+	return dbg.noquote() << QString::fromStdString(ToString(v));
+}
+
+class Result : private ZXing::Result
+{
+public:
+	Result() : ZXing::Result(DecodeStatus::NotFound) {} // required for qRegisterMetaType
+	explicit Result(ZXing::Result&& r) : ZXing::Result(std::move(r)) {}
+
+	using ZXing::Result::format;
+	using ZXing::Result::isValid;
+	using ZXing::Result::status;
+
+	inline QString text() const { return QString::fromWCharArray(ZXing::Result::text().c_str()); }
+};
+
+inline Result ReadBarcode(const QImage& img, const DecodeHints& hints = {})
+{
+	auto ImgFmtFromQImg = [](const QImage& img) {
+		switch (img.format()) {
+		case QImage::Format_ARGB32:
+		case QImage::Format_RGB32:
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+			return ImageFormat::BGRX;
+#else
+			return ImageFormat::XRGB;
+#endif
+		case QImage::Format_RGB888: return ImageFormat::RGB;
+		case QImage::Format_RGBX8888:
+		case QImage::Format_RGBA8888: return ImageFormat::RGBX;
+		case QImage::Format_Grayscale8: return ImageFormat::Lum;
+		default: return ImageFormat::None;
+		}
+	};
+
+	auto exec = [&](const QImage& img) {
+		return Result(ZXing::ReadBarcode({img.bits(), img.width(), img.height(), ImgFmtFromQImg(img)}, hints));
+	};
+
+	return ImgFmtFromQImg(img) == ImageFormat::None ? exec(img.convertToFormat(QImage::Format_RGBX8888)) : exec(img);
+}
+
+#ifdef QT_MULTIMEDIA_LIB
+
+/**
+* Decodes a video frame without converting it to a QImage first: the frame is mapped and for the YUV formats only the
+* luminance (Y) plane is passed to ZXing, in place.
+*/
+inline Result ReadBarcode(const QVideoFrame& frame, const DecodeHints& hints = {})
+{
+	QVideoFrame img = frame; // QVideoFrame is explicitly shared, this does not copy the pixels
+	if (!img.map(QAbstractVideoBuffer::ReadOnly))
+		return {};
+
+	ImageFormat fmt = ImageFormat::None;
+	int pixStride = 0;
+	int offset = 0;
+	switch (img.pixelFormat()) {
+	case QVideoFrame::Format_ARGB32:
+	case QVideoFrame::Format_ARGB32_Premultiplied:
+	case QVideoFrame::Format_RGB32:
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+		fmt = ImageFormat::BGRX;
+#else
+		fmt = ImageFormat::XRGB;
+#endif
+		break;
+	// the planar and semi-planar formats start with the full resolution Y plane
+	case QVideoFrame::Format_Y8:
+	case QVideoFrame::Format_NV12:
+	case QVideoFrame::Format_NV21:
+	case QVideoFrame::Format_YUV420P:
+	case QVideoFrame::Format_YV12: fmt = ImageFormat::Lum; break;
+	// the packed 4:2:2 formats have every second byte a Y sample
+	case QVideoFrame::Format_YUYV: fmt = ImageFormat::Lum, pixStride = 2; break;
+	case QVideoFrame::Format_UYVY: fmt = ImageFormat::Lum, pixStride = 2, offset = 1; break;
+	default: break;
+	}
+
+	Result res;
+	if (fmt != ImageFormat::None) {
+		res = Result(ZXing::ReadBarcode(
+			{img.bits() + offset, img.width(), img.height(), fmt, img.bytesPerLine(), pixStride}, hints));
+	}
+#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
+	else {
+		res = ReadBarcode(img.image(), hints);
+	}
+#endif
+	img.unmap();
+	return res;
+}
+
+/**
+* Decodes video frames on its own thread, e.g. the ones a QVideoProbe or a QAbstractVideoSurface receive from a
+* camera. A frame passed to decode() while the thread is still busy replaces any frame waiting before it, so the
+* decoder always works on the latest frame and never falls behind the camera, it just skips frames. The results are
+* delivered by the signals, queued to the receivers' threads.
+*/
+class VideoDecoder : public QThread
+{
+	Q_OBJECT
+
+public:
+	explicit VideoDecoder(const DecodeHints& hints = {}, QObject* parent = nullptr) : QThread(parent), _hints(hints)
+	{
+		qRegisterMetaType<ZXing::Qt::Result>();
+		start();
+	}
+
+	~VideoDecoder() override
+	{
+		{
+			QMutexLocker lock(&_mutex);
+			_quit = true;
+			_pending = {};
+			_wake.wakeOne();
+		}
+		wait();
+	}
+
+public slots:
+	void decode(const QVideoFrame& frame)
+	{
+		QMutexLocker lock(&_mutex);
+		_pending = frame;
+		_wake.wakeOne();
+	}
+
+signals:
+	/// Emitted for every frame decoded, whether a barcode was found or not
+	void decoded(ZXing::Qt::Result result);
+	/// Emitted for the frames a barcode was found in
+	void found(ZXing::Qt::Result result);
+
+protected:
+	void run() override
+	{
+		while (true) {
+			QVideoFrame frame;
+			{
+				QMutexLocker lock(&_mutex);
+				while (!_quit && !_pending.isValid())
+					_wake.wait(&_mutex);
+				if (_quit)
+					return;
+				frame = _pending;
+				_pending = {};
+			}
+			auto result = ReadBarcode(frame, _hints);
+			emit decoded(result);
+			if (result.isValid())
+				emit found(result);
+		}
+	}
+
+private:
+	const DecodeHints _hints;
+	QMutex _mutex;
+	QWaitCondition _wake;
+	QVideoFrame _pending;
+	bool _quit = false;
+};
+
+#endif // QT_MULTIMEDIA_LIB
+
+} // namespace Qt
+} // namespace ZXing
+
+Q_DECLARE_METATYPE(ZXing::Qt::Result)
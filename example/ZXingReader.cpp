@@ -18,24 +18,68 @@
 #include "TextUtfEncoding.h"
 #include "ZXNumeric.h"
 
-#include <iostream>
-#include <cstring>
-#include <string>
 #include <algorithm>
 #include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
+#ifdef ZXING_HAS_LIBJPEG
+#include "JpegLuma.h"
+#endif
+
 using namespace ZXing;
 
+enum class OutputMode { Text, Json, Csv };
+
+struct Options
+{
+	DecodeHints hints;
+	std::vector<std::string> filePaths;
+	OutputMode output = OutputMode::Text;
+	int threads = 1;
+	int shard = 0, shardCount = 1;
+	std::string checkpointPath;
+	bool stats = false;
+	int jpegScale = 1;
+};
+
 static void PrintUsage(const char* exePath)
 {
-	std::cout << "Usage: " << exePath << " [-fast] [-rotate] [-format <FORMAT[,...]>] <png image path>\n"
-			  << "    -fast    Skip some lines/pixels during detection\n"
-			  << "    -rotate  Also try rotated image during detection\n"
-			  << "    -format  Only detect given format(s)\n"
-			  << "    -ispure  Assume the image contains only a 'pure'/perfect code\n"
+	std::cout << "Usage: " << exePath << " [options] <image path>...\n"
+			  << "    -fast        Skip some lines/pixels during detection\n"
+			  << "    -stride <N>  Scan only every N-th line/edge of the detectors' pattern searches, see -fast\n"
+			  << "    -rotate      Also try rotated image during detection\n"
+			  << "    -format      Only detect given format(s)\n"
+			  << "    -ispure      Assume the image contains only a 'pure'/perfect code\n"
+			  << "    -bestchannel Use the color channel with the most contrast instead of the luminance\n"
+			  << "    -threads <N> Read N images in parallel\n"
+			  << "    -json        Print one JSON object per image and line\n"
+			  << "    -csv         Print one CSV record per image, after a header line\n"
+			  << "    -shard <i/N> Only read the images whose path hashes to shard i of N (0 <= i < N)\n"
+			  << "    -checkpoint <file>\n"
+			  << "                 Skip the images listed in file and append each image read to it\n"
+			  << "    -stats       Print the number of images read and decoded and the throughput to stderr\n"
+#ifdef ZXING_HAS_LIBJPEG
+			  << "    -jpegscale <N>\n"
+			  << "                 Decode JPEG images scaled by 1/N (N = 1, 2, 4 or 8), positions refer to that scale\n"
+#endif
+			  << "\n"
+			  << "An image path of '-' reads the image paths from stdin, one per line.\n"
 			  << "\n"
 			  << "Supported formats are:\n";
 	for (auto f : BarcodeFormats::all()) {
@@ -44,13 +88,20 @@ static void PrintUsage(const char* exePath)
 	std::cout << "Formats can be lowercase, with or without underscore, separated by ',', '|' and/or ' '\n";
 }
 
-static bool ParseOptions(int argc, char* argv[], DecodeHints* hints, std::string* filePath)
+static bool ParseOptions(int argc, char* argv[], Options* options)
 {
+	DecodeHints* hints = &options->hints;
 	hints->setTryHarder(true);
 	for (int i = 1; i < argc; ++i) {
 		if (strcmp(argv[i], "-fast") == 0) {
 			hints->setTryHarder(false);
 		}
+		else if (strcmp(argv[i], "-stride") == 0) {
+			int stride;
+			if (++i == argc || (stride = std::atoi(argv[i])) < 1)
+				return false;
+			hints->setScanStride(stride);
+		}
 		else if (strcmp(argv[i], "-rotate") == 0) {
 			hints->setTryRotate(true);
 		}
@@ -58,6 +109,9 @@ static bool ParseOptions(int argc, char* argv[], DecodeHints* hints, std::string
 			hints->setIsPure(true);
 			hints->setBinarizer(Binarizer::FixedThreshold);
 		}
+		else if (strcmp(argv[i], "-bestchannel") == 0) {
+			hints->setColorStrategy(ColorStrategy::BestChannel);
+		}
 		else if (strcmp(argv[i], "-format") == 0) {
 			if (++i == argc)
 				return false;
@@ -68,12 +122,44 @@ static bool ParseOptions(int argc, char* argv[], DecodeHints* hints, std::string
 				return false;
 			}
 		}
+		else if (strcmp(argv[i], "-threads") == 0) {
+			if (++i == argc || (options->threads = std::atoi(argv[i])) < 1)
+				return false;
+		}
+		else if (strcmp(argv[i], "-shard") == 0) {
+			if (++i == argc || sscanf(argv[i], "%d/%d", &options->shard, &options->shardCount) != 2 ||
+				options->shard < 0 || options->shard >= options->shardCount)
+				return false;
+		}
+		else if (strcmp(argv[i], "-checkpoint") == 0) {
+			if (++i == argc)
+				return false;
+			options->checkpointPath = argv[i];
+		}
+		else if (strcmp(argv[i], "-stats") == 0) {
+			options->stats = true;
+		}
+#ifdef ZXING_HAS_LIBJPEG
+		else if (strcmp(argv[i], "-jpegscale") == 0) {
+			if (++i == argc)
+				return false;
+			options->jpegScale = std::atoi(argv[i]);
+			if (options->jpegScale != 1 && options->jpegScale != 2 && options->jpegScale != 4 && options->jpegScale != 8)
+				return false;
+		}
+#endif
+		else if (strcmp(argv[i], "-json") == 0) {
+			options->output = OutputMode::Json;
+		}
+		else if (strcmp(argv[i], "-csv") == 0) {
+			options->output = OutputMode::Csv;
+		}
 		else {
-			*filePath = argv[i];
+			options->filePaths.push_back(argv[i]);
 		}
 	}
 
-	return !filePath->empty();
+	return !options->filePaths.empty();
 }
 
 std::ostream& operator<<(std::ostream& os, const Position& points) {
@@ -82,34 +168,243 @@ std::ostream& operator<<(std::ostream& os, const Position& points) {
 	return os;
 }
 
+static std::string JsonString(const std::string& str)
+{
+	std::string res = "\"";
+	for (unsigned char c : str) {
+		if (c == '"' || c == '\\') {
+			res += '\\';
+			res += c;
+		}
+		else if (c < 0x20) {
+			char buf[8];
+			snprintf(buf, sizeof(buf), "\\u%04x", c);
+			res += buf;
+		}
+		else {
+			res += c;
+		}
+	}
+	return res + "\"";
+}
+
+static std::string CsvString(const std::string& str)
+{
+	if (str.find_first_of(",\"\r\n") == std::string::npos)
+		return str;
+	std::string res = "\"";
+	for (char c : str) {
+		if (c == '"')
+			res += '"';
+		res += c;
+	}
+	return res + "\"";
+}
+
+/// FNV-1a, so that every node assigns a path to the same shard, regardless of platform and input order.
+static uint32_t PathHash(const std::string& path)
+{
+	uint32_t hash = 2166136261u;
+	for (unsigned char c : path)
+		hash = (hash ^ c) * 16777619u;
+	return hash;
+}
+
+struct Image
+{
+	std::unique_ptr<stbi_uc, void (*)(void*)> stbPixels{nullptr, stbi_image_free};
+	std::vector<uint8_t> jpegPixels;
+	int width = 0, height = 0;
+	ImageFormat format = ImageFormat::None;
+
+	const uint8_t* data() const { return stbPixels ? stbPixels.get() : jpegPixels.data(); }
+	bool isValid() const { return stbPixels || !jpegPixels.empty(); }
+};
+
+#ifdef ZXING_HAS_LIBJPEG
+static bool IsJpeg(const std::string& filePath)
+{
+	auto ext = filePath.substr(std::min(filePath.size(), filePath.rfind('.')));
+	std::transform(ext.begin(), ext.end(), ext.begin(), [](char c) { return static_cast<char>(std::tolower(c)); });
+	return ext == ".jpg" || ext == ".jpeg";
+}
+#endif
+
+/**
+* Loads an image with as few channels as possible, so that gray scale files are passed to ReadBarcode as is instead
+* of being expanded to RGBX first. If available, JPEG files are decoded by libjpeg, luminance only.
+*/
+static Image LoadImage(const std::string& filePath, const Options& options)
+{
+	Image img;
+#ifdef ZXING_HAS_LIBJPEG
+	if (IsJpeg(filePath) && LoadJpegLuma(filePath.c_str(), options.jpegScale, img.jpegPixels, img.width, img.height)) {
+		img.format = ImageFormat::Lum;
+		return img;
+	}
+#else
+	(void)options;
+#endif
+	int channels = 0;
+	if (!stbi_info(filePath.c_str(), &img.width, &img.height, &channels))
+		return img;
+	// gray with alpha is read as gray, the alpha channel is ignored by ReadBarcode anyway
+	int loadChannels = channels <= 2 ? 1 : channels;
+	img.format = loadChannels == 1 ? ImageFormat::Lum : loadChannels == 3 ? ImageFormat::RGB : ImageFormat::RGBX;
+	img.stbPixels.reset(stbi_load(filePath.c_str(), &img.width, &img.height, &channels, loadChannels));
+	return img;
+}
+
+/// Reads one image and returns what is to be printed for it.
+static std::string ReadImage(const std::string& filePath, const Options& options, bool isBatch, int& status)
+{
+	std::ostringstream out;
+	auto img = LoadImage(filePath, options);
+	if (!img.isValid()) {
+		status = -1;
+		if (options.output == OutputMode::Json)
+			out << "{\"file\":" << JsonString(filePath) << ",\"error\":\"Failed to read image\"}\n";
+		else if (options.output == OutputMode::Csv)
+			out << CsvString(filePath) << ",,,,Failed to read image,\n";
+		else
+			std::cerr << "Failed to read image: " << filePath << "\n";
+		return out.str();
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	auto result = ReadBarcode({img.data(), img.width, img.height, img.format}, options.hints);
+	double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	status = static_cast<int>(result.status());
+
+	auto text = result.utf8();
+	auto formatName = ToString(result.format());
+	auto rotation = std::lround(result.position().rotation() * kDegPerRad);
+	auto error = ToString(result.status());
+	switch (options.output) {
+	case OutputMode::Json:
+		out << "{\"file\":" << JsonString(filePath) << ",\"text\":" << JsonString(text)
+			<< ",\"format\":" << JsonString(formatName) << ",\"rotation\":" << rotation
+			<< ",\"error\":" << JsonString(error) << ",\"ms\":" << ms << "}\n";
+		break;
+	case OutputMode::Csv:
+		out << CsvString(filePath) << "," << CsvString(text) << "," << formatName << "," << rotation << ","
+			<< error << "," << ms << "\n";
+		break;
+	case OutputMode::Text:
+		if (isBatch)
+			out << "File:     " << filePath << "\n";
+		out << "Text:     \"" << text << "\"\n"
+			<< "Format:   " << formatName << "\n"
+			<< "Position: " << result.position() << "\n"
+			<< "Rotation: " << rotation << "\n"
+			<< "Error:    " << error << "\n";
+		auto errLevel = result.metadata().getString(ResultMetadata::Key::ERROR_CORRECTION_LEVEL);
+		if (!errLevel.empty()) {
+			out << "EC Level: " << TextUtfEncoding::ToUtf8(errLevel) << "\n";
+		}
+		if (isBatch)
+			out << "Time:     " << ms << " ms\n\n";
+		break;
+	}
+	return out.str();
+}
+
 int main(int argc, char* argv[])
 {
-	DecodeHints hints;
-	std::string filePath;
+	Options options;
 
-	if (!ParseOptions(argc, argv, &hints, &filePath)) {
+	if (!ParseOptions(argc, argv, &options)) {
 		PrintUsage(argv[0]);
 		return -1;
 	}
 
-	int width, height, channels;
-	std::unique_ptr<stbi_uc, void(*)(void*)> buffer(stbi_load(filePath.c_str(), &width, &height, &channels, 4), stbi_image_free);
-	if (buffer == nullptr) {
-		std::cerr << "Failed to read image: " << filePath << "\n";
-		return -1;
+	const auto& paths = options.filePaths;
+	bool isBatch = paths.size() > 1 || paths.front() == "-" || options.output != OutputMode::Text ||
+				   options.shardCount > 1 || !options.checkpointPath.empty() || options.stats;
+	if (!isBatch) {
+		int status;
+		std::cout << ReadImage(paths.front(), options, false, status);
+		return status;
+	}
+
+	// the paths in the checkpoint file have been read by an earlier run, the ones read now are appended
+	std::unordered_set<std::string> done;
+	std::ofstream checkpoint;
+	if (!options.checkpointPath.empty()) {
+		std::ifstream in(options.checkpointPath);
+		for (std::string path; std::getline(in, path);)
+			done.insert(path);
+		checkpoint.open(options.checkpointPath, std::ios::app);
+		if (!checkpoint) {
+			std::cerr << "Failed to open checkpoint file: " << options.checkpointPath << "\n";
+			return -1;
+		}
 	}
+	auto isSkipped = [&](const std::string& path) {
+		return (options.shardCount > 1 && PathHash(path) % options.shardCount != static_cast<uint32_t>(options.shard)) ||
+			   done.count(path);
+	};
+
+	if (options.output == OutputMode::Csv)
+		std::cout << "file,text,format,rotation,error,ms\n";
+
+	// the workers take the next path from the command line, or from stdin for a '-', and print each record as soon
+	// as it is complete, so the order of the output may differ from the order of the input
+	std::mutex inputMutex, outputMutex;
+	size_t next = 0;
+	bool inStdin = false;
+	auto nextPath = [&](std::string& path) {
+		std::lock_guard<std::mutex> lock(inputMutex);
+		while (true) {
+			if (inStdin) {
+				while (std::getline(std::cin, path))
+					if (!path.empty() && !isSkipped(path))
+						return true;
+				inStdin = false;
+			}
+			if (next == paths.size())
+				return false;
+			path = paths[next++];
+			if (path == "-")
+				inStdin = true;
+			else if (!isSkipped(path))
+				return true;
+		}
+	};
+
+	bool allRead = true;
+	int numRead = 0, numDecoded = 0;
+	auto startTime = std::chrono::steady_clock::now();
+	auto worker = [&]() {
+		std::string path;
+		while (nextPath(path)) {
+			int status;
+			auto record = ReadImage(path, options, true, status);
+			std::lock_guard<std::mutex> lock(outputMutex);
+			std::cout << record;
+			allRead &= status != -1;
+			numRead += status != -1;
+			numDecoded += status == 0;
+			// flushed after the output, so a crashed run is resumed at the first image without a record
+			if (checkpoint.is_open())
+				checkpoint << path << std::endl;
+		}
+	};
 
-	auto result = ReadBarcode({buffer.get(), width, height, ImageFormat::RGBX}, hints);
+	std::vector<std::thread> threads;
+	for (int i = 1; i < options.threads; ++i)
+		threads.emplace_back(worker);
+	worker();
+	for (auto& t : threads)
+		t.join();
 
-	std::cout << "Text:     \"" << TextUtfEncoding::ToUtf8(result.text()) << "\"\n"
-			  << "Format:   " << ToString(result.format()) << "\n"
-			  << "Position: " << result.position() << "\n"
-			  << "Rotation: " << std::lround(result.position().rotation() * kDegPerRad) << "\n"
-			  << "Error:    " << ToString(result.status()) << "\n";
-	auto errLevel = result.metadata().getString(ResultMetadata::Key::ERROR_CORRECTION_LEVEL);
-	if (!errLevel.empty()) {
-		std::cout << "EC Level: " << TextUtfEncoding::ToUtf8(errLevel) << "\n";
+	if (options.stats) {
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+		std::cerr << "Images:     " << numRead << "\n"
+				  << "Decoded:    " << numDecoded << "\n"
+				  << "Time:       " << seconds << " s\n"
+				  << "Throughput: " << (seconds > 0 ? numRead / seconds : 0) << " images/s\n";
 	}
 
-	return static_cast<int>(result.status());
+	return allRead ? 0 : -1;
 }
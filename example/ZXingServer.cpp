@@ -0,0 +1,580 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+/*
+* A minimal HTTP decode service, as a reference for running the library in a long-lived process:
+*
+*  - one BarcodeScanner per distinct configuration, created on first use and shared by all requests
+*  - requests are collected into micro batches (up to -batch images, waiting at most -batchwait for more) that are
+*    decoded in parallel on the worker pool of the library (ParallelFor)
+*  - the temporary buffers of each request come from a MonotonicBufferResource that is released in one go afterwards
+*  - with -cache, re-uploads of byte-identical images are answered from the result cache of the scanner
+*  - latency histograms and the DecodeStats of all requests in the Prometheus text format at GET /metrics
+*
+* POST /decode?formats=QRCode,DataMatrix&fast=1&rotate=1&pure=1&multi=1 with an image file (PNG, JPEG, BMP, PGM, ...)
+* as body returns the results as JSON. With width=<w>&height=<h> the body is taken as raw 8-bit gray pixels instead.
+*/
+
+#include "DecodeStats.h"
+#include "MemoryResource.h"
+#include "Parallel.h"
+#include "ReadBarcode.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <csignal>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+using namespace ZXing;
+using Clock = std::chrono::steady_clock;
+
+static double Seconds(Clock::duration d)
+{
+	return std::chrono::duration<double>(d).count();
+}
+
+/// Cumulative histogram as exposed by Prometheus, le = upper bound of a bucket
+class Histogram
+{
+	std::vector<double> _bounds;
+	std::vector<uint64_t> _counts;
+	double _sum = 0;
+	uint64_t _count = 0;
+	mutable std::mutex _mutex;
+
+public:
+	explicit Histogram(std::vector<double> bounds) : _bounds(std::move(bounds)), _counts(_bounds.size(), 0) {}
+
+	void observe(double value)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		for (size_t i = 0; i < _bounds.size(); ++i)
+			if (value <= _bounds[i])
+				++_counts[i];
+		_sum += value;
+		++_count;
+	}
+
+	void write(std::ostream& out, const char* name, const char* help) const
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		out << "# HELP " << name << " " << help << "\n# TYPE " << name << " histogram\n";
+		for (size_t i = 0; i < _bounds.size(); ++i)
+			out << name << "_bucket{le=\"" << _bounds[i] << "\"} " << _counts[i] << "\n";
+		out << name << "_bucket{le=\"+Inf\"} " << _count << "\n"
+			<< name << "_sum " << _sum << "\n"
+			<< name << "_count " << _count << "\n";
+	}
+};
+
+static const std::vector<double> kLatencyBounds = {0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5};
+
+struct Metrics
+{
+	DecodeStats decode; // shared by all scanners, the counters are atomic
+	Histogram requestSeconds{kLatencyBounds};
+	Histogram queueSeconds{kLatencyBounds};
+	Histogram decodeSeconds{kLatencyBounds};
+	Histogram batchSize{{1, 2, 4, 8, 16, 32, 64}};
+	std::atomic<uint64_t> requests{0}, badRequests{0}, symbols{0}, arenaBytes{0};
+};
+
+static Metrics g_metrics;
+
+// the arena of the request being decoded on this thread
+static thread_local MonotonicBufferResource* t_arena = nullptr;
+
+/**
+* The MemoryResource of all scanners, forwards to the arena of the request decoded on the current thread. The
+* scanners run with binarizerThreads = 1 and without tiling, so all buffers of a request are allocated and freed on the
+* thread that decodes it.
+*/
+class RequestArenas : public MemoryResource
+{
+protected:
+	void* doAllocate(std::size_t bytes, std::size_t alignment) override
+	{
+		return t_arena ? t_arena->allocate(bytes, alignment) : Default()->allocate(bytes, alignment);
+	}
+	void doDeallocate(void* p, std::size_t bytes, std::size_t alignment) noexcept override
+	{
+		if (!t_arena)
+			Default()->deallocate(p, bytes, alignment);
+	}
+};
+
+static RequestArenas g_arenas;
+
+struct Job
+{
+	BarcodeScanner* scanner;
+	bool multi;
+	ImageView image;
+	Clock::time_point queued;
+	Results results;
+	std::promise<void> done;
+
+	Job(BarcodeScanner* scanner, bool multi, const ImageView& image)
+		: scanner(scanner), multi(multi), image(image), queued(Clock::now())
+	{}
+};
+
+static void Decode(Job& job)
+{
+	auto start = Clock::now();
+	g_metrics.queueSeconds.observe(Seconds(start - job.queued));
+
+	MonotonicBufferResource arena;
+	t_arena = &arena;
+	if (job.multi)
+		job.results = job.scanner->readMultiple(job.image);
+	else {
+		auto result = job.scanner->read(job.image);
+		if (result.isValid())
+			job.results.push_back(std::move(result));
+	}
+	t_arena = nullptr;
+
+	g_metrics.arenaBytes += arena.allocatedBytes();
+	g_metrics.decodeSeconds.observe(Seconds(Clock::now() - start));
+}
+
+/**
+* Collects the jobs into batches: a batch starts with the oldest waiting job and takes everything that arrives until
+* maxBatch jobs are waiting or the oldest one waited maxWait. While a batch is decoded, the next one fills up.
+*/
+class Batcher
+{
+	std::mutex _mutex;
+	std::condition_variable _cv;
+	std::deque<Job*> _queue;
+	const int _maxBatch;
+	const std::chrono::microseconds _maxWait;
+	std::thread _thread;
+
+	void run()
+	{
+		for (;;) {
+			std::vector<Job*> batch;
+			{
+				std::unique_lock<std::mutex> lock(_mutex);
+				_cv.wait(lock, [this] { return !_queue.empty(); });
+				_cv.wait_until(lock, _queue.front()->queued + _maxWait,
+							   [this] { return static_cast<int>(_queue.size()) >= _maxBatch; });
+				while (!_queue.empty() && static_cast<int>(batch.size()) < _maxBatch) {
+					batch.push_back(_queue.front());
+					_queue.pop_front();
+				}
+			}
+			g_metrics.batchSize.observe(static_cast<double>(batch.size()));
+			ParallelFor(static_cast<int>(batch.size()), [&batch](int i) { Decode(*batch[i]); });
+			for (auto job : batch)
+				job->done.set_value();
+		}
+	}
+
+public:
+	Batcher(int maxBatch, std::chrono::microseconds maxWait)
+		: _maxBatch(maxBatch), _maxWait(maxWait), _thread(&Batcher::run, this)
+	{
+		_thread.detach(); // runs as long as the process
+	}
+
+	/// Decodes the job in one of the next batches, returns when it is done
+	void decode(Job& job)
+	{
+		auto done = job.done.get_future();
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_queue.push_back(&job);
+		}
+		_cv.notify_one();
+		done.wait();
+	}
+};
+
+/// The reusable scanners, one per configuration (the normalized decode options of the query)
+class Scanners
+{
+	std::mutex _mutex;
+	std::map<std::string, std::unique_ptr<BarcodeScanner>> _scanners;
+
+public:
+	BarcodeScanner* get(const std::string& key, const DecodeHints& hints)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		auto& scanner = _scanners[key];
+		if (!scanner)
+			scanner.reset(new BarcodeScanner(hints));
+		return scanner.get();
+	}
+
+	int size()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return static_cast<int>(_scanners.size());
+	}
+};
+
+static Scanners g_scanners;
+static std::unique_ptr<Batcher> g_batcher;
+static int g_cacheSize = 0; // images whose results each scanner keeps, see DecodeHints::resultCacheSize
+
+struct HttpRequest
+{
+	std::string method, path;
+	std::map<std::string, std::string> query;
+	std::string body;
+	bool keepAlive = true;
+};
+
+struct HttpResponse
+{
+	int status = 200;
+	std::string contentType = "application/json";
+	std::string body;
+};
+
+static std::string UrlDecode(const std::string& str)
+{
+	std::string res;
+	for (size_t i = 0; i < str.size(); ++i) {
+		if (str[i] == '%' && i + 2 < str.size()) {
+			res += static_cast<char>(std::strtol(str.substr(i + 1, 2).c_str(), nullptr, 16));
+			i += 2;
+		}
+		else {
+			res += str[i] == '+' ? ' ' : str[i];
+		}
+	}
+	return res;
+}
+
+static bool ReadRequest(int fd, std::string& buffer, HttpRequest& req)
+{
+	constexpr size_t MAX_BODY = 64 * 1024 * 1024;
+	char chunk[64 * 1024];
+	size_t headerEnd;
+	while ((headerEnd = buffer.find("\r\n\r\n")) == std::string::npos) {
+		ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+		if (n <= 0 || buffer.size() > 64 * 1024)
+			return false;
+		buffer.append(chunk, n);
+	}
+
+	std::istringstream header(buffer.substr(0, headerEnd));
+	std::string target, version, line;
+	header >> req.method >> target >> version;
+	std::getline(header, line);
+	size_t contentLength = 0;
+	req.keepAlive = version == "HTTP/1.1";
+	while (std::getline(header, line)) {
+		auto colon = line.find(':');
+		if (colon == std::string::npos)
+			continue;
+		std::string name = line.substr(0, colon), value = line.substr(colon + 1);
+		std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+		value.erase(0, value.find_first_not_of(' '));
+		value.erase(value.find_last_not_of("\r ") + 1);
+		if (name == "content-length")
+			contentLength = std::strtoul(value.c_str(), nullptr, 10);
+		else if (name == "connection")
+			req.keepAlive = value != "close";
+	}
+	if (contentLength > MAX_BODY)
+		return false;
+
+	auto question = target.find('?');
+	req.path = target.substr(0, question);
+	if (question != std::string::npos) {
+		std::istringstream query(target.substr(question + 1));
+		std::string param;
+		while (std::getline(query, param, '&')) {
+			auto eq = param.find('=');
+			req.query[UrlDecode(param.substr(0, eq))] = eq == std::string::npos ? "1" : UrlDecode(param.substr(eq + 1));
+		}
+	}
+
+	buffer.erase(0, headerEnd + 4);
+	while (buffer.size() < contentLength) {
+		ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+		if (n <= 0)
+			return false;
+		buffer.append(chunk, n);
+	}
+	req.body = buffer.substr(0, contentLength);
+	buffer.erase(0, contentLength);
+	return true;
+}
+
+static bool WriteResponse(int fd, const HttpResponse& res, bool keepAlive)
+{
+	const char* reason = res.status == 200 ? "OK" : res.status == 404 ? "Not Found" : "Bad Request";
+	std::string out = "HTTP/1.1 " + std::to_string(res.status) + " " + reason + "\r\nContent-Type: " + res.contentType +
+					  "\r\nContent-Length: " + std::to_string(res.body.size()) +
+					  (keepAlive ? "\r\n\r\n" : "\r\nConnection: close\r\n\r\n") + res.body;
+	for (size_t sent = 0; sent < out.size();) {
+		ssize_t n = send(fd, out.data() + sent, out.size() - sent, 0);
+		if (n <= 0)
+			return false;
+		sent += n;
+	}
+	return true;
+}
+
+static std::string JsonString(const std::string& str)
+{
+	std::string res = "\"";
+	for (unsigned char c : str) {
+		if (c == '"' || c == '\\') {
+			res += '\\';
+			res += c;
+		}
+		else if (c < 0x20) {
+			char buf[8];
+			snprintf(buf, sizeof(buf), "\\u%04x", c);
+			res += buf;
+		}
+		else {
+			res += c;
+		}
+	}
+	return res + "\"";
+}
+
+static HttpResponse BadRequest(const std::string& message)
+{
+	++g_metrics.badRequests;
+	HttpResponse res;
+	res.status = 400;
+	res.body = "{\"error\":" + JsonString(message) + "}\n";
+	return res;
+}
+
+static HttpResponse HandleDecode(const HttpRequest& req)
+{
+	auto flag = [&req](const char* name) { return req.query.count(name) && req.query.at(name) != "0"; };
+
+	DecodeHints hints;
+	std::string formats = req.query.count("formats") ? req.query.at("formats") : "";
+	try {
+		hints.setFormats(BarcodeFormatsFromString(formats));
+	} catch (const std::exception& e) {
+		return BadRequest(e.what());
+	}
+	hints.setTryHarder(!flag("fast")).setTryRotate(flag("rotate")).setIsPure(flag("pure"));
+	if (flag("pure"))
+		hints.setBinarizer(Binarizer::FixedThreshold);
+	// all buffers of a request have to be allocated on the decoding thread, see RequestArenas
+	hints.setBinarizerThreads(1).setStats(&g_metrics.decode).setMemoryResource(&g_arenas);
+	hints.setResultCacheSize(g_cacheSize);
+	const bool multi = flag("multi");
+	std::string key = formats + (flag("fast") ? "|fast" : "") + (flag("rotate") ? "|rotate" : "") +
+					  (flag("pure") ? "|pure" : "");
+
+	std::unique_ptr<stbi_uc, void (*)(void*)> pixels(nullptr, stbi_image_free);
+	int width = 0, height = 0, channels = 0;
+	ImageFormat format = ImageFormat::Lum;
+	const auto* body = reinterpret_cast<const uint8_t*>(req.body.data());
+	if (req.query.count("width") && req.query.count("height")) {
+		width = std::atoi(req.query.at("width").c_str());
+		height = std::atoi(req.query.at("height").c_str());
+		if (width <= 0 || height <= 0 || static_cast<size_t>(width) * height != req.body.size())
+			return BadRequest("body size does not match width x height");
+	}
+	else {
+		if (!stbi_info_from_memory(body, static_cast<int>(req.body.size()), &width, &height, &channels))
+			return BadRequest("unsupported image format");
+		int loadChannels = channels <= 2 ? 1 : channels;
+		format = loadChannels == 1 ? ImageFormat::Lum : loadChannels == 3 ? ImageFormat::RGB : ImageFormat::RGBX;
+		pixels.reset(stbi_load_from_memory(body, static_cast<int>(req.body.size()), &width, &height, &channels,
+										   loadChannels));
+		if (!pixels)
+			return BadRequest("failed to decode image");
+		body = pixels.get();
+	}
+
+	Job job(g_scanners.get(key + (multi ? "|multi" : ""), hints), multi, ImageView(body, width, height, format));
+	g_batcher->decode(job);
+
+	HttpResponse res;
+	res.body = "{\"results\":[";
+	for (size_t i = 0; i < job.results.size(); ++i) {
+		const auto& result = job.results[i];
+		const auto& pos = result.position();
+		res.body += std::string(i ? "," : "") + "{\"format\":" + JsonString(ToString(result.format())) +
+					",\"text\":" + JsonString(result.utf8()) + ",\"position\":[";
+		for (int j = 0; j < 4; ++j)
+			res.body += (j ? "," : "") + std::to_string(pos[j].x) + "," + std::to_string(pos[j].y);
+		res.body += "]}";
+	}
+	res.body += "]}\n";
+	g_metrics.symbols += job.results.size();
+	return res;
+}
+
+static HttpResponse HandleMetrics()
+{
+	static const char* stageNames[] = {"Binarize", "Detect", "Sample", "ErrorCorrection", "DecodeText"};
+	static const char* readerNames[] = {"OneD", "QRCode", "DataMatrix", "Aztec", "PDF417", "MaxiCode"};
+	const auto& stats = g_metrics.decode;
+
+	std::ostringstream out;
+	g_metrics.requestSeconds.write(out, "zxing_request_duration_seconds",
+								   "Time from the complete request to the response of POST /decode.");
+	g_metrics.queueSeconds.write(out, "zxing_queue_wait_seconds", "Time a request waited for its batch to start.");
+	g_metrics.decodeSeconds.write(out, "zxing_decode_duration_seconds", "Time spent decoding a request.");
+	g_metrics.batchSize.write(out, "zxing_batch_size", "Number of requests decoded together.");
+
+	out << "# HELP zxing_stage_seconds_total Time spent per decoding stage.\n"
+		<< "# TYPE zxing_stage_seconds_total counter\n";
+	for (int i = 0; i < static_cast<int>(DecodeStats::Stage::_count); ++i)
+		out << "zxing_stage_seconds_total{stage=\"" << stageNames[i] << "\"} "
+			<< std::chrono::duration<double>(stats.time(static_cast<DecodeStats::Stage>(i))).count() << "\n";
+	out << "# HELP zxing_reader_seconds_total Time spent per reader.\n"
+		<< "# TYPE zxing_reader_seconds_total counter\n";
+	for (int i = 0; i < static_cast<int>(DecodeStats::ReaderType::_count); ++i)
+		out << "zxing_reader_seconds_total{reader=\"" << readerNames[i] << "\"} "
+			<< std::chrono::duration<double>(stats.time(static_cast<DecodeStats::ReaderType>(i))).count() << "\n";
+
+	auto counter = [&out](const char* name, const char* help, uint64_t value) {
+		out << "# HELP " << name << " " << help << "\n# TYPE " << name << " counter\n" << name << " " << value << "\n";
+	};
+	counter("zxing_requests_total", "Requests received.", g_metrics.requests);
+	counter("zxing_bad_requests_total", "Requests rejected as malformed.", g_metrics.badRequests);
+	counter("zxing_symbols_total", "Symbols decoded.", g_metrics.symbols);
+	counter("zxing_arena_bytes_total", "Bytes allocated by the per request arenas.", g_metrics.arenaBytes);
+	counter("zxing_allocations_total", "Image sized buffers allocated.", stats.allocations());
+	counter("zxing_rows_scanned_total", "Rows scanned by the 1D readers.", stats.rowsScanned());
+	counter("zxing_errors_corrected_total", "Codewords fixed by error correction.", stats.errorsCorrected());
+	counter("zxing_cache_hits_total", "Requests answered from the result cache.", stats.cacheHits());
+	counter("zxing_cache_misses_total", "Requests not found in the result cache.", stats.cacheMisses());
+	out << "# HELP zxing_scanners Reusable scanners, one per configuration.\n# TYPE zxing_scanners gauge\n"
+		<< "zxing_scanners " << g_scanners.size() << "\n";
+
+	HttpResponse res;
+	res.contentType = "text/plain; version=0.0.4";
+	res.body = out.str();
+	return res;
+}
+
+static void Serve(int fd)
+{
+	std::string buffer;
+	HttpRequest req;
+	while (ReadRequest(fd, buffer, req)) {
+		auto start = Clock::now();
+		HttpResponse res;
+		if (req.method == "POST" && req.path == "/decode") {
+			++g_metrics.requests;
+			res = HandleDecode(req);
+			g_metrics.requestSeconds.observe(Seconds(Clock::now() - start));
+		}
+		else if (req.method == "GET" && req.path == "/metrics") {
+			res = HandleMetrics();
+		}
+		else if (req.method == "GET" && req.path == "/healthz") {
+			res.contentType = "text/plain";
+			res.body = "ok\n";
+		}
+		else {
+			res.status = 404;
+			res.body = "{\"error\":\"not found\"}\n";
+		}
+		if (!WriteResponse(fd, res, req.keepAlive) || !req.keepAlive)
+			break;
+		req = HttpRequest();
+	}
+	close(fd);
+}
+
+static void PrintUsage(const char* exePath)
+{
+	std::cout << "Usage: " << exePath << " [options]\n"
+			  << "    -port <N>        TCP port to listen on (default 8080)\n"
+			  << "    -batch <N>       Most requests decoded together (default: number of cores)\n"
+			  << "    -batchwait <us>  Longest time a request waits for others to join its batch (default 1000)\n"
+			  << "    -cache <N>       Keep the results of the last N distinct images per configuration (default 0)\n"
+			  << "\n"
+			  << "POST /decode?formats=<list>&fast=1&rotate=1&pure=1&multi=1  body: image file\n"
+			  << "POST /decode?width=<w>&height=<h>                          body: raw 8-bit gray pixels\n"
+			  << "GET  /metrics                                              Prometheus text format\n";
+}
+
+int main(int argc, char* argv[])
+{
+	int port = 8080;
+	int maxBatch = std::max(1u, std::thread::hardware_concurrency());
+	int maxWait = 1000;
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "-port") == 0 && i + 1 < argc)
+			port = std::atoi(argv[++i]);
+		else if (strcmp(argv[i], "-batch") == 0 && i + 1 < argc)
+			maxBatch = std::max(1, std::atoi(argv[++i]));
+		else if (strcmp(argv[i], "-batchwait") == 0 && i + 1 < argc)
+			maxWait = std::max(0, std::atoi(argv[++i]));
+		else if (strcmp(argv[i], "-cache") == 0 && i + 1 < argc)
+			g_cacheSize = std::max(0, std::atoi(argv[++i]));
+		else {
+			PrintUsage(argv[0]);
+			return argc == 2 && strcmp(argv[1], "-help") == 0 ? 0 : -1;
+		}
+	}
+	g_batcher.reset(new Batcher(maxBatch, std::chrono::microseconds(maxWait)));
+	signal(SIGPIPE, SIG_IGN);
+
+	int server = socket(AF_INET, SOCK_STREAM, 0);
+	int yes = 1;
+	setsockopt(server, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+	sockaddr_in addr = {};
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_ANY);
+	addr.sin_port = htons(static_cast<uint16_t>(port));
+	if (server < 0 || bind(server, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(server, 64) != 0) {
+		perror("Failed to listen");
+		return -1;
+	}
+	std::cerr << "Listening on port " << port << "\n";
+
+	// one thread per connection, they only parse and wait, the decoding happens in the batches
+	for (;;) {
+		int fd = accept(server, nullptr, nullptr);
+		if (fd >= 0)
+			std::thread(Serve, fd).detach();
+	}
+}
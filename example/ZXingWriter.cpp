@@ -17,10 +17,12 @@
 #include "BarcodeFormat.h"
 #include "MultiFormatWriter.h"
 #include "BitMatrix.h"
+#include "BitMatrixIO.h"
 #include "ByteMatrix.h"
 #include "TextUtfEncoding.h"
 #include "ZXStrConvWorkaround.h"
 
+#include <fstream>
 #include <iostream>
 #include <cstring>
 #include <string>
@@ -47,6 +49,7 @@ static void PrintUsage(const char* exePath)
 		std::cout << "    " << ToString(f) << "\n";
 	}
 	std::cout << "Format can be lowercase letters, with or without underscore.\n";
+	std::cout << "The output file type is chosen by its extension: png (default), jpg, svg, pbm or tif.\n";
 }
 
 static bool ParseSize(std::string str, int* width, int* height)
@@ -132,14 +135,25 @@ int main(int argc, char* argv[])
 
 	try {
 		auto writer = MultiFormatWriter(format).setMargin(margin).setEccLevel(eccLevel);
-		auto bitmap = ToMatrix<uint8_t>(writer.encode(TextUtfEncoding::FromUtf8(text), width, height));
+		auto contents = TextUtfEncoding::FromUtf8(text);
 
 		auto ext = GetExtension(filePath);
 		int success = 0;
-		if (ext == "" || ext == "png") {
-			success = stbi_write_png(filePath.c_str(), bitmap.width(), bitmap.height(), 1, bitmap.data(), 0);
+		if (ext == "svg") {
+			// vector output is built from the unscaled symbol, -size is ignored
+			std::ofstream file(filePath);
+			file << ToSVG(writer.encode(contents));
+			success = static_cast<bool>(file);
+		}
+		else if (ext == "" || ext == "png" || ext == "pbm" || ext == "tif" || ext == "tiff") {
+			// 1-bit output packed straight from the rendered matrix
+			auto matrix = writer.encode(contents, width, height);
+			std::ofstream file(filePath, std::ios::binary);
+			file << (ext == "pbm" ? ToPBM(matrix) : ext[0] == 't' ? ToTIFF(matrix) : ToPNG(matrix));
+			success = static_cast<bool>(file);
 		}
 		else if (ext == "jpg" || ext == "jpeg") {
+			auto bitmap = ToMatrix<uint8_t>(writer.encode(contents, width, height));
 			success = stbi_write_jpg(filePath.c_str(), bitmap.width(), bitmap.height(), 1, bitmap.data(), 0);
 		}
 
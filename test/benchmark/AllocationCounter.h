@@ -0,0 +1,28 @@
+#pragma once
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <cstdint>
+
+namespace ZXing::Test {
+
+/**
+* Number of calls to the global operator new so far. The counting replacement lives in BenchmarkMain.cpp, so this
+* includes the allocations of the library and of the standard library containers it uses.
+*/
+uint64_t AllocationCount();
+
+} // ZXing::Test
@@ -0,0 +1,448 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "BarcodeFormat.h"
+#include "BitMatrix.h"
+#include "MultiFormatWriter.h"
+#include "Parallel.h"
+#include "PerspectiveTransform.h"
+#include "ReadBarcode.h"
+#include "TextUtfEncoding.h"
+#include "ZXContainerAlgorithms.h"
+#include "ZXFilesystem.h"
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace ZXing;
+
+// Synthesizes a corpus of barcode images with ground truth for load and scaling tests. Everything is derived from
+// the seed with fully specified algorithms (std::mt19937, std::seed_seq and the code below), so the same command
+// line creates the same images on every platform and with every release.
+
+namespace {
+
+struct Options
+{
+	BarcodeFormats formats;
+	int count = 10;
+	double minMegapixels = 0.3, maxMegapixels = 2;
+	double minModuleSize = 2, maxModuleSize = 8;
+	double maxRotation = 0;    // in degrees, uniform in [-maxRotation, maxRotation]
+	double maxPerspective = 0; // corner displacement as fraction of the symbol height
+	int maxBlur = 0;           // box blur radius in pixels
+	double maxNoise = 0;       // standard deviation in gray levels
+	int maxSymbols = 1;
+	uint32_t seed = 1;
+	int threads = 0;
+	std::string extension = "png";
+	fs::path outDir;
+};
+
+class Random
+{
+	std::mt19937 _gen;
+
+public:
+	Random(uint32_t seed, uint32_t stream, uint32_t index)
+	{
+		std::seed_seq seq{seed, stream, index};
+		_gen.seed(seq);
+	}
+
+	double uniform(double lo, double hi) { return lo + (hi - lo) * (_gen() / 4294967296.0); }
+	int uniformInt(int lo, int hi) { return lo + static_cast<int>(_gen() % static_cast<uint32_t>(hi - lo + 1)); }
+	// approximately standard normal (Irwin-Hall), std::normal_distribution differs between standard libraries
+	double normal()
+	{
+		double sum = 0;
+		for (int i = 0; i < 12; ++i)
+			sum += uniform(0, 1);
+		return sum - 6;
+	}
+
+	std::string text(const char* alphabet, int minLength, int maxLength)
+	{
+		int n = static_cast<int>(std::strlen(alphabet));
+		std::string res(uniformInt(minLength, maxLength), ' ');
+		for (auto& c : res)
+			c = alphabet[uniformInt(0, n - 1)];
+		return res;
+	}
+};
+
+std::string RandomContents(BarcodeFormat format, Random& rnd)
+{
+	const char* digits = "0123456789";
+	switch (format) {
+	case BarcodeFormat::CODABAR: return "A" + rnd.text(digits, 4, 12) + "B";
+	case BarcodeFormat::CODE_39: return rnd.text("0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ-. ", 4, 12);
+	case BarcodeFormat::CODE_93: return rnd.text("0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ", 4, 12);
+	case BarcodeFormat::CODE_128: return rnd.text("0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz", 4, 20);
+	case BarcodeFormat::EAN_8: return rnd.text(digits, 7, 7);
+	case BarcodeFormat::EAN_13: return rnd.text(digits, 12, 12);
+	case BarcodeFormat::UPC_A: return rnd.text(digits, 11, 11);
+	case BarcodeFormat::UPC_E: return "0" + rnd.text(digits, 6, 6);
+	case BarcodeFormat::ITF: {
+		// interleaved 2 of 5 needs an even number of digits
+		auto half = rnd.text(digits, 3, 7);
+		return half + rnd.text(digits, Size(half), Size(half));
+	}
+	default: return rnd.text("0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz -.:/", 5, 80);
+	}
+}
+
+struct Symbol
+{
+	BitMatrix bits;     // one bit per module, without quiet zone
+	std::string text;   // what the reader reports for it
+	int heightModules;  // 1D symbols get bars of this height
+	int quietZone;
+};
+
+// Encodes random contents and reads back a clean rendering, so the ground truth is exactly what the library returns
+// (including check digits and the like).
+Symbol MakeSymbol(BarcodeFormat format, Random& rnd)
+{
+	bool linear = !(BarcodeFormats(BarcodeFormat::AZTEC) | BarcodeFormat::DATA_MATRIX | BarcodeFormat::PDF_417 |
+					BarcodeFormat::QR_CODE).testFlag(format);
+	for (int attempt = 0; attempt < 10; ++attempt) {
+		auto contents = TextUtfEncoding::FromUtf8(RandomContents(format, rnd));
+		auto bits = MultiFormatWriter(format).setMargin(0).encode(contents);
+		int heightModules = linear ? std::max(20, bits.width() / 3) : bits.height();
+		int quietZone = linear ? 10 : 4;
+
+		auto clean = ToMatrix<uint8_t>(MultiFormatWriter(format).setMargin(quietZone * 3).encode(
+			contents, (bits.width() + 2 * quietZone) * 3, (heightModules + 2 * quietZone) * 3));
+		auto result = ReadBarcode({clean.data(), clean.width(), clean.height(), ImageFormat::Lum},
+								  DecodeHints().setFormats(format));
+		if (result.isValid())
+			return {std::move(bits), result.utf8(), heightModules, quietZone};
+	}
+	throw std::runtime_error(std::string("Failed to create a readable ") + ToString(format) + " symbol");
+}
+
+struct Canvas
+{
+	int width, height;
+	std::vector<uint8_t> pixels;
+	uint8_t background, ink;
+};
+
+/**
+* Draws the symbol with the given module size, rotated around its center by rotation degrees, its corners displaced by
+* up to perspective * symbol size, inside the cell (left, top, cellWidth, cellHeight). Returns the position of the
+* symbol (without quiet zone) or an empty string if it doesn't fit.
+*/
+std::string Draw(Canvas& canvas, const Symbol& symbol, double moduleSize, double rotation, double perspective,
+				 int left, int top, int cellWidth, int cellHeight, Random& rnd)
+{
+	const int q = symbol.quietZone;
+	const double w = symbol.bits.width() + 2 * q, h = symbol.heightModules + 2 * q;
+	const double a = rotation * 3.14159265358979323846 / 180, cosA = std::abs(std::cos(a)), sinA = std::abs(std::sin(a));
+	// shrink the modules until the rotated and distorted symbol fits into the cell
+	auto extent = [&](double m, bool horizontal) {
+		return m * ((horizontal ? cosA * w + sinA * h : sinA * w + cosA * h) + 2 * perspective * std::min(w, h));
+	};
+	moduleSize = std::min({moduleSize, moduleSize * cellWidth / extent(moduleSize, true),
+						   moduleSize * cellHeight / extent(moduleSize, false)});
+	if (moduleSize < 1)
+		return {};
+
+	double ew = extent(moduleSize, true), eh = extent(moduleSize, false);
+	PointF center(left + rnd.uniform(ew / 2, cellWidth - ew / 2), top + rnd.uniform(eh / 2, cellHeight - eh / 2));
+	PointF dx(std::cos(a) * moduleSize, std::sin(a) * moduleSize), dy(-dx.y, dx.x);
+	auto corner = [&](double u, double v) {
+		double jitter = perspective * std::min(w, h) * moduleSize;
+		return center + (u - w / 2) * dx + (v - h / 2) * dy +
+			   PointF(rnd.uniform(-jitter, jitter), rnd.uniform(-jitter, jitter));
+	};
+	QuadrilateralF modules(PointF(-q, -q), PointF(w - q, -q), PointF(w - q, h - q), PointF(-q, h - q));
+	QuadrilateralF image(corner(0, 0), corner(w, 0), corner(w, h), corner(0, h));
+	PerspectiveTransform toModules(image, modules), toImage(modules, image);
+
+	int x0 = std::max(0, static_cast<int>(std::floor(std::min({image[0].x, image[1].x, image[2].x, image[3].x}))));
+	int x1 = std::min(canvas.width, static_cast<int>(std::ceil(std::max({image[0].x, image[1].x, image[2].x, image[3].x}))));
+	int y0 = std::max(0, static_cast<int>(std::floor(std::min({image[0].y, image[1].y, image[2].y, image[3].y}))));
+	int y1 = std::min(canvas.height, static_cast<int>(std::ceil(std::max({image[0].y, image[1].y, image[2].y, image[3].y}))));
+
+	// 2 x 2 supersampling for anti-aliased module edges
+	std::vector<int> black(std::max(0, x1 - x0));
+	const bool linear = symbol.bits.height() == 1;
+	for (int y = y0; y < y1; ++y) {
+		std::fill(black.begin(), black.end(), 0);
+		for (double sy : {0.25, 0.75})
+			for (double sx : {0.25, 0.75})
+				toModules.mapRow(PointF(x0 + sx, y + sy), x1 - x0, [&](int i, PointF p) {
+					if (p.x >= 0 && p.y >= 0 && p.x < symbol.bits.width() && p.y < symbol.heightModules)
+						black[i] += symbol.bits.get(static_cast<int>(p.x), linear ? 0 : static_cast<int>(p.y));
+				});
+		uint8_t* row = canvas.pixels.data() + y * canvas.width + x0;
+		for (int i = 0; i < x1 - x0; ++i)
+			if (black[i])
+				row[i] = static_cast<uint8_t>(canvas.background - (canvas.background - canvas.ink) * black[i] / 4);
+	}
+
+	std::ostringstream pos;
+	for (auto p : {PointF(0, 0), PointF(w - 2 * q, 0), PointF(w - 2 * q, h - 2 * q), PointF(0, h - 2 * q)}) {
+		auto ip = toImage(p);
+		pos << (pos.tellp() ? " " : "") << std::lround(ip.x) << "x" << std::lround(ip.y);
+	}
+	char info[64];
+	std::snprintf(info, sizeof(info), "\t%.2f\t%.1f", moduleSize, rotation);
+	return pos.str() + info;
+}
+
+// three passes of a box blur approximate a gaussian one
+void Blur(Canvas& canvas, int radius)
+{
+	if (radius <= 0)
+		return;
+	auto pass = [radius](uint8_t* data, int count, int stride) {
+		std::vector<uint8_t> line(count);
+		for (int i = 0; i < count; ++i)
+			line[i] = data[i * stride];
+		int sum = 0, n = 2 * radius + 1;
+		auto at = [&](int i) { return line[std::clamp(i, 0, count - 1)]; };
+		for (int i = -radius; i <= radius; ++i)
+			sum += at(i);
+		for (int i = 0; i < count; ++i) {
+			data[i * stride] = static_cast<uint8_t>(sum / n);
+			sum += at(i + radius + 1) - at(i - radius);
+		}
+	};
+	for (int k = 0; k < 3; ++k) {
+		for (int y = 0; y < canvas.height; ++y)
+			pass(canvas.pixels.data() + y * canvas.width, canvas.width, 1);
+		for (int x = 0; x < canvas.width; ++x)
+			pass(canvas.pixels.data() + x, canvas.height, canvas.width);
+	}
+}
+
+void AddNoise(Canvas& canvas, double stdDev, Random& rnd)
+{
+	if (stdDev <= 0)
+		return;
+	for (auto& p : canvas.pixels)
+		p = static_cast<uint8_t>(std::clamp(static_cast<int>(std::lround(p + stdDev * rnd.normal())), 0, 255));
+}
+
+std::string DirectoryName(BarcodeFormat format)
+{
+	std::string name = ToString(format);
+	name.erase(std::remove(name.begin(), name.end(), '_'), name.end());
+	std::transform(name.begin(), name.end(), name.begin(), [](char c) { return static_cast<char>(std::tolower(c)); });
+	return name;
+}
+
+// Creates image 'index' of a format, returns its ground truth lines
+std::string Generate(const Options& opts, BarcodeFormat format, int index)
+{
+	Random rnd(opts.seed, static_cast<uint32_t>(format), index);
+
+	// log-uniform size, 4:3 landscape or portrait
+	double megapixels = std::exp(rnd.uniform(std::log(opts.minMegapixels), std::log(opts.maxMegapixels)));
+	int longSide = static_cast<int>(std::sqrt(megapixels * 1e6 * 4 / 3));
+	int shortSide = longSide * 3 / 4;
+	bool portrait = rnd.uniformInt(0, 1);
+	Canvas canvas{portrait ? shortSide : longSide, portrait ? longSide : shortSide, {}, 0, 0};
+	canvas.background = static_cast<uint8_t>(rnd.uniformInt(170, 255));
+	canvas.ink = static_cast<uint8_t>(rnd.uniformInt(0, 80));
+	canvas.pixels.assign(size_t(canvas.width) * canvas.height, canvas.background);
+
+	int numSymbols = rnd.uniformInt(1, opts.maxSymbols);
+	int cols = static_cast<int>(std::ceil(std::sqrt(numSymbols)));
+	int rows = (numSymbols + cols - 1) / cols;
+	int cellWidth = canvas.width / cols, cellHeight = canvas.height / rows;
+
+	char name[32];
+	std::snprintf(name, sizeof(name), "%04d.", index);
+	auto relPath = fs::path(DirectoryName(format)) / (name + opts.extension);
+
+	std::vector<std::string> texts;
+	std::string truth;
+	for (int i = 0; i < numSymbols; ++i) {
+		auto symbol = MakeSymbol(format, rnd);
+		auto pos = Draw(canvas, symbol, rnd.uniform(opts.minModuleSize, opts.maxModuleSize),
+						rnd.uniform(-opts.maxRotation, opts.maxRotation), rnd.uniform(0, opts.maxPerspective),
+						(i % cols) * cellWidth, (i / cols) * cellHeight, cellWidth, cellHeight, rnd);
+		if (pos.empty())
+			continue;
+		texts.push_back(symbol.text);
+		truth += relPath.generic_string() + "\t" + ToString(format) + "\t" + symbol.text + "\t" + pos + "\n";
+	}
+
+	Blur(canvas, rnd.uniformInt(0, opts.maxBlur));
+	AddNoise(canvas, rnd.uniform(0, opts.maxNoise), rnd);
+
+	auto path = opts.outDir / relPath;
+	bool ok = opts.extension == "pgm"
+				  ? [&] {
+						std::ofstream f(path, std::ios::binary);
+						f << "P5\n" << canvas.width << " " << canvas.height << "\n255\n";
+						f.write(reinterpret_cast<const char*>(canvas.pixels.data()), canvas.pixels.size());
+						return f.good();
+					}()
+				  : stbi_write_png(path.string().c_str(), canvas.width, canvas.height, 1, canvas.pixels.data(),
+								   canvas.width) != 0;
+	if (!ok)
+		throw std::runtime_error("Failed to write " + path.string());
+
+	// like in test/samples, images with a single symbol get their expected text next to them
+	if (texts.size() == 1)
+		std::ofstream(fs::path(path).replace_extension(".txt"), std::ios::binary) << texts.front();
+
+	return truth;
+}
+
+void PrintUsage(const char* exePath)
+{
+	std::cout << "Usage: " << exePath << " [options] <output dir>\n"
+			  << "    -formats <list>        Formats to generate (default: all with a writer)\n"
+			  << "    -count <n>             Images per format (default: 10)\n"
+			  << "    -megapixels <min:max>  Image size range, log-uniform (default: 0.3:2)\n"
+			  << "    -modulesize <min:max>  Module size range in pixels (default: 2:8)\n"
+			  << "    -rotation <degrees>    Maximum rotation, both directions (default: 0)\n"
+			  << "    -perspective <f>       Maximum corner displacement as fraction of the symbol height (default: 0)\n"
+			  << "    -blur <radius>         Maximum blur radius in pixels (default: 0)\n"
+			  << "    -noise <sigma>         Maximum noise standard deviation in gray levels (default: 0)\n"
+			  << "    -symbols <n>           Maximum number of symbols per image (default: 1)\n"
+			  << "    -seed <n>              Seed of the pseudo random numbers (default: 1)\n"
+			  << "    -threads <n>           Number of images generated concurrently (default: hardware threads)\n"
+			  << "    -pgm                   Write binary PGM instead of PNG files (faster for huge images)\n"
+			  << "\n"
+			  << "Creates one directory per format and <output dir>/groundtruth.tsv with one line per symbol:\n"
+			  << "file, format, text, the 4 corners (top-left first, clockwise), module size and rotation.\n"
+			  << "Images with a single symbol also get a .txt file with the text, like test/samples.\n";
+}
+
+bool ParseRange(const char* str, double& lo, double& hi)
+{
+	return std::sscanf(str, "%lf:%lf", &lo, &hi) == 2 && 0 < lo && lo <= hi;
+}
+
+bool ParseOptions(int argc, char* argv[], Options& opts)
+{
+	for (int i = 1; i < argc; ++i) {
+		auto is = [&](const char* str) { return std::strcmp(argv[i], str) == 0 && i + 1 < argc; };
+		if (is("-formats"))
+			opts.formats = BarcodeFormatsFromString(argv[++i]);
+		else if (is("-count"))
+			opts.count = std::atoi(argv[++i]);
+		else if (is("-megapixels")) {
+			if (!ParseRange(argv[++i], opts.minMegapixels, opts.maxMegapixels))
+				return false;
+		}
+		else if (is("-modulesize")) {
+			if (!ParseRange(argv[++i], opts.minModuleSize, opts.maxModuleSize))
+				return false;
+		}
+		else if (is("-rotation"))
+			opts.maxRotation = std::atof(argv[++i]);
+		else if (is("-perspective"))
+			opts.maxPerspective = std::atof(argv[++i]);
+		else if (is("-blur"))
+			opts.maxBlur = std::atoi(argv[++i]);
+		else if (is("-noise"))
+			opts.maxNoise = std::atof(argv[++i]);
+		else if (is("-symbols"))
+			opts.maxSymbols = std::max(1, std::atoi(argv[++i]));
+		else if (is("-seed"))
+			opts.seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+		else if (is("-threads"))
+			opts.threads = std::atoi(argv[++i]);
+		else if (std::strcmp(argv[i], "-pgm") == 0)
+			opts.extension = "pgm";
+		else if (argv[i][0] != '-' && opts.outDir.empty())
+			opts.outDir = argv[i];
+		else
+			return false;
+	}
+	return !opts.outDir.empty();
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	Options opts;
+	try {
+		if (!ParseOptions(argc, argv, opts)) {
+			PrintUsage(argv[0]);
+			return -1;
+		}
+	} catch (const std::exception& e) {
+		std::cerr << e.what() << "\n";
+		return -1;
+	}
+
+	// the formats MultiFormatWriter can create
+	std::vector<BarcodeFormat> formats;
+	for (auto f : {BarcodeFormat::AZTEC, BarcodeFormat::CODABAR, BarcodeFormat::CODE_39, BarcodeFormat::CODE_93,
+				   BarcodeFormat::CODE_128, BarcodeFormat::DATA_MATRIX, BarcodeFormat::EAN_8, BarcodeFormat::EAN_13,
+				   BarcodeFormat::ITF, BarcodeFormat::PDF_417, BarcodeFormat::QR_CODE, BarcodeFormat::UPC_A,
+				   BarcodeFormat::UPC_E})
+		if (opts.formats == BarcodeFormats() || opts.formats.testFlag(f))
+			formats.push_back(f);
+
+	for (auto f : formats)
+		fs::create_directories(opts.outDir / DirectoryName(f));
+
+	int numImages = Size(formats) * opts.count;
+	std::vector<std::string> truth(numImages);
+	std::atomic<int> next(0);
+	std::atomic<bool> failed(false);
+	int threads = opts.threads > 0 ? opts.threads : std::max(1u, std::thread::hardware_concurrency());
+	ParallelFor(std::min(threads, std::max(1, numImages)), [&](int) {
+		for (int i; !failed && (i = next++) < numImages;) {
+			try {
+				truth[i] = Generate(opts, formats[i / opts.count], i % opts.count);
+			} catch (const std::exception& e) {
+				std::cerr << e.what() << "\n";
+				failed = true;
+			}
+		}
+	});
+	if (failed)
+		return -1;
+
+	std::ofstream f(opts.outDir / "groundtruth.tsv", std::ios::binary);
+	f << "#";
+	for (int i = 0; i < argc; ++i)
+		f << " " << (i ? argv[i] : "ZXingCorpusGenerator");
+	f << "\n#file\tformat\ttext\tposition\tmodule size\trotation\n";
+	for (const auto& lines : truth)
+		f << lines;
+
+	std::cout << "Created " << numImages << " images in " << opts.outDir << "\n";
+	return 0;
+}
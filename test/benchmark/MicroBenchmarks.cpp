@@ -0,0 +1,227 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "AllocationCounter.h"
+#include "BarcodeFormat.h"
+#include "BitMatrix.h"
+#include "DetectorResult.h"
+#include "GenericGF.h"
+#include "GenericLuminanceSource.h"
+#include "GridSampler.h"
+#include "HybridBinarizer.h"
+#include "MultiFormatWriter.h"
+#include "PerspectiveTransform.h"
+#include "ReedSolomonDecoder.h"
+#include "ReedSolomonEncoder.h"
+#include "datamatrix/DMDetector.h"
+#include "qrcode/QRFinderPatternFinder.h"
+#include "qrcode/QRFinderPatternInfo.h"
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace ZXing;
+
+// Micro benchmarks of the individual stages of a decode on a synthetic VGA frame. They complement the sample based
+// ones in SampleBenchmarks.cpp, which measure whole decodes.
+
+namespace {
+
+constexpr int WIDTH = 640;
+constexpr int HEIGHT = 480;
+constexpr int MARGIN = 4;
+
+/**
+* A symbol drawn into a WIDTH x HEIGHT gray frame with a soft horizontal shading, plus where its modules ended up.
+*/
+struct Frame
+{
+	std::vector<uint8_t> lum;
+	int dimension = 0;
+	QuadrilateralF corners;
+
+	std::shared_ptr<const BitMatrix> binarized() const
+	{
+		auto source = std::make_shared<GenericLuminanceSource>(WIDTH, HEIGHT, lum.data(), WIDTH);
+		return HybridBinarizer(source).getBlackMatrix();
+	}
+};
+
+Frame MakeFrame(BarcodeFormat format)
+{
+	auto matrix = MultiFormatWriter(format).setMargin(MARGIN).encode(L"ZXing benchmark 0123456789 https://github.com/nu-book/zxing-cpp");
+
+	Frame frame;
+	frame.lum.resize(WIDTH * HEIGHT);
+	InflateInto(matrix, frame.lum.data(), WIDTH, HEIGHT, RasterFormat::Lum);
+	for (int y = 0; y < HEIGHT; ++y)
+		for (int x = 0; x < WIDTH; ++x) {
+			auto& p = frame.lum[y * WIDTH + x];
+			p = static_cast<uint8_t>(40 + p * (100 + x * 100 / WIDTH) / 255);
+		}
+
+	// same placement as InflateInto: largest integer scale, centered
+	int scale = std::min(WIDTH / matrix.width(), HEIGHT / matrix.height());
+	float left = (WIDTH - matrix.width() * scale) / 2 + MARGIN * scale;
+	float top = (HEIGHT - matrix.height() * scale) / 2 + MARGIN * scale;
+	frame.dimension = matrix.width() - 2 * MARGIN;
+	float size = frame.dimension * scale;
+	frame.corners = {PointF(left, top), PointF(left + size, top), PointF(left + size, top + size), PointF(left, top + size)};
+	return frame;
+}
+
+const Frame& QRFrame()
+{
+	static const Frame frame = MakeFrame(BarcodeFormat::QR_CODE);
+	return frame;
+}
+
+const Frame& DMFrame()
+{
+	static const Frame frame = MakeFrame(BarcodeFormat::DATA_MATRIX);
+	return frame;
+}
+
+void SetPixelsProcessed(benchmark::State& state, int64_t pixels)
+{
+	state.SetItemsProcessed(state.iterations() * pixels);
+	state.counters["time/pixel"] = benchmark::Counter(static_cast<double>(pixels), benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+}
+
+void CountAllocations(benchmark::State& state, uint64_t start)
+{
+	state.counters["allocs"] = benchmark::Counter(static_cast<double>(Test::AllocationCount() - start), benchmark::Counter::kAvgIterations);
+}
+
+} // namespace
+
+static void BM_GenericLuminanceSource(benchmark::State& state)
+{
+	// RGBX input, so the conversion to gray is part of the measurement
+	const auto& lum = QRFrame().lum;
+	std::vector<uint8_t> rgbx(lum.size() * 4);
+	for (size_t i = 0; i < lum.size(); ++i)
+		rgbx[4 * i] = rgbx[4 * i + 1] = rgbx[4 * i + 2] = lum[i];
+
+	auto allocs = Test::AllocationCount();
+	for (auto _ : state)
+		benchmark::DoNotOptimize(GenericLuminanceSource(WIDTH, HEIGHT, rgbx.data(), WIDTH * 4, 4, 0, 1, 2));
+	CountAllocations(state, allocs);
+	SetPixelsProcessed(state, WIDTH * HEIGHT);
+}
+BENCHMARK(BM_GenericLuminanceSource);
+
+static void BM_HybridBinarizer(benchmark::State& state)
+{
+	const auto& lum = QRFrame().lum;
+	auto source = std::make_shared<GenericLuminanceSource>(WIDTH, HEIGHT, lum.data(), WIDTH);
+
+	auto allocs = Test::AllocationCount();
+	for (auto _ : state) {
+		// the binarizer caches its matrix, so it has to be a new one each time
+		HybridBinarizer binarizer(source, static_cast<int>(state.range(0)));
+		benchmark::DoNotOptimize(binarizer.getBlackMatrix());
+	}
+	CountAllocations(state, allocs);
+	SetPixelsProcessed(state, WIDTH * HEIGHT);
+}
+BENCHMARK(BM_HybridBinarizer)->ArgName("bands")->Arg(1)->Arg(4);
+
+static void BM_QRFinderPatternFinder(benchmark::State& state)
+{
+	auto image = QRFrame().binarized();
+
+	auto allocs = Test::AllocationCount();
+	for (auto _ : state)
+		benchmark::DoNotOptimize(QRCode::FinderPatternFinder::Find(*image, state.range(0) != 0));
+	CountAllocations(state, allocs);
+	SetPixelsProcessed(state, WIDTH * HEIGHT);
+}
+BENCHMARK(BM_QRFinderPatternFinder)->ArgName("tryHarder")->Arg(0)->Arg(1);
+
+static void BM_DMDetector(benchmark::State& state)
+{
+	auto image = DMFrame().binarized();
+
+	auto allocs = Test::AllocationCount();
+	for (auto _ : state)
+		benchmark::DoNotOptimize(DataMatrix::Detector::Detect(*image, state.range(0) != 0, false, false));
+	CountAllocations(state, allocs);
+	SetPixelsProcessed(state, WIDTH * HEIGHT);
+}
+BENCHMARK(BM_DMDetector)->ArgName("tryHarder")->Arg(0)->Arg(1);
+
+static void BM_GridSampler(benchmark::State& state)
+{
+	const auto& frame = QRFrame();
+	auto image = frame.binarized();
+	PerspectiveTransform transform(Rectangle(frame.dimension, frame.dimension), frame.corners);
+	auto mode = static_cast<SampleMode>(state.range(0));
+
+	auto allocs = Test::AllocationCount();
+	for (auto _ : state)
+		benchmark::DoNotOptimize(SampleGrid(*image, frame.dimension, frame.dimension, transform, nullptr, mode));
+	CountAllocations(state, allocs);
+	state.SetItemsProcessed(state.iterations() * frame.dimension * frame.dimension);
+}
+BENCHMARK(BM_GridSampler)->ArgName("mode")->Arg(static_cast<int>(SampleMode::Center))->Arg(static_cast<int>(SampleMode::Majority));
+
+static void BM_ReedSolomonDecode(benchmark::State& state)
+{
+	// one full QR block of 255 codewords, 30 of them EC, with state.range(0) errors
+	const auto& field = GenericGF::QRCodeField256();
+	constexpr int numEC = 30;
+	std::mt19937 random(42);
+	std::vector<int> codewords(255);
+	for (auto& c : codewords)
+		c = random() % 256;
+	ReedSolomonEncoder(field).encode(codewords, numEC);
+
+	auto received = codewords;
+	for (int i = 0; i < state.range(0); ++i)
+		received[(i * 37) % received.size()] ^= 1 + random() % 255;
+
+	auto allocs = Test::AllocationCount();
+	for (auto _ : state) {
+		auto block = received;
+		benchmark::DoNotOptimize(ReedSolomonDecoder::Decode(field, block, numEC));
+	}
+	CountAllocations(state, allocs);
+	state.SetItemsProcessed(state.iterations() * codewords.size());
+}
+BENCHMARK(BM_ReedSolomonDecode)->ArgName("errors")->Arg(0)->Arg(5)->Arg(15);
+
+static void BM_Encode(benchmark::State& state, BarcodeFormat format, std::wstring text)
+{
+	MultiFormatWriter writer(format);
+
+	auto allocs = Test::AllocationCount();
+	for (auto _ : state)
+		benchmark::DoNotOptimize(writer.encode(text));
+	CountAllocations(state, allocs);
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_CAPTURE(BM_Encode, Aztec, BarcodeFormat::AZTEC, L"ZXing benchmark 0123456789 https://github.com/nu-book/zxing-cpp");
+BENCHMARK_CAPTURE(BM_Encode, DataMatrix, BarcodeFormat::DATA_MATRIX, L"ZXing benchmark 0123456789 https://github.com/nu-book/zxing-cpp");
+BENCHMARK_CAPTURE(BM_Encode, PDF417, BarcodeFormat::PDF_417, L"ZXing benchmark 0123456789 https://github.com/nu-book/zxing-cpp");
+BENCHMARK_CAPTURE(BM_Encode, QRCode, BarcodeFormat::QR_CODE, L"ZXing benchmark 0123456789 https://github.com/nu-book/zxing-cpp");
+BENCHMARK_CAPTURE(BM_Encode, Code128, BarcodeFormat::CODE_128, L"ZXing-0123456789");
+BENCHMARK_CAPTURE(BM_Encode, EAN13, BarcodeFormat::EAN_13, L"5901234123457");
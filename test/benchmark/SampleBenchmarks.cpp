@@ -0,0 +1,182 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "AllocationCounter.h"
+#include "LumaCorpus.h"
+#include "ReadBarcode.h"
+#include "ZXFilesystem.h"
+
+#include <benchmark/benchmark.h>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#ifdef ZXING_HAS_LIBJPEG
+#include "JpegLuma.h"
+#endif
+
+#include <algorithm>
+#include <cstdlib>
+#include <exception>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace ZXing;
+
+// Macro benchmarks: every image of a test/samples directory decoded with the default hints (all formats, tryHarder),
+// like an application calling ReadBarcode would. Loading the images is not part of the measurement. The samples
+// directory can be overridden with the environment variable ZXING_SAMPLES. If ZXING_CORPUS names a LumaCorpus file
+// (see SamplesToCorpus), its frames are decoded in place by BM_Corpus.
+
+namespace {
+
+struct Image
+{
+	std::unique_ptr<stbi_uc, void (*)(void*)> pixels{nullptr, stbi_image_free};
+	std::vector<uint8_t> jpegLuma; // the JPEG files decoded by libjpeg, if available
+	int width = 0, height = 0, channels = 0;
+
+	ImageView view() const
+	{
+		const ImageFormat formats[] = {ImageFormat::None, ImageFormat::Lum, ImageFormat::None, ImageFormat::RGB, ImageFormat::RGBX};
+		return {pixels ? pixels.get() : jpegLuma.data(), width, height, formats[channels]};
+	}
+};
+
+std::vector<Image> LoadImages(const fs::path& dir)
+{
+	std::vector<fs::path> paths;
+	for (const auto& entry : fs::directory_iterator(dir)) {
+		auto ext = entry.path().extension().string();
+		std::transform(ext.begin(), ext.end(), ext.begin(), [](char c) { return static_cast<char>(std::tolower(c)); });
+		if (ext == ".png" || ext == ".jpg" || ext == ".jpeg" || ext == ".gif" || ext == ".pgm" || ext == ".bmp")
+			paths.push_back(entry.path());
+	}
+	std::sort(paths.begin(), paths.end());
+
+	std::vector<Image> images;
+	for (const auto& path : paths) {
+		Image img;
+#ifdef ZXING_HAS_LIBJPEG
+		auto ext = path.extension().string();
+		std::transform(ext.begin(), ext.end(), ext.begin(), [](char c) { return static_cast<char>(std::tolower(c)); });
+		bool isJpeg = ext == ".jpg" || ext == ".jpeg";
+		if (isJpeg && LoadJpegLuma(path.string().c_str(), 1, img.jpegLuma, img.width, img.height)) {
+			img.channels = 1;
+			images.push_back(std::move(img));
+			continue;
+		}
+#endif
+		int channels = 0;
+		if (!stbi_info(path.string().c_str(), &img.width, &img.height, &channels))
+			continue;
+		// gray + alpha is not an ImageFormat, drop the alpha
+		img.channels = channels == 2 ? 1 : channels;
+		img.pixels.reset(stbi_load(path.string().c_str(), &img.width, &img.height, &channels, img.channels));
+		if (img.pixels)
+			images.push_back(std::move(img));
+	}
+	return images;
+}
+
+void BM_Samples(benchmark::State& state, const std::vector<fs::path>& dirs)
+{
+	std::vector<Image> images;
+	for (const auto& dir : dirs)
+		for (auto& img : LoadImages(dir))
+			images.push_back(std::move(img));
+	if (images.empty()) {
+		state.SkipWithError("no images");
+		return;
+	}
+
+	int64_t pixels = 0;
+	for (const auto& img : images)
+		pixels += int64_t(img.width) * img.height;
+
+	DecodeHints hints;
+	int64_t found = 0;
+	auto allocs = Test::AllocationCount();
+	for (auto _ : state)
+		for (const auto& img : images)
+			found += ReadBarcode(img.view(), hints).isValid();
+
+	auto numImages = static_cast<double>(images.size());
+	state.SetItemsProcessed(state.iterations() * images.size());
+	state.counters["time/pixel"] = benchmark::Counter(static_cast<double>(pixels), benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+	state.counters["allocs/decode"] = benchmark::Counter((Test::AllocationCount() - allocs) / numImages, benchmark::Counter::kAvgIterations);
+	state.counters["found"] = benchmark::Counter(found / numImages, benchmark::Counter::kAvgIterations);
+}
+
+void BM_Corpus(benchmark::State& state, const std::string& path)
+{
+	std::unique_ptr<Test::LumaCorpus> corpus;
+	try {
+		corpus = std::make_unique<Test::LumaCorpus>(path);
+	} catch (const std::exception& e) {
+		state.SkipWithError(e.what());
+		return;
+	}
+
+	DecodeHints hints;
+	int64_t found = 0;
+	for (auto _ : state)
+		for (int i = 0; i < corpus->size(); ++i)
+			found += ReadBarcode((*corpus)[i].image, hints).isValid();
+
+	auto numImages = static_cast<double>(corpus->size());
+	state.SetItemsProcessed(state.iterations() * corpus->size());
+	state.counters["found"] = benchmark::Counter(found / numImages, benchmark::Counter::kAvgIterations);
+}
+
+int RegisterCorpusBenchmark()
+{
+	const char* env = std::getenv("ZXING_CORPUS");
+	if (!env)
+		return 0;
+	benchmark::RegisterBenchmark("BM_Corpus", BM_Corpus, std::string(env))->Unit(benchmark::kMillisecond);
+	return 1;
+}
+
+const int numCorpusBenchmarks = RegisterCorpusBenchmark();
+
+// registers one benchmark per samples directory plus one over all of them
+int RegisterSampleBenchmarks()
+{
+	const char* env = std::getenv("ZXING_SAMPLES");
+	fs::path samples = env ? env : ZXING_SAMPLES_DIR;
+	std::error_code ec;
+	if (!fs::is_directory(samples, ec))
+		return 0;
+
+	std::vector<fs::path> dirs;
+	for (const auto& entry : fs::directory_iterator(samples))
+		if (entry.is_directory())
+			dirs.push_back(entry.path());
+	std::sort(dirs.begin(), dirs.end());
+
+	for (const auto& dir : dirs)
+		benchmark::RegisterBenchmark(("BM_Samples/" + dir.filename().string()).c_str(), BM_Samples, std::vector<fs::path>{dir})
+			->Unit(benchmark::kMillisecond);
+	benchmark::RegisterBenchmark("BM_Samples/all", BM_Samples, dirs)->Unit(benchmark::kMillisecond)->Iterations(1);
+	return static_cast<int>(dirs.size());
+}
+
+const int numSampleBenchmarks = RegisterSampleBenchmarks();
+
+} // namespace
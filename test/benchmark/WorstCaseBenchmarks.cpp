@@ -0,0 +1,254 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "AllocationCounter.h"
+#include "DecodeStats.h"
+#include "ReadBarcode.h"
+#include "ZXFilesystem.h"
+
+#include <benchmark/benchmark.h>
+#include <stb_image.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace ZXing;
+
+// Worst case benchmarks: synthetic inputs that drive a detector into its most expensive paths, the ones that caused
+// stalls in production. Each one has a ceiling for the time and the number of allocations per decode, recorded with
+// a generous margin on a desktop CPU. A benchmark that exceeds its ceiling is reported as an error, so a change that
+// breaks one of the complexity bounds (e.g. the candidate limit of the QR Code finder or the row limit and the dead
+// end memo of the DataBar Expanded row search) shows up in every run of ZXingBenchmark, not only as a slower number.
+
+namespace {
+
+struct Ceiling
+{
+	double millis;
+	double allocs;
+};
+
+struct LumImage
+{
+	int width = 0, height = 0;
+	std::vector<uint8_t> pixels;
+
+	LumImage(int width, int height, uint8_t value = 255)
+		: width(width), height(height), pixels(width * height, value)
+	{}
+	uint8_t& operator()(int x, int y) { return pixels[y * width + x]; }
+	ImageView view() const { return {pixels.data(), width, height, ImageFormat::Lum}; }
+};
+
+void RunWorstCase(benchmark::State& state, const LumImage& img, const DecodeHints& hints, const Ceiling& ceiling)
+{
+	// one scanner for all iterations, like a long-lived application would use
+	BarcodeScanner scanner(DecodeHints(hints).setStats(nullptr));
+	DecodeStats stats;
+	BarcodeScanner statsScanner(DecodeHints(hints).setStats(&stats));
+	statsScanner.readMultiple(img.view());
+
+	auto allocs = Test::AllocationCount();
+	auto start = std::chrono::steady_clock::now();
+	int64_t found = 0;
+	for (auto _ : state)
+		found += scanner.readMultiple(img.view()).size();
+	auto millis = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	auto n = static_cast<double>(state.iterations());
+	double allocsPerDecode = (Test::AllocationCount() - allocs) / n;
+	state.counters["allocs"] = allocsPerDecode;
+	state.counters["found"] = found / n;
+	state.counters["rows"] = static_cast<double>(stats.rowsScanned());
+	state.counters["finderCandidates"] = static_cast<double>(stats.finderCandidates());
+
+	char error[128] = {};
+	if (millis / n > ceiling.millis)
+		std::snprintf(error, sizeof(error), "%.1f ms per decode, ceiling %.0f ms", millis / n, ceiling.millis);
+	else if (allocsPerDecode > ceiling.allocs)
+		std::snprintf(error, sizeof(error), "%.0f allocations per decode, ceiling %.0f", allocsPerDecode,
+					  ceiling.allocs);
+	if (error[0])
+		state.SkipWithError(error);
+}
+
+/// A grid of complete finder patterns with 1 pixel modules, every one of them a confirmed QR Code candidate
+LumImage FinderPatternGrid(int width, int height, int pitch)
+{
+	LumImage img(width, height);
+	for (int top = 1; top + 7 < height; top += pitch)
+		for (int left = 1; left + 7 < width; left += pitch)
+			for (int y = 0; y < 7; ++y)
+				for (int x = 0; x < 7; ++x)
+					if (x == 0 || y == 0 || x == 6 || y == 6 || (x >= 2 && x <= 4 && y >= 2 && y <= 4))
+						img(left + x, top + y) = 0;
+	return img;
+}
+
+/// Uniformly distributed gray values, the high frequency noise of a sensor in the dark
+LumImage Noise(int width, int height)
+{
+	LumImage img(width, height);
+	std::mt19937 random(42);
+	for (auto& p : img.pixels)
+		p = static_cast<uint8_t>(random());
+	return img;
+}
+
+/// Squares of 'size' pixels, every row is a sequence of equal runs
+LumImage Checkerboard(int width, int height, int size)
+{
+	LumImage img(width, height);
+	for (int y = 0; y < height; ++y)
+		for (int x = 0; x < width; ++x)
+			img(x, y) = (x / size + y / size) % 2 ? 0 : 255;
+	return img;
+}
+
+/// PDF417 start patterns (8:1:1:1:1:1:1:3) repeated over the whole image, each row matches the guard many times
+LumImage StartPatternWallpaper(int width, int height, int moduleSize)
+{
+	const int pattern[] = {8, 1, 1, 1, 1, 1, 1, 3, 2};
+	LumImage img(width, height);
+	for (int y = 0; y < height; ++y)
+		for (int x = 0, i = 0; x < width; ++i) {
+			int run = pattern[i % 9] * moduleSize;
+			for (int end = std::min(width, x + run); x < end; ++x)
+				img(x, y) = i % 2 ? 255 : 0;
+		}
+	return img;
+}
+
+/**
+* The first row of a stacked DataBar Expanded sample followed by the other rows of many different ones. Each of them
+* continues the first one as far as the finder sequence is concerned, but the checksum never matches, so the row
+* search has to try the combinations up to its row limit.
+*/
+LumImage StackedExpandedRows(const fs::path& dir)
+{
+	std::vector<std::vector<uint8_t>> bands;
+	int width = 0, bandHeight = 0;
+	std::vector<fs::path> paths;
+	for (const auto& entry : fs::directory_iterator(dir))
+		if (entry.path().extension() == ".png")
+			paths.push_back(entry.path());
+	std::sort(paths.begin(), paths.end());
+
+	for (const auto& path : paths) {
+		int w, h, channels;
+		std::unique_ptr<stbi_uc, void (*)(void*)> pixels(stbi_load(path.string().c_str(), &w, &h, &channels, 1),
+														 stbi_image_free);
+		// only the two row symbols, taking 45% of the height keeps the separator pattern out
+		if (!pixels || h < 100 || h > 160)
+			continue;
+		int band = h * 45 / 100;
+		auto add = [&](int top) {
+			std::vector<uint8_t> b(w * band);
+			std::copy_n(pixels.get() + top * w, w * band, b.data());
+			bands.push_back(std::move(b));
+			width = std::max(width, w);
+			bandHeight = band;
+		};
+		// the first sample only contributes its first row, it would be complete with its own second one
+		add(bands.empty() ? 0 : h - band);
+		if (bands.size() == 40)
+			break;
+	}
+
+	LumImage img(width, bandHeight * static_cast<int>(bands.size()));
+	for (size_t i = 0; i < bands.size(); ++i) {
+		int w = static_cast<int>(bands[i].size()) / bandHeight;
+		for (int y = 0; y < bandHeight; ++y)
+			std::copy_n(bands[i].data() + y * w, w, &img(0, static_cast<int>(i) * bandHeight + y));
+	}
+	return img;
+}
+
+const auto tryHarder = DecodeHints().setTryHarder(true).setTryRotate(true);
+
+void BM_WorstCase_QRFinderGrid(benchmark::State& state)
+{
+	static const auto img = FinderPatternGrid(1280, 960, 9);
+	RunWorstCase(state, img, DecodeHints(tryHarder).setFormats(BarcodeFormat::QR_CODE), {3000, 1e5});
+}
+
+void BM_WorstCase_Noise(benchmark::State& state)
+{
+	static const auto img = Noise(1280, 960);
+	RunWorstCase(state, img, tryHarder, {1500, 2.5e5});
+}
+
+void BM_WorstCase_PDF417Checkerboard(benchmark::State& state)
+{
+	static const auto img = Checkerboard(1280, 960, 2);
+	RunWorstCase(state, img, DecodeHints(tryHarder).setFormats(BarcodeFormat::PDF_417), {100, 1e5});
+}
+
+void BM_WorstCase_PDF417StartPatterns(benchmark::State& state)
+{
+	static const auto img = StartPatternWallpaper(1280, 960, 2);
+	RunWorstCase(state, img, DecodeHints(tryHarder).setFormats(BarcodeFormat::PDF_417), {200, 1e5});
+}
+
+void BM_WorstCase_UniformLinear(benchmark::State& state)
+{
+	// a huge empty image, every row of it is scanned with tryHarder
+	static const LumImage img(4000, 3000, 200);
+	auto linear = BarcodeFormat::CODABAR | BarcodeFormat::CODE_39 | BarcodeFormat::CODE_93 | BarcodeFormat::CODE_128 |
+				  BarcodeFormat::EAN_8 | BarcodeFormat::EAN_13 | BarcodeFormat::ITF | BarcodeFormat::RSS_14 |
+				  BarcodeFormat::RSS_EXPANDED | BarcodeFormat::UPC_A | BarcodeFormat::UPC_E;
+	RunWorstCase(state, img, DecodeHints(tryHarder).setFormats(linear), {100, 1e4});
+}
+
+void BM_WorstCase_StackedExpandedRows(benchmark::State& state, const fs::path& dir)
+{
+	auto img = StackedExpandedRows(dir);
+	if (img.pixels.empty()) {
+		state.SkipWithError("no samples");
+		return;
+	}
+	RunWorstCase(state, img, DecodeHints(tryHarder).setFormats(BarcodeFormat::RSS_EXPANDED), {100, 2e4});
+}
+
+int RegisterWorstCaseBenchmarks()
+{
+	benchmark::RegisterBenchmark("BM_WorstCase/QRFinderGrid", BM_WorstCase_QRFinderGrid)->Unit(benchmark::kMillisecond);
+	benchmark::RegisterBenchmark("BM_WorstCase/Noise", BM_WorstCase_Noise)->Unit(benchmark::kMillisecond);
+	benchmark::RegisterBenchmark("BM_WorstCase/PDF417Checkerboard", BM_WorstCase_PDF417Checkerboard)
+		->Unit(benchmark::kMillisecond);
+	benchmark::RegisterBenchmark("BM_WorstCase/PDF417StartPatterns", BM_WorstCase_PDF417StartPatterns)
+		->Unit(benchmark::kMillisecond);
+	benchmark::RegisterBenchmark("BM_WorstCase/UniformLinear", BM_WorstCase_UniformLinear)
+		->Unit(benchmark::kMillisecond);
+
+	const char* env = std::getenv("ZXING_SAMPLES");
+	fs::path samples = env ? env : ZXING_SAMPLES_DIR;
+	benchmark::RegisterBenchmark("BM_WorstCase/StackedExpandedRows", BM_WorstCase_StackedExpandedRows,
+								 samples / "rssexpandedstacked-1")
+		->Unit(benchmark::kMillisecond);
+	return 6;
+}
+
+const int numWorstCaseBenchmarks = RegisterWorstCaseBenchmarks();
+
+} // namespace
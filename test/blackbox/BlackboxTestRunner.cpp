@@ -16,6 +16,7 @@
 */
 
 #include "BlackboxTestRunner.h"
+#include "AllocationCounter.h"
 #include "TextDecoder.h"
 #include "TextUtfEncoding.h"
 #include "DecodeHints.h"
@@ -24,17 +25,22 @@
 #include "ImageLoader.h"
 #include "BinaryBitmap.h"
 #include "Pdf417MultipleCodeReader.h"
+#include "Parallel.h"
 #include "QRCodeStructuredAppendReader.h"
 #include "ZXContainerAlgorithms.h"
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <exception>
 #include <iostream>
 #include <fstream>
 #include <map>
+#include <mutex>
 #include <optional>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace ZXing::Test {
@@ -107,7 +113,7 @@ static std::string checkResult(const fs::path& imgPath, const char* expectedForm
 	}
 
 	if (auto expected = readFile(".txt")) {
-		auto utf8Result = TextUtfEncoding::ToUtf8(result.text());
+		auto utf8Result = result.utf8();
 		return utf8Result != *expected ? "Content mismatch: expected '" + *expected + "' but got '" + utf8Result + "'" : "";
 	}
 
@@ -120,6 +126,40 @@ static std::string checkResult(const fs::path& imgPath, const char* expectedForm
 }
 
 static int failed = 0;
+static int numThreads = 1;
+
+using Clock = std::chrono::steady_clock;
+
+struct PerfStats
+{
+	size_t images = 0;
+	Clock::duration wallTime = {};
+	std::vector<Clock::duration> latencies; // of the single decode calls
+	uint64_t allocations = 0;
+};
+
+// per format and mode ("fast", "slow" or "pure"), over all directories and rotations
+static std::map<std::pair<std::string, std::string>, PerfStats> perfStats;
+
+static double ToMs(Clock::duration d)
+{
+	return std::chrono::duration<double, std::milli>(d).count();
+}
+
+static void printPerfStats()
+{
+	std::cout << "Performance (" << numThreads << " thread" << (numThreads > 1 ? "s" : "") << "):\n";
+	for (auto& [key, stats] : perfStats) {
+		auto& lat = stats.latencies;
+		if (lat.empty())
+			continue;
+		std::sort(lat.begin(), lat.end());
+		auto percentile = [&lat](double p) { return ToMs(lat[std::min(lat.size() - 1, size_t(p * lat.size()))]); };
+		printf("%-20s %s: %4d images, %7.1f images/s, p50: %6.2f ms, p99: %6.2f ms, allocs/decode: %6.0f\n",
+			   key.first.c_str(), key.second.c_str(), (int)stats.images, stats.images / (ToMs(stats.wallTime) / 1000),
+			   percentile(0.5), percentile(0.99), double(stats.allocations) / stats.images);
+	}
+}
 
 static void printPositiveTestStats(size_t imageCount, const TestCase::TC& tc)
 {
@@ -158,7 +198,7 @@ static std::vector<fs::path> getImagesInDirectory(const fs::path& directory)
 static void doRunTests(
 	const fs::path& directory, const char* format, size_t totalTests, const std::vector<TestCase>& tests, DecodeHints hints)
 {
-	ImageLoader::cache.clear();
+	ImageLoader::clearCache();
 
 	auto images = getImagesInDirectory(directory);
 	auto folderName = directory.stem();
@@ -167,6 +207,13 @@ static void doRunTests(
 		std::cout << "TEST " << folderName << " => Expected number of tests: " << totalTests
 			 << ", got: " << images.size() << " => FAILED!" << std::endl;
 
+	// read all images up front, so the reported decode throughput does not include the image loading
+	std::atomic<size_t> next = 0;
+	ParallelFor(std::min(numThreads, Size(images)), [&](int) {
+		for (size_t i; (i = next++) < images.size();)
+			ImageLoader::load(images[i]);
+	});
+
 	for (auto& test : tests) {
 		auto startTime = std::chrono::steady_clock::now();
 		printf("%-20s @ %3d, total: %3d", folderName.string().c_str(), test.rotation, (int)images.size());
@@ -176,17 +223,34 @@ static void doRunTests(
 			hints.setTryHarder(tc.name == "slow");
 			hints.setTryRotate(tc.name == "slow");
 			hints.setIsPure(tc.name == "pure");
-			MultiFormatReader reader(hints);
-			for (const auto& imgPath : images) {
-				auto result = reader.read(*ImageLoader::load(imgPath).rotated(test.rotation));
-				if (result.isValid()) {
-					auto error = checkResult(imgPath, format, result);
-					if (!error.empty())
+			auto& perf = perfStats[{format, tc.name}];
+			auto tcStartTime = Clock::now();
+			next = 0;
+			std::mutex mutex;
+			// the images are shared out one by one, the results don't depend on the number of threads
+			ParallelFor(std::min(numThreads, Size(images)), [&](int) {
+				MultiFormatReader reader(hints);
+				for (size_t i; (i = next++) < images.size();) {
+					const auto& imgPath = images[i];
+					const auto& image = ImageLoader::load(imgPath, test.rotation);
+					auto allocations = AllocationCount();
+					auto decodeStartTime = Clock::now();
+					auto result = reader.read(image);
+					auto latency = Clock::now() - decodeStartTime;
+					allocations = AllocationCount() - allocations;
+					auto error = result.isValid() ? checkResult(imgPath, format, result) : std::string();
+
+					std::lock_guard<std::mutex> lock(mutex);
+					perf.latencies.push_back(latency);
+					perf.allocations += allocations;
+					if (!result.isValid())
+						tc.notDetectedFiles.insert(imgPath);
+					else if (!error.empty())
 						tc.misReadFiles[imgPath] = error;
-				} else {
-					tc.notDetectedFiles.insert(imgPath);
 				}
-			}
+			});
+			perf.images += images.size();
+			perf.wallTime += Clock::now() - tcStartTime;
 
 			printPositiveTestStats(images.size(), tc);
 		}
@@ -238,8 +302,10 @@ static void doRunStructuredAppendTest(
 	}
 }
 
-int runBlackBoxTests(const fs::path& testPathPrefix, const std::set<std::string>& includedTests)
+int runBlackBoxTests(const fs::path& testPathPrefix, const std::set<std::string>& includedTests, int threads)
 {
+	numThreads = std::max(1, threads);
+
 	auto hasTest = [&includedTests](const fs::path& dir) {
 		auto stem = dir.stem().string();
 		return includedTests.empty() || Contains(includedTests, stem) ||
@@ -272,6 +338,7 @@ int runBlackBoxTests(const fs::path& testPathPrefix, const std::set<std::string>
 			{ 13, 13, 90  },
 			{ 13, 13, 180 },
 			{ 13, 13, 270 },
+			{ 13, 0, pure },
 		});
 
 		runTests("aztec-2", "AZTEC", 22, {
@@ -396,8 +463,11 @@ int runBlackBoxTests(const fs::path& testPathPrefix, const std::set<std::string>
 			{ 13, 13, 180 },
 		});
 
-		runTests("maxicode-1", "MAXICODE", 6, {
-			{ 1, 1, 5, 5, 0 },
+		runTests("maxicode-1", "MAXICODE", 7, {
+			{ 2, 2, 5, 5, 0   },
+			{ 2, 2, 5, 5, 90  },
+			{ 2, 2, 5, 5, 180 },
+			{ 2, 2, 5, 5, 270 },
 		});
 
 		runTests("upca-1", "UPC_A", 15, {
@@ -536,6 +606,7 @@ int runBlackBoxTests(const fs::path& testPathPrefix, const std::set<std::string>
 		runTests("pdf417-1", "PDF_417", 10, {
 			{ 10, 10, 0   },
 			{ 10, 10, 180 },
+			{ 10, 0, pure },
 		});
 
 		runTests("pdf417-2", "PDF_417", 25, {
@@ -569,6 +640,7 @@ int runBlackBoxTests(const fs::path& testPathPrefix, const std::set<std::string>
 
 		auto duration = std::chrono::steady_clock::now() - startTime;
 		std::cout << "Total time: " << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() << " ms." << std::endl;
+		printPerfStats();
 		if (failed)
 			std::cout << "WARNING: " << failed << " tests failed." << std::endl;
 
@@ -28,6 +28,11 @@ namespace Test {
 
 std::string metadataToUtf8(const Result& result);
 
-int runBlackBoxTests(const fs::path& blackboxPath, const std::set<std::string>& includedTests);
+/**
+* Runs the tests of the sample directories under blackboxPath (all or the included ones). The images of each test are
+* decoded by the given number of threads. Besides the pass counts, the images/s, the p50/p99 decode latency and the
+* allocations per decode of every format and mode are reported.
+*/
+int runBlackBoxTests(const fs::path& blackboxPath, const std::set<std::string>& includedTests, int threads = 1);
 
 }} // ZXing::Test
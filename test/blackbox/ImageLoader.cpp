@@ -35,7 +35,8 @@ using Binarizer = ZXing::HybridBinarizer;
 
 namespace ZXing::Test {
 
-std::map<fs::path, std::unique_ptr<BinaryBitmap>> ImageLoader::cache;
+std::mutex ImageLoader::mutex;
+std::map<std::pair<fs::path, int>, ImageLoader::Entry> ImageLoader::cache;
 
 static std::shared_ptr<GenericLuminanceSource> readImage(const fs::path& imgPath)
 {
@@ -54,12 +55,37 @@ static std::shared_ptr<GenericLuminanceSource> readImage(const fs::path& imgPath
 	return {}; // silence warning
 }
 
-const BinaryBitmap& ImageLoader::load(const fs::path& imgPath)
+const BinaryBitmap& ImageLoader::load(const fs::path& imgPath, int rotation)
 {
-	auto& binImg = cache[imgPath];
-	if (binImg == nullptr)
-		binImg = std::make_unique<Binarizer>(readImage(imgPath));
-	return *binImg;
+	rotation = (rotation % 360 + 360) % 360;
+	Entry* entry;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		entry = &cache[{imgPath, rotation}]; // map nodes are stable, the image is read outside of the lock
+	}
+	std::call_once(entry->once, [&] {
+		if (rotation == 0) {
+			entry->luminance = readImage(imgPath);
+		}
+		else {
+			load(imgPath, 0);
+			std::lock_guard<std::mutex> lock(mutex);
+			entry->luminance = cache[{imgPath, 0}].luminance->rotated(rotation);
+		}
+		entry->image = std::make_unique<Binarizer>(entry->luminance);
+	});
+	return *entry->image;
+}
+
+std::shared_ptr<LuminanceSource> ImageLoader::readLuminance(const fs::path& imgPath)
+{
+	return readImage(imgPath);
+}
+
+void ImageLoader::clearCache()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	cache.clear();
 }
 
 }
@@ -19,19 +19,47 @@
 
 #include <memory>
 #include <map>
+#include <mutex>
+#include <utility>
 
 namespace ZXing {
 
 class BinaryBitmap;
+class LuminanceSource;
 
 namespace Test {
 
+/**
+* Loads the images of the tests and caches them until clearCache(). load() may be called concurrently, every image
+* is only read once.
+*/
 class ImageLoader
 {
+	struct Entry
+	{
+		std::once_flag once;
+		std::shared_ptr<const LuminanceSource> luminance;
+		std::unique_ptr<BinaryBitmap> image;
+	};
+
+	static std::mutex mutex;
+	static std::map<std::pair<fs::path, int>, Entry> cache;
+
 public:
-	static std::map<fs::path, std::unique_ptr<BinaryBitmap>> cache;
+	static const BinaryBitmap& load(const fs::path& imgPath) { return load(imgPath, 0); }
+
+	/**
+	* The image rotated by 'rotation' degrees clockwise, binarized after the rotation like a rotated capture would be.
+	* BinaryBitmap::rotated() instead rotates the already binarized image, which is not the same for the local
+	* thresholding of the HybridBinarizer.
+	*/
+	static const BinaryBitmap& load(const fs::path& imgPath, int rotation);
+
+	/// Reads an image without caching or binarizing it, throws std::runtime_error if it can't be read
+	static std::shared_ptr<LuminanceSource> readLuminance(const fs::path& imgPath);
 
-	static const BinaryBitmap& load(const fs::path& imgPath);
+	/// Must not be called while another thread is loading or uses a loaded image
+	static void clearCache();
 };
 
 
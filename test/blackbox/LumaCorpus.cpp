@@ -0,0 +1,190 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "LumaCorpus.h"
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ZXing::Test {
+
+namespace {
+
+constexpr char MAGIC[4] = {'Z', 'X', 'L', 'C'};
+constexpr uint32_t VERSION = 1;
+constexpr uint64_t PIXEL_ALIGNMENT = 64;
+
+struct Header
+{
+	char magic[4];
+	uint32_t version;
+	uint32_t count;
+	uint32_t indexOffset;
+};
+
+struct IndexEntry
+{
+	uint64_t pixelOffset;
+	uint32_t width, height;
+	uint32_t nameOffset, nameSize;
+	uint32_t textOffset, textSize;
+};
+
+static_assert(sizeof(Header) == 16 && sizeof(IndexEntry) == 32, "the structs are the file layout");
+
+} // anonymous
+
+void LumaCorpus::Write(const fs::path& path, const std::vector<Source>& frames)
+{
+	std::vector<IndexEntry> index(frames.size());
+	std::string strings;
+	uint64_t stringsOffset = sizeof(Header) + index.size() * sizeof(IndexEntry);
+	for (size_t i = 0; i < frames.size(); ++i) {
+		const auto& f = frames[i];
+		if (f.pixels.size() != size_t(f.width) * f.height)
+			throw std::runtime_error("Frame size does not match its pixels: " + f.name);
+		index[i] = {0, uint32_t(f.width), uint32_t(f.height), uint32_t(stringsOffset + strings.size()),
+					uint32_t(f.name.size()), uint32_t(stringsOffset + strings.size() + f.name.size()),
+					uint32_t(f.text.size())};
+		strings += f.name + f.text;
+	}
+	uint64_t pixelOffset = stringsOffset + strings.size();
+	for (auto& entry : index) {
+		pixelOffset = (pixelOffset + PIXEL_ALIGNMENT - 1) / PIXEL_ALIGNMENT * PIXEL_ALIGNMENT;
+		entry.pixelOffset = pixelOffset;
+		pixelOffset += uint64_t(entry.width) * entry.height;
+	}
+	if (stringsOffset + strings.size() > UINT32_MAX)
+		throw std::runtime_error("Too many frames");
+
+	std::ofstream out(path, std::ios::binary);
+	Header header = {{MAGIC[0], MAGIC[1], MAGIC[2], MAGIC[3]}, VERSION, uint32_t(frames.size()), sizeof(Header)};
+	out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	out.write(reinterpret_cast<const char*>(index.data()), index.size() * sizeof(IndexEntry));
+	out.write(strings.data(), strings.size());
+	uint64_t pos = stringsOffset + strings.size();
+	for (size_t i = 0; i < frames.size(); ++i) {
+		const char padding[PIXEL_ALIGNMENT] = {};
+		out.write(padding, index[i].pixelOffset - pos);
+		out.write(reinterpret_cast<const char*>(frames[i].pixels.data()), frames[i].pixels.size());
+		pos = index[i].pixelOffset + frames[i].pixels.size();
+	}
+	if (!out)
+		throw std::runtime_error("Failed to write " + path.string());
+}
+
+LumaCorpus::LumaCorpus(const fs::path& path)
+{
+#ifdef _WIN32
+	_file = CreateFileW(path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+						FILE_ATTRIBUTE_NORMAL, nullptr);
+	LARGE_INTEGER size;
+	if (_file != INVALID_HANDLE_VALUE && GetFileSizeEx(_file, &size) && size.QuadPart > 0) {
+		_mapping = CreateFileMappingW(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (_mapping) {
+			_data = static_cast<const uint8_t*>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+			_size = size_t(size.QuadPart);
+		}
+	}
+#else
+	int fd = open(path.c_str(), O_RDONLY);
+	struct stat st;
+	if (fd >= 0 && fstat(fd, &st) == 0 && st.st_size > 0) {
+		void* data = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+		if (data != MAP_FAILED) {
+			_data = static_cast<const uint8_t*>(data);
+			_size = size_t(st.st_size);
+		}
+	}
+	if (fd >= 0)
+		close(fd); // the mapping stays valid
+#endif
+	if (!_data) {
+		unmap();
+		throw std::runtime_error("Failed to map " + path.string());
+	}
+
+	// check everything up front, so operator[] can't read outside of the mapping
+	Header header = {};
+	bool valid = _size >= sizeof(header);
+	if (valid) {
+		std::memcpy(&header, _data, sizeof(header));
+		valid = std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 && header.version == VERSION &&
+				header.indexOffset + uint64_t(header.count) * sizeof(IndexEntry) <= _size;
+	}
+	for (uint32_t i = 0; valid && i < header.count; ++i) {
+		IndexEntry e;
+		std::memcpy(&e, _data + header.indexOffset + i * sizeof(IndexEntry), sizeof(e));
+		valid = e.pixelOffset + uint64_t(e.width) * e.height <= _size && e.width <= INT32_MAX &&
+				e.height <= INT32_MAX && uint64_t(e.nameOffset) + e.nameSize <= _size &&
+				uint64_t(e.textOffset) + e.textSize <= _size;
+	}
+	if (!valid) {
+		unmap();
+		throw std::runtime_error("Not a valid corpus: " + path.string());
+	}
+	_count = int(header.count);
+}
+
+LumaCorpus::~LumaCorpus()
+{
+	unmap();
+}
+
+void LumaCorpus::unmap()
+{
+#ifdef _WIN32
+	if (_data)
+		UnmapViewOfFile(_data);
+	if (_mapping)
+		CloseHandle(_mapping);
+	if (_file && _file != INVALID_HANDLE_VALUE)
+		CloseHandle(_file);
+	_mapping = _file = nullptr;
+#else
+	if (_data)
+		munmap(const_cast<uint8_t*>(_data), _size);
+#endif
+	_data = nullptr;
+	_size = 0;
+}
+
+LumaCorpus::Frame LumaCorpus::operator[](int i) const
+{
+	Header header;
+	std::memcpy(&header, _data, sizeof(header));
+	IndexEntry e;
+	std::memcpy(&e, _data + header.indexOffset + i * sizeof(IndexEntry), sizeof(e));
+	auto chars = reinterpret_cast<const char*>(_data);
+	return {{chars + e.nameOffset, e.nameSize},
+			{chars + e.textOffset, e.textSize},
+			{_data + e.pixelOffset, int(e.width), int(e.height), ImageFormat::Lum}};
+}
+
+} // ZXing::Test
@@ -0,0 +1,80 @@
+#pragma once
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "ReadBarcode.h"
+#include "ZXFilesystem.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ZXing::Test {
+
+/**
+* A file of already decoded 8 bit gray scale images plus the expected text of each, which is memory mapped so that
+* the images can be passed to ReadBarcode as ImageViews without loading, decoding or copying them.
+*
+* Layout, little endian: a 16 byte header ("ZXLC", version, frame count, offset of the index), the index with one
+* 32 byte entry per frame (64 bit offset of the pixels, width, height, offset and size of the name, offset and size of
+* the expected text) and then the names, texts and pixels. The pixels of every frame start at a multiple of 64 bytes
+* and have no row padding.
+*/
+class LumaCorpus
+{
+public:
+	struct Frame
+	{
+		std::string_view name;
+		std::string_view text; ///< expected UTF-8 text, empty if unknown
+		ImageView image;
+	};
+
+	struct Source
+	{
+		std::string name, text;
+		int width = 0, height = 0;
+		std::vector<uint8_t> pixels;
+	};
+
+	/// Throws std::runtime_error if the file can't be written
+	static void Write(const fs::path& path, const std::vector<Source>& frames);
+
+	/// Maps the file, throws std::runtime_error if it can't be mapped or is not a valid corpus
+	explicit LumaCorpus(const fs::path& path);
+	~LumaCorpus();
+
+	LumaCorpus(const LumaCorpus&) = delete;
+	LumaCorpus& operator=(const LumaCorpus&) = delete;
+
+	int size() const { return _count; }
+	Frame operator[](int i) const;
+
+private:
+	const uint8_t* _data = nullptr;
+	size_t _size = 0;
+	int _count = 0;
+#ifdef _WIN32
+	void* _file = nullptr;
+	void* _mapping = nullptr;
+#endif
+
+	void unmap();
+};
+
+} // ZXing::Test
@@ -18,37 +18,26 @@
 #include "BinaryBitmap.h"
 #include "TextUtfEncoding.h"
 #include "pdf417/PDFReader.h"
-#include "pdf417/PDFDecoderResultExtra.h"
+#include "pdf417/PDFMacroAssembler.h"
 #include "ImageLoader.h"
 
-#include <list>
-#include <utility>
+#include <limits>
 
 namespace ZXing::Test {
 
 Result Pdf417MultipleCodeReader::readMultiple(const std::vector<fs::path>& imgPaths, int rotation)
 {
 	Pdf417::Reader reader;
-	std::list<Result> allResults;
+	Pdf417::MacroAssembler assembler(1);
 	for (const auto& imgPath : imgPaths) {
-		auto results = reader.decodeMultiple(*ImageLoader::load(imgPath).rotated(rotation));
-		allResults.insert(allResults.end(), results.begin(), results.end());
+		for (const auto& r : reader.decode(ImageLoader::load(imgPath, rotation), std::numeric_limits<int>::max())) {
+			auto combined = assembler.add(r);
+			if (combined.isValid())
+				return combined;
+		}
 	}
 
-	if (allResults.empty())
-		return Result(DecodeStatus::NotFound);
-
-	allResults.sort([](const Result &r1, const Result &r2) {
-		auto m1 = std::dynamic_pointer_cast<Pdf417::DecoderResultExtra>(r1.metadata().getCustomData(ResultMetadata::PDF417_EXTRA_METADATA));
-		auto m2 = std::dynamic_pointer_cast<Pdf417::DecoderResultExtra>(r2.metadata().getCustomData(ResultMetadata::PDF417_EXTRA_METADATA));
-		return m1->segmentIndex() < m2->segmentIndex();
-	});
-
-	std::wstring text;
-	for (const auto& r : allResults)
-		text.append(r.text());
-
-	return {std::move(text), {}, BarcodeFormat::PDF_417};
+	return Result(imgPaths.empty() ? DecodeStatus::NotFound : DecodeStatus::FormatError);
 }
 
 } // ZXing::Test
@@ -20,44 +20,25 @@
 #include "Result.h"
 #include "DecodeHints.h"
 #include "qrcode/QRReader.h"
+#include "qrcode/QRStructuredAppend.h"
 #include "ImageLoader.h"
 
-#include <list>
-#include <string>
-#include <utility>
-
 namespace ZXing::Test {
 
 Result QRCodeStructuredAppendReader::readMultiple(const std::vector<fs::path>& imgPaths, int rotation)
 {
 	QRCode::Reader reader({});
-	std::list<Result> allResults;
-	int prevParity = -1;
+	QRCode::StructuredAppendAssembler assembler(1);
 	for (const auto& imgPath : imgPaths) {
-		auto r = reader.decode(*ImageLoader::load(imgPath).rotated(rotation));
+		auto r = reader.decode(ImageLoader::load(imgPath, rotation));
 		if (r.metadata().getInt(ResultMetadata::STRUCTURED_APPEND_CODE_COUNT, 0) != Size(imgPaths))
 			return Result(DecodeStatus::FormatError);
-		auto parity = r.metadata().getInt(ResultMetadata::STRUCTURED_APPEND_PARITY, -1);
-		if (prevParity != -1 && prevParity != parity)
-			return Result(DecodeStatus::FormatError);
-		prevParity = parity;
-		allResults.push_back(r);
+		auto combined = assembler.add(r);
+		if (combined.isValid())
+			return combined;
 	}
 
-	if (allResults.empty())
-		return Result(DecodeStatus::NotFound);
-
-	allResults.sort([](const Result &r1, const Result &r2) {
-		auto s1 = r1.metadata().getInt(ResultMetadata::STRUCTURED_APPEND_SEQUENCE, -1);
-		auto s2 = r2.metadata().getInt(ResultMetadata::STRUCTURED_APPEND_SEQUENCE, -1);
-		return s1 < s2;
-	});
-
-	std::wstring text;
-	for (const auto& r : allResults)
-		text.append(r.text());
-
-	return {std::move(text), {}, BarcodeFormat::QR_CODE};
+	return Result(imgPaths.empty() ? DecodeStatus::NotFound : DecodeStatus::FormatError);
 }
 
 } // ZXing::Test
@@ -0,0 +1,77 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "ByteArray.h"
+#include "ImageLoader.h"
+#include "LuminanceSource.h"
+#include "LumaCorpus.h"
+#include "ZXContainerAlgorithms.h"
+#include "ZXFilesystem.h"
+
+#include <algorithm>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+using namespace ZXing;
+using namespace ZXing::Test;
+
+// Converts the images below a directory, e.g. test/samples, into a LumaCorpus. The gray values are the ones the
+// blackbox tests decode and the expected text of an image is taken from the .txt file next to it.
+int main(int argc, char** argv)
+{
+	if (argc != 3) {
+		std::cout << "Usage: " << argv[0] << " <samples directory> <corpus file>" << std::endl;
+		return argc == 1 ? 0 : -1;
+	}
+
+	fs::path samples = argv[1];
+	std::vector<fs::path> paths;
+	for (const auto& entry : fs::recursive_directory_iterator(samples))
+		if (fs::is_regular_file(entry.status()) && Contains({".png", ".jpg", ".pgm", ".gif"}, entry.path().extension()))
+			paths.push_back(entry.path());
+	std::sort(paths.begin(), paths.end());
+
+	try {
+		std::vector<LumaCorpus::Source> frames;
+		for (const auto& path : paths) {
+			auto luminance = ImageLoader::readLuminance(path);
+			LumaCorpus::Source frame;
+			frame.name = fs::relative(path, samples).generic_string();
+			frame.width = luminance->width();
+			frame.height = luminance->height();
+			frame.pixels.reserve(size_t(frame.width) * frame.height);
+			ByteArray buffer;
+			for (int y = 0; y < frame.height; ++y) {
+				auto row = luminance->getRow(y, buffer);
+				frame.pixels.insert(frame.pixels.end(), row, row + frame.width);
+			}
+			std::ifstream text(fs::path(path).replace_extension(".txt"), std::ios::binary);
+			if (text)
+				frame.text.assign(std::istreambuf_iterator<char>(text), std::istreambuf_iterator<char>());
+			frames.push_back(std::move(frame));
+		}
+		LumaCorpus::Write(argv[2], frames);
+		std::cout << "Wrote " << frames.size() << " images to " << argv[2] << std::endl;
+	} catch (const std::exception& e) {
+		std::cerr << e.what() << std::endl;
+		return -1;
+	}
+	return 0;
+}
@@ -18,20 +18,23 @@
 #include "ByteArray.h"
 #include "BlackboxTestRunner.h"
 #include "ImageLoader.h"
+#include "LumaCorpus.h"
 #include "MultiFormatReader.h"
 #include "Result.h"
 #include "BinaryBitmap.h"
 #include "ImageLoader.h"
 #include "DecodeHints.h"
-#include "TextUtfEncoding.h"
 #include "ZXContainerAlgorithms.h"
 #include "ZXFilesystem.h"
 
+#include <chrono>
 #include <cstdlib>
 #include <cstring>
+#include <exception>
 #include <iostream>
 #include <fstream>
 #include <set>
+#include <thread>
 
 using namespace ZXing;
 using namespace ZXing::Test;
@@ -42,16 +45,53 @@ int getEnv(const char* name, int fallback = 0)
 	return var ? atoi(var) : fallback;
 }
 
+// Decodes every frame of the memory mapped corpus in place, returns the number of frames decoded to a text other than
+// the expected one.
+static int runCorpus(const fs::path& path, const DecodeHints& hints)
+{
+	LumaCorpus corpus(path);
+	int decoded = 0, mismatched = 0;
+	std::chrono::steady_clock::duration decodeTime = {};
+	for (int i = 0; i < corpus.size(); ++i) {
+		auto frame = corpus[i];
+		auto startTime = std::chrono::steady_clock::now();
+		auto result = ReadBarcode(frame.image, hints);
+		decodeTime += std::chrono::steady_clock::now() - startTime;
+		if (!result.isValid())
+			continue;
+		++decoded;
+		if (!frame.text.empty() && result.utf8() != frame.text) {
+			std::cout << frame.name << ": expected '" << frame.text << "' but got '" << result.utf8() << "'\n";
+			++mismatched;
+		}
+	}
+	auto ms = std::chrono::duration<double, std::milli>(decodeTime).count();
+	std::cout << path.filename().string() << ": " << decoded << " of " << corpus.size() << " decoded, " << mismatched
+			  << " mismatched, " << ms << " ms (" << (ms > 0 ? corpus.size() * 1000 / ms : 0) << " images/s)"
+			  << std::endl;
+	return mismatched;
+}
+
 int main(int argc, char** argv)
 {
 	if (argc <= 1) {
-		std::cout << "Usage: " << argv[0] << " <test_path_prefix>" << std::endl;
+		std::cout << "Usage: " << argv[0] << " <test_path_prefix>|<image>...|<corpus.zxlc>" << std::endl;
 		return 0;
 	}
 
 	fs::path pathPrefix = argv[1];
 
-	if (Contains({".png", ".jpg", ".pgm", ".gif"}, pathPrefix.extension())) {
+	if (pathPrefix.extension() == ".zxlc") {
+		auto hints = DecodeHints().setTryHarder(!getEnv("FAST", false)).setTryRotate(true).setIsPure(getEnv("IS_PURE"));
+		if (getenv("FORMATS"))
+			hints.setFormats(BarcodeFormatsFromString(getenv("FORMATS")));
+		try {
+			return runCorpus(pathPrefix, hints);
+		} catch (const std::exception& e) {
+			std::cerr << e.what() << std::endl;
+			return -1;
+		}
+	} else if (Contains({".png", ".jpg", ".pgm", ".gif"}, pathPrefix.extension())) {
 		auto hints = DecodeHints().setTryHarder(!getEnv("FAST", false)).setTryRotate(true).setIsPure(getEnv("IS_PURE"));
 		if (getenv("FORMATS"))
 			hints.setFormats(BarcodeFormatsFromString(getenv("FORMATS")));
@@ -59,15 +99,15 @@ int main(int argc, char** argv)
 		int rotation = getEnv("ROTATION");
 
 		for (int i = 1; i < argc; ++i) {
-			Result result = reader.read(*ImageLoader::load(argv[i]).rotated(rotation));
+			Result result = reader.read(ImageLoader::load(argv[i], rotation));
 			std::cout << argv[i] << ": ";
 			if (result.isValid())
-				std::cout << ToString(result.format()) << ": " << TextUtfEncoding::ToUtf8(result.text()) << " " << metadataToUtf8(result) << "\n";
+				std::cout << ToString(result.format()) << ": " << result.utf8() << " " << metadataToUtf8(result) << "\n";
 			else
 				std::cout << "FAILED\n";
 			if (result.isValid() && getenv("WRITE_TEXT")) {
 				std::ofstream f(fs::path(argv[i]).replace_extension(".txt"));
-				f << TextUtfEncoding::ToUtf8(result.text());
+				f << result.utf8();
 			}
 		}
 		return 0;
@@ -79,6 +119,7 @@ int main(int argc, char** argv)
 			}
 		}
 
-		return runBlackBoxTests(pathPrefix, includedTests);
+		int threads = getEnv("THREADS", std::thread::hardware_concurrency());
+		return runBlackBoxTests(pathPrefix, includedTests, threads);
 	}
 }
@@ -0,0 +1,81 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "AsyncBarcodeReader.h"
+#include "ImageUtility.h"
+
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <vector>
+
+using namespace ZXing;
+using namespace ZXing::Utility;
+
+TEST(AsyncBarcodeReaderTest, Callback)
+{
+	auto img = Render(BarcodeFormat::QR_CODE, L"async", 200, 200);
+	auto view = View(img);
+
+	std::atomic<int> decoded{0}, dropped{0}, calls{0};
+	{
+		AsyncBarcodeReader reader(DecodeHints().setFormats(BarcodeFormat::QR_CODE), 2, 1);
+		for (int i = 0; i < 20; ++i)
+			reader.submit(view, [&](Results&& results, bool wasDropped) {
+				++calls;
+				if (wasDropped) {
+					EXPECT_TRUE(results.empty());
+					++dropped;
+				} else {
+					ASSERT_EQ(results.size(), 1);
+					EXPECT_EQ(results[0].text(), L"async");
+					++decoded;
+				}
+			});
+		reader.wait();
+		EXPECT_EQ(reader.queueLength(), 0);
+
+		auto stats = reader.stats();
+		EXPECT_EQ(stats.submitted, 20);
+		EXPECT_EQ(stats.decoded, decoded);
+		EXPECT_EQ(stats.dropped, dropped);
+		EXPECT_LE(stats.maxQueueLength, 1);
+		EXPECT_GE(stats.maxLatency, stats.meanLatency());
+	}
+	EXPECT_EQ(calls, 20);
+	EXPECT_EQ(decoded + dropped, 20);
+	EXPECT_GE(decoded, 1);
+}
+
+TEST(AsyncBarcodeReaderTest, Future)
+{
+	auto img = Render(BarcodeFormat::CODE_128, L"future", 200, 50);
+	// interleaved RGB with padded rows, the frame is copied without the padding
+	const int rowStride = 3 * img.width() + 7;
+	std::vector<uint8_t> rgb(rowStride * img.height());
+	for (int y = 0; y < img.height(); ++y)
+		for (int x = 0; x < img.width(); ++x)
+			for (int c = 0; c < 3; ++c)
+				rgb[y * rowStride + 3 * x + c] = img.get(x, y);
+
+	AsyncBarcodeReader reader;
+	auto future = reader.submit({rgb.data(), img.width(), img.height(), ImageFormat::RGB, rowStride});
+	std::fill(rgb.begin(), rgb.end(), 255); // the caller may reuse its buffer right away
+	auto results = future.get();
+	ASSERT_EQ(results.size(), 1);
+	EXPECT_EQ(results[0].text(), L"future");
+}
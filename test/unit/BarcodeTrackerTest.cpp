@@ -0,0 +1,166 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "BarcodeTracker.h"
+#include "ImageUtility.h"
+
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <vector>
+
+using namespace ZXing;
+using namespace ZXing::Utility;
+
+// a 640x480 frame with the symbols pasted at the given offsets
+static Matrix<uint8_t> Frame(const std::vector<std::pair<Matrix<uint8_t>*, PointI>>& symbols)
+{
+	Matrix<uint8_t> frame(640, 480, 255);
+	for (auto& s : symbols)
+		Paste(frame, *s.first, s.second.x, s.second.y);
+	return frame;
+}
+
+TEST(BarcodeTrackerTest, Read)
+{
+	auto qr = Render(BarcodeFormat::QR_CODE, L"tracked", 120, 120);
+	BarcodeTracker tracker(DecodeHints().setFormats(BarcodeFormat::QR_CODE | BarcodeFormat::CODE_128));
+
+	for (int i = 0; i < 5; ++i) {
+		PointI offset(100 + 5 * i, 200 - 3 * i);
+		auto frame = Frame({{&qr, offset}});
+		auto result = tracker.read(View(frame));
+		ASSERT_TRUE(result.isValid()) << i;
+		EXPECT_EQ(result.text(), L"tracked");
+		EXPECT_EQ(tracker.lastFrameTracked(), i > 0) << i;
+		EXPECT_GE(result.position().topLeft().x, offset.x);
+		EXPECT_LT(result.position().topLeft().x, offset.x + qr.width());
+	}
+
+	// the symbol jumped out of the window: full scan
+	auto frame = Frame({{&qr, {500, 20}}});
+	auto result = tracker.read(View(frame));
+	ASSERT_TRUE(result.isValid());
+	EXPECT_FALSE(tracker.lastFrameTracked());
+	EXPECT_GE(result.position().topLeft().x, 500);
+
+	// gone completely
+	frame = Frame({});
+	EXPECT_FALSE(tracker.read(View(frame)).isValid());
+	EXPECT_FALSE(tracker.lastFrameTracked());
+}
+
+TEST(BarcodeTrackerTest, ReadMultiple)
+{
+	auto qr = Render(BarcodeFormat::QR_CODE, L"first", 120, 120);
+	auto code128 = Render(BarcodeFormat::CODE_128, L"second", 240, 60);
+	BarcodeTracker tracker(DecodeHints().setFormats(BarcodeFormat::QR_CODE | BarcodeFormat::CODE_128), 3);
+
+	std::vector<bool> tracked;
+	for (int i = 0; i < 5; ++i) {
+		auto frame = Frame({{&qr, {50 + 4 * i, 50}}, {&code128, {300, 300 + 2 * i}}});
+		auto results = tracker.readMultiple(View(frame));
+		ASSERT_EQ(results.size(), 2) << i;
+		tracked.push_back(tracker.lastFrameTracked());
+	}
+	// every 3rd frame is scanned completely
+	EXPECT_EQ(tracked, std::vector<bool>({false, true, true, false, true}));
+
+	tracker.reset();
+	auto frame = Frame({{&qr, {50, 50}}});
+	EXPECT_EQ(tracker.readMultiple(View(frame)).size(), 1);
+	EXPECT_FALSE(tracker.lastFrameTracked());
+}
+
+TEST(BarcodeTrackerTest, Repeat)
+{
+	auto first = Render(BarcodeFormat::QR_CODE, L"first", 120, 120);
+	auto second = Render(BarcodeFormat::QR_CODE, L"second", 120, 120);
+	BarcodeTracker tracker(DecodeHints().setFormats(BarcodeFormat::QR_CODE));
+
+	auto read = [&tracker](Matrix<uint8_t>& symbol, PointI offset) {
+		auto frame = Frame({{&symbol, offset}});
+		return tracker.read(View(frame));
+	};
+
+	auto result = read(first, {100, 100});
+	EXPECT_FALSE(result.isRepeat());
+	for (int i = 1; i < 3; ++i) {
+		result = read(first, {100 + 5 * i, 100});
+		ASSERT_TRUE(result.isValid());
+		EXPECT_TRUE(result.isRepeat());
+		EXPECT_EQ(result.text(), L"first");
+		EXPECT_GE(result.position().topLeft().x, 100 + 5 * i);
+	}
+
+	// a different symbol at the same place
+	result = read(second, {110, 100});
+	ASSERT_TRUE(result.isValid());
+	EXPECT_FALSE(result.isRepeat());
+	EXPECT_EQ(result.text(), L"second");
+
+	// the same symbol elsewhere is a different one as well
+	result = read(second, {450, 300});
+	ASSERT_TRUE(result.isValid());
+	EXPECT_FALSE(result.isRepeat());
+
+	tracker.setRepeatTimeout(std::chrono::milliseconds(0));
+	result = read(second, {450, 300});
+	ASSERT_TRUE(result.isValid());
+	EXPECT_FALSE(result.isRepeat());
+	EXPECT_EQ(result.text(), L"second");
+}
+
+TEST(BarcodeTrackerTest, FrameGating)
+{
+	auto qr = Render(BarcodeFormat::QR_CODE, L"gated", 120, 120);
+	Matrix<uint8_t> gray(200, 100, 128);
+	BarcodeTracker tracker(DecodeHints().setFormats(BarcodeFormat::QR_CODE));
+	tracker.setFrameGating(true);
+
+	auto read = [&tracker](std::vector<std::pair<Matrix<uint8_t>*, PointI>> symbols) {
+		auto frame = Frame(symbols);
+		return tracker.read(View(frame));
+	};
+
+	EXPECT_TRUE(read({{&qr, {100, 100}}}).isValid());
+	EXPECT_FALSE(tracker.lastFrameSkipped());
+
+	// unchanged
+	auto result = read({{&qr, {100, 100}}});
+	EXPECT_TRUE(tracker.lastFrameSkipped());
+	ASSERT_TRUE(result.isValid());
+	EXPECT_TRUE(result.isRepeat());
+	EXPECT_EQ(result.text(), L"gated");
+
+	// the symbol is gone, the tracked one is searched for once
+	EXPECT_FALSE(read({}).isValid());
+	EXPECT_FALSE(tracker.lastFrameSkipped());
+	EXPECT_FALSE(read({}).isValid());
+	EXPECT_TRUE(tracker.lastFrameSkipped());
+
+	// a change without edges
+	EXPECT_FALSE(read({{&gray, {300, 300}}}).isValid());
+	EXPECT_TRUE(tracker.lastFrameSkipped());
+
+	// a new symbol, only the changed part of the frame is scanned
+	result = read({{&gray, {300, 300}}, {&qr, {480, 40}}});
+	EXPECT_FALSE(tracker.lastFrameSkipped());
+	ASSERT_TRUE(result.isValid());
+	EXPECT_GE(result.position().topLeft().x, 480);
+	EXPECT_LT(result.position().topLeft().y, 40 + qr.height());
+}
@@ -16,6 +16,7 @@
 #include "gtest/gtest.h"
 
 #include "BitHacks.h"
+#include <algorithm>
 #include <vector>
 
 TEST(BitHackTest, BitHacks)
@@ -56,4 +57,13 @@ TEST(BitHackTest, BitHacks)
 	checkReverse(V{0, 1}, 0, V{0x80000000, 0});
 	checkReverse(V{0, 1}, 31, V{1, 0});
 	checkReverse(V{0xffffffff, 0}, 16, V{0xffff0000, 0xffff});
+
+	uint32_t block[32], expected[32] = {};
+	for (int r = 0; r < 32; ++r) {
+		block[r] = 0x9E3779B9u * (r + 1);
+		for (int c = 0; c < 32; ++c)
+			expected[c] |= ((block[r] >> c) & 1) << r;
+	}
+	Transpose32(block);
+	EXPECT_TRUE(std::equal(block, block + 32, expected));
 }
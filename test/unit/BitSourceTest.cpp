@@ -0,0 +1,75 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "BitSource.h"
+#include "ByteArray.h"
+
+#include "gtest/gtest.h"
+
+#include <stdexcept>
+
+using namespace ZXing;
+
+TEST(BitSourceTest, ReadBits)
+{
+	ByteArray bytes = {0x01, 0x02, 0x03, 0x04, 0x05};
+	BitSource source(bytes);
+	EXPECT_EQ(source.available(), 40);
+	EXPECT_EQ(source.readBits(1), 0);
+	EXPECT_EQ(source.available(), 39);
+	EXPECT_EQ(source.readBits(6), 0);
+	EXPECT_EQ(source.readBits(1), 1);
+	EXPECT_EQ(source.readBits(2), 0);
+	EXPECT_EQ(source.readBits(7), 4);
+	EXPECT_EQ(source.readBits(13), 0xC1);
+	EXPECT_EQ(source.bitOffset(), 6);
+	EXPECT_EQ(source.byteOffset(), 3);
+	EXPECT_EQ(source.readBits(10), 5);
+	EXPECT_EQ(source.available(), 0);
+	EXPECT_THROW(source.readBits(1), std::out_of_range);
+}
+
+TEST(BitSourceTest, ReadWideWindows)
+{
+	ByteArray bytes = {0x12, 0x34, 0x56, 0x78, 0x9A, 0xBC, 0xDE, 0xF0, 0xFF};
+	for (int offset = 0; offset <= 8; ++offset) {
+		BitSource source(bytes);
+		source.skipBits(offset);
+		uint64_t expected = 0x123456789ABCDEF0ull << offset | (0xFF >> (8 - offset));
+		EXPECT_EQ(source.peekBits(32), static_cast<int>(static_cast<uint32_t>(expected >> 32)));
+		EXPECT_EQ(source.readBits(32), static_cast<int>(static_cast<uint32_t>(expected >> 32)));
+		EXPECT_EQ(source.available(), 72 - offset - 32);
+	}
+}
+
+TEST(BitSourceTest, PeekAndSkip)
+{
+	ByteArray bytes = {0xA5, 0x0F};
+	BitSource source(bytes);
+	EXPECT_EQ(source.peekBits(4), 0xA);
+	EXPECT_EQ(source.peekBits(4), 0xA);
+	EXPECT_EQ(source.available(), 16);
+	source.skipBits(3);
+	EXPECT_EQ(source.peekBits(9), 0x050);
+	source.skipBits(0);
+	EXPECT_EQ(source.readBits(9), 0x050);
+	EXPECT_EQ(source.available(), 4);
+	EXPECT_THROW(source.peekBits(5), std::out_of_range);
+	EXPECT_THROW(source.skipBits(5), std::out_of_range);
+	EXPECT_THROW(source.skipBits(-1), std::out_of_range);
+	source.skipBits(4);
+	EXPECT_EQ(source.available(), 0);
+}
@@ -0,0 +1,53 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "ByteSegments.h"
+#include "ResultMetadata.h"
+
+#include "gtest/gtest.h"
+
+using namespace ZXing;
+
+TEST(ByteSegmentsTest, Append)
+{
+	ByteSegments segments;
+	EXPECT_TRUE(segments.empty());
+
+	segments.append(ByteArray{0x01, 0x02}.data(), 2);
+	uint8_t* p = segments.append(3);
+	p[0] = 0x03, p[1] = 0x04, p[2] = 0x05;
+	segments.append(nullptr, 0);
+
+	ASSERT_EQ(segments.size(), 3);
+	EXPECT_EQ(segments.bytes(), ByteArray({0x01, 0x02, 0x03, 0x04, 0x05}));
+	EXPECT_EQ(segments.ends(), std::vector<int>({2, 5, 5}));
+	EXPECT_EQ(segments[0].toByteArray(), ByteArray({0x01, 0x02}));
+	EXPECT_EQ(segments[1].toByteArray(), ByteArray({0x03, 0x04, 0x05}));
+	EXPECT_EQ(segments.back().size(), 0);
+}
+
+TEST(ByteSegmentsTest, Metadata)
+{
+	std::list<ByteArray> list = {{0x01}, {0x02, 0x03}};
+
+	ResultMetadata metadata;
+	metadata.put(ResultMetadata::BYTE_SEGMENTS, ByteSegments(list));
+	EXPECT_EQ(metadata.getByteArrayList(ResultMetadata::BYTE_SEGMENTS), list);
+	ASSERT_NE(metadata.getByteSegments(ResultMetadata::BYTE_SEGMENTS), nullptr);
+	EXPECT_EQ(metadata.getByteSegments(ResultMetadata::BYTE_SEGMENTS)->bytes(), ByteArray({0x01, 0x02, 0x03}));
+	EXPECT_EQ(metadata.getByteSegments(ResultMetadata::ERROR_CORRECTION_LEVEL), nullptr);
+}
@@ -0,0 +1,100 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "CpuFeatures.h"
+#include "BitMatrix.h"
+#include "ByteArray.h"
+#include "GenericLuminanceSource.h"
+#include "GlobalHistogramBinarizer.h"
+#include "HybridBinarizer.h"
+
+#include "gtest/gtest.h"
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace ZXing;
+using CpuFeatures::Isa;
+
+namespace {
+
+// what the kernels produce for a noisy RGB image, the SIMD ones have to match the scalar fallbacks bit for bit
+struct Output
+{
+	ByteArray luminance;
+	BitMatrix hybrid, global, rotated;
+};
+
+Output RunKernels(const std::vector<uint8_t>& rgb, int width, int height)
+{
+	auto source = std::make_shared<GenericLuminanceSource>(width, height, rgb.data(), width * 3, 3, 0, 1, 2);
+	Output res;
+	int rowBytes = 0;
+	auto lum = source->getMatrix(res.luminance, rowBytes, true);
+	res.luminance.assign(lum, lum + width * height);
+	res.hybrid = HybridBinarizer(source).getBlackMatrix()->copy();
+	res.global = GlobalHistogramBinarizer(source).getBlackMatrix()->copy();
+	res.rotated = res.hybrid.copy();
+	res.rotated.rotate90();
+	res.rotated.rotate180();
+	return res;
+}
+
+} // namespace
+
+TEST(CpuFeaturesTest, SetMaxIsa)
+{
+	Isa best = CpuFeatures::Best();
+	EXPECT_TRUE(CpuFeatures::Has(Isa::Scalar));
+
+	CpuFeatures::SetMaxIsa(Isa::Scalar);
+	EXPECT_EQ(CpuFeatures::Best(), Isa::Scalar);
+	EXPECT_FALSE(CpuFeatures::HasSSE2());
+	EXPECT_FALSE(CpuFeatures::HasNEON());
+
+	CpuFeatures::SetMaxIsa(Isa::SSE2);
+	EXPECT_FALSE(CpuFeatures::HasSSSE3());
+	EXPECT_FALSE(CpuFeatures::HasAVX2());
+
+	CpuFeatures::SetMaxIsa(best);
+	EXPECT_EQ(CpuFeatures::Best(), best);
+	EXPECT_STREQ(CpuFeatures::ToString(Isa::SSE41), "sse4.1");
+}
+
+TEST(CpuFeaturesTest, ScalarFallbacksMatch)
+{
+	const int width = 301, height = 203;
+	std::mt19937 rnd(42);
+	std::vector<uint8_t> rgb(width * height * 3);
+	for (int y = 0; y < height; ++y)
+		for (int x = 0; x < width * 3; ++x)
+			rgb[y * width * 3 + x] = static_cast<uint8_t>((x / 3 / 7 + y / 5) % 2 * 160 + rnd() % 90);
+
+	Isa best = CpuFeatures::Best();
+	auto expected = RunKernels(rgb, width, height);
+	for (auto isa : {Isa::Scalar, Isa::SSE2, Isa::SSSE3, Isa::SSE41, Isa::NEON, Isa::WasmSimd}) {
+		CpuFeatures::SetMaxIsa(isa);
+		auto out = RunKernels(rgb, width, height);
+		EXPECT_EQ(out.luminance, expected.luminance) << CpuFeatures::ToString(isa);
+		EXPECT_EQ(out.hybrid, expected.hybrid) << CpuFeatures::ToString(isa);
+		EXPECT_EQ(out.global, expected.global) << CpuFeatures::ToString(isa);
+		EXPECT_EQ(out.rotated, expected.rotated) << CpuFeatures::ToString(isa);
+	}
+	CpuFeatures::SetMaxIsa(best);
+}
@@ -0,0 +1,74 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "Deadline.h"
+
+#include "gtest/gtest.h"
+
+#include <chrono>
+
+using namespace ZXing;
+using namespace std::chrono_literals;
+
+TEST(DeadlineTest, Unlimited)
+{
+	Deadline deadline;
+	EXPECT_FALSE(deadline.isLimited());
+	EXPECT_FALSE(deadline.isCancellable());
+	EXPECT_FALSE(deadline.hasExpired());
+}
+
+TEST(DeadlineTest, Expires)
+{
+	EXPECT_TRUE(Deadline(Deadline::Clock::now() - 1ms).hasExpired());
+	EXPECT_FALSE(Deadline(1h).hasExpired());
+	EXPECT_TRUE(Deadline(1h).isLimited());
+}
+
+TEST(DeadlineTest, CopiesShareCancellation)
+{
+	auto deadline = Deadline::Cancellable();
+	auto copy = deadline;
+	Deadline other = Deadline::Cancellable();
+	EXPECT_TRUE(deadline.isCancellable());
+	EXPECT_FALSE(copy.hasExpired());
+
+	deadline.cancel();
+	EXPECT_TRUE(deadline.hasExpired());
+	EXPECT_TRUE(copy.hasExpired());
+	EXPECT_FALSE(other.hasExpired());
+}
+
+TEST(DeadlineTest, Scope)
+{
+	EXPECT_EQ(Deadline::Current(), nullptr);
+	EXPECT_FALSE(Deadline::Expired());
+
+	auto outer = Deadline::Cancellable();
+	Deadline::Scope outerScope(outer);
+	EXPECT_EQ(Deadline::Current(), &outer);
+	{
+		Deadline inner(Deadline::Clock::now() - 1ms);
+		Deadline::Scope innerScope(inner);
+		EXPECT_EQ(Deadline::Current(), &inner);
+		EXPECT_TRUE(Deadline::Expired());
+	}
+	EXPECT_EQ(Deadline::Current(), &outer);
+	EXPECT_FALSE(Deadline::Expired());
+	outer.cancel();
+	EXPECT_TRUE(Deadline::Expired());
+}
@@ -0,0 +1,125 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "DecodeStats.h"
+#include "BarcodeFormat.h"
+#include "DecodeHints.h"
+#include "ImageUtility.h"
+#include "ReadBarcode.h"
+
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <vector>
+
+using namespace ZXing;
+using namespace ZXing::Utility;
+using Stage = DecodeStats::Stage;
+using ReaderType = DecodeStats::ReaderType;
+
+TEST(DecodeStatsTest, QRCode)
+{
+	auto img = Render(BarcodeFormat::QR_CODE, L"DecodeStats", 200, 200);
+	DecodeStats stats;
+	auto result = ReadBarcode(View(img), DecodeHints().setFormats(BarcodeFormat::QR_CODE).setStats(&stats));
+	ASSERT_TRUE(result.isValid());
+
+	using std::chrono::nanoseconds;
+	EXPECT_GT(stats.time(Stage::Binarize), nanoseconds(0));
+	EXPECT_GT(stats.time(Stage::Detect), nanoseconds(0));
+	EXPECT_GT(stats.time(Stage::Sample), nanoseconds(0));
+	EXPECT_GT(stats.time(Stage::ErrorCorrection), nanoseconds(0));
+	EXPECT_GT(stats.time(Stage::DecodeText), nanoseconds(0));
+	EXPECT_GT(stats.time(ReaderType::QRCode), nanoseconds(0));
+	EXPECT_EQ(stats.time(ReaderType::DataMatrix), nanoseconds(0));
+	EXPECT_GE(stats.finderCandidates(), 3);
+	EXPECT_EQ(stats.rowsScanned(), 0);
+	EXPECT_EQ(stats.errorsCorrected(), 0);
+
+	// stage times are exclusive, so together they can't exceed the time spent in the reader (plus the binarizer)
+	nanoseconds total(0);
+	for (auto stage : {Stage::Detect, Stage::Sample, Stage::ErrorCorrection, Stage::DecodeText})
+		total += stats.time(stage);
+	EXPECT_LE(total, stats.time(ReaderType::QRCode));
+
+	stats.reset();
+	EXPECT_EQ(stats.time(ReaderType::QRCode), nanoseconds(0));
+	EXPECT_EQ(stats.finderCandidates(), 0);
+}
+
+TEST(DecodeStatsTest, OneD)
+{
+	auto img = Render(BarcodeFormat::CODE_128, L"DecodeStats", 200, 200);
+	DecodeStats stats;
+	auto result = ReadBarcode(View(img), DecodeHints().setFormats(BarcodeFormat::CODE_128).setStats(&stats));
+	ASSERT_TRUE(result.isValid());
+	EXPECT_GT(stats.rowsScanned(), 0);
+	EXPECT_GT(stats.time(ReaderType::OneD), std::chrono::nanoseconds(0));
+}
+
+TEST(DecodeStatsTest, Disabled)
+{
+	auto img = Render(BarcodeFormat::QR_CODE, L"DecodeStats", 200, 200);
+	DecodeStats stats;
+	{
+		DecodeStats::Scope scope(&stats);
+		// the stats of the hints win over the ones installed by the caller
+		ReadBarcode(View(img), DecodeHints());
+	}
+	EXPECT_EQ(stats.time(ReaderType::QRCode), std::chrono::nanoseconds(0));
+	EXPECT_EQ(DecodeStats::Current(), nullptr);
+}
+
+TEST(DecodeStatsTest, Memory)
+{
+	auto img = Render(BarcodeFormat::QR_CODE, L"DecodeStats", 200, 200);
+	DecodeStats stats;
+	{
+		// an RGB image gets converted into a luminance copy
+		std::vector<uint8_t> rgb;
+		for (auto v : img)
+			rgb.insert(rgb.end(), {v, v, v});
+		auto result = ReadBarcode({rgb.data(), img.width(), img.height(), ImageFormat::RGB},
+								  DecodeHints().setFormats(BarcodeFormat::QR_CODE).setStats(&stats));
+		ASSERT_TRUE(result.isValid());
+	}
+	EXPECT_GE(stats.allocations(), 2);
+	EXPECT_GE(stats.peakBytes(), img.width() * img.height()); // at least the luminance copy
+
+	stats.reset();
+	EXPECT_EQ(stats.allocations(), 0);
+	EXPECT_EQ(stats.peakBytes(), 0); // nothing is held anymore
+}
+
+TEST(DecodeStatsTest, MaxMemory)
+{
+	// an 800 x 800 image, 4 pixels per module
+	auto img = Render(BarcodeFormat::QR_CODE, L"DecodeStats", 800, 800);
+	DecodeStats stats;
+	auto hints = DecodeHints().setFormats(BarcodeFormat::QR_CODE).setStats(&stats).setMaxMemory(100 * 100);
+	auto iv = View(img);
+
+	auto result = ReadBarcode(iv, hints);
+	ASSERT_TRUE(result.isValid());
+	EXPECT_LT(stats.peakBytes(), img.width() * img.height() / 4);
+	// positions are in full resolution coordinates
+	EXPECT_GT(result.position().topRight().x, img.width() / 2);
+
+	auto results = ReadBarcodes(iv, hints);
+	ASSERT_EQ(results.size(), 1u);
+	EXPECT_EQ(results.front().position(), result.position());
+}
@@ -0,0 +1,71 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "EdgeOrientation.h"
+#include "GenericLuminanceSource.h"
+#include "GlobalHistogramBinarizer.h"
+
+#include "gtest/gtest.h"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+using namespace ZXing;
+
+// a pattern inside a white border, as the rows of GlobalHistogramBinarizer need more than one color
+static EdgeOrientation Stripes(std::function<bool(int x, int y)> isBlack)
+{
+	const int width = 200, height = 120, border = 20;
+	std::vector<uint8_t> pixels(width * height, 230);
+	for (int y = border; y < height - border; ++y)
+		for (int x = border; x < width - border; ++x)
+			if (isBlack(x, y))
+				pixels[y * width + x] = 20;
+	GlobalHistogramBinarizer image(std::make_shared<GenericLuminanceSource>(width, height, pixels.data(), width));
+	return EdgeOrientation(image);
+}
+
+TEST(EdgeOrientationTest, Axes)
+{
+	auto bars = Stripes([](int x, int) { return x / 3 % 2; });
+	EXPECT_EQ(bars.binsByCount()[0], 0);
+	EXPECT_FALSE(bars.prefersColumns());
+
+	auto rotated = Stripes([](int, int y) { return y / 3 % 2; });
+	EXPECT_EQ(rotated.binsByCount()[0], EdgeOrientation::NUM_BINS / 2);
+	EXPECT_TRUE(rotated.prefersColumns());
+}
+
+TEST(EdgeOrientationTest, Diagonals)
+{
+	// the gradient of stripes running from top right to bottom left points to the bottom right, i.e. 45 degrees
+	auto falling = Stripes([](int x, int y) { return (x + y) / 7 % 2; });
+	EXPECT_EQ(falling.binsByCount()[0], 2);
+	EXPECT_FALSE(falling.prefersColumns());
+
+	auto rising = Stripes([](int x, int y) { return (x - y + 1000) / 7 % 2; });
+	EXPECT_EQ(rising.binsByCount()[0], 6);
+}
+
+TEST(EdgeOrientationTest, Empty)
+{
+	auto blank = Stripes([](int, int) { return false; });
+	EXPECT_EQ(blank.total(), 0);
+	EXPECT_FALSE(blank.prefersColumns());
+}
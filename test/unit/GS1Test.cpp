@@ -0,0 +1,65 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "GS1.h"
+#include "DecodeStatus.h"
+
+#include "gtest/gtest.h"
+
+using namespace ZXing;
+
+static std::string HRI(const std::string& data)
+{
+	std::string res;
+	return StatusIsOK(GS1::HRIFromGS1(data, res)) ? res : "<error>";
+}
+
+TEST(GS1Test, Parse)
+{
+	std::string data = "0100012345678905" "10ABC\x1D" "3103000123" "7031276ABC";
+	std::vector<GS1::Element> elements;
+	ASSERT_EQ(GS1::Parse(data, elements), DecodeStatus::NoError);
+	ASSERT_EQ(elements.size(), 4u);
+	EXPECT_EQ(elements[0].ai(data), "01");
+	EXPECT_EQ(elements[0].value(data), "00012345678905");
+	EXPECT_EQ(elements[1].ai(data), "10");
+	EXPECT_EQ(elements[1].value(data), "ABC");
+	EXPECT_EQ(elements[2].ai(data), "3103");
+	EXPECT_EQ(elements[2].value(data), "000123");
+	EXPECT_EQ(elements[3].ai(data), "7031");
+	EXPECT_EQ(elements[3].value(data), "276ABC");
+}
+
+TEST(GS1Test, HRI)
+{
+	EXPECT_EQ(HRI(""), "");
+	EXPECT_EQ(HRI("0100012345678905"), "(01)00012345678905");
+	EXPECT_EQ(HRI("0100012345678905\x1D" "17201231"), "(01)00012345678905(17)201231");
+	// a variable length field ends at its maximum length
+	EXPECT_EQ(HRI("21" + std::string(20, 'X') + "11201231"), "(21)" + std::string(20, 'X') + "(11)201231");
+	EXPECT_EQ(HRI("8200http://example.com\x1D" "8102" "03"), "(8200)http://example.com(8102)03");
+}
+
+TEST(GS1Test, Errors)
+{
+	EXPECT_EQ(HRI("0"), "<error>");         // truncated AI
+	EXPECT_EQ(HRI("01123"), "<error>");     // fixed length field too short
+	EXPECT_EQ(HRI("10"), "<error>");        // empty variable length field
+	EXPECT_EQ(HRI("10\x1D" "11"), "<error>");
+	EXPECT_EQ(HRI("23123456"), "<error>");  // unknown AI
+	EXPECT_EQ(HRI("310A123456"), "<error>"); // AI not numeric
+}
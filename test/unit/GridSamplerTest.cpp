@@ -0,0 +1,82 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "GridSampler.h"
+#include "CpuFeatures.h"
+
+#include "gtest/gtest.h"
+
+#include <vector>
+
+using namespace ZXing;
+
+TEST(GridSamplerTest, SampleModes)
+{
+	// a 4x4 checker board with modules of 10x10 pixels
+	BitMatrix image(40, 40);
+	for (int y = 0; y < 40; ++y)
+		for (int x = 0; x < 40; ++x)
+			if ((x / 10 + y / 10) % 2)
+				image.set(x, y);
+	// a speck of dirt right at the center of the white module (1, 1)
+	image.set(15, 15);
+
+	PerspectiveTransform transform({PointF{0, 0}, {4, 0}, {4, 4}, {0, 4}}, {PointF{0, 0}, {40, 0}, {40, 40}, {0, 40}});
+
+	BitMatrix lowConfidence;
+	auto center = SampleGrid(image, 4, 4, transform, &lowConfidence);
+	ASSERT_TRUE(center.isValid());
+	EXPECT_TRUE(center.bits().get(1, 1));
+	EXPECT_TRUE(lowConfidence.get(1, 1));
+	EXPECT_FALSE(lowConfidence.get(0, 1));
+	EXPECT_TRUE(center.bits().get(0, 1));
+
+	auto majority = SampleGrid(image, 4, 4, transform, &lowConfidence, SampleMode::Majority);
+	ASSERT_TRUE(majority.isValid());
+	for (int y = 0; y < 4; ++y)
+		for (int x = 0; x < 4; ++x) {
+			EXPECT_EQ(majority.bits().get(x, y), (x + y) % 2 == 1);
+			EXPECT_FALSE(lowConfidence.get(x, y));
+		}
+}
+
+TEST(GridSamplerTest, BatchTransform)
+{
+	PerspectiveTransform transform({PointF{0, 0}, {21, 0}, {21, 21}, {0, 21}},
+								   {PointF{13.2, 17.9}, {251.3, 30.1}, {240.7, 260.4}, {5.5, 230.8}});
+	ASSERT_TRUE(transform.isValid());
+
+	std::vector<PointF> points;
+	for (int y = 0; y < 21; ++y)
+		for (int x = 0; x < 21; ++x)
+			points.push_back({x + 0.5, y + 0.5});
+	points.pop_back(); // an odd count to leave a remainder for the scalar code
+
+	auto best = CpuFeatures::Best();
+	for (auto isa : {CpuFeatures::Isa::Scalar, best}) {
+		CpuFeatures::SetMaxIsa(isa);
+		std::vector<PointF> mapped(points.size());
+		transform(points.data(), mapped.data(), static_cast<int>(points.size()));
+		for (size_t i = 0; i < points.size(); ++i)
+			EXPECT_EQ(mapped[i], transform(points[i])) << CpuFeatures::ToString(isa) << " " << i;
+
+		// in place
+		auto inPlace = points;
+		transform(inPlace.data(), inPlace.data(), static_cast<int>(inPlace.size()));
+		EXPECT_EQ(inPlace, mapped);
+	}
+	CpuFeatures::SetMaxIsa(best);
+}
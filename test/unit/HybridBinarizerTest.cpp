@@ -0,0 +1,195 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "HybridBinarizer.h"
+#include "BitArray.h"
+#include "BitMatrix.h"
+#include "GenericLuminanceSource.h"
+
+#include "gtest/gtest.h"
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+using namespace ZXing;
+
+TEST(HybridBinarizerTest, BlockSizeForModuleSize)
+{
+	EXPECT_EQ(HybridBinarizer::BlockSizeForModuleSize(0), 8);
+	EXPECT_EQ(HybridBinarizer::BlockSizeForModuleSize(3.5f), 8);
+	EXPECT_EQ(HybridBinarizer::BlockSizeForModuleSize(16), 16);
+	EXPECT_EQ(HybridBinarizer::BlockSizeForModuleSize(31.9f), 16);
+	EXPECT_EQ(HybridBinarizer::BlockSizeForModuleSize(40), 32);
+}
+
+TEST(HybridBinarizerTest, LargeBlocks)
+{
+	// a checkerboard of 20 pixel modules under a horizontal lighting gradient, with a size that is not a multiple of
+	// the block sizes
+	const int width = 300, height = 250, module = 20;
+	std::vector<uint8_t> pixels(width * height);
+	for (int y = 0; y < height; ++y)
+		for (int x = 0; x < width; ++x)
+			pixels[y * width + x] = static_cast<uint8_t>(((x / module + y / module) % 2 ? 40 : 170) + x / 6);
+	auto source = std::make_shared<GenericLuminanceSource>(width, height, pixels.data(), width);
+
+	for (int blockSize : {0, 8, 16, 32}) {
+		auto matrix = HybridBinarizer(source, 1, blockSize).getBlackMatrix();
+		ASSERT_NE(matrix, nullptr);
+		int errors = 0;
+		for (int y = 0; y < height; ++y)
+			for (int x = 0; x < width; ++x)
+				errors += matrix->get(x, y) != ((x / module + y / module) % 2 == 1);
+		EXPECT_EQ(errors, 0) << "block size " << blockSize;
+	}
+}
+
+TEST(HybridBinarizerTest, SmallImage)
+{
+	// too small for 5x5 blocks of 32 pixels, falls back to smaller ones
+	const int width = 100, height = 60;
+	std::vector<uint8_t> pixels(width * height, 200);
+	for (int y = 20; y < 40; ++y)
+		for (int x = 30; x < 70; ++x)
+			pixels[y * width + x] = 30;
+	auto source = std::make_shared<GenericLuminanceSource>(width, height, pixels.data(), width);
+
+	auto matrix = HybridBinarizer(source, 1, 32).getBlackMatrix();
+	ASSERT_NE(matrix, nullptr);
+	EXPECT_TRUE(matrix->get(50, 30));
+	EXPECT_FALSE(matrix->get(10, 10));
+	EXPECT_FALSE(matrix->get(90, 50));
+}
+
+TEST(HybridBinarizerTest, RotatedAndCroppedViews)
+{
+	// a random pattern of 4 pixel modules, every block has enough contrast
+	const int width = 120, height = 80;
+	std::vector<uint8_t> pixels(width * height);
+	uint32_t state = 12345;
+	std::vector<bool> modules(width / 4 * height / 4);
+	for (size_t i = 0; i < modules.size(); ++i)
+		modules[i] = ((state = state * 1103515245 + 12345) >> 16) & 1;
+	for (int y = 0; y < height; ++y)
+		for (int x = 0; x < width; ++x)
+			pixels[y * width + x] = modules[y / 4 * (width / 4) + x / 4] ? 20 : 230;
+	auto source = std::make_shared<GenericLuminanceSource>(width, height, pixels.data(), width);
+
+	HybridBinarizer binarizer(source);
+	auto matrix = binarizer.getBlackMatrix();
+	ASSERT_NE(matrix, nullptr);
+	// the views share the cache, no binarization of a rotated copy
+	EXPECT_EQ(binarizer.rotated(360)->getBlackMatrix(), matrix);
+
+	auto expected = [&](int degreeCW, int x, int y) {
+		switch (degreeCW) {
+		case 90: return matrix->get(y, height - 1 - x);
+		case 180: return matrix->get(width - 1 - x, height - 1 - y);
+		default: return matrix->get(width - 1 - y, x);
+		}
+	};
+	for (int degreeCW : {90, 180, 270}) {
+		auto view = binarizer.rotated(degreeCW);
+		auto rotated = view->getBlackMatrix();
+		ASSERT_NE(rotated, nullptr);
+		ASSERT_EQ(rotated->width(), view->width());
+		ASSERT_EQ(rotated->height(), view->height());
+		int errors = 0;
+		for (int y = 0; y < view->height(); ++y) {
+			BitArray row;
+			ASSERT_TRUE(view->getBlackRow(y, row));
+			for (int x = 0; x < view->width(); ++x)
+				errors += (rotated->get(x, y) != expected(degreeCW, x, y)) + (row.get(x) != rotated->get(x, y));
+		}
+		EXPECT_EQ(errors, 0) << degreeCW;
+	}
+
+	auto cropped = binarizer.cropped(10, 20, 50, 30)->cropped(5, 2, 40, 20);
+	auto croppedMatrix = cropped->getBlackMatrix();
+	ASSERT_NE(croppedMatrix, nullptr);
+	ASSERT_EQ(croppedMatrix->width(), 40);
+	int errors = 0;
+	for (int y = 0; y < 20; ++y)
+		for (int x = 0; x < 40; ++x)
+			errors += croppedMatrix->get(x, y) != matrix->get(x + 15, y + 22);
+	EXPECT_EQ(errors, 0);
+	EXPECT_THROW(binarizer.cropped(100, 0, 30, 10), std::out_of_range);
+}
+
+TEST(HybridBinarizerTest, BinarizeRows)
+{
+	// sizes that are not multiples of the block sizes and a pattern with low contrast areas, which use the black
+	// points of their neighbors
+	for (auto size : {std::pair<int, int>{40, 40}, {203, 77}, {331, 250}, {64, 520}}) {
+		const int width = size.first, height = size.second;
+		std::vector<uint8_t> pixels(width * height);
+		uint32_t state = width * height;
+		for (int y = 0; y < height; ++y)
+			for (int x = 0; x < width; ++x) {
+				state = state * 1103515245 + 12345;
+				bool flat = (x / 50 + y / 30) % 3 == 0;
+				int value = flat ? 150 + (state >> 28) : ((x / 3 + y / 5) % 2 ? 30 : 200) + (state >> 27);
+				pixels[y * width + x] = static_cast<uint8_t>(value + x / 8);
+			}
+		auto source = std::make_shared<GenericLuminanceSource>(width, height, pixels.data(), width);
+
+		for (int blockSize : {0, 8, 16, 32}) {
+			auto expected = HybridBinarizer(source, 1, blockSize).getBlackMatrix();
+			BitMatrix matrix(width, height);
+			int nextRow = 0;
+			ASSERT_TRUE(HybridBinarizer::BinarizeRows(*source, blockSize, [&](int y, const BitArray& row) {
+				EXPECT_EQ(y, nextRow++);
+				matrix.setRow(y, row);
+			}));
+			EXPECT_EQ(nextRow, height);
+			EXPECT_EQ(matrix, *expected) << width << "x" << height << " block size " << blockSize;
+			EXPECT_EQ(*HybridBinarizer(source, 1, blockSize, true).getBlackMatrix(), *expected);
+		}
+	}
+
+	std::vector<uint8_t> small(30 * 30, 255);
+	EXPECT_FALSE(HybridBinarizer::BinarizeRows(GenericLuminanceSource(30, 30, small.data(), 30), 8,
+											   [](int, const BitArray&) {}));
+}
+
+TEST(HybridBinarizerTest, Bands)
+{
+	// the bands only split the work, the result is the same for any number of them, including more bands than rows
+	// of blocks
+	const int width = 331, height = 250;
+	std::vector<uint8_t> pixels(width * height);
+	uint32_t state = 4711;
+	for (int y = 0; y < height; ++y)
+		for (int x = 0; x < width; ++x) {
+			state = state * 1103515245 + 12345;
+			pixels[y * width + x] = static_cast<uint8_t>(((x / 3 + y / 5) % 2 ? 30 : 200) + (state >> 27) + y / 4);
+		}
+	auto source = std::make_shared<GenericLuminanceSource>(width, height, pixels.data(), width);
+
+	for (int blockSize : {8, 32}) {
+		auto expected = HybridBinarizer(source, 1, blockSize).getBlackMatrix();
+		ASSERT_NE(expected, nullptr);
+		for (int numBands : {2, 3, 8, 100}) {
+			auto matrix = HybridBinarizer(source, numBands, blockSize).getBlackMatrix();
+			ASSERT_NE(matrix, nullptr);
+			EXPECT_EQ(*matrix, *expected) << numBands << " bands, block size " << blockSize;
+		}
+	}
+}
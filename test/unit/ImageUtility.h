@@ -0,0 +1,49 @@
+#pragma once
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "BitMatrix.h"
+#include "Matrix.h"
+#include "MultiFormatWriter.h"
+#include "ReadBarcode.h"
+
+#include <cstdint>
+#include <string>
+
+namespace ZXing {
+namespace Utility {
+
+/// The symbol as an 8-bit grayscale image of (at least) width x height pixels with a quiet zone of 10 pixels
+inline Matrix<uint8_t> Render(BarcodeFormat format, const std::wstring& text, int width, int height)
+{
+	return ToMatrix<uint8_t>(MultiFormatWriter(format).setMargin(10).encode(text, width, height));
+}
+
+/// Copies symbol into image with its top left corner at (left, top)
+inline void Paste(Matrix<uint8_t>& image, const Matrix<uint8_t>& symbol, int left, int top)
+{
+	for (int y = 0; y < symbol.height(); ++y)
+		for (int x = 0; x < symbol.width(); ++x)
+			image.set(left + x, top + y, symbol.get(x, y));
+}
+
+inline ImageView View(const Matrix<uint8_t>& image)
+{
+	return {image.data(), image.width(), image.height(), ImageFormat::Lum};
+}
+
+}} // ZXing::Utility
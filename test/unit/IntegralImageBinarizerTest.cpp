@@ -0,0 +1,107 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "IntegralImageBinarizer.h"
+#include "BitMatrix.h"
+#include "GenericLuminanceSource.h"
+#include "ImageUtility.h"
+#include "ReadBarcode.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+using namespace ZXing;
+using namespace ZXing::Utility;
+
+TEST(IntegralImageBinarizerTest, LocalMean)
+{
+	// random pixels, compared with a brute force computation of the window means
+	const int width = 97, height = 61;
+	std::vector<uint8_t> pixels(width * height);
+	uint32_t state = 42;
+	for (auto& p : pixels)
+		p = static_cast<uint8_t>((state = state * 1103515245 + 12345) >> 24);
+	auto source = std::make_shared<GenericLuminanceSource>(width, height, pixels.data(), width);
+
+	IntegralImageBinarizer binarizer(source);
+	for (int windowSize : {2, 10, 40, 200}) {
+		auto matrix = binarizer.getBlackMatrix(windowSize);
+		ASSERT_NE(matrix, nullptr);
+		const int r = std::max(1, windowSize / 2);
+		int errors = 0;
+		for (int y = 0; y < height; ++y)
+			for (int x = 0; x < width; ++x) {
+				int sum = 0, count = 0;
+				for (int wy = std::max(0, y - r); wy < std::min(height, y + r + 1); ++wy)
+					for (int wx = std::max(0, x - r); wx < std::min(width, x + r + 1); ++wx, ++count)
+						sum += pixels[wy * width + wx];
+				errors += matrix->get(x, y) != (pixels[y * width + x] * count * 100 <= sum * 85);
+			}
+		EXPECT_EQ(errors, 0) << "window size " << windowSize;
+		// the same as a binarizer constructed with that window size
+		EXPECT_EQ(*matrix, *IntegralImageBinarizer(source, windowSize).getBlackMatrix());
+	}
+	EXPECT_EQ(*binarizer.getBlackMatrix(), *binarizer.getBlackMatrix(40));
+	EXPECT_EQ(binarizer.getBlackMatrix(), binarizer.getBlackMatrix());
+}
+
+TEST(IntegralImageBinarizerTest, Offset)
+{
+	// a flat image is white, unless the offset is 0 and a pixel equal to its mean counts as black
+	std::vector<uint8_t> pixels(50 * 40, 128);
+	auto source = std::make_shared<GenericLuminanceSource>(50, 40, pixels.data(), 50);
+	EXPECT_EQ(*IntegralImageBinarizer(source).getBlackMatrix(), BitMatrix(50, 40));
+	auto matrix = IntegralImageBinarizer(source, 0, 0).getBlackMatrix();
+	for (int y = 0; y < 40; ++y)
+		for (int x = 0; x < 50; ++x)
+			ASSERT_TRUE(matrix->get(x, y));
+}
+
+TEST(IntegralImageBinarizerTest, LightingGradient)
+{
+	// a checkerboard of 20 pixel modules under a strong horizontal lighting gradient, which no global threshold can
+	// separate
+	const int width = 300, height = 200, module = 20;
+	std::vector<uint8_t> pixels(width * height);
+	for (int y = 0; y < height; ++y)
+		for (int x = 0; x < width; ++x)
+			pixels[y * width + x] = static_cast<uint8_t>(((x / module + y / module) % 2 ? 20 : 100) + x / 2);
+	auto source = std::make_shared<GenericLuminanceSource>(width, height, pixels.data(), width);
+
+	// close to the corners the window can lie within a single module, which then looks flat
+	auto matrix = IntegralImageBinarizer(source).getBlackMatrix();
+	ASSERT_NE(matrix, nullptr);
+	int errors = 0;
+	for (int y = module; y < height - module; ++y)
+		for (int x = module; x < width - module; ++x)
+			errors += matrix->get(x, y) != ((x / module + y / module) % 2 == 1);
+	EXPECT_EQ(errors, 0);
+
+	// the same through DecodeHints::binarizer
+	auto qr = Render(BarcodeFormat::QR_CODE, L"mean", 200, 200);
+	Matrix<uint8_t> lit(qr.width(), qr.height());
+	for (int y = 0; y < qr.height(); ++y)
+		for (int x = 0; x < qr.width(); ++x)
+			lit.set(x, y, static_cast<uint8_t>((qr.get(x, y) ? 100 : 20) + x * 150 / qr.width()));
+	auto result =
+		ReadBarcode(View(lit), DecodeHints().setFormats(BarcodeFormat::QR_CODE).setBinarizer(Binarizer::LocalMean));
+	EXPECT_EQ(result.text(), L"mean");
+}
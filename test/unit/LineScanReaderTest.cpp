@@ -0,0 +1,81 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "LineScanReader.h"
+#include "ImageUtility.h"
+
+#include "gtest/gtest.h"
+
+#include <vector>
+
+using namespace ZXing;
+using namespace ZXing::Utility;
+
+// pushes the rows of img one by one and returns the number of the row each result was completed in
+static std::vector<std::pair<int, Result>> PushRows(LineScanReader& reader, const Matrix<uint8_t>& img)
+{
+	std::vector<std::pair<int, Result>> res;
+	for (int y = 0; y < img.height(); ++y)
+		for (auto& result : reader.push({img.data() + y * img.width(), img.width(), 1, ImageFormat::Lum}))
+			res.emplace_back(reader.rowCount() - 1, std::move(result));
+	return res;
+}
+
+TEST(LineScanReaderTest, Code128)
+{
+	auto symbol = Render(BarcodeFormat::CODE_128, L"line", 300, 40);
+	Matrix<uint8_t> blank(symbol.width(), 100, 255);
+	LineScanReader reader(DecodeHints().setFormats(BarcodeFormat::CODE_128).setMinLineCount(3), 64);
+
+	EXPECT_TRUE(PushRows(reader, blank).empty());
+	auto results = PushRows(reader, symbol);
+	ASSERT_EQ(results.size(), 1);
+	// reported as soon as 3 rows agreed
+	EXPECT_EQ(results[0].first, 100 + 2);
+	EXPECT_EQ(results[0].second.text(), L"line");
+	EXPECT_EQ(results[0].second.position().topLeft().y, 100);
+
+	// a gap shorter than the window: still the same symbol
+	EXPECT_TRUE(PushRows(reader, Matrix<uint8_t>(symbol.width(), 30, 255)).empty());
+	EXPECT_TRUE(PushRows(reader, symbol).empty());
+
+	// after the window it is reported again
+	EXPECT_TRUE(PushRows(reader, blank).empty());
+	results = PushRows(reader, symbol);
+	ASSERT_EQ(results.size(), 1);
+	EXPECT_EQ(results[0].first, 100 + 40 + 30 + 40 + 100 + 2);
+	EXPECT_EQ(reader.rowCount(), 100 + 40 + 30 + 40 + 100 + 40);
+
+	reader.reset();
+	EXPECT_EQ(reader.rowCount(), 0);
+}
+
+TEST(LineScanReaderTest, MultipleRows)
+{
+	auto symbol = Render(BarcodeFormat::EAN_13, L"4006381333931", 200, 30);
+	// interleaved RGB blocks of several rows work as well
+	std::vector<uint8_t> rgb;
+	for (uint8_t v : std::vector<uint8_t>(symbol.data(), symbol.data() + symbol.size()))
+		rgb.insert(rgb.end(), {v, v, v});
+
+	LineScanReader reader;
+	auto results = reader.push({rgb.data(), symbol.width(), symbol.height(), ImageFormat::RGB});
+	ASSERT_EQ(results.size(), 1);
+	EXPECT_EQ(results[0].format(), BarcodeFormat::EAN_13);
+	EXPECT_EQ(results[0].text(), L"4006381333931");
+	EXPECT_EQ(results[0].lineCount(), 1);
+}
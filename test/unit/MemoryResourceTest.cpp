@@ -0,0 +1,224 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "MemoryResource.h"
+#include "BarcodeFormat.h"
+#include "BitMatrix.h"
+#include "DecodeHints.h"
+#include "GenericLuminanceSource.h"
+#include "HybridBinarizer.h"
+#include "ImageUtility.h"
+#include "MultiFormatReader.h"
+#include "ReadBarcode.h"
+
+#include "gtest/gtest.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+
+using namespace ZXing;
+using namespace ZXing::Utility;
+
+namespace {
+
+// forwards to the default resource and keeps track of what is still allocated
+class CountingResource : public MemoryResource
+{
+public:
+	int allocations = 0;
+	int largeAllocations = 0; // 1 KB or more
+	int64_t bytesInUse = 0;
+
+protected:
+	void* doAllocate(std::size_t bytes, std::size_t alignment) override
+	{
+		++allocations;
+		largeAllocations += bytes >= 1024;
+		bytesInUse += bytes;
+		return Default()->allocate(bytes, alignment);
+	}
+	void doDeallocate(void* p, std::size_t bytes, std::size_t alignment) noexcept override
+	{
+		bytesInUse -= bytes;
+		Default()->deallocate(p, bytes, alignment);
+	}
+};
+
+} // namespace
+
+TEST(MemoryResourceTest, Scope)
+{
+	CountingResource outer, inner;
+	EXPECT_EQ(MemoryResource::Current(), MemoryResource::Default());
+	{
+		MemoryResource::Scope outerScope(&outer);
+		Vector<int> a(10);
+		{
+			MemoryResource::Scope innerScope(&inner);
+			Vector<int> b(20);
+			EXPECT_EQ(b.get_allocator().resource(), &inner);
+
+			// copies use the current resource, moves keep the one of the source
+			auto c = a;
+			EXPECT_EQ(c.get_allocator().resource(), &inner);
+			b = std::move(a);
+			EXPECT_EQ(b.get_allocator().resource(), &outer);
+		}
+		EXPECT_EQ(MemoryResource::Current(), &outer);
+		EXPECT_EQ(inner.bytesInUse, 0);
+		EXPECT_EQ(outer.bytesInUse, 0);
+
+		MemoryResource::Scope nullScope(nullptr);
+		EXPECT_EQ(MemoryResource::Current(), MemoryResource::Default());
+	}
+	EXPECT_EQ(MemoryResource::Current(), MemoryResource::Default());
+	EXPECT_EQ(outer.allocations, 1);
+	EXPECT_EQ(inner.allocations, 2);
+}
+
+// constant initialized, so it is destroyed after every function local static, e.g. a default resource that is not
+// immortal
+static std::unique_ptr<BitMatrix> s_staticMatrix;
+
+TEST(MemoryResourceTest, DefaultOutlivesStatics)
+{
+	// the child process frees the matrix at exit, after the destructors of the function local statics have run
+	EXPECT_EXIT(
+		{
+			s_staticMatrix.reset(new BitMatrix(100, 100));
+			std::exit(0);
+		},
+		::testing::ExitedWithCode(0), "");
+}
+
+TEST(MemoryResourceTest, MonotonicBuffer)
+{
+	MonotonicBufferResource resource(256);
+	EXPECT_EQ(resource.allocatedBytes(), 0u);
+
+	auto* c = static_cast<char*>(resource.allocate(3, 1));
+	auto* d = static_cast<double*>(resource.allocate(sizeof(double), alignof(double)));
+	EXPECT_EQ(reinterpret_cast<std::uintptr_t>(d) % alignof(double), 0u);
+	EXPECT_GT(reinterpret_cast<char*>(d), c);
+	resource.deallocate(c, 3, 1); // no-op
+
+	// larger than the chunk size
+	auto* big = static_cast<char*>(resource.allocate(10000, 16));
+	EXPECT_EQ(reinterpret_cast<std::uintptr_t>(big) % 16, 0u);
+	big[9999] = 1;
+	EXPECT_GE(resource.allocatedBytes(), 10000u + 256u);
+
+	resource.release();
+	EXPECT_EQ(resource.allocatedBytes(), 0u);
+	EXPECT_NE(resource.allocate(8), nullptr);
+}
+
+TEST(MemoryResourceTest, ReadBarcode)
+{
+	auto img = Render(BarcodeFormat::QR_CODE, L"Arena", 200, 200);
+	auto view = View(img);
+
+	CountingResource counting;
+	auto result = ReadBarcode(view, DecodeHints().setMemoryResource(&counting));
+	ASSERT_TRUE(result.isValid());
+	EXPECT_EQ(result.text(), L"Arena");
+	// the binarized image at least, everything is freed again and nothing is left in the result
+	EXPECT_GT(counting.allocations, 0);
+	EXPECT_EQ(counting.bytesInUse, 0);
+
+	// a monotonic buffer per call, 1D readers included
+	auto ean = Render(BarcodeFormat::EAN_13, L"4006381333931", 200, 80);
+	for (int i = 0; i < 3; ++i) {
+		MonotonicBufferResource arena;
+		auto r = ReadBarcode(View(ean), DecodeHints().setMemoryResource(&arena).setRowScanThreads(2));
+		ASSERT_TRUE(r.isValid());
+		EXPECT_EQ(r.text(), L"4006381333931");
+		EXPECT_GT(arena.allocatedBytes(), 0u);
+	}
+}
+
+TEST(MemoryResourceTest, InstalledResource)
+{
+	auto img = Render(BarcodeFormat::QR_CODE, L"Scope", 200, 200);
+	GenericLuminanceSource source(img.width(), img.height(), img.data(), img.width());
+
+	// without a resource in the hints the reader keeps the one installed by the caller
+	CountingResource counting;
+	{
+		HybridBinarizer binarizer(source);
+		binarizer.getBlackMatrix();
+		MultiFormatReader reader(DecodeHints().setFormats(BarcodeFormat::QR_CODE));
+		MemoryResource::Scope scope(&counting);
+		EXPECT_TRUE(reader.read(binarizer).isValid());
+		EXPECT_GT(counting.allocations, 0);
+		int allocations = counting.allocations;
+		EXPECT_EQ(reader.readMultiple(binarizer).size(), 1);
+		EXPECT_GT(counting.allocations, allocations);
+	}
+	EXPECT_EQ(counting.bytesInUse, 0);
+}
+
+TEST(MemoryResourceTest, Recycling)
+{
+	CountingResource upstream;
+	{
+		RecyclingMemoryResource recycling(1024, 10000, &upstream);
+		void* a = recycling.allocate(2000);
+		recycling.deallocate(a, 2000);
+		EXPECT_EQ(recycling.cachedBytes(), 2000u);
+		EXPECT_EQ(recycling.allocate(2000), a);
+		EXPECT_EQ(recycling.cachedBytes(), 0u);
+		EXPECT_EQ(upstream.allocations, 1);
+
+		// different size or too small for the cache
+		void* b = recycling.allocate(3000);
+		void* c = recycling.allocate(100);
+		recycling.deallocate(c, 100);
+		EXPECT_EQ(upstream.bytesInUse, 5000);
+		EXPECT_EQ(upstream.allocations, 3);
+
+		// the oldest blocks go first when the cache is full
+		recycling.deallocate(a, 2000);
+		recycling.deallocate(b, 3000);
+		void* d = recycling.allocate(6000);
+		recycling.deallocate(d, 6000);
+		EXPECT_EQ(recycling.cachedBytes(), 9000u);
+		void* e = recycling.allocate(4000);
+		recycling.deallocate(e, 4000);
+		EXPECT_EQ(recycling.cachedBytes(), 10000u);
+		EXPECT_EQ(upstream.bytesInUse, 10000);
+	}
+	EXPECT_EQ(upstream.bytesInUse, 0);
+}
+
+TEST(MemoryResourceTest, RecycleFrames)
+{
+	auto img = Render(BarcodeFormat::QR_CODE, L"Frame", 400, 400);
+	auto view = View(img);
+
+	CountingResource upstream;
+	RecyclingMemoryResource recycling(1024, 64 * 1024 * 1024, &upstream);
+	BarcodeScanner scanner(DecodeHints().setBinarizer(Binarizer::LocalAverage).setMemoryResource(&recycling));
+
+	ASSERT_TRUE(scanner.read(view).isValid());
+	int firstFrame = upstream.largeAllocations;
+	EXPECT_GT(firstFrame, 0);
+	for (int i = 0; i < 3; ++i)
+		ASSERT_TRUE(scanner.read(view).isValid());
+	EXPECT_EQ(upstream.largeAllocations, firstFrame);
+}
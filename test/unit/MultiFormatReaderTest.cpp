@@ -0,0 +1,221 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "BitMatrix.h"
+#include "DecodeHints.h"
+#include "GenericLuminanceSource.h"
+#include "HybridBinarizer.h"
+#include "ImageUtility.h"
+#include "MultiFormatReader.h"
+#include "Pattern.h"
+#include "ReadBarcode.h"
+
+#include "gtest/gtest.h"
+
+#include <memory>
+
+using namespace ZXing;
+using namespace ZXing::Utility;
+
+// a 400x300 image with a QR Code on the left and/or a Code 128 on the right
+static Matrix<uint8_t> Image(bool qrCode, bool code128)
+{
+	Matrix<uint8_t> img(400, 300, 255);
+	if (qrCode)
+		Paste(img, Render(BarcodeFormat::QR_CODE, L"qr", 120, 120), 20, 90);
+	if (code128)
+		Paste(img, Render(BarcodeFormat::CODE_128, L"1d", 200, 60), 180, 120);
+	return img;
+}
+
+TEST(MultiFormatReaderTest, AdaptiveReaderOrder)
+{
+	auto hints = DecodeHints().setFormats(BarcodeFormat::QR_CODE | BarcodeFormat::CODE_128);
+	auto both = Image(true, true);
+	auto qrCode = Image(true, false);
+	auto code128 = Image(false, true);
+	auto read = [](const BarcodeScanner& scanner, const Matrix<uint8_t>& img) { return scanner.read(View(img)); };
+
+	// fixed order: the 1D reader comes first
+	BarcodeScanner fixed(hints);
+	for (int i = 0; i < 5; ++i)
+		EXPECT_EQ(read(fixed, qrCode).format(), BarcodeFormat::QR_CODE);
+	EXPECT_EQ(read(fixed, both).format(), BarcodeFormat::CODE_128);
+
+	BarcodeScanner adaptive(DecodeHints(hints).setAdaptiveReaderOrder(true));
+	EXPECT_EQ(read(adaptive, both).format(), BarcodeFormat::CODE_128);
+	for (int i = 0; i < 5; ++i)
+		EXPECT_EQ(read(adaptive, qrCode).format(), BarcodeFormat::QR_CODE);
+	// after a run of QR Codes their reader is tried first
+	EXPECT_EQ(read(adaptive, both).format(), BarcodeFormat::QR_CODE);
+
+	// images with a single symbol are found regardless of the order
+	for (int i = 0; i < 20; ++i) {
+		auto result = read(adaptive, code128);
+		EXPECT_EQ(result.format(), BarcodeFormat::CODE_128);
+		EXPECT_EQ(result.text(), L"1d");
+	}
+	EXPECT_EQ(read(adaptive, both).format(), BarcodeFormat::CODE_128);
+
+	// nothing found leaves the order as it was
+	for (int i = 0; i < 20; ++i)
+		EXPECT_FALSE(read(adaptive, Image(false, false)).isValid());
+	EXPECT_EQ(read(adaptive, both).format(), BarcodeFormat::CODE_128);
+}
+
+TEST(MultiFormatReaderTest, TryParallel)
+{
+	auto hints = DecodeHints().setFormats(BarcodeFormat::QR_CODE | BarcodeFormat::CODE_128);
+	auto parallel = DecodeHints(hints).setTryParallel(true);
+
+	for (int symbols : {1, 2, 3}) {
+		auto img = Image(symbols & 1, symbols & 2);
+		auto view = View(img);
+		auto sequential = ReadBarcode(view, hints);
+		ASSERT_TRUE(sequential.isValid());
+		// the readers race on the same image, the result is the one of the sequential order nevertheless
+		for (int i = 0; i < 10; ++i) {
+			auto result = ReadBarcode(view, parallel);
+			ASSERT_TRUE(result.isValid());
+			EXPECT_EQ(result.format(), sequential.format());
+			EXPECT_EQ(result.text(), sequential.text());
+			EXPECT_EQ(result.position(), sequential.position());
+		}
+	}
+
+	// both readers find a symbol in this one, the 1D reader has the higher priority
+	auto both = Image(true, true);
+	EXPECT_TRUE(ReadBarcode(View(both), DecodeHints(parallel).setFormats(BarcodeFormat::QR_CODE)).isValid());
+	EXPECT_EQ(ReadBarcode(View(both), parallel).format(), BarcodeFormat::CODE_128);
+}
+
+TEST(MultiFormatReaderTest, TryInvert)
+{
+	auto img = Image(true, true);
+	for (int y = 0; y < img.height(); ++y)
+		for (int x = 0; x < img.width(); ++x)
+			img(x, y) = 255 - img(x, y);
+	auto view = View(img);
+	auto hints = DecodeHints().setFormats(BarcodeFormat::QR_CODE | BarcodeFormat::CODE_128);
+
+	EXPECT_FALSE(ReadBarcode(view, hints).isValid());
+
+	hints.setTryInvert(true);
+	for (auto binarizer : {Binarizer::LocalAverage, Binarizer::GlobalHistogram, Binarizer::FixedThreshold}) {
+		auto result = ReadBarcode(view, DecodeHints(hints).setBinarizer(binarizer));
+		ASSERT_TRUE(result.isValid()) << static_cast<int>(binarizer);
+		EXPECT_TRUE(result.isInverted());
+		EXPECT_EQ(result.format(), BarcodeFormat::CODE_128);
+	}
+
+	auto results = ReadBarcodes(view, hints);
+	ASSERT_EQ(results.size(), 2);
+	EXPECT_TRUE(results[0].isInverted() && results[1].isInverted());
+
+	// a symbol found without inverting is not flagged
+	auto normal = Image(false, true);
+	auto result = ReadBarcode(View(normal), hints);
+	ASSERT_TRUE(result.isValid());
+	EXPECT_FALSE(result.isInverted());
+}
+
+TEST(MultiFormatReaderTest, NonOwningSource)
+{
+	auto img = Image(true, true);
+	GenericLuminanceSource source(400, 300, img.data(), 400);
+	HybridBinarizer binarizer(source);
+	auto hints = DecodeHints().setFormats(BarcodeFormat::QR_CODE | BarcodeFormat::CODE_128);
+
+	// the reference is the one kept from the first call
+	auto matrix = binarizer.getBitMatrix();
+	ASSERT_NE(matrix, nullptr);
+	EXPECT_EQ(matrix, binarizer.getBlackMatrix().get());
+	EXPECT_EQ(matrix, binarizer.getBitMatrix());
+
+	EXPECT_TRUE(MultiFormatReader(hints).read(binarizer).isValid());
+	// readMultiple masks out each symbol found (a change of the matrix the readers see) before the next attempt
+	EXPECT_EQ(MultiFormatReader(hints).readMultiple(binarizer).size(), 2);
+}
+
+TEST(MultiFormatReaderTest, ReadMultiple)
+{
+	auto img = Image(true, true);
+	GenericLuminanceSource source(400, 300, img.data(), 400);
+	HybridBinarizer binarizer(source);
+	MultiFormatReader reader(DecodeHints().setFormats(BarcodeFormat::QR_CODE | BarcodeFormat::CODE_128));
+	auto before = binarizer.getBlackMatrix()->copy();
+
+	auto results = reader.readMultiple(binarizer);
+	ASSERT_EQ(results.size(), 2);
+	EXPECT_NE(results[0].format(), results[1].format());
+	// the masking happens on a copy, the matrix of the binarizer is left as it was
+	EXPECT_EQ(*binarizer.getBlackMatrix(), before);
+
+	EXPECT_EQ(reader.readMultiple(binarizer, 1).size(), 1);
+	auto blank = Image(false, false);
+	EXPECT_TRUE(reader.readMultiple(HybridBinarizer(GenericLuminanceSource(400, 300, blank.data(), 400))).empty());
+}
+
+TEST(MultiFormatReaderTest, InvertPatternRow)
+{
+	PatternRow row = {3, 2, 1, 4, 0};
+	InvertPatternRow(row);
+	EXPECT_EQ(row, PatternRow({0, 3, 2, 1, 4}));
+	InvertPatternRow(row);
+	EXPECT_EQ(row, PatternRow({3, 2, 1, 4, 0}));
+
+	row = {5};
+	InvertPatternRow(row);
+	EXPECT_EQ(row, PatternRow({0, 5, 0}));
+}
+
+TEST(MultiFormatReaderTest, ExpectedGeometry)
+{
+	// the QR Code in Image() is a version 1 symbol with modules of 4 pixels
+	auto img = Image(true, false);
+	auto view = View(img);
+	auto hints = DecodeHints().setFormats(BarcodeFormat::QR_CODE);
+
+	auto matching = DecodeHints(hints).setExpectedDimension(21).setExpectedRotation(0);
+	auto result = ReadBarcode(view, matching.setMinModuleSize(3).setMaxModuleSize(6));
+	ASSERT_TRUE(result.isValid());
+	EXPECT_EQ(result.text(), L"qr");
+
+	EXPECT_FALSE(ReadBarcode(view, DecodeHints(hints).setExpectedRotation(180)).isValid());
+	EXPECT_FALSE(ReadBarcode(view, DecodeHints(hints).setMaxModuleSize(2)).isValid());
+	EXPECT_FALSE(ReadBarcode(view, DecodeHints(hints).setMinModuleSize(8)).isValid());
+}
+
+TEST(MultiFormatReaderTest, ScanStride)
+{
+	// symbols with modules of several pixels are still found when every detector scans only every 3rd line/edge
+	for (auto format : {BarcodeFormat::QR_CODE, BarcodeFormat::DATA_MATRIX, BarcodeFormat::AZTEC,
+						BarcodeFormat::PDF_417, BarcodeFormat::CODE_128}) {
+		Matrix<uint8_t> img(400, 300, 255);
+		Paste(img, Render(format, L"stride", 240, 160), 60, 60);
+		auto view = View(img);
+		auto hints = DecodeHints().setFormats(format).setTryHarder(false).setScanStride(3);
+
+		auto result = ReadBarcode(view, hints);
+		ASSERT_TRUE(result.isValid()) << ToString(format);
+		EXPECT_EQ(result.text(), L"stride");
+
+		auto results = ReadBarcodes(view, hints);
+		ASSERT_EQ(results.size(), 1) << ToString(format);
+		EXPECT_EQ(results.front().text(), L"stride");
+	}
+}
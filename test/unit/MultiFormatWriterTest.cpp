@@ -0,0 +1,178 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "MultiFormatWriter.h"
+#include "BarcodeFormat.h"
+#include "BitMatrix.h"
+#include "BitMatrixIO.h"
+
+#include "gtest/gtest.h"
+
+#include <array>
+#include <stdexcept>
+#include <vector>
+
+using namespace ZXing;
+
+// pixel of the raster drawn by InflateInto, computed the slow way
+static bool IsBlack(const BitMatrix& m, int width, int height, int x, int y)
+{
+	bool linear = m.height() == 1;
+	int scale = linear ? width / m.width() : std::min(width / m.width(), height / m.height());
+	int moduleHeight = linear ? height : scale;
+	int left = (width - m.width() * scale) / 2;
+	int top = (height - m.height() * moduleHeight) / 2;
+	if (x < left || y < top || x >= left + m.width() * scale || y >= top + m.height() * moduleHeight)
+		return false;
+	return m.get((x - left) / scale, (y - top) / moduleHeight);
+}
+
+TEST(MultiFormatWriterTest, InflateInto)
+{
+	auto matrix = ParseBitMatrix("X X\n"
+								 " XX\n", 'X', false);
+	std::vector<uint8_t> lum(8 * 5);
+	InflateInto(matrix, lum.data(), 8, 5, RasterFormat::Lum);
+	std::string expected = "-XX--XX-"
+						   "-XX--XX-"
+						   "---XXXX-"
+						   "---XXXX-"
+						   "--------";
+	for (int i = 0; i < Size(lum); ++i)
+		EXPECT_EQ(lum[i], expected[i] == 'X' ? 0 : 255) << i;
+
+	// a linear barcode is stretched over the full height
+	auto linear = ParseBitMatrix("X XX\n", 'X', false);
+	std::vector<uint8_t> mono(2 * 3, 0xAA);
+	InflateInto(linear, mono.data(), 10, 3, RasterFormat::Mono, 2);
+	for (int y = 0; y < 3; ++y) {
+		EXPECT_EQ(mono[2 * y], 0b01100111);
+		EXPECT_EQ(mono[2 * y + 1], 0b10000000);
+	}
+
+	EXPECT_THROW(InflateInto(matrix, lum.data(), 2, 5, RasterFormat::Lum), std::invalid_argument);
+}
+
+TEST(MultiFormatWriterTest, Render)
+{
+	const int width = 203, height = 131;
+	for (auto format : {BarcodeFormat::AZTEC, BarcodeFormat::DATA_MATRIX, BarcodeFormat::PDF_417, BarcodeFormat::QR_CODE,
+						BarcodeFormat::CODE_128, BarcodeFormat::EAN_13}) {
+		MultiFormatWriter writer(format);
+		std::wstring contents = format == BarcodeFormat::EAN_13 ? L"123456789012" : L"Hello World";
+		auto symbol = writer.encode(contents, 0, 0);
+
+		// strides are padded, the padding must not be touched
+		const int lumStride = width + 5, monoStride = (width + 7) / 8 + 3;
+		std::vector<uint8_t> lum(height * lumStride, 0x42), mono(height * monoStride, 0x42);
+		writer.render(contents, lum.data(), width, height, RasterFormat::Lum, lumStride);
+		writer.render(contents, mono.data(), width, height, RasterFormat::Mono, monoStride);
+
+		for (int y = 0; y < height; ++y) {
+			for (int x = 0; x < width; ++x) {
+				bool black = IsBlack(symbol, width, height, x, y);
+				ASSERT_EQ(lum[y * lumStride + x], black ? 0 : 255) << ToString(format) << " " << x << "," << y;
+				ASSERT_EQ((mono[y * monoStride + x / 8] >> (7 - x % 8)) & 1, black) << ToString(format) << " " << x << "," << y;
+			}
+			for (int i = width; i < lumStride; ++i)
+				ASSERT_EQ(lum[y * lumStride + i], 0x42);
+			for (int i = (width + 7) / 8; i < monoStride; ++i)
+				ASSERT_EQ(mono[y * monoStride + i], 0x42);
+		}
+	}
+}
+
+TEST(MultiFormatWriterTest, ForEachRectangle)
+{
+	for (auto format : {BarcodeFormat::DATA_MATRIX, BarcodeFormat::PDF_417, BarcodeFormat::QR_CODE, BarcodeFormat::CODE_128}) {
+		auto symbol = MultiFormatWriter(format).encode(L"Hello World");
+		BitMatrix covered(symbol.width(), symbol.height());
+		int count = 0;
+		ForEachRectangle(symbol, [&](int left, int top, int width, int height) {
+			for (int y = top; y < top + height; ++y)
+				for (int x = left; x < left + width; ++x) {
+					ASSERT_TRUE(symbol.get(x, y));
+					ASSERT_FALSE(covered.get(x, y));
+					covered.set(x, y);
+				}
+			++count;
+		});
+		EXPECT_EQ(covered, symbol) << ToString(format);
+		if (format == BarcodeFormat::CODE_128)
+			EXPECT_EQ(count, 13 * 3 + 4); // one rectangle per bar: 3 per symbol (start, 11 chars, checksum) + 4 for stop
+	}
+
+	auto matrix = ParseBitMatrix("XX X\n"
+								 "XX X\n"
+								 " XXX\n", 'X', false);
+	std::vector<std::array<int, 4>> rects;
+	ForEachRectangle(matrix, [&](int l, int t, int w, int h) { rects.push_back({l, t, w, h}); });
+	EXPECT_EQ(rects, (std::vector<std::array<int, 4>>{{0, 0, 2, 2}, {3, 0, 1, 2}, {1, 2, 3, 1}}));
+}
+
+TEST(MultiFormatWriterTest, RasterOutput)
+{
+	auto symbol = MultiFormatWriter(BarcodeFormat::QR_CODE).encode(L"Hello World");
+	int scale = 3, quietZone = 2;
+	int width = (symbol.width() + 2 * quietZone) * scale, stride = (width + 7) / 8;
+
+	auto pbm = ToPBM(symbol, scale, quietZone);
+	std::string header = "P4\n" + std::to_string(width) + " " + std::to_string(width) + "\n";
+	ASSERT_EQ(pbm.substr(0, header.size()), header);
+	ASSERT_EQ(pbm.size(), header.size() + stride * width);
+	for (int y = 0; y < width; ++y)
+		for (int x = 0; x < width; ++x) {
+			int mx = x / scale - quietZone, my = y / scale - quietZone;
+			bool black = mx >= 0 && my >= 0 && mx < symbol.width() && my < symbol.height() && symbol.get(mx, my);
+			ASSERT_EQ(black, (pbm[header.size() + y * stride + x / 8] & (0x80 >> (x % 8))) != 0) << x << "," << y;
+		}
+
+	auto png = ToPNG(symbol, scale, quietZone);
+	ASSERT_EQ(png.substr(0, 16), std::string("\x89PNG\r\n\x1a\n\0\0\0\x0dIHDR", 16));
+	auto size = std::string(3, '\0') + static_cast<char>(width);
+	EXPECT_EQ(png.substr(16, 13), size + size + std::string("\x01\0\0\0\0", 5)); // bit depth 1, grayscale
+	EXPECT_EQ(png.substr(png.size() - 12), std::string("\0\0\0\0IEND\xae\x42\x60\x82", 12));
+
+	// a white row is coded as V0 followed by the two EOL codes of the EOFB: 1 000000000001 000000000001
+	auto tiff = ToTIFF(BitMatrix(8, 1));
+	ASSERT_EQ(tiff.substr(0, 4), std::string("II*\0", 4));
+	EXPECT_EQ(tiff.substr(8, 4), std::string("\x80\x08\x00\x80", 4));
+	EXPECT_LT(ToTIFF(symbol, scale, quietZone).size(), pbm.size());
+}
+
+TEST(MultiFormatWriterTest, EncodeBatch)
+{
+	std::vector<std::wstring> contents;
+	for (int i = 0; i < 50; ++i)
+		contents.push_back(L"Item " + std::to_wstring(i * 7919));
+	contents[17].clear(); // can not be encoded
+
+	MultiFormatWriter writer(BarcodeFormat::QR_CODE);
+	std::vector<BitMatrix> results(contents.size());
+	std::vector<int> calls(contents.size(), 0);
+	writer.encodeBatch(contents, 100, 100, [&](int i, BitMatrix&& matrix) {
+		results[i] = std::move(matrix);
+		++calls[i]; // each index is reported once, so there is no concurrent access to the same element
+	}, 4);
+
+	for (int i = 0; i < Size(contents); ++i) {
+		EXPECT_EQ(calls[i], 1);
+		if (i == 17)
+			EXPECT_TRUE(results[i].empty());
+		else
+			EXPECT_EQ(results[i], writer.encode(contents[i], 100, 100)) << i;
+	}
+}
@@ -0,0 +1,69 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "Parallel.h"
+
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+using namespace ZXing;
+
+TEST(ParallelTest, Nested)
+{
+	// batch -> image -> band, every task runs exactly once
+	std::vector<std::atomic<int>> counts(8 * 8 * 8);
+	ParallelFor(8, [&](int i) {
+		ParallelFor(8, [&](int j) {
+			ParallelFor(8, [&](int k) { ++counts[(i * 8 + j) * 8 + k]; });
+		});
+	});
+	for (auto& count : counts)
+		EXPECT_EQ(count, 1);
+}
+
+TEST(ParallelTest, Exception)
+{
+	std::atomic<int> count{0};
+	EXPECT_THROW(ParallelFor(16,
+							 [&](int i) {
+								 ++count;
+								 if (i == 5)
+									 throw std::runtime_error("task 5");
+							 }),
+				 std::runtime_error);
+	// the other tasks still ran before the exception was rethrown
+	EXPECT_EQ(count, 16);
+}
+
+TEST(ParallelTest, CustomExecutor)
+{
+	int calls = 0;
+	SetParallelExecutor([&calls](int numTasks, const std::function<void(int)>& task) {
+		++calls;
+		for (int i = 0; i < numTasks; ++i)
+			task(i);
+	});
+	int sum = 0;
+	ParallelFor(4, [&](int i) { sum += i; });
+	SetParallelExecutor({});
+
+	EXPECT_EQ(calls, 1);
+	EXPECT_EQ(sum, 6);
+}
@@ -0,0 +1,448 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "ReadBarcode.h"
+#include "Deadline.h"
+#include "DecodeStats.h"
+#include "ImageUtility.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace ZXing;
+using namespace ZXing::Utility;
+
+TEST(ReadBarcodeTest, BarcodeScanner)
+{
+	auto qr = Render(BarcodeFormat::QR_CODE, L"scanner", 120, 120);
+	auto dm = Render(BarcodeFormat::DATA_MATRIX, L"matrix", 90, 90);
+	auto hints = DecodeHints().setFormats(BarcodeFormat::QR_CODE | BarcodeFormat::DATA_MATRIX);
+	BarcodeScanner scanner(hints);
+	EXPECT_EQ(scanner.hints().formats(), hints.formats());
+
+	// images of different sizes and formats one after the other, the buffers of the previous ones are reused
+	std::vector<uint8_t> rgb(3 * qr.width() * qr.height());
+	for (int i = 0; i < qr.width() * qr.height(); ++i)
+		std::fill_n(rgb.data() + 3 * i, 3, qr.data()[i]);
+	for (int i = 0; i < 3; ++i) {
+		EXPECT_EQ(scanner.read(View(qr)).text(), L"scanner");
+		EXPECT_EQ(scanner.read(View(dm)).text(), L"matrix");
+		EXPECT_EQ(scanner.read(ImageView(rgb.data(), qr.width(), qr.height(), ImageFormat::RGB)).text(), L"scanner");
+	}
+	auto result = scanner.read(View(qr));
+	EXPECT_EQ(result.position().topLeft(), ReadBarcode(View(qr), hints).position().topLeft());
+
+	// one instance shared by several threads
+	std::atomic<int> decoded{0};
+	std::vector<std::thread> threads;
+	for (int t = 0; t < 4; ++t)
+		threads.emplace_back([&, t] {
+			for (int i = 0; i < 10; ++i)
+				decoded += scanner.read(View((t + i) % 2 ? qr : dm)).isValid();
+		});
+	for (auto& thread : threads)
+		thread.join();
+	EXPECT_EQ(decoded, 40);
+
+	BarcodeScanner moved(std::move(scanner));
+	EXPECT_EQ(moved.read(View(dm)).text(), L"matrix");
+	EXPECT_EQ(moved.hints().formats(), hints.formats());
+}
+
+TEST(ReadBarcodeTest, ReadBarcodes)
+{
+	Matrix<uint8_t> img(800, 500, 255);
+	Paste(img, Render(BarcodeFormat::QR_CODE, L"qr", 150, 150), 20, 20);
+	Paste(img, Render(BarcodeFormat::DATA_MATRIX, L"dm", 120, 120), 250, 20);
+	Paste(img, Render(BarcodeFormat::AZTEC, L"aztec", 150, 150), 450, 20);
+	Paste(img, Render(BarcodeFormat::PDF_417, L"pdf417", 300, 120), 20, 250);
+	Paste(img, Render(BarcodeFormat::EAN_13, L"4006381333931", 250, 100), 450, 300);
+	auto view = View(img);
+
+	auto results = ReadBarcodes(view);
+	std::vector<std::wstring> texts;
+	for (auto& result : results)
+		texts.push_back(result.text());
+	std::sort(texts.begin(), texts.end());
+	EXPECT_EQ(texts, std::vector<std::wstring>({L"4006381333931", L"aztec", L"dm", L"pdf417", L"qr"}));
+
+	EXPECT_EQ(ReadBarcodes(view, DecodeHints().setMaxNumberOfSymbols(3)).size(), 3);
+	EXPECT_EQ(BarcodeScanner().readMultiple(view).size(), 5);
+	EXPECT_EQ(ReadBarcodes(view, DecodeHints().setFormats(BarcodeFormat::DATA_MATRIX)).size(), 1);
+
+	Matrix<uint8_t> blank(300, 200, 255);
+	EXPECT_TRUE(ReadBarcodes(View(blank)).empty());
+}
+
+TEST(ReadBarcodeTest, CascadeAttempts)
+{
+	auto attempts = CascadeAttempts(DecodeHints());
+	ASSERT_EQ(attempts.size(), 6);
+	EXPECT_EQ(attempts[0].binarizer, Binarizer::LocalAverage);
+	EXPECT_EQ(attempts[1].binarizer, Binarizer::GlobalHistogram);
+	EXPECT_FALSE(attempts[1].tryRotate);
+	EXPECT_TRUE(attempts[2].tryRotate);
+	EXPECT_FALSE(attempts[3].tryHarder);
+	EXPECT_TRUE(attempts[5].tryRotate && attempts[5].tryHarder);
+
+	auto hints = DecodeHints().setBinarizer(Binarizer::FixedThreshold).setTryRotate(true).setTryHarder(true);
+	attempts = CascadeAttempts(hints);
+	ASSERT_EQ(attempts.size(), 3);
+	EXPECT_EQ(attempts[0].binarizer, Binarizer::FixedThreshold);
+	EXPECT_EQ(attempts[2].binarizer, Binarizer::GlobalHistogram);
+}
+
+TEST(ReadBarcodeTest, Cascade)
+{
+	auto upright = Render(BarcodeFormat::CODE_128, L"cascade", 200, 60);
+	Matrix<uint8_t> rotated(upright.height(), upright.width());
+	for (int y = 0; y < upright.height(); ++y)
+		for (int x = 0; x < upright.width(); ++x)
+			rotated.set(upright.height() - 1 - y, x, upright.get(x, y));
+
+	auto hints = DecodeHints().setFormats(BarcodeFormat::CODE_128);
+	EXPECT_FALSE(ReadBarcode(View(rotated), hints).isValid());
+	EXPECT_EQ(ReadBarcode(View(upright), hints).cascadeAttempt(), -1);
+
+	hints.setTryCascade(true);
+	EXPECT_EQ(ReadBarcode(View(upright), hints).cascadeAttempt(), 0);
+	auto result = ReadBarcode(View(rotated), hints);
+	ASSERT_TRUE(result.isValid());
+	EXPECT_EQ(result.text(), L"cascade");
+	// the first attempt with tryRotate
+	EXPECT_EQ(result.cascadeAttempt(), 2);
+
+	// a symbol outside of the middle half of the image is only scanned by the attempts with tryHarder
+	Matrix<uint8_t> tall(400, 640, 255);
+	Paste(tall, upright, 100, 20);
+	EXPECT_FALSE(ReadBarcode(View(tall), DecodeHints(hints).setTryCascade(false).setTryRotate(true)).isValid());
+	result = ReadBarcode(View(tall), hints);
+	ASSERT_TRUE(result.isValid());
+	EXPECT_EQ(result.text(), L"cascade");
+	EXPECT_EQ(result.cascadeAttempt(), 4);
+	EXPECT_TRUE(CascadeAttempts(hints)[4].tryHarder);
+
+	// a scanner that saw mostly rotated symbols tries rotating first
+	BarcodeScanner scanner(hints);
+	for (int i = 0; i < 3; ++i)
+		EXPECT_EQ(scanner.read(View(rotated)).cascadeAttempt(), 2);
+	EXPECT_EQ(scanner.read(View(upright)).cascadeAttempt(), 2);
+
+	// the timeout covers the whole cascade
+	Matrix<uint8_t> blank(2000, 2000, 255);
+	EXPECT_EQ(BarcodeScanner(DecodeHints(hints).setTimeout(std::chrono::milliseconds(1))).read(View(blank)).status(),
+			  DecodeStatus::Timeout);
+}
+
+TEST(ReadBarcodeTest, Timeout)
+{
+	using namespace std::chrono;
+	auto qr = Render(BarcodeFormat::QR_CODE, L"in time", 120, 120);
+	EXPECT_EQ(ReadBarcode(View(qr), DecodeHints().setTimeout(seconds(10))).text(), L"in time");
+
+	// noise keeps the readers busy for seconds with tryHarder
+	std::vector<uint8_t> noise(2000 * 2000);
+	for (size_t i = 0; i < noise.size(); ++i)
+		noise[i] = (i * 7919 + i / 2000 * 104729) % 251;
+	ImageView view(noise.data(), 2000, 2000, ImageFormat::Lum);
+	auto hints = DecodeHints().setTryHarder(true).setTimeout(milliseconds(1));
+	auto start = steady_clock::now();
+	EXPECT_EQ(ReadBarcode(view, hints).status(), DecodeStatus::Timeout);
+	EXPECT_TRUE(ReadBarcodes(view, hints).empty());
+	EXPECT_LT(steady_clock::now() - start, seconds(2));
+
+	// a cancellable deadline of the caller stops a read running on another thread
+	auto deadline = Deadline::Cancellable();
+	DecodeStatus status = DecodeStatus::NoError;
+	std::thread reader([&] {
+		Deadline::Scope scope(deadline);
+		status = ReadBarcode(view, DecodeHints().setTryHarder(true)).status();
+	});
+	std::this_thread::sleep_for(milliseconds(20));
+	deadline.cancel();
+	reader.join();
+	EXPECT_EQ(status, DecodeStatus::Timeout);
+}
+
+TEST(ReadBarcodeTest, BinarizerThreads)
+{
+	auto qr = Render(BarcodeFormat::QR_CODE, L"bands", 300, 300);
+	auto view = View(qr);
+	auto hints = DecodeHints().setFormats(BarcodeFormat::QR_CODE);
+	auto expected = ReadBarcode(view, hints);
+	ASSERT_TRUE(expected.isValid());
+	for (int threads : {2, 4, 64}) {
+		auto result = ReadBarcode(view, DecodeHints(hints).setBinarizerThreads(threads));
+		EXPECT_EQ(result.text(), L"bands");
+		EXPECT_EQ(result.position(), expected.position());
+	}
+}
+
+TEST(ReadBarcodeTest, Tiled)
+{
+	// tiles of 600 pixels starting every 450 pixels, "left" lies in the overlap of the first two columns of tiles
+	Matrix<uint8_t> img(1500, 1000, 255);
+	Paste(img, Render(BarcodeFormat::QR_CODE, L"left", 120, 120), 460, 100);
+	Paste(img, Render(BarcodeFormat::QR_CODE, L"right", 120, 120), 1300, 800);
+	auto view = View(img);
+	auto hints = DecodeHints().setFormats(BarcodeFormat::QR_CODE).setMaxSymbolSize(150);
+
+	auto results = ReadBarcodes(view, hints);
+	ASSERT_EQ(results.size(), 2);
+	std::sort(results.begin(), results.end(), [](const Result& a, const Result& b) { return a.text() < b.text(); });
+	EXPECT_EQ(results[0].text(), L"left");
+	EXPECT_EQ(results[1].text(), L"right");
+	// positions in the coordinates of the whole image
+	EXPECT_GT(results[0].position().topLeft().x, 460);
+	EXPECT_LT(results[0].position().topLeft().x, 480);
+	EXPECT_GT(results[1].position().topLeft().y, 800);
+
+	auto result = ReadBarcode(view, hints);
+	ASSERT_TRUE(result.isValid());
+	EXPECT_EQ(result.text(), L"left");
+
+	EXPECT_EQ(ReadBarcodes(view, DecodeHints(hints).setMaxNumberOfSymbols(1)).size(), 1);
+
+	// all tiles share the deadline of the call, the one of the caller without a timeout of its own
+	auto expired = Deadline::Cancellable();
+	expired.cancel();
+	{
+		Deadline::Scope scope(expired);
+		EXPECT_EQ(ReadBarcode(view, hints).status(), DecodeStatus::Timeout);
+		EXPECT_TRUE(ReadBarcodes(view, hints).empty());
+	}
+	Matrix<uint8_t> blank(4000, 4000, 255);
+	auto blankView = View(blank);
+	EXPECT_EQ(ReadBarcode(blankView, DecodeHints(hints).setTimeout(std::chrono::milliseconds(1))).status(),
+			  DecodeStatus::Timeout);
+}
+
+TEST(ReadBarcodeTest, RegionsOfInterest)
+{
+	Matrix<uint8_t> img(800, 600, 255);
+	Paste(img, Render(BarcodeFormat::QR_CODE, L"top", 120, 120), 50, 50);
+	Paste(img, Render(BarcodeFormat::QR_CODE, L"bottom", 120, 120), 500, 400);
+	auto view = View(img);
+
+	// a cropped view shares the pixels and is clamped to the image
+	auto crop = view.cropped(500, 400, 400, 400);
+	EXPECT_EQ(crop.width(), 300);
+	EXPECT_EQ(crop.height(), 200);
+	EXPECT_EQ(crop.rowStride(), view.rowStride());
+	EXPECT_EQ(crop.data(0, 0), view.data(500, 400));
+	EXPECT_EQ(view.cropped(-10, -10, 30, 30).width(), 20);
+	EXPECT_EQ(view.cropped(900, 0, 10, 10).width(), 0);
+	// Mono12Packed keeps whole pixel pairs
+	uint8_t mono12[12] = {};
+	auto packed = ImageView(mono12, 8, 1, ImageFormat::Mono12Packed).cropped(3, 0, 4, 1);
+	EXPECT_EQ(packed.width(), 6);
+	EXPECT_EQ(packed.data(0, 0), mono12 + 3);
+
+	auto hints = DecodeHints().setFormats(BarcodeFormat::QR_CODE);
+	auto bottom = ImageRegion{480, 380, 180, 180};
+	auto top = ImageRegion{-50, -50, 250, 250};
+
+	// only the regions are scanned, positions are in the coordinates of the whole image
+	auto result = ReadBarcode(view, DecodeHints(hints).setRegionsOfInterest({bottom}));
+	ASSERT_TRUE(result.isValid());
+	EXPECT_EQ(result.text(), L"bottom");
+	EXPECT_GT(result.position().topLeft().x, 500);
+	EXPECT_GT(result.position().topLeft().y, 400);
+	result = ReadBarcode(view, DecodeHints(hints).setRegionsOfInterest({top}));
+	ASSERT_TRUE(result.isValid());
+	EXPECT_EQ(result.text(), L"top");
+	EXPECT_GT(result.position().topLeft().x, 50);
+	EXPECT_LT(result.position().topLeft().x, 80);
+	EXPECT_EQ(ReadBarcode(view, DecodeHints(hints).setRegionsOfInterest({{200, 200, 200, 100}})).status(),
+			  DecodeStatus::NotFound);
+	EXPECT_EQ(ReadBarcode(view, DecodeHints(hints).setRegionsOfInterest({{900, 0, 100, 100}})).status(),
+			  DecodeStatus::NotFound);
+
+	// the regions are tried in the given order
+	EXPECT_EQ(ReadBarcode(view, DecodeHints(hints).setRegionsOfInterest({bottom, top})).text(), L"bottom");
+	auto results = ReadBarcodes(view, DecodeHints(hints).setRegionsOfInterest({bottom, top}));
+	ASSERT_EQ(results.size(), 2);
+	EXPECT_EQ(results[0].text(), L"bottom");
+	EXPECT_EQ(results[1].text(), L"top");
+	EXPECT_LT(results[1].position().topLeft().x, 80);
+	auto first = DecodeHints(hints).setRegionsOfInterest({bottom, top}).setMaxNumberOfSymbols(1);
+	EXPECT_EQ(ReadBarcodes(view, first).size(), 1);
+}
+
+TEST(ReadBarcodeTest, PyramidDeadline)
+{
+	Matrix<uint8_t> blank(800, 800, 255);
+	auto view = View(blank);
+	auto hints = DecodeHints().setFormats(BarcodeFormat::QR_CODE).setTryDownscale(true).setDownscaleThreshold(200);
+
+	DecodeStats all;
+	EXPECT_EQ(ReadBarcode(view, DecodeHints(hints).setStats(&all)).status(), DecodeStatus::NotFound);
+
+	// an expired deadline stops the pyramid after the coarsest level, the finer ones are not even binarized
+	auto expired = Deadline::Cancellable();
+	expired.cancel();
+	Deadline::Scope scope(expired);
+	DecodeStats coarsest;
+	EXPECT_EQ(ReadBarcode(view, DecodeHints(hints).setStats(&coarsest)).status(), DecodeStatus::Timeout);
+	EXPECT_LT(coarsest.allocations(), all.allocations());
+}
+
+TEST(ReadBarcodeTest, PyramidMultiple)
+{
+	Matrix<uint8_t> img(1200, 800, 255);
+	Paste(img, Render(BarcodeFormat::QR_CODE, L"large", 600, 600), 50, 100);
+	Paste(img, Render(BarcodeFormat::QR_CODE, L"small", 120, 120), 900, 600);
+	auto view = View(img);
+	auto hints = DecodeHints().setFormats(BarcodeFormat::QR_CODE).setDownscaleThreshold(200);
+
+	auto sorted = [](Results results) {
+		std::sort(results.begin(), results.end(), [](const Result& a, const Result& b) { return a.text() < b.text(); });
+		return results;
+	};
+	DecodeStats fullStats, pyramidStats;
+	auto full = sorted(ReadBarcodes(view, DecodeHints(hints).setStats(&fullStats)));
+	// all levels are scanned, a symbol found on several of them is reported once, in full resolution coordinates
+	auto pyramid = sorted(ReadBarcodes(view, DecodeHints(hints).setTryDownscale(true).setStats(&pyramidStats)));
+	ASSERT_EQ(full.size(), 2);
+	ASSERT_EQ(pyramid.size(), 2);
+	EXPECT_GT(pyramidStats.allocations(), fullStats.allocations());
+	for (int i = 0; i < 2; ++i) {
+		EXPECT_EQ(pyramid[i].text(), full[i].text());
+		EXPECT_LT(distance(Center(pyramid[i].position()), Center(full[i].position())), 4);
+	}
+
+	EXPECT_EQ(ReadBarcodes(view, DecodeHints(hints).setTryDownscale(true).setMaxNumberOfSymbols(1)).size(), 1);
+}
+
+TEST(ReadBarcodeTest, RawFormats)
+{
+	auto m = Render(BarcodeFormat::QR_CODE, L"raw", 120, 120);
+	const int width = m.width(), height = m.height();
+	auto hints = DecodeHints().setFormats(BarcodeFormat::QR_CODE);
+	auto read = [&](const std::vector<uint8_t>& data, ImageFormat format) {
+		return ReadBarcode(ImageView(data.data(), width, height, format), hints).text();
+	};
+
+	// under-exposed 12-bit values in 16-bit little endian words, only 400 of 65536 levels apart
+	std::vector<uint8_t> lum16(2 * width * height);
+	for (int i = 0; i < width * height; ++i) {
+		int v = m.data()[i] ? 1400 : 1000;
+		lum16[2 * i] = v & 0xFF;
+		lum16[2 * i + 1] = v >> 8;
+	}
+	EXPECT_EQ(read(lum16, ImageFormat::Lum16), L"raw");
+
+	std::vector<uint8_t> mono12((width * 3 + 1) / 2 * height);
+	for (int i = 0; i < width * height; i += 2) {
+		int p0 = m.data()[i] ? 600 : 200, p1 = m.data()[i + 1] ? 600 : 200;
+		uint8_t* p = mono12.data() + i / 2 * 3;
+		p[0] = p0 >> 4;
+		p[1] = (p0 & 0x0F) | ((p1 & 0x0F) << 4);
+		p[2] = p1 >> 4;
+	}
+	EXPECT_EQ(read(mono12, ImageFormat::Mono12Packed), L"raw");
+
+	// a gray symbol seen through an RGGB filter, the blue pixels get a third of the light the red ones get
+	std::vector<uint8_t> bayer(width * height);
+	const int gain[4] = {100, 60, 60, 30};
+	for (int y = 0; y < height; ++y)
+		for (int x = 0; x < width; ++x)
+			bayer[y * width + x] = (m.get(x, y) ? 250 : 40) * gain[2 * (y & 1) + (x & 1)] / 100;
+	EXPECT_EQ(read(bayer, ImageFormat::Bayer8), L"raw");
+
+	// the tiled and multi symbol paths convert the image once as well
+	EXPECT_EQ(ReadBarcodes(ImageView(bayer.data(), width, height, ImageFormat::Bayer8), hints).size(), 1);
+}
+
+TEST(ReadBarcodeTest, YuvFormats)
+{
+	auto m = Render(BarcodeFormat::QR_CODE, L"yuv", 120, 120);
+	// padded camera rows, the chroma planes follow the luma plane and must not be looked at
+	const int width = m.width(), height = m.height(), rowStride = width + 16;
+	std::vector<uint8_t> yuv(rowStride * height * 3 / 2, 0);
+	for (int y = 0; y < height; ++y)
+		for (int x = 0; x < width; ++x)
+			yuv[y * rowStride + x] = m.get(x, y);
+
+	for (auto format : {ImageFormat::NV12, ImageFormat::NV21, ImageFormat::I420, ImageFormat::YV12}) {
+		EXPECT_EQ(PixStride(format), 1);
+		ImageView view(yuv.data(), width, height, format, rowStride);
+		auto hints = DecodeHints().setFormats(BarcodeFormat::QR_CODE);
+		for (auto binarizer : {Binarizer::LocalAverage, Binarizer::GlobalHistogram, Binarizer::FixedThreshold})
+			EXPECT_EQ(ReadBarcode(view, DecodeHints(hints).setBinarizer(binarizer)).text(), L"yuv");
+	}
+}
+
+TEST(ReadBarcodeTest, BestChannel)
+{
+	// red modules on a teal background, both with almost the same luminance (88 and 91)
+	auto m = Render(BarcodeFormat::QR_CODE, L"color", 120, 120);
+	std::vector<uint8_t> rgb(3 * m.width() * m.height());
+	for (int i = 0; i < m.width() * m.height(); ++i) {
+		const uint8_t red[3] = {200, 40, 40}, teal[3] = {0, 130, 130};
+		std::copy_n(m.data()[i] ? teal : red, 3, rgb.data() + 3 * i);
+	}
+	ImageView view(rgb.data(), m.width(), m.height(), ImageFormat::RGB);
+	auto hints = DecodeHints().setFormats(BarcodeFormat::QR_CODE);
+
+	EXPECT_FALSE(ReadBarcode(view, hints).isValid());
+
+	hints.setColorStrategy(ColorStrategy::BestChannel);
+	EXPECT_EQ(ReadBarcode(view, hints).text(), L"color");
+	// the red channel is thresholded directly as well
+	EXPECT_EQ(ReadBarcode(view, DecodeHints(hints).setBinarizer(Binarizer::FixedThreshold)).text(), L"color");
+}
+
+TEST(ReadBarcodeTest, ResultCache)
+{
+	auto m = Render(BarcodeFormat::QR_CODE, L"cached", 120, 120);
+	std::vector<uint8_t> img(m.data(), m.data() + m.width() * m.height());
+	ImageView view(img.data(), m.width(), m.height(), ImageFormat::Lum);
+	DecodeStats stats;
+	BarcodeScanner scanner(DecodeHints().setFormats(BarcodeFormat::QR_CODE).setResultCacheSize(2).setStats(&stats));
+
+	EXPECT_EQ(scanner.read(view).text(), L"cached");
+	EXPECT_EQ(scanner.read(view).text(), L"cached");
+	EXPECT_EQ(stats.cacheMisses(), 1);
+	EXPECT_EQ(stats.cacheHits(), 1);
+	// the cache answers without decoding
+	auto qrTime = stats.time(DecodeStats::ReaderType::QRCode);
+	scanner.read(view);
+	EXPECT_EQ(stats.time(DecodeStats::ReaderType::QRCode), qrTime);
+
+	// readMultiple has entries of its own
+	EXPECT_EQ(scanner.readMultiple(view).size(), 1);
+	EXPECT_EQ(stats.cacheMisses(), 2);
+
+	// a different image, the same pixels with a padded row stride and an empty image (which is cached as well)
+	std::vector<uint8_t> blank(img.size(), 255);
+	EXPECT_FALSE(scanner.read({blank.data(), m.width(), m.height(), ImageFormat::Lum}).isValid());
+	EXPECT_EQ(stats.cacheMisses(), 3);
+	std::vector<uint8_t> padded((m.width() + 3) * m.height(), 0);
+	for (int y = 0; y < m.height(); ++y)
+		std::copy_n(img.data() + y * m.width(), m.width(), padded.data() + y * (m.width() + 3));
+	EXPECT_EQ(scanner.readMultiple({padded.data(), m.width(), m.height(), ImageFormat::Lum, m.width() + 3}).size(), 1);
+	EXPECT_EQ(stats.cacheHits(), 3);
+
+	// the least recently used entry (read of 'view') was dropped for the blank image
+	scanner.read(view);
+	EXPECT_EQ(stats.cacheMisses(), 4);
+}
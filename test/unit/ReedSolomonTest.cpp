@@ -18,8 +18,10 @@
 #include "ReedSolomonEncoder.h"
 #include "GenericGF.h"
 #include "PseudoRandom.h"
+#include "ZXContainerAlgorithms.h"
 
 #include <algorithm>
+#include <numeric>
 #include <ostream>
 
 static std::ostream& operator<<(std::ostream& out, const ZXing::GenericGF& field) {
@@ -480,3 +482,119 @@ TEST(ReedSolomonTest, Aztec)
 	TestEncodeDecodeRandom(GenericGF::AztecData10(), 768, 255);
 	TestEncodeDecodeRandom(GenericGF::AztecData12(), 3072, 1023);
 }
+
+TEST(ReedSolomonTest, EuclideanCrossCheck)
+{
+	PseudoRandom random(0x12345678);
+	auto check = [&random](const GenericGF& field, int dataSize, int ecSize) {
+		ReedSolomonEncoder encoder(field);
+		std::vector<int> message(dataSize + ecSize);
+		for (int i = 0; i < dataSize; ++i)
+			message[i] = random.next(0, field.size() - 1);
+		encoder.encode(message, ecSize);
+		for (int errors = 0; errors <= ecSize / 2; ++errors) {
+			auto received = message;
+			Corrupt(received, errors, random, field.size());
+			auto euclidean = received;
+			EXPECT_TRUE(ReedSolomonDecoder::Decode(field, received, ecSize)) << field << " at " << errors << " errors";
+			EXPECT_TRUE(ReedSolomonDecoder::DecodeEuclidean(field, euclidean, ecSize));
+			EXPECT_EQ(received, message);
+			EXPECT_EQ(euclidean, message);
+		}
+	};
+	check(GenericGF::QRCodeField256(), 100, 30);
+	check(GenericGF::DataMatrixField256(), 100, 68);
+	check(GenericGF::MaxiCodeField64(), 20, 28);
+	check(GenericGF::AztecParam(), 4, 6);
+	check(GenericGF::AztecData6(), 20, 13);
+	check(GenericGF::AztecData10(), 300, 200);
+}
+
+TEST(ReedSolomonTest, Erasures)
+{
+	PseudoRandom random(0x12345678);
+	auto check = [&random](const GenericGF& field, int dataSize, int ecSize) {
+		ReedSolomonEncoder encoder(field);
+		std::vector<int> message(dataSize + ecSize);
+		for (int i = 0; i < dataSize; ++i)
+			message[i] = random.next(0, field.size() - 1);
+		encoder.encode(message, ecSize);
+		for (int numErasures = 0; numErasures <= ecSize; ++numErasures) {
+			int numErrors = (ecSize - numErasures) / 2;
+			auto received = message;
+			// corrupt the erased positions as well as some others that the decoder has to find by itself
+			Corrupt(received, numErasures + numErrors, random, field.size());
+			std::vector<int> erasures;
+			for (int i = 0; i < Size(received) && Size(erasures) < numErasures; ++i)
+				if (received[i] != message[i])
+					erasures.push_back(i);
+			EXPECT_TRUE(ReedSolomonDecoder::Decode(field, received, ecSize, erasures))
+				<< field << " at " << numErasures << " erasures and " << numErrors << " errors";
+			EXPECT_EQ(received, message);
+		}
+		// an erased codeword may just as well be correct
+		auto received = message;
+		EXPECT_TRUE(ReedSolomonDecoder::Decode(field, received, ecSize, {0, dataSize}));
+		EXPECT_EQ(received, message);
+		// more erasures than error correction codewords can not be corrected
+		std::vector<int> tooMany(ecSize + 1);
+		std::iota(tooMany.begin(), tooMany.end(), 0);
+		received[0] ^= 1;
+		EXPECT_FALSE(ReedSolomonDecoder::Decode(field, received, ecSize, tooMany));
+	};
+	check(GenericGF::QRCodeField256(), 100, 30);
+	check(GenericGF::DataMatrixField256(), 100, 68);
+	check(GenericGF::MaxiCodeField64(), 20, 28);
+	check(GenericGF::AztecParam(), 4, 6);
+	check(GenericGF::AztecData6(), 20, 13);
+	check(GenericGF::AztecData10(), 300, 200);
+}
+
+TEST(ReedSolomonTest, BatchEncode)
+{
+	PseudoRandom random(0x12345678);
+	for (auto field : {&GenericGF::QRCodeField256(), &GenericGF::DataMatrixField256(), &GenericGF::MaxiCodeField64()}) {
+		ReedSolomonEncoder encoder(*field);
+		std::vector<int> blockSizes = {10, 11, 1, 40};
+		int ecSize = 18;
+		ByteArray data;
+		for (int i = 0; i < Reduce(blockSizes); ++i)
+			data.push_back(static_cast<uint8_t>(random.next(0, field->size() - 1)));
+		ByteArray ecBytes;
+		encoder.encode(data, blockSizes, ecSize, ecBytes);
+		ASSERT_EQ(Size(ecBytes), Size(blockSizes) * ecSize);
+		int offset = 0;
+		for (int b = 0; b < Size(blockSizes); ++b) {
+			std::vector<int> message(data.begin() + offset, data.begin() + offset + blockSizes[b]);
+			message.resize(blockSizes[b] + ecSize);
+			encoder.encode(message, ecSize);
+			EXPECT_EQ(std::vector<int>(ecBytes.begin() + b * ecSize, ecBytes.begin() + (b + 1) * ecSize),
+					  std::vector<int>(message.begin() + blockSizes[b], message.end()))
+				<< *field << " block " << b;
+			offset += blockSizes[b];
+		}
+	}
+}
+
+TEST(ReedSolomonTest, InterleavedEncode)
+{
+	PseudoRandom random(0x12345678);
+	ReedSolomonEncoder encoder(GenericGF::DataMatrixField256());
+	// the layout of the 144x144 DataMatrix symbol: 1558 data codewords in 10 blocks of 156 or 155
+	int numData = 1558, numBlocks = 10, ecSize = 62;
+	ByteArray codewords(numData + numBlocks * ecSize);
+	for (int i = 0; i < numData; ++i)
+		codewords[i] = static_cast<uint8_t>(random.next(0, 255));
+	encoder.encodeInterleaved(codewords.data(), numData, numBlocks, ecSize);
+	for (int b = 0; b < numBlocks; ++b) {
+		std::vector<int> message;
+		for (int i = b; i < numData; i += numBlocks)
+			message.push_back(codewords[i]);
+		int blockSize = Size(message);
+		EXPECT_EQ(blockSize, b < 8 ? 156 : 155);
+		message.resize(blockSize + ecSize);
+		encoder.encode(message, ecSize);
+		for (int k = 0; k < ecSize; ++k)
+			EXPECT_EQ(codewords[numData + b + k * numBlocks], message[blockSize + k]) << "block " << b << " ec " << k;
+	}
+}
@@ -0,0 +1,115 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "RunLengthIndex.h"
+#include "BitMatrix.h"
+#include "BitMatrixIO.h"
+
+#include "gtest/gtest.h"
+
+using namespace ZXing;
+
+TEST(RunLengthIndexTest, MatchesGetPatternRow)
+{
+	auto matrix = ParseBitMatrix("XX XX  X\n"
+								 " XXX   X\n"
+								 "XXXXXXXX\n"
+								 "       X\n"
+								 "   X    \n",
+								 'X', false);
+	RunLengthIndex index(matrix);
+	ASSERT_EQ(index.width(), matrix.width());
+	ASSERT_EQ(index.height(), matrix.height());
+
+	PatternRow expected;
+	for (int y = 0; y < matrix.height(); ++y) {
+		GetPatternRow(matrix, y, expected);
+		EXPECT_EQ(index.row(y), expected) << "row " << y;
+	}
+	for (int x = 0; x < matrix.width(); ++x) {
+		GetPatternRow(matrix, x, expected, true);
+		EXPECT_EQ(index.column(x), expected) << "column " << x;
+	}
+}
+
+TEST(RunLengthIndexTest, GetPatternLine)
+{
+	auto matrix = ParseBitMatrix("XX XX  X\n"
+								 " XXX   X\n"
+								 "XXXXXXXX\n"
+								 "       X\n"
+								 "   X    \n",
+								 'X', false);
+	PatternRow expected, line;
+	for (int y = 0; y < matrix.height(); ++y) {
+		GetPatternRow(matrix, y, expected);
+		EXPECT_EQ(GetPatternLine(matrix, {0, y}, {matrix.width() - 1, y}, line), matrix.width());
+		EXPECT_EQ(line, expected) << "row " << y;
+	}
+	for (int x = 0; x < matrix.width(); ++x) {
+		GetPatternRow(matrix, x, expected, true);
+		EXPECT_EQ(GetPatternLine(matrix, {x, 0}, {x, matrix.height() - 1}, line), matrix.height());
+		EXPECT_EQ(line, expected) << "column " << x;
+	}
+
+	// the diagonal from the top left: (0, 0), (1, 1), (2, 2) are black, (3, 3), (4, 4) white
+	EXPECT_EQ(GetPatternLine(matrix, {0, 0}, {4, 4}, line), 5);
+	EXPECT_EQ(line, PatternRow({0, 3, 2}));
+	// one sample per column: (0, 0), (1, 1), (2, 1), (3, 2), (4, 2), (5, 3), (6, 3), (7, 4)
+	EXPECT_EQ(GetPatternLine(matrix, {0, 0}, {7, 4}, line), 8);
+	EXPECT_EQ(line, PatternRow({0, 5, 3}));
+}
+
+TEST(RunLengthIndexTest, TransitionsAndRanges)
+{
+	auto matrix = ParseBitMatrix("XX XX  X  XXXXXXXXXXX\n"
+								 " XXX   X            X\n"
+								 "XXXXXXXXXXXXXXXXXXXXX\n"
+								 "       X             \n"
+								 "   X                 \n",
+								 'X', false);
+	RunLengthIndex index(matrix);
+
+	auto transitions = [](auto line, int begin, int end) {
+		int res = 0;
+		for (int i = begin + 1; i < end; ++i)
+			res += line[i] != line[i - 1];
+		return res;
+	};
+	auto contains = [](auto line, int begin, int end, bool value) {
+		for (int i = begin; i < end; ++i)
+			if (line[i] == value)
+				return true;
+		return false;
+	};
+
+	for (int y = 0; y < matrix.height(); ++y)
+		for (int begin = 0; begin <= matrix.width(); ++begin)
+			for (int end = begin; end <= matrix.width(); ++end) {
+				auto line = matrix.rowView(y);
+				EXPECT_EQ(index.rowTransitions(y, begin, end), transitions(line, begin, end));
+				EXPECT_EQ(matrix.isRowRange(y, begin, end, false), !contains(line, begin, end, true));
+				EXPECT_EQ(matrix.isRowRange(y, begin, end, true), !contains(line, begin, end, false));
+			}
+
+	for (int x = 0; x < matrix.width(); ++x)
+		for (int begin = 0; begin <= matrix.height(); ++begin)
+			for (int end = begin; end <= matrix.height(); ++end) {
+				auto line = matrix.columnView(x);
+				EXPECT_EQ(index.columnTransitions(x, begin, end), transitions(line, begin, end));
+				EXPECT_EQ(index.columnHasBlack(x, begin, end), contains(line, begin, end, true));
+			}
+}
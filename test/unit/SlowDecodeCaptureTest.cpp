@@ -0,0 +1,95 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "SlowDecodeCapture.h"
+#include "DecodeHints.h"
+#include "DecodeStats.h"
+#include "ImageUtility.h"
+#include "ReadBarcode.h"
+
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+
+using namespace ZXing;
+using namespace ZXing::Utility;
+
+TEST(SlowDecodeCaptureTest, Callback)
+{
+	auto img = Render(BarcodeFormat::QR_CODE, L"slow", 120, 120);
+	auto view = View(img);
+
+	DecodeStats total;
+	int calls = 0;
+	std::chrono::nanoseconds binarizeTime{};
+	auto hints = DecodeHints().setFormats(BarcodeFormat::QR_CODE).setStats(&total).setSlowDecodeCallback(
+		[&](const SlowDecode& slow) {
+			++calls;
+			EXPECT_EQ(slow.image.width(), img.width());
+			EXPECT_EQ(slow.hints.formats(), BarcodeFormat::QR_CODE);
+			EXPECT_GT(slow.time, std::chrono::nanoseconds(0));
+			binarizeTime = slow.stats.time(DecodeStats::Stage::Binarize);
+		});
+
+	// a threshold of 0 reports every call
+	BarcodeScanner scanner(hints);
+	EXPECT_TRUE(scanner.read(view).isValid());
+	EXPECT_EQ(calls, 1);
+	EXPECT_GT(binarizeTime, std::chrono::nanoseconds(0));
+	// the stats of the call are added to the ones of the hints
+	EXPECT_EQ(total.time(DecodeStats::Stage::Binarize), binarizeTime);
+
+	EXPECT_EQ(scanner.readMultiple(view).size(), 1);
+	EXPECT_EQ(calls, 2);
+
+	EXPECT_TRUE(ReadBarcode(view, DecodeHints(hints).setSlowDecodeThreshold(std::chrono::hours(1))).isValid());
+	EXPECT_EQ(calls, 2);
+}
+
+TEST(SlowDecodeCaptureTest, Write)
+{
+	// 2 x 1 pixels of 12-bit gray, 0x123 and 0xABC
+	const uint8_t mono12[] = {0x12, 0xC3, 0xAB};
+	ImageView view(mono12, 2, 1, ImageFormat::Mono12Packed);
+	DecodeHints hints;
+	DecodeStats stats;
+
+	// written to the working directory, like the files of the other tests
+	std::string base = "zxing_slow_decode_test";
+	ASSERT_TRUE(WriteSlowDecode({view, hints, stats, std::chrono::milliseconds(42)}, base));
+
+	std::string content;
+	std::stringstream ss;
+	{
+		std::ifstream pgm(base + ".pgm", std::ios::binary);
+		content.assign(std::istreambuf_iterator<char>(pgm), std::istreambuf_iterator<char>());
+		std::ifstream json(base + ".json");
+		ss << json.rdbuf();
+	}
+	EXPECT_EQ(content, std::string("P5\n2 1\n4095\n\x01\x23\x0A\xBC", 16));
+	EXPECT_NE(ss.str().find("\"image\": \"zxing_slow_decode_test.pgm\""), std::string::npos);
+	EXPECT_NE(ss.str().find("\"format\": \"Mono12Packed\""), std::string::npos);
+	EXPECT_NE(ss.str().find("\"timeMs\": 42"), std::string::npos);
+
+	std::remove((base + ".pgm").c_str());
+	std::remove((base + ".json").c_str());
+}
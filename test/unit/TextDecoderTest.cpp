@@ -0,0 +1,76 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "CharacterSet.h"
+#include "CharacterSetECI.h"
+#include "TextDecoder.h"
+
+#include "gtest/gtest.h"
+
+#include <string>
+
+using namespace ZXing;
+
+static CharacterSet Guess(const std::string& s, CharacterSet fallback = TextDecoder::DefaultEncoding())
+{
+	return TextDecoder::GuessEncoding(reinterpret_cast<const uint8_t*>(s.data()), s.size(), fallback);
+}
+
+TEST(TextDecoderTest, GuessEncoding)
+{
+	// plain ASCII, longer than one SIMD block
+	std::string url = "https://www.example.com/path?query=0123456789";
+	EXPECT_EQ(Guess(url), CharacterSet::ISO8859_1);
+	EXPECT_EQ(Guess(url, CharacterSet::Shift_JIS), CharacterSet::Shift_JIS);
+
+	// UTF-8 with 2, 3 and 4 byte sequences, one of them crossing the boundary between the first two blocks
+	std::string utf8 = "0123456789abcd\xC3\xA4\xE6\x97\xA5\xF0\x9F\x98\x80 and some more text";
+	EXPECT_EQ(Guess(utf8), CharacterSet::UTF8);
+	// cut off in the middle of the last sequence, in the last block and at the end of a full block
+	EXPECT_NE(Guess("0123456789abcdef\xE6\x97"), CharacterSet::UTF8);
+	EXPECT_NE(Guess("0123456789abcd\xE6\x97"), CharacterSet::UTF8);
+
+	// Latin1 umlauts are not valid UTF-8
+	EXPECT_EQ(Guess("Gr\xFC\xDF" "e aus K\xF6ln"), CharacterSet::ISO8859_1);
+
+	// Shift_JIS katakana
+	EXPECT_EQ(Guess("\xB1\xB2\xB3"), CharacterSet::Shift_JIS);
+}
+
+TEST(TextDecoderTest, CharacterSetECI)
+{
+	EXPECT_EQ(CharacterSetECI::CharsetFromName("ASCII"), CharacterSet::ASCII);
+	EXPECT_EQ(CharacterSetECI::CharsetFromName("ISO-8859-1"), CharacterSet::ISO8859_1);
+	EXPECT_EQ(CharacterSetECI::CharsetFromName("ISO-8859-16"), CharacterSet::ISO8859_16);
+	EXPECT_EQ(CharacterSetECI::CharsetFromName("SJIS"), CharacterSet::Shift_JIS);
+	EXPECT_EQ(CharacterSetECI::CharsetFromName("windows-1256"), CharacterSet::Cp1256);
+	EXPECT_EQ(CharacterSetECI::CharsetFromName(""), CharacterSet::Unknown);
+	EXPECT_EQ(CharacterSetECI::CharsetFromName("ISO-8859"), CharacterSet::Unknown);
+	EXPECT_EQ(CharacterSetECI::CharsetFromName("zzz"), CharacterSet::Unknown);
+
+	EXPECT_EQ(CharacterSetECI::CharsetFromValue(0), CharacterSet::Cp437);
+	EXPECT_EQ(CharacterSetECI::CharsetFromValue(14), CharacterSet::Unknown);
+	EXPECT_EQ(CharacterSetECI::CharsetFromValue(30), CharacterSet::EUC_KR);
+	EXPECT_EQ(CharacterSetECI::CharsetFromValue(31), CharacterSet::Unknown);
+	EXPECT_EQ(CharacterSetECI::CharsetFromValue(170), CharacterSet::ASCII);
+	EXPECT_EQ(CharacterSetECI::CharsetFromValue(-1), CharacterSet::Unknown);
+
+	// the lowest of several values
+	EXPECT_EQ(CharacterSetECI::ValueForCharset(CharacterSet::ISO8859_1), 1);
+	EXPECT_EQ(CharacterSetECI::ValueForCharset(CharacterSet::ASCII), 27);
+	EXPECT_EQ(CharacterSetECI::ValueForCharset(CharacterSet::UTF8), 26);
+	EXPECT_EQ(CharacterSetECI::ValueForCharset(CharacterSet::Unknown), 0);
+}
@@ -0,0 +1,65 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "CharacterSet.h"
+#include "TextDecoder.h"
+#include "TextEncoder.h"
+
+#include "gtest/gtest.h"
+
+#include <stdexcept>
+#include <string>
+
+using namespace ZXing;
+
+TEST(TextEncoderTest, EucKr)
+{
+	// hangul, hanja and ASCII
+	EXPECT_EQ(TextEncoder::FromUnicode(L"a가一", CharacterSet::EUC_KR), "a\xB0\xA1\xEC\xE9");
+	// below the first entry of every table, this used to run the binary search out of bounds
+	EXPECT_EQ(TextEncoder::FromUnicode(L"\u0080¡", CharacterSet::EUC_KR), "??");
+}
+
+TEST(TextEncoderTest, SingleByteRoundTrip)
+{
+	std::string bytes;
+	for (int c = 0x20; c <= 0xFF; ++c)
+		if (c < 0x7F || c >= 0xA0)
+			bytes.push_back(static_cast<char>(c));
+	for (auto charset : {CharacterSet::ISO8859_5, CharacterSet::Cp1252})
+		EXPECT_EQ(TextEncoder::FromUnicode(TextDecoder::ToUnicode(bytes, charset), charset), bytes);
+
+	EXPECT_EQ(TextEncoder::FromUnicode(L"Жж", CharacterSet::ISO8859_5), "\xB6\xD6");
+	EXPECT_EQ(TextEncoder::FromUnicode(L"€™", CharacterSet::Cp1252), "\x80\x99");
+	EXPECT_THROW(TextEncoder::FromUnicode(L"一", CharacterSet::Cp1252), std::invalid_argument);
+}
+
+TEST(TextEncoderTest, Big5RoundTrip)
+{
+	std::wstring text = L"中文 Big5 繁體字";
+	std::string bytes = TextEncoder::FromUnicode(text, CharacterSet::Big5);
+	EXPECT_EQ(bytes, "\xA4\xA4\xA4\xE5 Big5 \xC1\x63\xC5\xE9\xA6\x72");
+	EXPECT_EQ(TextDecoder::ToUnicode(bytes, CharacterSet::Big5), text);
+
+	// the first row of the frequently used characters
+	std::string row;
+	for (int c = 0x40; c <= 0x7E; ++c)
+		row += {'\xA4', static_cast<char>(c)};
+	EXPECT_EQ(TextEncoder::FromUnicode(TextDecoder::ToUnicode(row, CharacterSet::Big5), CharacterSet::Big5), row);
+
+	EXPECT_EQ(TextEncoder::FromUnicode(L"가", CharacterSet::Big5), "?");
+}
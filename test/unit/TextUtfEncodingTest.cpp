@@ -0,0 +1,104 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "TextUtfEncoding.h"
+#include "CpuFeatures.h"
+
+#include "gtest/gtest.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace ZXing;
+using CpuFeatures::Isa;
+
+// runs of ASCII, two, three and four byte code points, long enough to fill and straddle the SIMD blocks
+static std::wstring RandomText(std::mt19937& rnd, int length)
+{
+	static const std::vector<std::pair<uint32_t, uint32_t>> ranges = {
+		{0x20, 0x7e}, {0x80, 0x7ff}, {0x800, 0xd7ff}, {0x10000, 0x10ffff}};
+	std::wstring res;
+	while (static_cast<int>(res.size()) < length) {
+		auto range = ranges[rnd() % (sizeof(wchar_t) == 2 ? 3 : 4)];
+		for (int n = rnd() % 24; n > 0; --n)
+			res.push_back(static_cast<wchar_t>(range.first + rnd() % (range.second - range.first + 1)));
+	}
+	return res;
+}
+
+TEST(TextUtfEncodingTest, RoundTrip)
+{
+	EXPECT_EQ(TextUtfEncoding::ToUtf8(L"Aé€"), "A\xc3\xa9\xe2\x82\xac");
+	EXPECT_EQ(TextUtfEncoding::FromUtf8("A\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80"), L"Aé€\U0001F600");
+	EXPECT_EQ(TextUtfEncoding::FromUtf8(""), L"");
+
+	std::mt19937 rnd(42);
+	for (int i = 0; i < 200; ++i) {
+		auto text = RandomText(rnd, i * 3);
+		EXPECT_EQ(TextUtfEncoding::FromUtf8(TextUtfEncoding::ToUtf8(text)), text);
+	}
+}
+
+TEST(TextUtfEncodingTest, ScalarFallbacksMatch)
+{
+	std::mt19937 rnd(7);
+	std::vector<std::wstring> texts = {std::wstring(100, L'x'), std::wstring(37, L'Ж'), std::wstring(20, L'Â')};
+	std::vector<std::string> utf8s = {
+		std::string(40, 'a') + "\xc1\xbf" + std::string(40, 'b'), // overlong sequence
+		std::string(33, 'a') + "\xc3" + std::string(30, 'b'),     // truncated sequence
+		std::string(17, '\xd0'),
+	};
+	for (int i = 0; i < 100; ++i) {
+		texts.push_back(RandomText(rnd, 5 + i));
+		utf8s.push_back(TextUtfEncoding::ToUtf8(texts.back()));
+		// flip random bits to get invalid input as well
+		utf8s.push_back(utf8s.back());
+		if (!utf8s.back().empty())
+			utf8s.back()[rnd() % utf8s.back().size()] ^= static_cast<char>(1 << rnd() % 8);
+	}
+
+	Isa best = CpuFeatures::Best();
+	CpuFeatures::SetMaxIsa(Isa::Scalar);
+	std::vector<std::string> encoded;
+	std::vector<std::wstring> decoded;
+	for (auto& text : texts)
+		encoded.push_back(TextUtfEncoding::ToUtf8(text));
+	for (auto& utf8 : utf8s)
+		decoded.push_back(TextUtfEncoding::FromUtf8(utf8));
+	CpuFeatures::SetMaxIsa(best);
+
+	for (size_t i = 0; i < texts.size(); ++i)
+		EXPECT_EQ(TextUtfEncoding::ToUtf8(texts[i]), encoded[i]) << i;
+	for (size_t i = 0; i < utf8s.size(); ++i)
+		EXPECT_EQ(TextUtfEncoding::FromUtf8(utf8s[i]), decoded[i]) << i;
+}
+
+TEST(TextUtfEncodingTest, AppendUtf8Buffer)
+{
+	std::wstring text = L"Größe € 12";
+	std::string expected = TextUtfEncoding::ToUtf8(text);
+
+	EXPECT_EQ(TextUtfEncoding::AppendUtf8(nullptr, 0, text.data(), text.size()), expected.size());
+
+	std::vector<char> buffer(expected.size() + 4, '#');
+	EXPECT_EQ(TextUtfEncoding::AppendUtf8(buffer.data(), expected.size() - 1, text.data(), text.size()), expected.size());
+	EXPECT_EQ(std::string(buffer.begin(), buffer.end()), std::string(buffer.size(), '#')); // too small, untouched
+
+	EXPECT_EQ(TextUtfEncoding::AppendUtf8(buffer.data(), buffer.size(), text.data(), text.size()), expected.size());
+	EXPECT_EQ(std::string(buffer.data(), expected.size()), expected);
+	EXPECT_EQ(buffer[expected.size()], '#');
+}
@@ -0,0 +1,86 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "Trace.h"
+#include "BarcodeFormat.h"
+#include "DecodeHints.h"
+#include "ImageUtility.h"
+#include "ReadBarcode.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace ZXing;
+using namespace ZXing::Utility;
+
+namespace {
+
+class RecordingTracer : public Tracer
+{
+public:
+	std::vector<std::string> events;
+	std::vector<const char*> open;
+	bool nested = true;
+
+	void begin(const char* name) override
+	{
+		events.push_back(name);
+		open.push_back(name);
+	}
+	void end(const char* name) override
+	{
+		nested = nested && !open.empty() && open.back() == name;
+		if (!open.empty())
+			open.pop_back();
+	}
+};
+
+struct TracerGuard
+{
+	explicit TracerGuard(Tracer* tracer) { SetTracer(tracer); }
+	~TracerGuard() { SetTracer(nullptr); }
+};
+
+} // namespace
+
+TEST(TraceTest, ReadBarcode)
+{
+	auto img = Render(BarcodeFormat::QR_CODE, L"Trace", 200, 200);
+	RecordingTracer tracer;
+	{
+		TracerGuard guard(&tracer);
+		EXPECT_EQ(CurrentTracer(), &tracer);
+		auto result = ReadBarcode(View(img), DecodeHints().setFormats(BarcodeFormat::QR_CODE));
+		EXPECT_TRUE(result.isValid());
+	}
+	EXPECT_EQ(CurrentTracer(), nullptr);
+
+#ifdef ZX_TRACING
+	ASSERT_FALSE(tracer.events.empty());
+	EXPECT_EQ(tracer.events.front(), "ReadBarcode");
+	for (auto name : {"HybridBinarizer::InitBlackMatrix", "QRCode::Reader::decode", "QRCode::Detector::Detect",
+					  "QRCode::Decoder::Decode"})
+		EXPECT_NE(std::find(tracer.events.begin(), tracer.events.end(), name), tracer.events.end()) << name;
+	EXPECT_TRUE(tracer.nested);
+	EXPECT_TRUE(tracer.open.empty());
+#else
+	EXPECT_TRUE(tracer.events.empty());
+#endif
+}
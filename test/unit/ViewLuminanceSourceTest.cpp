@@ -0,0 +1,65 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "ViewLuminanceSource.h"
+#include "ByteArray.h"
+
+#include "gtest/gtest.h"
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+using namespace ZXing;
+
+static std::vector<uint8_t> Pixels(const LuminanceSource& source)
+{
+	ByteArray buffer;
+	int rowBytes = 0;
+	const uint8_t* matrix = source.getMatrix(buffer, rowBytes);
+	std::vector<uint8_t> res;
+	for (int y = 0; y < source.height(); ++y)
+		res.insert(res.end(), matrix + y * rowBytes, matrix + y * rowBytes + source.width());
+	return res;
+}
+
+TEST(ViewLuminanceSourceTest, Rotated)
+{
+	// a 3x2 image in a buffer with a row stride of 4
+	const uint8_t bytes[] = {1, 2, 3, 0, 4, 5, 6, 0};
+	ViewLuminanceSource source(3, 2, bytes, 4);
+
+	auto r90 = source.rotated(90);
+	EXPECT_EQ(r90->width(), 2);
+	EXPECT_EQ(r90->height(), 3);
+	EXPECT_EQ(Pixels(*r90), std::vector<uint8_t>({4, 1, 5, 2, 6, 3}));
+
+	auto r180 = source.rotated(180);
+	EXPECT_EQ(r180->width(), 3);
+	EXPECT_EQ(Pixels(*r180), std::vector<uint8_t>({6, 5, 4, 3, 2, 1}));
+
+	auto r270 = source.rotated(-90);
+	EXPECT_EQ(r270->height(), 3);
+	EXPECT_EQ(Pixels(*r270), std::vector<uint8_t>({3, 6, 2, 5, 1, 4}));
+
+	// the rotated copies match the ones of a cropped source, the crop starts at the second column
+	const uint8_t wide[] = {9, 1, 2, 3, 9, 4, 5, 6};
+	auto cropped = ViewLuminanceSource(4, 2, wide, 4).cropped(1, 0, 3, 2);
+	for (int degree : {0, 90, 180, 270})
+		EXPECT_EQ(Pixels(*cropped->rotated(degree)), Pixels(*source.rotated(degree))) << degree;
+
+	EXPECT_THROW(source.rotated(45), std::invalid_argument);
+}
@@ -0,0 +1,47 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "XXHash.h"
+
+#include "gtest/gtest.h"
+
+#include <cstring>
+#include <vector>
+
+using namespace ZXing;
+
+TEST(XXHashTest, ReferenceValues)
+{
+	auto hash = [](const char* s, uint64_t seed = 0) { return XXHash64(s, std::strlen(s), seed); };
+	EXPECT_EQ(hash(""), 0xEF46DB3751D8E999ULL);
+	// a short input (tail only) and one with a 32-byte stripe and a tail of 8, 4 and 1 byte steps
+	EXPECT_EQ(hash("hello, world"), 0xB33A384E6D1B1242ULL);
+	EXPECT_EQ(hash("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789$"), 0x1032D841E824F998ULL);
+	EXPECT_NE(hash("hello, world", 1), hash("hello, world"));
+}
+
+TEST(XXHashTest, Unaligned)
+{
+	std::vector<uint8_t> data(1000);
+	for (size_t i = 0; i < data.size(); ++i)
+		data[i] = static_cast<uint8_t>(i * 7);
+	std::vector<uint8_t> shifted(data.size() + 1);
+	std::copy(data.begin(), data.end(), shifted.begin() + 1);
+	EXPECT_EQ(XXHash64(shifted.data() + 1, data.size()), XXHash64(data.data(), data.size()));
+	shifted[500] ^= 1;
+	EXPECT_NE(XXHash64(shifted.data() + 1, data.size()), XXHash64(data.data(), data.size()));
+}
@@ -17,9 +17,13 @@
 #include "gtest/gtest.h"
 #include "aztec/AZDetector.h"
 #include "aztec/AZDetectorResult.h"
+#include "aztec/AZDecoder.h"
+#include "aztec/AZWriter.h"
+#include "DecoderResult.h"
 #include "BitMatrixIO.h"
 #include "PseudoRandom.h"
 
+#include <set>
 #include <vector>
 
 using namespace ZXing;
@@ -202,3 +206,43 @@ TEST(AZDetectorTest, ErrorInParameterLocatorNotCompact)
 		, 'X', true)
 	);
 }
+
+TEST(AZDetectorTest, DetectMultiple)
+{
+	const std::wstring texts[] = {L"first", L"second symbol", L"the third one is a bit longer than the others"};
+	const int offsets[][2] = {{12, 140}, {150, 15}, {300, 120}};
+
+	BitMatrix image(470, 300);
+	Aztec::Writer writer;
+	for (int i = 0; i < 3; ++i) {
+		auto symbol = MakeLarger(writer.encode(texts[i], 0, 0), 3 + i);
+		for (int y = 0; y < symbol.height(); ++y)
+			for (int x = 0; x < symbol.width(); ++x)
+				if (symbol.get(x, y))
+					image.set(offsets[i][0] + x, offsets[i][1] + y);
+	}
+
+	std::set<std::wstring> decoded;
+	for (auto& res : Aztec::Detector::DetectMultiple(image, false))
+		decoded.insert(Aztec::Decoder::Decode(res).text());
+	EXPECT_EQ(decoded, std::set<std::wstring>(std::begin(texts), std::end(texts)));
+}
+
+TEST(AZDetectorTest, FindPureBullsEye)
+{
+	Aztec::Writer writer;
+	for (std::wstring text : {std::wstring(L"compact"), std::wstring(150, L'F')})
+		for (int factor : {1, 3}) {
+			auto symbol = MakeLarger(writer.encode(text, 0, 0), factor);
+			BitMatrix image = Inflate(symbol.copy(), symbol.width() + 10, symbol.height() + 10, 5);
+			for (int rotation = 0; rotation < 360; rotation += 90) {
+				Aztec::BullsEye bullsEye;
+				ASSERT_TRUE(Aztec::Detector::FindPureBullsEye(image, bullsEye));
+				EXPECT_EQ(bullsEye.compact, text == L"compact");
+				auto res = Aztec::Detector::Detect(image, bullsEye, false);
+				ASSERT_TRUE(res.isValid());
+				EXPECT_EQ(Aztec::Decoder::Decode(res).text(), text);
+				image.rotate90();
+			}
+		}
+}
@@ -45,3 +45,50 @@ TEST(DMDecodedBitStreamParserTest, AsciiDoubleDigitDecode)
 	auto decodedString = DataMatrix::DecodedBitStreamParser::Decode(std::move(bytes)).text();
 	EXPECT_EQ(decodedString, L"00019899");
 }
+
+// Appends the two codewords encoding the three C40/Text/X12 values
+static void AppendTriple(ByteArray& bytes, int c1, int c2, int c3)
+{
+	int value = 1600 * c1 + 40 * c2 + c3 + 1;
+	bytes.push_back(static_cast<uint8_t>(value >> 8));
+	bytes.push_back(static_cast<uint8_t>(value & 0xFF));
+}
+
+TEST(DMDecodedBitStreamParserTest, C40Decode)
+{
+	ByteArray bytes = {230}; // latch to C40
+	AppendTriple(bytes, 14, 1, 0); // 'A', shift 2 '!'
+	AppendTriple(bytes, 1, 30, 14); // shift 2 upper shift, 'A' + 128
+	AppendTriple(bytes, 2, 1, 3); // shift 3 'a', ' '
+	bytes.push_back(254); // unlatch
+	bytes.push_back('b' + 1);
+	auto decodedString = DataMatrix::DecodedBitStreamParser::Decode(std::move(bytes)).text();
+	EXPECT_EQ(decodedString, L"A!\xC1" L"a b");
+}
+
+TEST(DMDecodedBitStreamParserTest, TextDecode)
+{
+	ByteArray bytes = {239}; // latch to Text
+	AppendTriple(bytes, 14, 2, 0); // 'a', shift 3 '`'
+	AppendTriple(bytes, 1, 27, 3); // shift 2 FNC1, ' '
+	AppendTriple(bytes, 2, 1, 4); // shift 3 'A', '0'
+	auto decodedString = DataMatrix::DecodedBitStreamParser::Decode(std::move(bytes)).text();
+	EXPECT_EQ(decodedString, L"a`\x1D A0");
+
+	bytes = {239};
+	AppendTriple(bytes, 2, 32, 3); // shift 3 has only 32 values
+	EXPECT_FALSE(DataMatrix::DecodedBitStreamParser::Decode(std::move(bytes)).isValid());
+}
+
+TEST(DMDecodedBitStreamParserTest, AnsiX12Decode)
+{
+	ByteArray bytes = {238}; // latch to ANSI X12
+	AppendTriple(bytes, 0, 1, 2);
+	AppendTriple(bytes, 3, 4, 39);
+	auto decodedString = DataMatrix::DecodedBitStreamParser::Decode(std::move(bytes)).text();
+	EXPECT_EQ(decodedString, L"\r*> 0Z");
+
+	bytes = {238};
+	AppendTriple(bytes, 40, 0, 0);
+	EXPECT_FALSE(DataMatrix::DecodedBitStreamParser::Decode(std::move(bytes)).isValid());
+}
@@ -0,0 +1,78 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#include "gtest/gtest.h"
+#include "BitMatrix.h"
+#include "DecoderResult.h"
+#include "DetectorResult.h"
+#include "datamatrix/DMDecoder.h"
+#include "datamatrix/DMDetector.h"
+#include "datamatrix/DMWriter.h"
+
+#include <set>
+
+using namespace ZXing;
+using namespace ZXing::DataMatrix;
+
+TEST(DMDetectorTest, DetectMultiple)
+{
+	const std::wstring texts[] = {L"first", L"second symbol", L"3"};
+	const int offsets[][2] = {{10, 150}, {170, 20}, {330, 110}};
+
+	BitMatrix image(480, 260);
+	Writer writer;
+	writer.setMargin(0);
+	for (int i = 0; i < 3; ++i) {
+		auto symbol = writer.encode(texts[i], 70 + 10 * i, 70 + 10 * i);
+		for (int y = 0; y < symbol.height(); ++y)
+			for (int x = 0; x < symbol.width(); ++x)
+				if (symbol.get(x, y))
+					image.set(offsets[i][0] + x, offsets[i][1] + y);
+	}
+
+	for (int threads : {1, 3}) {
+		std::set<std::wstring> decoded;
+		for (auto& res : Detector::DetectMultiple(image, false, threads))
+			decoded.insert(Decoder::Decode(res.bits()).text());
+		EXPECT_EQ(decoded, std::set<std::wstring>(std::begin(texts), std::end(texts)));
+	}
+
+	// the single symbol detection only walks left from the image center
+	EXPECT_FALSE(Detector::Detect(image, false, false, false).isValid());
+}
+
+TEST(DMDetectorTest, DetectPure)
+{
+	Writer writer;
+	writer.setMargin(0);
+	auto symbol = writer.encode(L"pure symbol", 0, 0);
+
+	// scale the symbol up and place it off-center, with a gap on the right and bottom that is smaller than a module
+	const int moduleSize = 5, left = 13, top = 7;
+	BitMatrix image(left + symbol.width() * moduleSize + 3, top + symbol.height() * moduleSize + 2);
+	for (int y = 0; y < symbol.height() * moduleSize; ++y)
+		for (int x = 0; x < symbol.width() * moduleSize; ++x)
+			if (symbol.get(x / moduleSize, y / moduleSize))
+				image.set(left + x, top + y);
+
+	auto res = Detector::Detect(image, false, false, true);
+	ASSERT_TRUE(res.isValid());
+	EXPECT_EQ(res.bits().width(), symbol.width());
+	EXPECT_EQ(res.bits().height(), symbol.height());
+	for (int y = 0; y < symbol.height(); ++y)
+		for (int x = 0; x < symbol.width(); ++x)
+			EXPECT_EQ(res.bits().get(x, y), symbol.get(x, y)) << x << ", " << y;
+	EXPECT_EQ(Decoder::Decode(res.bits()).text(), L"pure symbol");
+}
@@ -19,6 +19,7 @@
 #include "datamatrix/DMSymbolShape.h"
 #include "DecoderResult.h"
 #include "BitMatrixIO.h"
+#include "PseudoRandom.h"
 
 #include <algorithm>
 #ifndef NDEBUG
@@ -39,11 +40,13 @@ using namespace ZXing;
 
 namespace {
 
-	void TestEncodeDecode(const std::wstring& data, DataMatrix::SymbolShape shape = DataMatrix::SymbolShape::NONE)
+	void TestEncodeDecode(const std::wstring& data, DataMatrix::SymbolShape shape = DataMatrix::SymbolShape::NONE,
+						  bool minimal = false)
 	{
 		DataMatrix::Writer writer;
 		writer.setMargin(0);
 		writer.setShapeHint(shape);
+		writer.setMinimalEncoding(minimal);
 		BitMatrix matrix = writer.encode(data, 0, 0);
 		ASSERT_EQ(matrix.empty(), false);
 
@@ -134,3 +137,38 @@ TEST(DMEncodeDecodeTest, EDIFACTWithEOD)
 			TestEncodeDecode(data, shape);
 }
 
+
+TEST(DMEncodeDecodeTest, MinimalEncoding)
+{
+	using namespace DataMatrix;
+	std::wstring text[] = {
+		L"Abc123!",
+		L"AIMAIMAIM",
+		L"abc<->ABCDE",
+		L"<ABCDEFG><ABCDEFGK>",
+		L"*CH/GN1/022/00",
+		L"*MEMANT-1F-MESTECH",
+		L"http://test/~!@#*^%&)__ ;:'\"[]{}\\|-+-=`1029384",
+		L"\xAB\xE4\xF6\xFC\xE9\xE0\xE1-\xB7\xB7\xB7\xBB",
+		L"[)>\x1E""05\x1D""5555\x1C""6666\x1E\x04",
+	};
+	for (auto data : text)
+		for (size_t len = 1; len <= data.size(); ++len)
+			for (auto shape : {SymbolShape::NONE, SymbolShape::SQUARE, SymbolShape::RECTANGLE})
+				TestEncodeDecode(data.substr(0, len), shape, true);
+
+	// random mixes of the character sets of the different encodations, including Base 256 segments > 249 bytes
+	const std::wstring alphabet = L"0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ abcdefghijklmnopqrstuvwxyz*>\r<=-/\x1D\xE4\xFC";
+	PseudoRandom random(42);
+	for (int i = 0; i < 200; ++i) {
+		std::wstring data;
+		int len = random.next(1, i < 190 ? 60 : 600);
+		for (int j = 0; j < len;) {
+			// runs of characters of one kind give the encoder a reason to switch modes
+			int first = random.next(0, Size(alphabet) - 1), run = random.next(1, 12);
+			for (int k = 0; k < run && j < len; ++k, ++j)
+				data.push_back(alphabet[std::min(Size(alphabet) - 1, first + random.next(0, 5))]);
+		}
+		TestEncodeDecode(data, SymbolShape::NONE, true);
+	}
+}
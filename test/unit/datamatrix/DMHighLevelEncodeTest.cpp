@@ -362,6 +362,34 @@ TEST(DMHighLevelEncodeTest, EDIFACTWithEODBug)
     EXPECT_EQ(visualized, "98 99 100 240 242 223 129 8 49 5 129 147");
 }
 
+TEST(DMHighLevelEncodeTest, MinimalEncoding)
+{
+	auto encodeMinimal = [](const std::wstring& text) {
+		return Visualize(DataMatrix::HighLevelEncoder::EncodeMinimal(text, DataMatrix::SymbolShape::NONE, -1, -1, -1, -1));
+	};
+
+	// same as Encode
+	EXPECT_EQ(encodeMinimal(L"123456"), "142 164 186");
+	EXPECT_EQ(encodeMinimal(L"AIMAIMAIM"), "230 91 11 91 11 91 11 254");
+
+	// the look ahead test latches to X12 and needs a 10 codeword symbol, staying in ASCII fits into 8
+	EXPECT_EQ(HighLevelEncode(L"6F >G>ae"), "238 65 124 254 63 72 63 98 102 129");
+	EXPECT_EQ(encodeMinimal(L"6F >G>ae"), "55 71 33 63 72 63 98 102");
+
+	std::wstring text[] = {
+		L"abc<->ABCDE",
+		L"*MEMANT-1F-MESTECH",
+		L"Lorem ipsum. http://test/",
+		L"AAAANAAAANAAAANAAAANAAAANAAAANAAAANAAAANAAAANAAAAN",
+		CreateBinaryMessage(20),
+		CreateBinaryMessage(300),
+	};
+	for (auto& msg : text)
+		EXPECT_LE(Size(DataMatrix::HighLevelEncoder::EncodeMinimal(msg, DataMatrix::SymbolShape::NONE, -1, -1, -1, -1)),
+				  Size(DataMatrix::HighLevelEncoder::Encode(msg)))
+			<< std::string(msg.begin(), msg.end());
+}
+
 //  @Ignore
 //  @Test  
 //  public void testDataURL() {
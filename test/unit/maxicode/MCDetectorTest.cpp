@@ -0,0 +1,175 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "gtest/gtest.h"
+#include "BitMatrix.h"
+#include "DetectorResult.h"
+#include "PerspectiveTransform.h"
+#include "PseudoRandom.h"
+#include "maxicode/MCDetector.h"
+
+#include <cmath>
+
+using namespace ZXing;
+using namespace ZXing::MaxiCode;
+
+namespace {
+
+const int WIDTH = 30;
+const int HEIGHT = 33;
+const double ROW_PITCH = 0.87;
+const double PI = 3.14159265358979323846;
+
+// the black and white rings are equally wide, the middle of the outer black one 4.2 module pitches from the center
+const double RING_WIDTH = 4.2 / 5.5;
+const double DOT_RADIUS = 0.45;
+
+// the symbol plane position of the center of module (x, y), in module pitches from the center of the bull's eye
+PointF ModuleCenter(int x, int y)
+{
+	return {x + (y & 1 ? 1.0 : 0.5) - 14.5, (y + 0.5 - 16.5) * ROW_PITCH};
+}
+
+bool IsModule(int x, int y)
+{
+	return x >= 0 && y >= 0 && y < HEIGHT && x < WIDTH - (y & 1)
+		   && distance(ModuleCenter(x, y), PointF()) > 6 * RING_WIDTH + 0.5;
+}
+
+BitMatrix RandomSymbol(size_t seed)
+{
+	const struct { int x, y; bool black; } orientation[] = {
+		{10, 9, true}, {11, 9, true}, {11, 10, true},
+		{17, 9, false}, {17, 10, false}, {18, 10, false},
+		{7, 15, true}, {7, 16, false}, {8, 16, true},
+		{20, 16, true}, {21, 16, false}, {20, 17, true},
+		{10, 22, true}, {11, 22, false}, {10, 23, true},
+		{17, 22, true}, {16, 23, false}, {17, 23, true},
+	};
+
+	PseudoRandom random(seed);
+	BitMatrix symbol(WIDTH, HEIGHT);
+	for (int y = 0; y < HEIGHT; ++y)
+		for (int x = 0; x < WIDTH - (y & 1); ++x)
+			symbol.set(x, y, random.next(0, 1) == 1);
+	for (auto& module : orientation)
+		symbol.set(module.x, module.y, module.black);
+	return symbol;
+}
+
+/**
+* The camera view of the symbol plane, module pitch pixels per module pitch: the symbol is turned by spin within its
+* plane, the plane tilted away so that the top edge of the view is foreshortened by the given factor, mirrored and
+* the view rotated by rotation degrees.
+*/
+PerspectiveTransform ImageToSymbol(double pitch, double spin, double foreshortening, bool mirror, double rotation,
+								   PointF center)
+{
+	const double h = 18;
+	QuadrilateralF symbol, image;
+	PointF square[] = {{-h, -h}, {h, -h}, {h, h}, {-h, h}};
+	PointF view[] = {{-h * (1 - foreshortening), -h}, {h * (1 - foreshortening), -h}, {h, h}, {-h, h}};
+	auto rotate = [](PointF p, double degrees) {
+		double c = std::cos(degrees * PI / 180), s = std::sin(degrees * PI / 180);
+		return PointF(c * p.x - s * p.y, s * p.x + c * p.y);
+	};
+	for (int i = 0; i < 4; ++i) {
+		symbol[i] = rotate(square[i], spin);
+		PointF v = pitch * view[i];
+		image[i] = center + rotate(mirror ? PointF(-v.x, v.y) : v, rotation);
+	}
+	return {image, symbol};
+}
+
+/**
+* Draws the modules as round dots and the bull's eye as rings. With speckle, a pixel in every 30 is set in the quiet
+* zone from 2 module pitches around the symbol on, like the binarizer does with the noise of a flat background.
+*/
+BitMatrix Render(const BitMatrix& symbol, const PerspectiveTransform& imageToSymbol, int size, bool speckle = false)
+{
+	PseudoRandom random(size);
+	BitMatrix image(size, size);
+	for (int y = 0; y < size; ++y)
+		for (int x = 0; x < size; ++x) {
+			auto p = imageToSymbol(PointF(x + 0.5, y + 0.5));
+			double r = distance(p, PointF());
+			if (r < 6 * RING_WIDTH) {
+				image.set(x, y, static_cast<int>(r / RING_WIDTH) % 2 == 1);
+				continue;
+			}
+			if (speckle && (std::abs(p.x) > 17 || std::abs(p.y) > 16.5) && random.next(0, 29) == 0) {
+				image.set(x, y);
+				continue;
+			}
+			int row = static_cast<int>(std::lround(p.y / ROW_PITCH + 16));
+			for (int my = row - 1; my <= row + 1; ++my) {
+				int mx = static_cast<int>(std::lround(p.x + 14.5 - (my & 1 ? 1.0 : 0.5)));
+				if (IsModule(mx, my) && symbol.get(mx, my) && distance(p, ModuleCenter(mx, my)) < DOT_RADIUS)
+					image.set(x, y);
+			}
+		}
+	return image;
+}
+
+void CheckDetect(const BitMatrix& image, const BitMatrix& symbol)
+{
+	auto bullsEyes = Detector::FindBullsEyes(image);
+	ASSERT_FALSE(bullsEyes.empty());
+	auto res = Detector::Detect(image, bullsEyes.front());
+	ASSERT_TRUE(res.isValid());
+	int errors = 0;
+	for (int y = 0; y < HEIGHT; ++y)
+		for (int x = 0; x < WIDTH; ++x)
+			errors += IsModule(x, y) && res.bits().get(x, y) != symbol.get(x, y);
+	EXPECT_EQ(errors, 0);
+}
+
+} // namespace
+
+TEST(MCDetectorTest, Rotated)
+{
+	auto symbol = RandomSymbol(1);
+	for (bool mirror : {false, true})
+		for (double rotation : {0, 20, 45, 90, 135, 200, 290, 333}) {
+			SCOPED_TRACE(testing::Message() << "mirror " << mirror << ", rotation " << rotation);
+			CheckDetect(Render(symbol, ImageToSymbol(6, 0, 0, mirror, rotation, {160, 160}), 320), symbol);
+		}
+}
+
+TEST(MCDetectorTest, Tilted)
+{
+	auto symbol = RandomSymbol(2);
+	for (double foreshortening : {0.05, 0.1, 0.15})
+		for (double spin : {0, 35, 90, 160, 250})
+			for (bool mirror : {false, true}) {
+				SCOPED_TRACE(testing::Message() << "foreshortening " << foreshortening << ", spin " << spin
+												<< ", mirror " << mirror);
+				auto imageToSymbol = ImageToSymbol(7, spin, foreshortening, mirror, 25, {180, 180});
+				CheckDetect(Render(symbol, imageToSymbol, 360), symbol);
+			}
+}
+
+TEST(MCDetectorTest, SpeckledQuietZone)
+{
+	// the specks must neither be taken for modules at the outer edges nor make the detector give up on an edge
+	auto symbol = RandomSymbol(3);
+	for (double foreshortening : {0.0, 0.12})
+		for (double spin : {0, 45, 110}) {
+			SCOPED_TRACE(testing::Message() << "foreshortening " << foreshortening << ", spin " << spin);
+			auto imageToSymbol = ImageToSymbol(7, spin, foreshortening, false, 0, {180, 180});
+			CheckDetect(Render(symbol, imageToSymbol, 360, true), symbol);
+		}
+}
@@ -0,0 +1,64 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "BitMatrix.h"
+#include "DecodeHints.h"
+#include "Pattern.h"
+#include "Result.h"
+#include "oned/ODITFReader.h"
+#include "oned/ODITFWriter.h"
+
+#include "gtest/gtest.h"
+
+#include <memory>
+#include <string>
+
+using namespace ZXing;
+using namespace ZXing::OneD;
+
+namespace {
+	std::wstring Decode(const std::wstring& input, const DecodeHints& hints = {})
+	{
+		auto matrix = ITFWriter().encode(input, 0, 0);
+		PatternRow row;
+		GetPatternRow(matrix, 0, row);
+		std::unique_ptr<RowReader::DecodingState> state;
+		auto result = ITFReader(hints).decodePattern(0, PatternView(row), state);
+		return result.isValid() ? result.text() : L"<invalid>";
+	}
+}
+
+TEST(ODITFReaderTest, DecodeAllPairs)
+{
+	// the writer accepts at most 80 digits
+	for (int first = 0; first < 100; first += 20) {
+		std::wstring input;
+		for (int i = first; i < first + 20; ++i)
+			input += std::to_wstring(i / 10) + std::to_wstring(i % 10);
+		EXPECT_EQ(Decode(input), input);
+	}
+}
+
+TEST(ODITFReaderTest, AllowedLengths)
+{
+	EXPECT_EQ(Decode(L"00123456789012"), L"00123456789012");
+	EXPECT_EQ(Decode(L"00123456789012", DecodeHints().setAllowedLengths({10, 14})), L"00123456789012");
+	EXPECT_EQ(Decode(L"00123456789012", DecodeHints().setAllowedLengths({16})), L"<invalid>");
+	// longer than the longest allowed length is accepted
+	EXPECT_EQ(Decode(L"00123456789012", DecodeHints().setAllowedLengths({10})), L"00123456789012");
+	// too short for a symbol of the shortest allowed length
+	EXPECT_EQ(Decode(L"12345678", DecodeHints().setAllowedLengths({14})), L"<invalid>");
+}
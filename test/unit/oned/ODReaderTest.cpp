@@ -0,0 +1,193 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "Deadline.h"
+#include "DecodeHints.h"
+#include "ImageUtility.h"
+#include "ReadBarcode.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+using namespace ZXing;
+using namespace ZXing::Utility;
+
+// a 400x300 image with a Code 128 in the upper and an EAN-13 in the lower half
+static Matrix<uint8_t> TwoSymbols()
+{
+	Matrix<uint8_t> img(400, 300, 255);
+	Paste(img, Render(BarcodeFormat::CODE_128, L"upper", 220, 60), 90, 40);
+	Paste(img, Render(BarcodeFormat::EAN_13, L"4006381333931", 220, 60), 90, 200);
+	return img;
+}
+
+TEST(ODReaderTest, RowScanThreads)
+{
+	auto img = TwoSymbols();
+	auto view = View(img);
+	auto hints = DecodeHints().setFormats(BarcodeFormat::CODE_128 | BarcodeFormat::EAN_13).setTryRotate(false);
+	hints.setTryHarder(true);
+	auto byText = [](const Result& a, const Result& b) { return a.text() < b.text(); };
+
+	auto expected = ReadBarcode(view, hints);
+	ASSERT_TRUE(expected.isValid());
+	auto expectedAll = ReadBarcodes(view, hints);
+	ASSERT_EQ(expectedAll.size(), 2);
+	std::sort(expectedAll.begin(), expectedAll.end(), byText);
+
+	// the rows are split across the threads, the row closest to the center still wins
+	for (int threads : {2, 3, 8}) {
+		auto threaded = DecodeHints(hints).setRowScanThreads(threads);
+		auto result = ReadBarcode(view, threaded);
+		EXPECT_EQ(result.text(), expected.text()) << threads;
+		EXPECT_EQ(result.position(), expected.position()) << threads;
+
+		auto results = ReadBarcodes(view, threaded);
+		ASSERT_EQ(results.size(), 2) << threads;
+		std::sort(results.begin(), results.end(), byText);
+		for (int i = 0; i < 2; ++i) {
+			EXPECT_EQ(results[i].text(), expectedAll[i].text()) << threads;
+			EXPECT_EQ(results[i].position(), expectedAll[i].position()) << threads;
+		}
+		EXPECT_EQ(ReadBarcodes(view, DecodeHints(threaded).setMaxNumberOfSymbols(1)).size(), 1) << threads;
+	}
+
+	// the workers install the deadline of the caller
+	auto expired = Deadline::Cancellable();
+	expired.cancel();
+	Deadline::Scope scope(expired);
+	EXPECT_FALSE(ReadBarcode(view, DecodeHints(hints).setRowScanThreads(4)).isValid());
+}
+
+TEST(ODReaderTest, MinLineCount)
+{
+	// a Code 128 only 30 pixels high in the middle of the image, the default scan without tryHarder crosses it a few
+	// times, the one with tryHarder in every row
+	Matrix<uint8_t> img(400, 300, 255);
+	Paste(img, Render(BarcodeFormat::CODE_128, L"lines", 220, 30), 90, 135);
+	auto view = View(img);
+	auto hints = DecodeHints().setFormats(BarcodeFormat::CODE_128).setTryRotate(false).setTryHarder(false);
+
+	auto result = ReadBarcode(view, hints);
+	ASSERT_TRUE(result.isValid());
+	EXPECT_EQ(result.lineCount(), 1);
+
+	result = ReadBarcode(view, DecodeHints(hints).setMinLineCount(3));
+	ASSERT_TRUE(result.isValid());
+	EXPECT_EQ(result.text(), L"lines");
+	EXPECT_EQ(result.lineCount(), 3);
+
+	EXPECT_FALSE(ReadBarcode(view, DecodeHints(hints).setMinLineCount(10)).isValid());
+	for (int threads : {1, 4}) {
+		auto denser = DecodeHints(hints).setMinLineCount(10).setTryHarder(true).setRowScanThreads(threads);
+		result = ReadBarcode(view, denser);
+		ASSERT_TRUE(result.isValid()) << threads;
+		EXPECT_EQ(result.lineCount(), 10) << threads;
+		EXPECT_EQ(ReadBarcodes(view, denser).size(), 1) << threads;
+	}
+
+	// both symbols of the other image are crossed often enough, 2D symbols have no line count
+	auto two = TwoSymbols();
+	auto both = DecodeHints().setFormats(BarcodeFormat::CODE_128 | BarcodeFormat::EAN_13).setMinLineCount(5);
+	EXPECT_EQ(ReadBarcodes(View(two), both.setTryHarder(true)).size(), 2);
+	auto qr = Render(BarcodeFormat::QR_CODE, L"2d", 120, 120);
+	result = ReadBarcode(View(qr), DecodeHints().setMinLineCount(5));
+	ASSERT_TRUE(result.isValid());
+	EXPECT_EQ(result.lineCount(), 0);
+}
+
+TEST(ODReaderTest, AdaptiveRowOrder)
+{
+	// a Code 128 close to the top edge, outside of the middle half scanned without tryHarder
+	Matrix<uint8_t> img(400, 300, 255);
+	Paste(img, Render(BarcodeFormat::CODE_128, L"top", 200, 30), 100, 5);
+	auto view = View(img);
+	auto hints = DecodeHints().setFormats(BarcodeFormat::CODE_128).setTryRotate(false);
+
+	EXPECT_FALSE(ReadBarcode(view, hints).isValid());
+
+	for (bool tryHarder : {false, true}) {
+		auto result = ReadBarcode(view, DecodeHints(hints).setTryHarder(tryHarder).setAdaptiveRowOrder(true));
+		ASSERT_TRUE(result.isValid()) << tryHarder;
+		EXPECT_EQ(result.text(), L"top");
+		EXPECT_LT(result.position().topLeft().y, 40);
+	}
+
+	// a symbol in the middle is found as before
+	Matrix<uint8_t> normal(400, 300, 255);
+	Paste(normal, Render(BarcodeFormat::CODE_128, L"middle", 200, 60), 100, 120);
+	auto result = ReadBarcode(View(normal), DecodeHints(hints).setAdaptiveRowOrder(true));
+	ASSERT_TRUE(result.isValid());
+	EXPECT_EQ(result.text(), L"middle");
+}
+
+TEST(ODReaderTest, TryOmnidirectional)
+{
+	auto symbol = Render(BarcodeFormat::CODE_128, L"angled", 440, 60);
+	auto hints = DecodeHints().setFormats(BarcodeFormat::CODE_128).setTryRotate(false);
+
+	for (int degrees : {20, 30, 45, 60, 135}) {
+		// the symbol (4 pixels per module) rotated clockwise around the center of a 500x500 image
+		Matrix<uint8_t> img(500, 500, 255);
+		double radians = degrees * 3.14159265358979323846 / 180;
+		double c = std::cos(radians), s = std::sin(radians);
+		for (int y = 0; y < 500; ++y)
+			for (int x = 0; x < 500; ++x) {
+				double u = c * (x - 250) + s * (y - 250) + symbol.width() / 2.;
+				double v = -s * (x - 250) + c * (y - 250) + symbol.height() / 2.;
+				if (u >= 0 && v >= 0 && u < symbol.width() && v < symbol.height())
+					img.set(x, y, symbol.get(int(u), int(v)));
+			}
+		auto view = View(img);
+
+		EXPECT_FALSE(ReadBarcode(view, hints).isValid()) << degrees;
+
+		auto result = ReadBarcode(view, DecodeHints(hints).setTryOmnidirectional(true));
+		ASSERT_TRUE(result.isValid()) << degrees;
+		EXPECT_EQ(result.text(), L"angled");
+		// within the 22.5 degree step of the scan lines
+		int orientation = result.metadata().getInt(ResultMetadata::ORIENTATION);
+		EXPECT_LE(std::abs((orientation + degrees + 180) % 360 - 180), 23) << degrees << " " << orientation;
+	}
+}
+
+TEST(ODReaderTest, MultipleSymbolsPerRow)
+{
+	// a shelf edge with 4 EAN-13 labels in one row, two of them identical
+	Matrix<uint8_t> img(800, 100, 255);
+	int left = 0;
+	for (auto text : {L"4006381333931", L"5901234123457", L"4006381333931", L"9780201379624"}) {
+		Paste(img, Render(BarcodeFormat::EAN_13, text, 190, 60), left, 20);
+		left += 200;
+	}
+	auto view = View(img);
+
+	auto results = ReadBarcodes(view, DecodeHints().setFormats(BarcodeFormat::EAN_13));
+	ASSERT_EQ(results.size(), 4);
+	std::sort(results.begin(), results.end(),
+			  [](const Result& a, const Result& b) { return a.position().topLeft().x < b.position().topLeft().x; });
+	EXPECT_EQ(results[0].text(), L"4006381333931");
+	EXPECT_EQ(results[1].text(), L"5901234123457");
+	EXPECT_EQ(results[2].text(), L"4006381333931");
+	EXPECT_EQ(results[3].text(), L"9780201379624");
+
+	// a single symbol is still the first one found
+	EXPECT_TRUE(ReadBarcode(view, DecodeHints().setFormats(BarcodeFormat::EAN_13)).isValid());
+}
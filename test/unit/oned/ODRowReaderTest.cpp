@@ -0,0 +1,151 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "BitMatrix.h"
+#include "DecodeHints.h"
+#include "GenericLuminanceSource.h"
+#include "GlobalHistogramBinarizer.h"
+#include "Pattern.h"
+#include "Result.h"
+#include "ZXContainerAlgorithms.h"
+#include "oned/ODCode128Patterns.h"
+#include "oned/ODCode39Reader.h"
+#include "oned/ODCode39Writer.h"
+#include "oned/ODRowReader.h"
+#include "oned/ODUPCEANCommon.h"
+
+#include "gtest/gtest.h"
+
+#include <array>
+#include <cmath>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace ZXing;
+using namespace ZXing::OneD;
+
+TEST(ODRowReaderTest, PatternTableLookup)
+{
+	PatternTable<4, 7, std::array<UPCEANReader::Digit, 20>> table(UPCEANCommon::L_AND_G_PATTERNS);
+	for (int i = 0; i < 20; ++i) {
+		auto counters = UPCEANCommon::L_AND_G_PATTERNS[i];
+		EXPECT_EQ(table.lookup(counters), i);
+		for (auto& c : counters)
+			c *= 3;
+		EXPECT_EQ(table.lookup(counters), i);
+	}
+	EXPECT_EQ(table.lookup(UPCEANReader::Digit{1, 1, 1, 1}), -1);
+	EXPECT_EQ(table.lookup(UPCEANReader::Digit{0, 3, 2, 2}), -1);
+}
+
+// the table lookup must give the same result as the variance search over all patterns
+TEST(ODRowReaderTest, DecodeDigitWithTable)
+{
+	std::mt19937 rng(42);
+	std::uniform_int_distribution<int> noise(-2, 2);
+
+	PatternTable<6, 11, std::array<std::vector<int>, 107>> code128(Code128::CODE_PATTERNS);
+	for (int n = 0; n < 10000; ++n) {
+		std::vector<int> counters(6);
+		for (int i = 0; i < 6; ++i)
+			counters[i] = std::max(0, Code128::CODE_PATTERNS[n % 107][i] * 4 + noise(rng));
+		EXPECT_EQ(RowReader::DecodeDigit(counters, code128, 0.25f, 0.7f),
+				  RowReader::DecodeDigit(counters, Code128::CODE_PATTERNS, 0.25f, 0.7f));
+	}
+
+	PatternTable<4, 7, std::array<UPCEANReader::Digit, 20>> upcean(UPCEANCommon::L_AND_G_PATTERNS);
+	for (int n = 0; n < 10000; ++n) {
+		UPCEANReader::Digit counters;
+		for (int i = 0; i < 4; ++i)
+			counters[i] = std::max(0, UPCEANCommon::L_AND_G_PATTERNS[n % 20][i] * 3 + noise(rng));
+		EXPECT_EQ(RowReader::DecodeDigit(counters, upcean, 0.48f, 0.7f, false),
+				  RowReader::DecodeDigit(counters, UPCEANCommon::L_AND_G_PATTERNS, 0.48f, 0.7f, false));
+	}
+}
+
+// the direct lookup must give the same character as the linear search, for every possible bit pattern
+TEST(ODRowReaderTest, BitPatternTable)
+{
+	static const char ALPHABET[] = "0123456789-$:/.+ABCD";
+	static const int ENCODINGS[] = {0x03, 0x06, 0x09, 0x60, 0x12, 0x42, 0x21, 0x24, 0x30, 0x48,
+									0x0c, 0x18, 0x45, 0x51, 0x54, 0x15, 0x1A, 0x29, 0x0B, 0x0E};
+	BitPatternTable<7> table(ENCODINGS, ALPHABET);
+	for (int pattern = -1; pattern < 256; ++pattern)
+		EXPECT_EQ(table[pattern], RowReader::LookupBitPattern(pattern, ENCODINGS, ALPHABET)) << pattern;
+}
+
+// a row with the given Code 39 symbols starting at the given x positions
+static PatternRow Row(const std::vector<std::pair<std::wstring, int>>& symbols)
+{
+	std::vector<bool> bits(400, false);
+	for (auto& s : symbols) {
+		auto matrix = Code39Writer().encode(s.first, 0, 0);
+		for (int x = 0; x < matrix.width(); ++x)
+			bits[s.second + x] = matrix.get(x, 0);
+	}
+	PatternRow res = {0};
+	bool color = false;
+	for (bool bit : bits) {
+		if (bit != color) {
+			res.push_back(0);
+			color = bit;
+		}
+		++res.back();
+	}
+	return res;
+}
+
+TEST(ODRowReaderTest, DecodeNearPreviousSymbol)
+{
+	Code39Reader reader(DecodeHints{});
+	auto row = Row({{L"B2", 10}, {L"A1", 200}});
+
+	std::unique_ptr<RowReader::DecodingState> state;
+	EXPECT_EQ(reader.decodePattern(0, PatternView(row), state).text(), L"B2");
+
+	// after finding A1 in one row, the next row is first searched around its start
+	state.reset();
+	EXPECT_EQ(reader.decodePattern(0, PatternView(Row({{L"A1", 200}})), state).text(), L"A1");
+	EXPECT_EQ(reader.decodePattern(1, PatternView(row), state).text(), L"A1");
+}
+
+TEST(ODRowReaderTest, SubPixelPatternRow)
+{
+	// bars of 6 and 9 pixels with every edge blurred over one gray pixel
+	std::vector<uint8_t> row;
+	for (int i = 0; i < 8; ++i) {
+		row.insert(row.end(), i % 2 ? 9 : 6, i % 2 ? 0 : 255);
+		row.push_back(128);
+	}
+	row.insert(row.end(), 6, 255);
+	int width = Size(row);
+	GlobalHistogramBinarizer binarizer(std::make_shared<GenericLuminanceSource>(width, 1, row.data(), width));
+
+	PatternRow bars;
+	SubPixelPatternRow widths;
+	ASSERT_TRUE(binarizer.getSubPixelPatternRow(0, bars, widths));
+	ASSERT_EQ(widths.size(), bars.size());
+	EXPECT_NEAR(std::accumulate(widths.begin(), widths.end(), 0.f), width, 0.01f);
+	for (size_t i = 0; i < bars.size(); ++i)
+		EXPECT_LE(std::abs(widths[i] - bars[i]), 1.f);
+
+	PatternView view(bars, widths);
+	EXPECT_TRUE(view.hasSubPixelWidths());
+	EXPECT_FALSE(PatternView(bars).hasSubPixelWidths());
+}
@@ -0,0 +1,76 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "BitArray.h"
+#include "BitArrayUtility.h"
+#include "DecodeHints.h"
+#include "Result.h"
+#include "oned/ODMultiUPCEANReader.h"
+
+#include "gtest/gtest.h"
+
+#include <memory>
+#include <string>
+
+using namespace ZXing;
+using namespace ZXing::OneD;
+
+// EAN-13 5901234123457, one pixel per module
+static const std::string MAIN = "101" "0001011" "0100111" "0110011" "0010011" "0111101" "0011101" "01010"
+								"1100110" "1101100" "1000010" "1011100" "1001110" "1000100" "101";
+// 2 digit extension 12: start guard, 1 and 2 in L parity with a separator
+static const std::string EXTENSION = "1011" "0011001" "01" "0010011";
+
+static Result Decode(const RowReader& reader, const std::string& row, std::unique_ptr<RowReader::DecodingState>& state)
+{
+	return reader.decodeRow(0, Utility::ParseBitArray(row, '1'), state);
+}
+
+TEST(ODUPCEANExtensionTest, Window)
+{
+	MultiUPCEANReader reader(DecodeHints().setFormats(BarcodeFormat::EAN_13));
+	std::unique_ptr<RowReader::DecodingState> state;
+	auto quiteZone = std::string(10, '0');
+
+	// the extension is expected 7 to 12 modules right of the main symbol
+	auto result = Decode(reader, quiteZone + MAIN + std::string(9, '0') + EXTENSION + quiteZone, state);
+	ASSERT_TRUE(result.isValid());
+	EXPECT_EQ(result.metadata().getString(ResultMetadata::UPC_EAN_EXTENSION), L"12");
+
+	state.reset();
+	result = Decode(reader, quiteZone + MAIN + std::string(30, '0') + EXTENSION + quiteZone, state);
+	ASSERT_TRUE(result.isValid());
+	EXPECT_EQ(result.metadata().getString(ResultMetadata::UPC_EAN_EXTENSION), L"");
+}
+
+TEST(ODUPCEANExtensionTest, Cache)
+{
+	MultiUPCEANReader reader(DecodeHints().setFormats(BarcodeFormat::EAN_13).setAllowedEanExtensions({2}));
+	std::unique_ptr<RowReader::DecodingState> state;
+	auto quiteZone = std::string(10, '0');
+	auto withExtension = quiteZone + MAIN + std::string(9, '0') + EXTENSION + quiteZone;
+	auto withoutExtension = quiteZone + MAIN + std::string(9 + EXTENSION.size(), '0') + quiteZone;
+
+	// a row that misses the extension is rejected until it has been seen next to the same main symbol
+	EXPECT_FALSE(Decode(reader, withoutExtension, state).isValid());
+	EXPECT_TRUE(Decode(reader, withExtension, state).isValid());
+	auto result = Decode(reader, withoutExtension, state);
+	ASSERT_TRUE(result.isValid());
+	EXPECT_EQ(result.metadata().getString(ResultMetadata::UPC_EAN_EXTENSION), L"12");
+
+	// but only if the main symbol ends at about the same position
+	EXPECT_FALSE(Decode(reader, std::string(20, '0') + withoutExtension, state).isValid());
+}
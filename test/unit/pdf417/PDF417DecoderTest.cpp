@@ -16,6 +16,7 @@
 */
 #include "gtest/gtest.h"
 #include "DecodeStatus.h"
+#include "DecoderResult.h"
 #include "pdf417/PDFDecodedBitStreamParser.h"
 #include "pdf417/PDFDecoderResultExtra.h"
 
@@ -111,3 +112,42 @@ TEST(PDF417DecoderTest, SampleWithNumericValues)
 	EXPECT_EQ(30, resultMetadata.fileSize());
 	EXPECT_EQ(260013, resultMetadata.checksum());
 }
+
+TEST(PDF417DecoderTest, InvalidMacroBlock)
+{
+	int next = 0;
+	DecoderResultExtra resultMetadata;
+
+	// a byte compaction latch after the file id is neither an optional field nor the terminator, this used to loop
+	// forever because the error check was unreachable
+	std::vector<int> unexpectedCodeword = { 8, 477, 928, 111, 100, 0, 252, 901, 0 };
+	EXPECT_EQ(DecodeStatus::FormatError, DecodeMacroBlock(unexpectedCodeword, 3, resultMetadata, next));
+
+	// 7 is not an optional field designator
+	std::vector<int> unknownField = { 9, 477, 928, 111, 100, 0, 252, 923, 7, 0 };
+	EXPECT_EQ(DecodeStatus::FormatError, DecodeMacroBlock(unknownField, 3, resultMetadata, next));
+
+	// an empty segment count and one that does not fit into an int
+	std::vector<int> emptyNumber = { 10, 477, 928, 111, 100, 0, 252, 923, 1, 922, 0 };
+	EXPECT_EQ(DecodeStatus::FormatError, DecodeMacroBlock(emptyNumber, 3, resultMetadata, next));
+	std::vector<int> hugeNumber = { 13, 477, 928, 111, 100, 0, 252, 923, 1, 1, 0, 0, 0, 0 };
+	EXPECT_EQ(DecodeStatus::FormatError, DecodeMacroBlock(hugeNumber, 3, resultMetadata, next));
+
+	// the whole symbol is rejected, too
+	auto result = DecodedBitStreamParser::Decode(unexpectedCodeword, 0);
+	EXPECT_FALSE(result.isValid());
+}
+
+TEST(PDF417DecoderTest, NumericCompaction)
+{
+	// a full group of 15 codewords (44 digits) followed by the one of the example in PDFDecodedBitStreamParser.cpp
+	std::vector<int> sampleCodes = { 23, 902, 442, 468, 658, 254, 249, 833, 72, 640, 676, 489, 54, 267, 648, 11, 223,
+		1, 624, 434, 632, 282, 200,
+		// error correction codewords
+		0, 0 };
+
+	auto result = DecodedBitStreamParser::Decode(sampleCodes, 0);
+
+	EXPECT_EQ(true, result.isValid());
+	EXPECT_EQ(L"01234567890123456789012345678901234567890123000213298174000", result.text());
+}
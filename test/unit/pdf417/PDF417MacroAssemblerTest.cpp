@@ -0,0 +1,91 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#include "gtest/gtest.h"
+#include "pdf417/PDFMacroAssembler.h"
+#include "pdf417/PDFDecoderResultExtra.h"
+
+#include <memory>
+
+using namespace ZXing;
+using namespace ZXing::Pdf417;
+
+static Result MakeSegment(std::wstring text, const std::string& fileId, int index, int count = -1, bool last = false)
+{
+	auto extra = std::make_shared<DecoderResultExtra>();
+	extra->setFileId(fileId);
+	extra->setSegmentIndex(index);
+	extra->setSegmentCount(count);
+	extra->setLastSegment(last);
+	Result res(std::move(text), {}, BarcodeFormat::PDF_417);
+	res.metadata().put(ResultMetadata::PDF417_EXTRA_METADATA, extra);
+	return res;
+}
+
+TEST(PDF417MacroAssemblerTest, Assemble)
+{
+	MacroAssembler assembler;
+	EXPECT_FALSE(assembler.add(MakeSegment(L"C", "ARBX", 2, -1, true)).isValid());
+	EXPECT_FALSE(assembler.add(MakeSegment(L"A", "ARBX", 0)).isValid());
+	EXPECT_TRUE(assembler.hasSegment("ARBX", 0));
+	EXPECT_FALSE(assembler.hasSegment("ARBX", 1));
+	// duplicates and symbols without a control block are ignored
+	EXPECT_FALSE(assembler.add(MakeSegment(L"A", "ARBX", 0)).isValid());
+	EXPECT_FALSE(assembler.add(MakeSegment(L"plain", "", 0)).isValid());
+	EXPECT_FALSE(assembler.add(Result(L"plain", {}, BarcodeFormat::PDF_417)).isValid());
+	EXPECT_FALSE(assembler.add(MakeSegment(L"x", "OTHER", 0, 2)).isValid());
+	EXPECT_EQ(assembler.pendingFiles(), 2);
+
+	auto res = assembler.add(MakeSegment(L"B", "ARBX", 1));
+	ASSERT_TRUE(res.isValid());
+	EXPECT_EQ(res.text(), L"ABC");
+	EXPECT_EQ(res.format(), BarcodeFormat::PDF_417);
+	auto extra = std::dynamic_pointer_cast<DecoderResultExtra>(res.metadata().getCustomData(ResultMetadata::PDF417_EXTRA_METADATA));
+	ASSERT_NE(extra, nullptr);
+	EXPECT_EQ(extra->fileId(), "ARBX");
+	EXPECT_EQ(extra->segmentIndex(), 0);
+	EXPECT_EQ(assembler.pendingFiles(), 1);
+	EXPECT_FALSE(assembler.hasSegment("ARBX", 0));
+
+	// the segment count field completes a file without a segment marked as the last one
+	EXPECT_EQ(assembler.add(MakeSegment(L"y", "OTHER", 1, 2)).text(), L"xy");
+	EXPECT_EQ(assembler.pendingFiles(), 0);
+}
+
+TEST(PDF417MacroAssemblerTest, BoundedState)
+{
+	MacroAssembler assembler(2);
+	assembler.add(MakeSegment(L"a", "1", 0));
+	assembler.add(MakeSegment(L"b", "2", 0));
+	assembler.add(MakeSegment(L"a", "1", 0)); // refreshes file 1
+	assembler.add(MakeSegment(L"c", "3", 0)); // evicts file 2
+	EXPECT_EQ(assembler.pendingFiles(), 2);
+	EXPECT_TRUE(assembler.hasSegment("1", 0));
+	EXPECT_FALSE(assembler.hasSegment("2", 0));
+	EXPECT_TRUE(assembler.hasSegment("3", 0));
+
+	// segments beyond the known count are ignored
+	EXPECT_FALSE(assembler.add(MakeSegment(L"b", "1", 1, 3)).isValid());
+	EXPECT_FALSE(assembler.add(MakeSegment(L"d", "1", 3)).isValid());
+	EXPECT_FALSE(assembler.hasSegment("1", 3));
+
+	// same file ID with a different segment count starts a new file
+	EXPECT_FALSE(assembler.add(MakeSegment(L"B", "1", 1, 4)).isValid());
+	EXPECT_FALSE(assembler.hasSegment("1", 0));
+	EXPECT_TRUE(assembler.hasSegment("1", 1));
+
+	assembler.clear();
+	EXPECT_EQ(assembler.pendingFiles(), 0);
+}
@@ -20,11 +20,13 @@
 #include "qrcode/QRVersion.h"
 #include "qrcode/QRErrorCorrectionLevel.h"
 #include "ByteArray.h"
+#include "CharacterSet.h"
 #include "DecoderResult.h"
 
 namespace ZXing {
 	namespace QRCode {
-		DecoderResult DecodeBitStream(ByteArray&& bytes, const Version& version, ErrorCorrectionLevel ecLevel, const std::string& hintedCharset);
+		DecoderResult DecodeBitStream(ByteArray&& bytes, const Version& version, ErrorCorrectionLevel ecLevel, CharacterSet hintedCharset,
+									  bool decodeText = true);
 	}
 }
 
@@ -83,7 +85,7 @@ TEST(QRDecodedBitStreamParserTest, SimpleByteMode)
     builder.write(0xF1, 8);
     builder.write(0xF2, 8);
     builder.write(0xF3, 8);
-    auto result = DecodeBitStream(builder.toByteArray(), *Version::VersionForNumber(1), ErrorCorrectionLevel::Medium, "").text();
+    auto result = DecodeBitStream(builder.toByteArray(), *Version::VersionForNumber(1), ErrorCorrectionLevel::Medium, CharacterSet::Unknown).text();
     EXPECT_EQ(L"\xF1\xF2\xF3", result);
 }
 
@@ -96,7 +98,7 @@ TEST(QRDecodedBitStreamParserTest, SimpleSJIS)
     builder.write(0xA2, 8);
     builder.write(0xA3, 8);
     builder.write(0xD0, 8);
-	auto result = DecodeBitStream(builder.toByteArray(), *Version::VersionForNumber(1), ErrorCorrectionLevel::Medium, "").text();
+	auto result = DecodeBitStream(builder.toByteArray(), *Version::VersionForNumber(1), ErrorCorrectionLevel::Medium, CharacterSet::Unknown).text();
 	EXPECT_EQ(L"\uff61\uff62\uff63\uff90", result);
 }
 
@@ -110,7 +112,7 @@ TEST(QRDecodedBitStreamParserTest, ECI)
     builder.write(0xA1, 8);
     builder.write(0xA2, 8);
     builder.write(0xA3, 8);
-	auto result = DecodeBitStream(builder.toByteArray(), *Version::VersionForNumber(1), ErrorCorrectionLevel::Medium, "").text();
+	auto result = DecodeBitStream(builder.toByteArray(), *Version::VersionForNumber(1), ErrorCorrectionLevel::Medium, CharacterSet::Unknown).text();
 	EXPECT_EQ(L"\xED\xF3\xFA", result);
 }
 
@@ -121,7 +123,7 @@ TEST(QRDecodedBitStreamParserTest, Hanzi)
     builder.write(0x01, 4); // Subset 1 = GB2312 encoding
     builder.write(0x01, 8); // 1 characters
     builder.write(0x03C1, 13);
-	auto result = DecodeBitStream(builder.toByteArray(), *Version::VersionForNumber(1), ErrorCorrectionLevel::Medium, "").text();
+	auto result = DecodeBitStream(builder.toByteArray(), *Version::VersionForNumber(1), ErrorCorrectionLevel::Medium, CharacterSet::Unknown).text();
 	EXPECT_EQ(L"\u963f", result);
 }
 
@@ -133,6 +135,93 @@ TEST(QRDecodedBitStreamParserTest, HanziLevel1)
 	builder.write(0x01, 8); // 1 characters
 	// A5A2 (U+30A2) => A5A2 - A1A1 = 401, 4*60 + 01 = 0181
 	builder.write(0x0181, 13);
-	auto result = DecodeBitStream(builder.toByteArray(), *Version::VersionForNumber(1), ErrorCorrectionLevel::Medium, "").text();
+	auto result = DecodeBitStream(builder.toByteArray(), *Version::VersionForNumber(1), ErrorCorrectionLevel::Medium, CharacterSet::Unknown).text();
 	EXPECT_EQ(L"\u30a2", result);
 }
+
+TEST(QRDecodedBitStreamParserTest, SkipTextDecoding)
+{
+	BitSourceBuilder builder;
+	builder.write(0x04, 4); // Byte mode
+	builder.write(0x03, 8); // 3 bytes
+	builder.write(0xF1, 8);
+	builder.write(0xF2, 8);
+	builder.write(0xF3, 8);
+	builder.write(0x0D, 4); // Hanzi mode
+	builder.write(0x01, 4); // Subset 1 = GB2312 encoding
+	builder.write(0x01, 8); // 1 characters
+	builder.write(0x03C1, 13);
+	auto result = DecodeBitStream(builder.toByteArray(), *Version::VersionForNumber(1), ErrorCorrectionLevel::Medium, CharacterSet::Unknown, false);
+	EXPECT_TRUE(result.isValid());
+	EXPECT_TRUE(result.text().empty());
+	ASSERT_EQ(result.byteSegments().size(), 1);
+	EXPECT_EQ(result.byteSegments().front().toByteArray(), ByteArray({0xF1, 0xF2, 0xF3}));
+}
+
+TEST(QRDecodedBitStreamParserTest, NumericSegment)
+{
+	BitSourceBuilder builder;
+	builder.write(0x01, 4); // Numeric mode
+	builder.write(3002, 14); // 3002 digits
+	std::wstring expected;
+	for (int i = 0; i < 1000; ++i) {
+		builder.write(i, 10);
+		expected += std::to_wstring(1000 + i).substr(1);
+	}
+	builder.write(7, 7);
+	expected += L"07";
+	auto result = DecodeBitStream(builder.toByteArray(), *Version::VersionForNumber(40), ErrorCorrectionLevel::Low, CharacterSet::Unknown);
+	EXPECT_EQ(result.text(), expected);
+
+	BitSourceBuilder truncated;
+	truncated.write(0x01, 4); // Numeric mode
+	truncated.write(0x04, 10); // 4 digits
+	truncated.write(123, 10);
+	result = DecodeBitStream(truncated.toByteArray(), *Version::VersionForNumber(1), ErrorCorrectionLevel::Medium, CharacterSet::Unknown);
+	EXPECT_FALSE(result.isValid());
+}
+
+TEST(QRDecodedBitStreamParserTest, AlphanumericSegment)
+{
+	const std::wstring chars = L"0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ $%*+-./:";
+	BitSourceBuilder builder;
+	builder.write(0x02, 4); // Alphanumeric mode
+	builder.write(45 * 45 * 2 + 1, 13); // all pairs plus one char
+	std::wstring expected;
+	for (int i = 0; i < 45 * 45; ++i) {
+		builder.write(i, 11);
+		expected += chars[i / 45];
+		expected += chars[i % 45];
+	}
+	builder.write(44, 6);
+	expected += L":";
+	auto result = DecodeBitStream(builder.toByteArray(), *Version::VersionForNumber(40), ErrorCorrectionLevel::Low, CharacterSet::Unknown);
+	EXPECT_EQ(result.text(), expected);
+}
+
+TEST(QRDecodedBitStreamParserTest, AlphanumericFNC1)
+{
+	BitSourceBuilder builder;
+	builder.write(0x05, 4); // FNC1 in first position
+	builder.write(0x02, 4); // Alphanumeric mode
+	builder.write(0x06, 9); // 6 chars: "A%%B%C"
+	builder.write(10 * 45 + 38, 11);
+	builder.write(38 * 45 + 11, 11);
+	builder.write(38 * 45 + 12, 11);
+	auto result = DecodeBitStream(builder.toByteArray(), *Version::VersionForNumber(1), ErrorCorrectionLevel::Medium, CharacterSet::Unknown);
+	EXPECT_EQ(result.text(), L"A%B\x1D" L"C");
+}
+
+TEST(QRDecodedBitStreamParserTest, InvalidModeBits)
+{
+	for (int modeBits : {0x06, 0x0A, 0x0B, 0x0C, 0x0E, 0x0F}) {
+		BitSourceBuilder builder;
+		builder.write(0x04, 4); // Byte mode
+		builder.write(0x01, 8); // 1 byte
+		builder.write(0xA1, 8);
+		builder.write(modeBits, 4);
+		builder.write(0x00, 12);
+		auto result = DecodeBitStream(builder.toByteArray(), *Version::VersionForNumber(1), ErrorCorrectionLevel::Medium, CharacterSet::Unknown);
+		EXPECT_EQ(result.errorCode(), DecodeStatus::FormatError) << modeBits;
+	}
+}
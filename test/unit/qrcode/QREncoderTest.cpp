@@ -651,3 +651,58 @@ TEST(QREncoderTest, BugInBitVectorNumBytes)
     //     bytes).
     Encoder::Encode(std::wstring(3518, L'0'), ErrorCorrectionLevel::Low, CharacterSet::Unknown, 0, false, -1);
 }
+
+TEST(QREncoderTest, BatchEncoder)
+{
+	const std::wstring contents[] = {L"12345678", L"ABC-12", L"hello", L"été", L""};
+	for (int versionNumber : {1, 7, 22}) {
+		for (auto ecLevel : {ErrorCorrectionLevel::Low, ErrorCorrectionLevel::High}) {
+			for (auto charset : {CharacterSet::Unknown, CharacterSet::UTF8}) {
+				BatchEncoder batch(ecLevel, charset, versionNumber, false, 5);
+				BitMatrix output;
+				for (auto& content : contents) {
+					batch.encode(content, output);
+					auto expected = Encoder::Encode(content, ecLevel, charset, versionNumber, false, 5);
+					EXPECT_EQ(expected.version, &batch.version());
+					EXPECT_EQ(expected.matrix, output);
+				}
+			}
+		}
+	}
+
+	BatchEncoder batch(ErrorCorrectionLevel::High, CharacterSet::Unknown, 1, true, 0);
+	BitMatrix output;
+	batch.encode(L"01234567890123", output);
+	EXPECT_EQ(Encoder::Encode(L"01234567890123", ErrorCorrectionLevel::High, CharacterSet::Unknown, 1, true, 0).matrix, output);
+	EXPECT_THROW(batch.encode(std::wstring(100, L'A'), output), std::invalid_argument);
+	EXPECT_THROW(BatchEncoder(ErrorCorrectionLevel::High, CharacterSet::Unknown, 41, false, 0), std::invalid_argument);
+	EXPECT_THROW(BatchEncoder(ErrorCorrectionLevel::High, CharacterSet::Unknown, 1, false, 8), std::invalid_argument);
+}
+
+TEST(QREncoderTest, MinimalEncoding)
+{
+	// content that fits a single mode best ends up in the same symbol
+	for (auto& content : {L"ABCDEF", L"0123", L"hello", L"日本"}) {
+		for (auto charset : {CharacterSet::Unknown, CharacterSet::UTF8, CharacterSet::Shift_JIS}) {
+			if (content[0] > 0xff && charset == CharacterSet::Unknown)
+				continue;
+			auto single = Encoder::Encode(content, ErrorCorrectionLevel::Medium, charset, 0, false, 3);
+			auto minimal = Encoder::Encode(content, ErrorCorrectionLevel::Medium, charset, 0, false, 3, 1, true);
+			EXPECT_EQ(single.mode, minimal.mode);
+			EXPECT_EQ(single.matrix, minimal.matrix);
+		}
+	}
+
+	// 24 alphanumeric characters and 60 digits: 4 + 9 + 132 + 4 + 10 + 200 = 359 bits fit version 3-L (440 bits),
+	// all of it in alphanumeric mode takes 4 + 9 + 462 bits and needs version 4
+	std::wstring content = L"HTTP://EXAMPLE.COM/ITEM/" + std::wstring(60, L'7');
+	auto single = Encoder::Encode(content, ErrorCorrectionLevel::Low, CharacterSet::Unknown, 0, false, -1);
+	auto minimal = Encoder::Encode(content, ErrorCorrectionLevel::Low, CharacterSet::Unknown, 0, false, -1, 1, true);
+	EXPECT_EQ(single.version->versionNumber(), 4);
+	EXPECT_EQ(minimal.version->versionNumber(), 3);
+	EXPECT_EQ(minimal.mode, CodecMode::ALPHANUMERIC);
+
+	EXPECT_EQ(Encoder::Encode(content, ErrorCorrectionLevel::Low, CharacterSet::Unknown, 5, false, -1, 1, true).version->versionNumber(), 5);
+	EXPECT_THROW(Encoder::Encode(content, ErrorCorrectionLevel::Low, CharacterSet::Unknown, 2, false, -1, 1, true),
+				 std::invalid_argument);
+}
@@ -0,0 +1,91 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "qrcode/QRFinderPatternFinder.h"
+#include "BitMatrix.h"
+#include "ImageUtility.h"
+#include "ReadBarcode.h"
+#include "qrcode/QRFinderPatternInfo.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace ZXing;
+using namespace ZXing::Utility;
+using namespace ZXing::QRCode;
+
+// a sheet of 2 rows of 3 labels, each one a QR Code of 150x150 pixels
+static BitMatrix Sheet()
+{
+	BitMatrix sheet(600, 400);
+	for (int i = 0; i < 6; ++i) {
+		auto symbol = Render(BarcodeFormat::QR_CODE, L"label " + std::to_wstring(i), 150, 150);
+		for (int y = 0; y < symbol.height(); ++y)
+			for (int x = 0; x < symbol.width(); ++x)
+				if (symbol.get(x, y) == 0)
+					sheet.set(i % 3 * 200 + 20 + x, i / 3 * 200 + 20 + y);
+	}
+	return sheet;
+}
+
+TEST(QRFinderPatternFinderTest, FindMultiple)
+{
+	auto sheet = Sheet();
+	EXPECT_TRUE(FinderPatternFinder::Find(sheet, false).isValid());
+
+	auto infos = FinderPatternFinder::FindMultiple(sheet, false);
+	auto inLabel = [](const FinderPattern& p, int i) {
+		int left = i % 3 * 200 + 20, top = i / 3 * 200 + 20;
+		return p.x() > left && p.x() < left + 150 && p.y() > top && p.y() < top + 150;
+	};
+	for (int i = 0; i < 6; ++i)
+		EXPECT_TRUE(std::any_of(infos.begin(), infos.end(), [&](const FinderPatternInfo& info) {
+			return inLabel(info.topLeft, i) && inLabel(info.topRight, i) && inLabel(info.bottomLeft, i);
+		})) << "label " << i;
+
+	// the concurrent scan finds the same triples in the same order
+	auto threaded = FinderPatternFinder::FindMultiple(sheet, false, 4);
+	ASSERT_EQ(threaded.size(), infos.size());
+	for (size_t i = 0; i < infos.size(); ++i) {
+		EXPECT_EQ(PointF(threaded[i].topLeft), PointF(infos[i].topLeft));
+		EXPECT_EQ(PointF(threaded[i].topRight), PointF(infos[i].topRight));
+		EXPECT_EQ(PointF(threaded[i].bottomLeft), PointF(infos[i].bottomLeft));
+	}
+
+	EXPECT_TRUE(FinderPatternFinder::FindMultiple(BitMatrix(300, 300), true).empty());
+}
+
+TEST(QRFinderPatternFinderTest, ReadMultiple)
+{
+	auto sheet = ToMatrix<uint8_t>(Sheet());
+	auto view = View(sheet);
+	auto hints = DecodeHints().setFormats(BarcodeFormat::QR_CODE);
+
+	auto results = ReadBarcodes(view, hints);
+	ASSERT_EQ(results.size(), 6);
+	std::vector<std::wstring> texts;
+	for (auto& result : results)
+		texts.push_back(result.text());
+	std::sort(texts.begin(), texts.end());
+	for (int i = 0; i < 6; ++i)
+		EXPECT_EQ(texts[i], L"label " + std::to_wstring(i));
+
+	EXPECT_EQ(ReadBarcodes(view, DecodeHints(hints).setMaxNumberOfSymbols(2)).size(), 2);
+}
@@ -50,3 +50,10 @@ TEST(QRFormatInformationTest, DecodeWithMisread)
     FormatInformation expected = FormatInformation::DecodeFormatInformation(MASKED_TEST_FORMAT_INFO, MASKED_TEST_FORMAT_INFO);
 	EXPECT_EQ(expected, FormatInformation::DecodeFormatInformation(MASKED_TEST_FORMAT_INFO ^ 0x03, MASKED_TEST_FORMAT_INFO ^ 0x0F));
 }
+
+TEST(QRFormatInformationTest, HammingDistance)
+{
+	EXPECT_EQ(FormatInformation::DecodeFormatInformation(MASKED_TEST_FORMAT_INFO, MASKED_TEST_FORMAT_INFO).hammingDistance(), 0);
+	EXPECT_EQ(FormatInformation::DecodeFormatInformation(MASKED_TEST_FORMAT_INFO ^ 0x03, MASKED_TEST_FORMAT_INFO ^ 0x07).hammingDistance(), 2);
+	EXPECT_EQ(FormatInformation::DecodeFormatInformation(MASKED_TEST_FORMAT_INFO ^ 0x0F, MASKED_TEST_FORMAT_INFO ^ 0x07).hammingDistance(), 3);
+}
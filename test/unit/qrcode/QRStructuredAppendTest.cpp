@@ -0,0 +1,76 @@
+/*
+* Copyright 2021 ZXing authors
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#include "gtest/gtest.h"
+#include "qrcode/QRStructuredAppend.h"
+
+using namespace ZXing;
+using namespace ZXing::QRCode;
+
+static Result MakePart(std::wstring text, int parity, int sequence, int count)
+{
+	Result res(std::move(text), {}, BarcodeFormat::QR_CODE);
+	res.metadata().put(ResultMetadata::STRUCTURED_APPEND_SEQUENCE, sequence);
+	res.metadata().put(ResultMetadata::STRUCTURED_APPEND_CODE_COUNT, count);
+	res.metadata().put(ResultMetadata::STRUCTURED_APPEND_PARITY, parity);
+	return res;
+}
+
+TEST(QRStructuredAppendTest, Assemble)
+{
+	StructuredAppendAssembler assembler;
+	EXPECT_FALSE(assembler.add(MakePart(L"C", 7, 2, 3)).isValid());
+	EXPECT_FALSE(assembler.add(MakePart(L"A", 7, 0, 3)).isValid());
+	EXPECT_TRUE(assembler.hasPart(7, 0));
+	EXPECT_FALSE(assembler.hasPart(7, 1));
+	// duplicates and unrelated results are ignored
+	EXPECT_FALSE(assembler.add(MakePart(L"A", 7, 0, 3)).isValid());
+	EXPECT_FALSE(assembler.add(Result(L"plain", {}, BarcodeFormat::QR_CODE)).isValid());
+	EXPECT_FALSE(assembler.add(MakePart(L"x", 9, 0, 2)).isValid());
+	EXPECT_EQ(assembler.pendingSequences(), 2);
+
+	auto res = assembler.add(MakePart(L"B", 7, 1, 3));
+	ASSERT_TRUE(res.isValid());
+	EXPECT_EQ(res.text(), L"ABC");
+	EXPECT_EQ(res.format(), BarcodeFormat::QR_CODE);
+	EXPECT_EQ(res.metadata().getInt(ResultMetadata::STRUCTURED_APPEND_PARITY, -1), 7);
+	EXPECT_EQ(res.metadata().getInt(ResultMetadata::STRUCTURED_APPEND_CODE_COUNT, -1), 3);
+	EXPECT_EQ(assembler.pendingSequences(), 1);
+	EXPECT_FALSE(assembler.hasPart(7, 0));
+
+	// a single symbol sequence completes immediately
+	EXPECT_EQ(assembler.add(MakePart(L"single", 1, 0, 1)).text(), L"single");
+}
+
+TEST(QRStructuredAppendTest, BoundedState)
+{
+	StructuredAppendAssembler assembler(2);
+	assembler.add(MakePart(L"a", 1, 0, 2));
+	assembler.add(MakePart(L"b", 2, 0, 2));
+	assembler.add(MakePart(L"a", 1, 0, 2)); // refreshes parity 1
+	assembler.add(MakePart(L"c", 3, 0, 2)); // evicts parity 2
+	EXPECT_EQ(assembler.pendingSequences(), 2);
+	EXPECT_TRUE(assembler.hasPart(1, 0));
+	EXPECT_FALSE(assembler.hasPart(2, 0));
+	EXPECT_TRUE(assembler.hasPart(3, 0));
+
+	// same parity with a different code count starts a new sequence
+	EXPECT_FALSE(assembler.add(MakePart(L"A", 1, 1, 3)).isValid());
+	EXPECT_FALSE(assembler.hasPart(1, 0));
+	EXPECT_TRUE(assembler.hasPart(1, 1));
+
+	assembler.clear();
+	EXPECT_EQ(assembler.pendingSequences(), 0);
+}
@@ -16,6 +16,14 @@
 package com.zxing;
 
 import android.graphics.Bitmap;
+import android.graphics.Point;
+import android.graphics.Rect;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.charset.StandardCharsets;
+import java.util.ArrayList;
+import java.util.List;
 
 public class BarcodeReader
 {
@@ -29,13 +37,43 @@ public class BarcodeReader
 			return text;
 		}
 
+		/** The corners top left, top right, bottom right and bottom left, in the coordinates of the cropped image. */
+		public Point[] getPosition() {
+			return position;
+		}
+
+		/** The rotation of the symbol in degrees clockwise, derived from the position. */
+		public int getOrientation() {
+			int dx = position[1].x + position[2].x - position[0].x - position[3].x;
+			int dy = position[1].y + position[2].y - position[0].y - position[3].y;
+			return (int)Math.round(Math.toDegrees(Math.atan2(dy, dx)));
+		}
+
+		public String getEcLevel() {
+			return ecLevel;
+		}
+
+		public byte[] getRawBytes() {
+			return rawBytes;
+		}
+
 		Result(BarcodeFormat format, String text) {
+			this(format, text, new Point[] {new Point(), new Point(), new Point(), new Point()}, "", new byte[0]);
+		}
+
+		Result(BarcodeFormat format, String text, Point[] position, String ecLevel, byte[] rawBytes) {
 			this.format = format;
 			this.text = text;
+			this.position = position;
+			this.ecLevel = ecLevel;
+			this.rawBytes = rawBytes;
 		}
 
 		private BarcodeFormat format;
 		private String text;
+		private Point[] position;
+		private String ecLevel;
+		private byte[] rawBytes;
 	}
 
 	public BarcodeReader(BarcodeFormat... formats)
@@ -64,6 +102,102 @@ public class BarcodeReader
 		return null;
 	}
 
+	/**
+	 * Read from the luma (Y) plane of a YUV 4:2:0 camera image (NV21, NV12, YUV_420_888, ...) in place.
+	 * The buffer has to be a direct ByteBuffer, e.g. Image.getPlanes()[0].getBuffer().
+	 */
+	public Result read(ByteBuffer yBuffer, int imgWidth, int imgHeight, int rowStride, int cropWidth, int cropHeight)
+	{
+		cropWidth = cropWidth <= 0 ? imgWidth : Math.min(imgWidth, cropWidth);
+		cropHeight = cropHeight <= 0 ? imgHeight : Math.min(imgHeight, cropHeight);
+		int cropLeft = (imgWidth - cropWidth) / 2;
+		int cropTop = (imgHeight - cropHeight) / 2;
+		return read(yBuffer, imgWidth, imgHeight, rowStride, new Rect(cropLeft, cropTop, cropLeft + cropWidth, cropTop + cropHeight), 0);
+	}
+
+	/**
+	 * Read from the luma (Y) plane of a YUV 4:2:0 camera image in place, e.g. for a CameraX ImageProxy:
+	 * read(image.getPlanes()[0].getBuffer(), image.getWidth(), image.getHeight(), image.getPlanes()[0].getRowStride(),
+	 *      image.getCropRect(), image.getImageInfo().getRotationDegrees())
+	 * A cropRect of null means the whole image. A rotationDegrees other than 0 (clockwise, a multiple of 90) makes
+	 * the image upright before decoding, which costs a copy of the cropped luma plane.
+	 */
+	public Result read(ByteBuffer yBuffer, int imgWidth, int imgHeight, int rowStride, Rect cropRect, int rotationDegrees)
+	{
+		if (cropRect == null)
+		{
+			cropRect = new Rect(0, 0, imgWidth, imgHeight);
+		}
+		Object[] result = new Object[1];
+		int resultFormat = readYuv(_nativePtr, yBuffer, imgWidth, imgHeight, rowStride, cropRect.left, cropRect.top,
+				cropRect.width(), cropRect.height(), rotationDegrees, result);
+		if (resultFormat >= 0)
+		{
+			return new Result(BarcodeFormat.values()[resultFormat], (String)result[0]);
+		}
+		return null;
+	}
+
+	/**
+	 * Read up to maxSymbols barcodes with their position, EC level and raw bytes in one call.
+	 */
+	public List<Result> readAll(Bitmap bitmap, Rect cropRect, int maxSymbols)
+	{
+		if (cropRect == null)
+		{
+			cropRect = new Rect(0, 0, bitmap.getWidth(), bitmap.getHeight());
+		}
+		return unpackResults(readBarcodes(_nativePtr, bitmap, cropRect.left, cropRect.top, cropRect.width(),
+				cropRect.height(), maxSymbols));
+	}
+
+	/**
+	 * Read up to maxSymbols barcodes from the luma plane of a YUV 4:2:0 camera image in place, see
+	 * read(ByteBuffer, int, int, int, Rect, int). The positions are in the coordinates of the cropped and rotated image.
+	 */
+	public List<Result> readAll(ByteBuffer yBuffer, int imgWidth, int imgHeight, int rowStride, Rect cropRect,
+			int rotationDegrees, int maxSymbols)
+	{
+		if (cropRect == null)
+		{
+			cropRect = new Rect(0, 0, imgWidth, imgHeight);
+		}
+		return unpackResults(readYuvBarcodes(_nativePtr, yBuffer, imgWidth, imgHeight, rowStride, cropRect.left,
+				cropRect.top, cropRect.width(), cropRect.height(), rotationDegrees, maxSymbols));
+	}
+
+	// the layout is written by ToJavaResults in JNIUtils.cpp
+	private static List<Result> unpackResults(byte[] packed)
+	{
+		List<Result> results = new ArrayList<>();
+		if (packed == null)
+		{
+			return results;
+		}
+		ByteBuffer buffer = ByteBuffer.wrap(packed).order(ByteOrder.nativeOrder());
+		int count = buffer.getInt();
+		for (int i = 0; i < count; ++i)
+		{
+			BarcodeFormat format = BarcodeFormat.values()[buffer.getInt()];
+			Point[] position = new Point[4];
+			for (int j = 0; j < 4; ++j)
+			{
+				position[j] = new Point(buffer.getInt(), buffer.getInt());
+			}
+			String text = new String(getBytes(buffer), StandardCharsets.UTF_8);
+			String ecLevel = new String(getBytes(buffer), StandardCharsets.UTF_8);
+			results.add(new Result(format, text, position, ecLevel, getBytes(buffer)));
+		}
+		return results;
+	}
+
+	private static byte[] getBytes(ByteBuffer buffer)
+	{
+		byte[] bytes = new byte[buffer.getInt()];
+		buffer.get(bytes);
+		return bytes;
+	}
+
 	@Override
 	protected void finalize() throws Throwable
 	{
@@ -87,6 +221,10 @@ public class BarcodeReader
 	private static native long createInstance(int[] formats);
 	private static native void destroyInstance(long objPtr);
 	private static native int readBarcode(long objPtr, Bitmap bitmap, int left, int top, int width, int height, Object[] result);
+	private static native int readYuv(long objPtr, ByteBuffer yBuffer, int imgWidth, int imgHeight, int rowStride, int left, int top, int width, int height, int rotation, Object[] result);
+
+	private static native byte[] readBarcodes(long objPtr, Bitmap bitmap, int left, int top, int width, int height, int maxSymbols);
+	private static native byte[] readYuvBarcodes(long objPtr, ByteBuffer yBuffer, int imgWidth, int imgHeight, int rowStride, int left, int top, int width, int height, int rotation, int maxSymbols);
 
 	static {
 		System.loadLibrary("zxing-android");
@@ -31,7 +31,7 @@ static std::vector<ZXing::BarcodeFormat> GetFormats(JNIEnv* env, jintArray forma
 		env->GetIntArrayRegion(formats, 0, elems.size(), elems.data());
 		result.resize(len);
 		for (jsize i = 0; i < len; ++i) {
-			result[i] = ZXing::BarcodeFormat(elems[i]);
+			result[i] = FromJavaFormat(elems[i]);
 		}
 	}
 	return result;
@@ -86,7 +86,7 @@ Java_com_zxing_BarcodeReader_readBarcode(JNIEnv* env, jobject thiz, jlong objPtr
 		auto readResult = reader->read(*binImage);
 		if (readResult.isValid()) {
 			env->SetObjectArrayElement(result, 0, ToJavaString(env, readResult.text()));
-			return static_cast<int>(readResult.format());
+			return ToJavaFormat(readResult.format());
 		}
 	}
 	catch (const std::exception& e)
@@ -99,3 +99,67 @@ Java_com_zxing_BarcodeReader_readBarcode(JNIEnv* env, jobject thiz, jlong objPtr
 	}
 	return -1;
 }
+
+extern "C" JNIEXPORT jint JNICALL
+Java_com_zxing_BarcodeReader_readYuv(JNIEnv* env, jobject thiz, jlong objPtr, jobject yuvBuffer, jint imgWidth, jint imgHeight, jint rowStride, jint left, jint top, jint width, jint height, jint rotation, jobjectArray result)
+{
+	try
+	{
+		auto reader = reinterpret_cast<ZXing::MultiFormatReader*>(objPtr);
+		auto binImage = BinaryBitmapFromYuvBuffer(env, yuvBuffer, imgWidth, imgHeight, rowStride, left, top, width, height, rotation);
+		auto readResult = reader->read(*binImage);
+		if (readResult.isValid()) {
+			env->SetObjectArrayElement(result, 0, ToJavaString(env, readResult.text()));
+			return ToJavaFormat(readResult.format());
+		}
+	}
+	catch (const std::exception& e)
+	{
+		ThrowJavaException(env, e.what());
+	}
+	catch (...)
+	{
+		ThrowJavaException(env, "Unknown exception");
+	}
+	return -1;
+}
+
+extern "C" JNIEXPORT jbyteArray JNICALL
+Java_com_zxing_BarcodeReader_readBarcodes(JNIEnv* env, jobject thiz, jlong objPtr, jobject bitmap, jint left, jint top, jint width, jint height, jint maxSymbols)
+{
+	try
+	{
+		auto reader = reinterpret_cast<ZXing::MultiFormatReader*>(objPtr);
+		auto binImage = BinaryBitmapFromJavaBitmap(env, bitmap, left, top, width, height);
+		return ToJavaResults(env, reader->readMultiple(*binImage, maxSymbols));
+	}
+	catch (const std::exception& e)
+	{
+		ThrowJavaException(env, e.what());
+	}
+	catch (...)
+	{
+		ThrowJavaException(env, "Unknown exception");
+	}
+	return nullptr;
+}
+
+extern "C" JNIEXPORT jbyteArray JNICALL
+Java_com_zxing_BarcodeReader_readYuvBarcodes(JNIEnv* env, jobject thiz, jlong objPtr, jobject yuvBuffer, jint imgWidth, jint imgHeight, jint rowStride, jint left, jint top, jint width, jint height, jint rotation, jint maxSymbols)
+{
+	try
+	{
+		auto reader = reinterpret_cast<ZXing::MultiFormatReader*>(objPtr);
+		auto binImage = BinaryBitmapFromYuvBuffer(env, yuvBuffer, imgWidth, imgHeight, rowStride, left, top, width, height, rotation);
+		return ToJavaResults(env, reader->readMultiple(*binImage, maxSymbols));
+	}
+	catch (const std::exception& e)
+	{
+		ThrowJavaException(env, e.what());
+	}
+	catch (...)
+	{
+		ThrowJavaException(env, "Unknown exception");
+	}
+	return nullptr;
+}
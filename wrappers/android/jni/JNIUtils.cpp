@@ -14,10 +14,17 @@
 * limitations under the License.
 */
 #include "JNIUtils.h"
+#include "BarcodeFormat.h"
+#include "BitHacks.h"
 #include "GenericLuminanceSource.h"
 #include "HybridBinarizer.h"
+#include "ReadBarcode.h"
+#include "Result.h"
+#include "TextUtfEncoding.h"
+#include "ViewLuminanceSource.h"
 
 #include <android/bitmap.h>
+#include <cstring>
 #include <stdexcept>
 #include <vector>
 
@@ -73,6 +80,30 @@ std::shared_ptr<ZXing::BinaryBitmap> BinaryBitmapFromJavaBitmap(JNIEnv* env, job
 	}
 }
 
+std::shared_ptr<ZXing::BinaryBitmap> BinaryBitmapFromYuvBuffer(JNIEnv* env, jobject buffer, int width, int height, int rowStride, int cropLeft, int cropTop, int cropWidth, int cropHeight, int rotation)
+{
+	using namespace ZXing;
+
+	auto data = static_cast<const uint8_t*>(env->GetDirectBufferAddress(buffer));
+	if (data == nullptr)
+		throw std::runtime_error("Buffer is not a direct ByteBuffer");
+	if (width <= 0 || height <= 0 || rowStride < width || env->GetDirectBufferCapacity(buffer) < (jlong)rowStride * (height - 1) + width)
+		throw std::runtime_error("Buffer too small for the given image size");
+
+	// the luma plane of all YUV 4:2:0 formats is at the start of the buffer, so the exact format does not matter here
+	auto image = ImageView(data, width, height, ImageFormat::NV21, rowStride)
+					 .cropped(cropLeft, cropTop, cropWidth < 0 ? width : cropWidth, cropHeight < 0 ? height : cropHeight);
+	std::shared_ptr<LuminanceSource> luminance = std::make_shared<ViewLuminanceSource>(image.width(), image.height(), image.data(0, 0), image.rowStride());
+	// only an upright image needs no copy, rotating the (cropped) luma plane is still much cheaper than a conversion to RGBA
+	rotation = (rotation % 360 + 360) % 360;
+	if (rotation != 0) {
+		if (rotation % 90 != 0)
+			throw std::runtime_error("Rotation has to be a multiple of 90 degrees");
+		luminance = luminance->rotated(rotation);
+	}
+	return std::make_shared<HybridBinarizer>(luminance);
+}
+
 void ThrowJavaException(JNIEnv* env, const char* message)
 {
 	static jclass jcls = env->FindClass("java/lang/RuntimeException");
@@ -124,3 +155,57 @@ jstring ToJavaString(JNIEnv* env, const std::wstring& str)
 		return env->NewString((const jchar*)buffer.data(), buffer.size());
 	}
 }
+
+ZXing::BarcodeFormat FromJavaFormat(int ordinal)
+{
+	return ZXing::BarcodeFormat(1 << ordinal);
+}
+
+int ToJavaFormat(ZXing::BarcodeFormat format)
+{
+	return ZXing::BitHacks::HighestBitSet(static_cast<uint32_t>(format));
+}
+
+namespace {
+
+	struct ResultPacker
+	{
+		std::vector<jbyte> bytes;
+
+		void put(int32_t value) {
+			auto pos = bytes.size();
+			bytes.resize(pos + sizeof(value));
+			std::memcpy(bytes.data() + pos, &value, sizeof(value));
+		}
+
+		template <typename T>
+		void put(const T& str) {
+			put(static_cast<int32_t>(str.size()));
+			bytes.insert(bytes.end(), str.begin(), str.end());
+		}
+	};
+
+} // anonymous
+
+jbyteArray ToJavaResults(JNIEnv* env, const std::vector<ZXing::Result>& results)
+{
+	using namespace ZXing;
+
+	ResultPacker packer;
+	packer.put(static_cast<int32_t>(results.size()));
+	for (auto& r : results) {
+		packer.put(ToJavaFormat(r.format()));
+		for (auto& p : r.position()) {
+			packer.put(p.x);
+			packer.put(p.y);
+		}
+		packer.put(r.utf8());
+		packer.put(TextUtfEncoding::ToUtf8(r.metadata().getString(ResultMetadata::ERROR_CORRECTION_LEVEL)));
+		packer.put(r.rawBytes());
+	}
+
+	auto array = env->NewByteArray(packer.bytes.size());
+	if (array != nullptr)
+		env->SetByteArrayRegion(array, 0, packer.bytes.size(), packer.bytes.data());
+	return array;
+}
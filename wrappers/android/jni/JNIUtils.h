@@ -20,6 +20,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #define ZX_LOG_TAG "ZXing"
 
@@ -30,9 +31,22 @@
 
 namespace ZXing {
 class BinaryBitmap;
+class Result;
+enum class BarcodeFormat;
 }
 
 // Create BinaryBitmap from Android's Bitmap
 std::shared_ptr<ZXing::BinaryBitmap> BinaryBitmapFromJavaBitmap(JNIEnv* env, jobject bitmap, int cropLeft, int cropTop, int cropWidth, int cropHeight);
+// Create BinaryBitmap from the luma (Y) plane of a YUV 4:2:0 image (NV21, NV12, I420, ...) in a direct ByteBuffer,
+// the pixels are not copied unless rotation (degrees clockwise) is not 0, so the buffer must not be modified while the
+// BinaryBitmap is in use
+std::shared_ptr<ZXing::BinaryBitmap> BinaryBitmapFromYuvBuffer(JNIEnv* env, jobject buffer, int width, int height, int rowStride, int cropLeft, int cropTop, int cropWidth, int cropHeight, int rotation);
 void ThrowJavaException(JNIEnv* env, const char* message);
 jstring ToJavaString(JNIEnv* env, const std::wstring& str);
+// The Java BarcodeFormat enum lists the formats in the order of their bits in ZXing::BarcodeFormat
+ZXing::BarcodeFormat FromJavaFormat(int ordinal);
+int ToJavaFormat(ZXing::BarcodeFormat format);
+// Pack all results into one byte array (native byte order) so Java can read them without a JNI call per field:
+// int32 count, then per result int32 format, 8 x int32 corners (x, y of top left, top right, bottom right and bottom
+// left) and the length prefixed (int32) byte strings text (UTF-8), EC level (UTF-8) and raw bytes
+jbyteArray ToJavaResults(JNIEnv* env, const std::vector<ZXing::Result>& results);
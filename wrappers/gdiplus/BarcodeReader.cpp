@@ -15,13 +15,19 @@
 */
 
 #include "BarcodeReader.h"
-#include "TextUtfEncoding.h"
-#include "HybridBinarizer.h"
 #include "BinaryBitmap.h"
 #include "MultiFormatReader.h"
 #include "Result.h"
 #include "DecodeHints.h"
 #include "ImageReader.h"
+#include "Parallel.h"
+
+#include <windows.h>
+#include <gdiplus.h>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
 
 namespace ZXing {
 
@@ -34,28 +40,68 @@ BarcodeReader::BarcodeReader(bool tryHarder, bool tryRotate, const std::string&
 	_reader = std::make_shared<MultiFormatReader>(hints);
 }
 
-BarcodeReader::ScanResult
-BarcodeReader::scan(Gdiplus::Bitmap& bitmap, int rotations)
+static Result
+Scan(const MultiFormatReader& reader, const BinaryBitmap& binImg, int rotations)
 {
 	Result result(DecodeStatus::NotFound);
-	auto binImg = std::make_shared<HybridBinarizer>(ImageReader::Read(bitmap));
-	
-	if ((rotations & Rotation0) != 0) {
-		result = _reader->read(*binImg);
+	if ((rotations & BarcodeReader::Rotation0) != 0) {
+		result = reader.read(binImg);
 	}
-	if (!result.isValid() && (rotations & Rotation180) != 0) {
-		result = _reader->read(*binImg->rotated(180));
+	if (!result.isValid() && (rotations & BarcodeReader::Rotation180) != 0) {
+		result = reader.read(*binImg.rotated(180));
 	}
-	if (!result.isValid() && (rotations & RotationCW90) != 0) {
-		result = _reader->read(*binImg->rotated(90));
+	if (!result.isValid() && (rotations & BarcodeReader::RotationCW90) != 0) {
+		result = reader.read(*binImg.rotated(90));
 	}
-	if (!result.isValid() && (rotations & RotationCCW90) != 0) {
-		result = _reader->read(*binImg->rotated(270));
+	if (!result.isValid() && (rotations & BarcodeReader::RotationCCW90) != 0) {
+		result = reader.read(*binImg.rotated(270));
 	}
+	return result;
+}
+
+static BarcodeReader::ScanResult
+ToScanResult(const Result& result)
+{
 	if (result.isValid()) {
-		return{ ToString(result.format()), TextUtfEncoding::ToUtf8(result.text()) };
+		return{ ToString(result.format()), result.utf8() };
 	}
-	return ScanResult();
+	return BarcodeReader::ScanResult();
+}
+
+BarcodeReader::ScanResult
+BarcodeReader::scan(Gdiplus::Bitmap& bitmap, int rotations)
+{
+	Result result(DecodeStatus::NotFound);
+	ImageReader::Read(bitmap, [&](const BinaryBitmap& binImg) { result = Scan(*_reader, binImg, rotations); });
+	return ToScanResult(result);
+}
+
+std::vector<BarcodeReader::ScanResult>
+BarcodeReader::scanPages(Gdiplus::Bitmap& bitmap, int rotations)
+{
+	UINT count = std::max(1u, bitmap.GetFrameCount(&Gdiplus::FrameDimensionPage));
+	std::vector<ScanResult> results(count);
+	int numThreads = static_cast<int>(std::min(count, std::max(1u, std::thread::hardware_concurrency())));
+
+	// A Gdiplus::Bitmap has one active frame and must not be used concurrently, so the workers take turns selecting and
+	// binarizing their next page and decode it in parallel.
+	std::mutex bitmapMutex;
+	std::atomic<UINT> next{0};
+	ParallelFor(numThreads, [&](int) {
+		for (UINT i = next++; i < count; i = next++) {
+			std::shared_ptr<BinaryBitmap> page;
+			{
+				std::lock_guard<std::mutex> lock(bitmapMutex);
+				if (count > 1)
+					bitmap.SelectActiveFrame(&Gdiplus::FrameDimensionPage, i);
+				page = ImageReader::Binarize(bitmap);
+			}
+			results[i] = ToScanResult(Scan(*_reader, *page, rotations));
+		}
+	});
+	if (count > 1)
+		bitmap.SelectActiveFrame(&Gdiplus::FrameDimensionPage, 0);
+	return results;
 }
 
 } // ZXing
@@ -17,6 +17,7 @@
 
 #include <string>
 #include <memory>
+#include <vector>
 
 namespace Gdiplus {
 	class Bitmap;
@@ -65,6 +66,12 @@ public:
 
 	ScanResult scan(Gdiplus::Bitmap& bitmap, int rotations = Rotation0);
 
+	/**
+	 Scan every page of a multi-page image (e.g. a TIFF document), the pages are decoded in parallel (see Parallel.h).
+	 The result for page i is at index i, with an empty format if nothing was found.
+	*/
+	std::vector<ScanResult> scanPages(Gdiplus::Bitmap& bitmap, int rotations = Rotation0);
+
 private:
 	std::shared_ptr<MultiFormatReader> _reader;
 };
@@ -17,16 +17,153 @@
 
 #include <windows.h>
 #include <gdiplus.h>
+#include <algorithm>
+#include <array>
 #include <type_traits>
 #include <stdexcept>
+#include <vector>
 
+#include "BinaryBitmap.h"
+#include "BitMatrix.h"
+#include "ByteArray.h"
 #include "GenericLuminanceSource.h"
+#include "HybridBinarizer.h"
+#include "ViewLuminanceSource.h"
 
 namespace ZXing {
 
+namespace {
+
+class LockedBits
+{
+	Gdiplus::Bitmap& _bitmap;
+
+public:
+	Gdiplus::BitmapData data;
+
+	explicit LockedBits(Gdiplus::Bitmap& bitmap) : _bitmap(bitmap)
+	{
+		if (bitmap.LockBits(nullptr, Gdiplus::ImageLockModeRead, bitmap.GetPixelFormat(), &data) != Gdiplus::Ok)
+			throw std::runtime_error("Failed to lock bitmap");
+	}
+	~LockedBits() { _bitmap.UnlockBits(&data); }
+
+	int width() const { return static_cast<int>(data.Width); }
+	int height() const { return static_cast<int>(data.Height); }
+	const uint8_t* row(int y) const { return static_cast<const uint8_t*>(data.Scan0) + y * data.Stride; }
+};
+
+/**
+* A BinaryBitmap of an image that is black and white already, e.g. a 1bpp scan.
+*/
+class BitMatrixBitmap : public BinaryBitmap
+{
+	std::shared_ptr<const BitMatrix> _matrix;
+
+public:
+	explicit BitMatrixBitmap(std::shared_ptr<const BitMatrix> matrix) : _matrix(std::move(matrix)) {}
+
+	int width() const override { return _matrix->width(); }
+	int height() const override { return _matrix->height(); }
+
+	bool getBlackRow(int y, BitArray& row) const override
+	{
+		_matrix->getRow(y, row);
+		return true;
+	}
+
+	std::shared_ptr<const BitMatrix> getBlackMatrix() const override { return _matrix; }
+
+	bool canRotate() const override { return true; }
+
+	std::shared_ptr<BinaryBitmap> rotated(int degreeCW) const override
+	{
+		auto matrix = std::make_shared<BitMatrix>(_matrix->copy());
+		switch ((degreeCW + 360) % 360) {
+		case 90: matrix->rotate90(); break;
+		case 180: matrix->rotate180(); break;
+		case 270: matrix->rotate180(); matrix->rotate90(); break;
+		}
+		return std::make_shared<BitMatrixBitmap>(matrix);
+	}
+};
+
+} // anonymous
+
+// same weights as GenericLuminanceSource
+static uint8_t RGBToGray(unsigned r, unsigned g, unsigned b)
+{
+	return static_cast<uint8_t>((306 * r + 601 * g + 117 * b + 0x200) >> 10);
+}
+
+// luminance of each palette index, indices beyond the palette are black
+static std::array<uint8_t, 256> PaletteLuminances(Gdiplus::Bitmap& bitmap)
+{
+	int size = bitmap.GetPaletteSize();
+	std::vector<UINT> buffer((std::max(size, 0) + sizeof(UINT) - 1) / sizeof(UINT));
+	auto palette = reinterpret_cast<Gdiplus::ColorPalette*>(buffer.data());
+	if (size < static_cast<int>(sizeof(Gdiplus::ColorPalette)) || bitmap.GetPalette(palette, size) != Gdiplus::Ok)
+		throw std::runtime_error("Failed to read palette");
+
+	std::array<uint8_t, 256> luminances = {};
+	for (UINT i = 0; i < palette->Count && i < luminances.size(); ++i) {
+		Gdiplus::Color color(palette->Entries[i]);
+		luminances[i] = RGBToGray(color.GetR(), color.GetG(), color.GetB());
+	}
+	return luminances;
+}
+
+static std::shared_ptr<BinaryBitmap>
+CreateBitMatrixBitmap(const LockedBits& bits, const std::array<uint8_t, 256>& luminances)
+{
+	// the darker of the two palette entries is black
+	int blackBit = luminances[1] < luminances[0] ? 1 : 0;
+	auto matrix = std::make_shared<BitMatrix>(bits.width(), bits.height());
+	if (luminances[0] != luminances[1]) {
+		for (int y = 0; y < bits.height(); ++y) {
+			const uint8_t* row = bits.row(y);
+			for (int x = 0; x < bits.width(); ++x)
+				if (((row[x >> 3] >> (7 - (x & 7))) & 1) == blackBit)
+					matrix->set(x, y);
+		}
+	}
+	return std::make_shared<BitMatrixBitmap>(matrix);
+}
+
 static std::shared_ptr<LuminanceSource>
-CreateLuminanceSource(Gdiplus::Bitmap& bitmap, const Gdiplus::BitmapData& data)
+CreateIndexedLuminanceSource(const LockedBits& bits, const std::array<uint8_t, 256>& luminances, int bitsPerPixel, bool inPlace)
 {
+	int width = bits.width(), height = bits.height();
+	bool isGray = true;
+	for (int i = 0; i < 256; ++i)
+		isGray &= luminances[i] == i;
+	if (bitsPerPixel == 8 && isGray && inPlace)
+		return std::make_shared<ViewLuminanceSource>(width, height, bits.row(0), bits.data.Stride);
+
+	auto pixels = std::make_shared<ByteArray>(width * height);
+	uint8_t* dest = pixels->data();
+	for (int y = 0; y < height; ++y) {
+		const uint8_t* src = bits.row(y);
+		if (bitsPerPixel == 8) {
+			for (int x = 0; x < width; ++x)
+				*dest++ = luminances[src[x]];
+		}
+		else if (bitsPerPixel == 4) {
+			for (int x = 0; x < width; ++x)
+				*dest++ = luminances[(src[x >> 1] >> (x & 1 ? 0 : 4)) & 0x0F];
+		}
+		else {
+			for (int x = 0; x < width; ++x)
+				*dest++ = luminances[(src[x >> 3] >> (7 - (x & 7))) & 1];
+		}
+	}
+	return std::make_shared<GenericLuminanceSource>(0, 0, width, height, std::move(pixels), width);
+}
+
+static std::shared_ptr<LuminanceSource>
+CreateLuminanceSource(Gdiplus::Bitmap& bitmap, const LockedBits& bits, bool inPlace)
+{
+	const auto& data = bits.data;
 	switch (bitmap.GetPixelFormat())
 	{
 	case PixelFormat24bppRGB:
@@ -34,25 +171,40 @@ CreateLuminanceSource(Gdiplus::Bitmap& bitmap, const Gdiplus::BitmapData& data)
 	case PixelFormat32bppARGB:
 	case PixelFormat32bppRGB:
 		return std::make_shared<GenericLuminanceSource>(data.Width, data.Height, data.Scan0, data.Stride, 4, 2, 1, 0);
+	case PixelFormat8bppIndexed:
+		return CreateIndexedLuminanceSource(bits, PaletteLuminances(bitmap), 8, inPlace);
+	case PixelFormat4bppIndexed:
+		return CreateIndexedLuminanceSource(bits, PaletteLuminances(bitmap), 4, inPlace);
+	case PixelFormat1bppIndexed:
+		return CreateIndexedLuminanceSource(bits, PaletteLuminances(bitmap), 1, inPlace);
 	}
 	throw std::invalid_argument("Unsupported format");
 }
 
+static std::shared_ptr<BinaryBitmap>
+CreateBinaryBitmap(Gdiplus::Bitmap& bitmap, const LockedBits& bits, bool inPlace)
+{
+	if (bitmap.GetPixelFormat() == PixelFormat1bppIndexed)
+		return CreateBitMatrixBitmap(bits, PaletteLuminances(bitmap));
+	return std::make_shared<HybridBinarizer>(CreateLuminanceSource(bitmap, bits, inPlace));
+}
+
 std::shared_ptr<LuminanceSource> ImageReader::Read(Gdiplus::Bitmap& bitmap)
 {
-	Gdiplus::BitmapData data;
-	bitmap.LockBits(nullptr, Gdiplus::ImageLockModeRead, bitmap.GetPixelFormat(), &data);
-	try
-	{
-		auto result = CreateLuminanceSource(bitmap, data);
-		bitmap.UnlockBits(&data);
-		return result;
-	}
-	catch (...)
-	{
-		bitmap.UnlockBits(&data);
-		throw;
-	}
+	LockedBits bits(bitmap);
+	return CreateLuminanceSource(bitmap, bits, false);
+}
+
+void ImageReader::Read(Gdiplus::Bitmap& bitmap, const std::function<void(const BinaryBitmap&)>& f)
+{
+	LockedBits bits(bitmap);
+	f(*CreateBinaryBitmap(bitmap, bits, true));
+}
+
+std::shared_ptr<BinaryBitmap> ImageReader::Binarize(Gdiplus::Bitmap& bitmap)
+{
+	LockedBits bits(bitmap);
+	return CreateBinaryBitmap(bitmap, bits, false);
 }
 
 } // ZXing
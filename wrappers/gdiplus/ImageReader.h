@@ -15,6 +15,7 @@
 * limitations under the License.
 */
 
+#include <functional>
 #include <memory>
 
 namespace Gdiplus {
@@ -23,12 +24,26 @@ namespace Gdiplus {
 
 namespace ZXing {
 
+class BinaryBitmap;
 class LuminanceSource;
 
 class ImageReader
 {
 public:
 	static std::shared_ptr<LuminanceSource> Read(Gdiplus::Bitmap& bitmap);
+
+	/**
+	* Calls f with the binarized (active frame of the) bitmap while its pixels are locked. 8bpp grayscale images are
+	* read in place, the other indexed formats through a luminance table built from their palette and 1bpp images are
+	* turned into a BitMatrix directly, without any thresholding.
+	*/
+	static void Read(Gdiplus::Bitmap& bitmap, const std::function<void(const BinaryBitmap&)>& f);
+
+	/**
+	* Same as above, but the returned image does not refer to the pixels of the bitmap, so it stays valid after
+	* another frame has been selected.
+	*/
+	static std::shared_ptr<BinaryBitmap> Binarize(Gdiplus::Bitmap& bitmap);
 };
 
 } // ZXing
@@ -23,6 +23,82 @@ class Test(unittest.TestCase):
 		self.assertEqual(res.format, format)
 		self.assertEqual(res.text, text)
 
+	@unittest.skipIf(not has_numpy, "need numpy for read/write tests")
+	def test_write_linear(self):
+		img = zxing.write_barcode(BF.CODE_128, "12345", 200, 50)
+		self.assertGreaterEqual(img.shape[1], 200)
+		self.assertEqual(img.shape[0], 50)
+		self.assertEqual(set(img.flatten()), {0, 255})
+
+		res = zxing.read_barcode(img)
+		self.assertTrue(res.valid)
+		self.assertEqual(res.text, "12345")
+
+	@unittest.skipIf(not has_numpy, "need numpy for read/write tests")
+	def test_read_strided(self):
+		import numpy as np
+		format = BF.QR_CODE
+		text = "I have the best words."
+		img = zxing.write_barcode(format, text)
+		h, w = img.shape
+
+		# a slice out of a bigger image is not contiguous
+		frame = np.full((h + 20, w + 30), 255, np.uint8)
+		frame[10:10 + h, 20:20 + w] = img
+		res = zxing.read_barcode(frame[5:15 + h, 10:30 + w])
+		self.assertTrue(res.valid)
+		self.assertEqual(res.text, text)
+
+		rgba = np.dstack([img, img, img, np.full(img.shape, 255, np.uint8)])
+		for image_format in [zxing.ImageFormat.NONE, zxing.ImageFormat.RGBX]:
+			res = zxing.read_barcode(rgba, imageFormat = image_format)
+			self.assertTrue(res.valid)
+			self.assertEqual(res.text, text)
+
+		with self.assertRaises(ValueError):
+			zxing.read_barcode(rgba, imageFormat = zxing.ImageFormat.RGB)
+
+	@unittest.skipIf(not has_numpy, "need numpy for read/write tests")
+	def test_read_batch(self):
+		import numpy as np
+		texts = ["first", "second", "third"]
+		images = [zxing.write_barcode(BF.QR_CODE, text, 100, 100) for text in texts]
+		images.insert(1, np.zeros((100, 100), np.uint8))
+
+		for batch in [images, np.stack(images)]:
+			results = zxing.read_barcodes(batch, numThreads = 2)
+			self.assertEqual([res.valid for res in results], [True, False, True, True])
+			self.assertEqual([res.text for res in results], ["first", "", "second", "third"])
+
+		self.assertEqual(zxing.read_barcodes([]), [])
+
+	@unittest.skipIf(not has_numpy, "need numpy for read/write tests")
+	def test_reader(self):
+		import numpy as np
+		first = zxing.write_barcode(BF.QR_CODE, "first", 100, 100)
+		second = zxing.write_barcode(BF.QR_CODE, "second", 100, 100)
+		img = np.hstack([first, second])
+
+		reader = zxing.Reader(formats = [BF.QR_CODE])
+		for _ in range(2):
+			results = reader.read(img)
+			self.assertEqual(sorted(res.text for res in results), ["first", "second"])
+
+		res = min(results, key = lambda res: res.position[0][0])
+		self.assertEqual(res.text, "first")
+		self.assertEqual(res.position.shape, (4, 2))
+		self.assertLess(res.position[1][0], 100)
+		self.assertEqual([(p.x, p.y) for p in res.points], [tuple(p) for p in res.position.tolist()])
+
+		raw = res.raw_bytes
+		self.assertIsInstance(raw, memoryview)
+		self.assertGreater(len(raw), 0)
+		self.assertTrue(raw.readonly)
+		del res, results
+		self.assertEqual(len(bytes(raw)), len(raw)) # the view keeps its result alive
+
+		self.assertEqual(reader.read(np.zeros((100, 100), np.uint8)), [])
+
 	@unittest.skipIf(not has_numpy, "need numpy for read/write tests")
 	def test_failed_read(self):
 		import numpy as np
@@ -8,16 +8,21 @@
 #include "MultiFormatWriter.h"
 #include "TextUtfEncoding.h"
 
+#include "Parallel.h"
+
 #include <pybind11/pybind11.h>
 #include <pybind11/numpy.h>
 #include <pybind11/stl.h>
+#include <algorithm>
+#include <atomic>
 #include <memory>
+#include <thread>
 #include <vector>
 
 using namespace ZXing;
 namespace py = pybind11;
 
-// Numpy array wrapper class for images (either BGR or GRAYSCALE)
+// Numpy array wrapper class for the images returned by write_barcode
 using Image = py::array_t<uint8_t, py::array::c_style>;
 
 template<typename OUT, typename IN>
@@ -36,20 +41,125 @@ FormatList barcode_formats_from_str(const std::string& str)
 	return FormatList(formats.begin(), formats.end());
 };
 
-Result read_barcode(const Image& image, const FormatList& formats, bool fastMode, bool tryRotate, bool hybridBinarizer)
+DecodeHints make_hints(const FormatList& formats, bool fastMode, bool tryRotate, bool hybridBinarizer)
 {
 	DecodeHints hints;
 	hints.setTryHarder(!fastMode);
 	hints.setTryRotate(tryRotate);
 	hints.setPossibleFormats(formats);
 	hints.setBinarizer(hybridBinarizer ? Binarizer::LocalAverage : Binarizer::GlobalHistogram);
-	const auto height = narrow<int>(image.shape(0));
-	const auto width = narrow<int>(image.shape(1));
-	const auto channels = image.ndim() == 2 ? 1 : narrow<int>(image.shape(2));
-	const auto bytes = image.data();
-	const auto imgfmt = channels == 1 ? ImageFormat::Lum : ImageFormat::BGR;
+	return hints;
+}
+
+// Any object supporting the buffer protocol (numpy arrays and slices of them, memoryviews, ...) is read in place, the
+// strides of the rows and pixels are passed on to the ImageView. The image dimensions start at "firstAxis" of "info",
+// "data" points to its first pixel.
+ImageView image_view(const py::buffer_info& info, int firstAxis, const void* data, ImageFormat imageFormat)
+{
+	const auto ndim = info.ndim - firstAxis;
+	if (info.format != py::format_descriptor<uint8_t>::format() || (ndim != 2 && ndim != 3))
+		throw py::value_error("image must be a 2 or 3 dimensional buffer of uint8 values");
+	const auto height = narrow<int>(info.shape[firstAxis]);
+	const auto width = narrow<int>(info.shape[firstAxis + 1]);
+	const auto channels = ndim == 2 ? 1 : narrow<int>(info.shape[firstAxis + 2]);
+	if (channels > 1 && info.strides[firstAxis + 2] != 1)
+		throw py::value_error("the channels of a pixel must be adjacent in memory");
+
+	if (imageFormat == ImageFormat::None)
+		imageFormat = channels == 1 ? ImageFormat::Lum : channels == 3 ? ImageFormat::BGR : ImageFormat::BGRX;
+	if (PixStride(imageFormat) != channels)
+		throw py::value_error("image format does not match the " + std::to_string(channels) + " channels of the image");
+
+	return {static_cast<const uint8_t*>(data), width, height, imageFormat, narrow<int>(info.strides[firstAxis]),
+			narrow<int>(info.strides[firstAxis + 1])};
+}
+
+Result read_barcode(py::buffer image, const FormatList& formats, bool fastMode, bool tryRotate, bool hybridBinarizer,
+					ImageFormat imageFormat)
+{
+	const auto hints = make_hints(formats, fastMode, tryRotate, hybridBinarizer);
+	const auto info = image.request();
+	const auto view = image_view(info, 0, info.ptr, imageFormat);
+
+	// Decoding does not touch any python object, so other python threads can run (and decode) meanwhile.
+	py::gil_scoped_release release;
+	return ReadBarcode(view, hints);
+}
+
+std::vector<Result> read_barcodes(py::object images, const FormatList& formats, bool fastMode, bool tryRotate,
+								  bool hybridBinarizer, ImageFormat imageFormat, int numThreads)
+{
+	const auto hints = make_hints(formats, fastMode, tryRotate, hybridBinarizer);
+
+	// Either one buffer with the images stacked along the first axis (N x H x W or N x H x W x C) or a sequence of
+	// image buffers. The buffer_infos keep the memory of the images alive while the GIL is released.
+	std::vector<py::buffer_info> infos;
+	std::vector<ImageView> views;
+	if (py::isinstance<py::buffer>(images)) {
+		infos.push_back(images.cast<py::buffer>().request());
+		const auto& info = infos.front();
+		if (info.ndim < 1)
+			throw py::value_error("images must be a stack of images");
+		for (ssize_t i = 0; i < info.shape[0]; ++i)
+			views.push_back(image_view(info, 1, static_cast<const uint8_t*>(info.ptr) + i * info.strides[0], imageFormat));
+	} else {
+		for (auto image : images) {
+			infos.push_back(image.cast<py::buffer>().request());
+			views.push_back(image_view(infos.back(), 0, infos.back().ptr, imageFormat));
+		}
+	}
 
-	return ReadBarcode({bytes, width, height, imgfmt, width * channels, channels}, hints);
+	std::vector<Result> results(views.size(), Result(DecodeStatus::NotFound));
+	if (numThreads <= 0)
+		numThreads = std::max(1u, std::thread::hardware_concurrency());
+	numThreads = std::min(numThreads, narrow<int>(views.size()));
+
+	// Each worker has its own scanner with the one set of hints and pulls the next image once it is done with one,
+	// so a few images that are slow to decode do not hold up the others.
+	py::gil_scoped_release release;
+	std::atomic<size_t> next{0};
+	ParallelFor(numThreads, [&](int) {
+		BarcodeScanner scanner(hints);
+		for (size_t i = next++; i < views.size(); i = next++)
+			results[i] = scanner.read(views[i]);
+	});
+	return results;
+}
+
+// A reusable reader: the hints and the format specific readers of the native BarcodeScanner are set up once, read()
+// returns all symbols of an image. One instance can be used from several python threads at the same time.
+class Reader
+{
+	BarcodeScanner _scanner;
+	ImageFormat _imageFormat;
+
+public:
+	Reader(const FormatList& formats, bool fastMode, bool tryRotate, bool hybridBinarizer, ImageFormat imageFormat,
+		   int maxNumberOfSymbols)
+		: _scanner(make_hints(formats, fastMode, tryRotate, hybridBinarizer).setMaxNumberOfSymbols(maxNumberOfSymbols)),
+		  _imageFormat(imageFormat)
+	{}
+
+	Results read(py::buffer image) const
+	{
+		const auto info = image.request();
+		const auto view = image_view(info, 0, info.ptr, _imageFormat);
+
+		py::gil_scoped_release release;
+		return _scanner.readMultiple(view);
+	}
+};
+
+// The corners of the symbol as a 4 x 2 array of [x, y] rows: top left, top right, bottom right, bottom left
+py::array_t<int> result_position(const Result& result)
+{
+	py::array_t<int> corners({4, 2});
+	auto c = corners.mutable_unchecked<2>();
+	for (int i = 0; i < 4; ++i) {
+		c(i, 0) = result.position()[i].x;
+		c(i, 1) = result.position()[i].y;
+	}
+	return corners;
 }
 
 Image write_barcode(BarcodeFormat format, std::string text, int width, int height, int margin, int eccLevel)
@@ -57,11 +167,9 @@ Image write_barcode(BarcodeFormat format, std::string text, int width, int heigh
 	auto writer = MultiFormatWriter(format).setMargin(margin).setEccLevel(eccLevel);
 	auto bitmap = writer.encode(TextUtfEncoding::FromUtf8(text), width, height);
 
-	auto result = Image({bitmap.width(), bitmap.height()});
-	auto r = result.mutable_unchecked<2>();
-	for (ssize_t y = 0; y < r.shape(0); y++)
-		for (ssize_t x = 0; x < r.shape(1); x++)
-			r(y, x) = bitmap.get(narrow<int>(x), narrow<int>(y)) ? 0 : 255;
+	// numpy arrays are indexed [row, column], InflateInto fills each run of black pixels with one memset
+	auto result = Image({bitmap.height(), bitmap.width()});
+	InflateInto(bitmap, result.mutable_data(), bitmap.width(), bitmap.height(), RasterFormat::Lum);
 	return result;
 }
 
@@ -89,22 +197,70 @@ PYBIND11_MODULE(zxing, m)
 		.value("FORMAT_COUNT", BarcodeFormat::FORMAT_COUNT)
 		.value("INVALID", BarcodeFormat::INVALID)
 		.export_values();
+	py::enum_<ImageFormat>(m, "ImageFormat")
+		.value("NONE", ImageFormat::None)
+		.value("LUM", ImageFormat::Lum)
+		.value("RGB", ImageFormat::RGB)
+		.value("BGR", ImageFormat::BGR)
+		.value("RGBX", ImageFormat::RGBX)
+		.value("XRGB", ImageFormat::XRGB)
+		.value("BGRX", ImageFormat::BGRX)
+		.value("XBGR", ImageFormat::XBGR);
 	py::class_<ResultPoint>(m, "ResultPoint")
 		.def_property_readonly("x", &ResultPoint::x)
 		.def_property_readonly("y", &ResultPoint::y);
-	py::class_<Result>(m, "Result")
+	// The buffer protocol exposes the raw bytes in place and read-only (the const_cast below must not leak write access),
+	// the memoryview returned by raw_bytes keeps the Result alive.
+	py::class_<Result>(m, "Result", py::buffer_protocol())
+		.def_buffer([](Result& res) {
+			auto& bytes = res.rawBytes();
+			return py::buffer_info(const_cast<uint8_t*>(bytes.data()), 1, py::format_descriptor<uint8_t>::format(), 1,
+								   {narrow<ssize_t>(bytes.size())}, {ssize_t(1)}, true);
+		})
 		.def_property_readonly("valid", &Result::isValid)
 		.def_property_readonly("text", &Result::text)
 		.def_property_readonly("format", &Result::format)
-		.def_property_readonly("points", &Result::resultPoints);
+		.def_property_readonly("raw_bytes", [](py::object self) { return py::memoryview(self); })
+		.def_property_readonly("position", &result_position)
+		.def_property_readonly("points", [](const Result& res) {
+			return std::vector<ResultPoint>(res.position().begin(), res.position().end());
+		});
+	py::class_<Reader>(m, "Reader")
+		.def(py::init<const FormatList&, bool, bool, bool, ImageFormat, int>(),
+			py::arg("formats") = FormatList{},
+			py::arg("fastMode") = false,
+			py::arg("tryRotate") = true,
+			py::arg("hybridBinarizer") = true,
+			py::arg("imageFormat") = ImageFormat::None,
+			py::arg("maxNumberOfSymbols") = 0xFF
+		)
+		.def("read", &Reader::read,
+			"Read (decode) all barcodes in a grayscale, BGR or BGRA image in any uint8 buffer, see read_barcode. "
+			"Returns a list with the valid results, possibly empty.",
+			py::arg("image")
+		);
 	m.def("barcode_format_from_str", &BarcodeFormatFromString, "Convert string to BarcodeFormat", py::arg("str"));
 	m.def("barcode_formats_from_str", &barcode_formats_from_str, "Convert string to BarcodeFormats", py::arg("str"));
-	m.def("read_barcode", &read_barcode, "Read (decode) a barcode from a numpy BGR or grayscale image array",
+	m.def("read_barcode", &read_barcode,
+		"Read (decode) a barcode from a grayscale, BGR or BGRA image in any uint8 buffer (e.g. a numpy array or a slice "
+		"of one) without copying it. Pass imageFormat for other channel orders like RGB or RGBA.",
 		py::arg("image"),
 		py::arg("formats") = FormatList{},
 		py::arg("fastMode") = false,
 		py::arg("tryRotate") = true,
-		py::arg("hybridBinarizer") = true
+		py::arg("hybridBinarizer") = true,
+		py::arg("imageFormat") = ImageFormat::None
+	);
+	m.def("read_barcodes", &read_barcodes,
+		"Read (decode) one barcode from each image of a list of images or of an N x H x W (x C) array on a native thread "
+		"pool, with the GIL released. Returns a list with one result per image, in the order of the images.",
+		py::arg("images"),
+		py::arg("formats") = FormatList{},
+		py::arg("fastMode") = false,
+		py::arg("tryRotate") = true,
+		py::arg("hybridBinarizer") = true,
+		py::arg("imageFormat") = ImageFormat::None,
+		py::arg("numThreads") = 0
 	);
 	m.def("write_barcode", &write_barcode, "Write (encode) a text into a barcode and return numpy image array",
 		py::arg("format"),
@@ -16,9 +16,12 @@
 
 #include "ReadBarcode.h"
 
+#include <algorithm>
 #include <string>
 #include <memory>
 #include <stdexcept>
+#include <thread>
+#include <vector>
 #include <emscripten/bind.h>
 
 #define STB_IMAGE_IMPLEMENTATION
@@ -31,6 +34,18 @@ struct ReadResult
 	std::string error;
 };
 
+static void UseAllCores(ZXing::DecodeHints& hints)
+{
+#ifdef __EMSCRIPTEN_PTHREADS__
+	// the _mt build starts one worker per core up front (PTHREAD_POOL_SIZE in CMakeLists.txt)
+	int threads = std::max(1u, std::thread::hardware_concurrency());
+	hints.setBinarizerThreads(threads);
+	hints.setRowScanThreads(threads);
+#else
+	(void)hints;
+#endif
+}
+
 ReadResult readBarcodeFromImage(int bufferPtr, int bufferLength, bool tryHarder, std::string format)
 {
 	using namespace ZXing;
@@ -39,6 +54,7 @@ ReadResult readBarcodeFromImage(int bufferPtr, int bufferLength, bool tryHarder,
 		hints.setTryHarder(tryHarder);
 		hints.setTryRotate(tryHarder);
 		hints.setFormats(BarcodeFormatsFromString(format));
+		UseAllCores(hints);
 
 		int width, height, channels;
 		std::unique_ptr<stbi_uc, void (*)(void*)> buffer(
@@ -71,6 +87,7 @@ ReadResult readBarcodeFromPixmap(int bufferPtr, int imgWidth, int imgHeight, boo
 		hints.setTryHarder(tryHarder);
 		hints.setTryRotate(tryHarder);
 		hints.setFormats(BarcodeFormatsFromString(format));
+		UseAllCores(hints);
 
 		auto result =
 			ReadBarcode({reinterpret_cast<uint8_t*>(bufferPtr), imgWidth, imgHeight, ImageFormat::RGBX}, hints);
@@ -88,6 +105,74 @@ ReadResult readBarcodeFromPixmap(int bufferPtr, int imgWidth, int imgHeight, boo
 	return {};
 }
 
+struct FrameResult
+{
+	std::string format;
+	std::string text; // UTF-8
+	std::string error;
+};
+
+/**
+* Reader for a stream of camera frames. It owns an RGBA frame buffer in the wasm heap that JS fills directly, e.g.
+*
+*   const reader = new zxing.FrameReader(false, "QR_CODE");
+*   reader.frameBuffer(imageData.width, imageData.height).set(imageData.data);
+*   const result = reader.read();
+*   ...
+*   reader.delete();
+*
+* The hints are parsed and the scanner is set up only once, the buffer is only reallocated when the frame size
+* changes. The view returned by frameBuffer() becomes invalid when the heap grows, so fetch it again for every frame.
+*/
+class FrameReader
+{
+	ZXing::BarcodeScanner _scanner;
+	std::vector<uint8_t> _buffer;
+	int _width = 0, _height = 0;
+
+	static ZXing::DecodeHints MakeHints(bool tryHarder, const std::string& format)
+	{
+		ZXing::DecodeHints hints;
+		hints.setTryHarder(tryHarder);
+		hints.setTryRotate(tryHarder);
+		hints.setFormats(ZXing::BarcodeFormatsFromString(format));
+		UseAllCores(hints);
+		return hints;
+	}
+
+public:
+	FrameReader(bool tryHarder, std::string format) : _scanner(MakeHints(tryHarder, format)) {}
+
+	emscripten::val frameBuffer(int width, int height)
+	{
+		_width = std::max(width, 0);
+		_height = std::max(height, 0);
+		_buffer.resize(4 * _width * _height);
+		return emscripten::val(emscripten::typed_memory_view(_buffer.size(), _buffer.data()));
+	}
+
+	FrameResult read() const
+	{
+		using namespace ZXing;
+		if (_buffer.empty()) {
+			return { "", "", "No frame, call frameBuffer() first" };
+		}
+		try {
+			auto result = _scanner.read({_buffer.data(), _width, _height, ImageFormat::RGBX});
+			if (result.isValid()) {
+				return { ToString(result.format()), result.utf8(), "" };
+			}
+		}
+		catch (const std::exception& e) {
+			return { "", "", e.what() };
+		}
+		catch (...) {
+			return { "", "", "Unknown error" };
+		}
+		return {};
+	}
+};
+
 EMSCRIPTEN_BINDINGS(BarcodeReader)
 {
 	using namespace emscripten;
@@ -98,6 +183,18 @@ EMSCRIPTEN_BINDINGS(BarcodeReader)
 	        .field("error", &ReadResult::error)
 	        ;
 
+	value_object<FrameResult>("FrameResult")
+	        .field("format", &FrameResult::format)
+	        .field("text", &FrameResult::text)
+	        .field("error", &FrameResult::error)
+	        ;
+
+	class_<FrameReader>("FrameReader")
+	        .constructor<bool, std::string>()
+	        .function("frameBuffer", &FrameReader::frameBuffer)
+	        .function("read", &FrameReader::read)
+	        ;
+
 	function("readBarcodeFromImage", &readBarcodeFromImage);
 	function("readBarcodeFromPixmap", &readBarcodeFromPixmap);
 
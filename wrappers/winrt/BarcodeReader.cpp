@@ -22,15 +22,14 @@
 
 #include "BarcodeFormat.h"
 #include "DecodeHints.h"
-#include "GenericLuminanceSource.h"
-#include "HybridBinarizer.h"
-#include "MultiFormatReader.h"
+#include "ReadBarcode.h"
 #include "ReadResult.h"
 #include "Result.h"
 #include "TextUtfEncoding.h"
 
 #include <algorithm>
 #include <MemoryBuffer.h>
+#include <ppltasks.h>
 #include <stdexcept>
 #include <wrl.h>
 
@@ -70,7 +69,7 @@ BarcodeReader::init(bool tryHarder, bool tryRotate, const Platform::Array<Barcod
 		hints.setPossibleFormats(barcodeFormats);
 	}
 
-	m_reader.reset(new MultiFormatReader(hints));
+	m_scanner = std::make_shared<BarcodeScanner>(hints);
 }
 
 BarcodeReader::~BarcodeReader()
@@ -162,14 +161,30 @@ BarcodeType BarcodeReader::ConvertNativeToRuntime(BarcodeFormat format)
 	}
 }
 
-static std::shared_ptr<BinaryBitmap>
-CreateBinaryBitmap(SoftwareBitmap^ bitmap, int cropWidth, int cropHeight)
+static ImageFormat
+ToImageFormat(BitmapPixelFormat format)
+{
+	switch (format)
+	{
+	case BitmapPixelFormat::Gray8: return ImageFormat::Lum;
+	case BitmapPixelFormat::Bgra8: return ImageFormat::BGRX;
+	case BitmapPixelFormat::Rgba8: return ImageFormat::RGBX;
+	case BitmapPixelFormat::Nv12: return ImageFormat::NV12; // only the Y plane is used
+	default: throw std::runtime_error("Unsupported format");
+	}
+}
+
+// The pixels are only locked for the duration of the call and read in place, Gray8 and NV12 frames are not copied at
+// all, Bgra8 and Rgba8 are converted into a buffer the scanner reuses.
+static Result
+ReadBitmap(const BarcodeScanner& scanner, SoftwareBitmap^ bitmap, int cropWidth, int cropHeight)
 {
 	cropWidth = cropWidth <= 0 ? bitmap->PixelWidth : std::min(bitmap->PixelWidth, cropWidth);
 	cropHeight = cropHeight <= 0 ? bitmap->PixelHeight : std::min(bitmap->PixelHeight, cropHeight);
 	int cropLeft = (bitmap->PixelWidth - cropWidth) / 2;
 	int cropTop = (bitmap->PixelHeight - cropHeight) / 2;
 
+	auto format = ToImageFormat(bitmap->BitmapPixelFormat);
 	auto inBuffer = bitmap->LockBuffer(BitmapBufferAccessMode::Read);
 	auto inMemRef = inBuffer->CreateReference();
 	ComPtr<IMemoryBufferByteAccess> inBufferAccess;
@@ -179,22 +194,9 @@ CreateBinaryBitmap(SoftwareBitmap^ bitmap, int cropWidth, int cropHeight)
 		UINT32 inCapacity = 0;
 		inBufferAccess->GetBuffer(&inBytes, &inCapacity);
 
-		std::shared_ptr<GenericLuminanceSource> luminance;
-		switch (bitmap->BitmapPixelFormat)
-		{
-		case BitmapPixelFormat::Gray8:
-			luminance = std::make_shared<GenericLuminanceSource>(cropLeft, cropTop, cropWidth, cropHeight, inBytes, inBuffer->GetPlaneDescription(0).Stride);
-			break;
-		case BitmapPixelFormat::Bgra8:
-			luminance = std::make_shared<GenericLuminanceSource>(cropLeft, cropTop, cropWidth, cropHeight, inBytes, inBuffer->GetPlaneDescription(0).Stride, 4, 2, 1, 0);
-			break;
-		case BitmapPixelFormat::Rgba8:
-			luminance = std::make_shared<GenericLuminanceSource>(cropLeft, cropTop, cropWidth, cropHeight, inBytes, inBuffer->GetPlaneDescription(0).Stride, 4, 0, 1, 2);
-			break;
-		default:
-			throw std::runtime_error("Unsupported format");
-		}
-		return std::make_shared<HybridBinarizer>(luminance);
+		auto plane = inBuffer->GetPlaneDescription(0);
+		auto image = ImageView(inBytes + plane.StartIndex, plane.Width, plane.Height, format, plane.Stride);
+		return scanner.read(image.cropped(cropLeft, cropTop, cropWidth, cropHeight));
 	}
 	else
 	{
@@ -215,10 +217,15 @@ static Platform::String^ ToPlatformString(const std::string& str)
 
 ReadResult^
 BarcodeReader::Read(SoftwareBitmap^ bitmap, int cropWidth, int cropHeight)
+{
+	return Read(*m_scanner, bitmap, cropWidth, cropHeight);
+}
+
+ReadResult^
+BarcodeReader::Read(const BarcodeScanner& scanner, SoftwareBitmap^ bitmap, int cropWidth, int cropHeight)
 {
 	try {
-		auto binImg = CreateBinaryBitmap(bitmap, cropWidth, cropHeight);
-		auto result = m_reader->read(*binImg);
+		auto result = ReadBitmap(scanner, bitmap, cropWidth, cropHeight);
 		if (result.isValid()) {
 			return ref new ReadResult(ToPlatformString(ZXing::ToString(result.format())), ToPlatformString(result.text()), ConvertNativeToRuntime(result.format()));
 		}
@@ -231,4 +238,14 @@ BarcodeReader::Read(SoftwareBitmap^ bitmap, int cropWidth, int cropHeight)
 	return nullptr;
 }
 
+IAsyncOperation<ReadResult^>^
+BarcodeReader::ReadAsync(SoftwareBitmap^ bitmap, int cropWidth, int cropHeight)
+{
+	// the task keeps its own reference to the scanner in case this BarcodeReader is released before it ran
+	auto scanner = m_scanner;
+	return concurrency::create_async([scanner, bitmap, cropWidth, cropHeight]() {
+		return Read(*scanner, bitmap, cropWidth, cropHeight);
+	});
+}
+
 } // ZXing
@@ -38,7 +38,7 @@ public enum class BarcodeType : int {
 	UPC_EAN_EXTENSION
 };
 
-class MultiFormatReader;
+class BarcodeScanner;
 ref class ReadResult;
 
 public ref class BarcodeReader sealed
@@ -50,15 +50,21 @@ public:
 
 	ReadResult^ Read(Windows::Graphics::Imaging::SoftwareBitmap^ bitmap, int cropWidth, int cropHeight);
 
+	// Decodes on the thread pool, so camera frames can be handed over without blocking the UI thread. Several reads
+	// may run at the same time, they share the reader and its scratch buffers.
+	Windows::Foundation::IAsyncOperation<ReadResult^>^ ReadAsync(Windows::Graphics::Imaging::SoftwareBitmap^ bitmap, int cropWidth, int cropHeight);
+
 private:
 	~BarcodeReader();
 
 	void init(bool tryHarder, bool tryRotate, const Platform::Array<BarcodeType>^ types);
 
+	static ReadResult^ Read(const BarcodeScanner& scanner, Windows::Graphics::Imaging::SoftwareBitmap^ bitmap, int cropWidth, int cropHeight);
+
 	static BarcodeFormat ConvertRuntimeToNative(BarcodeType type);
 	static BarcodeType ConvertNativeToRuntime(BarcodeFormat format);
 
-	std::unique_ptr<MultiFormatReader> m_reader;
+	std::shared_ptr<BarcodeScanner> m_scanner;
 };
 
 } // ZXing